@@ -0,0 +1,176 @@
+/**
+ * Kernel Microbenchmarks - Harness
+ *
+ * Host:   make bench        (table)   make bench-json  (JSON to build/bench/bench.json)
+ *         walkman_bench [--json] [name-filter]
+ * Target: make bench-elf, run under a debugger with semihosting; prints JSON
+ *
+ * Each kernel runs once untimed (warm caches, branch predictors, filter
+ * state), then BENCH_SETS sets of runs are timed and the fastest set is
+ * kept, which rejects interrupts and host scheduler noise. Kernels with a
+ * real-time rate get a load (% of one core at that rate); the exit status
+ * is 1 if one is over its budget. On the host that is the host's core, so
+ * budgets are meaningful on target (bench-elf).
+ */
+
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SETS  5
+
+#ifdef STM32F407xx
+/* ============ Target: DWT cycle counter ============ */
+#include "system.h"
+
+#define BENCH_UNIT      "cycles"
+#define BENCH_PLATFORM  "stm32f407"
+#define BENCH_CLOCK_HZ  SYSTEM_CLOCK_HZ
+#define BENCH_RUNS      16
+
+extern void initialise_monitor_handles(void);
+
+static void bench_timer_init(void) {
+    initialise_monitor_handles();
+    system_init();
+    system_cycles_init();
+}
+
+static uint64_t bench_now(void) {
+    return system_get_cycles();
+}
+
+/* CYCCNT is 32 bits; one set must stay under a wrap (~25 s) */
+static uint64_t bench_elapsed(uint64_t start) {
+    return (uint32_t)(system_get_cycles() - (uint32_t)start);
+}
+
+static uint32_t bench_calibrate(const bench_kernel_t* k) {
+    (void)k;
+    return BENCH_RUNS;
+}
+
+#else
+/* ============ Host: monotonic clock ============ */
+#include <time.h>
+
+#define BENCH_UNIT      "ns"
+#define BENCH_PLATFORM  "host"
+#define BENCH_CLOCK_HZ  1000000000u
+#define BENCH_MIN_SET_NS 20000000ull   // Grow runs per set to at least 20 ms
+
+static void bench_timer_init(void) {
+}
+
+static uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t bench_elapsed(uint64_t start) {
+    return bench_now() - start;
+}
+
+static uint32_t bench_calibrate(const bench_kernel_t* k) {
+    uint32_t runs = 1;
+    for (;;) {
+        uint64_t start = bench_now();
+        for (uint32_t i = 0; i < runs; i++) k->run();
+        if (bench_elapsed(start) >= BENCH_MIN_SET_NS / 4 || runs >= (1u << 24)) break;
+        runs *= 2;
+    }
+    return runs * 4;
+}
+#endif
+
+typedef struct {
+    uint32_t runs;
+    double per_run;           // Best set, per run (BENCH_UNIT)
+    double per_item;
+    double items_per_sec;
+    double load;              // % of one core at k->rate items/s
+} bench_result_t;
+
+static void bench_measure(const bench_kernel_t* k, bench_result_t* r) {
+    if (k->setup) k->setup();
+    k->run();
+
+    r->runs = bench_calibrate(k);
+    uint64_t best = UINT64_MAX;
+
+    for (int set = 0; set < BENCH_SETS; set++) {
+        uint64_t start = bench_now();
+        for (uint32_t i = 0; i < r->runs; i++) k->run();
+        uint64_t elapsed = bench_elapsed(start);
+        if (elapsed < best) best = elapsed;
+    }
+
+    r->per_run = (double)best / r->runs;
+    r->per_item = r->per_run / k->items;
+    r->items_per_sec = (r->per_item > 0.0) ? (double)BENCH_CLOCK_HZ / r->per_item : 0.0;
+    r->load = r->per_item * k->rate * 100.0 / BENCH_CLOCK_HZ;
+}
+
+int main(int argc, char** argv) {
+    int json = 0;
+    int over = 0;
+    const char* filter = NULL;
+
+#ifdef STM32F407xx
+    (void)argc; (void)argv;
+    json = 1;
+#else
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = 1;
+        else filter = argv[i];
+    }
+#endif
+
+    bench_timer_init();
+
+    if (json) {
+        printf("{\n  \"platform\": \"%s\",\n  \"unit\": \"%s\",\n  \"clock_hz\": %lu,\n"
+               "  \"results\": [", BENCH_PLATFORM, BENCH_UNIT, (unsigned long)BENCH_CLOCK_HZ);
+    } else {
+        printf("%-20s %10s %8s %14s %14s %16s %18s\n", "kernel", "items", "item",
+               BENCH_UNIT "/run", BENCH_UNIT "/item", "items/s", "load");
+    }
+
+    int first = 1;
+    for (uint32_t i = 0; i < bench_kernel_count; i++) {
+        const bench_kernel_t* k = &bench_kernels[i];
+        if (filter && strstr(k->name, filter) == NULL) continue;
+
+        bench_result_t r;
+        bench_measure(k, &r);
+        int over_budget = k->rate && r.load > k->budget;
+        over |= over_budget;
+
+        if (json) {
+            printf("%s\n    {\"name\": \"%s\", \"item\": \"%s\", \"items\": %lu, "
+                   "\"runs\": %lu, \"per_run\": %.1f, \"per_item\": %.3f, "
+                   "\"items_per_sec\": %.0f",
+                   first ? "" : ",", k->name, k->item, (unsigned long)k->items,
+                   (unsigned long)r.runs, r.per_run, r.per_item, r.items_per_sec);
+            if (k->rate) {
+                printf(", \"rate\": %lu, \"load_pct\": %.3f, \"budget_pct\": %.1f",
+                       (unsigned long)k->rate, r.load, (double)k->budget);
+            }
+            printf("}");
+        } else {
+            char load[32] = "-";
+            if (k->rate) {
+                snprintf(load, sizeof(load), "%.2f%%/%.0f%%%s", r.load, (double)k->budget,
+                         over_budget ? " OVER" : "");
+            }
+            printf("%-20s %10lu %8s %14.1f %14.3f %16.0f %18s\n", k->name,
+                   (unsigned long)k->items, k->item, r.per_run, r.per_item,
+                   r.items_per_sec, load);
+        }
+        first = 0;
+    }
+
+    if (json) printf("\n  ]\n}\n");
+    return over ? 1 : 0;
+}
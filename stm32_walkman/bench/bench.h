@@ -0,0 +1,33 @@
+/**
+ * Kernel Microbenchmarks
+ *
+ * Each kernel processes a fixed number of items (samples, frames, pixels,
+ * FFT points) per run. The harness times repeated runs and reports the best
+ * run per item: nanoseconds on the host build, DWT cycles on target.
+ * Kernels of the real-time path can name the item rate they must sustain
+ * and a budget: the load column is the share of one core they take at that
+ * rate, and the run fails if a kernel goes over its budget.
+ */
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdint.h>
+
+typedef struct {
+    const char* name;
+    const char* item;         // What one item is ("sample", "pixel", ...)
+    uint32_t items;           // Items processed per run
+    void (*setup)(void);      // Optional, called once before timing
+    void (*run)(void);
+    uint32_t rate;            // Items/s in real time (0 = no load column)
+    float budget;             // Max load in % of one core at that rate
+} bench_kernel_t;
+
+extern const bench_kernel_t bench_kernels[];
+extern const uint32_t bench_kernel_count;
+
+/* Defeats dead code elimination of kernel results */
+extern volatile uint32_t bench_sink;
+
+#endif /* __BENCH_H */
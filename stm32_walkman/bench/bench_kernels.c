@@ -0,0 +1,359 @@
+/**
+ * Kernel Microbenchmarks - Kernel Table
+ * Hot loops of the audio output path and the display renderer
+ */
+
+#include "bench.h"
+#include "dsp.h"
+#include "resample.h"
+#include "wsola.h"
+#include "loudcomp.h"
+#include "crossfeed.h"
+#include "limiter.h"
+#include "convolver.h"
+#include "dsd.h"
+#include "fft.h"
+#include "lcd_render.h"
+#include "pcm_ring.h"
+#include "adpcm.h"
+#include "sfx.h"
+#include <math.h>
+#include <string.h>
+
+#define BENCH_FRAMES   1024
+#define BENCH_SAMPLES  (BENCH_FRAMES * DSP_CHANNELS)
+
+static int16_t bench_s16[BENCH_SAMPLES];
+static int16_t bench_s16_out[BENCH_SAMPLES * 3];
+static int32_t bench_q31[BENCH_SAMPLES];
+static uint8_t bench_pixels[24 * 18 * 2];
+
+static dsp_biquad_t bench_biquad;
+static loudcomp_t bench_loudcomp;
+static crossfeed_t bench_crossfeed;
+static limiter_t bench_limiter;
+static resample_t bench_resampler;
+static wsola_t bench_wsola;
+static convolver_t bench_convolver;
+static convolver_coef_t bench_convolver_filter[CONVOLVER_FILTER_COEFS];
+static dsd_t bench_dsd;
+static uint8_t bench_dsd_bytes[BENCH_FRAMES * DSD_FRAME_BYTES * 2];
+static fft_q31_t bench_fft_data[FFT_MAX_SIZE];
+static uint32_t bench_seed = 1;
+
+static int16_t bench_ring_storage[4096 * PCM_RING_CHANNELS];
+static pcm_ring_t bench_ring;
+
+static sfx_mixer_t bench_sfx;
+
+#define BENCH_ADPCM_BLOCK  1024
+static uint8_t bench_adpcm_block[BENCH_ADPCM_BLOCK];
+static uint32_t bench_adpcm_frames;
+
+volatile uint32_t bench_sink;
+
+/* Two-tone test signal at -6 dBFS */
+static void bench_setup_signal(void) {
+    for (uint32_t i = 0; i < BENCH_FRAMES; i++) {
+        float t = (float)i / 44100.0f;
+        int16_t l = (int16_t)(8000.0f * sinf(2.0f * 3.14159265f * 440.0f * t) +
+                              8000.0f * sinf(2.0f * 3.14159265f * 5000.0f * t));
+        bench_s16[2 * i] = l;
+        bench_s16[2 * i + 1] = (int16_t)-l;
+    }
+    dsp_s16_to_q31(bench_s16, bench_q31, BENCH_SAMPLES);
+}
+
+/* ============ Audio kernels ============ */
+
+static void bench_run_s16_to_q31(void) {
+    dsp_s16_to_q31(bench_s16, bench_q31, BENCH_SAMPLES);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+static void bench_run_gain_s16(void) {
+    memcpy(bench_s16_out, bench_s16, sizeof(bench_s16));
+    dsp_gain_s16(bench_s16_out, BENCH_SAMPLES, 46341);  /* -3 dB */
+    bench_sink = (uint32_t)bench_s16_out[7];
+}
+
+static void bench_run_gain_q31(void) {
+    dsp_gain_q31(bench_q31, BENCH_SAMPLES, DSP_GAIN_UNITY);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+static void bench_setup_biquad(void) {
+    dsp_biquad_coef_t coef;
+    bench_setup_signal();
+    dsp_biquad_design(&coef, DSP_BIQUAD_PEAK, 44100.0f, 1000.0f, 0.7f, 6.0f);
+    dsp_biquad_init(&bench_biquad, &coef);
+}
+
+static void bench_run_biquad(void) {
+    dsp_biquad_q31(&bench_biquad, bench_q31, BENCH_FRAMES);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+static void bench_setup_loudcomp(void) {
+    bench_setup_signal();
+    loudcomp_init(&bench_loudcomp, 48000);
+    loudcomp_set_volume(&bench_loudcomp, 30);
+    loudcomp_reset(&bench_loudcomp);
+}
+
+static void bench_run_loudcomp(void) {
+    loudcomp_q31(&bench_loudcomp, bench_q31, BENCH_FRAMES);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+static void bench_setup_crossfeed(void) {
+    bench_setup_signal();
+    crossfeed_init(&bench_crossfeed, CROSSFEED_HIGH, 48000);
+}
+
+static void bench_run_crossfeed(void) {
+    crossfeed_q31(&bench_crossfeed, bench_q31, BENCH_FRAMES);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+/* Worst case: compressor on, its make-up gain driving the limiter */
+static void bench_setup_limiter(void) {
+    static const limiter_config_t config = {-1.0f, 5.0f, 80.0f, -30.0f, 3.0f, 10.0f, 10.0f, 300.0f};
+    bench_setup_signal();
+    limiter_init(&bench_limiter, &config, 48000);
+    limiter_set_drc(&bench_limiter, 1);
+}
+
+static void bench_run_limiter(void) {
+    limiter_q31(&bench_limiter, bench_q31, BENCH_FRAMES);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+static void bench_run_dither(void) {
+    dsp_dither_q31_to_s16(bench_q31, bench_s16_out, BENCH_SAMPLES, &bench_seed);
+    bench_sink = (uint32_t)bench_s16_out[7];
+}
+
+static void bench_run_resample(void) {
+    uint32_t consumed;
+    uint32_t produced = resample_process(&bench_resampler, bench_s16, BENCH_FRAMES,
+                                         &consumed, bench_s16_out, BENCH_FRAMES * 3);
+    bench_sink = produced;
+}
+
+static void bench_setup_src_48k(void) {
+    bench_setup_signal();
+    resample_init(&bench_resampler, 48000, 44100);
+}
+
+static void bench_setup_src_22k(void) {
+    bench_setup_signal();
+    resample_init(&bench_resampler, 22050, 44100);
+}
+
+static void bench_setup_wsola(void) {
+    bench_setup_signal();
+    wsola_init(&bench_wsola, 48000, 150);
+}
+
+/* BENCH_FRAMES output frames at 1.5x, the test signal looped as input */
+static void bench_run_wsola(void) {
+    uint32_t produced = 0, pos = 0;
+    while (produced < BENCH_FRAMES) {
+        uint32_t consumed;
+        produced += wsola_process(&bench_wsola, &bench_s16[pos * 2], BENCH_FRAMES - pos, &consumed,
+                                  &bench_s16_out[produced * 2], BENCH_FRAMES - produced);
+        pos = (pos + consumed) % BENCH_FRAMES;
+    }
+    bench_sink = (uint32_t)bench_s16_out[7];
+}
+
+/* Decaying noise as a stand-in for a measured room response, different per ear */
+static void bench_setup_convolver(uint32_t taps) {
+    float chunk[64 * DSP_CHANNELS];
+    uint32_t seed = 12345;
+
+    bench_setup_signal();
+    convolver_init(&bench_convolver, bench_convolver_filter);
+    convolver_begin(&bench_convolver, taps, 48000);
+    for (uint32_t i = 0; i < taps; i += 64) {
+        for (uint32_t k = 0; k < 64 * DSP_CHANNELS; k++) {
+            seed = seed * 1664525u + 1013904223u;
+            float decay = expf(-5.0f * (float)(i + k / DSP_CHANNELS) / (float)taps);
+            chunk[k] = 0.05f * decay * ((float)(int32_t)seed / 2147483648.0f);
+        }
+        convolver_load(&bench_convolver, chunk, 64, DSP_CHANNELS);
+    }
+    convolver_end(&bench_convolver);
+}
+
+static void bench_setup_convolver_1024(void) {
+    bench_setup_convolver(1024);
+}
+
+static void bench_setup_convolver_4096(void) {
+    bench_setup_convolver(4096);
+}
+
+static void bench_run_convolver(void) {
+    convolver_q31(&bench_convolver, bench_q31, BENCH_FRAMES);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+/* The test signal's left channel as DSD64 (first-order sigma-delta), both
+ * channels byte interleaved like DSDIFF */
+static void bench_setup_dsd(void) {
+    int32_t integrator = 0, y = 0;
+
+    bench_setup_signal();
+    memset(bench_dsd_bytes, 0, sizeof(bench_dsd_bytes));
+    for (uint32_t n = 0; n < BENCH_FRAMES * DSD_DECIMATION; n++) {
+        integrator += bench_s16[2 * (n / DSD_DECIMATION)] - y;
+        y = (integrator >= 0) ? 32767 : -32767;
+        if (y > 0) {
+            uint32_t byte = n / 8;
+            bench_dsd_bytes[2 * byte] |= 0x80 >> (n % 8);
+            bench_dsd_bytes[2 * byte + 1] |= 0x80 >> (n % 8);
+        }
+    }
+    dsd_init(&bench_dsd, 0);
+}
+
+static void bench_run_dsd(void) {
+    dsd_to_q31(&bench_dsd, 0, &bench_dsd_bytes[0], 2, BENCH_FRAMES, &bench_q31[0]);
+    dsd_to_q31(&bench_dsd, 1, &bench_dsd_bytes[1], 2, BENCH_FRAMES, &bench_q31[1]);
+    bench_sink = (uint32_t)bench_q31[7];
+}
+
+static void bench_setup_fft(void) {
+    fft_init();
+    for (uint32_t i = 0; i < FFT_MAX_SIZE; i++) {
+        bench_fft_data[i].re = (int32_t)bench_s16[(2 * i) % BENCH_SAMPLES] << 15;
+        bench_fft_data[i].im = 0;
+    }
+}
+
+static void bench_run_fft_256(void) {
+    fft_q31(bench_fft_data, 8, 0);
+    bench_sink = (uint32_t)bench_fft_data[3].re;
+}
+
+static void bench_run_fft_1024(void) {
+    fft_q31(bench_fft_data, 10, 0);
+    bench_sink = (uint32_t)bench_fft_data[3].re;
+}
+
+static void bench_setup_ring(void) {
+    pcm_ring_init(&bench_ring, bench_ring_storage, 4096);
+}
+
+/* One 512-frame DMA block through the decoder -> ISR queue */
+static void bench_run_ring(void) {
+    pcm_ring_write(&bench_ring, bench_s16, 512);
+    bench_sink = pcm_ring_read(&bench_ring, bench_s16_out, 512);
+}
+
+static void bench_setup_sfx(void) {
+    bench_setup_signal();
+    sfx_init(&bench_sfx, 48000);
+}
+
+/* One 512-frame DMA block with no UI sound playing */
+static void bench_run_sfx_idle(void) {
+    bench_sink = sfx_mix(&bench_sfx, bench_s16, 512);
+}
+
+/* Four confirmation tones (IMA, interpolated 44.1k -> 48k) over one block */
+static void bench_run_sfx_4_voices(void) {
+    for (uint32_t i = 0; i < SFX_VOICES; i++) {
+        sfx_voice_start(sfx_voice_claim(&bench_sfx, &sfx_clips[SFX_CONFIRM]));
+    }
+    bench_sink = sfx_mix(&bench_sfx, bench_s16, 512);
+}
+
+/* ============ Decoder kernels ============ */
+
+/* One stereo 1024-byte IMA block (1017 frames) encoded from the test signal */
+static void bench_setup_ima(void) {
+    adpcm_ima_state_t state[ADPCM_IMA_MAX_CHANNELS];
+    bench_setup_signal();
+    memset(state, 0, sizeof(state));
+    adpcm_ima_encode_block(state, bench_s16, 2, bench_adpcm_block, BENCH_ADPCM_BLOCK);
+    bench_adpcm_frames = adpcm_ima_block_frames(BENCH_ADPCM_BLOCK, 2);
+}
+
+static void bench_run_ima(void) {
+    adpcm_ima_state_t state[ADPCM_IMA_MAX_CHANNELS];
+    adpcm_ima_decode(state, bench_adpcm_block, 2, 0, bench_adpcm_frames, bench_s16_out);
+    bench_sink = (uint32_t)bench_s16_out[7];
+}
+
+/* Stereo 1024-byte MS block (1012 frames): predictor 1, random codes */
+static void bench_setup_ms(void) {
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < BENCH_ADPCM_BLOCK; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        bench_adpcm_block[i] = (uint8_t)(seed >> 24);
+    }
+    memset(bench_adpcm_block, 0, 14);
+    bench_adpcm_block[0] = bench_adpcm_block[1] = 1;
+    bench_adpcm_block[2] = bench_adpcm_block[4] = 64;
+    bench_adpcm_frames = adpcm_ms_block_frames(BENCH_ADPCM_BLOCK, 2);
+}
+
+static void bench_run_ms(void) {
+    adpcm_ms_state_t state[ADPCM_MS_MAX_CHANNELS];
+    adpcm_ms_decode(state, bench_adpcm_block, 2, 0, bench_adpcm_frames, bench_s16_out);
+    bench_sink = (uint32_t)bench_s16_out[7];
+}
+
+/* ============ Display kernels ============ */
+
+static void bench_run_fill_span(void) {
+    static uint8_t line[240 * 2];
+    lcd_render_fill_span(line, 0x0320, 240);
+    bench_sink = line[5];
+}
+
+static void bench_run_glyph_1x(void) {
+    for (char c = 'A'; c < 'A' + 16; c++) {
+        lcd_render_glyph(bench_pixels, LCD_CHAR_WIDTH, c, 0xFFFF, 0x0000, 1);
+    }
+    bench_sink = bench_pixels[9];
+}
+
+static void bench_run_glyph_2x(void) {
+    for (char c = 'A'; c < 'A' + 16; c++) {
+        lcd_render_glyph(bench_pixels, LCD_CHAR_WIDTH * 2, c, 0xFFFF, 0x0000, 2);
+    }
+    bench_sink = bench_pixels[9];
+}
+
+const bench_kernel_t bench_kernels[] = {
+    {"s16_to_q31",        "sample", BENCH_SAMPLES, bench_setup_signal,    bench_run_s16_to_q31, 0,     0},
+    {"gain_s16",          "sample", BENCH_SAMPLES, bench_setup_signal,    bench_run_gain_s16,   0,     0},
+    {"gain_q31",          "sample", BENCH_SAMPLES, bench_setup_signal,    bench_run_gain_q31,   0,     0},
+    {"biquad_q31",        "frame",  BENCH_FRAMES,  bench_setup_biquad,    bench_run_biquad,     0,     0},
+    {"loudcomp_q31",      "frame",  BENCH_FRAMES,  bench_setup_loudcomp,  bench_run_loudcomp,   48000, 3.0f},
+    {"crossfeed_q31",     "frame",  BENCH_FRAMES,  bench_setup_crossfeed, bench_run_crossfeed,  48000, 3.0f},
+    {"limiter_drc_q31",   "frame",  BENCH_FRAMES,  bench_setup_limiter,   bench_run_limiter,    48000, 4.0f},
+    {"dither_q31_to_s16", "sample", BENCH_SAMPLES, bench_setup_signal,    bench_run_dither,     0,     0},
+    {"src_48k_to_44k1",   "frame",  BENCH_FRAMES,  bench_setup_src_48k,   bench_run_resample,   0,     0},
+    {"src_22k05_to_44k1", "frame",  BENCH_FRAMES,  bench_setup_src_22k,   bench_run_resample,   0,     0},
+    {"wsola_1x5",         "frame",  BENCH_FRAMES,  bench_setup_wsola,     bench_run_wsola,      48000, 4.0f},
+    {"convolver_1024",    "frame",  BENCH_FRAMES,  bench_setup_convolver_1024, bench_run_convolver, 0, 0},
+    {"convolver_4096",    "frame",  BENCH_FRAMES,  bench_setup_convolver_4096, bench_run_convolver, 48000, 30.0f},
+    {"dsd64_to_q31",      "frame",  BENCH_FRAMES,  bench_setup_dsd,       bench_run_dsd,        44100, 40.0f},
+    {"fft_q31_256",       "point",  256,           bench_setup_fft,       bench_run_fft_256,    0,     0},
+    {"fft_q31_1024",      "point",  1024,          bench_setup_fft,       bench_run_fft_1024,   0,     0},
+    {"pcm_ring_block",    "frame",  512,           bench_setup_ring,      bench_run_ring,       0,     0},
+    {"sfx_idle",          "frame",  512,           bench_setup_sfx,       bench_run_sfx_idle,   0,     0},
+    {"sfx_4_voices",      "frame",  512,           bench_setup_sfx,       bench_run_sfx_4_voices, 0,   0},
+    {"adpcm_ima_stereo",  "frame",  1017,          bench_setup_ima,       bench_run_ima,        0,     0},
+    {"adpcm_ms_stereo",   "frame",  1012,          bench_setup_ms,        bench_run_ms,         0,     0},
+    {"lcd_fill_span",     "pixel",  240,           NULL,                  bench_run_fill_span,  0,     0},
+    {"lcd_glyph_1x",      "pixel",  16 * 6 * 8,    NULL,                  bench_run_glyph_1x,   0,     0},
+    {"lcd_glyph_2x",      "pixel",  16 * 12 * 16,  NULL,                  bench_run_glyph_2x,   0,     0},
+};
+
+const uint32_t bench_kernel_count = sizeof(bench_kernels) / sizeof(bench_kernels[0]);
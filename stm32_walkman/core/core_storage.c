@@ -0,0 +1,67 @@
+/**
+ * Walkman Core Library - Host Storage
+ * storage.h over stdio with host paths used as given (no card root)
+ */
+
+#include "storage.h"
+#include <stdio.h>
+#include <sys/stat.h>
+
+int storage_init(void) {
+    return STORAGE_OK;
+}
+
+int storage_open(storage_file_t* file, const char* path) {
+    struct stat st;
+
+    if (file == NULL || path == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return STORAGE_ERROR_NO_FILE;
+    }
+    if (fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > UINT32_MAX) {
+        fclose(f);
+        return STORAGE_ERROR;
+    }
+
+    file->handle = f;
+    file->size = (uint32_t)st.st_size;
+    file->pos = 0;
+    return STORAGE_OK;
+}
+
+int32_t storage_read(storage_file_t* file, void* buffer, uint32_t len) {
+    if (file == NULL || file->handle == NULL) {
+        return -1;
+    }
+
+    size_t n = fread(buffer, 1, len, (FILE*)file->handle);
+    if (n == 0 && ferror((FILE*)file->handle)) {
+        return -1;
+    }
+
+    file->pos += (uint32_t)n;
+    return (int32_t)n;
+}
+
+int storage_seek(storage_file_t* file, uint32_t offset) {
+    if (file == NULL || file->handle == NULL ||
+        fseek((FILE*)file->handle, offset, SEEK_SET) != 0) {
+        return STORAGE_ERROR;
+    }
+
+    file->pos = offset;
+    return STORAGE_OK;
+}
+
+void storage_close(storage_file_t* file) {
+    if (file == NULL || file->handle == NULL) {
+        return;
+    }
+
+    fclose((FILE*)file->handle);
+    file->handle = NULL;
+}
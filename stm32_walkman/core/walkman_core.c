@@ -0,0 +1,222 @@
+/**
+ * Walkman Core Library Implementation
+ * Wraps decoder.h, resample.h, dsp.h and shuffle.h behind the C ABI
+ */
+
+#include "walkman_core.h"
+#include "decoder.h"
+#include "resample.h"
+#include "dsp.h"
+#include "shuffle.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Frames decoded per pass ahead of the resampler */
+#define WM_DECODE_CHUNK 1024
+
+struct wm_stream {
+    decoder_t decoder;
+    resample_t resampler;
+    uint8_t resampling;
+    uint32_t output_rate;
+    int32_t gain_q16;
+
+    /* Decoded frames the resampler has not taken yet */
+    int16_t input[WM_DECODE_CHUNK * 2];
+    uint32_t input_pos;
+    uint32_t input_count;
+
+    /* Output position: frames produced since the last seek */
+    uint32_t base_ms;
+    uint64_t produced;
+};
+
+static void wm_fill_info(const decoder_t* dec, wm_info_t* info) {
+    memset(info, 0, sizeof(*info));
+    strncpy(info->codec, dec->ops->name, sizeof(info->codec) - 1);
+    info->sample_rate = dec->sample_rate;
+    info->channels = dec->channels;
+    info->bits_per_sample = dec->bits_per_sample;
+    info->total_frames = dec->total_frames;
+    info->duration_ms = (uint32_t)((uint64_t)dec->total_frames * 1000u / dec->sample_rate);
+    memcpy(info->title, dec->title, WM_TAG_LEN);
+    memcpy(info->artist, dec->artist, WM_TAG_LEN);
+    memcpy(info->album, dec->album, WM_TAG_LEN);
+    info->title[WM_TAG_LEN - 1] = '\0';
+    info->artist[WM_TAG_LEN - 1] = '\0';
+    info->album[WM_TAG_LEN - 1] = '\0';
+    info->replay_gain = dec->replay_gain;
+    info->replay_peak = dec->replay_peak;
+}
+
+uint32_t wm_abi_version(void) {
+    return WM_ABI_VERSION;
+}
+
+/**
+ * Opening a decoder parses the container and stops at the first audio
+ * byte, so a probe reads a few hundred bytes whatever the file size
+ */
+int wm_probe(const char* path, wm_info_t* info) {
+    decoder_t* dec;
+    int status;
+
+    if (path == NULL || info == NULL) {
+        return WM_ERROR_ARGUMENT;
+    }
+
+    dec = malloc(sizeof(*dec));
+    if (dec == NULL) {
+        return WM_ERROR;
+    }
+
+    status = decoder_open(dec, path);
+    if (status == DECODER_OK) {
+        wm_fill_info(dec, info);
+        decoder_close(dec);
+    }
+    free(dec);
+    return status;
+}
+
+wm_stream_t* wm_open(const char* path, uint32_t output_rate, int* status) {
+    wm_stream_t* stream;
+    int result;
+
+    if (path == NULL) {
+        if (status) *status = WM_ERROR_ARGUMENT;
+        return NULL;
+    }
+
+    stream = calloc(1, sizeof(*stream));
+    if (stream == NULL) {
+        if (status) *status = WM_ERROR;
+        return NULL;
+    }
+
+    result = decoder_open(&stream->decoder, path);
+    if (result == DECODER_OK && output_rate != 0 && output_rate != stream->decoder.sample_rate) {
+        if (resample_init(&stream->resampler, stream->decoder.sample_rate, output_rate) == RESAMPLE_OK) {
+            stream->resampling = 1;
+        } else {
+            decoder_close(&stream->decoder);
+            result = WM_ERROR_UNSUPPORTED;
+        }
+    }
+    if (result != DECODER_OK) {
+        free(stream);
+        if (status) *status = result;
+        return NULL;
+    }
+
+    stream->output_rate = stream->resampling ? output_rate : stream->decoder.sample_rate;
+    stream->gain_q16 = DSP_GAIN_UNITY;
+    if (status) *status = WM_OK;
+    return stream;
+}
+
+/**
+ * Decode and resample, as player.c does on the target
+ */
+static uint32_t wm_read_resampled(wm_stream_t* stream, int16_t* out, uint32_t frames) {
+    uint32_t produced = 0;
+
+    while (produced < frames) {
+        if (stream->input_pos >= stream->input_count) {
+            stream->input_count = decoder_read(&stream->decoder, stream->input, WM_DECODE_CHUNK);
+            stream->input_pos = 0;
+            if (stream->input_count == 0) {
+                produced += resample_flush(&stream->resampler, &out[produced * 2], frames - produced);
+                break;
+            }
+        }
+
+        uint32_t consumed = 0;
+        produced += resample_process(&stream->resampler,
+                                     &stream->input[stream->input_pos * 2],
+                                     stream->input_count - stream->input_pos, &consumed,
+                                     &out[produced * 2], frames - produced);
+        stream->input_pos += consumed;
+    }
+    return produced;
+}
+
+uint32_t wm_read(wm_stream_t* stream, int16_t* out, uint32_t frames) {
+    uint32_t done = 0;
+
+    if (stream == NULL || out == NULL) {
+        return 0;
+    }
+
+    if (stream->resampling) {
+        done = wm_read_resampled(stream, out, frames);
+    } else {
+        while (done < frames) {
+            uint32_t n = decoder_read(&stream->decoder, &out[done * 2], frames - done);
+            if (n == 0) break;
+            done += n;
+        }
+    }
+
+    if (stream->gain_q16 != DSP_GAIN_UNITY) {
+        dsp_gain_s16(out, done * 2, stream->gain_q16);
+    }
+    stream->produced += done;
+    return done;
+}
+
+int wm_seek_ms(wm_stream_t* stream, uint32_t position_ms) {
+    if (stream == NULL) {
+        return WM_ERROR_ARGUMENT;
+    }
+
+    uint32_t frame = (uint32_t)((uint64_t)position_ms * stream->decoder.sample_rate / 1000u);
+    int status = decoder_seek(&stream->decoder, frame);
+    if (status != DECODER_OK) {
+        return status;
+    }
+
+    if (stream->resampling) {
+        resample_reset(&stream->resampler);
+    }
+    stream->input_pos = 0;
+    stream->input_count = 0;
+    stream->base_ms = (uint32_t)((uint64_t)stream->decoder.frame_pos * 1000u / stream->decoder.sample_rate);
+    stream->produced = 0;
+    return WM_OK;
+}
+
+uint32_t wm_position_ms(const wm_stream_t* stream) {
+    if (stream == NULL) {
+        return 0;
+    }
+    return stream->base_ms + (uint32_t)(stream->produced * 1000u / stream->output_rate);
+}
+
+int wm_get_info(const wm_stream_t* stream, wm_info_t* info) {
+    if (stream == NULL || info == NULL) {
+        return WM_ERROR_ARGUMENT;
+    }
+    wm_fill_info(&stream->decoder, info);
+    return WM_OK;
+}
+
+void wm_set_gain_db(wm_stream_t* stream, float db) {
+    if (stream != NULL) {
+        stream->gain_q16 = dsp_gain_from_db(db);
+    }
+}
+
+void wm_close(wm_stream_t* stream) {
+    if (stream == NULL) {
+        return;
+    }
+    decoder_close(&stream->decoder);
+    free(stream);
+}
+
+void wm_shuffle_order(uint32_t seed, uint16_t* order, uint16_t count) {
+    if (order != NULL) {
+        shuffle_order(seed, order, count);
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * Walkman Core Library - C ABI
+ *
+ * The firmware's portable playback core built as a Linux shared library
+ * (libwalkman_core.so) for the Dragonboard player: format probing, tags,
+ * the WAV/WNF decoders, sample rate conversion, gain and the shuffle
+ * engine. The ABI uses only fixed-size integers, char arrays and opaque
+ * handles so ctypes can bind it without a compiler.
+ *
+ * Paths are host paths. Handles are independent, so separate streams may
+ * be used from separate threads; one handle must not be shared.
+ */
+
+#ifndef __WALKMAN_CORE_H
+#define __WALKMAN_CORE_H
+
+#include <stdint.h>
+
+#define WM_API __attribute__((visibility("default")))
+
+/* Bumped whenever a struct layout or signature below changes */
+#define WM_ABI_VERSION 1
+
+#define WM_TAG_LEN 64
+
+/* Status codes (match decoder_status_t) */
+typedef enum {
+    WM_OK = 0,
+    WM_ERROR = 1,
+    WM_ERROR_NO_FILE = 2,
+    WM_ERROR_UNSUPPORTED = 3,
+    WM_ERROR_ARGUMENT = 4
+} wm_status_t;
+
+/* Stream description, filled from the file headers alone */
+typedef struct {
+    char codec[8];              // Backend name ("wav", "wnf")
+    uint32_t sample_rate;
+    uint32_t channels;          // Channels in the file (output is always stereo)
+    uint32_t bits_per_sample;   // Coded bits (4 for ADPCM)
+    uint32_t total_frames;      // 0 if unknown
+    uint32_t duration_ms;
+    char title[WM_TAG_LEN];     // Empty if the file has no tags
+    char artist[WM_TAG_LEN];
+    char album[WM_TAG_LEN];
+    int32_t replay_gain;        // Track gain in 0.01 dB
+    uint32_t replay_peak;       // Q15, 32768 = full scale
+} wm_info_t;
+
+typedef struct wm_stream wm_stream_t;
+
+WM_API uint32_t wm_abi_version(void);
+
+/* Parse the headers of a file without decoding any audio */
+WM_API int wm_probe(const char* path, wm_info_t* info);
+
+/* Open a file for decoding; output_rate 0 keeps the file's rate, any other
+ * rate runs the firmware's resampler. Returns NULL with *status set. */
+WM_API wm_stream_t* wm_open(const char* path, uint32_t output_rate, int* status);
+
+/* Decode up to frames interleaved stereo s16 frames; 0 at end of stream */
+WM_API uint32_t wm_read(wm_stream_t* stream, int16_t* out, uint32_t frames);
+
+/* Frame-exact seek; positions past the end clamp to the end */
+WM_API int wm_seek_ms(wm_stream_t* stream, uint32_t position_ms);
+
+/* Position of the next frame wm_read() returns */
+WM_API uint32_t wm_position_ms(const wm_stream_t* stream);
+
+WM_API int wm_get_info(const wm_stream_t* stream, wm_info_t* info);
+
+/* Output gain in dB (saturating, +42 dB max); 0 dB = bit-exact */
+WM_API void wm_set_gain_db(wm_stream_t* stream, float db);
+
+WM_API void wm_close(wm_stream_t* stream);
+
+/* Shuffle order of count tracks, identical to the firmware's for a seed */
+WM_API void wm_shuffle_order(uint32_t seed, uint16_t* order, uint16_t count);
+
+#endif /* __WALKMAN_CORE_H */
@@ -0,0 +1,108 @@
+/**
+ * Bare Metal DMA Stream Manager - STM32F407
+ * Allocates DMA1/DMA2 streams and channels to peripheral requests
+ *
+ * Each request can be served by one or two fixed stream/channel pairs
+ * (RM0090 tables 42 and 43). Drivers claim their stream at init: a request
+ * whose streams are all taken fails with DMA_ERROR_CONFLICT instead of two
+ * drivers silently reprogramming the same stream.
+ */
+
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#include <stdint.h>
+
+/* Peripheral requests */
+typedef enum {
+    DMA_REQUEST_SPI3_TX = 0,    // I2S3 audio: DMA1 stream 5 or 7, channel 0
+    DMA_REQUEST_SDIO,           // SD card: DMA2 stream 3 or 6, channel 4
+    DMA_REQUEST_SPI5_TX,        // LCD: DMA2 stream 4 channel 2, stream 6 channel 7
+    DMA_REQUEST_SPI1_TX,        // DMA2 stream 3 or 5, channel 3
+    DMA_REQUEST_SPI2_TX,        // DMA1 stream 4, channel 0
+    DMA_REQUEST_COUNT
+} dma_request_t;
+
+/* Stream priority (arbitration between streams of one controller) */
+typedef enum {
+    DMA_PRIORITY_LOW = 0,
+    DMA_PRIORITY_MEDIUM = 1,
+    DMA_PRIORITY_HIGH = 2,
+    DMA_PRIORITY_VERY_HIGH = 3
+} dma_priority_t;
+
+typedef enum {
+    DMA_DIR_PERIPH_TO_MEM = 0,
+    DMA_DIR_MEM_TO_PERIPH = 1
+} dma_direction_t;
+
+/* DMA status */
+typedef enum {
+    DMA_OK = 0,
+    DMA_ERROR = 1,
+    DMA_ERROR_CONFLICT = 2,     // Every stream of the request is taken
+    DMA_ERROR_ARGUMENT = 3
+} dma_status_t;
+
+/* Interrupt / status flags, stream-independent (DMA_FLAG_*) */
+#define DMA_FLAG_FE   (1u << 0)     // FIFO error
+#define DMA_FLAG_DME  (1u << 2)     // Direct mode error
+#define DMA_FLAG_TE   (1u << 3)     // Transfer error (stream disabled)
+#define DMA_FLAG_HT   (1u << 4)     // Half transfer
+#define DMA_FLAG_TC   (1u << 5)     // Transfer complete
+#define DMA_FLAG_ALL  (DMA_FLAG_FE | DMA_FLAG_DME | DMA_FLAG_TE | DMA_FLAG_HT | DMA_FLAG_TC)
+
+/* Stream configuration */
+typedef struct {
+    dma_request_t request;
+    dma_priority_t priority;
+    dma_direction_t direction;
+    uint8_t item_size;          // Bytes per item, memory and peripheral (1, 2, 4)
+    uint8_t circular;
+    uint8_t fifo;               // FIFO with 4-beat memory bursts (else direct mode)
+    uint8_t periph_burst;       // 4-beat peripheral bursts (SDIO FIFO)
+    uint8_t periph_flow;        // Peripheral ends the transfer (SDIO)
+    uint8_t interrupts;         // DMA_FLAG_* to raise the stream interrupt
+    uint8_t irq_priority;       // NVIC priority (0 = highest)
+} dma_config_t;
+
+/* A claimed stream and its counters (updated by dma_irq_ack) */
+typedef struct {
+    uint8_t controller;         // 1 or 2
+    uint8_t stream;             // 0-7
+    uint8_t channel;
+    dma_config_t config;
+    volatile uint32_t transfers;        // Completed transfers (TC)
+    volatile uint32_t fifo_errors;      // FIFO under/overruns (FE)
+    volatile uint32_t transfer_errors;  // Bus errors (TE), stream stopped
+} dma_stream_t;
+
+/* Allocate a stream for the request and program it (disabled) */
+int dma_claim(const dma_config_t* config, dma_stream_t** stream);
+
+/* Stop the stream and return it to the pool */
+void dma_release(dma_stream_t* stream);
+
+/* Program addresses and item count, clear stale flags and enable.
+ * Memory bursts need an 8-byte aligned buffer and a multiple of 4 items;
+ * other buffers run single beats through the FIFO. */
+void dma_start(dma_stream_t* stream, uint32_t periph_address, const void* memory, uint32_t items);
+
+/* Disable the stream and wait until the hardware lets go */
+void dma_stop(dma_stream_t* stream);
+
+/* Items left in the current pass (NDTR) */
+uint32_t dma_remaining(const dma_stream_t* stream);
+
+/* Mask or unmask the stream's interrupt; flags raised while masked are
+ * served once it is unmasked */
+void dma_irq_mask(dma_stream_t* stream, uint8_t masked);
+
+/* Interrupt handler helper: read and clear the stream's flags, update the
+ * counters and return the flags (DMA_FLAG_*) */
+uint32_t dma_irq_ack(dma_stream_t* stream);
+
+/* Claimed stream by controller and number, NULL if free (diagnostics) */
+const dma_stream_t* dma_get_stream(uint8_t controller, uint8_t stream);
+
+#endif /* __DMA_H__ */
@@ -0,0 +1,39 @@
+/**
+ * Bare Metal Internal Flash Driver - STM32F407
+ * Sector erase and word programming of the 1 MB main bank
+ */
+
+#ifndef __FLASH_H__
+#define __FLASH_H__
+
+#include <stdint.h>
+
+/* Main memory: sectors 0-3 16 KB, 4 64 KB, 5-11 128 KB (RM0090 table 5) */
+#define FLASH_MEMORY_BASE   0x08000000u
+#define FLASH_MEMORY_SIZE   (1024u * 1024u)
+#define FLASH_SECTOR_COUNT  12
+
+/* Flash status */
+typedef enum {
+    FLASH_OK = 0,
+    FLASH_ERROR = 1,            // Programming / erase error flag (SR)
+    FLASH_ERROR_PROTECTED = 2,  // Write protected sector
+    FLASH_ERROR_TIMEOUT = 3,
+    FLASH_ERROR_ARGUMENT = 4    // Bad sector, misaligned or out of range
+} flash_status_t;
+
+/* Sector geometry */
+uint32_t flash_sector_address(uint8_t sector);
+uint32_t flash_sector_size(uint8_t sector);
+
+/* Erase one sector to 0xFF (16 KB: ~0.5 s, 128 KB: 1-2 s; the core
+ * stalls on instruction fetches from flash meanwhile) */
+int flash_erase_sector(uint8_t sector);
+
+/* Program len bytes (multiple of 4, word aligned) into erased memory */
+int flash_program(uint32_t address, const void* data, uint32_t len);
+
+/* Read len bytes (memory mapped on the target) */
+void flash_read(uint32_t address, void* data, uint32_t len);
+
+#endif /* __FLASH_H__ */
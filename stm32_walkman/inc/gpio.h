@@ -90,4 +90,11 @@ void gpio_write(gpio_port_t port, gpio_pin_t pin, uint8_t value);
 /* Configure external interrupt */
 void gpio_config_interrupt(gpio_port_t port, gpio_pin_t pin, gpio_int_trigger_t trigger);
 
+/* Set NVIC priority of the EXTI line serving a pin */
+void gpio_set_interrupt_priority(gpio_pin_t pin, uint8_t priority);
+
+/* Check/clear external interrupt pending flag */
+uint8_t gpio_exti_pending(gpio_pin_t pin);
+void gpio_exti_clear(gpio_pin_t pin);
+
 #endif /* __GPIO_H__ */
@@ -23,16 +23,42 @@ typedef enum {
     I2S_SR_96000 = 96000
 } i2s_sample_rate_t;
 
-/* Initialize I2S3 for audio streaming */
+/* DMA half-transfer callback: half = 0 when the first half of the buffer
+ * has been sent and may be refilled, 1 for the second half */
+typedef void (*i2s_callback_t)(uint8_t half);
+
+/* Initialize I2S3 for audio streaming (claims the TX DMA stream, see dma.h;
+ * on a stream conflict the I2S stays silent and i2s_start_dma() is a no-op) */
 void i2s_init(i2s_sample_rate_t sample_rate);
 
-/* Start I2S streaming via DMA */
+/* Register the half/complete transfer callback (called from DMA ISR) */
+void i2s_set_callback(i2s_callback_t callback);
+
+/* Start I2S streaming via circular (double-buffered) DMA */
 void i2s_start_dma(const int16_t* buffer, uint32_t samples);
 
 /* Stop I2S streaming */
 void i2s_stop(void);
 
+/* Pause/resume the DMA stream without losing the buffer position */
+void i2s_pause(void);
+void i2s_resume(void);
+
+/* Samples of the buffer already fetched in the current pass, i.e. the index
+ * the DMA reads next (the FIFO holds up to 4 more words ahead of the pins) */
+uint32_t i2s_get_position(void);
+
+/* Hold back the half/complete callback while the buffer is patched in
+ * place; a half completed meanwhile is reported on release */
+void i2s_hold_callback(uint8_t hold);
+
 /* Check if DMA transfer complete */
 uint8_t i2s_dma_complete(void);
 
+/* DMA transfer errors since boot (the stream stops on each one) */
+uint32_t i2s_get_errors(void);
+
+/* DMA FIFO errors since boot (a request found the FIFO empty) */
+uint32_t i2s_get_fifo_errors(void);
+
 #endif /* __I2S_H__ */
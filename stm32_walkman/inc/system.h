@@ -13,12 +13,23 @@
 #define APB1_CLOCK_HZ       42000000   /* 42 MHz */
 #define APB2_CLOCK_HZ       84000000   /* 84 MHz */
 
+/* RAM regions. Only the main SRAM is reachable by DMA; SYSTEM_CCM places
+ * CPU-only state in the core-coupled RAM (the linker script's .ccmram
+ * output section). The startup code neither copies nor clears .ccmram, so
+ * its users initialize what they put there. */
+#define SYSTEM_SRAM_SIZE    (128 * 1024)  /* 0x20000000 */
+#define SYSTEM_CCM_SIZE     (64 * 1024)   /* 0x10000000 */
+#define SYSTEM_CCM          __attribute__((section(".ccmram")))
+
 /* Tick frequency */
 #define TICK_FREQ_HZ        1000       /* 1ms ticks */
 
 /* Initialize system */
 void system_init(void);
 
+/* Start the 1ms SysTick interrupt */
+void system_tick_start(void);
+
 /* Get system tick in milliseconds */
 uint32_t system_get_tick(void);
 
@@ -28,4 +39,11 @@ void system_delay_ms(uint32_t ms);
 /* Delay in microseconds */
 void system_delay_us(uint32_t us);
 
+/* Sleep until the next interrupt (SysTick wakes the core every 1ms) */
+void system_idle(void);
+
+/* Free-running CPU cycle counter (DWT CYCCNT) for profiling */
+void system_cycles_init(void);
+uint32_t system_get_cycles(void);
+
 #endif /* __SYSTEM_H__ */
@@ -0,0 +1,546 @@
+/**
+ * Linux Playback Engine Implementation
+ *
+ * Threads and what they share:
+ * - The decode thread and the control calls (walkmand) serialize on
+ *   engine.lock: streams, queued track and markers are only touched with
+ *   it held. The mutex inherits priority, so the real-time decode thread
+ *   never waits behind a preempted control thread.
+ * - The output thread takes no lock. It reads the ring (tail side), and
+ *   the pause flag, gain and flush requests are single words written with
+ *   atomics. It publishes the playing ring frame under a sequence counter.
+ */
+
+#include "engine.h"
+#include "pcm_ring.h"
+#include "walkman_core.h"
+#include "dsp.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#define ENGINE_DECODE_CHUNK 2048    // Max frames per decoder call
+#define ENGINE_DECODE_MIN   512     // Free frames before the decoder runs
+#define ENGINE_MARKERS      8
+#define ENGINE_SEGMENTS     32
+
+/* SCHED_FIFO priorities: output above decode, both above normal threads */
+#define ENGINE_OUTPUT_PRIORITY 70
+#define ENGINE_DECODE_PRIORITY 60
+
+/* Track start in the ring (track_id 0 = end of the queue) */
+typedef struct {
+    uint32_t start;             // Ring frame of the track's first frame
+    uint32_t track_id;
+    uint64_t base;              // Track position of that frame (seeks)
+} engine_marker_t;
+
+/* Run of device frames with one source: consecutive ring frames or silence */
+typedef struct {
+    uint64_t device_start;
+    uint32_t ring_start;        // Silence: the ring frame that plays next
+    uint8_t silent;
+} engine_segment_t;
+
+/* Playing position published by the output thread */
+typedef struct {
+    volatile uint32_t sequence; // Odd while being written
+    uint32_t ring_frame;        // Ring frame at the DAC at time_ns
+    uint32_t ring_ahead;        // Consecutive ring frames queued after it
+    uint8_t silent;
+    uint64_t time_ns;
+} engine_clock_t;
+
+static struct {
+    pcm_out_t out;
+    pcm_ring_t ring;
+    int16_t ring_buffer[ENGINE_RING_FRAMES * 2];
+
+    pthread_t decode_thread;
+    pthread_t output_thread;
+    pthread_mutex_t lock;
+    sem_t space;                // Posted by the output thread per period
+    volatile uint8_t running;
+
+    /* Under lock */
+    wm_stream_t* stream;        // Track being decoded
+    uint32_t stream_id;
+    wm_stream_t* queued;
+    uint32_t queued_id;
+    engine_marker_t markers[ENGINE_MARKERS];
+    uint32_t marker_count;      // markers[0] is the track at the DAC
+    uint8_t started;            // markers[0] has been announced
+
+    /* Shared with the output thread (atomics) */
+    uint8_t paused;
+    uint8_t decoding;           // A stream is open: a starved period is an underrun
+    int32_t gain_q16;
+    uint32_t flush_generation;
+    uint32_t flush_target;
+    uint32_t underruns;
+
+    engine_clock_t clock;
+} engine;
+
+/* ============ Output thread ============ */
+
+static uint64_t engine_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Segments of the device timeline still queued in the device
+ */
+typedef struct {
+    engine_segment_t list[ENGINE_SEGMENTS];
+    uint32_t count;
+    uint64_t written;           // Device frames committed
+} engine_timeline_t;
+
+static void engine_timeline_append(engine_timeline_t* tl, uint32_t ring_start, uint8_t silent) {
+    if (tl->count > 0) {
+        engine_segment_t* last = &tl->list[tl->count - 1];
+        uint32_t next = last->silent ? last->ring_start :
+                        last->ring_start + (uint32_t)(tl->written - last->device_start);
+        if (last->silent == silent && next == ring_start) {
+            return;  /* Continues the last segment */
+        }
+    }
+    if (tl->count == ENGINE_SEGMENTS) {
+        memmove(&tl->list[0], &tl->list[1], (ENGINE_SEGMENTS - 1) * sizeof(tl->list[0]));
+        tl->count--;
+    }
+    tl->list[tl->count].device_start = tl->written;
+    tl->list[tl->count].ring_start = ring_start;
+    tl->list[tl->count].silent = silent;
+    tl->count++;
+}
+
+/**
+ * Publish the ring frame at the DAC and forget segments already heard
+ */
+static void engine_timeline_publish(engine_timeline_t* tl, uint32_t delay) {
+    uint64_t heard = tl->written > delay ? tl->written - delay : 0;
+    uint32_t i = tl->count;
+
+    while (i > 1 && tl->list[i - 1].device_start > heard) i--;
+    if (i > 1) {
+        memmove(&tl->list[0], &tl->list[i - 1], (tl->count - i + 1) * sizeof(tl->list[0]));
+        tl->count -= i - 1;
+    }
+
+    const engine_segment_t* seg = &tl->list[0];
+    uint64_t seg_end = tl->count > 1 ? tl->list[1].device_start : tl->written;
+    uint32_t ring_frame = seg->silent ? seg->ring_start :
+                          seg->ring_start + (uint32_t)(heard - seg->device_start);
+
+    __atomic_add_fetch(&engine.clock.sequence, 1, __ATOMIC_ACQ_REL);
+    engine.clock.ring_frame = ring_frame;
+    engine.clock.ring_ahead = seg->silent ? 0 : (uint32_t)(seg_end - heard);
+    engine.clock.silent = seg->silent;
+    engine.clock.time_ns = engine_now_ns();
+    __atomic_add_fetch(&engine.clock.sequence, 1, __ATOMIC_ACQ_REL);
+}
+
+static void* engine_output_main(void* arg) {
+    engine_timeline_t timeline = {0};
+    uint32_t flush_seen = 0;
+    uint8_t primed = 0;         // Audio has flowed since the last flush
+    (void)arg;
+
+    engine_timeline_append(&timeline, 0, 1);
+
+    while (engine.running) {
+        uint32_t frames = 0;
+        int16_t* area = engine.out.ops->begin(&engine.out, &frames);
+        if (area == NULL) {
+            fprintf(stderr, "[engine] output failed, stopping\n");
+            engine.running = 0;
+            break;
+        }
+
+        /* Consumer side of a flush: skip what was queued before it */
+        uint32_t generation = __atomic_load_n(&engine.flush_generation, __ATOMIC_ACQUIRE);
+        if (generation != flush_seen) {
+            uint32_t target = __atomic_load_n(&engine.flush_target, __ATOMIC_ACQUIRE);
+            if ((int32_t)(target - engine.ring.tail) > 0) {
+                engine.ring.tail = target;
+            }
+            flush_seen = generation;
+            primed = 0;
+        }
+
+        uint32_t first = engine.ring.tail;
+        uint32_t n = 0;
+        if (!__atomic_load_n(&engine.paused, __ATOMIC_ACQUIRE)) {
+            n = pcm_ring_read(&engine.ring, area, frames);
+        }
+        if (n > 0) {
+            primed = 1;
+        }
+        if (n < frames) {
+            memset(&area[n * 2], 0, (frames - n) * 2 * sizeof(int16_t));
+            if (primed && !engine.paused && __atomic_load_n(&engine.decoding, __ATOMIC_ACQUIRE)) {
+                __atomic_add_fetch(&engine.underruns, 1, __ATOMIC_RELAXED);
+            }
+        }
+
+        int32_t gain = __atomic_load_n(&engine.gain_q16, __ATOMIC_RELAXED);
+        if (n > 0 && gain != DSP_GAIN_UNITY) {
+            dsp_gain_s16(area, n * 2, gain);
+        }
+
+        if (n > 0) {
+            engine_timeline_append(&timeline, first, 0);
+            timeline.written += n;
+        }
+        if (n < frames) {
+            engine_timeline_append(&timeline, first + n, 1);
+            timeline.written += frames - n;
+        }
+
+        if (engine.out.ops->commit(&engine.out, frames) != PCM_OUT_OK) {
+            fprintf(stderr, "[engine] output commit failed, stopping\n");
+            engine.running = 0;
+            break;
+        }
+        sem_post(&engine.space);
+
+        engine_timeline_publish(&timeline, engine.out.ops->delay(&engine.out));
+    }
+
+    sem_post(&engine.space);
+    return NULL;
+}
+
+/* ============ Decode thread ============ */
+
+static void engine_push_marker(uint32_t track_id, uint64_t base) {
+    if (engine.marker_count == ENGINE_MARKERS) {
+        /* Many tracks shorter than the ring: lose the oldest */
+        memmove(&engine.markers[0], &engine.markers[1],
+                (ENGINE_MARKERS - 1) * sizeof(engine.markers[0]));
+        engine.marker_count--;
+        engine.started = 0;
+    }
+    engine.markers[engine.marker_count].start = engine.ring.head;
+    engine.markers[engine.marker_count].track_id = track_id;
+    engine.markers[engine.marker_count].base = base;
+    engine.marker_count++;
+}
+
+/**
+ * End of stream: continue with the queued track at the next ring frame
+ */
+static void engine_next_stream(void) {
+    wm_close(engine.stream);
+    engine.stream = engine.queued;
+    engine.stream_id = engine.queued_id;
+    engine.queued = NULL;
+    engine.queued_id = 0;
+
+    engine_push_marker(engine.stream != NULL ? engine.stream_id : 0, 0);
+    __atomic_store_n(&engine.decoding, engine.stream != NULL, __ATOMIC_RELEASE);
+}
+
+static void* engine_decode_main(void* arg) {
+    (void)arg;
+
+    while (engine.running) {
+        uint8_t progress = 0;
+
+        pthread_mutex_lock(&engine.lock);
+        if (engine.stream != NULL && pcm_ring_space(&engine.ring) >= ENGINE_DECODE_MIN) {
+            uint32_t contiguous;
+            int16_t* dst = pcm_ring_write_ptr(&engine.ring, &contiguous);
+            if (contiguous > ENGINE_DECODE_CHUNK) contiguous = ENGINE_DECODE_CHUNK;
+
+            uint32_t n = wm_read(engine.stream, dst, contiguous);
+            if (n > 0) {
+                pcm_ring_commit(&engine.ring, n);
+            } else {
+                engine_next_stream();
+            }
+            progress = 1;
+        }
+        pthread_mutex_unlock(&engine.lock);
+
+        if (!progress) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += 100 * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            sem_timedwait(&engine.space, &ts);
+        }
+    }
+    return NULL;
+}
+
+/* ============ Control side ============ */
+
+static int engine_start_thread(pthread_t* thread, void* (*main)(void*), int priority) {
+    pthread_attr_t attr;
+    struct sched_param param = {.sched_priority = priority};
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    int err = pthread_create(thread, &attr, main, NULL);
+    pthread_attr_destroy(&attr);
+
+    if (err == EPERM) {
+        fprintf(stderr, "[engine] no real-time priority permitted, using SCHED_OTHER\n");
+        err = pthread_create(thread, NULL, main, NULL);
+    }
+    return err == 0 ? ENGINE_OK : ENGINE_ERROR;
+}
+
+int engine_init(const char* device, uint32_t rate, uint32_t period_frames,
+                uint32_t periods) {
+    pthread_mutexattr_t attr;
+
+    if (pcm_out_open(&engine.out, device, rate, period_frames, periods) != PCM_OUT_OK) {
+        return ENGINE_ERROR;
+    }
+
+    /* Keep the ring and thread stacks out of swap */
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        fprintf(stderr, "[engine] mlockall failed, pages may fault during playback\n");
+    }
+
+    pcm_ring_init(&engine.ring, engine.ring_buffer, ENGINE_RING_FRAMES);
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&engine.lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    sem_init(&engine.space, 0, 0);
+    engine.gain_q16 = DSP_GAIN_UNITY;
+    engine.running = 1;
+
+    if (engine_start_thread(&engine.output_thread, engine_output_main, ENGINE_OUTPUT_PRIORITY) != ENGINE_OK) {
+        engine.out.ops->close(&engine.out);
+        return ENGINE_ERROR;
+    }
+    if (engine_start_thread(&engine.decode_thread, engine_decode_main, ENGINE_DECODE_PRIORITY) != ENGINE_OK) {
+        engine.running = 0;
+        pthread_join(engine.output_thread, NULL);
+        engine.out.ops->close(&engine.out);
+        return ENGINE_ERROR;
+    }
+    return ENGINE_OK;
+}
+
+void engine_shutdown(void) {
+    engine.running = 0;
+    sem_post(&engine.space);
+    pthread_join(engine.decode_thread, NULL);
+    pthread_join(engine.output_thread, NULL);
+
+    wm_close(engine.stream);
+    wm_close(engine.queued);
+    engine.stream = NULL;
+    engine.queued = NULL;
+    engine.out.ops->close(&engine.out);
+}
+
+static wm_stream_t* engine_open_stream(const char* path, int* status) {
+    int result;
+    wm_stream_t* stream = wm_open(path, engine.out.rate, &result);
+    *status = result == WM_OK ? ENGINE_OK :
+              result == WM_ERROR_NO_FILE ? ENGINE_ERROR_NO_FILE :
+              result == WM_ERROR_UNSUPPORTED ? ENGINE_ERROR_UNSUPPORTED : ENGINE_ERROR;
+    return stream;
+}
+
+/**
+ * Drop everything queued in the ring (lock held, so the decoder is idle)
+ */
+static void engine_flush(void) {
+    __atomic_store_n(&engine.flush_target, engine.ring.head, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&engine.flush_generation, 1, __ATOMIC_RELEASE);
+    engine.marker_count = 0;
+    engine.started = 0;
+}
+
+int engine_play(const char* path, uint32_t track_id) {
+    int status;
+    wm_stream_t* stream = engine_open_stream(path, &status);
+    if (stream == NULL) {
+        return status;
+    }
+
+    pthread_mutex_lock(&engine.lock);
+    wm_close(engine.stream);
+    wm_close(engine.queued);
+    engine.stream = stream;
+    engine.stream_id = track_id;
+    engine.queued = NULL;
+    engine.queued_id = 0;
+    engine_flush();
+    engine_push_marker(track_id, 0);
+    __atomic_store_n(&engine.decoding, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&engine.paused, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&engine.lock);
+
+    sem_post(&engine.space);
+    return ENGINE_OK;
+}
+
+int engine_queue(const char* path, uint32_t track_id) {
+    int status;
+    wm_stream_t* stream = engine_open_stream(path, &status);
+    if (stream == NULL) {
+        return status;
+    }
+
+    pthread_mutex_lock(&engine.lock);
+    if (engine.stream == NULL && engine.marker_count > 0 &&
+        engine.markers[engine.marker_count - 1].track_id == 0) {
+        /* Queued after the decoder reached the end: join at that point,
+         * the end marker becomes this track's start */
+        engine.stream = stream;
+        engine.stream_id = track_id;
+        engine.markers[engine.marker_count - 1].track_id = track_id;
+        if (engine.marker_count == 1) engine.started = 0;
+        __atomic_store_n(&engine.decoding, 1, __ATOMIC_RELEASE);
+    } else {
+        wm_close(engine.queued);
+        engine.queued = stream;
+        engine.queued_id = track_id;
+    }
+    pthread_mutex_unlock(&engine.lock);
+
+    sem_post(&engine.space);
+    return ENGINE_OK;
+}
+
+void engine_pause(uint8_t paused) {
+    __atomic_store_n(&engine.paused, paused ? 1 : 0, __ATOMIC_RELEASE);
+}
+
+void engine_stop(void) {
+    pthread_mutex_lock(&engine.lock);
+    wm_close(engine.stream);
+    wm_close(engine.queued);
+    engine.stream = NULL;
+    engine.queued = NULL;
+    engine.stream_id = 0;
+    engine.queued_id = 0;
+    __atomic_store_n(&engine.decoding, 0, __ATOMIC_RELEASE);
+    engine_flush();
+    __atomic_store_n(&engine.paused, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&engine.lock);
+}
+
+int engine_seek(uint32_t track_id, uint32_t position_ms) {
+    int status = ENGINE_OK;
+
+    pthread_mutex_lock(&engine.lock);
+    if (engine.stream == NULL || engine.stream_id != track_id) {
+        status = ENGINE_ERROR_STALE;
+    } else if (wm_seek_ms(engine.stream, position_ms) != WM_OK) {
+        status = ENGINE_ERROR;
+    } else {
+        /* A queued track stays queued */
+        engine_flush();
+        engine_push_marker(track_id, (uint64_t)position_ms * engine.out.rate / 1000u);
+        engine.started = 1;
+    }
+    pthread_mutex_unlock(&engine.lock);
+
+    sem_post(&engine.space);
+    return status;
+}
+
+void engine_set_volume(uint8_t volume) {
+    if (volume > 100) volume = 100;
+    /* Half a dB per step below full scale */
+    int32_t gain = volume == 0 ? 0 : dsp_gain_from_db((float)(volume - 100) * 0.5f);
+    __atomic_store_n(&engine.gain_q16, gain, __ATOMIC_RELAXED);
+}
+
+/**
+ * Ring frame at the DAC now: the published frame advanced by the time
+ * since, up to the frames known to follow it without a break
+ */
+static uint32_t engine_heard_frame(void) {
+    engine_clock_t clock;
+    uint32_t sequence;
+
+    do {
+        sequence = __atomic_load_n(&engine.clock.sequence, __ATOMIC_ACQUIRE);
+        clock.ring_frame = engine.clock.ring_frame;
+        clock.ring_ahead = engine.clock.ring_ahead;
+        clock.silent = engine.clock.silent;
+        clock.time_ns = engine.clock.time_ns;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((sequence & 1) || sequence != __atomic_load_n(&engine.clock.sequence, __ATOMIC_ACQUIRE));
+
+    if (clock.silent) {
+        return clock.ring_frame;
+    }
+    uint64_t elapsed = (engine_now_ns() - clock.time_ns) * engine.out.rate / 1000000000ull;
+    if (elapsed > clock.ring_ahead) elapsed = clock.ring_ahead;
+    return clock.ring_frame + (uint32_t)elapsed;
+}
+
+/**
+ * Drop markers of tracks the DAC has moved past (lock held)
+ */
+static void engine_advance_markers(uint32_t heard) {
+    while (engine.marker_count > 1 && (int32_t)(heard - engine.markers[1].start) >= 0) {
+        memmove(&engine.markers[0], &engine.markers[1],
+                (engine.marker_count - 1) * sizeof(engine.markers[0]));
+        engine.marker_count--;
+        engine.started = 0;
+    }
+}
+
+int engine_poll_event(engine_event_t* event) {
+    int pending = 0;
+
+    pthread_mutex_lock(&engine.lock);
+    uint32_t heard = engine_heard_frame();
+    engine_advance_markers(heard);
+    if (engine.marker_count > 0 && !engine.started &&
+        (int32_t)(heard - engine.markers[0].start) >= 0) {
+        engine.started = 1;
+        event->track_id = engine.markers[0].track_id;
+        event->type = event->track_id ? ENGINE_EVENT_TRACK : ENGINE_EVENT_END;
+        pending = 1;
+    }
+    pthread_mutex_unlock(&engine.lock);
+    return pending;
+}
+
+void engine_get_status(engine_status_t* status) {
+    memset(status, 0, sizeof(*status));
+
+    pthread_mutex_lock(&engine.lock);
+    uint32_t heard = engine_heard_frame();
+    engine_advance_markers(heard);
+    if (engine.marker_count > 0 && engine.markers[0].track_id != 0) {
+        const engine_marker_t* marker = &engine.markers[0];
+        int32_t offset = (int32_t)(heard - marker->start);
+        status->track_id = marker->track_id;
+        status->position_frames = marker->base + (offset > 0 ? (uint32_t)offset : 0);
+        status->state = engine.paused ? ENGINE_PAUSED : ENGINE_PLAYING;
+    }
+    pthread_mutex_unlock(&engine.lock);
+
+    status->rate = engine.out.rate;
+    status->position_ms = (uint32_t)(status->position_frames * 1000u / status->rate);
+    status->underruns = __atomic_load_n(&engine.underruns, __ATOMIC_RELAXED);
+    status->xruns = engine.out.xruns;
+}
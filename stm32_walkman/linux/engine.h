@@ -0,0 +1,89 @@
+/**
+ * Linux Playback Engine
+ *
+ * The firmware's streaming pipeline on Linux:
+ *   control (walkmand) -> decode thread -> PCM ring -> output thread -> device
+ *
+ * The decode thread keeps the lock-free PCM ring full; when a track ends it
+ * continues with the queued track in the same pass, so tracks join without
+ * a gap. The output thread fills device periods in place from the ring and
+ * never blocks on the decoder (a starved period is padded with silence and
+ * counted as an underrun).
+ *
+ * Positions are sample accurate: the output thread maps the frame the DAC
+ * is playing (frames written minus device delay) back to a ring frame, and
+ * ring frames to tracks through the markers the decoder leaves at each
+ * track start.
+ */
+
+#ifndef __ENGINE_H
+#define __ENGINE_H
+
+#include <stdint.h>
+#include "pcm_out.h"
+
+#define ENGINE_RING_FRAMES 16384    // Decoded queue: 370 ms at 44.1kHz, as on the target
+
+typedef enum {
+    ENGINE_OK = 0,
+    ENGINE_ERROR = 1,
+    ENGINE_ERROR_NO_FILE = 2,
+    ENGINE_ERROR_UNSUPPORTED = 3,
+    ENGINE_ERROR_STALE = 4          // Track is no longer being decoded
+} engine_status_code_t;
+
+typedef enum {
+    ENGINE_STOPPED = 0,
+    ENGINE_PLAYING,
+    ENGINE_PAUSED
+} engine_state_t;
+
+typedef enum {
+    ENGINE_EVENT_TRACK = 1,         // Track started playing at the DAC
+    ENGINE_EVENT_END                // Last queued track finished
+} engine_event_type_t;
+
+typedef struct {
+    engine_event_type_t type;
+    uint32_t track_id;
+} engine_event_t;
+
+typedef struct {
+    engine_state_t state;
+    uint32_t track_id;              // Track at the DAC, 0 if none
+    uint64_t position_frames;       // In output frames from the track start
+    uint32_t position_ms;
+    uint32_t rate;                  // Output rate
+    uint32_t underruns;             // Periods the ring could not fill
+    uint32_t xruns;                 // Device underruns
+} engine_status_t;
+
+/* Open the output and start the decode and output threads. Threads run
+ * SCHED_FIFO when permitted (CAP_SYS_NICE / rtprio limit). */
+int engine_init(const char* device, uint32_t rate, uint32_t period_frames,
+                uint32_t periods);
+void engine_shutdown(void);
+
+/* Replace what is playing with a track (ids are chosen by the caller, not 0);
+ * drops the queued track */
+int engine_play(const char* path, uint32_t track_id);
+
+/* Track to continue with when the current one ends */
+int engine_queue(const char* path, uint32_t track_id);
+
+void engine_pause(uint8_t paused);
+void engine_stop(void);
+
+/* Frame-exact seek in the track being decoded; ENGINE_ERROR_STALE when the
+ * decoder has already moved on to the queued track */
+int engine_seek(uint32_t track_id, uint32_t position_ms);
+
+/* 0-100, mapped like the codec's volume (0 = mute) */
+void engine_set_volume(uint8_t volume);
+
+void engine_get_status(engine_status_t* status);
+
+/* Next pending event, 1 if one was returned (call from the control loop) */
+int engine_poll_event(engine_event_t* event);
+
+#endif /* __ENGINE_H */
@@ -0,0 +1,37 @@
+/**
+ * PCM Output Backend Selection
+ */
+
+#include "pcm_out.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PCM_OUT_FILE_PREFIX "file:"
+
+int pcm_out_open(pcm_out_t* out, const char* device, uint32_t rate,
+                 uint32_t period_frames, uint32_t periods) {
+    out->rate = rate;
+    out->period_frames = period_frames;
+    out->periods = periods;
+    out->xruns = 0;
+    out->handle = NULL;
+
+    if (strncmp(device, PCM_OUT_FILE_PREFIX, strlen(PCM_OUT_FILE_PREFIX)) == 0) {
+        out->ops = &pcm_out_file;
+        device += strlen(PCM_OUT_FILE_PREFIX);
+    } else {
+#ifdef WALKMAND_ALSA
+        out->ops = &pcm_out_alsa;
+#else
+        fprintf(stderr, "[pcm_out] built without ALSA, only file:<path> outputs\n");
+        return PCM_OUT_ERROR_UNSUPPORTED;
+#endif
+    }
+
+    int status = out->ops->open(out, device);
+    if (status == PCM_OUT_OK) {
+        printf("[pcm_out] %s %s: %u Hz, %u x %u frames\n", out->ops->name, device,
+               (unsigned)out->rate, (unsigned)out->periods, (unsigned)out->period_frames);
+    }
+    return status;
+}
@@ -0,0 +1,56 @@
+/**
+ * PCM Output Backends (Linux daemon)
+ *
+ * The daemon's equivalent of the I2S DMA: a device buffer of periods that
+ * the output thread fills in place. begin() waits until a period is free
+ * and returns a pointer into the device buffer (ALSA mmap area), the
+ * caller writes interleaved stereo s16 frames there and commit()s them.
+ *
+ * Backends are selected by device name: "file:<path>" writes a WAV file
+ * paced like a sound card, anything else is an ALSA PCM name.
+ */
+
+#ifndef __PCM_OUT_H
+#define __PCM_OUT_H
+
+#include <stdint.h>
+
+typedef enum {
+    PCM_OUT_OK = 0,
+    PCM_OUT_ERROR = 1,
+    PCM_OUT_ERROR_UNSUPPORTED = 2    // Device cannot do the requested format
+} pcm_out_status_t;
+
+typedef struct pcm_out pcm_out_t;
+
+/* Backend operations */
+typedef struct {
+    const char* name;
+    int (*open)(pcm_out_t* out, const char* device);
+    /* Wait for free space; returns the writable area and its size in
+     * frames (at most one period), NULL on a fatal error */
+    int16_t* (*begin)(pcm_out_t* out, uint32_t* frames);
+    int (*commit)(pcm_out_t* out, uint32_t frames);
+    /* Frames committed but not yet heard */
+    uint32_t (*delay)(pcm_out_t* out);
+    void (*close)(pcm_out_t* out);
+} pcm_out_ops_t;
+
+/* Output instance */
+struct pcm_out {
+    const pcm_out_ops_t* ops;
+    uint32_t rate;              // Requested, then actual rate
+    uint32_t period_frames;     // Requested, then actual period
+    uint32_t periods;
+    uint32_t xruns;             // Device underruns recovered
+    void* handle;               // Backend state
+};
+
+extern const pcm_out_ops_t pcm_out_alsa;
+extern const pcm_out_ops_t pcm_out_file;
+
+/* Pick the backend for a device name and open it */
+int pcm_out_open(pcm_out_t* out, const char* device, uint32_t rate,
+                 uint32_t period_frames, uint32_t periods);
+
+#endif /* __PCM_OUT_H */
@@ -0,0 +1,168 @@
+/**
+ * PCM Output - ALSA mmap
+ *
+ * The device buffer is mapped (SND_PCM_ACCESS_MMAP_INTERLEAVED) and the
+ * engine writes each period straight into it, like the firmware's DMA
+ * halves. Playback starts once the buffer is full and is kept running:
+ * an xrun is recovered with snd_pcm_recover() and counted.
+ *
+ * Without audio hardware, test against the null or file plugins, e.g. in
+ * ~/.asoundrc:
+ *   pcm.walkman_capture { type file; slave.pcm "null"; file "/tmp/walkmand.raw"; format "raw" }
+ */
+
+#include "pcm_out.h"
+#include <alsa/asoundlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    snd_pcm_t* pcm;
+    snd_pcm_uframes_t offset;   // Area handed out by begin()
+    snd_pcm_uframes_t frames;
+} pcm_out_alsa_t;
+
+static int pcm_out_alsa_configure(pcm_out_t* out, snd_pcm_t* pcm) {
+    snd_pcm_hw_params_t* hw;
+    snd_pcm_sw_params_t* sw;
+    snd_pcm_uframes_t period = out->period_frames;
+    snd_pcm_uframes_t buffer;
+    unsigned int rate = out->rate;
+    unsigned int periods = out->periods;
+
+    snd_pcm_hw_params_alloca(&hw);
+    if (snd_pcm_hw_params_any(pcm, hw) < 0 ||
+        snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0 ||
+        snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_S16_LE) < 0 ||
+        snd_pcm_hw_params_set_channels(pcm, hw, 2) < 0 ||
+        snd_pcm_hw_params_set_rate_near(pcm, hw, &rate, NULL) < 0 ||
+        snd_pcm_hw_params_set_period_size_near(pcm, hw, &period, NULL) < 0 ||
+        snd_pcm_hw_params_set_periods_near(pcm, hw, &periods, NULL) < 0 ||
+        snd_pcm_hw_params(pcm, hw) < 0) {
+        return PCM_OUT_ERROR_UNSUPPORTED;
+    }
+    snd_pcm_hw_params_get_buffer_size(hw, &buffer);
+
+    /* Wake per period, start when the buffer is full */
+    snd_pcm_sw_params_alloca(&sw);
+    if (snd_pcm_sw_params_current(pcm, sw) < 0 ||
+        snd_pcm_sw_params_set_avail_min(pcm, sw, period) < 0 ||
+        snd_pcm_sw_params_set_start_threshold(pcm, sw, buffer) < 0 ||
+        snd_pcm_sw_params(pcm, sw) < 0) {
+        return PCM_OUT_ERROR;
+    }
+
+    out->rate = rate;
+    out->period_frames = (uint32_t)period;
+    out->periods = (uint32_t)(buffer / period);
+    return PCM_OUT_OK;
+}
+
+static int pcm_out_alsa_open(pcm_out_t* out, const char* device) {
+    pcm_out_alsa_t* st = calloc(1, sizeof(*st));
+    int err;
+
+    if (st == NULL) return PCM_OUT_ERROR;
+
+    err = snd_pcm_open(&st->pcm, device, SND_PCM_STREAM_PLAYBACK, 0);
+    if (err < 0) {
+        fprintf(stderr, "[pcm_out] %s: %s\n", device, snd_strerror(err));
+        free(st);
+        return PCM_OUT_ERROR;
+    }
+
+    int status = pcm_out_alsa_configure(out, st->pcm);
+    if (status != PCM_OUT_OK || snd_pcm_prepare(st->pcm) < 0) {
+        fprintf(stderr, "[pcm_out] %s: no mmap S16_LE stereo at %u Hz\n", device, (unsigned)out->rate);
+        snd_pcm_close(st->pcm);
+        free(st);
+        return status != PCM_OUT_OK ? status : PCM_OUT_ERROR;
+    }
+
+    out->handle = st;
+    return PCM_OUT_OK;
+}
+
+static int pcm_out_alsa_recover(pcm_out_t* out, pcm_out_alsa_t* st, int err) {
+    if (snd_pcm_recover(st->pcm, err, 1) < 0) {
+        return PCM_OUT_ERROR;
+    }
+    out->xruns++;
+    return PCM_OUT_OK;
+}
+
+static int16_t* pcm_out_alsa_begin(pcm_out_t* out, uint32_t* frames) {
+    pcm_out_alsa_t* st = (pcm_out_alsa_t*)out->handle;
+    const snd_pcm_channel_area_t* areas;
+
+    for (;;) {
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(st->pcm);
+        if (avail < 0) {
+            if (pcm_out_alsa_recover(out, st, (int)avail) != PCM_OUT_OK) return NULL;
+            continue;
+        }
+        if ((snd_pcm_uframes_t)avail < out->period_frames) {
+            int err = snd_pcm_wait(st->pcm, 1000);
+            if (err < 0 && pcm_out_alsa_recover(out, st, err) != PCM_OUT_OK) return NULL;
+            continue;
+        }
+
+        st->frames = out->period_frames;
+        int err = snd_pcm_mmap_begin(st->pcm, &areas, &st->offset, &st->frames);
+        if (err < 0) {
+            if (pcm_out_alsa_recover(out, st, err) != PCM_OUT_OK) return NULL;
+            continue;
+        }
+
+        /* Interleaved: one area, 32-bit frame step */
+        *frames = (uint32_t)st->frames;
+        return (int16_t*)((uint8_t*)areas[0].addr + areas[0].first / 8 +
+                          st->offset * (areas[0].step / 8));
+    }
+}
+
+static int pcm_out_alsa_commit(pcm_out_t* out, uint32_t frames) {
+    pcm_out_alsa_t* st = (pcm_out_alsa_t*)out->handle;
+
+    snd_pcm_sframes_t done = snd_pcm_mmap_commit(st->pcm, st->offset, frames);
+    if (done < 0 || (snd_pcm_uframes_t)done != frames) {
+        return pcm_out_alsa_recover(out, st, done < 0 ? (int)done : -EPIPE);
+    }
+
+    /* mmap commits do not trigger the start threshold */
+    if (snd_pcm_state(st->pcm) == SND_PCM_STATE_PREPARED &&
+        snd_pcm_avail_update(st->pcm) < (snd_pcm_sframes_t)out->period_frames) {
+        int err = snd_pcm_start(st->pcm);
+        if (err < 0) return pcm_out_alsa_recover(out, st, err);
+    }
+    return PCM_OUT_OK;
+}
+
+static uint32_t pcm_out_alsa_delay(pcm_out_t* out) {
+    pcm_out_alsa_t* st = (pcm_out_alsa_t*)out->handle;
+    snd_pcm_sframes_t delay = 0;
+
+    if (snd_pcm_delay(st->pcm, &delay) < 0 || delay < 0) {
+        return 0;
+    }
+    return (uint32_t)delay;
+}
+
+static void pcm_out_alsa_close(pcm_out_t* out) {
+    pcm_out_alsa_t* st = (pcm_out_alsa_t*)out->handle;
+    if (st == NULL) return;
+
+    snd_pcm_drop(st->pcm);
+    snd_pcm_close(st->pcm);
+    free(st);
+    out->handle = NULL;
+}
+
+const pcm_out_ops_t pcm_out_alsa = {
+    .name = "alsa",
+    .open = pcm_out_alsa_open,
+    .begin = pcm_out_alsa_begin,
+    .commit = pcm_out_alsa_commit,
+    .delay = pcm_out_alsa_delay,
+    .close = pcm_out_alsa_close
+};
@@ -0,0 +1,134 @@
+/**
+ * PCM Output - WAV File
+ * Emulates a sound card for tests without audio hardware: periods are
+ * written to a 16-bit stereo WAV file and released at the sample rate
+ * against CLOCK_MONOTONIC, so the delay and position reported to the
+ * engine behave like a device buffer of periods x period_frames.
+ */
+
+#include "pcm_out.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    FILE* file;
+    int16_t* period;            // Area handed out by begin()
+    uint64_t written;           // Frames committed
+    uint64_t start_ns;          // Clock at the first commit
+    uint8_t started;
+} pcm_out_file_t;
+
+static uint64_t pcm_out_file_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void pcm_out_file_put_le32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * 44-byte canonical header; sizes are patched on close
+ */
+static int pcm_out_file_header(pcm_out_t* out, FILE* f, uint32_t data_bytes) {
+    uint8_t h[44] = {
+        'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 16, 0,
+        'd', 'a', 't', 'a', 0, 0, 0, 0
+    };
+    pcm_out_file_put_le32(h + 4, 36 + data_bytes);
+    pcm_out_file_put_le32(h + 24, out->rate);
+    pcm_out_file_put_le32(h + 28, out->rate * 4);
+    pcm_out_file_put_le32(h + 40, data_bytes);
+
+    return fseek(f, 0, SEEK_SET) == 0 && fwrite(h, 1, sizeof(h), f) == sizeof(h) ?
+           PCM_OUT_OK : PCM_OUT_ERROR;
+}
+
+/* Frames the emulated DAC has played */
+static uint64_t pcm_out_file_played(const pcm_out_t* out, const pcm_out_file_t* st) {
+    if (!st->started) return 0;
+
+    uint64_t played = (pcm_out_file_now_ns() - st->start_ns) * out->rate / 1000000000ull;
+    return played < st->written ? played : st->written;
+}
+
+static int pcm_out_file_open(pcm_out_t* out, const char* path) {
+    pcm_out_file_t* st = calloc(1, sizeof(*st));
+    if (st == NULL) return PCM_OUT_ERROR;
+
+    st->period = calloc(out->period_frames * 2, sizeof(int16_t));
+    st->file = fopen(path, "wb");
+    if (st->period == NULL || st->file == NULL || pcm_out_file_header(out, st->file, 0) != PCM_OUT_OK) {
+        if (st->file) fclose(st->file);
+        free(st->period);
+        free(st);
+        return PCM_OUT_ERROR;
+    }
+    out->handle = st;
+    return PCM_OUT_OK;
+}
+
+static int16_t* pcm_out_file_begin(pcm_out_t* out, uint32_t* frames) {
+    pcm_out_file_t* st = (pcm_out_file_t*)out->handle;
+    uint64_t buffer = (uint64_t)out->periods * out->period_frames;
+
+    /* Wait until a period of the emulated buffer has played out */
+    while (st->written - pcm_out_file_played(out, st) + out->period_frames > buffer) {
+        uint64_t due = st->written + out->period_frames - buffer;
+        uint64_t wait_ns = (due - pcm_out_file_played(out, st)) * 1000000000ull / out->rate;
+        struct timespec ts = {(time_t)(wait_ns / 1000000000ull), (long)(wait_ns % 1000000000ull)};
+        nanosleep(&ts, NULL);
+    }
+
+    *frames = out->period_frames;
+    return st->period;
+}
+
+static int pcm_out_file_commit(pcm_out_t* out, uint32_t frames) {
+    pcm_out_file_t* st = (pcm_out_file_t*)out->handle;
+
+    if (fwrite(st->period, 4, frames, st->file) != frames) {
+        return PCM_OUT_ERROR;
+    }
+    st->written += frames;
+
+    /* Playback starts once the buffer is full, as with ALSA's default
+     * start threshold */
+    if (!st->started && st->written >= (uint64_t)out->periods * out->period_frames) {
+        st->started = 1;
+        st->start_ns = pcm_out_file_now_ns();
+    }
+    return PCM_OUT_OK;
+}
+
+static uint32_t pcm_out_file_delay(pcm_out_t* out) {
+    pcm_out_file_t* st = (pcm_out_file_t*)out->handle;
+    return (uint32_t)(st->written - pcm_out_file_played(out, st));
+}
+
+static void pcm_out_file_close(pcm_out_t* out) {
+    pcm_out_file_t* st = (pcm_out_file_t*)out->handle;
+    if (st == NULL) return;
+
+    pcm_out_file_header(out, st->file, (uint32_t)(st->written * 4));
+    fclose(st->file);
+    free(st->period);
+    free(st);
+    out->handle = NULL;
+}
+
+const pcm_out_ops_t pcm_out_file = {
+    .name = "file",
+    .open = pcm_out_file_open,
+    .begin = pcm_out_file_begin,
+    .commit = pcm_out_file_commit,
+    .delay = pcm_out_file_delay,
+    .close = pcm_out_file_close
+};
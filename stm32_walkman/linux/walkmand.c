@@ -0,0 +1,379 @@
+/**
+ * walkmand - Walkman Playback Daemon (Linux / Dragonboard)
+ *
+ * Runs the playback engine (engine.h) and takes commands over a Unix
+ * stream socket, one line per command and one reply line per command:
+ *
+ *   play <path>       -> ok <track id>    Play now, drops the queued track
+ *   queue <path>      -> ok <track id>    Continue with this track, gapless
+ *   pause | resume | stop                 -> ok
+ *   seek <ms>         -> ok               In the track being heard
+ *   volume <0-100>    -> ok
+ *   status            -> ok state=<s> track=<id> position_ms=<n>
+ *                        position_frames=<n> rate=<hz> underruns=<n> xruns=<n>
+ *   button <name> <pressed|long|released>
+ *                     -> ok               Passed on to subscribers (wminput)
+ *   subscribe         -> ok, then asynchronous lines on this connection:
+ *                        event track <id>  (track reached the DAC)
+ *                        event end         (queue played out)
+ *                        event button <name> <pressed|long|released>
+ *
+ * Errors reply "error <reason>". Paths are host paths.
+ */
+
+#include "engine.h"
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define WALKMAND_MAX_CLIENTS 8
+#define WALKMAND_LINE_MAX    1024
+#define WALKMAND_TICK_MS     10     // Event latency
+#define WALKMAND_TRACKS      8      // Recent track ids kept for seek
+
+typedef struct {
+    int fd;
+    uint8_t subscribed;
+    uint32_t fill;
+    char line[WALKMAND_LINE_MAX];
+} walkmand_client_t;
+
+typedef struct {
+    uint32_t id;
+    char path[WALKMAND_LINE_MAX];
+} walkmand_track_t;
+
+static volatile sig_atomic_t walkmand_running = 1;
+static walkmand_client_t walkmand_clients[WALKMAND_MAX_CLIENTS];
+static walkmand_track_t walkmand_tracks[WALKMAND_TRACKS];
+static uint32_t walkmand_next_id = 1;
+static uint32_t walkmand_queued_id = 0;
+
+static void walkmand_signal(int sig) {
+    (void)sig;
+    walkmand_running = 0;
+}
+
+static uint32_t walkmand_add_track(const char* path) {
+    walkmand_track_t* track = &walkmand_tracks[walkmand_next_id % WALKMAND_TRACKS];
+    track->id = walkmand_next_id++;
+    snprintf(track->path, sizeof(track->path), "%s", path);
+    return track->id;
+}
+
+static const walkmand_track_t* walkmand_find_track(uint32_t id) {
+    const walkmand_track_t* track = &walkmand_tracks[id % WALKMAND_TRACKS];
+    return (id != 0 && track->id == id) ? track : NULL;
+}
+
+static void walkmand_send(int fd, const char* text) {
+    size_t len = strlen(text);
+    while (len > 0) {
+        ssize_t n = send(fd, text, len, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        text += n;
+        len -= (size_t)n;
+    }
+}
+
+static void walkmand_reply_status(int fd, int status, uint32_t id) {
+    static const char* const reasons[] = {
+        [ENGINE_ERROR] = "error failed\n",
+        [ENGINE_ERROR_NO_FILE] = "error no such file\n",
+        [ENGINE_ERROR_UNSUPPORTED] = "error unsupported format\n",
+        [ENGINE_ERROR_STALE] = "error track not playing\n",
+    };
+    char line[32];
+
+    if (status != ENGINE_OK) {
+        walkmand_send(fd, reasons[status]);
+    } else if (id != 0) {
+        snprintf(line, sizeof(line), "ok %u\n", (unsigned)id);
+        walkmand_send(fd, line);
+    } else {
+        walkmand_send(fd, "ok\n");
+    }
+}
+
+/**
+ * Seek in the heard track. If the decoder is already past it (the end of
+ * the track is in the ring), the track is reopened and the queued one is
+ * queued again behind it.
+ */
+static int walkmand_seek(uint32_t position_ms) {
+    engine_status_t status;
+    engine_get_status(&status);
+    if (status.track_id == 0) {
+        return ENGINE_ERROR_STALE;
+    }
+
+    int result = engine_seek(status.track_id, position_ms);
+    if (result != ENGINE_ERROR_STALE) {
+        return result;
+    }
+
+    const walkmand_track_t* track = walkmand_find_track(status.track_id);
+    const walkmand_track_t* queued = walkmand_find_track(walkmand_queued_id);
+    if (track == NULL) {
+        return ENGINE_ERROR_STALE;
+    }
+    result = engine_play(track->path, track->id);
+    if (result == ENGINE_OK) {
+        result = engine_seek(track->id, position_ms);
+    }
+    if (result == ENGINE_OK && queued != NULL && queued->id != track->id) {
+        engine_queue(queued->path, queued->id);
+    }
+    return result;
+}
+
+static void walkmand_publish(const char* line) {
+    for (int i = 0; i < WALKMAND_MAX_CLIENTS; i++) {
+        if (walkmand_clients[i].fd >= 0 && walkmand_clients[i].subscribed) {
+            walkmand_send(walkmand_clients[i].fd, line);
+        }
+    }
+}
+
+/**
+ * Button event from the input service: "<name> <action>", name of
+ * letters, digits and '_'
+ */
+static int walkmand_button(const char* arg) {
+    char name[32], action[16], line[64];
+
+    if (sscanf(arg, "%31[a-z0-9_] %15s", name, action) != 2 ||
+        (strcmp(action, "pressed") != 0 && strcmp(action, "long") != 0 &&
+         strcmp(action, "released") != 0)) {
+        return -1;
+    }
+    snprintf(line, sizeof(line), "event button %s %s\n", name, action);
+    walkmand_publish(line);
+    return 0;
+}
+
+static void walkmand_command(walkmand_client_t* client, char* line) {
+    char* arg = strchr(line, ' ');
+    char reply[256];
+    int status;
+
+    if (arg != NULL) {
+        *arg++ = '\0';
+    }
+
+    if (strcmp(line, "play") == 0 && arg != NULL) {
+        uint32_t id = walkmand_add_track(arg);
+        status = engine_play(arg, id);
+        walkmand_queued_id = 0;
+        walkmand_reply_status(client->fd, status, id);
+    } else if (strcmp(line, "queue") == 0 && arg != NULL) {
+        uint32_t id = walkmand_add_track(arg);
+        status = engine_queue(arg, id);
+        if (status == ENGINE_OK) walkmand_queued_id = id;
+        walkmand_reply_status(client->fd, status, id);
+    } else if (strcmp(line, "pause") == 0 || strcmp(line, "resume") == 0) {
+        engine_pause(line[0] == 'p');
+        walkmand_reply_status(client->fd, ENGINE_OK, 0);
+    } else if (strcmp(line, "stop") == 0) {
+        engine_stop();
+        walkmand_queued_id = 0;
+        walkmand_reply_status(client->fd, ENGINE_OK, 0);
+    } else if (strcmp(line, "seek") == 0 && arg != NULL) {
+        walkmand_reply_status(client->fd, walkmand_seek((uint32_t)strtoul(arg, NULL, 10)), 0);
+    } else if (strcmp(line, "volume") == 0 && arg != NULL) {
+        engine_set_volume((uint8_t)strtoul(arg, NULL, 10));
+        walkmand_reply_status(client->fd, ENGINE_OK, 0);
+    } else if (strcmp(line, "status") == 0) {
+        static const char* const states[] = {"stopped", "playing", "paused"};
+        engine_status_t st;
+        engine_get_status(&st);
+        snprintf(reply, sizeof(reply),
+                 "ok state=%s track=%u position_ms=%u position_frames=%llu rate=%u underruns=%u xruns=%u\n",
+                 states[st.state], (unsigned)st.track_id, (unsigned)st.position_ms,
+                 (unsigned long long)st.position_frames, (unsigned)st.rate,
+                 (unsigned)st.underruns, (unsigned)st.xruns);
+        walkmand_send(client->fd, reply);
+    } else if (strcmp(line, "button") == 0 && arg != NULL && walkmand_button(arg) == 0) {
+        walkmand_reply_status(client->fd, ENGINE_OK, 0);
+    } else if (strcmp(line, "subscribe") == 0) {
+        client->subscribed = 1;
+        walkmand_reply_status(client->fd, ENGINE_OK, 0);
+    } else {
+        walkmand_send(client->fd, "error unknown command\n");
+    }
+}
+
+/**
+ * Read what arrived and run complete lines
+ */
+static int walkmand_client_read(walkmand_client_t* client) {
+    ssize_t n = recv(client->fd, client->line + client->fill,
+                     sizeof(client->line) - 1 - client->fill, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    client->fill += (uint32_t)n;
+
+    char* start = client->line;
+    char* end;
+    while ((end = memchr(start, '\n', client->line + client->fill - start)) != NULL) {
+        *end = '\0';
+        if (end > start && end[-1] == '\r') end[-1] = '\0';
+        walkmand_command(client, start);
+        start = end + 1;
+    }
+
+    client->fill -= (uint32_t)(start - client->line);
+    memmove(client->line, start, client->fill);
+    if (client->fill == sizeof(client->line) - 1) {
+        return -1;  /* Line too long */
+    }
+    return 0;
+}
+
+static void walkmand_broadcast(const engine_event_t* event) {
+    char line[64];
+
+    if (event->type == ENGINE_EVENT_TRACK) {
+        snprintf(line, sizeof(line), "event track %u\n", (unsigned)event->track_id);
+        if (event->track_id == walkmand_queued_id) walkmand_queued_id = 0;
+    } else {
+        snprintf(line, sizeof(line), "event end\n");
+    }
+    walkmand_publish(line);
+}
+
+static int walkmand_listen(const char* path) {
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "walkmand: socket path too long\n");
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4) < 0) {
+        perror("walkmand: bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void walkmand_usage(void) {
+    fprintf(stderr,
+            "usage: walkmand [-s socket] [-D device] [-r rate] [-p period] [-n periods]\n"
+            "  -s  control socket (default /tmp/walkmand.sock)\n"
+            "  -D  ALSA PCM name or file:<path.wav> (default \"default\")\n"
+            "  -r  output rate, other rates are resampled (default 44100)\n"
+            "  -p  period in frames (default 512), -n periods per buffer (default 4)\n");
+}
+
+int main(int argc, char** argv) {
+    const char* socket_path = "/tmp/walkmand.sock";
+    const char* device = "default";
+    uint32_t rate = 44100, period = 512, periods = 4;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:D:r:p:n:h")) != -1) {
+        switch (opt) {
+            case 's': socket_path = optarg; break;
+            case 'D': device = optarg; break;
+            case 'r': rate = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'p': period = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'n': periods = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default: walkmand_usage(); return 2;
+        }
+    }
+    if (rate == 0 || period == 0 || periods < 2) {
+        walkmand_usage();
+        return 2;
+    }
+
+    signal(SIGINT, walkmand_signal);
+    signal(SIGTERM, walkmand_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    int listen_fd = walkmand_listen(socket_path);
+    if (listen_fd < 0) {
+        return 1;
+    }
+    if (engine_init(device, rate, period, periods) != ENGINE_OK) {
+        fprintf(stderr, "walkmand: cannot open output %s\n", device);
+        close(listen_fd);
+        unlink(socket_path);
+        return 1;
+    }
+    printf("walkmand: listening on %s\n", socket_path);
+    fflush(stdout);
+
+    for (int i = 0; i < WALKMAND_MAX_CLIENTS; i++) {
+        walkmand_clients[i].fd = -1;
+    }
+
+    while (walkmand_running) {
+        struct pollfd fds[WALKMAND_MAX_CLIENTS + 1];
+        engine_event_t event;
+
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < WALKMAND_MAX_CLIENTS; i++) {
+            fds[i + 1].fd = walkmand_clients[i].fd;
+            fds[i + 1].events = POLLIN;
+        }
+
+        if (poll(fds, WALKMAND_MAX_CLIENTS + 1, WALKMAND_TICK_MS) < 0 && errno != EINTR) {
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+            int slot = -1;
+            for (int i = 0; i < WALKMAND_MAX_CLIENTS && fd >= 0; i++) {
+                if (walkmand_clients[i].fd < 0) {
+                    slot = i;
+                    break;
+                }
+            }
+            if (slot >= 0) {
+                memset(&walkmand_clients[slot], 0, sizeof(walkmand_clients[slot]));
+                walkmand_clients[slot].fd = fd;
+            } else if (fd >= 0) {
+                walkmand_send(fd, "error too many clients\n");
+                close(fd);
+            }
+        }
+
+        for (int i = 0; i < WALKMAND_MAX_CLIENTS; i++) {
+            if (walkmand_clients[i].fd >= 0 && (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) {
+                if (walkmand_client_read(&walkmand_clients[i]) < 0) {
+                    close(walkmand_clients[i].fd);
+                    walkmand_clients[i].fd = -1;
+                }
+            }
+        }
+
+        while (engine_poll_event(&event)) {
+            walkmand_broadcast(&event);
+        }
+    }
+
+    for (int i = 0; i < WALKMAND_MAX_CLIENTS; i++) {
+        if (walkmand_clients[i].fd >= 0) close(walkmand_clients[i].fd);
+    }
+    engine_shutdown();
+    close(listen_fd);
+    unlink(socket_path);
+    return 0;
+}
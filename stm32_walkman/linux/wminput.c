@@ -0,0 +1,304 @@
+/**
+ * wminput - Button Input Service (Linux / Dragonboard)
+ *
+ * Watches the player buttons through the GPIO character device (the v2
+ * line uAPI that libgpiod wraps): one line request with edge detection on
+ * both edges, active low with pull-up, so the kernel timestamps every
+ * edge and the service sleeps in epoll until one arrives. Edges and their
+ * timestamps go through the firmware's debounce and long-press logic
+ * (src/buttons/button_tracker.c); the epoll timeout is the tracker's next
+ * deadline, so debounce and long presses need no polling either.
+ *
+ * Each gesture is sent to walkmand as "button <name> <pressed|long|released>",
+ * which passes it on to its subscribers (the Python player, see
+ * walkman_player/src/gpio/controller.py DaemonButtonController). If the
+ * daemon is not there, the service reconnects once a second; gestures in
+ * between are dropped.
+ *
+ * Usage: wminput [-c chip] [-s socket] [-m name=offset,...] [-v]
+ *   e.g. wminput -c /dev/gpiochip0 -m play_pause=52,next=47
+ */
+
+#include "button_tracker.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <linux/gpio.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WMINPUT_EVENTS 16                   // Edges read per wakeup
+#define WMINPUT_RECONNECT_MS 1000
+
+typedef struct {
+    const char* name;                       // As in controller.py
+    int32_t offset;                         // Chip line, -1 if not wired
+    uint8_t level;                          // Last edge, 1 = pressed
+    uint32_t edge_time;                     // ms, kernel timestamp
+    button_tracker_t tracker;
+} wminput_button_t;
+
+/* DragonBoard 410c low speed header (GPIO numbers of DEFAULT_PIN_CONFIG) */
+static wminput_button_t wminput_buttons[NUM_BUTTONS] = {
+    [BTN_PREVIOUS] = {"prev", 45},
+    [BTN_PLAY_PAUSE] = {"play_pause", 52},
+    [BTN_NEXT] = {"next", 47},
+    [BTN_VOL_UP] = {"vol_up", 50},
+    [BTN_VOL_DOWN] = {"vol_down", 48},
+    [BTN_SHUFFLE] = {"shuffle", 46},
+    [BTN_LOOP] = {"loop", 44},
+};
+
+static volatile sig_atomic_t wminput_running = 1;
+static int wminput_verbose = 0;
+
+static void wminput_signal(int sig) {
+    (void)sig;
+    wminput_running = 0;
+}
+
+/* Same clock as the edge timestamps */
+static uint32_t wminput_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+/* ============ GPIO ============ */
+
+/**
+ * Request the wired lines as one set with edge events. Bias needs a
+ * 5.5+ kernel and a driver that supports it; without, the board's
+ * pull-ups have to do.
+ */
+static int wminput_request(int chip, uint32_t* line_of) {
+    struct gpio_v2_line_request req;
+    struct gpio_v2_line_values values;
+
+    memset(&req, 0, sizeof(req));
+    snprintf(req.consumer, sizeof(req.consumer), "wminput");
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        if (wminput_buttons[i].offset < 0) continue;
+        line_of[i] = req.num_lines;
+        req.offsets[req.num_lines++] = (uint32_t)wminput_buttons[i].offset;
+    }
+    req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_ACTIVE_LOW |
+                       GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING |
+                       GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+
+    if (ioctl(chip, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        req.config.flags &= ~(uint64_t)GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+        if (ioctl(chip, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+            return -1;
+        }
+        fprintf(stderr, "wminput: no bias control, relying on external pull-ups\n");
+    }
+
+    /* Start from the levels now, so a held button is not a press */
+    memset(&values, 0, sizeof(values));
+    values.mask = (req.num_lines == 64) ? ~0ull : (1ull << req.num_lines) - 1;
+    if (ioctl(req.fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0) {
+        for (int i = 0; i < NUM_BUTTONS; i++) {
+            if (wminput_buttons[i].offset < 0) continue;
+            wminput_buttons[i].level = (uint8_t)((values.bits >> line_of[i]) & 1);
+            wminput_buttons[i].tracker.state = wminput_buttons[i].level;
+            wminput_buttons[i].tracker.long_reported = 1;
+        }
+    }
+    return req.fd;
+}
+
+/* ============ Daemon ============ */
+
+static int wminput_connect(const char* path) {
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void wminput_publish(int* daemon, const wminput_button_t* button, button_event_t event,
+                            uint32_t now) {
+    static const char* const actions[] = {
+        [BUTTON_RELEASED] = "released",
+        [BUTTON_PRESSED] = "pressed",
+        [BUTTON_LONG_PRESSED] = "long",
+    };
+    char line[64];
+    int len = snprintf(line, sizeof(line), "button %s %s\n", button->name, actions[event]);
+
+    if (wminput_verbose) {
+        printf("%s %s, %u ms after the edge\n", button->name, actions[event],
+               (unsigned)(now - button->edge_time));
+        fflush(stdout);
+    }
+    if (*daemon >= 0 && send(*daemon, line, (size_t)len, MSG_NOSIGNAL) != len) {
+        close(*daemon);
+        *daemon = -1;
+    }
+}
+
+/* Replies are "ok" (or an error we cannot act on): only watch for hangup */
+static void wminput_drain(int* daemon) {
+    char buf[256];
+    ssize_t n = recv(*daemon, buf, sizeof(buf), MSG_DONTWAIT);
+
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        close(*daemon);
+        *daemon = -1;
+    }
+}
+
+/* ============ Main ============ */
+
+static int wminput_map(char* spec) {
+    for (char* item = strtok(spec, ","); item != NULL; item = strtok(NULL, ",")) {
+        char* eq = strchr(item, '=');
+        int i;
+        if (eq == NULL) return -1;
+        *eq = '\0';
+        for (i = 0; i < NUM_BUTTONS && strcmp(wminput_buttons[i].name, item) != 0; i++);
+        if (i == NUM_BUTTONS) return -1;
+        wminput_buttons[i].offset = (strcmp(eq + 1, "none") == 0) ? -1 : (int32_t)strtol(eq + 1, NULL, 10);
+    }
+    return 0;
+}
+
+static void wminput_usage(void) {
+    fprintf(stderr,
+            "usage: wminput [-c chip] [-s socket] [-m name=offset,...] [-v]\n"
+            "  -c  GPIO chip (default /dev/gpiochip0)\n"
+            "  -s  walkmand control socket (default /tmp/walkmand.sock)\n"
+            "  -m  line offsets (name=none leaves a button out); names:\n"
+            "      prev play_pause next vol_up vol_down shuffle loop\n"
+            "  -v  print each gesture and its delay after the edge\n");
+}
+
+int main(int argc, char** argv) {
+    const char* chip_path = "/dev/gpiochip0";
+    const char* socket_path = "/tmp/walkmand.sock";
+    struct gpio_v2_line_event events[WMINPUT_EVENTS];
+    struct epoll_event ev;
+    uint32_t line_of[NUM_BUTTONS];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:s:m:vh")) != -1) {
+        switch (opt) {
+            case 'c': chip_path = optarg; break;
+            case 's': socket_path = optarg; break;
+            case 'm':
+                if (wminput_map(optarg) != 0) {
+                    wminput_usage();
+                    return 2;
+                }
+                break;
+            case 'v': wminput_verbose = 1; break;
+            default: wminput_usage(); return 2;
+        }
+    }
+
+    signal(SIGINT, wminput_signal);
+    signal(SIGTERM, wminput_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        button_tracker_init(&wminput_buttons[i].tracker);
+    }
+    int chip = open(chip_path, O_RDONLY | O_CLOEXEC);
+    int lines = (chip >= 0) ? wminput_request(chip, line_of) : -1;
+    if (lines < 0) {
+        fprintf(stderr, "wminput: cannot request lines on %s: %s\n", chip_path, strerror(errno));
+        return 1;
+    }
+    close(chip);
+
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    ev.events = EPOLLIN;
+    ev.data.fd = lines;
+    epoll_ctl(ep, EPOLL_CTL_ADD, lines, &ev);
+
+    int daemon = -1;
+    uint32_t next_connect = wminput_now_ms();
+    printf("wminput: watching %s\n", chip_path);
+    fflush(stdout);
+
+    while (wminput_running) {
+        uint32_t now = wminput_now_ms();
+        if (daemon < 0 && (int32_t)(now - next_connect) >= 0) {
+            daemon = wminput_connect(socket_path);
+            next_connect = now + WMINPUT_RECONNECT_MS;
+            if (daemon >= 0) {
+                ev.events = EPOLLIN | EPOLLRDHUP;
+                ev.data.fd = daemon;
+                epoll_ctl(ep, EPOLL_CTL_ADD, daemon, &ev);
+            }
+        }
+
+        /* Sleep until an edge, a tracker deadline or a reconnect */
+        uint32_t wait = (daemon < 0) ? next_connect - now : BUTTON_NO_DEADLINE;
+        if ((int32_t)wait < 0) wait = 0;
+        for (int i = 0; i < NUM_BUTTONS; i++) {
+            if (wminput_buttons[i].offset < 0) continue;
+            uint32_t due = button_tracker_deadline(&wminput_buttons[i].tracker, now);
+            if (due < wait) wait = due;
+        }
+
+        struct epoll_event ready[2];
+        int n = epoll_wait(ep, ready, 2, wait == BUTTON_NO_DEADLINE ? -1 : (int)wait);
+        if (n < 0 && errno != EINTR) break;
+
+        for (int k = 0; k < n; k++) {
+            if (ready[k].data.fd == daemon) {
+                wminput_drain(&daemon);
+                continue;
+            }
+
+            ssize_t got = read(lines, events, sizeof(events));
+            for (ssize_t e = 0; e < got / (ssize_t)sizeof(events[0]); e++) {
+                uint32_t at = (uint32_t)(events[e].timestamp_ns / 1000000u);
+                for (int i = 0; i < NUM_BUTTONS; i++) {
+                    wminput_button_t* b = &wminput_buttons[i];
+                    button_event_t event;
+                    if (b->offset != (int32_t)events[e].offset) continue;
+
+                    b->level = (events[e].id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+                    b->edge_time = at;
+                    if (button_tracker_update(&b->tracker, b->level, at, &event)) {
+                        wminput_publish(&daemon, b, event, wminput_now_ms());
+                    }
+                }
+            }
+        }
+
+        /* Debounce settled or long press reached */
+        now = wminput_now_ms();
+        for (int i = 0; i < NUM_BUTTONS; i++) {
+            wminput_button_t* b = &wminput_buttons[i];
+            button_event_t event;
+            if (b->offset >= 0 && button_tracker_update(&b->tracker, b->level, now, &event)) {
+                wminput_publish(&daemon, b, event, now);
+            }
+        }
+    }
+
+    if (daemon >= 0) close(daemon);
+    close(lines);
+    close(ep);
+    return 0;
+}
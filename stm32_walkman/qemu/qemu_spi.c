@@ -0,0 +1,51 @@
+/**
+ * QEMU Target Test - SPI Sink
+ *
+ * QEMU's STM32F405 has no SPI5, so the LCD bus is a sink: the rendering
+ * code still runs on the emulated core and counts towards the scenario's
+ * instructions, the wire time and the panel are not modelled.
+ */
+
+#include "spi.h"
+#include <string.h>
+
+void spi_init(spi_bus_t bus, spi_datasize_t datasize, spi_prescaler_t prescaler,
+              spi_cpol_t cpol, spi_cpha_t cpha) {
+    (void)bus;
+    (void)datasize;
+    (void)prescaler;
+    (void)cpol;
+    (void)cpha;
+}
+
+void spi_write(spi_bus_t bus, const uint8_t* data, uint32_t len) {
+    (void)bus;
+    (void)data;
+    (void)len;
+}
+
+void spi_read(spi_bus_t bus, uint8_t* data, uint32_t len) {
+    (void)bus;
+    if (data) memset(data, 0xFF, len);
+}
+
+void spi_transfer(spi_bus_t bus, const uint8_t* tx, uint8_t* rx, uint32_t len) {
+    (void)bus;
+    (void)tx;
+    if (rx) memset(rx, 0xFF, len);
+}
+
+void spi_write_byte(spi_bus_t bus, uint8_t byte) {
+    (void)bus;
+    (void)byte;
+}
+
+uint8_t spi_read_byte(spi_bus_t bus) {
+    (void)bus;
+    return 0xFF;
+}
+
+uint8_t spi_is_busy(spi_bus_t bus) {
+    (void)bus;
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * QEMU Target Test - SD Card over Semihosting
+ *
+ * Card paths are opened on the host through newlib's semihosted stdio,
+ * below the "sdcard=" root. Semihosting cannot list directories, so
+ * qemu_test.py writes a ".index" file into every directory of the card
+ * image: one file name per line, in playlist order.
+ */
+
+#include "storage.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define QEMU_STORAGE_INDEX  ".index"
+
+static const char* storage_root = NULL;
+
+static void storage_host_path(char* out, size_t len, const char* path) {
+    snprintf(out, len, "%s%s%s", storage_root, path[0] == '/' ? "" : "/", path);
+}
+
+int storage_init(void) {
+    storage_root = sim_config("WALKMAN_SIM_SDCARD", "sdcard");
+    return STORAGE_OK;
+}
+
+int storage_open(storage_file_t* file, const char* path) {
+    char host_path[256];
+
+    if (storage_root == NULL || file == NULL || path == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    storage_host_path(host_path, sizeof(host_path), path);
+    FILE* f = fopen(host_path, "rb");
+    if (f == NULL) {
+        return STORAGE_ERROR_NO_FILE;
+    }
+
+    /* SYS_FLEN behind the scenes */
+    fseek(f, 0, SEEK_END);
+    file->size = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    file->handle = f;
+    file->pos = 0;
+    return STORAGE_OK;
+}
+
+int32_t storage_read(storage_file_t* file, void* buffer, uint32_t len) {
+    if (file == NULL || file->handle == NULL) {
+        return -1;
+    }
+
+    size_t n = fread(buffer, 1, len, (FILE*)file->handle);
+    if (n == 0 && ferror((FILE*)file->handle)) {
+        return -1;
+    }
+
+    file->pos += (uint32_t)n;
+    return (int32_t)n;
+}
+
+int storage_seek(storage_file_t* file, uint32_t offset) {
+    if (file == NULL || file->handle == NULL ||
+        fseek((FILE*)file->handle, offset, SEEK_SET) != 0) {
+        return STORAGE_ERROR;
+    }
+
+    file->pos = offset;
+    return STORAGE_OK;
+}
+
+void storage_close(storage_file_t* file) {
+    if (file == NULL || file->handle == NULL) {
+        return;
+    }
+
+    fclose((FILE*)file->handle);
+    file->handle = NULL;
+}
+
+/**
+ * Enumerate the files named in the directory's index
+ */
+int storage_list_dir(const char* directory, storage_dir_callback_t callback, void* ctx) {
+    char host_path[256], card_path[256], name[128];
+    storage_file_t file;
+
+    if (storage_root == NULL || callback == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    snprintf(card_path, sizeof(card_path), "%s/%s", directory, QEMU_STORAGE_INDEX);
+    storage_host_path(host_path, sizeof(host_path), card_path);
+    FILE* index = fopen(host_path, "r");
+    if (index == NULL) {
+        return STORAGE_ERROR_NO_FILE;
+    }
+
+    while (fgets(name, sizeof(name), index)) {
+        name[strcspn(name, "\r\n")] = '\0';
+        if (name[0] == '\0') continue;
+
+        snprintf(card_path, sizeof(card_path), "%s/%s", directory, name);
+        if (storage_open(&file, card_path) == STORAGE_OK) {
+            storage_close(&file);
+            callback(card_path, file.size, ctx);
+        }
+    }
+    fclose(index);
+
+    return STORAGE_OK;
+}
@@ -0,0 +1,206 @@
+/**
+ * QEMU Target Test - System Glue
+ *
+ * The firmware image for QEMU runs the real src/system.c (clock setup,
+ * SysTick, WFI idle) on an emulated Cortex-M4. The audio and button
+ * peripherals QEMU's STM32F405 does not model are replaced by the sim/
+ * models, clocked from the SysTick time base instead of the host
+ * simulation's virtual clock:
+ *
+ * - system_init(), system_get_tick() and the cycle counter are wrapped at
+ *   link time (-Wl,--wrap); the wrapper of system_get_tick() runs the
+ *   button script and the I2S model once per main loop pass, cycles come
+ *   from SysTick because QEMU does not model the DWT
+ * - configuration comes from the semihosting command line as key=value
+ *   words (sdcard=DIR script=FILE duration_ms=N), the same names as the
+ *   WALKMAN_SIM_* environment variables of the host build
+ * - player state changes are traced as "[qemu] ..." lines for the
+ *   scenario expectations of qemu_test.py
+ */
+
+#include "system.h"
+#include "sim.h"
+#include "player.h"
+#include "i2s.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define QEMU_CMDLINE_LEN    512
+#define QEMU_MAX_ARGS       16
+
+/* ARM semihosting operations */
+#define SEMIHOST_SYS_GET_CMDLINE    0x15
+
+void initialise_monitor_handles(void);
+
+void __real_system_init(void);
+uint32_t __real_system_get_tick(void);
+
+static char qemu_cmdline[QEMU_CMDLINE_LEN];
+static const char* qemu_args[QEMU_MAX_ARGS];
+static int qemu_arg_count = 0;
+static uint32_t qemu_limit_ms = 0;
+static uint8_t qemu_in_models = 0;
+
+/* Last traced player state */
+static struct {
+    uint8_t is_playing;
+    uint8_t is_paused;
+    uint8_t volume;
+    char file[MAX_FILENAME_LEN];
+} qemu_trace;
+
+static int qemu_semihost(int op, void* arg) {
+    register int r0 __asm__("r0") = op;
+    register void* r1 __asm__("r1") = arg;
+    __asm__ volatile ("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+    return r0;
+}
+
+/**
+ * Split the semihosting command line into key=value words
+ */
+static void qemu_parse_cmdline(void) {
+    struct {
+        char* buffer;
+        int length;
+    } block = { qemu_cmdline, sizeof(qemu_cmdline) - 1 };
+
+    if (qemu_semihost(SEMIHOST_SYS_GET_CMDLINE, &block) != 0) {
+        return;
+    }
+    qemu_cmdline[block.length] = '\0';
+
+    for (char* word = strtok(qemu_cmdline, " "); word && qemu_arg_count < QEMU_MAX_ARGS;
+         word = strtok(NULL, " ")) {
+        if (strchr(word, '=')) qemu_args[qemu_arg_count++] = word;
+    }
+}
+
+/**
+ * Configuration lookup: WALKMAN_SIM_SDCARD is read from "sdcard=..."
+ */
+const char* sim_config(const char* name, const char* default_value) {
+    const char* key = strncmp(name, "WALKMAN_SIM_", 12) == 0 ? name + 12 : name;
+    size_t key_len = strlen(key);
+
+    for (int i = 0; i < qemu_arg_count; i++) {
+        if (strncasecmp(qemu_args[i], key, key_len) == 0 && qemu_args[i][key_len] == '=') {
+            const char* value = qemu_args[i] + key_len + 1;
+            return value[0] ? value : default_value;
+        }
+    }
+    return default_value;
+}
+
+/**
+ * Time since boot from the tick count and the SysTick down-counter
+ */
+uint64_t sim_time_ns(void) {
+    uint32_t tick, val;
+
+    do {
+        tick = __real_system_get_tick();
+        val = SysTick->VAL;
+    } while (tick != __real_system_get_tick());
+
+    uint32_t elapsed = SysTick->LOAD - val;
+    return (uint64_t)tick * SIM_NS_PER_MS +
+           (uint64_t)elapsed * SIM_NS_PER_SEC / SYSTEM_CLOCK_HZ;
+}
+
+/* Time is real SysTick time here; the models cannot move it */
+void sim_advance_ns(uint64_t ns) {
+    (void)ns;
+}
+
+/* No framebuffer in the target image (see qemu_spi.c) */
+int sim_lcd_dump_ppm(const char* path) {
+    (void)path;
+    return -1;
+}
+
+/**
+ * Print player state changes (track, pause, volume)
+ */
+static void qemu_trace_player(void) {
+    player_t* state = player_get_state();
+
+    if (state->is_playing &&
+        (!qemu_trace.is_playing || strcmp(state->current_file, qemu_trace.file) != 0)) {
+        printf("[qemu] play %s\n", state->current_file);
+    } else if (!state->is_playing && qemu_trace.is_playing) {
+        printf("[qemu] stop\n");
+    }
+    if (state->is_playing && state->is_paused != qemu_trace.is_paused) {
+        printf("[qemu] %s\n", state->is_paused ? "pause" : "resume");
+    }
+    if (state->volume != qemu_trace.volume) {
+        printf("[qemu] volume %u\n", state->volume);
+    }
+
+    qemu_trace.is_playing = state->is_playing;
+    qemu_trace.is_paused = state->is_playing ? state->is_paused : 0;
+    qemu_trace.volume = state->volume;
+    strncpy(qemu_trace.file, state->current_file, sizeof(qemu_trace.file) - 1);
+}
+
+static void qemu_exit_handler(void) {
+    printf("[qemu] exit at %lu ms, i2s errors %lu\n",
+           (unsigned long)__real_system_get_tick(), (unsigned long)i2s_get_errors());
+}
+
+/**
+ * Semihosting I/O and configuration ahead of the real clock setup
+ */
+void __wrap_system_init(void) {
+    initialise_monitor_handles();
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    __real_system_init();
+
+    qemu_parse_cmdline();
+    qemu_limit_ms = strtoul(sim_config("WALKMAN_SIM_DURATION_MS", "30000"), NULL, 10);
+    atexit(qemu_exit_handler);
+
+    sim_script_load(sim_config("WALKMAN_SIM_SCRIPT", NULL));
+
+    printf("[qemu] STM32F407 image under QEMU, SD card root '%s'\n",
+           sim_config("WALKMAN_SIM_SDCARD", "sdcard"));
+}
+
+/* DWT is not modelled; see __wrap_system_get_cycles() */
+void __wrap_system_cycles_init(void) {
+}
+
+/**
+ * Core clock cycles since boot from the SysTick time base
+ */
+uint32_t __wrap_system_get_cycles(void) {
+    return (uint32_t)(sim_time_ns() * (SYSTEM_CLOCK_HZ / 1000000) / 1000);
+}
+
+/**
+ * Tick read of the main loop: run the peripheral models up to now
+ */
+uint32_t __wrap_system_get_tick(void) {
+    uint32_t tick = __real_system_get_tick();
+
+    if (!qemu_in_models) {
+        qemu_in_models = 1;
+        uint64_t now = sim_time_ns();
+        sim_script_run(now);
+        sim_i2s_run(now);
+        qemu_trace_player();
+        qemu_in_models = 0;
+
+        if (tick >= qemu_limit_ms) {
+            printf("[qemu] run time limit reached\n");
+            exit(0);
+        }
+    }
+    return tick;
+}
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+QEMU target smoke and timing test.
+
+Boots the firmware image built for QEMU (make qemu-elf) on an emulated
+STM32F4 (netduinoplus2 by default) once per scenario in qemu/scenarios:
+
+- the SD card is a host directory with the generated test tones and a
+  ".index" file per directory (semihosting cannot list directories)
+- the scenario file is the button script (sim/ format); its
+  "# expect: <text>" comment lines must appear in the semihosted trace in
+  that order
+- with -icount the guest clock advances one virtual ns per instruction,
+  so a run is deterministic; with the TCG insn plugin (--plugin
+  .../libinsn.so) the executed instructions are counted and compared
+  against qemu/baseline.json
+
+Usage: qemu_test.py --elf build/qemu/walkman_f407_qemu.elf
+                    [--plugin libinsn.so] [--update-baseline] [names...]
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+SCENARIOS = os.path.join(HERE, "scenarios")
+BASELINE = os.path.join(HERE, "baseline.json")
+MAKE_TONES = os.path.join(ROOT, "sim", "make_test_tones.py")
+
+# Instruction count growth over the baseline that fails the run
+DEFAULT_TOLERANCE = 0.05
+TIMEOUT_S = 300
+
+
+def load_expectations(path):
+    """Ordered trace substrings from the scenario's "# expect:" lines"""
+    expect = []
+    with open(path) as f:
+        for line in f:
+            m = re.match(r"\s*#\s*expect:\s*(.*?)\s*$", line)
+            if m:
+                expect.append(m.group(1))
+    return expect
+
+
+def make_sdcard(root):
+    """Card image with the test tones and directory indexes"""
+    music = os.path.join(root, "music")
+    os.makedirs(music)
+    subprocess.run([sys.executable, MAKE_TONES, music], check=True,
+                   stdout=subprocess.DEVNULL)
+    for dirpath, _, files in os.walk(root):
+        names = sorted(n for n in files if not n.startswith("."))
+        with open(os.path.join(dirpath, ".index"), "w") as f:
+            f.write("".join(n + "\n" for n in names))
+
+
+def run_qemu(args, scenario, workdir):
+    """Run one scenario; returns (trace, instructions or None, exit code)"""
+    shutil.copy(scenario, os.path.join(workdir, "scenario.txt"))
+    make_sdcard(os.path.join(workdir, "sdcard"))
+
+    semihosting = ",".join(["enable=on", "target=native", "arg=walkman",
+                            "arg=sdcard=sdcard", "arg=script=scenario.txt",
+                            "arg=duration_ms=%d" % args.duration_ms])
+    cmd = [args.qemu, "-M", args.machine, "-nographic", "-monitor", "none",
+           "-serial", "null", "-kernel", os.path.abspath(args.elf),
+           "-icount", "shift=0,align=off,sleep=off",
+           "-semihosting-config", semihosting]
+    log = os.path.join(workdir, "plugin.log")
+    if args.plugin:
+        cmd += ["-plugin", args.plugin, "-d", "plugin", "-D", log]
+
+    proc = subprocess.run(cmd, cwd=workdir, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, timeout=TIMEOUT_S)
+    trace = proc.stdout.decode(errors="replace")
+
+    insns = None
+    if args.plugin and os.path.exists(log):
+        with open(log) as f:
+            counts = re.findall(r"insns:\s*(\d+)", f.read())
+        if counts:
+            insns = sum(int(c) for c in counts)
+    return trace, insns, proc.returncode
+
+
+def check_trace(trace, expect):
+    """First expectation not found after the previous one, or None"""
+    pos = 0
+    for text in expect:
+        found = trace.find(text, pos)
+        if found < 0:
+            return text
+        pos = found + len(text)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--elf", required=True, help="firmware image for QEMU")
+    parser.add_argument("--qemu", default="qemu-system-arm")
+    parser.add_argument("--machine", default="netduinoplus2")
+    parser.add_argument("--plugin", help="TCG instruction counting plugin (libinsn.so)")
+    parser.add_argument("--duration-ms", type=int, default=30000,
+                        help="guest run time limit per scenario")
+    parser.add_argument("--tolerance", type=float, default=DEFAULT_TOLERANCE,
+                        help="allowed instruction count growth (fraction)")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="record instruction counts in baseline.json")
+    parser.add_argument("--report", help="write JSON report")
+    parser.add_argument("--verbose", action="store_true", help="print the guest trace")
+    parser.add_argument("names", nargs="*", help="scenarios to run (default: all)")
+    args = parser.parse_args()
+
+    baseline = {}
+    if os.path.exists(BASELINE):
+        with open(BASELINE) as f:
+            baseline = json.load(f)
+
+    names = args.names or sorted(n[:-4] for n in os.listdir(SCENARIOS) if n.endswith(".txt"))
+    report = {"machine": args.machine, "scenarios": {}}
+    failures = 0
+
+    for name in names:
+        scenario = os.path.join(SCENARIOS, name + ".txt")
+        workdir = tempfile.mkdtemp(prefix="qemu_")
+        try:
+            trace, insns, code = run_qemu(args, scenario, workdir)
+        finally:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+        result = {"insns": insns, "exit_code": code}
+        m = re.search(r"\[qemu\] exit at (\d+) ms", trace)
+        if m:
+            result["guest_ms"] = int(m.group(1))
+
+        missing = check_trace(trace, load_expectations(scenario))
+        reference = baseline.get(name, {}).get("insns")
+        if code != 0:
+            result["error"] = "QEMU exited with %d" % code
+        elif missing is not None:
+            result["error"] = "expected '%s' in trace" % missing
+        elif insns and reference and not args.update_baseline and \
+                insns > reference * (1 + args.tolerance):
+            result["error"] = "%d instructions, baseline %d (+%.1f%%)" % (
+                insns, reference, 100.0 * (insns - reference) / reference)
+        if args.update_baseline and insns and "error" not in result:
+            baseline[name] = {"insns": insns}
+        report["scenarios"][name] = result
+
+        status = "FAIL" if "error" in result else "ok"
+        failures += status == "FAIL"
+        detail = result.get("error") or (
+            "%d instructions" % insns if insns else "trace ok (no insn plugin)")
+        if insns and reference:
+            detail += " (baseline %d, %+.1f%%)" % (reference, 100.0 * (insns - reference) / reference)
+        print("%-12s %-4s %s" % (name, status, detail))
+        if args.verbose or status == "FAIL":
+            sys.stdout.write(trace)
+
+    if args.update_baseline:
+        with open(BASELINE, "w") as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Updated %s" % BASELINE)
+
+    if args.report:
+        with open(args.report, "w") as f:
+            json.dump(report, f, indent=2)
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
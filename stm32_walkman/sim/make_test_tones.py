@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+Generate short 16-bit WAV test tones for the host simulation.
+
+Usage: make_test_tones.py <output_dir>
+"""
+
+import math
+import os
+import struct
+import sys
+import wave
+
+TONES = [
+    # name, frequency (Hz), seconds, channels, sample rate
+    ("01_tone_440.wav", 440.0, 3.0, 2, 44100),
+    ("02_tone_1k_mono.wav", 1000.0, 2.0, 1, 44100),
+    ("03_tone_220_48k.wav", 220.0, 2.0, 2, 48000),
+]
+
+
+def write_tone(path, freq, seconds, channels, rate):
+    """Write a sine tone at -6 dBFS; right channel is phase shifted."""
+    frames = int(seconds * rate)
+    with wave.open(path, "wb") as w:
+        w.setnchannels(channels)
+        w.setsampwidth(2)
+        w.setframerate(rate)
+        data = bytearray()
+        for n in range(frames):
+            phase = 2.0 * math.pi * freq * n / rate
+            left = int(16384 * math.sin(phase))
+            data += struct.pack("<h", left)
+            if channels == 2:
+                data += struct.pack("<h", int(16384 * math.sin(phase + math.pi / 2)))
+        w.writeframes(bytes(data))
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 1
+    out_dir = sys.argv[1]
+    os.makedirs(out_dir, exist_ok=True)
+    for name, freq, seconds, channels, rate in TONES:
+        path = os.path.join(out_dir, name)
+        if not os.path.exists(path):
+            write_tone(path, freq, seconds, channels, rate)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,55 @@
+/**
+ * Host Simulation - Shared Definitions
+ *
+ * The simulation build links the application layer (player, codec, LCD,
+ * buttons, main) against simulated versions of the bare metal drivers:
+ * - system: virtual clock; every tick read costs SIM_POLL_COST_NS
+ * - i2s:    DMA consumed at the sample rate, written to a WAV file
+ * - spi:    ILI9341 command model rendering into a framebuffer (PPM dump)
+ * - i2c:    WM8994 register file
+ * - gpio:   pin levels, buttons driven by a timed script
+ * - storage: SD card mapped onto a host directory
+ * - flash:  internal flash bank backed by a host file
+ * - stats:  player stage timing written at exit (host ns)
+ *
+ * Configuration comes from environment variables (see sim_system.c).
+ */
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdint.h>
+#include "gpio.h"
+
+/* Virtual time charged per system_get_tick() call (one main-loop poll) */
+#define SIM_POLL_COST_NS    10000ULL
+
+#define SIM_NS_PER_MS       1000000ULL
+#define SIM_NS_PER_SEC      1000000000ULL
+
+/* Virtual clock */
+uint64_t sim_time_ns(void);
+void sim_advance_ns(uint64_t ns);
+
+/* Configuration lookup (environment with default) */
+const char* sim_config(const char* name, const char* default_value);
+
+/* Button script (sim_script.c) */
+void sim_script_load(const char* path);
+void sim_script_run(uint64_t now_ns);
+
+/* GPIO model (sim_gpio.c) */
+void sim_gpio_drive(gpio_port_t port, gpio_pin_t pin, uint8_t level);
+uint8_t sim_gpio_level(gpio_port_t port, gpio_pin_t pin);
+
+/* I2S model (sim_i2s.c) */
+void sim_i2s_run(uint64_t now_ns);
+void sim_i2s_open_output(const char* path);
+
+/* LCD model (sim_spi.c) */
+int sim_lcd_dump_ppm(const char* path);
+
+/* Audio pipeline profile as JSON (sim_stats.c) */
+int sim_stats_write(const char* path);
+
+#endif /* __SIM_H__ */
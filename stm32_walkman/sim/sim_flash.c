@@ -0,0 +1,113 @@
+/**
+ * Host Simulation - Internal Flash
+ * The 1 MB main bank in memory, blank at start. With WALKMAN_SIM_FLASH set
+ * it is loaded from and written through to that host file, so state
+ * survives between runs. NOR rules hold: programming only clears bits, an
+ * erase sets the sector to 0xFF.
+ */
+
+#include "flash.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t sim_flash[FLASH_MEMORY_SIZE];
+static uint8_t sim_flash_loaded = 0;
+static const char* sim_flash_path = NULL;
+
+/* Sector sizes in KB */
+static const uint16_t sim_flash_sector_kb[FLASH_SECTOR_COUNT] = {
+    16, 16, 16, 16, 64, 128, 128, 128, 128, 128, 128, 128
+};
+
+/**
+ * Load the image on first use (a missing file is a blank chip)
+ */
+static void sim_flash_load(void) {
+    if (sim_flash_loaded) return;
+
+    sim_flash_loaded = 1;
+    sim_flash_path = sim_config("WALKMAN_SIM_FLASH", NULL);
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    if (sim_flash_path == NULL) return;
+
+    FILE* f = fopen(sim_flash_path, "rb");
+    if (f != NULL) {
+        if (fread(sim_flash, 1, sizeof(sim_flash), f) != sizeof(sim_flash)) {
+            memset(sim_flash, 0xFF, sizeof(sim_flash));
+        }
+        fclose(f);
+    }
+}
+
+static void sim_flash_store(uint32_t offset, uint32_t len) {
+    if (sim_flash_path == NULL) return;
+
+    FILE* f = fopen(sim_flash_path, "r+b");
+    if (f == NULL) {
+        f = fopen(sim_flash_path, "wb");
+        if (f == NULL) return;
+        fwrite(sim_flash, 1, sizeof(sim_flash), f);
+    } else {
+        fseek(f, offset, SEEK_SET);
+        fwrite(sim_flash + offset, 1, len, f);
+    }
+    fclose(f);
+}
+
+uint32_t flash_sector_address(uint8_t sector) {
+    if (sector >= FLASH_SECTOR_COUNT) return 0;
+
+    uint32_t address = FLASH_MEMORY_BASE;
+    for (uint8_t i = 0; i < sector; i++) {
+        address += sim_flash_sector_kb[i] * 1024u;
+    }
+    return address;
+}
+
+uint32_t flash_sector_size(uint8_t sector) {
+    return sector < FLASH_SECTOR_COUNT ? sim_flash_sector_kb[sector] * 1024u : 0;
+}
+
+int flash_erase_sector(uint8_t sector) {
+    if (sector >= FLASH_SECTOR_COUNT) return FLASH_ERROR_ARGUMENT;
+
+    sim_flash_load();
+    uint32_t offset = flash_sector_address(sector) - FLASH_MEMORY_BASE;
+    uint32_t size = flash_sector_size(sector);
+    memset(sim_flash + offset, 0xFF, size);
+    sim_flash_store(offset, size);
+
+    /* 128 KB sector: ~1 s with the core stalled */
+    sim_advance_ns((uint64_t)size * 8000ULL);
+    return FLASH_OK;
+}
+
+int flash_program(uint32_t address, const void* data, uint32_t len) {
+    const uint8_t* src = (const uint8_t*)data;
+
+    if ((address & 3) || (len & 3) || address < FLASH_MEMORY_BASE ||
+        address - FLASH_MEMORY_BASE + len > FLASH_MEMORY_SIZE) {
+        return FLASH_ERROR_ARGUMENT;
+    }
+
+    sim_flash_load();
+    uint32_t offset = address - FLASH_MEMORY_BASE;
+    for (uint32_t i = 0; i < len; i++) {
+        sim_flash[offset + i] &= src[i];
+    }
+    sim_flash_store(offset, len);
+
+    /* ~16 us per word */
+    sim_advance_ns((uint64_t)(len / 4) * 16000ULL);
+    return FLASH_OK;
+}
+
+void flash_read(uint32_t address, void* data, uint32_t len) {
+    sim_flash_load();
+    if (address < FLASH_MEMORY_BASE || address - FLASH_MEMORY_BASE + len > FLASH_MEMORY_SIZE) {
+        memset(data, 0xFF, len);
+        return;
+    }
+    memcpy(data, sim_flash + (address - FLASH_MEMORY_BASE), len);
+}
@@ -0,0 +1,166 @@
+/**
+ * Host Simulation - GPIO
+ * Pin levels per port; inputs are driven by sim_gpio_drive() (button
+ * script), outputs by the firmware. Falling/rising edges on EXTI-enabled
+ * pins raise the pending flag and call the firmware's EXTI handler.
+ */
+
+#include "gpio.h"
+#include "sim.h"
+#include <stddef.h>
+
+#define SIM_GPIO_PORTS 9
+
+typedef struct {
+    uint16_t level;      // Current pin levels
+    uint16_t driven;     // Pins with an external driver (script)
+    uint16_t output;     // Pins configured as outputs
+} sim_gpio_port_t;
+
+static sim_gpio_port_t sim_ports[SIM_GPIO_PORTS];
+
+/* EXTI model */
+static uint16_t exti_rising = 0;
+static uint16_t exti_falling = 0;
+static uint16_t exti_mask = 0;
+static volatile uint16_t exti_pending = 0;
+
+/* Firmware interrupt handlers (buttons.c) */
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+
+static void sim_exti_dispatch(gpio_pin_t pin) {
+    switch (pin) {
+        case 0: EXTI0_IRQHandler(); break;
+        case 1: EXTI1_IRQHandler(); break;
+        case 2: EXTI2_IRQHandler(); break;
+        default:
+            if (pin >= 10) EXTI15_10_IRQHandler();
+            break;
+    }
+}
+
+void gpio_init_port(gpio_port_t port) {
+    (void)port;
+}
+
+void gpio_config(gpio_port_t port, gpio_pin_t pin, gpio_mode_t mode,
+                 gpio_output_t output_type, gpio_speed_t speed, gpio_pull_t pull) {
+    (void)output_type;
+    (void)speed;
+    if (port >= SIM_GPIO_PORTS || pin >= 16) return;
+
+    sim_gpio_port_t* p = &sim_ports[port];
+    uint16_t bit = 1 << pin;
+
+    if (mode == GPIO_MODE_OUTPUT) {
+        p->output |= bit;
+    } else {
+        p->output &= ~bit;
+    }
+
+    /* Undriven inputs follow the pull resistor */
+    if (!(p->driven & bit) && !(p->output & bit)) {
+        if (pull == GPIO_PULL_UP) {
+            p->level |= bit;
+        } else if (pull == GPIO_PULL_DOWN) {
+            p->level &= ~bit;
+        }
+    }
+}
+
+void gpio_config_alt_func(gpio_port_t port, gpio_pin_t pin, uint8_t alt_func) {
+    (void)port;
+    (void)pin;
+    (void)alt_func;
+}
+
+void gpio_set(gpio_port_t port, gpio_pin_t pin) {
+    if (port >= SIM_GPIO_PORTS || pin >= 16) return;
+    sim_ports[port].level |= (1 << pin);
+}
+
+void gpio_clear(gpio_port_t port, gpio_pin_t pin) {
+    if (port >= SIM_GPIO_PORTS || pin >= 16) return;
+    sim_ports[port].level &= ~(1 << pin);
+}
+
+void gpio_toggle(gpio_port_t port, gpio_pin_t pin) {
+    if (port >= SIM_GPIO_PORTS || pin >= 16) return;
+    sim_ports[port].level ^= (1 << pin);
+}
+
+uint8_t gpio_read(gpio_port_t port, gpio_pin_t pin) {
+    return sim_gpio_level(port, pin);
+}
+
+void gpio_write(gpio_port_t port, gpio_pin_t pin, uint8_t value) {
+    if (value) {
+        gpio_set(port, pin);
+    } else {
+        gpio_clear(port, pin);
+    }
+}
+
+void gpio_config_interrupt(gpio_port_t port, gpio_pin_t pin, gpio_int_trigger_t trigger) {
+    if (port >= SIM_GPIO_PORTS || pin >= 16) return;
+
+    gpio_config(port, pin, GPIO_MODE_INPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_PULL_UP);
+
+    uint16_t bit = 1 << pin;
+    exti_rising &= ~bit;
+    exti_falling &= ~bit;
+    if (trigger == GPIO_INT_RISING || trigger == GPIO_INT_BOTH) exti_rising |= bit;
+    if (trigger == GPIO_INT_FALLING || trigger == GPIO_INT_BOTH) exti_falling |= bit;
+    exti_mask |= bit;
+}
+
+void gpio_set_interrupt_priority(gpio_pin_t pin, uint8_t priority) {
+    (void)pin;
+    (void)priority;
+}
+
+uint8_t gpio_exti_pending(gpio_pin_t pin) {
+    if (pin >= 16) return 0;
+    return (exti_pending >> pin) & 1;
+}
+
+void gpio_exti_clear(gpio_pin_t pin) {
+    if (pin >= 16) return;
+    exti_pending &= ~(1 << pin);
+}
+
+/**
+ * Drive an input pin from outside (button script)
+ */
+void sim_gpio_drive(gpio_port_t port, gpio_pin_t pin, uint8_t level) {
+    if (port >= SIM_GPIO_PORTS || pin >= 16) return;
+
+    sim_gpio_port_t* p = &sim_ports[port];
+    uint16_t bit = 1 << pin;
+    uint8_t old = (p->level & bit) ? 1 : 0;
+
+    p->driven |= bit;
+    if (level) {
+        p->level |= bit;
+    } else {
+        p->level &= ~bit;
+    }
+
+    if (old != level && (exti_mask & bit)) {
+        if ((level && (exti_rising & bit)) || (!level && (exti_falling & bit))) {
+            exti_pending |= bit;
+            sim_exti_dispatch(pin);
+        }
+    }
+}
+
+/**
+ * Current level of a pin
+ */
+uint8_t sim_gpio_level(gpio_port_t port, gpio_pin_t pin) {
+    if (port >= SIM_GPIO_PORTS || pin >= 16) return 0;
+    return (sim_ports[port].level >> pin) & 1;
+}
@@ -0,0 +1,84 @@
+/**
+ * Host Simulation - I2C with WM8994 Register Model
+ *
+ * The codec answers at 7-bit address 0x1A. A write of two bytes sets the
+ * 16-bit register pointer, a write of four bytes stores a 16-bit value
+ * (both MSB first), reads return the addressed register. Register 0 reads
+ * back the chip ID and a write to it resets the register file. Registers
+ * from WM8994_REGS on are not modelled: writes are dropped, reads return
+ * 0. Other addresses NACK. Bus time is charged at 9 bits per byte.
+ */
+
+#include "i2c.h"
+#include "sim.h"
+#include <string.h>
+
+#define WM8994_I2C_ADDR 0x1A
+#define WM8994_CHIP_ID  0x8994
+#define WM8994_REGS     0x0800
+
+static uint32_t i2c_clock[4];
+
+static struct {
+    uint16_t regs[WM8994_REGS];
+    uint16_t pointer;
+} wm8994;
+
+static void sim_i2c_charge(i2c_bus_t bus, uint32_t bytes) {
+    if (i2c_clock[bus] == 0) return;
+    /* START + address byte + data bytes, 9 clocks per byte */
+    sim_advance_ns((uint64_t)(bytes + 1) * 9 * SIM_NS_PER_SEC / i2c_clock[bus]);
+}
+
+void i2c_init(i2c_bus_t bus, uint32_t clock_speed) {
+    if (bus < 1 || bus > 3) return;
+    i2c_clock[bus] = clock_speed;
+
+    if (bus == I2C_BUS_1) {
+        memset(&wm8994, 0, sizeof(wm8994));
+        wm8994.regs[0] = WM8994_CHIP_ID;
+    }
+}
+
+int i2c_write(i2c_bus_t bus, uint8_t addr, const uint8_t* data, uint32_t len) {
+    if (!data || len == 0 || bus < 1 || bus > 3) return -1;
+    sim_i2c_charge(bus, len);
+
+    if (bus != I2C_BUS_1 || addr != WM8994_I2C_ADDR) return -1;  /* NACK */
+
+    if (len < 2) return 0;
+    wm8994.pointer = ((uint16_t)data[0] << 8) | data[1];
+    if (len >= 4) {
+        uint16_t value = ((uint16_t)data[2] << 8) | data[3];
+        if (wm8994.pointer == 0) {
+            memset(wm8994.regs, 0, sizeof(wm8994.regs));
+            wm8994.regs[0] = WM8994_CHIP_ID;
+        } else if (wm8994.pointer < WM8994_REGS) {
+            wm8994.regs[wm8994.pointer] = value;
+        }
+    }
+    return 0;
+}
+
+int i2c_read(i2c_bus_t bus, uint8_t addr, uint8_t* data, uint32_t len) {
+    if (!data || len == 0 || bus < 1 || bus > 3) return -1;
+    sim_i2c_charge(bus, len);
+
+    if (bus != I2C_BUS_1 || addr != WM8994_I2C_ADDR) return -1;  /* NACK */
+
+    uint16_t value = (wm8994.pointer < WM8994_REGS) ? wm8994.regs[wm8994.pointer] : 0;
+    for (uint32_t i = 0; i < len; i++) {
+        data[i] = (i & 1) ? (value & 0xFF) : (value >> 8);
+    }
+    return 0;
+}
+
+int i2c_write_read(i2c_bus_t bus, uint8_t addr, uint8_t reg, uint8_t* data, uint32_t len) {
+    if (i2c_write(bus, addr, &reg, 1) != 0) return -1;
+    return i2c_read(bus, addr, data, len);
+}
+
+uint8_t i2c_is_busy(i2c_bus_t bus) {
+    (void)bus;
+    return 0;
+}
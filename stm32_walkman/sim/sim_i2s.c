@@ -0,0 +1,185 @@
+/**
+ * Host Simulation - I2S3 with Circular DMA
+ *
+ * While the stream runs, frames are consumed from the DMA buffer at the
+ * configured sample rate of the virtual clock and appended to a 16-bit
+ * stereo WAV file. Crossing the middle or the end of the buffer invokes
+ * the half/complete callback exactly like the DMA1 Stream 5 interrupt.
+ */
+
+#include "i2s.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct {
+    uint32_t sample_rate;
+    const int16_t* buffer;
+    uint32_t samples;        // Buffer length in samples (2 per frame)
+    uint32_t pos;            // Next sample to send
+    uint8_t running;
+    uint8_t paused;
+    uint8_t complete;
+    uint64_t last_ns;
+    uint64_t frame_acc;      // Remainder of (elapsed ns * rate)
+    i2s_callback_t callback;
+} i2s;
+
+static FILE* wav_file = NULL;
+static uint32_t wav_frames = 0;
+static uint32_t wav_rate = 0;
+
+static void wav_put_le32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static void wav_write_header(void) {
+    uint8_t h[44];
+    uint32_t data_bytes = wav_frames * 4;
+
+    memcpy(h, "RIFF", 4);
+    wav_put_le32(h + 4, 36 + data_bytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    wav_put_le32(h + 16, 16);
+    h[20] = 1; h[21] = 0;                    /* PCM */
+    h[22] = 2; h[23] = 0;                    /* Stereo */
+    wav_put_le32(h + 24, wav_rate);
+    wav_put_le32(h + 28, wav_rate * 4);
+    h[32] = 4; h[33] = 0;                    /* Block align */
+    h[34] = 16; h[35] = 0;                   /* Bits per sample */
+    memcpy(h + 36, "data", 4);
+    wav_put_le32(h + 40, data_bytes);
+
+    fseek(wav_file, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), wav_file);
+    fseek(wav_file, 0, SEEK_END);
+}
+
+static void wav_close(void) {
+    if (wav_file == NULL) return;
+    wav_write_header();
+    fclose(wav_file);
+    wav_file = NULL;
+    printf("[sim] I2S capture: %u frames at %u Hz\n", wav_frames, wav_rate);
+}
+
+/**
+ * Open the capture file; the header is finalized at exit
+ */
+void sim_i2s_open_output(const char* path) {
+    wav_file = fopen(path, "wb");
+    if (wav_file == NULL) {
+        fprintf(stderr, "[sim] cannot create %s\n", path);
+        return;
+    }
+    wav_rate = 44100;
+    wav_write_header();
+    atexit(wav_close);
+}
+
+static void sim_i2s_emit(const int16_t* samples, uint32_t count) {
+    if (wav_file == NULL) return;
+    if (wav_frames == 0) {
+        wav_rate = i2s.sample_rate;
+    } else if (wav_rate != i2s.sample_rate) {
+        fprintf(stderr, "[sim] warning: I2S rate changed to %u Hz during capture\n",
+                i2s.sample_rate);
+        wav_rate = i2s.sample_rate;
+    }
+    fwrite(samples, sizeof(int16_t), count, wav_file);
+    wav_frames += count / 2;
+}
+
+/**
+ * Consume frames due up to now, firing half/complete callbacks
+ */
+void sim_i2s_run(uint64_t now_ns) {
+    uint64_t elapsed = now_ns - i2s.last_ns;
+    i2s.last_ns = now_ns;
+
+    if (!i2s.running || i2s.paused) {
+        i2s.frame_acc = 0;
+        return;
+    }
+
+    i2s.frame_acc += elapsed * i2s.sample_rate;
+    uint64_t frames = i2s.frame_acc / SIM_NS_PER_SEC;
+    i2s.frame_acc %= SIM_NS_PER_SEC;
+
+    uint32_t half = i2s.samples / 2;
+    while (frames > 0 && i2s.running && !i2s.paused) {
+        uint32_t boundary = (i2s.pos < half) ? half : i2s.samples;
+        uint32_t chunk = boundary - i2s.pos;
+        if ((uint64_t)chunk > frames * 2) chunk = (uint32_t)frames * 2;
+
+        sim_i2s_emit(&i2s.buffer[i2s.pos], chunk);
+        i2s.pos += chunk;
+        frames -= chunk / 2;
+
+        if (i2s.pos == half) {
+            if (i2s.callback) i2s.callback(0);
+        } else if (i2s.pos == i2s.samples) {
+            i2s.pos = 0;
+            i2s.complete = 1;
+            if (i2s.callback) i2s.callback(1);
+        }
+    }
+}
+
+void i2s_init(i2s_sample_rate_t sample_rate) {
+    i2s.sample_rate = sample_rate;
+    i2s.running = 0;
+    i2s.complete = 0;
+}
+
+void i2s_set_callback(i2s_callback_t callback) {
+    i2s.callback = callback;
+}
+
+void i2s_start_dma(const int16_t* buffer, uint32_t samples) {
+    if (!buffer || samples == 0) return;
+
+    i2s.buffer = buffer;
+    i2s.samples = samples & ~3u;  /* Whole stereo frames per half */
+    i2s.pos = 0;
+    i2s.running = 1;
+    i2s.paused = 0;
+    i2s.complete = 0;
+    i2s.frame_acc = 0;
+    i2s.last_ns = sim_time_ns();
+}
+
+void i2s_stop(void) {
+    i2s.running = 0;
+}
+
+void i2s_pause(void) {
+    i2s.paused = 1;
+}
+
+void i2s_resume(void) {
+    i2s.last_ns = sim_time_ns();
+    i2s.paused = 0;
+}
+
+uint32_t i2s_get_position(void) {
+    return i2s.pos;
+}
+
+/* Callbacks only run while the virtual clock advances: nothing to hold */
+void i2s_hold_callback(uint8_t hold) {
+    (void)hold;
+}
+
+uint8_t i2s_dma_complete(void) {
+    return i2s.complete;
+}
+
+uint32_t i2s_get_errors(void) {
+    return 0;
+}
+
+uint32_t i2s_get_fifo_errors(void) {
+    return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * Host Simulation - Button Script
+ *
+ * One event per line, times in virtual milliseconds since boot:
+ *
+ *   # comment
+ *   500   tap play          press, release after SIM_TAP_MS
+ *   3000  hold next 1500    press, release after 1500 ms
+ *   4000  press volup
+ *   4100  release volup
+ *   6000  snap frame.ppm    dump the LCD framebuffer
+ *   7000  expect volume 65  player state, exit 1 on a mismatch
+ *   7000  expect position 2500 100   ... within a tolerance
+ *   9000  quit
+ *
+ * Buttons: prev play next volup voldown shuffle loop (wiring of buttons.c)
+ * Expect keys: playing paused volume speed loudness position (ms)
+ */
+
+#include "sim.h"
+#include "player.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_SCRIPT_MAX_EVENTS 512
+#define SIM_TAP_MS 80
+
+typedef enum {
+    SIM_EV_PRESS,
+    SIM_EV_RELEASE,
+    SIM_EV_SNAP,
+    SIM_EV_EXPECT,
+    SIM_EV_QUIT
+} sim_event_type_t;
+
+typedef struct {
+    uint64_t time_ns;
+    sim_event_type_t type;
+    int button;                 // Or the expect key
+    char arg[128];
+    uint32_t value, tolerance;  // SIM_EV_EXPECT
+} sim_event_t;
+
+/* Button wiring, must match buttons.c (active low, pull-up) */
+static const struct {
+    const char* name;
+    gpio_port_t port;
+    gpio_pin_t pin;
+} sim_buttons[] = {
+    {"prev",    GPIO_PORT_D, 13},
+    {"play",    GPIO_PORT_D, 14},
+    {"next",    GPIO_PORT_D, 15},
+    {"volup",   GPIO_PORT_A, 0},
+    {"voldown", GPIO_PORT_D, 0},
+    {"shuffle", GPIO_PORT_D, 1},
+    {"loop",    GPIO_PORT_D, 2},
+};
+
+#define SIM_NUM_BUTTONS (int)(sizeof(sim_buttons) / sizeof(sim_buttons[0]))
+
+static const char* const sim_expect_keys[] = {
+    "playing", "paused", "volume", "speed", "loudness", "position"
+};
+
+#define SIM_NUM_EXPECT_KEYS (int)(sizeof(sim_expect_keys) / sizeof(sim_expect_keys[0]))
+
+static sim_event_t sim_events[SIM_SCRIPT_MAX_EVENTS];
+static int sim_event_count = 0;
+static int sim_event_next = 0;
+
+static int sim_button_lookup(const char* name) {
+    for (int i = 0; i < SIM_NUM_BUTTONS; i++) {
+        if (strcmp(sim_buttons[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int sim_expect_lookup(const char* key) {
+    for (int i = 0; i < SIM_NUM_EXPECT_KEYS; i++) {
+        if (strcmp(sim_expect_keys[i], key) == 0) return i;
+    }
+    return -1;
+}
+
+/* Player state named by an expect key (index into sim_expect_keys) */
+static uint32_t sim_expect_read(int key) {
+    const player_t* state = player_get_state();
+    switch (key) {
+        case 0: return state->is_playing;
+        case 1: return state->is_paused;
+        case 2: return state->volume;
+        case 3: return state->speed;
+        case 4: return state->loudness;
+        default: return player_get_position_ms();
+    }
+}
+
+static sim_event_t* sim_event_add(uint64_t time_ms, sim_event_type_t type) {
+    if (sim_event_count >= SIM_SCRIPT_MAX_EVENTS) {
+        fprintf(stderr, "[sim] script: too many events\n");
+        exit(2);
+    }
+    sim_event_t* ev = &sim_events[sim_event_count++];
+    memset(ev, 0, sizeof(*ev));
+    ev->time_ns = time_ms * SIM_NS_PER_MS;
+    ev->type = type;
+    return ev;
+}
+
+static int sim_event_compare(const void* a, const void* b) {
+    const sim_event_t* ea = a;
+    const sim_event_t* eb = b;
+    if (ea->time_ns != eb->time_ns) return ea->time_ns < eb->time_ns ? -1 : 1;
+    return ea < eb ? -1 : 1;
+}
+
+/**
+ * Parse script file into a time-ordered event list
+ */
+void sim_script_load(const char* path) {
+    char line[256];
+    int line_no = 0;
+
+    if (path == NULL) return;
+
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "[sim] cannot open script %s\n", path);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long t;
+        char cmd[32] = "", arg1[128] = "";
+        unsigned long long arg2 = 0, arg3 = 0;
+        line_no++;
+
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        int n = sscanf(line, "%llu %31s %127s %llu %llu", &t, cmd, arg1, &arg2, &arg3);
+        if (n <= 0) continue;
+        if (n < 2) goto bad_line;
+
+        if (strcmp(cmd, "quit") == 0) {
+            sim_event_add(t, SIM_EV_QUIT);
+        } else if (strcmp(cmd, "snap") == 0 && n >= 3) {
+            strcpy(sim_event_add(t, SIM_EV_SNAP)->arg, arg1);
+        } else if (strcmp(cmd, "expect") == 0) {
+            int key = sim_expect_lookup(arg1);
+            if (n < 4 || key < 0) goto bad_line;
+            sim_event_t* ev = sim_event_add(t, SIM_EV_EXPECT);
+            ev->button = key;
+            ev->value = (uint32_t)arg2;
+            ev->tolerance = (uint32_t)arg3;
+        } else {
+            int button = sim_button_lookup(arg1);
+            if (n < 3 || button < 0) goto bad_line;
+
+            if (strcmp(cmd, "press") == 0) {
+                sim_event_add(t, SIM_EV_PRESS)->button = button;
+            } else if (strcmp(cmd, "release") == 0) {
+                sim_event_add(t, SIM_EV_RELEASE)->button = button;
+            } else if (strcmp(cmd, "tap") == 0 || (strcmp(cmd, "hold") == 0 && n == 4)) {
+                uint64_t len = (cmd[0] == 't') ? SIM_TAP_MS : arg2;
+                sim_event_add(t, SIM_EV_PRESS)->button = button;
+                sim_event_add(t + len, SIM_EV_RELEASE)->button = button;
+            } else {
+                goto bad_line;
+            }
+        }
+        continue;
+
+    bad_line:
+        fprintf(stderr, "[sim] %s:%d: cannot parse '%s'\n", path, line_no, line);
+        exit(2);
+    }
+
+    fclose(f);
+    qsort(sim_events, sim_event_count, sizeof(sim_event_t), sim_event_compare);
+    printf("[sim] script %s: %d events\n", path, sim_event_count);
+}
+
+/**
+ * Fire all events due at or before now
+ */
+void sim_script_run(uint64_t now_ns) {
+    while (sim_event_next < sim_event_count && sim_events[sim_event_next].time_ns <= now_ns) {
+        sim_event_t* ev = &sim_events[sim_event_next++];
+
+        switch (ev->type) {
+            case SIM_EV_PRESS:
+            case SIM_EV_RELEASE:
+                printf("[sim] %llu ms: %s %s\n",
+                       (unsigned long long)(ev->time_ns / SIM_NS_PER_MS),
+                       ev->type == SIM_EV_PRESS ? "press" : "release",
+                       sim_buttons[ev->button].name);
+                sim_gpio_drive(sim_buttons[ev->button].port, sim_buttons[ev->button].pin,
+                               ev->type == SIM_EV_PRESS ? 0 : 1);
+                break;
+            case SIM_EV_SNAP:
+                if (sim_lcd_dump_ppm(ev->arg) == 0) {
+                    printf("[sim] LCD snapshot %s\n", ev->arg);
+                }
+                break;
+            case SIM_EV_EXPECT: {
+                uint32_t got = sim_expect_read(ev->button);
+                uint32_t off = (got > ev->value) ? got - ev->value : ev->value - got;
+                printf("[sim] %llu ms: %s %u (expect %u +-%u)\n",
+                       (unsigned long long)(ev->time_ns / SIM_NS_PER_MS),
+                       sim_expect_keys[ev->button], (unsigned)got,
+                       (unsigned)ev->value, (unsigned)ev->tolerance);
+                if (off > ev->tolerance) {
+                    printf("[sim] expectation failed\n");
+                    exit(1);
+                }
+                break;
+            }
+            case SIM_EV_QUIT:
+                printf("[sim] quit\n");
+                exit(0);
+        }
+    }
+}
@@ -0,0 +1,175 @@
+/**
+ * Host Simulation - SPI with ILI9341 LCD Model
+ *
+ * Bytes sent on SPI5 while the LCD chip select is low are decoded as
+ * ILI9341 commands (DC low) or parameters/pixel data (DC high):
+ * CASET 0x2A / PASET 0x2B set the window, RAMWR 0x2C streams RGB565
+ * pixels (big endian) into the framebuffer with auto-increment.
+ *
+ * Transfer time is charged to the virtual clock at the configured
+ * SPI bit rate, so display updates cost what they would on target.
+ */
+
+#include "spi.h"
+#include "sim.h"
+#include "system.h"
+#include "lcd_display.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ILI9341_CASET 0x2A
+#define ILI9341_PASET 0x2B
+#define ILI9341_RAMWR 0x2C
+
+static uint32_t spi_bit_rate[6];
+
+static struct {
+    uint16_t framebuffer[LCD_HEIGHT][LCD_WIDTH];
+    uint8_t cmd;
+    uint8_t param_index;
+    uint8_t params[4];
+    uint16_t x0, x1, y0, y1;
+    uint16_t x, y;
+    uint8_t pixel_hi;
+    uint8_t pixel_phase;
+} lcd;
+
+/**
+ * Feed one byte to the LCD controller
+ */
+static void sim_lcd_byte(uint8_t byte) {
+    if (sim_gpio_level(LCD_GPIO_PORT, LCD_CS_PIN)) return;  /* Not selected */
+
+    if (!sim_gpio_level(LCD_GPIO_PORT, LCD_DC_PIN)) {
+        lcd.cmd = byte;
+        lcd.param_index = 0;
+        lcd.pixel_phase = 0;
+        if (byte == ILI9341_RAMWR) {
+            lcd.x = lcd.x0;
+            lcd.y = lcd.y0;
+        }
+        return;
+    }
+
+    switch (lcd.cmd) {
+        case ILI9341_CASET:
+        case ILI9341_PASET:
+            if (lcd.param_index < 4) {
+                lcd.params[lcd.param_index++] = byte;
+            }
+            if (lcd.param_index == 4) {
+                uint16_t start = (lcd.params[0] << 8) | lcd.params[1];
+                uint16_t end = (lcd.params[2] << 8) | lcd.params[3];
+                if (lcd.cmd == ILI9341_CASET) {
+                    lcd.x0 = start;
+                    lcd.x1 = end;
+                } else {
+                    lcd.y0 = start;
+                    lcd.y1 = end;
+                }
+            }
+            break;
+
+        case ILI9341_RAMWR:
+            if (lcd.pixel_phase == 0) {
+                lcd.pixel_hi = byte;
+                lcd.pixel_phase = 1;
+                break;
+            }
+            lcd.pixel_phase = 0;
+            if (lcd.x < LCD_WIDTH && lcd.y < LCD_HEIGHT) {
+                lcd.framebuffer[lcd.y][lcd.x] = (lcd.pixel_hi << 8) | byte;
+            }
+            if (++lcd.x > lcd.x1) {
+                lcd.x = lcd.x0;
+                if (++lcd.y > lcd.y1) lcd.y = lcd.y0;
+            }
+            break;
+
+        default:
+            break;  /* Other commands have no visible effect */
+    }
+}
+
+/**
+ * Charge transfer time and feed bytes to devices on the bus
+ */
+static void sim_spi_transfer(spi_bus_t bus, const uint8_t* tx, uint32_t len) {
+    if (bus < 1 || bus > 5 || spi_bit_rate[bus] == 0) return;
+
+    if (bus == SPI_BUS_5 && tx) {
+        for (uint32_t i = 0; i < len; i++) sim_lcd_byte(tx[i]);
+    }
+
+    sim_advance_ns((uint64_t)len * 8 * SIM_NS_PER_SEC / spi_bit_rate[bus]);
+}
+
+void spi_init(spi_bus_t bus, spi_datasize_t datasize, spi_prescaler_t prescaler,
+              spi_cpol_t cpol, spi_cpha_t cpha) {
+    (void)datasize;
+    (void)cpol;
+    (void)cpha;
+    if (bus < 1 || bus > 5) return;
+
+    /* SPI1/4/5 on APB2, SPI2/3 on APB1 */
+    uint32_t pclk = (bus == SPI_BUS_2 || bus == SPI_BUS_3) ? APB1_CLOCK_HZ : APB2_CLOCK_HZ;
+    spi_bit_rate[bus] = pclk >> (prescaler + 1);
+}
+
+void spi_write(spi_bus_t bus, const uint8_t* data, uint32_t len) {
+    if (!data || len == 0) return;
+    sim_spi_transfer(bus, data, len);
+}
+
+void spi_read(spi_bus_t bus, uint8_t* data, uint32_t len) {
+    if (!data || len == 0) return;
+    memset(data, 0xFF, len);
+    sim_spi_transfer(bus, NULL, len);
+}
+
+void spi_transfer(spi_bus_t bus, const uint8_t* tx, uint8_t* rx, uint32_t len) {
+    if (len == 0) return;
+    if (rx) memset(rx, 0xFF, len);
+    sim_spi_transfer(bus, tx, len);
+}
+
+void spi_write_byte(spi_bus_t bus, uint8_t byte) {
+    sim_spi_transfer(bus, &byte, 1);
+}
+
+uint8_t spi_read_byte(spi_bus_t bus) {
+    sim_spi_transfer(bus, NULL, 1);
+    return 0xFF;
+}
+
+uint8_t spi_is_busy(spi_bus_t bus) {
+    (void)bus;
+    return 0;
+}
+
+/**
+ * Write the framebuffer as binary PPM (RGB565 expanded to 8 bits)
+ */
+int sim_lcd_dump_ppm(const char* path) {
+    static uint8_t row[LCD_WIDTH * 3];
+
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) return -1;
+
+    fprintf(f, "P6\n%d %d\n255\n", LCD_WIDTH, LCD_HEIGHT);
+    for (int y = 0; y < LCD_HEIGHT; y++) {
+        for (int x = 0; x < LCD_WIDTH; x++) {
+            uint16_t c = lcd.framebuffer[y][x];
+            uint8_t r = (c >> 11) & 0x1F;
+            uint8_t g = (c >> 5) & 0x3F;
+            uint8_t b = c & 0x1F;
+            row[x * 3 + 0] = (r << 3) | (r >> 2);
+            row[x * 3 + 1] = (g << 2) | (g >> 4);
+            row[x * 3 + 2] = (b << 3) | (b >> 2);
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+
+    fclose(f);
+    return 0;
+}
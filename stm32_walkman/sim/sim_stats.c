@@ -0,0 +1,35 @@
+/**
+ * Host Simulation - Pipeline Statistics
+ * Dumps the player's per-stage profile and how many frames the limiter
+ * held down. In the simulation the cycle counter runs in host
+ * nanoseconds, so totals are real compute time.
+ */
+
+#include "sim.h"
+#include "player.h"
+#include <stdio.h>
+
+int sim_stats_write(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) return -1;
+
+    const player_stage_stats_t* stats = player_get_stage_stats();
+    limiter_meter_t meter;
+    player_get_limiter_meter(&meter);
+
+    fprintf(f, "{\n  \"unit\": \"ns\",\n  \"underruns\": %u,\n  \"limited_frames\": %u,\n  \"stages\": [",
+            (unsigned)player_get_underruns(), (unsigned)meter.limited_frames);
+    for (int i = 0; i < PLAYER_STAGE_COUNT; i++) {
+        const player_stage_stats_t* st = &stats[i];
+        double per_frame = st->frames ? (double)st->cycles / st->frames : 0.0;
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"calls\": %u, \"frames\": %u, "
+                "\"total\": %llu, \"max\": %u, \"per_frame\": %.2f}",
+                i ? "," : "", player_stage_name((player_stage_t)i),
+                (unsigned)st->calls, (unsigned)st->frames,
+                (unsigned long long)st->cycles, (unsigned)st->max_cycles, per_frame);
+    }
+    fprintf(f, "\n  ]\n}\n");
+
+    fclose(f);
+    return 0;
+}
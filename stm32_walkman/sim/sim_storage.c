@@ -0,0 +1,128 @@
+/**
+ * Host Simulation - SD Card Storage
+ * Card paths are resolved below the WALKMAN_SIM_SDCARD host directory
+ */
+
+#include "storage.h"
+#include "sim.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define SIM_STORAGE_MAX_DIR_ENTRIES 1024
+
+static const char* storage_root = NULL;
+
+static void storage_host_path(char* out, size_t len, const char* path) {
+    snprintf(out, len, "%s%s%s", storage_root, path[0] == '/' ? "" : "/", path);
+}
+
+int storage_init(void) {
+    struct stat st;
+
+    storage_root = sim_config("WALKMAN_SIM_SDCARD", "sdcard");
+    if (stat(storage_root, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return STORAGE_ERROR_NO_CARD;
+    }
+    return STORAGE_OK;
+}
+
+int storage_open(storage_file_t* file, const char* path) {
+    char host_path[512];
+    struct stat st;
+
+    if (storage_root == NULL || file == NULL || path == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    storage_host_path(host_path, sizeof(host_path), path);
+    FILE* f = fopen(host_path, "rb");
+    if (f == NULL) {
+        return STORAGE_ERROR_NO_FILE;
+    }
+
+    fstat(fileno(f), &st);
+    file->handle = f;
+    file->size = (uint32_t)st.st_size;
+    file->pos = 0;
+    return STORAGE_OK;
+}
+
+int32_t storage_read(storage_file_t* file, void* buffer, uint32_t len) {
+    if (file == NULL || file->handle == NULL) {
+        return -1;
+    }
+
+    size_t n = fread(buffer, 1, len, (FILE*)file->handle);
+    if (n == 0 && ferror((FILE*)file->handle)) {
+        return -1;
+    }
+
+    file->pos += (uint32_t)n;
+    return (int32_t)n;
+}
+
+int storage_seek(storage_file_t* file, uint32_t offset) {
+    if (file == NULL || file->handle == NULL ||
+        fseek((FILE*)file->handle, offset, SEEK_SET) != 0) {
+        return STORAGE_ERROR;
+    }
+
+    file->pos = offset;
+    return STORAGE_OK;
+}
+
+void storage_close(storage_file_t* file) {
+    if (file == NULL || file->handle == NULL) {
+        return;
+    }
+
+    fclose((FILE*)file->handle);
+    file->handle = NULL;
+}
+
+static int storage_name_compare(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/**
+ * Enumerate regular files, sorted by name so runs are reproducible
+ */
+int storage_list_dir(const char* directory, storage_dir_callback_t callback, void* ctx) {
+    static char* names[SIM_STORAGE_MAX_DIR_ENTRIES];
+    char host_path[512], card_path[512], file_path[1024];
+    struct dirent* entry;
+    struct stat st;
+    int count = 0;
+
+    if (storage_root == NULL || callback == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    storage_host_path(host_path, sizeof(host_path), directory);
+    DIR* dir = opendir(host_path);
+    if (dir == NULL) {
+        return STORAGE_ERROR_NO_FILE;
+    }
+
+    while ((entry = readdir(dir)) != NULL && count < SIM_STORAGE_MAX_DIR_ENTRIES) {
+        if (entry->d_name[0] == '.') continue;
+        names[count++] = strdup(entry->d_name);
+    }
+    closedir(dir);
+
+    qsort(names, count, sizeof(char*), storage_name_compare);
+
+    for (int i = 0; i < count; i++) {
+        snprintf(file_path, sizeof(file_path), "%s/%s", host_path, names[i]);
+        if (stat(file_path, &st) == 0 && S_ISREG(st.st_mode)) {
+            snprintf(card_path, sizeof(card_path), "%s/%s", directory, names[i]);
+            callback(card_path, (uint32_t)st.st_size, ctx);
+        }
+        free(names[i]);
+    }
+
+    return STORAGE_OK;
+}
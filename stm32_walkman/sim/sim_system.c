@@ -0,0 +1,133 @@
+/**
+ * Host Simulation - System Clock
+ * Implements system.h on a virtual nanosecond clock
+ *
+ * Environment:
+ * - WALKMAN_SIM_SDCARD       host directory used as SD card root (sdcard)
+ * - WALKMAN_SIM_SCRIPT       button script, see sim_script.c (none)
+ * - WALKMAN_SIM_WAV          I2S capture output (sim_output.wav)
+ * - WALKMAN_SIM_LCD          framebuffer dump at exit (sim_lcd.ppm)
+ * - WALKMAN_SIM_DURATION_MS  virtual run time limit (30000)
+ * - WALKMAN_SIM_STATS        pipeline stage timing JSON at exit (none)
+ * - WALKMAN_SIM_FLASH        internal flash image file (none: blank every run)
+ */
+
+#include "system.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static uint64_t sim_clock_ns = 0;
+static uint64_t sim_limit_ns = 0;
+static uint8_t sim_in_advance = 0;
+
+/**
+ * Configuration lookup
+ */
+const char* sim_config(const char* name, const char* default_value) {
+    const char* value = getenv(name);
+    return (value && value[0]) ? value : default_value;
+}
+
+/**
+ * Write the framebuffer dump on exit
+ */
+static void sim_exit_handler(void) {
+    const char* lcd_path = sim_config("WALKMAN_SIM_LCD", "sim_lcd.ppm");
+    if (sim_lcd_dump_ppm(lcd_path) == 0) {
+        printf("[sim] LCD framebuffer written to %s\n", lcd_path);
+    }
+    const char* stats_path = sim_config("WALKMAN_SIM_STATS", NULL);
+    if (stats_path && sim_stats_write(stats_path) == 0) {
+        printf("[sim] pipeline stats written to %s\n", stats_path);
+    }
+    printf("[sim] exit at %llu ms\n", (unsigned long long)(sim_clock_ns / SIM_NS_PER_MS));
+}
+
+/**
+ * Current virtual time
+ */
+uint64_t sim_time_ns(void) {
+    return sim_clock_ns;
+}
+
+/**
+ * Advance virtual time and run the peripheral models up to it
+ * Peripheral callbacks (DMA interrupts) run from here, like an ISR
+ * preempting the main loop at this point.
+ */
+void sim_advance_ns(uint64_t ns) {
+    sim_clock_ns += ns;
+
+    if (sim_in_advance) return;
+    sim_in_advance = 1;
+
+    sim_script_run(sim_clock_ns);
+    sim_i2s_run(sim_clock_ns);
+
+    sim_in_advance = 0;
+
+    if (sim_clock_ns >= sim_limit_ns) {
+        printf("[sim] run time limit reached\n");
+        exit(0);
+    }
+}
+
+/**
+ * Initialize simulation (replaces clock tree setup)
+ */
+void system_init(void) {
+    sim_clock_ns = 0;
+    sim_limit_ns = strtoull(sim_config("WALKMAN_SIM_DURATION_MS", "30000"), NULL, 10) *
+                   SIM_NS_PER_MS;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    atexit(sim_exit_handler);
+
+    sim_i2s_open_output(sim_config("WALKMAN_SIM_WAV", "sim_output.wav"));
+    sim_script_load(sim_config("WALKMAN_SIM_SCRIPT", NULL));
+
+    printf("[sim] STM32F407 host simulation, SD card root '%s'\n",
+           sim_config("WALKMAN_SIM_SDCARD", "sdcard"));
+}
+
+void system_tick_start(void) {
+}
+
+/**
+ * Get system tick in milliseconds
+ * Each call stands for one pass through a polling loop
+ */
+uint32_t system_get_tick(void) {
+    sim_advance_ns(SIM_POLL_COST_NS);
+    return (uint32_t)(sim_clock_ns / SIM_NS_PER_MS);
+}
+
+void system_delay_ms(uint32_t ms) {
+    sim_advance_ns((uint64_t)ms * SIM_NS_PER_MS);
+}
+
+void system_delay_us(uint32_t us) {
+    sim_advance_ns((uint64_t)us * 1000);
+}
+
+/**
+ * Sleep until the next SysTick: skip to the next millisecond boundary
+ */
+void system_idle(void) {
+    sim_advance_ns(SIM_NS_PER_MS - sim_clock_ns % SIM_NS_PER_MS);
+}
+
+void system_cycles_init(void) {
+}
+
+/**
+ * Cycle counter stand-in: host monotonic nanoseconds
+ * Profiles real host compute time, independent of the virtual clock
+ */
+uint32_t system_get_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * SIM_NS_PER_SEC + (uint64_t)ts.tv_nsec);
+}
@@ -0,0 +1,270 @@
+/**
+ * ADPCM Codecs
+ * IMA (WAV 0x0011) and Microsoft (WAV 0x0002) block decoders
+ *
+ * The inner loops keep the predictors in registers, decode both channels
+ * per pass and avoid data-dependent branches. Tables are int16/int8
+ * (178 + 16 + 32 bytes for IMA and MS), small enough to stay in the
+ * flash accelerator's cache lines during a block.
+ */
+
+#include "adpcm.h"
+#include <string.h>
+
+static const int16_t adpcm_ima_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+    34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+    3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t adpcm_ima_index_adjust[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static int32_t adpcm_clamp_index(int32_t index) {
+    if (index < 0) return 0;
+    if (index > 88) return 88;
+    return index;
+}
+
+static int32_t adpcm_clamp_sample(int32_t sample) {
+    if (sample > 32767) return 32767;
+    if (sample < -32768) return -32768;
+    return sample;
+}
+
+/**
+ * Apply one nibble to a predictor, returns the new sample
+ * Branch-free apart from the clamps, which compile to SSAT/IT on Cortex-M4.
+ */
+static inline int32_t adpcm_ima_nibble(int32_t* predictor, int32_t* index, uint32_t nibble) {
+    int32_t step = adpcm_ima_steps[*index];
+    int32_t diff = step >> 3;
+    int32_t sign = -(int32_t)(nibble >> 3);
+
+    diff += step & -(int32_t)((nibble >> 2) & 1);
+    diff += (step >> 1) & -(int32_t)((nibble >> 1) & 1);
+    diff += (step >> 2) & -(int32_t)(nibble & 1);
+
+    *predictor = adpcm_clamp_sample(*predictor + ((diff ^ sign) - sign));
+    *index = adpcm_clamp_index(*index + adpcm_ima_index_adjust[nibble]);
+    return *predictor;
+}
+
+static int16_t adpcm_ima_step(adpcm_ima_state_t* st, uint8_t nibble) {
+    return (int16_t)adpcm_ima_nibble(&st->predictor, &st->index, nibble);
+}
+
+static uint32_t adpcm_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint32_t adpcm_ima_block_frames(uint32_t block_bytes, uint8_t channels) {
+    uint32_t header = 4u * channels;
+
+    if (channels < 1 || channels > ADPCM_IMA_MAX_CHANNELS ||
+        block_bytes <= header || (block_bytes - header) % header != 0) {
+        return 0;
+    }
+    return (block_bytes - header) * 2 / channels + 1;
+}
+
+/**
+ * IMA decode: nibble by nibble up to a word boundary, then whole words
+ * (8 frames, both channels per pass) with the predictors in registers
+ */
+void adpcm_ima_decode(adpcm_ima_state_t state[ADPCM_IMA_MAX_CHANNELS],
+                      const uint8_t* block, uint8_t channels,
+                      uint32_t first, uint32_t count, int16_t* out) {
+    const uint8_t* data = block + 4u * channels;
+    const uint32_t stereo = (channels == 2);
+    int32_t pl = state[0].predictor, il = state[0].index;
+    int32_t pr = state[stereo].predictor, ir = state[stereo].index;
+    uint32_t frame = first;
+    uint32_t end = first + count;
+
+    if (frame == 0 && count > 0) {
+        pl = (int16_t)(block[0] | (block[1] << 8));
+        il = adpcm_clamp_index(block[2]);
+        pr = stereo ? (int16_t)(block[4] | (block[5] << 8)) : pl;
+        ir = stereo ? adpcm_clamp_index(block[6]) : il;
+        *out++ = (int16_t)pl;
+        *out++ = (int16_t)pr;
+        frame = 1;
+    }
+
+    while (frame < end) {
+        uint32_t k = frame - 1;
+        const uint8_t* word = data + (k >> 3) * 4u * channels;
+
+        if ((k & 7) == 0 && end - frame >= 8) {
+            uint32_t wl = adpcm_le32(word);
+            uint32_t wr = adpcm_le32(word + 4 * stereo);
+            for (uint32_t i = 0; i < 8; i++) {
+                int32_t l = adpcm_ima_nibble(&pl, &il, wl & 0x0F);
+                int32_t r = stereo ? adpcm_ima_nibble(&pr, &ir, wr & 0x0F) : l;
+                out[0] = (int16_t)l;
+                out[1] = (int16_t)r;
+                out += 2;
+                wl >>= 4;
+                wr >>= 4;
+            }
+            frame += 8;
+            continue;
+        }
+
+        uint32_t shift = (k & 7) * 4;
+        int32_t l = adpcm_ima_nibble(&pl, &il, (adpcm_le32(word) >> shift) & 0x0F);
+        int32_t r = stereo ? adpcm_ima_nibble(&pr, &ir, (adpcm_le32(word + 4) >> shift) & 0x0F) : l;
+        out[0] = (int16_t)l;
+        out[1] = (int16_t)r;
+        out += 2;
+        frame++;
+    }
+
+    state[0].predictor = pl;
+    state[0].index = il;
+    if (stereo) {
+        state[1].predictor = pr;
+        state[1].index = ir;
+    }
+}
+
+/**
+ * Pick the nibble closest to the next sample and track the decoder
+ */
+static uint8_t adpcm_ima_encode_sample(adpcm_ima_state_t* st, int16_t sample) {
+    int32_t step = adpcm_ima_steps[st->index];
+    int32_t diff = sample - st->predictor;
+    uint8_t nibble = 0;
+
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { nibble |= 4; diff -= step; }
+    if (diff >= step >> 1) { nibble |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) { nibble |= 1; }
+
+    adpcm_ima_step(st, nibble);
+    return nibble;
+}
+
+void adpcm_ima_encode_block(adpcm_ima_state_t state[ADPCM_IMA_MAX_CHANNELS],
+                            const int16_t* in, uint8_t channels,
+                            uint8_t* block, uint32_t block_bytes) {
+    uint32_t frames = adpcm_ima_block_frames(block_bytes, channels);
+    uint8_t* data = block + 4u * channels;
+
+    if (frames == 0) return;
+    memset(block, 0, block_bytes);
+
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        int16_t first = in[ch];
+        state[ch].predictor = first;
+        state[ch].index = adpcm_clamp_index(state[ch].index);
+        block[4 * ch] = (uint8_t)first;
+        block[4 * ch + 1] = (uint8_t)((uint16_t)first >> 8);
+        block[4 * ch + 2] = (uint8_t)state[ch].index;
+    }
+
+    for (uint32_t k = 0; k + 1 < frames; k++) {
+        for (uint8_t ch = 0; ch < channels; ch++) {
+            uint8_t nibble = adpcm_ima_encode_sample(&state[ch], in[(k + 1) * channels + ch]);
+            data[((k >> 3) * channels + ch) * 4 + ((k & 7) >> 1)] |=
+                (k & 1) ? (uint8_t)(nibble << 4) : nibble;
+        }
+    }
+}
+
+/* ============ Microsoft ADPCM ============ */
+
+const int16_t adpcm_ms_coefs[ADPCM_MS_NUM_COEFS][2] = {
+    {256, 0}, {512, -256}, {0, 0}, {192, 64}, {240, 0}, {460, -208}, {392, -232}
+};
+
+static const int16_t adpcm_ms_adapt[16] = {
+    230, 230, 230, 230, 307, 409, 512, 614,
+    768, 614, 512, 409, 307, 230, 230, 230
+};
+
+/**
+ * Apply one nibble to a channel state, returns the new sample
+ */
+static inline int32_t adpcm_ms_nibble(adpcm_ms_state_t* st, uint32_t nibble) {
+    int32_t predict = (st->sample1 * st->coef1 + st->sample2 * st->coef2) >> 8;
+    int32_t error = ((int32_t)nibble ^ 8) - 8;       /* Signed 4-bit */
+    int32_t sample = adpcm_clamp_sample(predict + error * st->delta);
+    int32_t delta = (adpcm_ms_adapt[nibble] * st->delta) >> 8;
+
+    st->sample2 = st->sample1;
+    st->sample1 = sample;
+    st->delta = delta < 16 ? 16 : delta;
+    return sample;
+}
+
+uint32_t adpcm_ms_block_frames(uint32_t block_bytes, uint8_t channels) {
+    uint32_t header = 7u * channels;
+
+    if (channels < 1 || channels > ADPCM_MS_MAX_CHANNELS || block_bytes <= header) {
+        return 0;
+    }
+    return (block_bytes - header) * 2 / channels + 2;
+}
+
+/**
+ * Microsoft ADPCM decode; frames 0 and 1 come from the block header
+ */
+void adpcm_ms_decode(adpcm_ms_state_t state[ADPCM_MS_MAX_CHANNELS],
+                     const uint8_t* block, uint8_t channels,
+                     uint32_t first, uint32_t count, int16_t* out) {
+    const uint8_t* data = block + 7u * channels;
+    const uint32_t stereo = (channels == 2);
+    uint32_t frame = first;
+    uint32_t end = first + count;
+
+    if (frame == 0 && count > 0) {
+        for (uint8_t ch = 0; ch < channels; ch++) {
+            uint8_t predictor = block[ch];
+            const uint8_t* h = block + channels + 2u * ch;
+            if (predictor >= ADPCM_MS_NUM_COEFS) predictor = 0;
+
+            state[ch].coef1 = adpcm_ms_coefs[predictor][0];
+            state[ch].coef2 = adpcm_ms_coefs[predictor][1];
+            state[ch].delta = (int16_t)(h[0] | (h[1] << 8));
+            state[ch].sample1 = (int16_t)(h[2 * channels] | (h[2 * channels + 1] << 8));
+            state[ch].sample2 = (int16_t)(h[4 * channels] | (h[4 * channels + 1] << 8));
+        }
+    }
+
+    for (; frame < end && frame < 2; frame++) {
+        int32_t l = (frame == 0) ? state[0].sample2 : state[0].sample1;
+        int32_t r = (frame == 0) ? state[stereo].sample2 : state[stereo].sample1;
+        *out++ = (int16_t)l;
+        *out++ = (int16_t)r;
+    }
+
+    if (stereo) {
+        /* One byte per frame: left in the high nibble */
+        for (; frame < end; frame++) {
+            uint32_t byte = data[frame - 2];
+            out[0] = (int16_t)adpcm_ms_nibble(&state[0], byte >> 4);
+            out[1] = (int16_t)adpcm_ms_nibble(&state[1], byte & 0x0F);
+            out += 2;
+        }
+    } else {
+        for (; frame < end; frame++) {
+            uint32_t k = frame - 2;
+            uint32_t byte = data[k >> 1];
+            int16_t s = (int16_t)adpcm_ms_nibble(&state[0], (k & 1) ? (byte & 0x0F) : (byte >> 4));
+            out[0] = s;
+            out[1] = s;
+            out += 2;
+        }
+    }
+}
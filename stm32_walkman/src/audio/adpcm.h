@@ -0,0 +1,77 @@
+/**
+ * ADPCM Codecs
+ *
+ * IMA ADPCM (WAV format 0x0011): each block starts with one header per
+ * channel (int16 sample, uint8 step index, uint8 reserved) that is also
+ * the block's first frame, followed by 32-bit words of eight nibbles,
+ * alternating between channels, low nibble first.
+ *
+ * Microsoft ADPCM (WAV format 0x0002): per-channel predictor index, delta,
+ * sample1 and sample2 (the first two frames, sample2 first), then one
+ * byte per frame pair in stereo (left = high nibble) or two mono frames.
+ * Only the seven standard coefficient pairs are supported, which is what
+ * every encoder writes.
+ *
+ * Blocks decode independently, so every block start is a seek point. The
+ * decoders output interleaved stereo (mono is duplicated) and can stop and
+ * continue anywhere inside a block. The IMA encoder is used by the host
+ * tools.
+ */
+
+#ifndef __ADPCM_H
+#define __ADPCM_H
+
+#include <stdint.h>
+
+#define ADPCM_IMA_MAX_CHANNELS 2
+#define ADPCM_MS_MAX_CHANNELS 2
+#define ADPCM_MS_NUM_COEFS 7
+
+/* IMA predictor state of one channel */
+typedef struct {
+    int32_t predictor;
+    int32_t index;            // Step table index, 0-88
+} adpcm_ima_state_t;
+
+/* Microsoft ADPCM predictor state of one channel */
+typedef struct {
+    int32_t sample1;          // Last output
+    int32_t sample2;          // Output before that
+    int32_t delta;            // Quantizer step
+    int32_t coef1, coef2;     // Predictor pair, 8.8 fixed point
+} adpcm_ms_state_t;
+
+/* Standard predictor pairs (fmt extension of WAV 0x0002 files) */
+extern const int16_t adpcm_ms_coefs[ADPCM_MS_NUM_COEFS][2];
+
+/* Frames held in one block (header frame included), 0 if the size is invalid */
+uint32_t adpcm_ima_block_frames(uint32_t block_bytes, uint8_t channels);
+
+/**
+ * Decode frames [first, first + count) of a block into interleaved stereo.
+ * state carries the predictors between calls on the same block, so calls
+ * must continue where the previous one stopped; first == 0 starts the
+ * block from its header.
+ */
+void adpcm_ima_decode(adpcm_ima_state_t state[ADPCM_IMA_MAX_CHANNELS],
+                      const uint8_t* block, uint8_t channels,
+                      uint32_t first, uint32_t count, int16_t* out);
+
+/**
+ * Encode one full block from interleaved input (channels per frame,
+ * adpcm_ima_block_frames() frames). state carries the step index from
+ * block to block; reset it to zero before the first block.
+ */
+void adpcm_ima_encode_block(adpcm_ima_state_t state[ADPCM_IMA_MAX_CHANNELS],
+                            const int16_t* in, uint8_t channels,
+                            uint8_t* block, uint32_t block_bytes);
+
+/* Microsoft ADPCM frames per block (0 if the size is invalid) */
+uint32_t adpcm_ms_block_frames(uint32_t block_bytes, uint8_t channels);
+
+/* Microsoft ADPCM counterpart of adpcm_ima_decode() */
+void adpcm_ms_decode(adpcm_ms_state_t state[ADPCM_MS_MAX_CHANNELS],
+                     const uint8_t* block, uint8_t channels,
+                     uint32_t first, uint32_t count, int16_t* out);
+
+#endif /* __ADPCM_H */
@@ -34,6 +34,36 @@
 #define WM8994_AUDIO_INTERFACE_4            0x0303
 #define WM8994_AIF1_CONTROL_1               0x0300
 #define WM8994_AIF1_CONTROL_2               0x0301
+#define WM8994_SYSTEM_CLOCKING_1            0x0208
+#define WM8994_AIF1_DAC1_FILTERS_2          0x0421
+#define WM8994_AIF1_DRC1_1                  0x0440
+#define WM8994_AIF1_DRC1_2                  0x0441
+#define WM8994_AIF1_DRC1_3                  0x0442
+#define WM8994_AIF1_DRC1_4                  0x0443
+#define WM8994_AIF1_DAC1_EQ_GAINS_1         0x0480
+#define WM8994_AIF1_DAC1_EQ_GAINS_2         0x0481
+
+/* Power management 1: output drivers on top of VMID and BIAS */
+#define WM8994_PM1_VMID_BIAS                0x0003
+#define WM8994_PM1_HPOUT1                   0x0300  // HPOUT1L/R (headphone jack)
+#define WM8994_PM1_SPKOUT                   0x3000  // SPKOUTL/R
+
+/* On-chip DSP fields */
+#define WM8994_AIF1DSPCLK_ENA               0x0008  // System Clocking (1)
+#define WM8994_SYSDSPCLK_ENA                0x0002
+#define WM8994_AIF1DAC1_3D_GAIN_SHIFT       9       // AIF1 DAC1 Filters (2), 5 bits
+#define WM8994_AIF1DAC1_3D_ENA              0x0100
+#define WM8994_AIF1DRC1_DEFAULT             0x0098  // DRC1 (1): QR, anti-clip, signal detect
+#define WM8994_AIF1DAC1_DRC_ENA             0x0004
+#define WM8994_AIF1DAC1_EQ_ENA              0x0001  // EQ Gains (1)
+#define WM8994_EQ_GAIN_0DB                  12      // Band gain code of 0 dB
+#define WM8994_DRC_KNEE_STEP_DB             0.75f
+#define WM8994_DSP_MAX_RATE                 48000
+
+/* Registers mirrored by the write-through cache: clocking, the audio
+ * interfaces and the AIF1 DSP blocks */
+#define CODEC_CACHE_FIRST                   0x0200
+#define CODEC_CACHE_COUNT                   0x0300
 
 #define WM8994_ADDR (0x1A << 1)  // I2C address (8-bit)
 #define WM8994_TIMEOUT 1000
@@ -43,28 +73,53 @@ static struct {
     uint8_t is_initialized;
     uint8_t is_playing;
     uint8_t volume;
+    codec_sample_rate_t sample_rate;
+    codec_output_dest_t output_dest;
     const int16_t *current_buffer;
     uint32_t buffer_size;
-    uint32_t buffer_position;
+    volatile uint32_t buffer_position;  /* Frames played */
+    codec_stream_callback_t stream_callback;
+    uint8_t dsp_blocks;                 /* CODEC_DSP_* switched on */
 } codec_state = {
     .is_initialized = 0,
     .is_playing = 0,
     .volume = 70,
+    .sample_rate = CODEC_SAMPLE_RATE_44100,
+    .output_dest = CODEC_OUTPUT_LINE,
     .current_buffer = NULL,
     .buffer_size = 0,
-    .buffer_position = 0
+    .buffer_position = 0,
+    .stream_callback = NULL,
+    .dsp_blocks = 0
 };
 
+/* Last value written per cached register; valid bit set once written */
+static struct {
+    uint16_t value[CODEC_CACHE_COUNT];
+    uint32_t valid[CODEC_CACHE_COUNT / 32];
+} codec_cache;
+
+/* On-chip DSP blocks, each needs the DSP clocks */
+#define CODEC_DSP_EQ  0x01
+#define CODEC_DSP_DRC 0x02
+#define CODEC_DSP_3D  0x04
+
+static uint16_t codec_output_power(codec_output_dest_t dest) {
+    return WM8994_PM1_VMID_BIAS |
+           (dest == CODEC_OUTPUT_SPEAKER ? WM8994_PM1_SPKOUT : WM8994_PM1_HPOUT1);
+}
+
 /* ============ Low-level I2C Communication ============ */
 
 /**
  * Read register from WM8994 via I2C (bare metal)
  */
 codec_status_t codec_read_register(uint16_t addr, uint16_t *value) {
-    uint8_t reg_addr = addr & 0xFF;
+    uint8_t reg_addr[2] = {(uint8_t)(addr >> 8), (uint8_t)(addr & 0xFF)};
     uint8_t data[2] = {0, 0};
     
-    if (i2c_write_read(I2C_BUS_1, 0x1A, reg_addr, data, 2) != 0) {
+    if (i2c_write(I2C_BUS_1, 0x1A, reg_addr, 2) != 0 ||
+        i2c_read(I2C_BUS_1, 0x1A, data, 2) != 0) {
         return CODEC_TIMEOUT;
     }
     
@@ -74,21 +129,59 @@ codec_status_t codec_read_register(uint16_t addr, uint16_t *value) {
 
 /**
  * Write register to WM8994 via I2C (bare metal)
+ * Keeps the register cache current; a write to register 0 resets the chip
+ * and empties it.
  */
 codec_status_t codec_write_register(uint16_t addr, uint16_t value) {
-    uint8_t data[3];
+    uint8_t data[4];
     
-    data[0] = addr & 0xFF;
-    data[1] = (value >> 8) & 0xFF;
-    data[2] = value & 0xFF;
+    data[0] = (addr >> 8) & 0xFF;
+    data[1] = addr & 0xFF;
+    data[2] = (value >> 8) & 0xFF;
+    data[3] = value & 0xFF;
     
-    if (i2c_write(I2C_BUS_1, 0x1A, data, 3) != 0) {
+    if (i2c_write(I2C_BUS_1, 0x1A, data, 4) != 0) {
         return CODEC_TIMEOUT;
     }
     
+    if (addr == WM8994_CHIP_ID) {
+        memset(&codec_cache, 0, sizeof(codec_cache));
+        codec_state.dsp_blocks = 0;
+    } else if (addr >= CODEC_CACHE_FIRST && addr - CODEC_CACHE_FIRST < CODEC_CACHE_COUNT) {
+        uint32_t i = addr - CODEC_CACHE_FIRST;
+        codec_cache.value[i] = value;
+        codec_cache.valid[i / 32] |= 1u << (i % 32);
+    }
+    
     return CODEC_OK;
 }
 
+/**
+ * Write a cached register only if the value differs from the last one
+ */
+static codec_status_t codec_write_cached(uint16_t addr, uint16_t value) {
+    uint32_t i = addr - CODEC_CACHE_FIRST;
+    
+    if ((codec_cache.valid[i / 32] & (1u << (i % 32))) && codec_cache.value[i] == value) {
+        return CODEC_OK;
+    }
+    return codec_write_register(addr, value);
+}
+
+/**
+ * Change the bits of mask in a cached register (read from the chip once)
+ */
+static codec_status_t codec_update_cached(uint16_t addr, uint16_t mask, uint16_t value) {
+    uint32_t i = addr - CODEC_CACHE_FIRST;
+    uint16_t old = codec_cache.value[i];
+    
+    if (!(codec_cache.valid[i / 32] & (1u << (i % 32))) &&
+        codec_read_register(addr, &old) != CODEC_OK) {
+        return CODEC_TIMEOUT;
+    }
+    return codec_write_cached(addr, (uint16_t)((old & ~mask) | (value & mask)));
+}
+
 /**
  * Initialize GPIO for codec control (bare metal)
  */
@@ -117,6 +210,7 @@ static void codec_i2c_init(void) {
 static void codec_i2s_init(void) {
     /* I2S3 (SPI3) is initialized via bare metal i2s driver */
     i2s_init(I2S_SR_44100);
+    i2s_set_callback(codec_i2s_interrupt_handler);
 }
 
 /**
@@ -139,7 +233,7 @@ static codec_status_t codec_configure_chip(void) {
     system_delay_ms(10);
     
     /* Power management: enable core, output mixer, DAC */
-    codec_write_register(WM8994_POWER_MANAGEMENT_1, 0x1003);  /* VMID, BIAS */
+    codec_write_register(WM8994_POWER_MANAGEMENT_1, codec_output_power(codec_state.output_dest));
     codec_write_register(WM8994_POWER_MANAGEMENT_2, 0x0000);
     codec_write_register(WM8994_POWER_MANAGEMENT_3, 0x0000);
     
@@ -186,17 +280,28 @@ codec_status_t codec_init(void) {
  */
 codec_status_t codec_deinit(void) {
     codec_stop();
-    HAL_I2S_DeInit(&codec_state.hi2s3);
-    HAL_I2C_DeInit(&codec_state.hi2c1);
+    i2s_set_callback(NULL);
+    gpio_clear(GPIO_PORT_D, 4);  /* Codec power off */
     codec_state.is_initialized = 0;
     return CODEC_OK;
 }
 
+/**
+ * Register callback for buffer refill (see codec_play)
+ */
+void codec_set_stream_callback(codec_stream_callback_t callback) {
+    codec_state.stream_callback = callback;
+}
+
 /**
  * Start playback
+ * 
+ * The buffer is played circularly: whenever one half has been sent the
+ * stream callback is asked to refill it. size is in 16-bit samples and
+ * must cover a whole number of stereo frames per half.
  */
 codec_status_t codec_play(const int16_t *buffer, uint32_t size) {
-    if (!codec_state.is_initialized) {
+    if (!codec_state.is_initialized || buffer == NULL || size == 0) {
         return CODEC_ERROR;
     }
     
@@ -206,9 +311,7 @@ codec_status_t codec_play(const int16_t *buffer, uint32_t size) {
     codec_state.is_playing = 1;
     
     /* Start I2S DMA transfer */
-    if (HAL_I2S_Transmit_DMA(&codec_state.hi2s3, (uint16_t *)buffer, size) != HAL_OK) {
-        return CODEC_ERROR;
-    }
+    i2s_start_dma(buffer, size);
     
     return CODEC_OK;
 }
@@ -218,8 +321,7 @@ codec_status_t codec_play(const int16_t *buffer, uint32_t size) {
  */
 codec_status_t codec_stop(void) {
     codec_state.is_playing = 0;
-    HAL_I2S_DMAPause(&codec_state.hi2s3);
-    HAL_I2S_DMAStop(&codec_state.hi2s3);
+    i2s_stop();
     return CODEC_OK;
 }
 
@@ -228,7 +330,7 @@ codec_status_t codec_stop(void) {
  */
 codec_status_t codec_pause(void) {
     codec_state.is_playing = 0;
-    HAL_I2S_DMAPause(&codec_state.hi2s3);
+    i2s_pause();
     return CODEC_OK;
 }
 
@@ -241,7 +343,7 @@ codec_status_t codec_resume(void) {
     }
     
     codec_state.is_playing = 1;
-    HAL_I2S_DMAResume(&codec_state.hi2s3);
+    i2s_resume();
     return CODEC_OK;
 }
 
@@ -265,9 +367,34 @@ codec_status_t codec_set_sample_rate(codec_sample_rate_t rate) {
             return CODEC_ERROR;
     }
     
+    if (codec_state.sample_rate == rate) {
+        return CODEC_OK;
+    }
+    
+    /* Re-clock I2S3 to the new rate */
+    i2s_init((i2s_sample_rate_t)rate);
+    codec_state.sample_rate = rate;
+    
+    /* Above 48kHz the DSP blocks cannot run */
+    if (!codec_dsp_available() && codec_state.dsp_blocks) {
+        codec_set_eq(NULL);
+        codec_set_drc(NULL);
+        codec_set_3d(0);
+    }
+    
     return codec_write_register(WM8994_AUDIO_INTERFACE_2, config);
 }
 
+/**
+ * Map volume 0-100 onto the output volume codes
+ */
+uint8_t codec_volume_code(uint8_t volume) {
+    if (volume > 100) {
+        volume = 100;
+    }
+    return (uint8_t)((volume * CODEC_VOLUME_CODE_MAX) / 100);
+}
+
 /**
  * Set volume (0-100%)
  */
@@ -279,9 +406,7 @@ codec_status_t codec_set_volume(uint8_t volume) {
     }
     
     codec_state.volume = volume;
-    
-    /* Map 0-100 to DAC range (0-127 for max volume) */
-    dac_vol = (volume * 127) / 100;
+    dac_vol = codec_volume_code(volume);
     
     /* Set left and right output volumes */
     codec_write_register(WM8994_LEFT_OUTPUT_VOLUME, 0xC0 | dac_vol);   // Unmute + volume
@@ -305,12 +430,33 @@ uint8_t codec_is_playing(void) {
 }
 
 /**
- * Get playback position
+ * Get current sample rate
+ */
+codec_sample_rate_t codec_get_sample_rate(void) {
+    return codec_state.sample_rate;
+}
+
+/**
+ * Get playback position (frames sent to the DAC since codec_play)
  */
 uint32_t codec_get_position(void) {
     return codec_state.buffer_position;
 }
 
+/**
+ * Sample of the playback buffer the DMA reads next (0 when stopped)
+ */
+uint32_t codec_get_buffer_offset(void) {
+    return codec_state.current_buffer ? i2s_get_position() : 0;
+}
+
+/**
+ * Hold back the stream callback (see i2s_hold_callback)
+ */
+void codec_hold_stream(uint8_t hold) {
+    i2s_hold_callback(hold);
+}
+
 /**
  * Set input source (not implemented - for future use)
  */
@@ -320,11 +466,27 @@ codec_status_t codec_set_input_source(codec_input_source_t source) {
 }
 
 /**
- * Set output destination (not implemented - for future use)
+ * Route the DAC to the headphone jack or the speaker driver
+ * The player runs its headphone-only processing (crossfeed) while the
+ * destination is CODEC_OUTPUT_LINE.
  */
 codec_status_t codec_set_output_destination(codec_output_dest_t dest) {
-    (void)dest;  // Unused for now
-    return CODEC_OK;
+    if (dest != CODEC_OUTPUT_LINE && dest != CODEC_OUTPUT_SPEAKER) {
+        return CODEC_ERROR;
+    }
+    
+    codec_state.output_dest = dest;
+    if (!codec_state.is_initialized) {
+        return CODEC_OK;  /* Applied by codec_init() */
+    }
+    return codec_write_register(WM8994_POWER_MANAGEMENT_1, codec_output_power(dest));
+}
+
+/**
+ * Get the output destination
+ */
+codec_output_dest_t codec_get_output_destination(void) {
+    return codec_state.output_dest;
 }
 
 /**
@@ -335,12 +497,144 @@ codec_status_t codec_set_mic_gain(uint8_t gain) {
     return CODEC_OK;
 }
 
+/* ============ On-chip DSP ============ */
+
+/**
+ * The AIF1 DSP runs at 44.1kHz and 48kHz only
+ */
+uint8_t codec_dsp_available(void) {
+    return codec_state.sample_rate <= WM8994_DSP_MAX_RATE;
+}
+
 /**
- * I2S interrupt handler (called from HAL)
+ * Switch a DSP block on or off; the DSP clocks run while any block is on
  */
-void codec_i2s_interrupt_handler(void) {
-    /* Update playback position */
+static codec_status_t codec_dsp_block(uint8_t block, uint8_t on) {
+    const uint16_t clocks = WM8994_AIF1DSPCLK_ENA | WM8994_SYSDSPCLK_ENA;
+    
+    if (on) {
+        codec_state.dsp_blocks |= block;
+    } else {
+        codec_state.dsp_blocks &= (uint8_t)~block;
+    }
+    return codec_update_cached(WM8994_SYSTEM_CLOCKING_1, clocks,
+                               codec_state.dsp_blocks ? clocks : 0);
+}
+
+/**
+ * Nearest value of min * 2^code, code clamped to 0..max_code
+ */
+static uint16_t codec_log2_code(float value, float min, uint16_t max_code) {
+    uint16_t code = 0;
+    
+    while (code < max_code && value > min * 1.4142136f) {
+        value *= 0.5f;
+        code++;
+    }
+    return code;
+}
+
+/**
+ * Clamp a level to 0..max_code steps of WM8994_DRC_KNEE_STEP_DB below 0 dB
+ */
+static uint16_t codec_knee_code(float level_db, uint16_t max_code) {
+    float steps = -level_db / WM8994_DRC_KNEE_STEP_DB + 0.5f;
+    
+    if (steps < 0.0f) return 0;
+    if (steps > (float)max_code) return max_code;
+    return (uint16_t)steps;
+}
+
+/**
+ * Program the ReTune Mobile EQ band gains and switch it on (NULL: off)
+ */
+codec_status_t codec_set_eq(const codec_eq_t *eq) {
+    uint16_t code[CODEC_EQ_BANDS];
+    
+    if (eq == NULL) {
+        codec_update_cached(WM8994_AIF1_DAC1_EQ_GAINS_1, WM8994_AIF1DAC1_EQ_ENA, 0);
+        return codec_dsp_block(CODEC_DSP_EQ, 0);
+    }
+    if (!codec_dsp_available()) {
+        return CODEC_ERROR;
+    }
+    
+    for (int band = 0; band < CODEC_EQ_BANDS; band++) {
+        int gain = eq->gain_db[band];
+        if (gain > CODEC_EQ_GAIN_MAX_DB) gain = CODEC_EQ_GAIN_MAX_DB;
+        if (gain < -CODEC_EQ_GAIN_MAX_DB) gain = -CODEC_EQ_GAIN_MAX_DB;
+        code[band] = (uint16_t)(WM8994_EQ_GAIN_0DB + gain);
+    }
+    
+    codec_dsp_block(CODEC_DSP_EQ, 1);
+    codec_write_cached(WM8994_AIF1_DAC1_EQ_GAINS_2, (uint16_t)((code[3] << 11) | (code[4] << 6)));
+    return codec_write_cached(WM8994_AIF1_DAC1_EQ_GAINS_1,
+                              (uint16_t)((code[0] << 11) | (code[1] << 6) | (code[2] << 1) |
+                                         WM8994_AIF1DAC1_EQ_ENA));
+}
+
+/**
+ * Program the DRC curve and time constants and switch it on (NULL: off)
+ */
+codec_status_t codec_set_drc(const codec_drc_t *drc) {
+    if (drc == NULL) {
+        codec_write_cached(WM8994_AIF1_DRC1_1, WM8994_AIF1DRC1_DEFAULT);
+        return codec_dsp_block(CODEC_DSP_DRC, 0);
+    }
+    if (!codec_dsp_available()) {
+        return CODEC_ERROR;
+    }
+    
+    /* Gain below the knee sets the maximum gain range: 12, 18, 24 or 36 dB */
+    uint16_t knee_in = codec_knee_code(drc->knee_in_db, 60);
+    uint16_t knee_out = codec_knee_code(drc->knee_out_db, 30);
+    float gain_db = (float)(knee_in - knee_out) * WM8994_DRC_KNEE_STEP_DB;
+    uint16_t max_gain = (gain_db <= 12.0f) ? 0 : (gain_db <= 18.0f) ? 1 : (gain_db <= 24.0f) ? 2 : 3;
+    
+    /* HI_COMP: slope 1/2^code above the knee, 5 is a limiter */
+    uint16_t hi_comp = codec_log2_code(drc->ratio, 1.0f, 5);
+    
+    /* Attack 181 us * 2^(code - 1) from code 1, decay 186 ms * 2^code */
+    uint16_t attack = (uint16_t)(codec_log2_code(drc->attack_ms, 0.181f, 11) + 1);
+    uint16_t decay = codec_log2_code(drc->decay_ms, 186.0f, 8);
+    
+    codec_dsp_block(CODEC_DSP_DRC, 1);
+    codec_write_cached(WM8994_AIF1_DRC1_2, (uint16_t)((attack << 9) | (decay << 5) | (1 << 2) | max_gain));
+    codec_write_cached(WM8994_AIF1_DRC1_3, (uint16_t)(hi_comp << 3));
+    codec_write_cached(WM8994_AIF1_DRC1_4, (uint16_t)((knee_in << 5) | knee_out));
+    return codec_write_cached(WM8994_AIF1_DRC1_1, WM8994_AIF1DRC1_DEFAULT | WM8994_AIF1DAC1_DRC_ENA);
+}
+
+/**
+ * Set the 3D stereo enhancement depth (0: off)
+ */
+codec_status_t codec_set_3d(uint8_t depth) {
+    const uint16_t mask = (0x1F << WM8994_AIF1DAC1_3D_GAIN_SHIFT) | WM8994_AIF1DAC1_3D_ENA;
+    
+    if (depth > 31 || (depth && !codec_dsp_available())) {
+        return CODEC_ERROR;
+    }
+    if (depth) {
+        codec_dsp_block(CODEC_DSP_3D, 1);
+    }
+    codec_status_t status = codec_update_cached(WM8994_AIF1_DAC1_FILTERS_2, mask,
+        depth ? (uint16_t)((depth << WM8994_AIF1DAC1_3D_GAIN_SHIFT) | WM8994_AIF1DAC1_3D_ENA) : 0);
+    if (!depth) {
+        codec_dsp_block(CODEC_DSP_3D, 0);
+    }
+    return status;
+}
+
+/**
+ * I2S interrupt handler (called from the I2S DMA half/complete interrupt)
+ */
+void codec_i2s_interrupt_handler(uint8_t half) {
+    /* Update playback position: one half of the buffer, 2 samples per frame */
     if (codec_state.is_playing) {
-        codec_state.buffer_position++;
+        codec_state.buffer_position += codec_state.buffer_size / 4;
+    }
+    
+    if (codec_state.stream_callback) {
+        codec_state.stream_callback(half);
     }
 }
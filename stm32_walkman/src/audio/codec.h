@@ -17,6 +17,8 @@
  * - 24-bit internal processing
  * - Software volume control (0-100%)
  * - Configurable input/output routing
+ * - On-chip AIF1 DSP: ReTune Mobile 5-band EQ, DRC, 3D enhancement
+ *   (44.1kHz and 48kHz only)
  */
 
 #ifndef __WM8994_CODEC_H
@@ -50,11 +52,37 @@ typedef enum {
     CODEC_OUTPUT_SPEAKER = 1 // Speaker
 } codec_output_dest_t;
 
+/* ReTune Mobile EQ: gain per band (-12..+12 dB, 1 dB steps) on the
+ * default band shapes: low shelf 100 Hz, peaks at 300 Hz, 875 Hz and
+ * 2.4 kHz, high shelf 6.9 kHz */
+#define CODEC_EQ_BANDS 5
+#define CODEC_EQ_GAIN_MAX_DB 12
+
+typedef struct {
+    int8_t gain_db[CODEC_EQ_BANDS];
+} codec_eq_t;
+
+/* DRC: a static curve through the knee, slope 1 below it (the gain there
+ * is knee_out_db - knee_in_db), 1/ratio above it; rounded to the chip's
+ * steps when programmed */
+typedef struct {
+    float knee_in_db;        // Input level at the knee, 0 to -45 dB
+    float knee_out_db;       // Output level at the knee, 0 to -22.5 dB
+    float ratio;             // Above the knee: 1, 2, 4, 8, 16 (larger: limit)
+    float attack_ms;         // 0.18 to 372 ms
+    float decay_ms;          // 186 ms to 47.6 s
+} codec_drc_t;
+
+/* Stream callback: half (0/1) of the playback buffer is free for refill.
+ * Called from the I2S DMA interrupt. */
+typedef void (*codec_stream_callback_t)(uint8_t half);
+
 /* Function prototypes */
 codec_status_t codec_init(void);
 codec_status_t codec_deinit(void);
 
-/* Playback control */
+/* Playback control (buffer is played circularly, size in samples) */
+void codec_set_stream_callback(codec_stream_callback_t callback);
 codec_status_t codec_play(const int16_t *buffer, uint32_t size);
 codec_status_t codec_stop(void);
 codec_status_t codec_pause(void);
@@ -64,20 +92,41 @@ codec_status_t codec_resume(void);
 codec_status_t codec_set_sample_rate(codec_sample_rate_t rate);
 codec_status_t codec_set_input_source(codec_input_source_t source);
 codec_status_t codec_set_output_destination(codec_output_dest_t dest);
+codec_output_dest_t codec_get_output_destination(void);
 
 /* Volume control (0-100) */
+#define CODEC_VOLUME_CODE_MAX  127  // Output volume code of volume 100, 1 dB per code
+#define CODEC_VOLUME_CODE_MUTE 0x30 // Codes below are muted
+
+/* Output volume code of volume: volume * CODEC_VOLUME_CODE_MAX / 100
+ * (mirrored by tools/loudcomp_table.py) */
+uint8_t codec_volume_code(uint8_t volume);
 codec_status_t codec_set_volume(uint8_t volume);
 uint8_t codec_get_volume(void);
 codec_status_t codec_set_mic_gain(uint8_t gain);
 
+/* On-chip DSP on the playback path; NULL or 0 switches a block off. The
+ * register values are computed here and written through the register
+ * cache, so repeating a setting costs no bus traffic. CODEC_ERROR at
+ * rates the DSP does not run at (codec_dsp_available). */
+uint8_t codec_dsp_available(void);
+codec_status_t codec_set_eq(const codec_eq_t *eq);
+codec_status_t codec_set_drc(const codec_drc_t *drc);
+codec_status_t codec_set_3d(uint8_t depth);  /* 0 (off) to 31 */
+
 /* Status */
+codec_sample_rate_t codec_get_sample_rate(void);
 uint8_t codec_is_playing(void);
 uint32_t codec_get_position(void);
+uint32_t codec_get_buffer_offset(void);
+
+/* Defer the stream callback while the playback buffer is patched in place */
+void codec_hold_stream(uint8_t hold);
 
 /* I2S interrupt handler */
-void codec_i2s_interrupt_handler(void);
+void codec_i2s_interrupt_handler(uint8_t half);
 
-/* Low-level I2C functions */
+/* Low-level I2C functions (16-bit register address and value) */
 codec_status_t codec_read_register(uint16_t addr, uint16_t *value);
 codec_status_t codec_write_register(uint16_t addr, uint16_t value);
 
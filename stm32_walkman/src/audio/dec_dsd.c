@@ -0,0 +1,285 @@
+/**
+ * DSD Decoder Backends (DSF, DSDIFF)
+ * DSD64, mono or stereo, decimated to 44.1kHz PCM by dsd.h
+ *
+ * DSF (Sony) stores each channel in turn in fixed blocks (4096 bytes per
+ * channel), bits LSB first. A read walks each channel's part of the block
+ * group on its own, filling that channel's output slots; between calls
+ * the file only moves forward within a group except for the step back to
+ * the first channel. DSDIFF (.dff, Philips) interleaves the channels byte
+ * by byte, MSB first, and streams like PCM. DST-compressed DSDIFF is not
+ * supported.
+ *
+ * Output frame n is input bytes 8n..8n+7 of each channel, so seeks are
+ * byte math; the decimation filters restart from silence.
+ */
+
+#include "decoder.h"
+#include <string.h>
+
+#define DSF_HEADER_BYTES        92      // "DSD ", "fmt " and "data" chunk headers
+#define DSF_FMT_OFFSET          28
+#define DSF_DATA_OFFSET         80
+#define DSF_BITS_LSB_FIRST      1
+
+/* Big-endian fields of DSDIFF */
+static uint32_t dff_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* 64-bit chunk sizes: anything past 4GB cannot be on FAT32 anyway */
+static int dsd_size64(uint32_t high, uint32_t low, uint32_t* size) {
+    *size = low;
+    return high == 0;
+}
+
+/**
+ * Common stream setup: only DSD64 decimates to a codec rate
+ */
+static int dsd_setup(decoder_t* dec, uint32_t dsd_rate, uint32_t channels, uint8_t lsb_first) {
+    if (dsd_rate != DSD64_RATE || channels < 1 || channels > 2) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+    dec->sample_rate = DSD_PCM_RATE;
+    dec->channels = (uint8_t)channels;
+    dec->bits_per_sample = 1;
+    dsd_init(&dec->dsd, lsb_first);
+    return DECODER_OK;
+}
+
+/* ============ DSF ============ */
+
+static int dsf_probe(const uint8_t* header, uint32_t len) {
+    return len >= DSF_FMT_OFFSET + 4 &&
+           memcmp(header, "DSD ", 4) == 0 &&
+           memcmp(header + DSF_FMT_OFFSET, "fmt ", 4) == 0;
+}
+
+static int dsf_open(decoder_t* dec) {
+    uint8_t* h = dec->io_buffer;
+    uint32_t samples, data_size;
+
+    if (storage_read(&dec->file, h, DSF_HEADER_BYTES) != DSF_HEADER_BYTES ||
+        memcmp(h + DSF_DATA_OFFSET, "data", 4) != 0) {
+        return DECODER_ERROR;
+    }
+
+    const uint8_t* fmt = h + DSF_FMT_OFFSET;
+    uint32_t block = decoder_le32(fmt + 44);
+    if (decoder_le32(fmt + 12) != 1 || decoder_le32(fmt + 16) != 0 ||    /* Version, DSD raw */
+        !dsd_size64(decoder_le32(fmt + 40), decoder_le32(fmt + 36), &samples) ||
+        block == 0 || block % DSD_FRAME_BYTES != 0) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+    int status = dsd_setup(dec, decoder_le32(fmt + 28), decoder_le32(fmt + 24),
+                           decoder_le32(fmt + 32) == DSF_BITS_LSB_FIRST);
+    if (status != DECODER_OK) {
+        return status;
+    }
+
+    dec->data_offset = DSF_HEADER_BYTES;
+    if (!dsd_size64(decoder_le32(h + DSF_DATA_OFFSET + 8), decoder_le32(h + DSF_DATA_OFFSET + 4),
+                    &data_size) || data_size < 12) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+    dec->data_size = data_size - 12;
+    if (dec->data_offset + dec->data_size > dec->file.size) {
+        dec->data_size = dec->file.size - dec->data_offset;  /* Truncated file */
+    }
+    dec->dsd_block = block;
+
+    /* Whole frames present in the file, at most the stated sample count */
+    uint32_t groups = dec->data_size / (block * dec->channels);
+    dec->total_frames = samples / DSD_DECIMATION;
+    if (dec->total_frames > groups * (block / DSD_FRAME_BYTES)) {
+        dec->total_frames = groups * (block / DSD_FRAME_BYTES);
+    }
+    return DECODER_OK;
+}
+
+/**
+ * Each channel's bytes of one block group: channel by channel, in
+ * io_buffer sized pieces
+ */
+static uint32_t dsf_read(decoder_t* dec, int16_t* out, uint32_t frames) {
+    const uint32_t block = dec->dsd_block;
+    const uint32_t piece = DECODER_IO_BUFFER_SIZE / DSD_FRAME_BYTES;
+    uint32_t remaining = dec->total_frames - dec->frame_pos;
+    uint32_t done = 0;
+
+    if (frames > remaining) frames = remaining;
+
+    while (done < frames) {
+        uint32_t byte = (dec->frame_pos + done) * DSD_FRAME_BYTES;
+        uint32_t group = byte / block;
+        uint32_t within = byte % block;
+        uint32_t n = (block - within) / DSD_FRAME_BYTES;
+        if (n > frames - done) n = frames - done;
+
+        for (uint32_t ch = 0; ch < dec->channels; ch++) {
+            uint32_t offset = dec->data_offset + (group * dec->channels + ch) * block + within;
+            if (dec->file.pos != offset && storage_seek(&dec->file, offset) != STORAGE_OK) {
+                return done;
+            }
+            for (uint32_t k = 0; k < n; k += piece) {
+                uint32_t m = (n - k < piece) ? n - k : piece;
+                if (storage_read(&dec->file, dec->io_buffer, m * DSD_FRAME_BYTES) !=
+                    (int32_t)(m * DSD_FRAME_BYTES)) {
+                    return done;
+                }
+                dsd_to_s16(&dec->dsd, ch, dec->io_buffer, 1, m, &out[(done + k) * 2 + ch]);
+            }
+        }
+        if (dec->channels == 1) {
+            for (uint32_t i = done; i < done + n; i++) out[2 * i + 1] = out[2 * i];
+        }
+        done += n;
+    }
+    return done;
+}
+
+/* Reads find their own file position; only the filters restart */
+static int dsd_seek(decoder_t* dec, uint32_t frame) {
+    (void)frame;
+    dsd_reset(&dec->dsd);
+    return DECODER_OK;
+}
+
+const decoder_ops_t dsf_decoder = {
+    .name = "dsf",
+    .probe = dsf_probe,
+    .open = dsf_open,
+    .read = dsf_read,
+    .seek = dsd_seek,
+    .close = NULL
+};
+
+/* ============ DSDIFF ============ */
+
+static int dff_probe(const uint8_t* header, uint32_t len) {
+    return len >= 16 &&
+           memcmp(header, "FRM8", 4) == 0 &&
+           memcmp(header + 12, "DSD ", 4) == 0;
+}
+
+/**
+ * Sound property chunk: sample rate, channels, compression
+ */
+static int dff_parse_prop(decoder_t* dec, uint32_t offset, uint32_t end) {
+    uint8_t chunk[12];
+    uint32_t rate = 0, channels = 0;
+    uint8_t compressed = 0;
+
+    if (storage_seek(&dec->file, offset) != STORAGE_OK ||
+        storage_read(&dec->file, chunk, 4) != 4 || memcmp(chunk, "SND ", 4) != 0) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+    offset += 4;
+
+    while (offset + 12 <= end) {
+        uint32_t size;
+        if (storage_seek(&dec->file, offset) != STORAGE_OK ||
+            storage_read(&dec->file, chunk, 12) != 12 ||
+            !dsd_size64(dff_be32(chunk + 4), dff_be32(chunk + 8), &size)) {
+            return DECODER_ERROR;
+        }
+
+        uint8_t field[4];
+        if (size >= 4 && (memcmp(chunk, "FS  ", 4) == 0 || memcmp(chunk, "CMPR", 4) == 0 ||
+                          memcmp(chunk, "CHNL", 4) == 0)) {
+            if (storage_read(&dec->file, field, 4) != 4) {
+                return DECODER_ERROR;
+            }
+            if (memcmp(chunk, "FS  ", 4) == 0) {
+                rate = dff_be32(field);
+            } else if (memcmp(chunk, "CHNL", 4) == 0) {
+                channels = ((uint32_t)field[0] << 8) | field[1];
+            } else {
+                compressed = memcmp(field, "DSD ", 4) != 0;
+            }
+        }
+        offset += 12 + size + (size & 1);
+    }
+
+    if (compressed) {
+        return DECODER_ERROR_UNSUPPORTED;  /* DST */
+    }
+    return dsd_setup(dec, rate, channels, 0);
+}
+
+static int dff_open(decoder_t* dec) {
+    uint8_t chunk[12];
+    uint32_t offset = 16;
+    uint8_t have_prop = 0;
+
+    while (offset + 12 <= dec->file.size) {
+        uint32_t size;
+        if (storage_seek(&dec->file, offset) != STORAGE_OK ||
+            storage_read(&dec->file, chunk, 12) != 12 ||
+            !dsd_size64(dff_be32(chunk + 4), dff_be32(chunk + 8), &size)) {
+            return DECODER_ERROR;
+        }
+
+        if (memcmp(chunk, "PROP", 4) == 0) {
+            int status = dff_parse_prop(dec, offset + 12, offset + 12 + size);
+            if (status != DECODER_OK) {
+                return status;
+            }
+            have_prop = 1;
+        } else if (memcmp(chunk, "DST ", 4) == 0) {
+            return DECODER_ERROR_UNSUPPORTED;
+        } else if (memcmp(chunk, "DSD ", 4) == 0) {
+            if (!have_prop) {
+                return DECODER_ERROR;
+            }
+            dec->data_offset = offset + 12;
+            dec->data_size = size;
+            if (dec->data_offset + dec->data_size > dec->file.size) {
+                dec->data_size = dec->file.size - dec->data_offset;  /* Truncated file */
+            }
+            dec->total_frames = dec->data_size / (DSD_FRAME_BYTES * dec->channels);
+            return storage_seek(&dec->file, dec->data_offset) == STORAGE_OK ?
+                   DECODER_OK : DECODER_ERROR;
+        }
+
+        offset += 12 + size + (size & 1);
+    }
+    return DECODER_ERROR;
+}
+
+static uint32_t dff_read(decoder_t* dec, int16_t* out, uint32_t frames) {
+    const uint32_t frame_bytes = DSD_FRAME_BYTES * dec->channels;
+    const uint32_t piece = DECODER_IO_BUFFER_SIZE / frame_bytes;
+    uint32_t remaining = dec->total_frames - dec->frame_pos;
+    uint32_t offset = dec->data_offset + dec->frame_pos * frame_bytes;
+    uint32_t done = 0;
+
+    if (frames > remaining) frames = remaining;
+    if (dec->file.pos != offset && storage_seek(&dec->file, offset) != STORAGE_OK) {
+        return 0;
+    }
+
+    while (done < frames) {
+        uint32_t n = (frames - done < piece) ? frames - done : piece;
+        if (storage_read(&dec->file, dec->io_buffer, n * frame_bytes) != (int32_t)(n * frame_bytes)) {
+            break;
+        }
+        for (uint32_t ch = 0; ch < dec->channels; ch++) {
+            dsd_to_s16(&dec->dsd, ch, &dec->io_buffer[ch], dec->channels, n, &out[done * 2 + ch]);
+        }
+        if (dec->channels == 1) {
+            for (uint32_t i = done; i < done + n; i++) out[2 * i + 1] = out[2 * i];
+        }
+        done += n;
+    }
+    return done;
+}
+
+const decoder_ops_t dff_decoder = {
+    .name = "dff",
+    .probe = dff_probe,
+    .open = dff_open,
+    .read = dff_read,
+    .seek = dsd_seek,
+    .close = NULL
+};
@@ -0,0 +1,259 @@
+/**
+ * WAV (RIFF/WAVE) Decoder Backend
+ * Supports 16-bit PCM, IMA ADPCM (0x0011) and Microsoft ADPCM (0x0002),
+ * mono or stereo, any sample rate
+ *
+ * Stereo PCM is read straight into the output buffer; mono PCM is read
+ * into the upper half of the output and expanded in place. ADPCM streams
+ * are decoded block by block through decoder_read_blocks(). Seeks are
+ * byte math on the data chunk (PCM) or on its fixed-size blocks (ADPCM).
+ *
+ * Title, artist and album come from a LIST/INFO chunk (INAM, IART, IPRD)
+ * placed before the data chunk, where common encoders write it.
+ */
+
+#include "decoder.h"
+#include <string.h>
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_MS_ADPCM    0x0002
+#define WAVE_FORMAT_IMA_ADPCM   0x0011
+
+#define WAV_FMT_MAX_BYTES       64
+
+/**
+ * Probe for "RIFF....WAVE"
+ */
+static int wav_probe(const uint8_t* header, uint32_t len) {
+    return len >= 12 &&
+           memcmp(header, "RIFF", 4) == 0 &&
+           memcmp(header + 8, "WAVE", 4) == 0;
+}
+
+/**
+ * Check the coefficient table of a Microsoft ADPCM fmt extension
+ */
+static int wav_ms_coefs_standard(const uint8_t* fmt, uint32_t len) {
+    if (len < 22) return 1;  /* No table: standard pairs implied */
+
+    uint16_t count = decoder_le16(fmt + 20);
+    if (count != ADPCM_MS_NUM_COEFS || len < 22u + 4u * count) return 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if ((int16_t)decoder_le16(fmt + 22 + 4 * i) != adpcm_ms_coefs[i][0] ||
+            (int16_t)decoder_le16(fmt + 24 + 4 * i) != adpcm_ms_coefs[i][1]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Parse the "fmt " chunk body
+ */
+static int wav_parse_fmt(decoder_t* dec, const uint8_t* fmt, uint32_t len) {
+    uint16_t format = decoder_le16(fmt);
+
+    dec->channels = (uint8_t)decoder_le16(fmt + 2);
+    dec->sample_rate = decoder_le32(fmt + 4);
+    dec->bits_per_sample = (uint8_t)decoder_le16(fmt + 14);
+    if (dec->channels < 1 || dec->channels > 2 || dec->sample_rate == 0) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+
+    switch (format) {
+        case WAVE_FORMAT_PCM:
+            dec->block_codec = DECODER_BLOCK_NONE;
+            return dec->bits_per_sample == 16 ? DECODER_OK : DECODER_ERROR_UNSUPPORTED;
+        case WAVE_FORMAT_IMA_ADPCM:
+            dec->block_codec = DECODER_BLOCK_IMA_ADPCM;
+            break;
+        case WAVE_FORMAT_MS_ADPCM:
+            if (!wav_ms_coefs_standard(fmt, len)) {
+                return DECODER_ERROR_UNSUPPORTED;
+            }
+            dec->block_codec = DECODER_BLOCK_MS_ADPCM;
+            break;
+        default:
+            return DECODER_ERROR_UNSUPPORTED;
+    }
+
+    /* ADPCM: whole blocks must fit the decoder's io_buffer */
+    dec->block_bytes = decoder_le16(fmt + 12);
+    dec->block_frames = (format == WAVE_FORMAT_IMA_ADPCM) ?
+                        adpcm_ima_block_frames(dec->block_bytes, dec->channels) :
+                        adpcm_ms_block_frames(dec->block_bytes, dec->channels);
+    if (dec->bits_per_sample != 4 || dec->block_frames == 0 ||
+        dec->block_bytes > DECODER_IO_BUFFER_SIZE) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+    return DECODER_OK;
+}
+
+/**
+ * Frames in the data chunk
+ */
+static uint32_t wav_count_frames(const decoder_t* dec) {
+    if (dec->block_codec == DECODER_BLOCK_NONE) {
+        return dec->data_size / (dec->channels * 2u);
+    }
+
+    uint32_t rest = dec->data_size % dec->block_bytes;
+    uint32_t frames = (dec->data_size / dec->block_bytes) * dec->block_frames;
+    if (rest > 0) {
+        frames += (dec->block_codec == DECODER_BLOCK_MS_ADPCM) ?
+                  adpcm_ms_block_frames(rest, dec->channels) :
+                  adpcm_ima_block_frames(rest, dec->channels);
+    }
+    return frames;
+}
+
+/**
+ * Copy the tags of a LIST/INFO chunk body
+ */
+static int wav_parse_info(decoder_t* dec, uint32_t offset, uint32_t end) {
+    uint8_t sub[8];
+
+    if (end > dec->file.size) end = dec->file.size;
+    while (offset + 8 <= end) {
+        if (storage_seek(&dec->file, offset) != STORAGE_OK ||
+            storage_read(&dec->file, sub, 8) != 8) {
+            return DECODER_ERROR;
+        }
+
+        uint32_t size = decoder_le32(sub + 4);
+        char* tag = memcmp(sub, "INAM", 4) == 0 ? dec->title :
+                    memcmp(sub, "IART", 4) == 0 ? dec->artist :
+                    memcmp(sub, "IPRD", 4) == 0 ? dec->album : NULL;
+        if (tag != NULL) {
+            uint32_t len = size < DECODER_TAG_LEN - 1 ? size : DECODER_TAG_LEN - 1;
+            if (storage_read(&dec->file, tag, len) != (int32_t)len) {
+                return DECODER_ERROR;
+            }
+            tag[len] = '\0';
+        }
+
+        offset += 8 + size + (size & 1);
+    }
+    return DECODER_OK;
+}
+
+/**
+ * Walk RIFF chunks, parse "fmt ", "fact" and LIST/INFO, locate "data"
+ */
+static int wav_open(decoder_t* dec) {
+    uint8_t chunk[8];
+    uint32_t offset = 12;
+    uint32_t fact_frames = 0;
+    uint8_t have_fmt = 0;
+
+    while (offset + 8 <= dec->file.size) {
+        if (storage_seek(&dec->file, offset) != STORAGE_OK ||
+            storage_read(&dec->file, chunk, 8) != 8) {
+            return DECODER_ERROR;
+        }
+
+        uint32_t chunk_size = decoder_le32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            /* io_buffer is free until the first read */
+            uint32_t len = chunk_size < WAV_FMT_MAX_BYTES ? chunk_size : WAV_FMT_MAX_BYTES;
+            if (chunk_size < 16 || storage_read(&dec->file, dec->io_buffer, len) != (int32_t)len) {
+                return DECODER_ERROR;
+            }
+            int status = wav_parse_fmt(dec, dec->io_buffer, len);
+            if (status != DECODER_OK) {
+                return status;
+            }
+            have_fmt = 1;
+        } else if (memcmp(chunk, "fact", 4) == 0 && chunk_size >= 4) {
+            if (storage_read(&dec->file, chunk, 4) != 4) {
+                return DECODER_ERROR;
+            }
+            fact_frames = decoder_le32(chunk);
+        } else if (memcmp(chunk, "LIST", 4) == 0 && chunk_size >= 4) {
+            if (storage_read(&dec->file, chunk, 4) != 4) {
+                return DECODER_ERROR;
+            }
+            if (memcmp(chunk, "INFO", 4) == 0 &&
+                wav_parse_info(dec, offset + 12, offset + 8 + chunk_size) != DECODER_OK) {
+                return DECODER_ERROR;
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) {
+                return DECODER_ERROR;
+            }
+            dec->data_offset = offset + 8;
+            dec->data_size = chunk_size;
+            if (dec->data_offset + dec->data_size > dec->file.size) {
+                dec->data_size = dec->file.size - dec->data_offset;  /* Truncated file */
+            }
+            dec->total_frames = wav_count_frames(dec);
+
+            /* ADPCM encoders pad the last block; "fact" has the true length */
+            if (dec->block_codec != DECODER_BLOCK_NONE && fact_frames > 0 &&
+                fact_frames < dec->total_frames) {
+                dec->total_frames = fact_frames;
+            }
+            return storage_seek(&dec->file, dec->data_offset) == STORAGE_OK ?
+                   DECODER_OK : DECODER_ERROR;
+        }
+
+        offset += 8 + chunk_size + (chunk_size & 1);  /* Chunks are word aligned */
+    }
+
+    return DECODER_ERROR;
+}
+
+/**
+ * Seek to a frame of the data chunk
+ */
+static int wav_seek(decoder_t* dec, uint32_t frame) {
+    if (dec->block_codec == DECODER_BLOCK_NONE) {
+        uint32_t offset = dec->data_offset + frame * dec->channels * 2u;
+        return storage_seek(&dec->file, offset) == STORAGE_OK ? DECODER_OK : DECODER_ERROR;
+    }
+    return decoder_seek_blocks(dec, frame);
+}
+
+/**
+ * Read frames as interleaved stereo
+ */
+static uint32_t wav_read(decoder_t* dec, int16_t* out, uint32_t frames) {
+    uint32_t remaining = dec->total_frames - dec->frame_pos;
+    int32_t got;
+
+    if (frames > remaining) frames = remaining;
+    if (frames == 0) return 0;
+
+    if (dec->block_codec != DECODER_BLOCK_NONE) {
+        return decoder_read_blocks(dec, out, frames);
+    }
+
+    if (dec->channels == 2) {
+        got = storage_read(&dec->file, out, frames * 4);
+        return got > 0 ? (uint32_t)got / 4 : 0;
+    }
+
+    /* Mono: read into the top half, duplicate downwards */
+    int16_t* mono = out + frames;
+    got = storage_read(&dec->file, mono, frames * 2);
+    if (got <= 0) return 0;
+    frames = (uint32_t)got / 2;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        int16_t s = mono[i];
+        out[2 * i] = s;
+        out[2 * i + 1] = s;
+    }
+    return frames;
+}
+
+const decoder_ops_t wav_decoder = {
+    .name = "wav",
+    .probe = wav_probe,
+    .open = wav_open,
+    .read = wav_read,
+    .seek = wav_seek,
+    .close = NULL
+};
@@ -0,0 +1,80 @@
+/**
+ * WNF Decoder Backend
+ * Walkman Native Format tracks written by tools/wnfpack (see wnf.h)
+ *
+ * PCM16 blocks are already output-rate stereo and are read straight into
+ * the output buffer. ADPCM blocks are read whole into io_buffer and
+ * decoded from there, continuing mid-block across calls. All blocks hold
+ * frames_per_block frames, so the header geometry is the seek index.
+ */
+
+#include "decoder.h"
+#include "wnf.h"
+#include <string.h>
+
+static int wnf_probe(const uint8_t* header, uint32_t len) {
+    return len >= 4 && memcmp(header, WNF_MAGIC, 4) == 0;
+}
+
+/**
+ * Parse the header sector and position at the first block
+ */
+static int wnf_open(decoder_t* dec) {
+    wnf_header_t hdr;
+
+    if (storage_read(&dec->file, dec->io_buffer, WNF_HEADER_BYTES) != WNF_HEADER_BYTES) {
+        return DECODER_ERROR;
+    }
+    if (wnf_header_parse(&hdr, dec->io_buffer) != 0) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+    if (hdr.codec == WNF_CODEC_IMA_ADPCM && hdr.block_bytes > DECODER_IO_BUFFER_SIZE) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+
+    dec->sample_rate = hdr.sample_rate;
+    dec->channels = hdr.channels;
+    dec->bits_per_sample = (hdr.codec == WNF_CODEC_PCM16) ? 16 : 4;
+    dec->total_frames = hdr.total_frames;
+    dec->data_offset = hdr.data_offset;
+    dec->data_size = hdr.block_count * hdr.block_bytes;
+    if (dec->data_offset + dec->data_size > dec->file.size) {
+        return DECODER_ERROR;  /* Truncated file */
+    }
+
+    dec->block_codec = (hdr.codec == WNF_CODEC_IMA_ADPCM) ? DECODER_BLOCK_IMA_ADPCM :
+                                                            DECODER_BLOCK_NONE;
+    dec->block_bytes = hdr.block_bytes;
+    dec->block_frames = hdr.frames_per_block;
+
+    memcpy(dec->title, hdr.title, DECODER_TAG_LEN);
+    memcpy(dec->artist, hdr.artist, DECODER_TAG_LEN);
+    memcpy(dec->album, hdr.album, DECODER_TAG_LEN);
+    dec->replay_gain = hdr.track_gain;
+    dec->replay_peak = hdr.track_peak;
+
+    return storage_seek(&dec->file, dec->data_offset) == STORAGE_OK ?
+           DECODER_OK : DECODER_ERROR;
+}
+
+static uint32_t wnf_read(decoder_t* dec, int16_t* out, uint32_t frames) {
+    uint32_t remaining = dec->total_frames - dec->frame_pos;
+
+    if (frames > remaining) frames = remaining;
+    if (frames == 0) return 0;
+
+    if (dec->block_codec == DECODER_BLOCK_NONE) {
+        int32_t got = storage_read(&dec->file, out, frames * 4);
+        return got > 0 ? (uint32_t)got / 4 : 0;
+    }
+    return decoder_read_blocks(dec, out, frames);
+}
+
+const decoder_ops_t wnf_decoder = {
+    .name = "wnf",
+    .probe = wnf_probe,
+    .open = wnf_open,
+    .read = wnf_read,
+    .seek = decoder_seek_blocks,
+    .close = NULL
+};
@@ -0,0 +1,199 @@
+/**
+ * Audio Decoder Dispatch
+ * Probes file headers and forwards calls to the matching backend
+ */
+
+#include "decoder.h"
+#include <string.h>
+
+/* Frames decoded per pass when a seek lands inside an ADPCM block */
+#define DECODER_SEEK_SKIP_FRAMES 128
+
+/* Registered backends, probed in order */
+static const decoder_ops_t* const decoder_backends[] = {
+    &wav_decoder,
+    &wnf_decoder,
+    &dsf_decoder,
+    &dff_decoder,
+};
+
+#define NUM_DECODER_BACKENDS (sizeof(decoder_backends) / sizeof(decoder_backends[0]))
+
+/**
+ * Find the backend that accepts a header
+ */
+const decoder_ops_t* decoder_probe(const uint8_t* header, uint32_t len) {
+    for (uint32_t i = 0; i < NUM_DECODER_BACKENDS; i++) {
+        if (decoder_backends[i]->probe(header, len)) {
+            return decoder_backends[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Open file and select a backend by probing its header
+ */
+int decoder_open(decoder_t* dec, const char* path) {
+    uint8_t header[DECODER_PROBE_SIZE];
+    int32_t len;
+    int status;
+
+    memset(dec, 0, sizeof(*dec) - sizeof(dec->io_buffer));
+
+    status = storage_open(&dec->file, path);
+    if (status != STORAGE_OK) {
+        return (status == STORAGE_ERROR_NO_FILE) ? DECODER_ERROR_NO_FILE : DECODER_ERROR;
+    }
+
+    len = storage_read(&dec->file, header, sizeof(header));
+    if (len <= 0 || storage_seek(&dec->file, 0) != STORAGE_OK) {
+        storage_close(&dec->file);
+        return DECODER_ERROR;
+    }
+
+    dec->ops = decoder_probe(header, (uint32_t)len);
+    if (dec->ops == NULL) {
+        storage_close(&dec->file);
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+
+    status = dec->ops->open(dec);
+    if (status != DECODER_OK) {
+        storage_close(&dec->file);
+        dec->ops = NULL;
+        return status;
+    }
+
+    return DECODER_OK;
+}
+
+/**
+ * Decode up to frames stereo frames, returns 0 at end of stream
+ */
+uint32_t decoder_read(decoder_t* dec, int16_t* out, uint32_t frames) {
+    if (dec->ops == NULL) {
+        return 0;
+    }
+
+    uint32_t n = dec->ops->read(dec, out, frames);
+    dec->frame_pos += n;
+    return n;
+}
+
+/**
+ * Position the stream so the next read returns frame (clamped to the end)
+ */
+int decoder_seek(decoder_t* dec, uint32_t frame) {
+    if (dec->ops == NULL) {
+        return DECODER_ERROR;
+    }
+    if (dec->ops->seek == NULL) {
+        return DECODER_ERROR_UNSUPPORTED;
+    }
+    if (dec->total_frames > 0 && frame > dec->total_frames) {
+        frame = dec->total_frames;
+    }
+
+    int status = dec->ops->seek(dec, frame);
+    if (status == DECODER_OK) {
+        dec->frame_pos = frame;
+    }
+    return status;
+}
+
+/**
+ * Frames held in a block of bytes (a short last block holds fewer)
+ */
+static uint32_t decoder_block_frames(const decoder_t* dec, uint32_t bytes) {
+    return dec->block_codec == DECODER_BLOCK_MS_ADPCM ?
+           adpcm_ms_block_frames(bytes, dec->channels) :
+           adpcm_ima_block_frames(bytes, dec->channels);
+}
+
+/**
+ * Decode block-coded frames, loading blocks into io_buffer as they run out
+ */
+uint32_t decoder_read_blocks(decoder_t* dec, int16_t* out, uint32_t frames) {
+    uint32_t done = 0;
+
+    while (done < frames) {
+        if (dec->block_pos >= dec->block_avail) {
+            int32_t got = storage_read(&dec->file, dec->io_buffer, dec->block_bytes);
+            dec->block_avail = (got > 0) ? decoder_block_frames(dec, (uint32_t)got) : 0;
+            if (dec->block_avail > dec->block_frames) dec->block_avail = dec->block_frames;
+            dec->block_pos = 0;
+            if (dec->block_avail == 0) break;
+        }
+
+        uint32_t n = dec->block_avail - dec->block_pos;
+        if (n > frames - done) n = frames - done;
+
+        if (dec->block_codec == DECODER_BLOCK_MS_ADPCM) {
+            adpcm_ms_decode(dec->adpcm.ms, dec->io_buffer, dec->channels,
+                            dec->block_pos, n, &out[done * 2]);
+        } else {
+            adpcm_ima_decode(dec->adpcm.ima, dec->io_buffer, dec->channels,
+                             dec->block_pos, n, &out[done * 2]);
+        }
+        dec->block_pos += n;
+        done += n;
+    }
+    return done;
+}
+
+/**
+ * Seek by block geometry: PCM lands on the frame's byte, ADPCM predictors
+ * only run forward, so the block is decoded from its header up to the frame
+ */
+int decoder_seek_blocks(decoder_t* dec, uint32_t frame) {
+    int16_t scratch[DECODER_SEEK_SKIP_FRAMES * 2];
+    uint32_t block = frame / dec->block_frames;
+    uint32_t skip = frame % dec->block_frames;
+    uint32_t offset = dec->data_offset + block * dec->block_bytes;
+
+    dec->block_avail = 0;
+    dec->block_pos = 0;
+
+    if (dec->block_codec == DECODER_BLOCK_NONE) {
+        offset += skip * dec->channels * 2u;
+        skip = 0;
+    }
+    if (storage_seek(&dec->file, offset) != STORAGE_OK) {
+        return DECODER_ERROR;
+    }
+
+    while (skip > 0) {
+        uint32_t n = skip < DECODER_SEEK_SKIP_FRAMES ? skip : DECODER_SEEK_SKIP_FRAMES;
+        if (decoder_read_blocks(dec, scratch, n) != n) {
+            return DECODER_ERROR;
+        }
+        skip -= n;
+    }
+    return DECODER_OK;
+}
+
+/**
+ * Close backend and file
+ */
+void decoder_close(decoder_t* dec) {
+    if (dec->ops == NULL) {
+        return;
+    }
+
+    if (dec->ops->close) {
+        dec->ops->close(dec);
+    }
+    storage_close(&dec->file);
+    dec->ops = NULL;
+}
+
+/**
+ * Track duration in whole seconds (0 if unknown)
+ */
+uint32_t decoder_duration_sec(const decoder_t* dec) {
+    if (dec->sample_rate == 0) {
+        return 0;
+    }
+    return dec->total_frames / dec->sample_rate;
+}
@@ -0,0 +1,128 @@
+/**
+ * Audio Decoder Interface
+ *
+ * Every file format is handled by a backend implementing decoder_ops_t.
+ * decoder_open() reads the first bytes of the file, asks each registered
+ * backend to probe them and opens the first match. All backends output
+ * interleaved stereo 16-bit frames at the file's native sample rate
+ * (DSD: decimated to 44.1kHz, sample_rate is the PCM rate).
+ *
+ * Seeking is frame exact. Backends locate the frame from their container
+ * geometry (PCM byte math, fixed-size ADPCM blocks), so a seek costs one
+ * file seek plus at most one block of decoding whatever the file size.
+ */
+
+#ifndef __DECODER_H
+#define __DECODER_H
+
+#include <stdint.h>
+#include "storage.h"
+#include "adpcm.h"
+#include "dsd.h"
+
+#define DECODER_PROBE_SIZE 64
+#define DECODER_IO_BUFFER_SIZE 2048
+#define DECODER_TAG_LEN 64
+
+typedef enum {
+    DECODER_OK = 0,
+    DECODER_ERROR = 1,
+    DECODER_ERROR_NO_FILE = 2,
+    DECODER_ERROR_UNSUPPORTED = 3
+} decoder_status_t;
+
+/* Block codecs handled by decoder_read_blocks() */
+typedef enum {
+    DECODER_BLOCK_NONE = 0,
+    DECODER_BLOCK_IMA_ADPCM,
+    DECODER_BLOCK_MS_ADPCM
+} decoder_block_codec_t;
+
+typedef struct decoder decoder_t;
+
+/* Backend operations */
+typedef struct {
+    const char* name;
+    int (*probe)(const uint8_t* header, uint32_t len);   // 1 if format matches
+    int (*open)(decoder_t* dec);                        // Parse headers, file at offset 0
+    uint32_t (*read)(decoder_t* dec, int16_t* out, uint32_t frames);
+    int (*seek)(decoder_t* dec, uint32_t frame);         // NULL if not seekable
+    void (*close)(decoder_t* dec);
+} decoder_ops_t;
+
+/* Decoder instance (statically allocated by the player) */
+struct decoder {
+    const decoder_ops_t* ops;
+    storage_file_t file;
+
+    /* Stream format, filled in by open() */
+    uint32_t sample_rate;
+    uint8_t channels;
+    uint8_t bits_per_sample;
+    uint32_t total_frames;      // 0 if unknown
+    uint32_t frame_pos;         // Frames decoded so far
+
+    /* Container layout */
+    uint32_t data_offset;       // First byte of audio payload
+    uint32_t data_size;         // Payload size in bytes
+
+    /* Block-coded payloads (ADPCM): the current block sits in io_buffer */
+    uint8_t block_codec;        // decoder_block_codec_t
+    uint16_t block_bytes;       // Coded block size
+    uint32_t block_frames;      // Frames per full block
+    uint32_t block_avail;       // Frames in the loaded block (last may be short)
+    uint32_t block_pos;         // Next frame of the loaded block
+    union {
+        adpcm_ima_state_t ima[ADPCM_IMA_MAX_CHANNELS];
+        adpcm_ms_state_t ms[ADPCM_MS_MAX_CHANNELS];
+    } adpcm;
+
+    /* DSD payloads: DSF block per channel (bytes), decimation filters */
+    uint32_t dsd_block;
+    dsd_t dsd;
+
+    /* Track metadata from the container, empty / 0 if it has none */
+    char title[DECODER_TAG_LEN];
+    char artist[DECODER_TAG_LEN];
+    char album[DECODER_TAG_LEN];
+    int16_t replay_gain;        // Track gain in 0.01 dB
+    uint16_t replay_peak;       // Q15, 32768 = full scale
+
+    /* Scratch for backends that cannot decode in place */
+    uint8_t io_buffer[DECODER_IO_BUFFER_SIZE];
+};
+
+/* Backends */
+extern const decoder_ops_t wav_decoder;
+extern const decoder_ops_t wnf_decoder;
+extern const decoder_ops_t dsf_decoder;
+extern const decoder_ops_t dff_decoder;
+
+/* Generic API */
+int decoder_open(decoder_t* dec, const char* path);
+uint32_t decoder_read(decoder_t* dec, int16_t* out, uint32_t frames);
+int decoder_seek(decoder_t* dec, uint32_t frame);
+void decoder_close(decoder_t* dec);
+uint32_t decoder_duration_sec(const decoder_t* dec);
+
+/* Shared read path of block-coded backends; open() sets block_codec,
+ * block_bytes and block_frames and leaves the file at the first block */
+uint32_t decoder_read_blocks(decoder_t* dec, int16_t* out, uint32_t frames);
+
+/* Seek of block-coded and block-aligned PCM payloads (block_frames set) */
+int decoder_seek_blocks(decoder_t* dec, uint32_t frame);
+
+/* Header probe without opening a decoder: returns backend or NULL */
+const decoder_ops_t* decoder_probe(const uint8_t* header, uint32_t len);
+
+/* Little-endian field helpers for container parsers */
+static inline uint16_t decoder_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t decoder_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#endif /* __DECODER_H */
@@ -0,0 +1,158 @@
+/**
+ * Correction Filter Files - Implementation
+ */
+
+#include "fir_file.h"
+#include "decoder.h"
+#include <string.h>
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_IEEE_FLOAT  0x0003
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+#define FIR_FMT_MAX_BYTES       40
+
+/**
+ * Parse the "fmt " chunk body; the extensible format carries the real one
+ * in the first two bytes of its subformat GUID
+ */
+static int fir_parse_fmt(fir_file_t* fir, const uint8_t* fmt, uint32_t len) {
+    uint16_t format = decoder_le16(fmt);
+    uint16_t bits = decoder_le16(fmt + 14);
+
+    if (format == WAVE_FORMAT_EXTENSIBLE) {
+        if (len < 26) {
+            return FIR_FILE_ERROR_UNSUPPORTED;
+        }
+        format = decoder_le16(fmt + 24);
+    }
+
+    fir->channels = (uint8_t)decoder_le16(fmt + 2);
+    fir->sample_rate = decoder_le32(fmt + 4);
+    fir->bytes = (uint8_t)(bits / 8);
+    fir->is_float = (format == WAVE_FORMAT_IEEE_FLOAT);
+    if (fir->channels < 1 || fir->channels > 2 || fir->sample_rate == 0) {
+        return FIR_FILE_ERROR_UNSUPPORTED;
+    }
+    if (format == WAVE_FORMAT_PCM && (bits == 16 || bits == 24 || bits == 32)) {
+        return FIR_FILE_OK;
+    }
+    return (fir->is_float && bits == 32) ? FIR_FILE_OK : FIR_FILE_ERROR_UNSUPPORTED;
+}
+
+/**
+ * Walk RIFF chunks to "fmt " and "data", leave the file at the first tap
+ */
+static int fir_open_wav(fir_file_t* fir) {
+    uint8_t chunk[8];
+    uint8_t fmt[FIR_FMT_MAX_BYTES];
+    uint32_t offset = 12;
+    uint8_t have_fmt = 0;
+
+    while (offset + 8 <= fir->file.size) {
+        if (storage_seek(&fir->file, offset) != STORAGE_OK ||
+            storage_read(&fir->file, chunk, 8) != 8) {
+            return FIR_FILE_ERROR;
+        }
+
+        uint32_t chunk_size = decoder_le32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint32_t len = chunk_size < FIR_FMT_MAX_BYTES ? chunk_size : FIR_FMT_MAX_BYTES;
+            if (chunk_size < 16 || storage_read(&fir->file, fmt, len) != (int32_t)len) {
+                return FIR_FILE_ERROR;
+            }
+            int status = fir_parse_fmt(fir, fmt, len);
+            if (status != FIR_FILE_OK) {
+                return status;
+            }
+            have_fmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) {
+                return FIR_FILE_ERROR;
+            }
+            uint32_t size = fir->file.size - (offset + 8);
+            if (chunk_size < size) size = chunk_size;
+            fir->frames = size / (fir->channels * (uint32_t)fir->bytes);
+            return FIR_FILE_OK;
+        }
+
+        offset += 8 + chunk_size + (chunk_size & 1);
+    }
+    return FIR_FILE_ERROR;
+}
+
+/**
+ * Open a filter file: RIFF/WAVE by its header, raw float32 otherwise
+ */
+int fir_file_open(fir_file_t* fir, const char* path) {
+    uint8_t header[12];
+
+    memset(fir, 0, sizeof(*fir));
+    switch (storage_open(&fir->file, path)) {
+        case STORAGE_OK:
+            break;
+        case STORAGE_ERROR_NO_FILE:
+            return FIR_FILE_ERROR_NO_FILE;
+        default:
+            return FIR_FILE_ERROR;
+    }
+
+    int status;
+    if (storage_read(&fir->file, header, sizeof(header)) == (int32_t)sizeof(header) &&
+        memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0) {
+        status = fir_open_wav(fir);
+    } else {
+        fir->sample_rate = 0;
+        fir->channels = 1;
+        fir->bytes = 4;
+        fir->is_float = 1;
+        fir->frames = fir->file.size / 4;
+        status = storage_seek(&fir->file, 0) == STORAGE_OK ? FIR_FILE_OK : FIR_FILE_ERROR;
+    }
+
+    if (status == FIR_FILE_OK && fir->frames == 0) {
+        status = FIR_FILE_ERROR_UNSUPPORTED;
+    }
+    if (status != FIR_FILE_OK) {
+        storage_close(&fir->file);
+    }
+    return status;
+}
+
+/**
+ * Read and convert one chunk; samples are little-endian, the top bytes of
+ * PCM land in the top of an int32 so every width scales alike
+ */
+uint32_t fir_file_read(fir_file_t* fir, float* taps, uint32_t frames) {
+    uint8_t raw[FIR_FILE_CHUNK * 2 * 4];
+    const uint32_t bytes = fir->bytes;
+
+    if (frames > FIR_FILE_CHUNK) frames = FIR_FILE_CHUNK;
+    if (frames > fir->frames - fir->position) frames = fir->frames - fir->position;
+
+    uint32_t samples = frames * fir->channels;
+    if (frames == 0 || storage_read(&fir->file, raw, samples * bytes) != (int32_t)(samples * bytes)) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < samples; i++) {
+        const uint8_t* p = &raw[i * bytes];
+        uint32_t word = 0;
+        for (uint32_t b = 0; b < bytes; b++) {
+            word |= (uint32_t)p[b] << (8 * (4 - bytes + b));
+        }
+        if (fir->is_float) {
+            memcpy(&taps[i], &word, sizeof(float));
+        } else {
+            taps[i] = (float)(int32_t)word * (1.0f / 2147483648.0f);
+        }
+    }
+
+    fir->position += frames;
+    return frames;
+}
+
+void fir_file_close(fir_file_t* fir) {
+    storage_close(&fir->file);
+}
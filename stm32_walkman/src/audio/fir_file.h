@@ -0,0 +1,46 @@
+/**
+ * Correction Filter Files
+ *
+ * Reads the taps of an FIR filter for the convolver (convolver.h) from the
+ * SD card, a chunk at a time:
+ * - WAV: PCM 16/24/32-bit or IEEE float 32-bit (WAVE_FORMAT_EXTENSIBLE
+ *        included), mono (same filter on both ears) or stereo; the
+ *        filter applies at the file's sample rate only
+ * - raw: no RIFF header, mono float32 little-endian, any rate
+ *
+ * Taps come back as float, full scale = 1.0.
+ */
+
+#ifndef __FIR_FILE_H
+#define __FIR_FILE_H
+
+#include <stdint.h>
+#include "storage.h"
+
+#define FIR_FILE_CHUNK 64           // Max frames per fir_file_read()
+
+typedef enum {
+    FIR_FILE_OK = 0,
+    FIR_FILE_ERROR = 1,
+    FIR_FILE_ERROR_NO_FILE = 2,
+    FIR_FILE_ERROR_UNSUPPORTED = 3
+} fir_file_status_t;
+
+typedef struct {
+    storage_file_t file;
+    uint32_t sample_rate;       // 0 = any (raw files)
+    uint32_t frames;            // Taps per channel
+    uint32_t position;          // Frames read so far
+    uint8_t channels;           // 1 or 2
+    uint8_t bytes;              // Per sample
+    uint8_t is_float;
+} fir_file_t;
+
+int fir_file_open(fir_file_t* fir, const char* path);
+
+/* Next frames (at most FIR_FILE_CHUNK) as interleaved float; returns frames, 0 at the end */
+uint32_t fir_file_read(fir_file_t* fir, float* taps, uint32_t frames);
+
+void fir_file_close(fir_file_t* fir);
+
+#endif /* __FIR_FILE_H */
@@ -0,0 +1,122 @@
+/**
+ * PCM Ring Buffer Implementation
+ * Lock-free SPSC FIFO between decoder and I2S DMA interrupt
+ */
+
+#include "pcm_ring.h"
+#include <string.h>
+
+/* Keep the compiler from reordering buffer accesses around index updates.
+ * Cortex-M4 is in-order single core, so no hardware barrier is needed; the
+ * Linux daemon runs producer and consumer on different cores. */
+#if defined(__linux__)
+#define PCM_RING_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define PCM_RING_BARRIER() __asm__ volatile("" ::: "memory")
+#endif
+
+/**
+ * Initialize ring over a caller-provided buffer
+ * frames must be a power of two
+ */
+void pcm_ring_init(pcm_ring_t* ring, int16_t* buffer, uint32_t frames) {
+    ring->buffer = buffer;
+    ring->size = frames;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+/**
+ * Drop all buffered frames (call only while the consumer is stopped)
+ */
+void pcm_ring_reset(pcm_ring_t* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+/**
+ * Number of frames available to read
+ */
+uint32_t pcm_ring_count(const pcm_ring_t* ring) {
+    return ring->head - ring->tail;
+}
+
+/**
+ * Number of frames that can be written
+ */
+uint32_t pcm_ring_space(const pcm_ring_t* ring) {
+    return ring->size - (ring->head - ring->tail);
+}
+
+/**
+ * Write up to count frames, returns frames written
+ */
+uint32_t pcm_ring_write(pcm_ring_t* ring, const int16_t* frames, uint32_t count) {
+    uint32_t space = pcm_ring_space(ring);
+    uint32_t mask = ring->size - 1;
+
+    if (count > space) count = space;
+    if (count == 0) return 0;
+
+    uint32_t start = ring->head & mask;
+    uint32_t first = ring->size - start;
+    if (first > count) first = count;
+
+    memcpy(&ring->buffer[start * PCM_RING_CHANNELS], frames,
+           first * PCM_RING_CHANNELS * sizeof(int16_t));
+    if (count > first) {
+        memcpy(ring->buffer, &frames[first * PCM_RING_CHANNELS],
+               (count - first) * PCM_RING_CHANNELS * sizeof(int16_t));
+    }
+
+    PCM_RING_BARRIER();
+    ring->head += count;
+    return count;
+}
+
+/**
+ * Read up to count frames, returns frames read
+ */
+uint32_t pcm_ring_read(pcm_ring_t* ring, int16_t* frames, uint32_t count) {
+    uint32_t avail = pcm_ring_count(ring);
+    uint32_t mask = ring->size - 1;
+
+    if (count > avail) count = avail;
+    if (count == 0) return 0;
+
+    PCM_RING_BARRIER();
+    uint32_t start = ring->tail & mask;
+    uint32_t first = ring->size - start;
+    if (first > count) first = count;
+
+    memcpy(frames, &ring->buffer[start * PCM_RING_CHANNELS],
+           first * PCM_RING_CHANNELS * sizeof(int16_t));
+    if (count > first) {
+        memcpy(&frames[first * PCM_RING_CHANNELS], ring->buffer,
+               (count - first) * PCM_RING_CHANNELS * sizeof(int16_t));
+    }
+
+    PCM_RING_BARRIER();
+    ring->tail += count;
+    return count;
+}
+
+/**
+ * Get pointer to the contiguous free region at the write position
+ */
+int16_t* pcm_ring_write_ptr(pcm_ring_t* ring, uint32_t* contiguous) {
+    uint32_t space = pcm_ring_space(ring);
+    uint32_t start = ring->head & (ring->size - 1);
+    uint32_t first = ring->size - start;
+
+    *contiguous = (space < first) ? space : first;
+    return &ring->buffer[start * PCM_RING_CHANNELS];
+}
+
+/**
+ * Publish frames written through pcm_ring_write_ptr()
+ */
+void pcm_ring_commit(pcm_ring_t* ring, uint32_t count) {
+    PCM_RING_BARRIER();
+    ring->head += count;
+}
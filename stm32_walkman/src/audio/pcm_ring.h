@@ -0,0 +1,38 @@
+/**
+ * PCM Ring Buffer
+ *
+ * Single-producer/single-consumer FIFO of interleaved stereo 16-bit frames.
+ * The decoder (main loop) writes, the I2S DMA interrupt reads. Indices are
+ * free-running frame counters, so no lock is needed as long as each side
+ * only updates its own index.
+ */
+
+#ifndef __PCM_RING_H
+#define __PCM_RING_H
+
+#include <stdint.h>
+
+#define PCM_RING_CHANNELS 2
+
+typedef struct {
+    int16_t* buffer;          // size * PCM_RING_CHANNELS samples
+    uint32_t size;            // Capacity in frames (power of two)
+    volatile uint32_t head;   // Frames written (producer)
+    volatile uint32_t tail;   // Frames read (consumer)
+} pcm_ring_t;
+
+void pcm_ring_init(pcm_ring_t* ring, int16_t* buffer, uint32_t frames);
+void pcm_ring_reset(pcm_ring_t* ring);
+
+uint32_t pcm_ring_count(const pcm_ring_t* ring);
+uint32_t pcm_ring_space(const pcm_ring_t* ring);
+
+/* Copying access */
+uint32_t pcm_ring_write(pcm_ring_t* ring, const int16_t* frames, uint32_t count);
+uint32_t pcm_ring_read(pcm_ring_t* ring, int16_t* frames, uint32_t count);
+
+/* Zero-copy producer access: get contiguous free region, then commit */
+int16_t* pcm_ring_write_ptr(pcm_ring_t* ring, uint32_t* contiguous);
+void pcm_ring_commit(pcm_ring_t* ring, uint32_t count);
+
+#endif /* __PCM_RING_H */
@@ -6,19 +6,178 @@
  * Audio System: WM8994 codec via I2S3 interface
  * Sample Rate: 44100 Hz (configurable to 48kHz, 96kHz)
  * Resolution: 16-bit stereo
+ *
+ * Streaming pipeline:
+ *   SD card -> decoder [-> SRC] (main loop, player_process) -> PCM ring
+ *   PCM ring -> DMA block (I2S DMA half/complete interrupt) -> codec
+ * Files at rates the codec cannot clock are resampled to 44.1kHz on the
+ * decode side, and off normal speed (player_set_speed) the time stretch
+ * follows; every other path is bit-exact from file to DAC unless the
+ * loudness compensation (player_set_loudness, below full volume), the
+ * headphone crossfeed (player_set_crossfeed, headphone jack only), the
+ * correction filter (player_load_fir) or the compressor (player_set_drc)
+ * is on. Those run on the decoded frames before they are queued, in q31,
+ * followed by the look-ahead limiter and the dithered requantization to
+ * s16. The loudness shelves and the compressor can instead run on the
+ * codec's own DSP (player_set_codec_dsp), which leaves the MCU path
+ * bit-exact and idle for them. The filter and the limiter delay the
+ * stream by one partition and the look-ahead; at the end of a track that
+ * tail is flushed with silence.
+ * The ring absorbs SD card and display latency, the DMA blocks are kept
+ * small so the output path reacts quickly.
+ *
+ * Seeking stops the output, drops the queued audio, repositions the
+ * decoder and restarts the DMA on freshly decoded frames, so the new
+ * position is audible after one decode pass regardless of file size.
+ *
+ * Transport changes never cut the waveform: pause, stop, seek and track
+ * changes ramp the output down over AUDIO_FADE_MS as the next DMA block is
+ * filled, and the interrupt halts the DMA on the block boundary after the
+ * ramp has played. Resume and seek ramp back up the same way. Only the
+ * frames under the ramp leave the ring, so a resume continues where the
+ * fade-out started.
+ *
+ * UI sounds (player_play_sfx) are mixed on top of the music as the blocks
+ * are filled. A new one is also mixed straight into the frames the DMA has
+ * not sent yet, so it starts within a millisecond instead of after the
+ * queued block.
  */
 
 #include "player.h"
 #include "codec.h"
-#include "i2s.h"
+#include "decoder.h"
+#include "pcm_ring.h"
+#include "resample.h"
+#include "wsola.h"
+#include "loudcomp.h"
+#include "crossfeed.h"
+#include "convolver.h"
+#include "limiter.h"
+#include "fir_file.h"
+#include "sfx.h"
+#include "dsp.h"
+#include "system.h"
 #include <string.h>
 #include <stdio.h>
 
-/* Audio buffer for playback */
-#define AUDIO_BUFFER_SIZE 44100  // 1 second at 44.1kHz (192KB RAM available on F407)
-static int16_t audio_buffer[AUDIO_BUFFER_SIZE];
-static uint32_t audio_buffer_pos = 0;
-static uint32_t audio_buffer_len = 0;
+/* Audio buffers
+ * RAM: whatever a decoder reads into goes through FatFs, which may DMA
+ * straight into it, so the ring, the SRC and stretch inputs and the DMA
+ * buffer stay in main SRAM with the decoder and the convolver's delay line
+ * (73KB). The DSP state only the CPU touches (filter spectra, resampler,
+ * WSOLA, loudness, crossfeed, limiter, DSP block: 63KB) sits in CCM, checked
+ * against SYSTEM_CCM_SIZE below; `make sim` checks both regions over all
+ * objects. */
+#define AUDIO_BLOCK_FRAMES 512     // One DMA half: 11.6 ms at 44.1kHz
+#define AUDIO_RING_FRAMES 4096     // Decoded queue: 93 ms at 44.1kHz (16KB)
+#define AUDIO_DECODE_CHUNK 1024    // Max frames per decoder call
+#define AUDIO_DECODE_CALLS 4       // Max decoder calls per player_process()
+#define AUDIO_FADE_MS 8            // Transport ramps (at most one DMA block)
+#define AUDIO_FADE_TIMEOUT_MS 100  // Stop waiting for the interrupt to halt the DMA
+#define AUDIO_SFX_GUARD_FRAMES 32  // UI sounds start this far past the DMA read position
+
+/* 8-byte aligned: the I2S DMA reads it in 4-sample bursts */
+static int16_t audio_dma_buffer[2 * AUDIO_BLOCK_FRAMES * 2] __attribute__((aligned(8)));
+static int16_t audio_ring_buffer[AUDIO_RING_FRAMES * 2];
+static pcm_ring_t audio_ring;
+static decoder_t audio_decoder;
+
+/* Decode-side sample rate conversion (only for rates the codec lacks) */
+#define AUDIO_SRC_OUTPUT_RATE 44100
+static resample_t audio_resampler SYSTEM_CCM;
+static int16_t audio_src_input[AUDIO_DECODE_CHUNK * 2];
+static uint32_t audio_src_pos = 0;           // Next unconsumed frame
+static uint32_t audio_src_count = 0;         // Frames held in audio_src_input
+static uint8_t audio_src_active = 0;
+
+/* Variable speed: time stretch after the SRC (only off 100 %) */
+#define AUDIO_STRETCH_CHUNK 256
+static wsola_t audio_wsola SYSTEM_CCM;
+static int16_t audio_stretch_input[AUDIO_STRETCH_CHUNK * 2];
+static uint32_t audio_stretch_pos = 0;
+static uint32_t audio_stretch_count = 0;
+static uint8_t audio_stretch_active = 0;
+static uint32_t audio_speed = 100;           // Speed of the output since codec_play()
+
+/* Loudness, crossfeed, correction filter, compressor and limiter, run in
+ * q31 sub-blocks of the decoded chunk */
+#define AUDIO_DSP_FRAMES 256
+static loudcomp_t audio_loudcomp SYSTEM_CCM;
+static crossfeed_t audio_crossfeed SYSTEM_CCM;
+static convolver_t audio_convolver;          // Delay line: 41KB at CONVOLVER_MAX_TAPS
+static convolver_coef_t audio_fir_spectra[CONVOLVER_FILTER_COEFS] SYSTEM_CCM;
+static limiter_t audio_limiter SYSTEM_CCM;
+static int32_t audio_dsp_buffer[AUDIO_DSP_FRAMES * 2] SYSTEM_CCM;
+static uint32_t audio_dither_seed = 1;
+static uint32_t audio_dsp_tail = 0;          // Filter and limiter frames still to flush at EOF
+static uint8_t audio_fir_active = 0;         // Filter loaded for the output rate
+
+_Static_assert(sizeof(audio_resampler) + sizeof(audio_wsola) + sizeof(audio_loudcomp) +
+               sizeof(audio_crossfeed) + sizeof(audio_fir_spectra) + sizeof(audio_limiter) +
+               sizeof(audio_dsp_buffer) <= SYSTEM_CCM_SIZE,
+               "audio DSP state exceeds the CCM");
+
+/* Ceiling below full scale leaves room for the DAC's reconstruction
+ * overshoot; the compressor lifts quiet passages by up to 10 dB */
+static const limiter_config_t audio_limiter_config = {
+    .ceiling_db = -1.0f,
+    .lookahead_ms = 2.0f,
+    .release_ms = 80.0f,
+    .drc_threshold_db = -30.0f,
+    .drc_ratio = 3.0f,
+    .drc_makeup_db = 10.0f,
+    .drc_attack_ms = 10.0f,
+    .drc_release_ms = 300.0f
+};
+
+/* The compressor on the codec's DRC: the same curve, rounded to its steps */
+static const codec_drc_t audio_codec_drc_config = {
+    .knee_in_db = -30.0f,
+    .knee_out_db = -20.0f,
+    .ratio = 3.0f,
+    .attack_ms = 10.0f,
+    .decay_ms = 300.0f
+};
+
+/* What the codec's DSP was last programmed with, reprogrammed on change */
+#define AUDIO_CODEC_OFF 0xFF
+#define AUDIO_CODEC_UNKNOWN 0xFE                // Not programmed at this rate yet
+static uint8_t audio_codec_loudness = AUDIO_CODEC_UNKNOWN;  // Volume of the EQ shelves
+static uint8_t audio_codec_drc = AUDIO_CODEC_UNKNOWN;
+static uint32_t audio_codec_rate = 0;
+
+/* Transport ramps, run by the DMA interrupt as it fills a block */
+#define AUDIO_FADE_UNITY 32768                   // Q15 gain of 1.0
+typedef enum {
+    AUDIO_FADE_NONE = 0,                         // Unity gain
+    AUDIO_FADE_IN,                               // Ramp up, then NONE
+    AUDIO_FADE_OUT                               // Ramp down, silence, halt the DMA
+} audio_fade_t;
+static volatile uint8_t audio_fade = AUDIO_FADE_NONE;
+static int32_t audio_fade_gain = AUDIO_FADE_UNITY;
+static int32_t audio_fade_step = AUDIO_FADE_UNITY / 256;  // Per frame, follows the output rate
+static uint8_t audio_fade_quiet = 0;          // Silent blocks filled after the ramp
+static uint8_t audio_dma_half = 1;            // Half filled last
+static uint32_t audio_block_pad[2];           // Ramp padding (frames of silence) in each half
+static uint32_t audio_pad_frames = 0;         // Padding played since codec_play()
+
+/* UI sounds, mixed by the DMA interrupt */
+static sfx_mixer_t audio_sfx;
+
+/* Per-stage profiling (system_get_cycles units) */
+static player_stage_stats_t stage_stats[PLAYER_STAGE_COUNT];
+static const char* const stage_names[PLAYER_STAGE_COUNT] = {
+    "decode", "src", "stretch", "dsp", "fir", "output", "seek"
+};
+
+/* Stream state shared with the DMA interrupt */
+static volatile uint8_t decoder_eof = 0;
+static volatile uint8_t drain_blocks = 0;     // Empty blocks sent after EOF
+static volatile uint32_t underrun_count = 0;
+
+/* Track position of the first frame sent since codec_play() */
+static uint32_t audio_position_base_ms = 0;
+static uint8_t audio_restart_pending = 0;     // Seeked, output not restarted yet
 
 /* Player state */
 static player_t player_state = {
@@ -27,9 +186,422 @@ static player_t player_state = {
     .current_track = 0,
     .volume = 70,  // 0-100
     .shuffle_enabled = 0,
-    .loop_mode = LOOP_OFF
+    .loop_mode = LOOP_OFF,
+    .crossfeed = CROSSFEED_OFF,
+    .drc_enabled = 0,
+    .loudness = 0,
+    .codec_dsp = 0,
+    .speed = 100,
+    .fir_taps = 0
 };
 
+/**
+ * Account one call of a pipeline stage
+ */
+static void audio_stage_record(player_stage_t stage, uint32_t start, uint32_t frames) {
+    uint32_t cycles = system_get_cycles() - start;
+    player_stage_stats_t* st = &stage_stats[stage];
+    
+    st->calls++;
+    st->frames += frames;
+    st->cycles += cycles;
+    if (cycles > st->max_cycles) st->max_cycles = cycles;
+}
+
+/**
+ * Step the transport gain once per frame over frames, scaling both channels
+ */
+static void audio_fade_apply(int16_t* pcm, uint32_t frames, int32_t step) {
+    int32_t gain = audio_fade_gain;
+    
+    for (uint32_t i = 0; i < frames; i++) {
+        gain += step;
+        if (gain < 0) gain = 0;
+        if (gain > AUDIO_FADE_UNITY) gain = AUDIO_FADE_UNITY;
+        pcm[2 * i] = (int16_t)((pcm[2 * i] * gain) >> 15);
+        pcm[2 * i + 1] = (int16_t)((pcm[2 * i + 1] * gain) >> 15);
+    }
+    audio_fade_gain = gain;
+}
+
+/**
+ * Fill one DMA half from the PCM ring, applying the transport ramp
+ * While fading out only the frames under the ramp are taken; once the
+ * ramp has played and the other half is silent the DMA is halted here,
+ * on the block boundary.
+ */
+static void audio_fill_block(uint8_t half) {
+    uint32_t start = system_get_cycles();
+    int16_t* block = &audio_dma_buffer[half * AUDIO_BLOCK_FRAMES * 2];
+    uint32_t take = AUDIO_BLOCK_FRAMES;
+    uint32_t ramp = 0;
+    
+    audio_dma_half = half;
+    if (audio_fade == AUDIO_FADE_OUT) {
+        ramp = (uint32_t)((audio_fade_gain + audio_fade_step - 1) / audio_fade_step);
+        take = ramp;
+    } else if (audio_fade == AUDIO_FADE_IN) {
+        ramp = (uint32_t)((AUDIO_FADE_UNITY - audio_fade_gain + audio_fade_step - 1) / audio_fade_step);
+    }
+    
+    uint32_t n = pcm_ring_read(&audio_ring, block, take);
+    if (n < AUDIO_BLOCK_FRAMES) {
+        memset(&block[n * 2], 0, (AUDIO_BLOCK_FRAMES - n) * 2 * sizeof(int16_t));
+    }
+    
+    if (audio_fade == AUDIO_FADE_OUT) {
+        audio_fade_apply(block, n, -audio_fade_step);
+        audio_fade_gain = 0;
+        audio_block_pad[half] = AUDIO_BLOCK_FRAMES - n;
+    } else {
+        audio_block_pad[half] = 0;
+        if (audio_fade == AUDIO_FADE_IN) {
+            audio_fade_apply(block, (n < ramp) ? n : ramp, audio_fade_step);
+            if (audio_fade_gain == AUDIO_FADE_UNITY) audio_fade = AUDIO_FADE_NONE;
+        }
+        if (n < AUDIO_BLOCK_FRAMES) {
+            if (decoder_eof) {
+                if (n == 0 && drain_blocks < 2) drain_blocks++;
+            } else {
+                underrun_count++;
+            }
+        }
+    }
+    
+    /* UI sounds on top, also over the fade; the halt waits for them */
+    uint32_t voices = sfx_mix(&audio_sfx, block, AUDIO_BLOCK_FRAMES);
+    if (audio_fade == AUDIO_FADE_OUT) {
+        audio_fade_quiet = (ramp == 0 && voices == 0) ? audio_fade_quiet + 1 : 0;
+        if (audio_fade_quiet == 2) {
+            codec_pause();
+        }
+    }
+    
+    audio_stage_record(PLAYER_STAGE_OUTPUT, start, AUDIO_BLOCK_FRAMES);
+}
+
+/**
+ * Start the fade-out; the interrupt halts the DMA when it has played
+ */
+static void audio_fade_out(void) {
+    if (audio_fade != AUDIO_FADE_OUT) {
+        audio_fade_quiet = 0;
+        audio_fade = AUDIO_FADE_OUT;
+    }
+}
+
+/**
+ * Refill the DMA half that has just played (I2S DMA interrupt context)
+ */
+static void audio_stream_callback(uint8_t half) {
+    /* Ramp padding is output time, not track time */
+    audio_pad_frames += audio_block_pad[half];
+    audio_fill_block(half);
+}
+
+/**
+ * Decode up to max_frames into dst
+ */
+static uint32_t audio_decode(int16_t* dst, uint32_t max_frames) {
+    uint32_t start = system_get_cycles();
+    uint32_t n = decoder_read(&audio_decoder, dst, max_frames);
+    audio_stage_record(PLAYER_STAGE_DECODE, start, n);
+    return n;
+}
+
+/**
+ * Decode and resample into dst; returns frames produced (0 at end of file)
+ * Decoded frames the converter could not take yet stay in audio_src_input.
+ */
+static uint32_t audio_decode_resampled(int16_t* dst, uint32_t max_frames) {
+    uint32_t produced = 0;
+    
+    while (produced < max_frames) {
+        if (audio_src_pos >= audio_src_count) {
+            audio_src_count = audio_decode(audio_src_input, AUDIO_DECODE_CHUNK);
+            audio_src_pos = 0;
+            if (audio_src_count == 0) {
+                /* End of file: drain the converter */
+                uint32_t start = system_get_cycles();
+                uint32_t n = resample_flush(&audio_resampler, &dst[produced * 2],
+                                            max_frames - produced);
+                audio_stage_record(PLAYER_STAGE_SRC, start, n);
+                produced += n;
+                break;
+            }
+        }
+        
+        uint32_t start = system_get_cycles();
+        uint32_t consumed = 0;
+        uint32_t n = resample_process(&audio_resampler,
+                                      &audio_src_input[audio_src_pos * 2],
+                                      audio_src_count - audio_src_pos, &consumed,
+                                      &dst[produced * 2], max_frames - produced);
+        audio_stage_record(PLAYER_STAGE_SRC, start, n);
+        
+        audio_src_pos += consumed;
+        produced += n;
+    }
+    
+    return produced;
+}
+
+/**
+ * Decoded (and resampled) frames at the output rate, in track time
+ */
+static uint32_t audio_decode_source(int16_t* dst, uint32_t max_frames) {
+    return audio_src_active ? audio_decode_resampled(dst, max_frames) :
+                              audio_decode(dst, max_frames);
+}
+
+/**
+ * Decode and time-stretch into dst; returns frames produced (0 at end of
+ * file). Source frames the stretch could not take yet stay in
+ * audio_stretch_input.
+ */
+static uint32_t audio_decode_stretched(int16_t* dst, uint32_t max_frames) {
+    uint32_t produced = 0;
+    
+    while (produced < max_frames) {
+        if (audio_stretch_pos >= audio_stretch_count) {
+            audio_stretch_count = audio_decode_source(audio_stretch_input, AUDIO_STRETCH_CHUNK);
+            audio_stretch_pos = 0;
+            if (audio_stretch_count == 0) {
+                /* End of file: drain the stretch */
+                uint32_t start = system_get_cycles();
+                uint32_t n = wsola_flush(&audio_wsola, &dst[produced * 2], max_frames - produced);
+                audio_stage_record(PLAYER_STAGE_STRETCH, start, n);
+                produced += n;
+                break;
+            }
+        }
+        
+        uint32_t start = system_get_cycles();
+        uint32_t consumed = 0;
+        uint32_t n = wsola_process(&audio_wsola,
+                                   &audio_stretch_input[audio_stretch_pos * 2],
+                                   audio_stretch_count - audio_stretch_pos, &consumed,
+                                   &dst[produced * 2], max_frames - produced);
+        audio_stage_record(PLAYER_STAGE_STRETCH, start, n);
+        
+        audio_stretch_pos += consumed;
+        produced += n;
+    }
+    
+    return produced;
+}
+
+/**
+ * Set the time stretch up for the selected speed at the output rate
+ * (new track, seek, speed change); 100 % bypasses it. Output above
+ * WSOLA_MAX_RATE drops the speed back to 100 %, so the status line and
+ * the resume journal show what plays.
+ */
+static void audio_stretch_setup(void) {
+    audio_stretch_active = player_state.speed != 100 &&
+                           wsola_init(&audio_wsola, (uint32_t)codec_get_sample_rate(),
+                                      player_state.speed) == WSOLA_OK;
+    audio_speed = audio_stretch_active ? player_state.speed : 100;
+    player_state.speed = (uint16_t)audio_speed;
+    audio_stretch_pos = 0;
+    audio_stretch_count = 0;
+}
+
+/**
+ * Program the codec's EQ with the loudness shelves for volume
+ * (AUDIO_CODEC_OFF: off) and switch its DRC, when either changed
+ */
+static void audio_codec_dsp_update(uint8_t loudness_volume, uint8_t drc, uint32_t rate) {
+    if (rate != audio_codec_rate) {
+        audio_codec_loudness = AUDIO_CODEC_UNKNOWN;
+        audio_codec_drc = AUDIO_CODEC_UNKNOWN;
+        audio_codec_rate = rate;
+    }
+    
+    if (loudness_volume != audio_codec_loudness) {
+        if (loudness_volume == AUDIO_CODEC_OFF) {
+            codec_set_eq(NULL);
+        } else {
+            codec_eq_t eq = {{0}};
+            float low_db, high_db;
+            loudcomp_shelf_gains(&audio_loudcomp, loudness_volume, &low_db, &high_db);
+            eq.gain_db[0] = (int8_t)(low_db + 0.5f);
+            eq.gain_db[CODEC_EQ_BANDS - 1] = (int8_t)(high_db + 0.5f);
+            codec_set_eq(&eq);
+        }
+        audio_codec_loudness = loudness_volume;
+    }
+    
+    if (drc != audio_codec_drc) {
+        codec_set_drc(drc ? &audio_codec_drc_config : NULL);
+        audio_codec_drc = drc;
+    }
+}
+
+/**
+ * Follow the DSP settings, the output rate and the destination
+ * Crossfeed only makes sense on headphones; the filters are redesigned
+ * only when one of the three changes.
+ */
+static void audio_dsp_update(void) {
+    crossfeed_preset_t preset = (codec_get_output_destination() == CODEC_OUTPUT_LINE) ?
+                                player_state.crossfeed : CROSSFEED_OFF;
+    uint32_t rate = (uint32_t)codec_get_sample_rate();
+    uint8_t on_codec = codec_dsp_available() ? player_state.codec_dsp : 0;
+    uint8_t volume = player_state.loudness ? player_state.volume : 100;
+    
+    if (preset != audio_crossfeed.preset || rate != audio_crossfeed.sample_rate) {
+        crossfeed_init(&audio_crossfeed, preset, rate);
+    }
+    if (rate != audio_limiter.sample_rate) {
+        limiter_init(&audio_limiter, &audio_limiter_config, rate);
+        audio_dsp_tail = 0;
+    }
+    limiter_set_drc(&audio_limiter, player_state.drc_enabled && !(on_codec & PLAYER_CODEC_DRC));
+    
+    /* Loudness: a table entry per volume step, faded in by loudcomp_q31 */
+    if (rate != audio_loudcomp.sample_rate) {
+        loudcomp_init(&audio_loudcomp, rate);
+    }
+    loudcomp_set_volume(&audio_loudcomp, (on_codec & PLAYER_CODEC_LOUDNESS) ? 100 : volume);
+    
+    /* Handed to the codec (44.1/48kHz only, otherwise the MCU keeps them) */
+    audio_codec_dsp_update((on_codec & PLAYER_CODEC_LOUDNESS) && player_state.loudness ?
+                           volume : AUDIO_CODEC_OFF,
+                           player_state.drc_enabled && (on_codec & PLAYER_CODEC_DRC), rate);
+    
+    /* A filter measured at one rate is wrong at any other */
+    audio_fir_active = audio_convolver.ready &&
+                       (audio_convolver.sample_rate == 0 || audio_convolver.sample_rate == rate);
+}
+
+static uint8_t audio_dsp_active(void) {
+    return audio_crossfeed.preset != CROSSFEED_OFF || audio_limiter.drc_enabled ||
+           !loudcomp_is_flat(&audio_loudcomp) || audio_fir_active;
+}
+
+static uint32_t audio_dsp_latency(void) {
+    return limiter_latency(&audio_limiter) +
+           (audio_fir_active ? convolver_latency(&audio_convolver) : 0);
+}
+
+/**
+ * Loudness-compensate, crossfeed, filter, compress and limit decoded s16
+ * frames in place (q31 in between, TPDF dither back)
+ */
+static void audio_process(int16_t* pcm, uint32_t frames) {
+    uint32_t start = system_get_cycles();
+    
+    for (uint32_t done = 0; done < frames; ) {
+        uint32_t n = frames - done;
+        if (n > AUDIO_DSP_FRAMES) n = AUDIO_DSP_FRAMES;
+        
+        dsp_s16_to_q31(&pcm[done * 2], audio_dsp_buffer, n * 2);
+        loudcomp_q31(&audio_loudcomp, audio_dsp_buffer, n);
+        crossfeed_q31(&audio_crossfeed, audio_dsp_buffer, n);
+        if (audio_fir_active) {
+            uint32_t fir_start = system_get_cycles();
+            convolver_q31(&audio_convolver, audio_dsp_buffer, n);
+            audio_stage_record(PLAYER_STAGE_FIR, fir_start, n);
+        }
+        limiter_q31(&audio_limiter, audio_dsp_buffer, n);
+        dsp_dither_q31_to_s16(audio_dsp_buffer, &pcm[done * 2], n * 2, &audio_dither_seed);
+        done += n;
+    }
+    
+    audio_stage_record(PLAYER_STAGE_DSP, start, frames);
+}
+
+/**
+ * Push silence through the DSP chain to play out what the filter and the
+ * limiter's look-ahead still hold; returns the frames written (0 once empty)
+ */
+static uint32_t audio_flush_dsp(int16_t* dst, uint32_t max_frames) {
+    uint32_t n = (audio_dsp_tail < max_frames) ? audio_dsp_tail : max_frames;
+    
+    if (n > 0) {
+        memset(dst, 0, n * 2 * sizeof(int16_t));
+        audio_process(dst, n);
+        audio_dsp_tail -= n;
+    }
+    return n;
+}
+
+/**
+ * Clear the DSP state at a discontinuity (new track, seek)
+ */
+static void audio_dsp_reset(void) {
+    loudcomp_reset(&audio_loudcomp);
+    crossfeed_reset(&audio_crossfeed);
+    convolver_reset(&audio_convolver);
+    limiter_reset(&audio_limiter);
+    audio_dsp_tail = 0;
+}
+
+/**
+ * Decode ahead into the PCM ring
+ */
+static void audio_fill_ring(void) {
+    audio_dsp_update();
+    
+    for (int i = 0; i < AUDIO_DECODE_CALLS && !decoder_eof; i++) {
+        uint32_t contiguous;
+        int16_t* dst = pcm_ring_write_ptr(&audio_ring, &contiguous);
+        
+        if (contiguous == 0) break;  /* Ring full */
+        if (contiguous > AUDIO_DECODE_CHUNK) contiguous = AUDIO_DECODE_CHUNK;
+        
+        uint32_t n = audio_stretch_active ? audio_decode_stretched(dst, contiguous) :
+                                            audio_decode_source(dst, contiguous);
+        if (n > 0 && audio_dsp_active()) {
+            /* Nothing in the look-ahead yet: start from a clean filter and limiter */
+            if (audio_dsp_tail == 0) {
+                convolver_reset(&audio_convolver);
+                limiter_reset(&audio_limiter);
+            }
+            audio_process(dst, n);
+            audio_dsp_tail = audio_dsp_latency();
+        } else if (n > 0) {
+            audio_dsp_tail = 0;  /* Bypassed: the look-ahead tail is dropped */
+        } else if ((n = audio_flush_dsp(dst, contiguous)) == 0) {
+            decoder_eof = 1;
+            break;
+        }
+        pcm_ring_commit(&audio_ring, n);
+    }
+}
+
+/**
+ * Prime both DMA halves from the ring and start the circular transfer
+ * fade_in ramps the first frames up (after a seek); a track starts at
+ * unity so that the output stays bit-exact.
+ */
+static int audio_start_output(uint8_t fade_in) {
+    audio_fill_ring();
+    audio_fade = fade_in ? AUDIO_FADE_IN : AUDIO_FADE_NONE;
+    audio_fade_gain = fade_in ? 0 : AUDIO_FADE_UNITY;
+    audio_pad_frames = 0;
+    audio_fill_block(0);
+    audio_fill_block(1);
+    
+    return codec_play(audio_dma_buffer, sizeof(audio_dma_buffer) / sizeof(int16_t)) == CODEC_OK ?
+           PLAYER_OK : PLAYER_ERROR;
+}
+
+/**
+ * Ramp the output down, wait for the interrupt to halt the DMA, stop it
+ * A track that has played out is silent already and stops at once.
+ */
+static void audio_stop_output(void) {
+    if (codec_is_playing() && drain_blocks < 2) {
+        audio_fade_out();
+        for (uint32_t waited = 0; codec_is_playing() && waited < AUDIO_FADE_TIMEOUT_MS; waited++) {
+            system_delay_ms(1);
+        }
+    }
+    codec_stop();
+}
+
 /**
  * Initialize audio player
  * 
@@ -41,27 +613,80 @@ int player_init(void) {
         return PLAYER_ERROR;
     }
     
+    /* CCM is not cleared at startup; the stages set up lazily from zero */
+    memset(&audio_resampler, 0, sizeof(audio_resampler));
+    memset(&audio_wsola, 0, sizeof(audio_wsola));
+    memset(&audio_loudcomp, 0, sizeof(audio_loudcomp));
+    memset(&audio_crossfeed, 0, sizeof(audio_crossfeed));
+    memset(&audio_limiter, 0, sizeof(audio_limiter));
+    
+    pcm_ring_init(&audio_ring, audio_ring_buffer, AUDIO_RING_FRAMES);
+    convolver_init(&audio_convolver, audio_fir_spectra);
+    sfx_init(&audio_sfx, (uint32_t)codec_get_sample_rate());
+    codec_set_stream_callback(audio_stream_callback);
+    
     return PLAYER_OK;
 }
 
 /**
- * Load audio file (WAV or MP3)
- * Returns PLAYER_OK on success
+ * Load audio file
+ * The format is detected from the file header; returns PLAYER_OK on success
  */
 int player_load_file(const char* filename) {
     if (filename == NULL) {
         return PLAYER_ERROR;
     }
     
-    // Check file extension
-    const char* ext = filename + strlen(filename) - 3;
-    if (strcmp(ext, "wav") != 0 && strcmp(ext, "mp3") != 0) {
-        return PLAYER_ERROR_UNSUPPORTED;
+    if (player_state.is_playing) {
+        player_stop();
+    }
+    decoder_close(&audio_decoder);
+    
+    switch (decoder_open(&audio_decoder, filename)) {
+        case DECODER_OK:
+            break;
+        case DECODER_ERROR_NO_FILE:
+            return PLAYER_ERROR_NO_FILE;
+        case DECODER_ERROR_UNSUPPORTED:
+            return PLAYER_ERROR_UNSUPPORTED;
+        default:
+            return PLAYER_ERROR;
     }
     
+    // Output runs at the file's native rate, or 44.1kHz through the SRC
+    audio_src_active = 0;
+    if (codec_set_sample_rate((codec_sample_rate_t)audio_decoder.sample_rate) != CODEC_OK) {
+        if (resample_init(&audio_resampler, audio_decoder.sample_rate,
+                          AUDIO_SRC_OUTPUT_RATE) != RESAMPLE_OK ||
+            codec_set_sample_rate((codec_sample_rate_t)AUDIO_SRC_OUTPUT_RATE) != CODEC_OK) {
+            decoder_close(&audio_decoder);
+            return PLAYER_ERROR_UNSUPPORTED;
+        }
+        audio_src_active = 1;
+    }
+    
+    uint32_t fade_frames = (uint32_t)codec_get_sample_rate() * AUDIO_FADE_MS / 1000;
+    if (fade_frames > AUDIO_BLOCK_FRAMES) fade_frames = AUDIO_BLOCK_FRAMES;
+    audio_fade_step = (AUDIO_FADE_UNITY + fade_frames - 1) / fade_frames;
+    sfx_set_rate(&audio_sfx, (uint32_t)codec_get_sample_rate());
+    
+    audio_src_pos = 0;
+    audio_src_count = 0;
+    audio_stretch_setup();
+    audio_dsp_reset();
+    
     // Store filename
-    strncpy(player_state.current_file, filename, MAX_FILENAME_LEN - 1);
-    player_state.current_file[MAX_FILENAME_LEN - 1] = '\0';
+    if (filename != player_state.current_file) {
+        strncpy(player_state.current_file, filename, MAX_FILENAME_LEN - 1);
+        player_state.current_file[MAX_FILENAME_LEN - 1] = '\0';
+    }
+    player_state.duration_sec = decoder_duration_sec(&audio_decoder);
+    
+    pcm_ring_reset(&audio_ring);
+    decoder_eof = 0;
+    drain_blocks = 0;
+    audio_position_base_ms = 0;
+    audio_restart_pending = 0;
     
     return PLAYER_OK;
 }
@@ -69,20 +694,24 @@ int player_load_file(const char* filename) {
 /**
  * Start playback
  * 
- * Note: For F407 with 192KB RAM, audio buffer is larger (1 second vs 500ms on F401)
- * Audio is streamed from SD card via SDIO and played through codec
+ * Decodes ahead to fill the PCM ring, primes both DMA halves and starts
+ * the circular I2S transfer. A stopped or finished track is reopened.
  */
 int player_play(void) {
-    if (audio_buffer_len == 0) {
-        return PLAYER_ERROR_NO_FILE;
+    if (audio_decoder.ops == NULL) {
+        if (player_state.current_file[0] == '\0' ||
+            player_load_file(player_state.current_file) != PLAYER_OK) {
+            return PLAYER_ERROR_NO_FILE;
+        }
     }
     
     player_state.is_playing = 1;
     player_state.is_paused = 0;
-    audio_buffer_pos = 0;
+    audio_restart_pending = 0;
     
     // Start codec audio playback via I2S3 DMA
-    if (codec_play(audio_buffer, audio_buffer_len) != CODEC_OK) {
+    if (audio_start_output(0) != PLAYER_OK) {
+        player_state.is_playing = 0;
         return PLAYER_ERROR;
     }
     
@@ -91,6 +720,7 @@ int player_play(void) {
 
 /**
  * Pause playback
+ * Returns at once; the DMA interrupt ramps the output down and halts it.
  */
 int player_pause(void) {
     if (!player_state.is_playing) {
@@ -98,7 +728,9 @@ int player_pause(void) {
     }
     
     player_state.is_paused = 1;
-    codec_pause();
+    if (!audio_restart_pending) {
+        audio_fade_out();
+    }
     
     return PLAYER_OK;
 }
@@ -112,19 +744,38 @@ int player_resume(void) {
     }
     
     player_state.is_paused = 0;
-    codec_resume();
+    
+    // A seek while paused dropped the output; start it on the new position
+    if (audio_restart_pending) {
+        audio_restart_pending = 0;
+        return audio_start_output(1);
+    }
+    
+    // Ramp up from wherever the fade-out got to. Once halted, both halves
+    // are refilled so the ramp is the next thing played.
+    audio_fade = AUDIO_FADE_IN;
+    if (!codec_is_playing()) {
+        uint8_t next = audio_dma_half ^ 1;
+        audio_fill_block(next);
+        audio_fill_block(next ^ 1);
+        codec_resume();
+    }
     
     return PLAYER_OK;
 }
 
 /**
  * Stop playback
+ * Closes the decoder; the next player_play() restarts the track
  */
 int player_stop(void) {
     player_state.is_playing = 0;
     player_state.is_paused = 0;
-    codec_stop();
-    audio_buffer_pos = 0;
+    audio_restart_pending = 0;
+    audio_stop_output();
+    sfx_stop_all(&audio_sfx);
+    decoder_close(&audio_decoder);
+    pcm_ring_reset(&audio_ring);
     
     return PLAYER_OK;
 }
@@ -143,6 +794,197 @@ int player_set_volume(uint8_t volume) {
     return PLAYER_OK;
 }
 
+/**
+ * Select the headphone crossfeed strength (CROSSFEED_OFF to bypass)
+ * Applies from the next decoded block while the output is the headphone
+ * jack (codec_set_output_destination); the speaker always gets plain stereo.
+ */
+int player_set_crossfeed(crossfeed_preset_t preset) {
+    if (preset >= CROSSFEED_PRESET_COUNT) {
+        return PLAYER_ERROR;
+    }
+    
+    player_state.crossfeed = preset;
+    return PLAYER_OK;
+}
+
+/**
+ * Switch loudness compensation on or off
+ * Below full volume, bass and treble are lifted along the equal-loudness
+ * contours for the volume setting; changes fade in over one DSP block.
+ */
+int player_set_loudness(uint8_t enabled) {
+    player_state.loudness = enabled ? 1 : 0;
+    return PLAYER_OK;
+}
+
+/**
+ * Switch the dynamic range compressor on or off
+ * Quiet passages come up by its make-up gain, loud ones are held down;
+ * applies from the next decoded block on every output.
+ */
+int player_set_drc(uint8_t enabled) {
+    player_state.drc_enabled = enabled ? 1 : 0;
+    return PLAYER_OK;
+}
+
+/**
+ * Choose per feature (PLAYER_CODEC_*) whether it runs on the codec's DSP
+ * or on the MCU
+ * The codec takes over from the next decoded block at 44.1kHz and 48kHz;
+ * at 96kHz the MCU keeps every feature. Its EQ has fixed bands and 1 dB
+ * steps up to +12 dB and its DRC a coarser curve, in exchange for no MCU
+ * cycles spent on them.
+ */
+int player_set_codec_dsp(uint8_t features) {
+    if (features & ~(PLAYER_CODEC_LOUDNESS | PLAYER_CODEC_DRC)) {
+        return PLAYER_ERROR;
+    }
+    
+    player_state.codec_dsp = features;
+    return PLAYER_OK;
+}
+
+/**
+ * Set the playback speed in percent (75-200), pitch unchanged
+ * A playing or paused track restarts at its current position at the new
+ * speed (player_seek), so the queued audio does not lag the change.
+ * PLAYER_ERROR_UNSUPPORTED while the output runs above WSOLA_MAX_RATE
+ * (88.2/96kHz), which plays at 100 % only.
+ */
+int player_set_speed(uint16_t percent) {
+    if (percent < WSOLA_SPEED_MIN || percent > WSOLA_SPEED_MAX) {
+        return PLAYER_ERROR;
+    }
+    if (percent == player_state.speed) {
+        return PLAYER_OK;
+    }
+    if (audio_decoder.ops != NULL && percent != 100 &&
+        (uint32_t)codec_get_sample_rate() > WSOLA_MAX_RATE) {
+        return PLAYER_ERROR_UNSUPPORTED;
+    }
+    
+    uint32_t position = player_get_position_ms();
+    player_state.speed = percent;
+    if (player_state.is_playing) {
+        return player_seek(position);
+    }
+    if (audio_decoder.ops != NULL) {
+        audio_stretch_setup();
+    }
+    return PLAYER_OK;
+}
+
+/**
+ * Load a correction filter (headphone or room FIR, see fir_file.h), or
+ * remove it with NULL
+ * A WAV filter applies while the output runs at its sample rate, a raw one
+ * at any rate. The taps stream through a small buffer straight into the
+ * convolver's partition spectra. A playing track restarts at its current
+ * position (player_seek) so the filter's delay does not tear the stream.
+ */
+int player_load_fir(const char* path) {
+    static float taps[FIR_FILE_CHUNK * 2];
+    fir_file_t fir;
+    int status = PLAYER_OK;
+    
+    audio_convolver.ready = 0;
+    player_state.fir_taps = 0;
+    
+    if (path != NULL) {
+        switch (fir_file_open(&fir, path)) {
+            case FIR_FILE_OK:
+                break;
+            case FIR_FILE_ERROR_NO_FILE:
+                return PLAYER_ERROR_NO_FILE;
+            case FIR_FILE_ERROR_UNSUPPORTED:
+                return PLAYER_ERROR_UNSUPPORTED;
+            default:
+                return PLAYER_ERROR;
+        }
+        
+        if (convolver_begin(&audio_convolver, fir.frames, fir.sample_rate) != CONVOLVER_OK) {
+            status = PLAYER_ERROR_UNSUPPORTED;
+        }
+        while (status == PLAYER_OK && fir.position < fir.frames) {
+            uint32_t n = fir_file_read(&fir, taps, FIR_FILE_CHUNK);
+            if (n == 0 || convolver_load(&audio_convolver, taps, n, fir.channels) != CONVOLVER_OK) {
+                status = PLAYER_ERROR;
+            }
+        }
+        fir_file_close(&fir);
+        
+        if (status == PLAYER_OK && convolver_end(&audio_convolver) != CONVOLVER_OK) {
+            status = PLAYER_ERROR;
+        }
+        if (status == PLAYER_OK) {
+            player_state.fir_taps = audio_convolver.taps;
+        }
+    }
+    
+    if (player_state.is_playing) {
+        int seek_status = player_seek(player_get_position_ms());
+        if (status == PLAYER_OK) status = seek_status;
+    }
+    return status;
+}
+
+/**
+ * Mix the head of a new voice straight into the DMA buffer, from
+ * AUDIO_SFX_GUARD_FRAMES past the read position to the end of the half
+ * queued next, and hand the rest to the interrupt. The interrupt is held
+ * off meanwhile so that no half is refilled under the patch.
+ */
+static void audio_sfx_inject(sfx_voice_t* voice) {
+    const uint32_t size = 2 * AUDIO_BLOCK_FRAMES;
+    
+    codec_hold_stream(1);
+    uint32_t read = codec_get_buffer_offset() / 2;
+    uint8_t playing = audio_dma_half ^ 1;
+    
+    /* Past the playing half the interrupt is pending: it takes the voice */
+    if (read / AUDIO_BLOCK_FRAMES == playing) {
+        uint32_t ahead = size - read + (playing ? AUDIO_BLOCK_FRAMES : 0);
+        uint32_t at = (read + AUDIO_SFX_GUARD_FRAMES) % size;
+        uint32_t left = (ahead > AUDIO_SFX_GUARD_FRAMES) ? ahead - AUDIO_SFX_GUARD_FRAMES : 0;
+        while (left > 0) {
+            uint32_t n = (size - at < left) ? size - at : left;
+            sfx_voice_mix(voice, &audio_dma_buffer[at * 2], n);
+            left -= n;
+            at = 0;
+        }
+    }
+    sfx_voice_start(voice);
+    codec_hold_stream(0);
+}
+
+/**
+ * Play a UI sound over the output
+ *
+ * Needs a track playing or paused: while paused the halted DMA is
+ * restarted on silence for the sound and halts again after it.
+ */
+int player_play_sfx(sfx_id_t sfx) {
+    if (sfx >= SFX_COUNT || !player_state.is_playing || audio_restart_pending) {
+        return PLAYER_ERROR;
+    }
+    
+    sfx_voice_t* voice = sfx_voice_claim(&audio_sfx, &sfx_clips[sfx]);
+    if (codec_is_playing()) {
+        audio_sfx_inject(voice);
+    } else {
+        /* Halted by a pause: the fade keeps the music at zero */
+        uint8_t next = audio_dma_half ^ 1;
+        sfx_voice_start(voice);
+        audio_fade_quiet = 0;
+        audio_fill_block(next);
+        audio_fill_block(next ^ 1);
+        codec_resume();
+    }
+    
+    return PLAYER_OK;
+}
+
 /**
  * Toggle shuffle mode
  */
@@ -180,17 +1022,129 @@ player_t* player_get_state(void) {
  * Get playback position in seconds
  */
 uint32_t player_get_position(void) {
-    uint32_t samples = codec_get_position();
-    return samples / CODEC_SAMPLE_RATE_44100;
+    return player_get_position_ms() / 1000;
 }
 
 /**
- * DMA Transmit Complete Callback
- * 
- * For F401RE, this would be called when streaming audio from SD card
- * TODO: Implement streaming from SD card in chunks
+ * Get playback position in milliseconds (track time at any speed)
+ */
+uint32_t player_get_position_ms(void) {
+    if (audio_restart_pending) {
+        return audio_position_base_ms;
+    }
+    uint64_t frames = codec_get_position() - audio_pad_frames;
+    return audio_position_base_ms +
+           (uint32_t)(frames * 10 * audio_speed / codec_get_sample_rate());
+}
+
+/**
+ * Seek to position_ms of the current track
+ *
+ * Playing: the output restarts at the new position straight away.
+ * Paused: the output restarts on player_resume(). Stopped: the track is
+ * opened and player_play() starts at the position. Positions past the end
+ * land on the end, which finishes the track.
  */
-void audio_stream_callback(void) {
-    // This callback would be used for streaming audio from SD card
-    // For now, playback is handled entirely in PWM interrupt
+int player_seek(uint32_t position_ms) {
+    uint32_t start = system_get_cycles();
+    
+    if (audio_decoder.ops == NULL) {
+        if (player_state.current_file[0] == '\0') {
+            return PLAYER_ERROR_NO_FILE;
+        }
+        int status = player_load_file(player_state.current_file);
+        if (status != PLAYER_OK) {
+            return status;
+        }
+    }
+    
+    uint32_t frame = (uint32_t)((uint64_t)position_ms * audio_decoder.sample_rate / 1000);
+    
+    int status = decoder_seek(&audio_decoder, frame);
+    if (status == DECODER_ERROR_UNSUPPORTED) {
+        return PLAYER_ERROR_UNSUPPORTED;  /* Nothing moved, keep playing */
+    }
+    
+    // The ring may only be reset while the DMA interrupt is not consuming
+    if (player_state.is_playing) {
+        audio_stop_output();
+    }
+    pcm_ring_reset(&audio_ring);
+    if (audio_src_active) {
+        resample_reset(&audio_resampler);
+    }
+    audio_stretch_setup();
+    audio_dsp_reset();
+    audio_src_pos = 0;
+    audio_src_count = 0;
+    decoder_eof = 0;
+    drain_blocks = 0;
+    
+    if (status != DECODER_OK) {
+        player_stop();
+        return PLAYER_ERROR;
+    }
+    audio_position_base_ms = (uint32_t)((uint64_t)audio_decoder.frame_pos * 1000 /
+                                        audio_decoder.sample_rate);
+    
+    status = PLAYER_OK;
+    if (player_state.is_playing && !player_state.is_paused) {
+        status = audio_start_output(1);
+        audio_stage_record(PLAYER_STAGE_SEEK, start, 0);
+    } else {
+        audio_restart_pending = 1;
+    }
+    
+    return status;
+}
+
+/**
+ * Get pipeline stage profile (indexed by player_stage_t)
+ */
+const player_stage_stats_t* player_get_stage_stats(void) {
+    return stage_stats;
+}
+
+const char* player_stage_name(player_stage_t stage) {
+    return (stage < PLAYER_STAGE_COUNT) ? stage_names[stage] : "unknown";
+}
+
+void player_reset_stage_stats(void) {
+    memset(stage_stats, 0, sizeof(stage_stats));
+}
+
+/**
+ * Output blocks that ran short while the decoder was still producing
+ */
+uint32_t player_get_underruns(void) {
+    return underrun_count;
+}
+
+/**
+ * Limiter and compressor meter; restarts the reduction peak hold
+ */
+void player_get_limiter_meter(limiter_meter_t* meter) {
+    if (audio_limiter.sample_rate == 0) {
+        memset(meter, 0, sizeof(*meter));  /* Nothing played yet */
+        return;
+    }
+    limiter_read_meter(&audio_limiter, meter);
+}
+
+/**
+ * Keep the PCM ring topped up and detect end of track
+ * Call from the main loop; bounded to AUDIO_DECODE_CALLS decoder calls
+ */
+void player_process(void) {
+    if (!player_state.is_playing || player_state.is_paused) {
+        return;
+    }
+    
+    /* Both DMA halves have played out the last decoded frames */
+    if (drain_blocks >= 2) {
+        player_stop();
+        return;
+    }
+    
+    audio_fill_ring();
 }
@@ -6,6 +6,9 @@
 #define __PLAYER_H
 
 #include <stdint.h>
+#include "crossfeed.h"
+#include "limiter.h"
+#include "sfx.h"
 
 #define MAX_FILENAME_LEN 256
 #define MAX_PLAYLIST_SIZE 100
@@ -23,6 +26,10 @@ typedef enum {
     LOOP_ONE = 2
 } loop_mode_t;
 
+/* Features that can run on the codec's DSP instead of the MCU */
+#define PLAYER_CODEC_LOUDNESS 0x01     // Loudness shelves on the ReTune Mobile EQ
+#define PLAYER_CODEC_DRC      0x02     // Compressor on the AIF1 DRC
+
 typedef struct {
     uint8_t is_playing;
     uint8_t is_paused;
@@ -30,9 +37,35 @@ typedef struct {
     loop_mode_t loop_mode;
     uint8_t current_track;
     uint8_t volume;  // 0-100
+    crossfeed_preset_t crossfeed;  // Applied while the output is the headphone jack
+    uint8_t drc_enabled;  // Compressor for noisy surroundings
+    uint8_t loudness;  // Equal-loudness bass/treble lift below full volume
+    uint8_t codec_dsp;  // Features handed to the codec's DSP (PLAYER_CODEC_*)
+    uint16_t speed;  // Playback speed in percent, pitch kept (100 = off)
+    uint32_t fir_taps;  // Correction filter loaded (player_load_fir), 0 = none
+    uint32_t duration_sec;  // Length of loaded track (0 if unknown)
     char current_file[MAX_FILENAME_LEN];
 } player_t;
 
+/* Pipeline stages, profiled with system_get_cycles() */
+typedef enum {
+    PLAYER_STAGE_DECODE = 0,   // decoder_read()
+    PLAYER_STAGE_SRC,          // Sample rate conversion
+    PLAYER_STAGE_STRETCH,      // Variable speed (WSOLA)
+    PLAYER_STAGE_DSP,          // Loudness, crossfeed, FIR, DRC, limiter (s16 -> q31 -> s16)
+    PLAYER_STAGE_FIR,          // Correction filter alone (part of DSP)
+    PLAYER_STAGE_OUTPUT,       // DMA block fill (interrupt)
+    PLAYER_STAGE_SEEK,         // player_seek() until output restarts
+    PLAYER_STAGE_COUNT
+} player_stage_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t frames;           // Frames produced by the stage
+    uint64_t cycles;           // Total
+    uint32_t max_cycles;       // Worst single call
+} player_stage_stats_t;
+
 /* Player control functions */
 int player_init(void);
 int player_load_file(const char* filename);
@@ -41,9 +74,32 @@ int player_pause(void);
 int player_resume(void);
 int player_stop(void);
 int player_set_volume(uint8_t volume);
+int player_set_crossfeed(crossfeed_preset_t preset);
+int player_set_loudness(uint8_t enabled);
+int player_set_drc(uint8_t enabled);
+int player_set_codec_dsp(uint8_t features);
+int player_set_speed(uint16_t percent);
+int player_load_fir(const char* path);
+int player_play_sfx(sfx_id_t sfx);
 int player_toggle_shuffle(void);
 int player_cycle_loop(void);
 player_t* player_get_state(void);
 uint32_t player_get_position(void);
+uint32_t player_get_position_ms(void);
+
+/* Jump within the loaded (or last) track; keeps the play/pause state */
+int player_seek(uint32_t position_ms);
+
+/* Streaming: decode ahead into the PCM queue (call from main loop) */
+void player_process(void);
+
+/* Diagnostics */
+const player_stage_stats_t* player_get_stage_stats(void);
+const char* player_stage_name(player_stage_t stage);
+void player_reset_stage_stats(void);
+uint32_t player_get_underruns(void);
+
+/* Limiter gain reduction since the last call, DRC gain */
+void player_get_limiter_meter(limiter_meter_t* meter);
 
 #endif /* __PLAYER_H */
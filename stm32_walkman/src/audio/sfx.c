@@ -0,0 +1,125 @@
+/**
+ * UI Sound Effects - Implementation
+ */
+
+#include "sfx.h"
+#include "dsp.h"
+#include <string.h>
+
+/* Order the voice fields against active, which hands a voice between the
+ * caller and the mixer. Cortex-M4 is in-order single core, so no hardware
+ * barrier is needed; the Linux daemon mixes on its output thread. */
+#if defined(__linux__)
+#define SFX_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define SFX_BARRIER() __asm__ volatile("" ::: "memory")
+#endif
+
+void sfx_init(sfx_mixer_t* mixer, uint32_t sample_rate) {
+    memset(mixer, 0, sizeof(*mixer));
+    mixer->sample_rate = sample_rate;
+}
+
+/**
+ * Output rate for voices started from now on
+ */
+void sfx_set_rate(sfx_mixer_t* mixer, uint32_t sample_rate) {
+    mixer->sample_rate = sample_rate;
+}
+
+/**
+ * Decode count clip frames from first into window[at..]; zeros past the end
+ */
+static void sfx_voice_decode(sfx_voice_t* voice, uint32_t first, uint32_t count, uint32_t at) {
+    const sfx_clip_t* clip = voice->clip;
+    uint32_t n = (first < clip->frames) ? clip->frames - first : 0;
+
+    if (n > count) n = count;
+    if (clip->format == SFX_IMA) {
+        int16_t stereo[(SFX_CHUNK + 1) * 2];
+        if (n > 0) {
+            adpcm_ima_decode(voice->ima, clip->data, 1, first, n, stereo);
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            voice->window[at + i] = stereo[2 * i];
+        }
+    } else {
+        memcpy(&voice->window[at], (const int16_t*)clip->data + first, n * sizeof(int16_t));
+    }
+    memset(&voice->window[at + n], 0, (count - n) * sizeof(int16_t));
+}
+
+sfx_voice_t* sfx_voice_claim(sfx_mixer_t* mixer, const sfx_clip_t* clip) {
+    sfx_voice_t* voice = &mixer->voice[0];
+
+    for (uint32_t i = 0; i < SFX_VOICES; i++) {
+        sfx_voice_t* v = &mixer->voice[i];
+        if (!v->active) {
+            voice = v;
+            break;
+        }
+        if (v->serial - voice->serial > 0x80000000u) voice = v;  /* Older */
+    }
+
+    voice->active = 0;
+    SFX_BARRIER();      /* Reclaimed from the mixer before it is rewritten */
+    voice->clip = clip;
+    voice->serial = ++mixer->serial;
+    voice->phase = 0;
+    voice->step = (uint32_t)(((uint64_t)clip->sample_rate << 16) / mixer->sample_rate);
+    voice->base = 0;
+    sfx_voice_decode(voice, 0, SFX_CHUNK + 1, 0);
+    return voice;
+}
+
+void sfx_voice_start(sfx_voice_t* voice) {
+    SFX_BARRIER();      /* Set up before the mixer sees it */
+    voice->active = 1;
+}
+
+uint32_t sfx_voice_mix(sfx_voice_t* voice, int16_t* pcm, uint32_t frames) {
+    const uint32_t end = voice->clip->frames;
+    uint32_t i;
+
+    for (i = 0; i < frames; i++) {
+        uint32_t k = voice->phase >> 16;
+        if (k >= end) break;
+
+        /* Slide the window on, keeping its last frame for the interpolation */
+        while (k + 1 > voice->base + SFX_CHUNK) {
+            voice->window[0] = voice->window[SFX_CHUNK];
+            voice->base += SFX_CHUNK;
+            sfx_voice_decode(voice, voice->base + 1, SFX_CHUNK, 1);
+        }
+
+        int32_t s0 = voice->window[k - voice->base];
+        int32_t s1 = voice->window[k + 1 - voice->base];
+        int32_t s = s0 + (((s1 - s0) * (int32_t)((voice->phase & 0xFFFF) >> 1)) >> 15);
+        pcm[2 * i] = dsp_sat16(pcm[2 * i] + s);
+        pcm[2 * i + 1] = dsp_sat16(pcm[2 * i + 1] + s);
+        voice->phase += voice->step;
+    }
+    return i;
+}
+
+uint32_t sfx_mix(sfx_mixer_t* mixer, int16_t* pcm, uint32_t frames) {
+    uint32_t mixed = 0;
+
+    for (uint32_t i = 0; i < SFX_VOICES; i++) {
+        sfx_voice_t* voice = &mixer->voice[i];
+        if (!voice->active) continue;
+
+        if (sfx_voice_mix(voice, pcm, frames) < frames) {
+            SFX_BARRIER();  /* Done with it before it can be claimed */
+            voice->active = 0;
+        }
+        mixed++;
+    }
+    return mixed;
+}
+
+void sfx_stop_all(sfx_mixer_t* mixer) {
+    for (uint32_t i = 0; i < SFX_VOICES; i++) {
+        mixer->voice[i].active = 0;
+    }
+}
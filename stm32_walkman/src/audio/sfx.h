@@ -0,0 +1,80 @@
+/**
+ * UI Sound Effects
+ *
+ * A small voice mixer for key clicks and confirmation tones. Clips are
+ * mono and live in flash (sfx_clips.c, generated by tools/sfx_clips.py),
+ * as 16-bit PCM or one IMA ADPCM block at any rate; a voice steps through
+ * its clip at the output rate with linear interpolation and is added to
+ * both channels of the output block with saturation. Only active voices
+ * are visited, so an idle mixer costs nothing per frame.
+ *
+ * The main loop claims and starts voices, the DMA interrupt mixes them:
+ * once started a voice belongs to the interrupt until its clip ends.
+ */
+
+#ifndef __SFX_H
+#define __SFX_H
+
+#include <stdint.h>
+#include "adpcm.h"
+
+#define SFX_VOICES 4
+#define SFX_CHUNK 32               // Clip frames decoded at a time
+
+typedef enum {
+    SFX_PCM16 = 0,                 // int16_t samples
+    SFX_IMA = 1                    // One mono IMA ADPCM block
+} sfx_format_t;
+
+typedef struct {
+    const void* data;
+    uint32_t frames;
+    uint32_t sample_rate;
+    uint8_t format;                // sfx_format_t
+} sfx_clip_t;
+
+/* Clips in sfx_clips.c */
+typedef enum {
+    SFX_CLICK = 0,                 // Key press
+    SFX_CONFIRM,                   // Setting switched
+    SFX_COUNT
+} sfx_id_t;
+
+extern const sfx_clip_t sfx_clips[SFX_COUNT];
+
+typedef struct {
+    const sfx_clip_t* clip;
+    volatile uint8_t active;       // Owned by the mixer (interrupt) while set
+    uint32_t serial;               // Start order, the oldest voice is taken first
+    uint32_t phase;                // Clip position, Q16 frames
+    uint32_t step;                 // Clip frames per output frame, Q16
+    uint32_t base;                 // Clip frame of window[0]
+    adpcm_ima_state_t ima[ADPCM_IMA_MAX_CHANNELS];
+    int16_t window[SFX_CHUNK + 1]; // Decoded frames base .. base + SFX_CHUNK
+} sfx_voice_t;
+
+typedef struct {
+    sfx_voice_t voice[SFX_VOICES];
+    uint32_t sample_rate;          // Output
+    uint32_t serial;
+} sfx_mixer_t;
+
+void sfx_init(sfx_mixer_t* mixer, uint32_t sample_rate);
+void sfx_set_rate(sfx_mixer_t* mixer, uint32_t sample_rate);
+
+/* Main loop: a voice set up for clip, not mixed until sfx_voice_start()
+ * (all busy: the oldest is cut off) */
+sfx_voice_t* sfx_voice_claim(sfx_mixer_t* mixer, const sfx_clip_t* clip);
+void sfx_voice_start(sfx_voice_t* voice);
+
+/* Add the voice's next frames to interleaved stereo pcm; returns the
+ * frames mixed, fewer than frames once the clip has ended */
+uint32_t sfx_voice_mix(sfx_voice_t* voice, int16_t* pcm, uint32_t frames);
+
+/* Interrupt: mix every active voice into the block; returns the voices
+ * mixed (0: the block is untouched) */
+uint32_t sfx_mix(sfx_mixer_t* mixer, int16_t* pcm, uint32_t frames);
+
+void sfx_stop_all(sfx_mixer_t* mixer);
+
+#endif /* __SFX_H */
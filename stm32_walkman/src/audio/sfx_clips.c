@@ -0,0 +1,159 @@
+/**
+ * UI Sound Effects - Clips
+ * Generated by tools/sfx_clips.py (make sfx-clips), do not edit
+ */
+
+#include "sfx.h"
+
+/* click: 176 frames, 16-bit PCM, -14 dBFS peak */
+static const int16_t sfx_click[176] = {
+    0, 450, 1592, 2949, 3948, 4088, 3082, 955, -1952, -4485, -6091, -6538,
+    -5812, -4104, -1770, 746, 2993, 4590, 5293, 5027, 3892, 2137, 102, -1838,
+    -3348, -4187, -4244, -3553, -2275, -668, 968, 2343, 3231, 3503, 3144, 2252,
+    1014, -334, -1549, -2425, -2827, -2710, -2123, -1196, -110, 936, 1760, 2229,
+    2280, 1928, 1257, 402, -476, -1223, -1713, -1876, -1700, -1235, -579, 143,
+    800, 1280, 1509, 1460, 1157, 668, 88, -475, -924, -1186, -1225, -1046,
+    -694, -239, 233, 637, 908, 1004, 919, 676, 329, -58, -412, -675,
+    -805, -786, -630, -372, -63, 240, 485, 630, 657, 567, 383, 141,
+    -112, -332, -481, -537, -496, -370, -186, 21, 212, 356, 429, 423,
+    343, 207, 42, -121, -254, -335, -353, -307, -211, -82, 54, 172,
+    255, 287, 268, 202, 105, -6, -109, -188, -229, -228, -187, -115,
+    -27, 61, 133, 178, 189, 166, 116, 48, -25, -90, -135, -154,
+    -145, -111, -59, 0, 56, 99, 122, 122, 101, 64, 17, -30,
+    -70, -94, -101, -90, -64, -27, 12, 46, 71, 82, 78, 60,
+    33, 2, -28, -52, -65, -66, -55, -35,
+};
+
+/* confirm: 3969 frames, IMA ADPCM, -18 dBFS peak */
+static const uint8_t sfx_confirm[1988] = {
+    0, 0, 0, 0, 0, 0, 0, 16, 0, 0, 0, 144, 144, 9, 153, 153,
+    144, 0, 1, 17, 18, 19, 19, 19, 17, 1, 153, 186, 187, 187, 173, 169,
+    169, 9, 33, 51, 53, 67, 67, 50, 34, 17, 185, 219, 219, 203, 203, 171,
+    187, 154, 16, 83, 68, 52, 53, 51, 67, 17, 129, 185, 205, 219, 203, 203,
+    186, 154, 137, 32, 99, 83, 52, 51, 52, 35, 2, 144, 219, 204, 219, 187,
+    188, 171, 154, 9, 49, 70, 67, 52, 67, 35, 19, 130, 168, 235, 188, 189,
+    203, 187, 186, 153, 24, 82, 68, 83, 51, 36, 35, 18, 129, 185, 220, 204,
+    187, 188, 187, 171, 137, 32, 68, 84, 51, 37, 51, 35, 17, 128, 203, 220,
+    203, 203, 187, 172, 153, 9, 48, 99, 83, 51, 52, 36, 18, 1, 152, 202,
+    189, 204, 187, 203, 170, 138, 8, 50, 69, 52, 68, 50, 35, 34, 0, 169,
+    220, 219, 203, 187, 187, 187, 153, 32, 99, 52, 53, 52, 51, 51, 18, 128,
+    202, 220, 203, 188, 187, 172, 154, 137, 33, 83, 68, 67, 36, 35, 19, 2,
+    144, 203, 204, 204, 202, 186, 170, 154, 8, 34, 53, 69, 51, 52, 35, 35,
+    129, 168, 204, 204, 219, 186, 187, 187, 153, 24, 67, 69, 83, 51, 67, 50,
+    33, 128, 185, 204, 189, 188, 203, 186, 170, 137, 32, 83, 68, 67, 36, 51,
+    34, 18, 144, 202, 204, 188, 188, 172, 171, 154, 9, 33, 68, 68, 67, 51,
+    67, 18, 1, 160, 202, 204, 188, 188, 186, 187, 154, 24, 50, 70, 52, 83,
+    50, 35, 19, 129, 184, 204, 204, 203, 203, 186, 170, 137, 24, 67, 68, 52,
+    52, 51, 51, 34, 128, 202, 204, 204, 203, 186, 187, 170, 137, 33, 68, 68,
+    52, 51, 52, 34, 17, 152, 202, 204, 188, 188, 203, 170, 154, 8, 49, 68,
+    68, 51, 52, 51, 34, 2, 169, 235, 188, 189, 203, 186, 186, 153, 0, 66,
+    68, 52, 52, 67, 34, 18, 129, 169, 204, 204, 187, 188, 187, 171, 137, 16,
+    68, 68, 67, 67, 35, 35, 18, 136, 186, 190, 189, 188, 203, 170, 154, 9,
+    32, 68, 52, 68, 35, 36, 33, 1, 152, 186, 190, 188, 204, 170, 171, 153,
+    8, 50, 68, 53, 67, 36, 50, 33, 0, 168, 219, 204, 203, 187, 187, 187,
+    138, 40, 83, 68, 52, 52, 67, 34, 17, 129, 170, 204, 204, 187, 188, 171,
+    171, 136, 32, 99, 52, 68, 66, 34, 34, 17, 152, 201, 219, 219, 187, 203,
+    170, 154, 9, 49, 68, 68, 51, 52, 36, 33, 1, 153, 202, 204, 203, 172,
+    187, 170, 138, 8, 66, 68, 83, 51, 67, 35, 18, 129, 169, 204, 204, 203,
+    187, 187, 171, 138, 32, 83, 53, 53, 67, 50, 35, 18, 128, 202, 188, 205,
+    187, 188, 186, 154, 137, 33, 68, 68, 67, 51, 67, 18, 2, 152, 202, 204,
+    203, 172, 187, 171, 154, 8, 49, 54, 68, 36, 67, 34, 18, 0, 168, 218,
+    219, 203, 187, 172, 170, 153, 16, 50, 69, 52, 52, 51, 36, 17, 0, 185,
+    204, 188, 188, 188, 171, 155, 153, 17, 68, 83, 52, 67, 50, 50, 17, 136,
+    202, 204, 219, 187, 172, 171, 154, 9, 33, 84, 67, 52, 51, 36, 34, 1,
+    152, 203, 189, 204, 187, 187, 172, 153, 0, 49, 69, 67, 52, 51, 51, 34,
+    129, 169, 205, 188, 204, 187, 171, 171, 138, 16, 83, 68, 83, 51, 51, 51,
+    18, 128, 202, 204, 204, 187, 188, 186, 154, 137, 48, 99, 83, 67, 51, 51,
+    51, 17, 152, 219, 204, 188, 203, 187, 187, 170, 8, 50, 69, 68, 67, 50,
+    51, 34, 1, 168, 204, 188, 189, 203, 187, 170, 138, 24, 66, 68, 52, 52,
+    51, 51, 34, 129, 186, 205, 204, 203, 171, 172, 169, 137, 32, 66, 52, 53,
+    36, 51, 35, 18, 136, 202, 204, 219, 187, 188, 186, 154, 9, 33, 68, 68,
+    67, 51, 51, 50, 1, 152, 219, 189, 188, 188, 172, 170, 138, 8, 49, 84,
+    67, 67, 51, 51, 34, 129, 184, 204, 189, 188, 172, 187, 171, 137, 40, 66,
+    53, 53, 67, 51, 35, 18, 128, 185, 190, 204, 203, 187, 187, 170, 9, 32,
+    68, 68, 67, 67, 34, 35, 1, 144, 202, 219, 188, 188, 187, 187, 170, 8,
+    49, 54, 53, 52, 67, 35, 34, 129, 152, 219, 188, 189, 187, 188, 170, 138,
+    24, 50, 69, 52, 52, 36, 34, 18, 129, 169, 235, 203, 188, 187, 203, 154,
+    153, 32, 66, 68, 52, 67, 35, 35, 2, 128, 186, 205, 188, 188, 172, 171,
+    154, 136, 33, 83, 68, 51, 52, 36, 18, 1, 144, 187, 205, 203, 172, 187,
+    186, 153, 25, 49, 69, 52, 52, 51, 36, 18, 1, 153, 188, 189, 204, 187,
+    171, 171, 138, 24, 67, 53, 53, 36, 51, 51, 18, 128, 185, 205, 188, 188,
+    172, 171, 170, 137, 17, 52, 53, 68, 51, 51, 35, 2, 144, 202, 189, 189,
+    203, 187, 187, 154, 9, 49, 69, 83, 51, 52, 51, 34, 1, 168, 219, 204,
+    203, 187, 203, 170, 153, 0, 50, 84, 67, 67, 51, 50, 18, 129, 185, 204,
+    204, 187, 188, 187, 170, 137, 16, 83, 52, 53, 67, 50, 50, 17, 144, 186,
+    220, 219, 187, 187, 187, 171, 136, 49, 84, 52, 52, 67, 35, 19, 17, 152,
+    203, 204, 203, 203, 186, 170, 154, 24, 49, 53, 68, 67, 50, 35, 34, 0,
+    169, 188, 205, 187, 172, 187, 170, 153, 16, 66, 68, 67, 51, 36, 34, 18,
+    144, 185, 188, 189, 173, 171, 171, 154, 9, 33, 67, 52, 52, 52, 51, 18,
+    2, 169, 187, 189, 187, 203, 171, 171, 154, 16, 49, 50, 51, 51, 35, 33,
+    17, 145, 144, 169, 169, 153, 169, 153, 0, 0, 16, 16, 16, 16, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 16, 0, 9, 144, 144, 9, 9, 16, 16,
+    33, 17, 18, 17, 144, 169, 186, 186, 171, 154, 16, 50, 67, 51, 83, 17,
+    145, 186, 189, 173, 187, 171, 9, 67, 68, 52, 52, 35, 1, 185, 236, 219,
+    187, 187, 153, 32, 84, 52, 37, 51, 18, 144, 203, 205, 203, 187, 170, 9,
+    66, 84, 67, 51, 51, 1, 185, 205, 189, 203, 171, 153, 16, 68, 52, 37,
+    51, 33, 144, 203, 220, 203, 186, 170, 9, 50, 85, 67, 51, 35, 1, 169,
+    205, 204, 186, 187, 154, 32, 99, 52, 37, 35, 18, 128, 202, 220, 187, 203,
+    170, 136, 34, 69, 52, 67, 34, 1, 169, 235, 203, 172, 171, 138, 24, 83,
+    52, 53, 50, 18, 145, 202, 204, 188, 203, 154, 9, 33, 84, 67, 51, 35,
+    17, 169, 220, 219, 187, 187, 154, 24, 68, 68, 67, 50, 18, 128, 201, 204,
+    219, 186, 154, 9, 48, 68, 68, 50, 35, 2, 168, 204, 204, 187, 187, 154,
+    24, 83, 53, 52, 36, 18, 0, 186, 205, 203, 187, 171, 9, 48, 69, 52,
+    52, 50, 1, 160, 235, 219, 187, 187, 154, 24, 83, 68, 67, 51, 18, 129,
+    201, 204, 203, 203, 154, 137, 33, 83, 52, 52, 35, 2, 160, 235, 219, 187,
+    187, 170, 0, 83, 68, 67, 51, 34, 0, 186, 205, 188, 188, 170, 137, 33,
+    99, 83, 50, 51, 17, 152, 219, 204, 203, 186, 169, 24, 50, 54, 68, 50,
+    18, 129, 169, 189, 189, 172, 155, 138, 17, 68, 83, 51, 51, 2, 144, 235,
+    219, 187, 172, 154, 8, 50, 69, 67, 51, 35, 129, 185, 205, 188, 172, 171,
+    153, 32, 68, 83, 51, 36, 17, 144, 202, 204, 203, 186, 154, 8, 65, 83,
+    52, 51, 35, 1, 185, 205, 188, 188, 171, 153, 32, 99, 67, 52, 50, 17,
+    128, 203, 204, 188, 171, 171, 8, 65, 68, 83, 50, 34, 1, 169, 204, 188,
+    188, 186, 153, 16, 52, 69, 67, 34, 18, 144, 201, 204, 187, 188, 154, 9,
+    49, 69, 67, 67, 18, 1, 168, 219, 219, 187, 187, 154, 16, 68, 52, 53,
+    50, 18, 128, 202, 204, 172, 187, 171, 136, 49, 69, 52, 36, 35, 1, 168,
+    188, 205, 187, 171, 154, 24, 83, 68, 67, 35, 18, 129, 202, 188, 189, 187,
+    171, 137, 49, 54, 53, 67, 34, 1, 152, 219, 188, 188, 187, 153, 24, 82,
+    68, 51, 36, 18, 129, 186, 205, 203, 187, 171, 137, 49, 69, 83, 51, 50,
+    17, 168, 235, 219, 187, 187, 154, 24, 83, 52, 53, 51, 34, 128, 185, 190,
+    189, 187, 171, 138, 49, 84, 52, 52, 50, 17, 168, 203, 205, 187, 187, 155,
+    24, 82, 68, 67, 35, 19, 129, 185, 205, 219, 186, 155, 138, 33, 99, 83,
+    50, 35, 18, 152, 219, 188, 173, 187, 169, 24, 65, 68, 67, 51, 34, 0,
+    185, 205, 219, 186, 171, 137, 32, 52, 54, 67, 50, 17, 152, 202, 204, 172,
+    187, 154, 8, 50, 69, 52, 51, 35, 1, 185, 205, 188, 188, 186, 137, 32,
+    83, 68, 51, 51, 18, 144, 219, 204, 203, 171, 170, 8, 65, 83, 52, 51,
+    35, 1, 169, 205, 188, 188, 170, 138, 16, 83, 68, 51, 51, 18, 144, 203,
+    205, 203, 186, 154, 9, 49, 69, 67, 51, 51, 1, 169, 205, 219, 187, 186,
+    138, 16, 83, 68, 67, 34, 18, 128, 202, 219, 172, 187, 155, 9, 49, 69,
+    52, 51, 51, 17, 169, 205, 188, 188, 186, 153, 40, 82, 52, 37, 35, 34,
+    144, 201, 188, 189, 187, 170, 137, 49, 69, 52, 36, 35, 1, 168, 219, 188,
+    188, 187, 154, 16, 67, 69, 51, 36, 18, 128, 185, 205, 203, 187, 170, 9,
+    48, 53, 53, 52, 34, 2, 168, 219, 188, 188, 187, 154, 24, 82, 68, 51,
+    36, 34, 128, 185, 205, 203, 187, 170, 10, 48, 84, 83, 50, 35, 17, 168,
+    203, 205, 187, 187, 154, 24, 82, 52, 53, 35, 19, 129, 201, 219, 188, 203,
+    154, 137, 32, 83, 52, 52, 34, 18, 152, 219, 188, 188, 172, 153, 8, 50,
+    53, 37, 51, 19, 129, 185, 205, 203, 172, 170, 137, 32, 83, 52, 67, 35,
+    2, 144, 203, 189, 188, 187, 170, 8, 51, 70, 67, 35, 35, 0, 185, 220,
+    203, 203, 154, 153, 17, 67, 68, 51, 51, 18, 144, 219, 204, 203, 186, 154,
+    8, 49, 69, 67, 51, 35, 129, 169, 205, 203, 203, 170, 137, 16, 67, 68,
+    67, 34, 2, 128, 187, 205, 203, 171, 170, 8, 49, 69, 67, 51, 35, 1,
+    169, 189, 189, 188, 186, 137, 40, 67, 53, 52, 51, 18, 128, 203, 189, 188,
+    172, 154, 9, 49, 68, 52, 51, 20, 1, 168, 219, 188, 172, 171, 138, 16,
+    67, 68, 36, 35, 18, 128, 202, 219, 188, 186, 155, 9, 49, 69, 67, 51,
+    51, 1, 169, 204, 204, 187, 171, 154, 16, 67, 69, 51, 36, 33, 144, 185,
+    189, 189, 186, 155, 137, 49, 53, 53, 36, 19, 17, 153, 219, 219, 187, 171,
+    154, 16, 82, 52, 52, 51, 19, 145, 201, 204, 188, 187, 170, 137, 49, 53,
+    53, 36, 35, 1, 152, 219, 219, 187, 171, 154, 24, 67, 53, 52, 51, 34,
+    128, 186, 205, 188, 187, 171, 137, 33, 69, 67, 51, 51, 2, 168, 235, 203,
+    172, 171, 154, 0, 66, 52, 52, 36, 33, 128, 185, 235, 187, 172, 170, 9,
+    32, 83, 52, 67, 34, 1, 152, 202, 188, 188, 171, 154, 24, 66, 52, 52,
+    36, 18, 128, 185, 219, 219, 170, 170, 9, 32, 67, 52, 67, 34, 1, 160,
+    202, 203, 203, 186, 153, 0, 50, 53, 51, 51, 51, 1, 170, 187, 187, 156,
+    153, 9, 17, 49, 18, 18, 2, 1, 9, 153, 153, 153, 0, 0, 0, 0,
+    1, 0, 0, 0,
+};
+
+const sfx_clip_t sfx_clips[SFX_COUNT] = {
+    [SFX_CLICK] = {sfx_click, 176, 44100, SFX_PCM16},
+    [SFX_CONFIRM] = {sfx_confirm, 3969, 44100, SFX_IMA},
+};
@@ -0,0 +1,22 @@
+/**
+ * Shuffle Engine Implementation
+ */
+
+#include "shuffle.h"
+
+void shuffle_order(uint32_t seed, uint16_t* order, uint16_t count) {
+    uint32_t x = seed ? seed : 1;
+
+    for (uint16_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    for (uint16_t i = count; i > 1; i--) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        uint16_t j = (uint16_t)(x % i);
+        uint16_t t = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = t;
+    }
+}
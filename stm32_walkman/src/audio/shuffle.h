@@ -0,0 +1,18 @@
+/**
+ * Shuffle Engine
+ *
+ * Seeded play order shared by the firmware and the host core library: the
+ * same seed gives the same order everywhere, so a stored seed (resume
+ * journal) reproduces the order after a reboot without storing it.
+ */
+
+#ifndef __SHUFFLE_H
+#define __SHUFFLE_H
+
+#include <stdint.h>
+
+/* Fisher-Yates permutation of 0..count-1 driven by an xorshift32 stream
+ * (seed 0 is treated as 1) */
+void shuffle_order(uint32_t seed, uint16_t* order, uint16_t count);
+
+#endif /* __SHUFFLE_H */
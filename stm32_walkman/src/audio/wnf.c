@@ -0,0 +1,137 @@
+/**
+ * Walkman Native Format (WNF) - Header Layout
+ * Shared by the player backend (dec_wnf.c) and the host packer
+ */
+
+#include "wnf.h"
+#include "adpcm.h"
+#include <string.h>
+
+/* Byte offsets in the header sector */
+#define WNF_OFS_MAGIC           0
+#define WNF_OFS_VERSION         4
+#define WNF_OFS_HEADER_BYTES    6
+#define WNF_OFS_CODEC           8
+#define WNF_OFS_CHANNELS        9
+#define WNF_OFS_BLOCK_BYTES     10
+#define WNF_OFS_SAMPLE_RATE     12
+#define WNF_OFS_TOTAL_FRAMES    16
+#define WNF_OFS_BLOCK_FRAMES    20
+#define WNF_OFS_DATA_OFFSET     24
+#define WNF_OFS_BLOCK_COUNT     28
+#define WNF_OFS_DURATION_MS     32
+#define WNF_OFS_TRACK_GAIN      36
+#define WNF_OFS_TRACK_PEAK      38
+#define WNF_OFS_ALBUM_GAIN      40
+#define WNF_OFS_ALBUM_PEAK      42
+#define WNF_OFS_TRACK_NUMBER    44
+#define WNF_OFS_TITLE           64
+#define WNF_OFS_ARTIST          (WNF_OFS_TITLE + WNF_TAG_LEN)
+#define WNF_OFS_ALBUM           (WNF_OFS_ARTIST + WNF_TAG_LEN)
+
+static uint16_t wnf_get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t wnf_get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wnf_put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void wnf_put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void wnf_get_tag(char* dst, const uint8_t* src) {
+    memcpy(dst, src, WNF_TAG_LEN);
+    dst[WNF_TAG_LEN - 1] = '\0';
+}
+
+static void wnf_put_tag(uint8_t* dst, const char* src) {
+    size_t len = strlen(src);
+    memcpy(dst, src, len < WNF_TAG_LEN ? len : WNF_TAG_LEN - 1);
+}
+
+uint32_t wnf_block_frames(uint8_t codec, uint8_t channels, uint32_t block_bytes) {
+    if (block_bytes == 0 || block_bytes % WNF_SECTOR_BYTES != 0) {
+        return 0;
+    }
+
+    switch (codec) {
+        case WNF_CODEC_PCM16:
+            return channels == 2 ? block_bytes / 4 : 0;
+        case WNF_CODEC_IMA_ADPCM:
+            return adpcm_ima_block_frames(block_bytes, channels);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Parse a header sector, checking the geometry against the codec
+ */
+int wnf_header_parse(wnf_header_t* hdr, const uint8_t* sector) {
+    if (memcmp(sector + WNF_OFS_MAGIC, WNF_MAGIC, 4) != 0 ||
+        wnf_get16(sector + WNF_OFS_VERSION) != WNF_VERSION) {
+        return -1;
+    }
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->codec = sector[WNF_OFS_CODEC];
+    hdr->channels = sector[WNF_OFS_CHANNELS];
+    hdr->block_bytes = wnf_get16(sector + WNF_OFS_BLOCK_BYTES);
+    hdr->sample_rate = wnf_get32(sector + WNF_OFS_SAMPLE_RATE);
+    hdr->total_frames = wnf_get32(sector + WNF_OFS_TOTAL_FRAMES);
+    hdr->frames_per_block = wnf_get32(sector + WNF_OFS_BLOCK_FRAMES);
+    hdr->data_offset = wnf_get32(sector + WNF_OFS_DATA_OFFSET);
+    hdr->block_count = wnf_get32(sector + WNF_OFS_BLOCK_COUNT);
+    hdr->duration_ms = wnf_get32(sector + WNF_OFS_DURATION_MS);
+    hdr->track_gain = (int16_t)wnf_get16(sector + WNF_OFS_TRACK_GAIN);
+    hdr->track_peak = wnf_get16(sector + WNF_OFS_TRACK_PEAK);
+    hdr->album_gain = (int16_t)wnf_get16(sector + WNF_OFS_ALBUM_GAIN);
+    hdr->album_peak = wnf_get16(sector + WNF_OFS_ALBUM_PEAK);
+    hdr->track_number = wnf_get16(sector + WNF_OFS_TRACK_NUMBER);
+    wnf_get_tag(hdr->title, sector + WNF_OFS_TITLE);
+    wnf_get_tag(hdr->artist, sector + WNF_OFS_ARTIST);
+    wnf_get_tag(hdr->album, sector + WNF_OFS_ALBUM);
+
+    if (hdr->sample_rate == 0 ||
+        hdr->frames_per_block == 0 ||
+        hdr->frames_per_block != wnf_block_frames(hdr->codec, hdr->channels, hdr->block_bytes) ||
+        hdr->data_offset < WNF_HEADER_BYTES || hdr->data_offset % WNF_SECTOR_BYTES != 0 ||
+        (uint64_t)hdr->block_count * hdr->frames_per_block < hdr->total_frames) {
+        return -1;
+    }
+    return 0;
+}
+
+void wnf_header_write(const wnf_header_t* hdr, uint8_t* sector) {
+    memcpy(sector + WNF_OFS_MAGIC, WNF_MAGIC, 4);
+    wnf_put16(sector + WNF_OFS_VERSION, WNF_VERSION);
+    wnf_put16(sector + WNF_OFS_HEADER_BYTES, WNF_HEADER_BYTES);
+    sector[WNF_OFS_CODEC] = hdr->codec;
+    sector[WNF_OFS_CHANNELS] = hdr->channels;
+    wnf_put16(sector + WNF_OFS_BLOCK_BYTES, hdr->block_bytes);
+    wnf_put32(sector + WNF_OFS_SAMPLE_RATE, hdr->sample_rate);
+    wnf_put32(sector + WNF_OFS_TOTAL_FRAMES, hdr->total_frames);
+    wnf_put32(sector + WNF_OFS_BLOCK_FRAMES, hdr->frames_per_block);
+    wnf_put32(sector + WNF_OFS_DATA_OFFSET, hdr->data_offset);
+    wnf_put32(sector + WNF_OFS_BLOCK_COUNT, hdr->block_count);
+    wnf_put32(sector + WNF_OFS_DURATION_MS, hdr->duration_ms);
+    wnf_put16(sector + WNF_OFS_TRACK_GAIN, (uint16_t)hdr->track_gain);
+    wnf_put16(sector + WNF_OFS_TRACK_PEAK, hdr->track_peak);
+    wnf_put16(sector + WNF_OFS_ALBUM_GAIN, (uint16_t)hdr->album_gain);
+    wnf_put16(sector + WNF_OFS_ALBUM_PEAK, hdr->album_peak);
+    wnf_put16(sector + WNF_OFS_TRACK_NUMBER, hdr->track_number);
+    wnf_put_tag(sector + WNF_OFS_TITLE, hdr->title);
+    wnf_put_tag(sector + WNF_OFS_ARTIST, hdr->artist);
+    wnf_put_tag(sector + WNF_OFS_ALBUM, hdr->album);
+}
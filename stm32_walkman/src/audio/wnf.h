@@ -0,0 +1,80 @@
+/**
+ * Walkman Native Format (WNF) Container
+ *
+ * Pre-transcoded tracks laid out for the player, written by the host tool
+ * tools/wnfpack. Everything is sector aligned so the SD card reads whole
+ * sectors straight into the PCM ring:
+ *
+ *   sector 0      header (WNF_HEADER_BYTES): geometry, tags, ReplayGain
+ *   sector 1...   audio blocks of block_bytes (a multiple of 512), the
+ *                 last one zero padded
+ *
+ * Codecs:
+ * - PCM16: interleaved stereo s16 at the output rate (44.1/48 kHz), no
+ *          decode work at all
+ * - IMA ADPCM: WAV 0x0011 blocks (see adpcm.h), 4:1
+ *
+ * Seek index: every block holds the same number of frames and decodes on
+ * its own, so the index is the header geometry itself. Frame n lives in
+ * block n / frames_per_block at data_offset + block * block_bytes, a
+ * seek point every 23 ms (PCM) or 23-46 ms (ADPCM) without a table to
+ * load.
+ *
+ * All fields are little-endian.
+ */
+
+#ifndef __WNF_H
+#define __WNF_H
+
+#include <stdint.h>
+
+#define WNF_MAGIC           "WNF1"
+#define WNF_VERSION         1
+#define WNF_HEADER_BYTES    512
+#define WNF_SECTOR_BYTES    512
+#define WNF_TAG_LEN         64      // Including the terminating NUL
+
+typedef enum {
+    WNF_CODEC_PCM16 = 0,
+    WNF_CODEC_IMA_ADPCM = 1
+} wnf_codec_t;
+
+/* Default block sizes written by wnfpack */
+#define WNF_PCM_BLOCK_BYTES     4096    // 1024 stereo frames
+#define WNF_ADPCM_BLOCK_BYTES   1024    // 1017 stereo / 2041 mono frames
+
+typedef struct {
+    uint8_t codec;              // wnf_codec_t
+    uint8_t channels;           // PCM16: 2; ADPCM: 1 or 2
+    uint16_t block_bytes;
+    uint32_t sample_rate;
+    uint32_t total_frames;
+    uint32_t frames_per_block;
+    uint32_t data_offset;
+    uint32_t block_count;
+    uint32_t duration_ms;
+    int16_t track_gain;         // ReplayGain in 0.01 dB
+    uint16_t track_peak;        // Q15, 32768 = full scale
+    int16_t album_gain;
+    uint16_t album_peak;
+    uint16_t track_number;
+    char title[WNF_TAG_LEN];
+    char artist[WNF_TAG_LEN];
+    char album[WNF_TAG_LEN];
+} wnf_header_t;
+
+/* Parse and validate a header sector; 0 on success */
+int wnf_header_parse(wnf_header_t* hdr, const uint8_t* sector);
+
+/* Serialize a header into a zeroed WNF_HEADER_BYTES sector */
+void wnf_header_write(const wnf_header_t* hdr, uint8_t* sector);
+
+/* Frames per block for a codec and block size (0 if invalid) */
+uint32_t wnf_block_frames(uint8_t codec, uint8_t channels, uint32_t block_bytes);
+
+/* File offset of the block holding a frame */
+static inline uint32_t wnf_block_offset(const wnf_header_t* hdr, uint32_t frame) {
+    return hdr->data_offset + (frame / hdr->frames_per_block) * hdr->block_bytes;
+}
+
+#endif /* __WNF_H */
@@ -0,0 +1,55 @@
+/**
+ * Button Debounce and Long-Press Tracking
+ */
+
+#include "button_tracker.h"
+#include <string.h>
+
+void button_tracker_init(button_tracker_t* t) {
+    memset(t, 0, sizeof(*t));
+}
+
+int button_tracker_update(button_tracker_t* t, uint8_t pressed, uint32_t now_ms,
+                          button_event_t* event) {
+    /* Debounce: a change counts once the input held it for BUTTON_DEBOUNCE_MS */
+    if (pressed != t->state) {
+        if (!t->changing) {
+            t->changing = 1;
+            t->change_time = now_ms;
+        } else if ((now_ms - t->change_time) >= BUTTON_DEBOUNCE_MS) {
+            t->changing = 0;
+            t->state = pressed;
+            if (pressed) {
+                t->press_time = now_ms;
+                t->long_reported = 0;
+            }
+            *event = pressed ? BUTTON_PRESSED : BUTTON_RELEASED;
+            return 1;
+        }
+        return 0;
+    }
+
+    /* Bounce back to the debounced state */
+    t->changing = 0;
+
+    /* Long press: reported once per press, measured from the press */
+    if (t->state && !t->long_reported && (now_ms - t->press_time) >= BUTTON_LONG_PRESS_MS) {
+        t->long_reported = 1;
+        *event = BUTTON_LONG_PRESSED;
+        return 1;
+    }
+    return 0;
+}
+
+uint32_t button_tracker_deadline(const button_tracker_t* t, uint32_t now_ms) {
+    uint32_t due;
+
+    if (t->changing) {
+        due = t->change_time + BUTTON_DEBOUNCE_MS;
+    } else if (t->state && !t->long_reported) {
+        due = t->press_time + BUTTON_LONG_PRESS_MS;
+    } else {
+        return BUTTON_NO_DEADLINE;
+    }
+    return ((int32_t)(due - now_ms) > 0) ? due - now_ms : 0;
+}
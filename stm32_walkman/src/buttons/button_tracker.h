@@ -0,0 +1,40 @@
+/**
+ * Button Debounce and Long-Press Tracking
+ *
+ * The gesture logic of buttons.c without the GPIO: fed with the raw level
+ * of one button and a millisecond time, it reports BUTTON_PRESSED once the
+ * level held for BUTTON_DEBOUNCE_MS, BUTTON_LONG_PRESSED once per press
+ * after BUTTON_LONG_PRESS_MS and BUTTON_RELEASED. The firmware feeds it
+ * from its poll loop; wminput (linux/) feeds it kernel edge timestamps and
+ * sleeps until button_tracker_deadline().
+ */
+
+#ifndef __BUTTON_TRACKER_H
+#define __BUTTON_TRACKER_H
+
+#include <stdint.h>
+#include "buttons.h"
+
+#define BUTTON_DEBOUNCE_MS 20
+#define BUTTON_LONG_PRESS_MS 1000
+#define BUTTON_NO_DEADLINE 0xFFFFFFFFu
+
+typedef struct {
+    uint8_t state;            // Debounced: 1 = pressed
+    uint32_t press_time;      // Time of the debounced press
+    uint8_t changing;         // Input differs from state since change_time
+    uint32_t change_time;
+    uint8_t long_reported;    // BUTTON_LONG_PRESSED sent for this press
+} button_tracker_t;
+
+void button_tracker_init(button_tracker_t* t);
+
+/* Feed the level (1 = pressed) at now_ms; 1 and *event set if one is due */
+int button_tracker_update(button_tracker_t* t, uint8_t pressed, uint32_t now_ms,
+                          button_event_t* event);
+
+/* Milliseconds from now_ms until an update may report something without a
+ * level change, BUTTON_NO_DEADLINE if none is pending */
+uint32_t button_tracker_deadline(const button_tracker_t* t, uint32_t now_ms);
+
+#endif /* __BUTTON_TRACKER_H */
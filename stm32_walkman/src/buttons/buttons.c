@@ -5,29 +5,28 @@
  */
 
 #include "buttons.h"
+#include "button_tracker.h"
 #include "gpio.h"
 #include "system.h"
 #include <string.h>
 
 /* Button configuration */
 typedef struct {
-    GPIO_TypeDef* port;
-    uint16_t pin;
+    gpio_port_t port;
+    gpio_pin_t pin;
     button_t id;
-    uint8_t state;
-    uint32_t press_time;
-    uint8_t debounced;
+    button_tracker_t tracker; // Debounce and long press (button_tracker.c)
 } button_config_t;
 
 /* Button definitions - STM32F407 Discovery board */
 static button_config_t buttons[NUM_BUTTONS] = {
-    {GPIOD, GPIO_PIN_13, BTN_PREVIOUS, 0, 0, 0},      // Previous track (PD13)
-    {GPIOD, GPIO_PIN_14, BTN_PLAY_PAUSE, 0, 0, 0},    // Play/Pause (PD14)
-    {GPIOD, GPIO_PIN_15, BTN_NEXT, 0, 0, 0},          // Next track (PD15)
-    {GPIOA, GPIO_PIN_0, BTN_VOL_UP, 0, 0, 0},         // Volume Up (PA0 - User button)
-    {GPIOD, GPIO_PIN_0, BTN_VOL_DOWN, 0, 0, 0},       // Volume Down (PD0)
-    {GPIOD, GPIO_PIN_1, BTN_SHUFFLE, 0, 0, 0},        // Shuffle (PD1)
-    {GPIOD, GPIO_PIN_2, BTN_LOOP, 0, 0, 0}            // Loop (PD2)
+    {GPIO_PORT_D, 13, BTN_PREVIOUS, {0}},      // Previous track (PD13)
+    {GPIO_PORT_D, 14, BTN_PLAY_PAUSE, {0}},    // Play/Pause (PD14)
+    {GPIO_PORT_D, 15, BTN_NEXT, {0}},          // Next track (PD15)
+    {GPIO_PORT_A, 0, BTN_VOL_UP, {0}},         // Volume Up (PA0 - User button)
+    {GPIO_PORT_D, 0, BTN_VOL_DOWN, {0}},       // Volume Down (PD0)
+    {GPIO_PORT_D, 1, BTN_SHUFFLE, {0}},        // Shuffle (PD1)
+    {GPIO_PORT_D, 2, BTN_LOOP, {0}}            // Loop (PD2)
 };
 
 /* Button callbacks */
@@ -36,10 +35,6 @@ static button_callback_t button_callbacks[NUM_BUTTONS] = {NULL};
 /* Interrupt flag for debouncing */
 static volatile uint32_t button_interrupt_flags = 0;
 
-/* Debounce timing */
-#define DEBOUNCE_TIME_MS 20
-#define LONG_PRESS_TIME_MS 1000
-
 /**
  * Initialize button inputs
  * Uses bare metal GPIO driver with EXTI interrupts
@@ -71,10 +66,10 @@ int buttons_init(void) {
     gpio_config_interrupt(GPIO_PORT_D, 15, GPIO_INT_FALLING);
     
     /* Set interrupt priorities (lower number = higher priority) */
-    NVIC_SetPriority(EXTI0_IRQn, 5);
-    NVIC_SetPriority(EXTI1_IRQn, 5);
-    NVIC_SetPriority(EXTI2_IRQn, 5);
-    NVIC_SetPriority(EXTI15_10_IRQn, 5);
+    gpio_set_interrupt_priority(0, 5);
+    gpio_set_interrupt_priority(1, 5);
+    gpio_set_interrupt_priority(2, 5);
+    gpio_set_interrupt_priority(13, 5);  /* EXTI15_10 */
     
     return BUTTONS_OK;
 }
@@ -93,7 +88,9 @@ int buttons_register_callback(button_t button, button_callback_t callback) {
 
 /**
  * Poll buttons for changes (call from main loop)
- * This handles debouncing and long-press detection after interrupt
+ * This handles debouncing and long-press detection after interrupt.
+ * Events per press: BUTTON_PRESSED, BUTTON_LONG_PRESSED once the button
+ * is held BUTTON_LONG_PRESS_MS, BUTTON_RELEASED.
  * Uses bare metal GPIO reading
  */
 void buttons_poll(void) {
@@ -106,36 +103,10 @@ void buttons_poll(void) {
         uint8_t pin_state = gpio_read(btn->port, btn->pin);
         uint8_t current_state = pin_state ? 0 : 1;  /* Invert for active-low logic */
         
-        /* Debounce logic with hysteresis */
-        if (current_state != btn->state) {
-            /* State changed, start debounce timer */
-            if (!btn->debounced) {
-                btn->press_time = current_time;
-                btn->debounced = 0;
-            } else if ((current_time - btn->press_time) >= DEBOUNCE_TIME_MS) {
-                /* Debounce time elapsed, confirm state change */
-                btn->debounced = 1;
-                btn->state = current_state;
-                
-                /* Generate callback event */
-                if (button_callbacks[i] != NULL) {
-                    if (current_state == 1) {
-                        button_callbacks[i](BUTTON_PRESSED);
-                    } else {
-                        button_callbacks[i](BUTTON_RELEASED);
-                    }
-                }
-            }
-        } else if (btn->debounced == 0 && (current_time - btn->press_time) >= DEBOUNCE_TIME_MS) {
-            /* State stable after debounce time */
-            btn->debounced = 1;
-        } else if (btn->state == 1 && btn->debounced == 1 && 
-                   (current_time - btn->press_time) >= LONG_PRESS_TIME_MS) {
-            /* Long press detected */
-            if (button_callbacks[i] != NULL) {
-                button_callbacks[i](BUTTON_LONG_PRESSED);
-            }
-            btn->debounced = 2;  /* Mark as long press reported */
+        button_event_t event;
+        if (button_tracker_update(&btn->tracker, current_state, current_time, &event) &&
+            button_callbacks[i] != NULL) {
+            button_callbacks[i](event);
         }
     }
 }
@@ -161,7 +132,7 @@ button_event_t buttons_get_state(button_t button) {
         return BUTTON_RELEASED;
     }
     
-    return buttons[button].state ? BUTTON_PRESSED : BUTTON_RELEASED;
+    return buttons[button].tracker.state ? BUTTON_PRESSED : BUTTON_RELEASED;
 }
 
 /**
@@ -190,15 +161,15 @@ void EXTI2_IRQHandler(void) {
 
 void EXTI15_10_IRQHandler(void) {
     /* Handles EXTI10-15 for PD13, PD14, PD15 */
-    if (EXTI->PR & (1 << 13)) {
+    if (gpio_exti_pending(13)) {
         gpio_exti_clear(13);
         button_interrupt_flags |= (1 << 3);
     }
-    if (EXTI->PR & (1 << 14)) {
+    if (gpio_exti_pending(14)) {
         gpio_exti_clear(14);
         button_interrupt_flags |= (1 << 4);
     }
-    if (EXTI->PR & (1 << 15)) {
+    if (gpio_exti_pending(15)) {
         gpio_exti_clear(15);
         button_interrupt_flags |= (1 << 5);
     }
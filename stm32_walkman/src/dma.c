@@ -0,0 +1,245 @@
+/**
+ * Bare Metal DMA Stream Manager Implementation - STM32F407
+ * Direct register access to DMA1/DMA2 (RM0090 section 10)
+ *
+ * Within one controller the arbiter serves the pending stream with the
+ * highest PL, so audio runs at very high priority. Between DMA1, DMA2 and
+ * the core the bus matrix arbitrates round-robin; bursts keep the number
+ * of arbitration rounds per item down: with the FIFO enabled the stream
+ * reads memory four items at a time (INCR4) and feeds the peripheral from
+ * the FIFO, so a late grant is absorbed by the 16-byte FIFO instead of
+ * reaching the peripheral as an underrun.
+ */
+
+#include "dma.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+
+/* Stream/channel pair serving a request (controller 0 = none) */
+typedef struct {
+    uint8_t controller;
+    uint8_t stream;
+    uint8_t channel;
+} dma_route_t;
+
+/* RM0090 tables 42 (DMA1) and 43 (DMA2) */
+static const dma_route_t dma_routes[DMA_REQUEST_COUNT][2] = {
+    [DMA_REQUEST_SPI3_TX] = {{1, 5, 0}, {1, 7, 0}},
+    [DMA_REQUEST_SDIO]    = {{2, 3, 4}, {2, 6, 4}},
+    [DMA_REQUEST_SPI5_TX] = {{2, 4, 2}, {2, 6, 7}},
+    [DMA_REQUEST_SPI1_TX] = {{2, 3, 3}, {2, 5, 3}},
+    [DMA_REQUEST_SPI2_TX] = {{1, 4, 0}, {0, 0, 0}},
+};
+
+static DMA_Stream_TypeDef* const dma_stream_regs[2][8] = {
+    {DMA1_Stream0, DMA1_Stream1, DMA1_Stream2, DMA1_Stream3,
+     DMA1_Stream4, DMA1_Stream5, DMA1_Stream6, DMA1_Stream7},
+    {DMA2_Stream0, DMA2_Stream1, DMA2_Stream2, DMA2_Stream3,
+     DMA2_Stream4, DMA2_Stream5, DMA2_Stream6, DMA2_Stream7}
+};
+
+static const IRQn_Type dma_stream_irqn[2][8] = {
+    {DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+     DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn},
+    {DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+     DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn}
+};
+
+/* FIFO threshold: full (16 bytes), a multiple of every INCR4 burst */
+#define DMA_FIFO_THRESHOLD_FULL (3u << DMA_SxFCR_FTH_Pos)
+
+/* Burst of four beats */
+#define DMA_BURST_INCR4 1u
+
+static dma_stream_t dma_streams[2][8];
+static uint8_t dma_claimed[2][8];
+
+static DMA_TypeDef* dma_controller(const dma_stream_t* stream) {
+    return stream->controller == 1 ? DMA1 : DMA2;
+}
+
+static DMA_Stream_TypeDef* dma_regs(const dma_stream_t* stream) {
+    return dma_stream_regs[stream->controller - 1][stream->stream];
+}
+
+/* Position of a stream's flags inside LISR/HISR */
+static uint32_t dma_flag_shift(uint8_t stream) {
+    static const uint8_t shift[4] = {0, 6, 16, 22};
+    return shift[stream & 3];
+}
+
+static void dma_clear_flags(const dma_stream_t* stream, uint32_t flags) {
+    DMA_TypeDef* dma = dma_controller(stream);
+    uint32_t mask = flags << dma_flag_shift(stream->stream);
+
+    if (stream->stream < 4) {
+        WRITE_REG(dma->LIFCR, mask);
+    } else {
+        WRITE_REG(dma->HIFCR, mask);
+    }
+}
+
+/**
+ * Write CR and FCR from the configuration (stream disabled)
+ */
+static void dma_program(const dma_stream_t* stream, uint8_t memory_burst) {
+    const dma_config_t* config = &stream->config;
+    DMA_Stream_TypeDef* regs = dma_regs(stream);
+    uint32_t size = config->item_size == 4 ? 2 : config->item_size == 2 ? 1 : 0;
+
+    uint32_t cr = 0;
+    cr |= (uint32_t)stream->channel << DMA_SxCR_CHSEL_Pos;
+    cr |= (uint32_t)config->priority << DMA_SxCR_PL_Pos;
+    cr |= size << DMA_SxCR_MSIZE_Pos;
+    cr |= size << DMA_SxCR_PSIZE_Pos;
+    cr |= DMA_SxCR_MINC;
+    if (config->direction == DMA_DIR_MEM_TO_PERIPH) cr |= DMA_SxCR_DIR_0;
+    if (config->circular) cr |= DMA_SxCR_CIRC;
+    if (config->periph_flow) cr |= DMA_SxCR_PFCTRL;
+    if (config->fifo && memory_burst) cr |= DMA_BURST_INCR4 << DMA_SxCR_MBURST_Pos;
+    if (config->fifo && config->periph_burst) cr |= DMA_BURST_INCR4 << DMA_SxCR_PBURST_Pos;
+    if (config->interrupts & DMA_FLAG_DME) cr |= DMA_SxCR_DMEIE;
+    if (config->interrupts & DMA_FLAG_TE) cr |= DMA_SxCR_TEIE;
+    if (config->interrupts & DMA_FLAG_HT) cr |= DMA_SxCR_HTIE;
+    if (config->interrupts & DMA_FLAG_TC) cr |= DMA_SxCR_TCIE;
+    WRITE_REG(regs->CR, cr);
+
+    uint32_t fcr = 0;
+    if (config->fifo) fcr |= DMA_SxFCR_DMDIS | DMA_FIFO_THRESHOLD_FULL;
+    if (config->interrupts & DMA_FLAG_FE) fcr |= DMA_SxFCR_FEIE;
+    WRITE_REG(regs->FCR, fcr);
+}
+
+/**
+ * Allocate the first free stream that serves the request
+ */
+int dma_claim(const dma_config_t* config, dma_stream_t** stream) {
+    if (config == NULL || stream == NULL || config->request >= DMA_REQUEST_COUNT ||
+        config->priority > DMA_PRIORITY_VERY_HIGH ||
+        (config->item_size != 1 && config->item_size != 2 && config->item_size != 4) ||
+        (config->periph_flow && config->circular) ||
+        (config->periph_burst && !config->fifo)) {
+        return DMA_ERROR_ARGUMENT;
+    }
+
+    const dma_route_t* route = NULL;
+    for (uint8_t i = 0; i < 2; i++) {
+        const dma_route_t* candidate = &dma_routes[config->request][i];
+        if (candidate->controller != 0 &&
+            !dma_claimed[candidate->controller - 1][candidate->stream]) {
+            route = candidate;
+            break;
+        }
+    }
+    if (route == NULL) {
+        return DMA_ERROR_CONFLICT;
+    }
+
+    SET_BIT(RCC->AHB1ENR, route->controller == 1 ? RCC_AHB1ENR_DMA1EN : RCC_AHB1ENR_DMA2EN);
+
+    dma_stream_t* s = &dma_streams[route->controller - 1][route->stream];
+    s->controller = route->controller;
+    s->stream = route->stream;
+    s->channel = route->channel;
+    s->config = *config;
+    s->transfers = 0;
+    s->fifo_errors = 0;
+    s->transfer_errors = 0;
+    dma_claimed[route->controller - 1][route->stream] = 1;
+
+    dma_stop(s);
+    dma_program(s, 1);
+    dma_clear_flags(s, DMA_FLAG_ALL);
+
+    if (config->interrupts) {
+        IRQn_Type irq = dma_stream_irqn[s->controller - 1][s->stream];
+        NVIC_SetPriority(irq, config->irq_priority);
+        NVIC_EnableIRQ(irq);
+    }
+
+    *stream = s;
+    return DMA_OK;
+}
+
+/**
+ * Stop the stream and free it
+ */
+void dma_release(dma_stream_t* stream) {
+    if (stream == NULL) return;
+
+    dma_stop(stream);
+    NVIC_DisableIRQ(dma_stream_irqn[stream->controller - 1][stream->stream]);
+    dma_claimed[stream->controller - 1][stream->stream] = 0;
+}
+
+/**
+ * Start a transfer
+ * An INCR4 burst must not cross a 1 KB boundary: bursts are used when the
+ * buffer is aligned to the burst size and holds whole bursts.
+ */
+void dma_start(dma_stream_t* stream, uint32_t periph_address, const void* memory, uint32_t items) {
+    DMA_Stream_TypeDef* regs = dma_regs(stream);
+    uint32_t burst_bytes = 4u * stream->config.item_size;
+    uint8_t memory_burst = ((uintptr_t)memory % burst_bytes) == 0 && (items % 4) == 0;
+
+    dma_stop(stream);
+    dma_program(stream, memory_burst);
+    dma_clear_flags(stream, DMA_FLAG_ALL);
+
+    WRITE_REG(regs->PAR, periph_address);
+    WRITE_REG(regs->M0AR, (uint32_t)(uintptr_t)memory);
+    WRITE_REG(regs->NDTR, items);
+
+    SET_BIT(regs->CR, DMA_SxCR_EN);
+}
+
+/**
+ * Disable the stream; EN reads 1 until the current beat has finished
+ */
+void dma_stop(dma_stream_t* stream) {
+    DMA_Stream_TypeDef* regs = dma_regs(stream);
+
+    CLEAR_BIT(regs->CR, DMA_SxCR_EN);
+    while (READ_BIT(regs->CR, DMA_SxCR_EN));
+}
+
+uint32_t dma_remaining(const dma_stream_t* stream) {
+    return READ_REG(dma_regs(stream)->NDTR);
+}
+
+void dma_irq_mask(dma_stream_t* stream, uint8_t masked) {
+    IRQn_Type irq = dma_stream_irqn[stream->controller - 1][stream->stream];
+
+    if (masked) {
+        NVIC_DisableIRQ(irq);
+    } else {
+        NVIC_EnableIRQ(irq);
+    }
+}
+
+/**
+ * Collect and clear the stream's flags (interrupt context)
+ * The flag registers are shared by four streams: only this stream's
+ * bits are written back (write-1-to-clear).
+ */
+uint32_t dma_irq_ack(dma_stream_t* stream) {
+    DMA_TypeDef* dma = dma_controller(stream);
+    uint32_t isr = stream->stream < 4 ? READ_REG(dma->LISR) : READ_REG(dma->HISR);
+    uint32_t flags = (isr >> dma_flag_shift(stream->stream)) & DMA_FLAG_ALL;
+
+    if (flags) {
+        dma_clear_flags(stream, flags);
+    }
+    if (flags & DMA_FLAG_TC) stream->transfers++;
+    if (flags & DMA_FLAG_FE) stream->fifo_errors++;
+    if (flags & DMA_FLAG_TE) stream->transfer_errors++;
+
+    return flags;
+}
+
+const dma_stream_t* dma_get_stream(uint8_t controller, uint8_t stream) {
+    if (controller < 1 || controller > 2 || stream > 7 || !dma_claimed[controller - 1][stream]) {
+        return NULL;
+    }
+    return &dma_streams[controller - 1][stream];
+}
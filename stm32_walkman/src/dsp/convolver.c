@@ -0,0 +1,266 @@
+/**
+ * Partitioned FFT Convolution - Implementation
+ *
+ * Scaling: the input block enters the FFT halved (the packed pair stays
+ * below 1.0), forward and inverse transforms each scale by 1/2B, and a
+ * partition spectrum carries its own exponent. shift[p][ch] folds all of
+ * that into each product so the accumulated spectrum is the true output
+ * spectrum / (2B * 2^CONVOLVER_HEADROOM); the inverse FFT then returns the
+ * output / 2^(log2n + CONVOLVER_HEADROOM), shifted back up per frame.
+ * A delay line slot is stored the same way as a partition, so its
+ * exponent adds to the shift of every product it enters.
+ */
+
+#include "convolver.h"
+#include <string.h>
+
+static int32_t convolver_tap_q31(float tap) {
+    float scaled = tap * (float)(1u << (31 - CONVOLVER_TAP_SHIFT));
+    const float limit = (float)(1u << (31 - CONVOLVER_TAP_SHIFT)) * 4.0f;
+    if (scaled > limit) scaled = limit;
+    if (scaled < -limit) scaled = -limit;
+    return (int32_t)scaled;
+}
+
+/**
+ * Bin k of the spectra of the two real signals packed as x = left + j right:
+ * L[k] = (X[k] + X*[n-k]) / 2, R[k] = (X[k] - X*[n-k]) / 2j
+ */
+static inline void convolver_split(const fft_q31_t* x, uint32_t n, uint32_t k,
+                                   fft_q31_t* left, fft_q31_t* right) {
+    const fft_q31_t* a = &x[k];
+    const fft_q31_t* b = &x[(n - k) & (n - 1)];
+    left->re = (a->re >> 1) + (b->re >> 1);
+    left->im = (a->im >> 1) - (b->im >> 1);
+    right->re = (a->im >> 1) + (b->im >> 1);
+    right->im = (b->re >> 1) - (a->re >> 1);
+}
+
+static inline uint32_t convolver_bits(const fft_q31_t* v) {
+    return ((v->re < 0) ? 0u - (uint32_t)v->re : (uint32_t)v->re) |
+           ((v->im < 0) ? 0u - (uint32_t)v->im : (uint32_t)v->im);
+}
+
+static inline convolver_coef_t convolver_coef(const fft_q31_t* v, uint32_t e) {
+    convolver_coef_t c = {
+        dsp_sat16((int32_t)((((int64_t)v->re << e) + 0x8000) >> 16)),
+        dsp_sat16((int32_t)((((int64_t)v->im << e) + 0x8000) >> 16)),
+    };
+    return c;
+}
+
+/**
+ * Split the packed spectrum x (n points) into bins 0..n/2 of each channel,
+ * stored as Q15 in groups of group bins, each scaled up by its exponent
+ * (e_left[g], e_right[g]) to its largest bin. Two passes over x (largest
+ * bins, then store) so no q31 copy of the halves is needed.
+ */
+static void convolver_store(const fft_q31_t* x, uint32_t n, uint32_t group,
+                            convolver_coef_t* left, convolver_coef_t* right,
+                            uint8_t* e_left, uint8_t* e_right) {
+    const uint32_t bins = n / 2 + 1, groups = (bins + group - 1) / group;
+    uint32_t bits[DSP_CHANNELS][CONVOLVER_GROUPS] = {{0}};
+    fft_q31_t l, r;
+
+    for (uint32_t k = 0; k < bins; k++) {
+        convolver_split(x, n, k, &l, &r);
+        bits[0][k / group] |= convolver_bits(&l);
+        bits[1][k / group] |= convolver_bits(&r);
+    }
+    for (uint32_t g = 0; g < groups; g++) {
+        uint32_t shift = 0;
+        while (shift < 30 && (bits[0][g] << shift) < 0x40000000u) shift++;
+        e_left[g] = (uint8_t)shift;
+        shift = 0;
+        while (shift < 30 && (bits[1][g] << shift) < 0x40000000u) shift++;
+        e_right[g] = (uint8_t)shift;
+    }
+
+    for (uint32_t k = 0; k < bins; k++) {
+        convolver_split(x, n, k, &l, &r);
+        left[k] = convolver_coef(&l, e_left[k / group]);
+        right[k] = convolver_coef(&r, e_right[k / group]);
+    }
+}
+
+/**
+ * Partition p from the taps staged in cv->in: transform, split, then
+ * store each channel as Q15 scaled up to its largest bin
+ */
+static void convolver_design(convolver_t* cv, uint32_t p) {
+    const uint32_t block = cv->block, n = 2 * block, bins = block + 1;
+    uint8_t e[DSP_CHANNELS];   // One group: the whole partition
+
+    for (uint32_t i = 0; i < n; i++) {
+        cv->work[i].re = (i < block) ? cv->in[i][0] : 0;
+        cv->work[i].im = (i < block) ? cv->in[i][1] : 0;
+    }
+    fft_q31(cv->work, cv->log2n, 0);
+
+    convolver_store(cv->work, n, bins, &cv->filter[0][p * bins], &cv->filter[1][p * bins],
+                    &e[0], &e[1]);
+    for (int ch = 0; ch < DSP_CHANNELS; ch++) {
+        cv->shift[p][ch] = (uint8_t)(14 + e[ch] + CONVOLVER_HEADROOM - cv->log2n - CONVOLVER_TAP_SHIFT);
+    }
+    cv->fill = 0;
+}
+
+void convolver_init(convolver_t* cv, convolver_coef_t* filter) {
+    memset(cv, 0, sizeof(*cv));
+    cv->filter[0] = filter;
+    cv->filter[1] = filter + CONVOLVER_MAX_BINS;
+}
+
+/**
+ * Pick the partition length: the smallest of 128..256 frames that needs
+ * no more than CONVOLVER_PARTITIONS partitions
+ */
+int convolver_begin(convolver_t* cv, uint32_t taps, uint32_t sample_rate) {
+    cv->ready = 0;
+    if (cv->filter[0] == NULL || taps == 0 || taps > CONVOLVER_MAX_TAPS) {
+        return CONVOLVER_ERROR;
+    }
+
+    uint32_t block = CONVOLVER_MIN_BLOCK;
+    while (block * CONVOLVER_PARTITIONS < taps && block < CONVOLVER_MAX_BLOCK) block <<= 1;
+
+    cv->sample_rate = sample_rate;
+    cv->taps = taps;
+    cv->block = block;
+    cv->log2n = 1;
+    while ((1u << cv->log2n) < 2 * block) cv->log2n++;
+    cv->partitions = (taps + block - 1) / block;
+    cv->loaded = 0;
+    cv->fill = 0;
+    fft_init();
+    return CONVOLVER_OK;
+}
+
+int convolver_load(convolver_t* cv, const float* taps, uint32_t frames, uint8_t channels) {
+    if (cv->ready || channels < 1 || channels > DSP_CHANNELS || cv->loaded + frames > cv->taps) {
+        return CONVOLVER_ERROR;
+    }
+
+    for (uint32_t i = 0; i < frames; i++) {
+        cv->in[cv->fill][0] = convolver_tap_q31(taps[i * channels]);
+        cv->in[cv->fill][1] = convolver_tap_q31(taps[i * channels + channels - 1]);
+        cv->loaded++;
+        if (++cv->fill == cv->block) {
+            convolver_design(cv, cv->loaded / cv->block - 1);
+        }
+    }
+    return CONVOLVER_OK;
+}
+
+int convolver_end(convolver_t* cv) {
+    if (cv->loaded != cv->taps || cv->taps == 0) {
+        return CONVOLVER_ERROR;
+    }
+    if (cv->fill > 0) {
+        memset(cv->in[cv->fill], 0, (cv->block - cv->fill) * sizeof(cv->in[0]));
+        convolver_design(cv, cv->loaded / cv->block);
+    }
+
+    cv->ready = 1;
+    convolver_reset(cv);
+    return CONVOLVER_OK;
+}
+
+void convolver_reset(convolver_t* cv) {
+    if (!cv->ready) {
+        return;
+    }
+    memset(cv->history, 0, sizeof(cv->history));
+    memset(cv->exponent, 0, sizeof(cv->exponent));
+    memset(cv->work, 0, sizeof(cv->work));
+    memset(cv->in, 0, sizeof(cv->in));
+    cv->fill = 0;
+    cv->slot = 0;
+}
+
+/**
+ * One block: transform the last 2B input frames, push the spectrum into
+ * the delay line, multiply-accumulate all partitions per bin, rebuild the
+ * packed output spectrum from the two half spectra and transform back.
+ * The last B points of cv->work are the output for the next B frames.
+ */
+static void convolver_block(convolver_t* cv) {
+    const uint32_t block = cv->block, n = 2 * block, bins = block + 1;
+    const uint32_t partitions = cv->partitions;
+    fft_q31_t* work = cv->work;
+
+    for (uint32_t i = 0; i < n; i++) {
+        work[i].re = cv->in[i][0] >> 1;
+        work[i].im = cv->in[i][1] >> 1;
+    }
+    memcpy(cv->in[0], cv->in[block], block * sizeof(cv->in[0]));
+    fft_q31(work, cv->log2n, 0);
+
+    cv->slot = (cv->slot == 0) ? partitions - 1 : cv->slot - 1;
+    convolver_store(work, n, CONVOLVER_GROUP_BINS,
+                    &cv->history[0][cv->slot * bins], &cv->history[1][cv->slot * bins],
+                    cv->exponent[cv->slot][0], cv->exponent[cv->slot][1]);
+
+    for (uint32_t k = 0, g = 0; k < bins; g++) {
+        const uint32_t end = (k + CONVOLVER_GROUP_BINS < bins) ? k + CONVOLVER_GROUP_BINS : bins;
+
+        /* Q15 x Q15 products, lifted to where a q31 delay line would put them */
+        uint8_t shift[CONVOLVER_PARTITIONS][DSP_CHANNELS];
+        for (uint32_t p = 0, s = cv->slot; p < partitions; p++) {
+            for (int ch = 0; ch < DSP_CHANNELS; ch++) {
+                uint32_t sum = cv->shift[p][ch] + cv->exponent[s][ch][g];
+                shift[p][ch] = (uint8_t)((sum > 63) ? 63 : sum);
+            }
+            if (++s == partitions) s = 0;
+        }
+
+        for (; k < end; k++) {
+            int64_t y[DSP_CHANNELS][2] = {{0, 0}, {0, 0}};
+
+            for (uint32_t p = 0, s = cv->slot; p < partitions; p++) {
+                for (int ch = 0; ch < DSP_CHANNELS; ch++) {
+                    const convolver_coef_t* x = &cv->history[ch][s * bins + k];
+                    const convolver_coef_t* h = &cv->filter[ch][p * bins + k];
+                    int64_t re = (int64_t)x->re * h->re - (int64_t)x->im * h->im;
+                    int64_t im = (int64_t)x->re * h->im + (int64_t)x->im * h->re;
+                    y[ch][0] += (re << 16) >> shift[p][ch];
+                    y[ch][1] += (im << 16) >> shift[p][ch];
+                }
+                if (++s == partitions) s = 0;
+            }
+
+            /* Z[k] = L[k] + j R[k], Z[n-k] = L*[k] + j R*[k] */
+            work[k].re = dsp_sat32(y[0][0] - y[1][1]);
+            work[k].im = dsp_sat32(y[0][1] + y[1][0]);
+            if (k > 0 && k < block) {
+                work[n - k].re = dsp_sat32(y[0][0] + y[1][1]);
+                work[n - k].im = dsp_sat32(y[1][0] - y[0][1]);
+            }
+        }
+    }
+
+    fft_q31(work, cv->log2n, 1);
+}
+
+void convolver_q31(convolver_t* cv, int32_t* buf, uint32_t frames) {
+    if (!cv->ready) {
+        return;
+    }
+
+    const uint32_t block = cv->block;
+    const uint32_t up = cv->log2n + CONVOLVER_HEADROOM;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        const fft_q31_t* y = &cv->work[block + cv->fill];
+        cv->in[block + cv->fill][0] = buf[0];
+        cv->in[block + cv->fill][1] = buf[1];
+        buf[0] = dsp_sat32((int64_t)y->re << up);
+        buf[1] = dsp_sat32((int64_t)y->im << up);
+        buf += DSP_CHANNELS;
+
+        if (++cv->fill == block) {
+            convolver_block(cv);
+            cv->fill = 0;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * Partitioned FFT Convolution
+ *
+ * Long FIR filters (headphone or room correction, up to
+ * CONVOLVER_MAX_TAPS per channel) on interleaved stereo q31, as a
+ * uniformly partitioned overlap-save convolver. The filter is cut into
+ * CONVOLVER_PARTITIONS or fewer partitions of B taps; each block of B
+ * input frames is transformed once (2B-point fft_q31, left and right
+ * packed as real and imaginary part) and its spectrum enters a frequency
+ * domain delay line. The output spectrum is the sum over partitions of
+ * delayed input spectra times partition spectra, transformed back once
+ * per block. B grows with the filter (128 to 256 frames), which keeps the
+ * partition count and with it the per-frame cost down; the output lags by
+ * B frames (convolver_latency).
+ *
+ * Filter spectra are Q15 with an exponent per partition and channel, the
+ * delay line Q15 with one per CONVOLVER_GROUP_BINS bins of each slot and
+ * channel. At CONVOLVER_MAX_TAPS that is 33KB of filter spectra, held
+ * in storage the caller hands to convolver_init (it may sit in another
+ * RAM region), and 41KB in convolver_t. Taps load in chunks
+ * (convolver_begin, _load, _end) so the whole filter never has to sit in
+ * memory as samples.
+ */
+
+#ifndef __CONVOLVER_H
+#define __CONVOLVER_H
+
+#include <stdint.h>
+#include "dsp.h"
+#include "fft.h"
+
+#define CONVOLVER_MAX_TAPS 4096
+#define CONVOLVER_PARTITIONS 16                         // At most
+#define CONVOLVER_MIN_BLOCK 128
+#define CONVOLVER_MAX_BLOCK (CONVOLVER_MAX_TAPS / CONVOLVER_PARTITIONS)   // Partition frames
+#define CONVOLVER_MAX_BINS (CONVOLVER_PARTITIONS * (CONVOLVER_MAX_BLOCK + 1))
+#define CONVOLVER_GROUP_BINS 16                         // Delay line bins per exponent
+#define CONVOLVER_GROUPS (CONVOLVER_MAX_BLOCK / CONVOLVER_GROUP_BINS + 1)
+#define CONVOLVER_FILTER_COEFS (DSP_CHANNELS * CONVOLVER_MAX_BINS)   // convolver_init storage
+#define CONVOLVER_TAP_SHIFT 3       // Taps up to +-4.0 (clipped beyond)
+#define CONVOLVER_HEADROOM 3        // Output bits kept free: up to +12 dB filter gain
+
+typedef enum {
+    CONVOLVER_OK = 0,
+    CONVOLVER_ERROR = 1
+} convolver_status_t;
+
+typedef struct {
+    int16_t re;
+    int16_t im;
+} convolver_coef_t;
+
+typedef struct {
+    uint32_t sample_rate;       // Rate the filter was designed for, 0 = any
+    uint32_t taps;              // Per channel
+    uint32_t block;             // Partition length B, frames
+    uint32_t log2n;             // FFT size 2B
+    uint32_t partitions;
+    uint32_t loaded;            // Partitions designed so far
+    uint32_t fill;              // Taps (loading) or input frames (running) in the block
+    uint32_t slot;              // Delay line slot of the newest input spectrum
+    uint8_t ready;              // Filter complete: convolver_q31 runs
+
+    uint8_t shift[CONVOLVER_PARTITIONS][DSP_CHANNELS];          // Product shift
+    uint8_t exponent[CONVOLVER_PARTITIONS][DSP_CHANNELS][CONVOLVER_GROUPS];  // Delay line
+    convolver_coef_t* filter[DSP_CHANNELS];                     // B + 1 bins per partition
+    convolver_coef_t history[DSP_CHANNELS][CONVOLVER_MAX_BINS]; // Delay line, same layout
+    fft_q31_t work[2 * CONVOLVER_MAX_BLOCK];                    // FFT; then the output block
+    int32_t in[2 * CONVOLVER_MAX_BLOCK][DSP_CHANNELS];          // Previous and current block
+} convolver_t;
+
+/* Bind the filter spectra to CONVOLVER_FILTER_COEFS coefficients of storage */
+void convolver_init(convolver_t* cv, convolver_coef_t* filter);
+
+/* Start a filter of taps frames per channel at sample_rate (0 = any rate) */
+int convolver_begin(convolver_t* cv, uint32_t taps, uint32_t sample_rate);
+
+/* Append frames of 1 (both ears) or 2 channels; CONVOLVER_ERROR past taps */
+int convolver_load(convolver_t* cv, const float* taps, uint32_t frames, uint8_t channels);
+
+/* Complete the filter and clear the delay line; CONVOLVER_ERROR if taps are missing */
+int convolver_end(convolver_t* cv);
+
+/* Clear the delay line (new track, seek) */
+void convolver_reset(convolver_t* cv);
+
+/* Frames of delay through convolver_q31 */
+static inline uint32_t convolver_latency(const convolver_t* cv) {
+    return cv->ready ? cv->block : 0;
+}
+
+/* Filter stereo q31 frames in place (no-op until a filter is complete) */
+void convolver_q31(convolver_t* cv, int32_t* buf, uint32_t frames);
+
+#endif /* __CONVOLVER_H */
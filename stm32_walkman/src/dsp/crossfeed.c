@@ -0,0 +1,118 @@
+/**
+ * Headphone Crossfeed - Implementation
+ */
+
+#include "crossfeed.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define CROSSFEED_LINE_MASK (CROSSFEED_LINE - 1)
+
+static const struct {
+    const char* name;
+    float cutoff_hz;
+    float feed_db;
+    float delay_us;
+} crossfeed_presets[CROSSFEED_PRESET_COUNT] = {
+    [CROSSFEED_OFF]    = {"off",    0.0f,   0.0f, 0.0f},
+    [CROSSFEED_LOW]    = {"low",    650.0f, 9.5f, 200.0f},
+    [CROSSFEED_MEDIUM] = {"medium", 700.0f, 6.0f, 250.0f},
+    [CROSSFEED_HIGH]   = {"high",   700.0f, 4.5f, 300.0f},
+};
+
+static int32_t crossfeed_q30(double v) {
+    return (int32_t)lrint(v * 1073741824.0);
+}
+
+/**
+ * Design the cross path for a preset and sample rate
+ *
+ * Bilinear first-order low-pass scaled by the cross gain g: the cross
+ * path sits feed_db below the direct path (1 - g) at low frequencies.
+ */
+int crossfeed_init(crossfeed_t* cf, crossfeed_preset_t preset, uint32_t sample_rate) {
+    if (preset >= CROSSFEED_PRESET_COUNT || sample_rate == 0) {
+        return CROSSFEED_ERROR;
+    }
+
+    memset(cf, 0, sizeof(*cf));
+    cf->preset = preset;
+    cf->sample_rate = sample_rate;
+    if (preset == CROSSFEED_OFF) {
+        return CROSSFEED_OK;
+    }
+
+    double ratio = pow(10.0, -crossfeed_presets[preset].feed_db / 20.0);
+    double g = ratio / (1.0 + ratio);
+    double k = tan(M_PI * crossfeed_presets[preset].cutoff_hz / sample_rate);
+    double delay = crossfeed_presets[preset].delay_us * 1e-6 * sample_rate;
+
+    if (delay + 1.0 >= CROSSFEED_LINE) {
+        return CROSSFEED_ERROR;
+    }
+    cf->b0 = cf->b1 = crossfeed_q30(g * k / (1.0 + k));
+    cf->a1 = crossfeed_q30((k - 1.0) / (k + 1.0));
+    cf->delay = (uint32_t)lrint(delay * 65536.0);
+    return CROSSFEED_OK;
+}
+
+void crossfeed_reset(crossfeed_t* cf) {
+    memset(cf->x1, 0, sizeof(cf->x1));
+    memset(cf->y1, 0, sizeof(cf->y1));
+    memset(cf->line, 0, sizeof(cf->line));
+    cf->write = 0;
+}
+
+const char* crossfeed_preset_name(crossfeed_preset_t preset) {
+    return (preset < CROSSFEED_PRESET_COUNT) ? crossfeed_presets[preset].name : "?";
+}
+
+/**
+ * Crossfeed stereo q31 frames in place
+ * 64-bit accumulator for the low-pass; the delayed cross signal is the
+ * linear interpolation of the two line taps around the delay (Q16 weight)
+ */
+void crossfeed_q31(crossfeed_t* cf, int32_t* buf, uint32_t frames) {
+    if (cf->preset == CROSSFEED_OFF) {
+        return;
+    }
+
+    const int32_t b0 = cf->b0, b1 = cf->b1, a1 = cf->a1;
+    const uint32_t tap = cf->delay >> 16;
+    const int32_t frac = (int32_t)(cf->delay & 0xFFFF);
+    int32_t xl1 = cf->x1[0], yl1 = cf->y1[0];
+    int32_t xr1 = cf->x1[1], yr1 = cf->y1[1];
+    int32_t* line_l = cf->line[0];
+    int32_t* line_r = cf->line[1];
+    uint32_t w = cf->write;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        int32_t xl = buf[0], xr = buf[1];
+
+        int32_t yl = (int32_t)(((int64_t)b0 * xl + (int64_t)b1 * xl1 - (int64_t)a1 * yl1) >> 30);
+        int32_t yr = (int32_t)(((int64_t)b0 * xr + (int64_t)b1 * xr1 - (int64_t)a1 * yr1) >> 30);
+        xl1 = xl; yl1 = yl;
+        xr1 = xr; yr1 = yr;
+
+        line_l[w] = yl;
+        line_r[w] = yr;
+        uint32_t near = (w - tap) & CROSSFEED_LINE_MASK;
+        uint32_t far = (near - 1) & CROSSFEED_LINE_MASK;
+        int32_t cl = line_l[near] + (int32_t)(((int64_t)(line_l[far] - line_l[near]) * frac) >> 16);
+        int32_t cr = line_r[near] + (int32_t)(((int64_t)(line_r[far] - line_r[near]) * frac) >> 16);
+        w = (w + 1) & CROSSFEED_LINE_MASK;
+
+        /* Each ear: own channel minus what crosses over, plus the other's */
+        buf[0] = dsp_sat32((int64_t)xl - cl + cr);
+        buf[1] = dsp_sat32((int64_t)xr - cr + cl);
+        buf += DSP_CHANNELS;
+    }
+
+    cf->x1[0] = xl1; cf->y1[0] = yl1;
+    cf->x1[1] = xr1; cf->y1[1] = yr1;
+    cf->write = w;
+}
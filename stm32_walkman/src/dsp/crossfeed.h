@@ -0,0 +1,55 @@
+/**
+ * Headphone Crossfeed
+ *
+ * Bauer-style stereo-to-binaural crossfeed for interleaved stereo q31:
+ * each ear also hears the other channel low-passed and delayed by an
+ * interaural time, the way speakers reach both ears. The direct path
+ * gives up what it sends across (x - D(LP(x)), a low shelf sharing the
+ * low-pass and delay line), so mono content passes unchanged and only
+ * the side signal is narrowed at low frequencies.
+ *
+ * Per channel one first-order section in Q2.30 and a fractional delay
+ * line read by linear interpolation; coefficients are designed with the
+ * FPU only when the preset or sample rate changes.
+ */
+
+#ifndef __CROSSFEED_H
+#define __CROSSFEED_H
+
+#include <stdint.h>
+#include "dsp.h"
+
+#define CROSSFEED_LINE 32          // Delay line frames per channel (power of 2)
+
+typedef enum {
+    CROSSFEED_OK = 0,
+    CROSSFEED_ERROR = 1
+} crossfeed_status_t;
+
+/* Strength presets: cut-off / feed level (cross below direct at LF) / delay */
+typedef enum {
+    CROSSFEED_OFF = 0,
+    CROSSFEED_LOW,             // 650 Hz, 9.5 dB, 200 us (Meier)
+    CROSSFEED_MEDIUM,          // 700 Hz, 6.0 dB, 250 us (Chu Moy)
+    CROSSFEED_HIGH,            // 700 Hz, 4.5 dB, 300 us (Bauer)
+    CROSSFEED_PRESET_COUNT
+} crossfeed_preset_t;
+
+typedef struct {
+    crossfeed_preset_t preset;
+    uint32_t sample_rate;
+    int32_t b0, b1, a1;        // Cross low-pass incl. feed gain, Q2.30
+    uint32_t delay;            // Interaural delay in frames, Q16.16
+    int32_t x1[DSP_CHANNELS], y1[DSP_CHANNELS];
+    int32_t line[DSP_CHANNELS][CROSSFEED_LINE];
+    uint32_t write;
+} crossfeed_t;
+
+int crossfeed_init(crossfeed_t* cf, crossfeed_preset_t preset, uint32_t sample_rate);
+void crossfeed_reset(crossfeed_t* cf);
+const char* crossfeed_preset_name(crossfeed_preset_t preset);
+
+/* Process stereo q31 frames in place; CROSSFEED_OFF passes them through */
+void crossfeed_q31(crossfeed_t* cf, int32_t* buf, uint32_t frames);
+
+#endif /* __CROSSFEED_H */
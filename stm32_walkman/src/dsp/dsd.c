@@ -0,0 +1,120 @@
+/**
+ * DSD to PCM - Implementation
+ *
+ * Each pass runs DSD_CHUNK frames of one channel through the stages, one
+ * stage at a time: a stage's input buffer holds the tail of its previous
+ * input followed by the new samples, so every filter window is a plain
+ * array slice.
+ */
+
+#include "dsd.h"
+#include "dsp.h"
+#include <string.h>
+
+void dsd_init(dsd_t* dsd, uint8_t lsb_first) {
+    dsd->lsb_first = lsb_first;
+    dsd->dither_seed = 1;
+    dsd_reset(dsd);
+}
+
+void dsd_reset(dsd_t* dsd) {
+    for (int c = 0; c < 2; c++) {
+        dsd_channel_t* ch = &dsd->ch[c];
+        memset(ch, 0, sizeof(*ch));
+        memset(ch->bytes, DSD_SILENCE, sizeof(ch->bytes));
+    }
+}
+
+/**
+ * Half-band decimation of 2 * outputs samples after len - 1 of history:
+ * 0.5 x the centre plus the symmetric pairs around it. Q28 data stays
+ * below 2^30 through every stage, so a pair adds in 32 bits and each tap
+ * is one SMLAL into the 64-bit accumulator.
+ */
+static void dsd_halfband(const int32_t* x, uint32_t outputs, const int32_t* coef, uint32_t taps,
+                         int32_t* out) {
+    const uint32_t centre = 2 * taps - 1;
+
+    for (uint32_t m = 0; m < outputs; m++) {
+        const int32_t* w = &x[2 * m + 1];
+        int64_t acc = ((int64_t)w[centre] << 30) + (1 << 30);
+        for (uint32_t i = 0; i < taps; i++) {
+            acc += (int64_t)coef[i] * (w[centre - 1 - 2 * i] + w[centre + 1 + 2 * i]);
+        }
+        out[m] = (int32_t)(acc >> 31);
+    }
+}
+
+/* One pass of frames (at most DSD_CHUNK) for one channel */
+static void dsd_pass(dsd_t* dsd, dsd_channel_t* ch, const uint8_t* in, uint32_t step,
+                     uint32_t frames, int32_t* out) {
+    const uint32_t n1 = frames * DSD_FRAME_BYTES;
+    uint8_t* bytes = dsd->bytes;
+
+    /* Bytes, MSB first, after the last DSD_FIR_BYTES - 1 of the previous pass */
+    memcpy(bytes, ch->bytes, sizeof(ch->bytes));
+    for (uint32_t k = 0; k < n1; k++) {
+        uint8_t b = in[k * step];
+        bytes[DSD_FIR_BYTES - 1 + k] = dsd->lsb_first ? dsd_bit_reverse[b] : b;
+    }
+    memcpy(ch->bytes, &bytes[n1], sizeof(ch->bytes));
+
+    /* Byte FIR, /8: table j holds the taps for the byte j back */
+    int32_t* x1 = dsd->x1;
+    memcpy(x1, ch->hist1, sizeof(ch->hist1));
+    for (uint32_t k = 0; k < n1; k++) {
+        const uint8_t* b = &bytes[DSD_FIR_BYTES - 1 + k];
+        int32_t sum = 0;
+        for (uint32_t j = 0; j < DSD_FIR_BYTES; j++) {
+            sum += dsd_fir_table[j][*(b - j)];
+        }
+        x1[DSD_HIST1 + k] = sum;
+    }
+    memcpy(ch->hist1, &x1[n1], sizeof(ch->hist1));
+
+    /* Half-bands, /2 each */
+    int32_t* x2 = dsd->x2;
+    memcpy(x2, ch->hist2, sizeof(ch->hist2));
+    dsd_halfband(x1, n1 / 2, dsd_hb1, DSD_HB1_TAPS, &x2[DSD_HIST2]);
+    memcpy(ch->hist2, &x2[n1 / 2], sizeof(ch->hist2));
+
+    int32_t* x3 = dsd->x3;
+    memcpy(x3, ch->hist3, sizeof(ch->hist3));
+    dsd_halfband(x2, n1 / 4, dsd_hb2, DSD_HB2_TAPS, &x3[DSD_HIST3]);
+    memcpy(ch->hist3, &x3[n1 / 4], sizeof(ch->hist3));
+
+    int32_t y[DSD_CHUNK];
+    dsd_halfband(x3, frames, dsd_hb3, DSD_HB3_TAPS, y);
+    for (uint32_t f = 0; f < frames; f++) {
+        out[2 * f] = dsp_sat32((int64_t)y[f] << 3);  /* Q28 -> q31 */
+    }
+}
+
+void dsd_to_q31(dsd_t* dsd, uint32_t channel, const uint8_t* in, uint32_t step,
+                uint32_t frames, int32_t* out) {
+    for (uint32_t done = 0; done < frames; ) {
+        uint32_t n = frames - done;
+        if (n > DSD_CHUNK) n = DSD_CHUNK;
+
+        dsd_pass(dsd, &dsd->ch[channel], &in[done * DSD_FRAME_BYTES * step], step, n, &out[2 * done]);
+        done += n;
+    }
+}
+
+void dsd_to_s16(dsd_t* dsd, uint32_t channel, const uint8_t* in, uint32_t step,
+                uint32_t frames, int16_t* out) {
+    int32_t q31[DSD_CHUNK * 2];
+    int16_t s16[DSD_CHUNK];
+
+    for (uint32_t done = 0; done < frames; ) {
+        uint32_t n = frames - done;
+        if (n > DSD_CHUNK) n = DSD_CHUNK;
+
+        /* Every other slot is unused: dither the filled ones only */
+        dsd_pass(dsd, &dsd->ch[channel], &in[done * DSD_FRAME_BYTES * step], step, n, q31);
+        for (uint32_t i = 0; i < n; i++) q31[i] = q31[2 * i];
+        dsp_dither_q31_to_s16(q31, s16, n, &dsd->dither_seed);
+        for (uint32_t i = 0; i < n; i++) out[2 * (done + i)] = s16[i];
+        done += n;
+    }
+}
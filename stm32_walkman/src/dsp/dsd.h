@@ -0,0 +1,84 @@
+/**
+ * DSD to PCM
+ *
+ * Decimates DSD64 (1-bit, 2.8224 MHz) by 64 to 44.1 kHz q31. The first
+ * stage is a 64-tap FIR evaluated a byte at a time: each input byte
+ * selects a precomputed partial sum (its 8 bits as +-1 times 8 taps), so
+ * one output at 352.8 kHz costs DSD_FIR_BYTES table lookups and adds and
+ * no per-bit work. Three half-band stages (every other tap zero, the
+ * rest symmetric) follow at 352.8, 176.4 and 88.2 kHz. The tables are
+ * const, generated offline (tools/dsd_table.py).
+ *
+ * Level: a constant +1 bit stream is q31 full scale, so the SACD 0 dB
+ * reference (50 % modulation) plays at -6 dBFS and the 70 % peaks the
+ * format allows still fit.
+ */
+
+#ifndef __DSD_H
+#define __DSD_H
+
+#include <stdint.h>
+
+#define DSD64_RATE 2822400
+#define DSD_PCM_RATE 44100
+#define DSD_DECIMATION (DSD64_RATE / DSD_PCM_RATE)     // Bits per channel per frame
+#define DSD_FRAME_BYTES (DSD_DECIMATION / 8)            // Bytes per channel per frame
+#define DSD_FIR_BYTES 8                                 // 64-tap byte FIR
+#define DSD_HB1_TAPS 6              // Non-zero side taps of each half-band
+#define DSD_HB2_TAPS 7
+#define DSD_HB3_TAPS 35
+#define DSD_HB_LEN(taps) (4 * (taps) - 1)
+#define DSD_SILENCE 0x69            // Idle pattern: as many ones as zeros
+
+/* dsd_table.c (generated) */
+extern const int32_t dsd_fir_table[DSD_FIR_BYTES][256];
+extern const int32_t dsd_hb1[DSD_HB1_TAPS];
+extern const int32_t dsd_hb2[DSD_HB2_TAPS];
+extern const int32_t dsd_hb3[DSD_HB3_TAPS];
+extern const uint8_t dsd_bit_reverse[256];
+
+#define DSD_CHUNK 32                // Frames per pass through the stages
+#define DSD_HIST1 (DSD_HB_LEN(DSD_HB1_TAPS) - 1)
+#define DSD_HIST2 (DSD_HB_LEN(DSD_HB2_TAPS) - 1)
+#define DSD_HIST3 (DSD_HB_LEN(DSD_HB3_TAPS) - 1)
+
+/* What each stage keeps of its input between passes */
+typedef struct {
+    uint8_t bytes[DSD_FIR_BYTES - 1];
+    int32_t hist1[DSD_HIST1];
+    int32_t hist2[DSD_HIST2];
+    int32_t hist3[DSD_HIST3];
+} dsd_channel_t;
+
+typedef struct {
+    uint8_t lsb_first;          // Bit order of the input bytes (DSF)
+    uint32_t dither_seed;
+    dsd_channel_t ch[2];
+
+    /* Stage inputs of one pass, history first (shared by the channels) */
+    uint8_t bytes[DSD_FIR_BYTES - 1 + DSD_CHUNK * DSD_FRAME_BYTES];
+    int32_t x1[DSD_HIST1 + DSD_CHUNK * DSD_FRAME_BYTES];           // 352.8 kHz
+    int32_t x2[DSD_HIST2 + DSD_CHUNK * DSD_FRAME_BYTES / 2];       // 176.4 kHz
+    int32_t x3[DSD_HIST3 + DSD_CHUNK * DSD_FRAME_BYTES / 4];       // 88.2 kHz
+} dsd_t;
+
+void dsd_init(dsd_t* dsd, uint8_t lsb_first);
+
+/* Back to silence (new stream, seek) */
+void dsd_reset(dsd_t* dsd);
+
+/**
+ * Decimate one channel: frames samples from DSD_FRAME_BYTES input bytes
+ * each, consecutive bytes of the channel step bytes apart (1 for planar
+ * blocks, the channel count for byte-interleaved data). Samples are
+ * written two apart, into the channel's slot of stereo frames, so the
+ * channels of planar data can be filled one after the other.
+ */
+void dsd_to_q31(dsd_t* dsd, uint32_t channel, const uint8_t* in, uint32_t step,
+                uint32_t frames, int32_t* out);
+
+/* As dsd_to_q31, requantized to s16 with TPDF dither */
+void dsd_to_s16(dsd_t* dsd, uint32_t channel, const uint8_t* in, uint32_t step,
+                uint32_t frames, int16_t* out);
+
+#endif /* __DSD_H */
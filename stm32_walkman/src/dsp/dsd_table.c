@@ -0,0 +1,323 @@
+/**
+ * DSD to PCM - Filter Tables
+ * Generated by tools/dsd_table.py (make dsd-table), do not edit
+ */
+
+#include "dsd.h"
+
+/* Byte j back (0 = newest), bits MSB first: sum of +-taps in Q28 */
+const int32_t dsd_fir_table[DSD_FIR_BYTES][256] = {
+    {
+        -83318, -83573, -84312, -84567, -85029, -85283, -86023, -86278,
+        -84195, -84449, -85189, -85444, -85905, -86160, -86900, -87154,
+        -78702, -78956, -79696, -79950, -80412, -80667, -81407, -81661,
+        -79578, -79833, -80573, -80827, -81289, -81543, -82283, -82538,
+        -63842, -64096, -64836, -65091, -65553, -65807, -66547, -66802,
+        -64719, -64973, -65713, -65967, -66429, -66684, -67424, -67678,
+        -59225, -59480, -60220, -60474, -60936, -61191, -61931, -62185,
+        -60102, -60356, -61096, -61351, -61813, -62067, -62807, -63062,
+        -34229, -34483, -35223, -35477, -35939, -36194, -36934, -37188,
+        -35105, -35360, -36100, -36354, -36816, -37070, -37810, -38065,
+        -29612, -29867, -30606, -30861, -31323, -31577, -32317, -32572,
+        -30489, -30743, -31483, -31738, -32199, -32454, -33194, -33448,
+        -14752, -15007, -15747, -16001, -16463, -16718, -17458, -17712,
+        -15629, -15884, -16623, -16878, -17340, -17594, -18334, -18589,
+        -10136, -10390, -11130, -11385, -11847, -12101, -12841, -13096,
+        -11013, -11267, -12007, -12261, -12723, -12978, -13718, -13972,
+        13972, 13718, 12978, 12723, 12261, 12007, 11267, 11013,
+        13096, 12841, 12101, 11847, 11385, 11130, 10390, 10136,
+        18589, 18334, 17594, 17340, 16878, 16623, 15884, 15629,
+        17712, 17458, 16718, 16463, 16001, 15747, 15007, 14752,
+        33448, 33194, 32454, 32199, 31738, 31483, 30743, 30489,
+        32572, 32317, 31577, 31323, 30861, 30606, 29867, 29612,
+        38065, 37810, 37070, 36816, 36354, 36100, 35360, 35105,
+        37188, 36934, 36194, 35939, 35477, 35223, 34483, 34229,
+        63062, 62807, 62067, 61813, 61351, 61096, 60356, 60102,
+        62185, 61931, 61191, 60936, 60474, 60220, 59480, 59225,
+        67678, 67424, 66684, 66429, 65967, 65713, 64973, 64719,
+        66802, 66547, 65807, 65553, 65091, 64836, 64096, 63842,
+        82538, 82283, 81543, 81289, 80827, 80573, 79833, 79578,
+        81661, 81407, 80667, 80412, 79950, 79696, 78956, 78702,
+        87154, 86900, 86160, 85905, 85444, 85189, 84449, 84195,
+        86278, 86023, 85283, 85029, 84567, 84312, 83573, 83318,
+    },
+    {
+        450351, 613127, 685051, 847826, 739023, 901798, 973722, 1136497,
+        735318, 898093, 970017, 1132793, 1023990, 1186765, 1258689, 1421464,
+        621365, 784141, 856065, 1018840, 910037, 1072812, 1144736, 1307511,
+        906332, 1069107, 1141031, 1303807, 1195004, 1357779, 1429703, 1592478,
+        340217, 502992, 574916, 737691, 628889, 791664, 863588, 1026363,
+        625184, 787959, 859883, 1022658, 913856, 1076631, 1148555, 1311330,
+        511231, 674006, 745930, 908705, 799903, 962678, 1034602, 1197377,
+        796198, 958973, 1030897, 1193672, 1084870, 1247645, 1319569, 1482344,
+        -154399, 8376, 80300, 243076, 134273, 297048, 368972, 531747,
+        130568, 293343, 365267, 528043, 419240, 582015, 653939, 816714,
+        16615, 179390, 251315, 414090, 305287, 468062, 539986, 702761,
+        301582, 464357, 536281, 699057, 590254, 753029, 824953, 987728,
+        -264533, -101758, -29834, 132941, 24139, 186914, 258838, 421613,
+        20434, 183209, 255133, 417908, 309106, 471881, 543805, 706580,
+        -93519, 69256, 141180, 303955, 195153, 357928, 429852, 592627,
+        191448, 354223, 426147, 588922, 480120, 642895, 714819, 877594,
+        -877594, -714819, -642895, -480120, -588922, -426147, -354223, -191448,
+        -592627, -429852, -357928, -195153, -303955, -141180, -69256, 93519,
+        -706580, -543805, -471881, -309106, -417908, -255133, -183209, -20434,
+        -421613, -258838, -186914, -24139, -132941, 29834, 101758, 264533,
+        -987728, -824953, -753029, -590254, -699057, -536281, -464357, -301582,
+        -702761, -539986, -468062, -305287, -414090, -251315, -179390, -16615,
+        -816714, -653939, -582015, -419240, -528043, -365267, -293343, -130568,
+        -531747, -368972, -297048, -134273, -243076, -80300, -8376, 154399,
+        -1482344, -1319569, -1247645, -1084870, -1193672, -1030897, -958973, -796198,
+        -1197377, -1034602, -962678, -799903, -908705, -745930, -674006, -511231,
+        -1311330, -1148555, -1076631, -913856, -1022658, -859883, -787959, -625184,
+        -1026363, -863588, -791664, -628889, -737691, -574916, -502992, -340217,
+        -1592478, -1429703, -1357779, -1195004, -1303807, -1141031, -1069107, -906332,
+        -1307511, -1144736, -1072812, -910037, -1018840, -856065, -784141, -621365,
+        -1421464, -1258689, -1186765, -1023990, -1132793, -970017, -898093, -735318,
+        -1136497, -973722, -901798, -739023, -847826, -685051, -613127, -450351,
+    },
+    {
+        8951547, 6710547, 5719895, 3478895, 4847964, 2606964, 1616311, -624689,
+        4370544, 2129544, 1138891, -1102109, 266960, -1974040, -2964693, -5205692,
+        4619272, 2378272, 1387619, -853381, 515688, -1725312, -2715965, -4956964,
+        38268, -2202731, -3193384, -5434384, -4065315, -6306315, -7296968, -9537968,
+        5938606, 3697606, 2706953, 465954, 1835022, -405978, -1396630, -3637630,
+        1357603, -883397, -1874050, -4115050, -2745981, -4986981, -5977634, -8218634,
+        1606331, -634669, -1625322, -3866322, -2497253, -4738253, -5728906, -7969906,
+        -2974673, -5215673, -6206325, -8447325, -7078256, -9319256, -10309909, -12550909,
+        8627563, 6386563, 5395911, 3154911, 4523980, 2282980, 1292327, -948673,
+        4046560, 1805560, 814907, -1426093, -57024, -2298024, -3288676, -5529676,
+        4295288, 2054288, 1063635, -1177365, 191704, -2049296, -3039949, -5280948,
+        -285715, -2526715, -3517368, -5758368, -4389299, -6630299, -7620952, -9861952,
+        5614622, 3373622, 2382969, 141970, 1511038, -729961, -1720614, -3961614,
+        1033619, -1207381, -2198034, -4439034, -3069965, -5310965, -6301618, -8542618,
+        1282347, -958653, -1949306, -4190306, -2821237, -5062237, -6052890, -8293890,
+        -3298657, -5539657, -6530309, -8771309, -7402240, -9643240, -10633893, -12874893,
+        12874893, 10633893, 9643240, 7402240, 8771309, 6530309, 5539657, 3298657,
+        8293890, 6052890, 5062237, 2821237, 4190306, 1949306, 958653, -1282347,
+        8542618, 6301618, 5310965, 3069965, 4439034, 2198034, 1207381, -1033619,
+        3961614, 1720614, 729961, -1511038, -141970, -2382969, -3373622, -5614622,
+        9861952, 7620952, 6630299, 4389299, 5758368, 3517368, 2526715, 285715,
+        5280948, 3039949, 2049296, -191704, 1177365, -1063635, -2054288, -4295288,
+        5529676, 3288676, 2298024, 57024, 1426093, -814907, -1805560, -4046560,
+        948673, -1292327, -2282980, -4523980, -3154911, -5395911, -6386563, -8627563,
+        12550909, 10309909, 9319256, 7078256, 8447325, 6206325, 5215673, 2974673,
+        7969906, 5728906, 4738253, 2497253, 3866322, 1625322, 634669, -1606331,
+        8218634, 5977634, 4986981, 2745981, 4115050, 1874050, 883397, -1357603,
+        3637630, 1396630, 405978, -1835022, -465954, -2706953, -3697606, -5938606,
+        9537968, 7296968, 6306315, 4065315, 5434384, 3193384, 2202731, -38268,
+        4956964, 2715965, 1725312, -515688, 853381, -1387619, -2378272, -4619272,
+        5205692, 2964693, 1974040, -266960, 1102109, -1138891, -2129544, -4370544,
+        624689, -1616311, -2606964, -4847964, -3478895, -5719895, -6710547, -8951547,
+    },
+    {
+        -143536309, -133788146, -126577151, -116828989, -118392560, -108644398, -101433403, -91685240,
+        -109842421, -100094258, -92883263, -83135101, -84698672, -74950510, -67739514, -57991352,
+        -101667768, -91919605, -84708610, -74960448, -76524019, -66775857, -59564862, -49816699,
+        -67973880, -58225717, -51014722, -41266560, -42830131, -33081969, -25870974, -16122811,
+        -94650983, -84902820, -77691825, -67943663, -69507234, -59759072, -52548077, -42799914,
+        -60957095, -51208932, -43997937, -34249775, -35813346, -26065184, -18854189, -9106026,
+        -52782442, -43034280, -35823284, -26075122, -27638693, -17890531, -10679536, -931373,
+        -19088554, -9340391, -2129396, 7618766, 6055195, 15803357, 23014352, 32762515,
+        -89509042, -79760879, -72549884, -62801722, -64365293, -54617131, -47406136, -37657973,
+        -55815153, -46066991, -38855996, -29107834, -30671405, -20923243, -13712247, -3964085,
+        -47640501, -37892338, -30681343, -20933181, -22496752, -12748590, -5537595, 4210568,
+        -13946613, -4198450, 3012545, 12760707, 11197136, 20945298, 28156293, 37904456,
+        -40623716, -30875553, -23664558, -13916396, -15479967, -5731805, 1479190, 11227353,
+        -6929828, 2818335, 10029330, 19777492, 18213921, 27962083, 35173078, 44921241,
+        1244825, 10992988, 18203983, 27952145, 26388574, 36136736, 43347731, 53095894,
+        34938713, 44686876, 51897871, 61646033, 60082462, 69830624, 77041619, 86789782,
+        -86789782, -77041619, -69830624, -60082462, -61646033, -51897871, -44686876, -34938713,
+        -53095894, -43347731, -36136736, -26388574, -27952145, -18203983, -10992988, -1244825,
+        -44921241, -35173078, -27962083, -18213921, -19777492, -10029330, -2818335, 6929828,
+        -11227353, -1479190, 5731805, 15479967, 13916396, 23664558, 30875553, 40623716,
+        -37904456, -28156293, -20945298, -11197136, -12760707, -3012545, 4198450, 13946613,
+        -4210568, 5537595, 12748590, 22496752, 20933181, 30681343, 37892338, 47640501,
+        3964085, 13712247, 20923243, 30671405, 29107834, 38855996, 46066991, 55815153,
+        37657973, 47406136, 54617131, 64365293, 62801722, 72549884, 79760879, 89509042,
+        -32762515, -23014352, -15803357, -6055195, -7618766, 2129396, 9340391, 19088554,
+        931373, 10679536, 17890531, 27638693, 26075122, 35823284, 43034280, 52782442,
+        9106026, 18854189, 26065184, 35813346, 34249775, 43997937, 51208932, 60957095,
+        42799914, 52548077, 59759072, 69507234, 67943663, 77691825, 84902820, 94650983,
+        16122811, 25870974, 33081969, 42830131, 41266560, 51014722, 58225717, 67973880,
+        49816699, 59564862, 66775857, 76524019, 74960448, 84708610, 91919605, 101667768,
+        57991352, 67739514, 74950510, 84698672, 83135101, 92883263, 100094258, 109842421,
+        91685240, 101433403, 108644398, 118392560, 116828989, 126577151, 133788146, 143536309,
+    },
+    {
+        -143536309, -86789782, -89509042, -32762515, -94650983, -37904456, -40623716, 16122811,
+        -101667768, -44921241, -47640501, 9106026, -52782442, 3964085, 1244825, 57991352,
+        -109842421, -53095894, -55815153, 931373, -60957095, -4210568, -6929828, 49816699,
+        -67973880, -11227353, -13946613, 42799914, -19088554, 37657973, 34938713, 91685240,
+        -118392560, -61646033, -64365293, -7618766, -69507234, -12760707, -15479967, 41266560,
+        -76524019, -19777492, -22496752, 34249775, -27638693, 29107834, 26388574, 83135101,
+        -84698672, -27952145, -30671405, 26075122, -35813346, 20933181, 18213921, 74960448,
+        -42830131, 13916396, 11197136, 67943663, 6055195, 62801722, 60082462, 116828989,
+        -126577151, -69830624, -72549884, -15803357, -77691825, -20945298, -23664558, 33081969,
+        -84708610, -27962083, -30681343, 26065184, -35823284, 20923243, 18203983, 74950510,
+        -92883263, -36136736, -38855996, 17890531, -43997937, 12748590, 10029330, 66775857,
+        -51014722, 5731805, 3012545, 59759072, -2129396, 54617131, 51897871, 108644398,
+        -101433403, -44686876, -47406136, 9340391, -52548077, 4198450, 1479190, 58225717,
+        -59564862, -2818335, -5537595, 51208932, -10679536, 46066991, 43347731, 100094258,
+        -67739514, -10992988, -13712247, 43034280, -18854189, 37892338, 35173078, 91919605,
+        -25870974, 30875553, 28156293, 84902820, 23014352, 79760879, 77041619, 133788146,
+        -133788146, -77041619, -79760879, -23014352, -84902820, -28156293, -30875553, 25870974,
+        -91919605, -35173078, -37892338, 18854189, -43034280, 13712247, 10992988, 67739514,
+        -100094258, -43347731, -46066991, 10679536, -51208932, 5537595, 2818335, 59564862,
+        -58225717, -1479190, -4198450, 52548077, -9340391, 47406136, 44686876, 101433403,
+        -108644398, -51897871, -54617131, 2129396, -59759072, -3012545, -5731805, 51014722,
+        -66775857, -10029330, -12748590, 43997937, -17890531, 38855996, 36136736, 92883263,
+        -74950510, -18203983, -20923243, 35823284, -26065184, 30681343, 27962083, 84708610,
+        -33081969, 23664558, 20945298, 77691825, 15803357, 72549884, 69830624, 126577151,
+        -116828989, -60082462, -62801722, -6055195, -67943663, -11197136, -13916396, 42830131,
+        -74960448, -18213921, -20933181, 35813346, -26075122, 30671405, 27952145, 84698672,
+        -83135101, -26388574, -29107834, 27638693, -34249775, 22496752, 19777492, 76524019,
+        -41266560, 15479967, 12760707, 69507234, 7618766, 64365293, 61646033, 118392560,
+        -91685240, -34938713, -37657973, 19088554, -42799914, 13946613, 11227353, 67973880,
+        -49816699, 6929828, 4210568, 60957095, -931373, 55815153, 53095894, 109842421,
+        -57991352, -1244825, -3964085, 52782442, -9106026, 47640501, 44921241, 101667768,
+        -16122811, 40623716, 37904456, 94650983, 32762515, 89509042, 86789782, 143536309,
+    },
+    {
+        8951547, 12874893, 8627563, 12550909, 5938606, 9861952, 5614622, 9537968,
+        4619272, 8542618, 4295288, 8218634, 1606331, 5529676, 1282347, 5205692,
+        4370544, 8293890, 4046560, 7969906, 1357603, 5280948, 1033619, 4956964,
+        38268, 3961614, -285715, 3637630, -2974673, 948673, -3298657, 624689,
+        4847964, 8771309, 4523980, 8447325, 1835022, 5758368, 1511038, 5434384,
+        515688, 4439034, 191704, 4115050, -2497253, 1426093, -2821237, 1102109,
+        266960, 4190306, -57024, 3866322, -2745981, 1177365, -3069965, 853381,
+        -4065315, -141970, -4389299, -465954, -7078256, -3154911, -7402240, -3478895,
+        5719895, 9643240, 5395911, 9319256, 2706953, 6630299, 2382969, 6306315,
+        1387619, 5310965, 1063635, 4986981, -1625322, 2298024, -1949306, 1974040,
+        1138891, 5062237, 814907, 4738253, -1874050, 2049296, -2198034, 1725312,
+        -3193384, 729961, -3517368, 405978, -6206325, -2282980, -6530309, -2606964,
+        1616311, 5539657, 1292327, 5215673, -1396630, 2526715, -1720614, 2202731,
+        -2715965, 1207381, -3039949, 883397, -5728906, -1805560, -6052890, -2129544,
+        -2964693, 958653, -3288676, 634669, -5977634, -2054288, -6301618, -2378272,
+        -7296968, -3373622, -7620952, -3697606, -10309909, -6386563, -10633893, -6710547,
+        6710547, 10633893, 6386563, 10309909, 3697606, 7620952, 3373622, 7296968,
+        2378272, 6301618, 2054288, 5977634, -634669, 3288676, -958653, 2964693,
+        2129544, 6052890, 1805560, 5728906, -883397, 3039949, -1207381, 2715965,
+        -2202731, 1720614, -2526715, 1396630, -5215673, -1292327, -5539657, -1616311,
+        2606964, 6530309, 2282980, 6206325, -405978, 3517368, -729961, 3193384,
+        -1725312, 2198034, -2049296, 1874050, -4738253, -814907, -5062237, -1138891,
+        -1974040, 1949306, -2298024, 1625322, -4986981, -1063635, -5310965, -1387619,
+        -6306315, -2382969, -6630299, -2706953, -9319256, -5395911, -9643240, -5719895,
+        3478895, 7402240, 3154911, 7078256, 465954, 4389299, 141970, 4065315,
+        -853381, 3069965, -1177365, 2745981, -3866322, 57024, -4190306, -266960,
+        -1102109, 2821237, -1426093, 2497253, -4115050, -191704, -4439034, -515688,
+        -5434384, -1511038, -5758368, -1835022, -8447325, -4523980, -8771309, -4847964,
+        -624689, 3298657, -948673, 2974673, -3637630, 285715, -3961614, -38268,
+        -4956964, -1033619, -5280948, -1357603, -7969906, -4046560, -8293890, -4370544,
+        -5205692, -1282347, -5529676, -1606331, -8218634, -4295288, -8542618, -4619272,
+        -9537968, -5614622, -9861952, -5938606, -12550909, -8627563, -12874893, -8951547,
+    },
+    {
+        450351, -877594, -154399, -1482344, 340217, -987728, -264533, -1592478,
+        621365, -706580, 16615, -1311330, 511231, -816714, -93519, -1421464,
+        735318, -592627, 130568, -1197377, 625184, -702761, 20434, -1307511,
+        906332, -421613, 301582, -1026363, 796198, -531747, 191448, -1136497,
+        739023, -588922, 134273, -1193672, 628889, -699057, 24139, -1303807,
+        910037, -417908, 305287, -1022658, 799903, -528043, 195153, -1132793,
+        1023990, -303955, 419240, -908705, 913856, -414090, 309106, -1018840,
+        1195004, -132941, 590254, -737691, 1084870, -243076, 480120, -847826,
+        685051, -642895, 80300, -1247645, 574916, -753029, -29834, -1357779,
+        856065, -471881, 251315, -1076631, 745930, -582015, 141180, -1186765,
+        970017, -357928, 365267, -962678, 859883, -468062, 255133, -1072812,
+        1141031, -186914, 536281, -791664, 1030897, -297048, 426147, -901798,
+        973722, -354223, 368972, -958973, 863588, -464357, 258838, -1069107,
+        1144736, -183209, 539986, -787959, 1034602, -293343, 429852, -898093,
+        1258689, -69256, 653939, -674006, 1148555, -179390, 543805, -784141,
+        1429703, 101758, 824953, -502992, 1319569, -8376, 714819, -613127,
+        613127, -714819, 8376, -1319569, 502992, -824953, -101758, -1429703,
+        784141, -543805, 179390, -1148555, 674006, -653939, 69256, -1258689,
+        898093, -429852, 293343, -1034602, 787959, -539986, 183209, -1144736,
+        1069107, -258838, 464357, -863588, 958973, -368972, 354223, -973722,
+        901798, -426147, 297048, -1030897, 791664, -536281, 186914, -1141031,
+        1072812, -255133, 468062, -859883, 962678, -365267, 357928, -970017,
+        1186765, -141180, 582015, -745930, 1076631, -251315, 471881, -856065,
+        1357779, 29834, 753029, -574916, 1247645, -80300, 642895, -685051,
+        847826, -480120, 243076, -1084870, 737691, -590254, 132941, -1195004,
+        1018840, -309106, 414090, -913856, 908705, -419240, 303955, -1023990,
+        1132793, -195153, 528043, -799903, 1022658, -305287, 417908, -910037,
+        1303807, -24139, 699057, -628889, 1193672, -134273, 588922, -739023,
+        1136497, -191448, 531747, -796198, 1026363, -301582, 421613, -906332,
+        1307511, -20434, 702761, -625184, 1197377, -130568, 592627, -735318,
+        1421464, 93519, 816714, -511231, 1311330, -16615, 706580, -621365,
+        1592478, 264533, 987728, -340217, 1482344, 154399, 877594, -450351,
+    },
+    {
+        -83318, 13972, -34229, 63062, -63842, 33448, -14752, 82538,
+        -78702, 18589, -29612, 67678, -59225, 38065, -10136, 87154,
+        -84195, 13096, -35105, 62185, -64719, 32572, -15629, 81661,
+        -79578, 17712, -30489, 66802, -60102, 37188, -11013, 86278,
+        -85029, 12261, -35939, 61351, -65553, 31738, -16463, 80827,
+        -80412, 16878, -31323, 65967, -60936, 36354, -11847, 85444,
+        -85905, 11385, -36816, 60474, -66429, 30861, -17340, 79950,
+        -81289, 16001, -32199, 65091, -61813, 35477, -12723, 84567,
+        -84312, 12978, -35223, 62067, -64836, 32454, -15747, 81543,
+        -79696, 17594, -30606, 66684, -60220, 37070, -11130, 86160,
+        -85189, 12101, -36100, 61191, -65713, 31577, -16623, 80667,
+        -80573, 16718, -31483, 65807, -61096, 36194, -12007, 85283,
+        -86023, 11267, -36934, 60356, -66547, 30743, -17458, 79833,
+        -81407, 15884, -32317, 64973, -61931, 35360, -12841, 84449,
+        -86900, 10390, -37810, 59480, -67424, 29867, -18334, 78956,
+        -82283, 15007, -33194, 64096, -62807, 34483, -13718, 83573,
+        -83573, 13718, -34483, 62807, -64096, 33194, -15007, 82283,
+        -78956, 18334, -29867, 67424, -59480, 37810, -10390, 86900,
+        -84449, 12841, -35360, 61931, -64973, 32317, -15884, 81407,
+        -79833, 17458, -30743, 66547, -60356, 36934, -11267, 86023,
+        -85283, 12007, -36194, 61096, -65807, 31483, -16718, 80573,
+        -80667, 16623, -31577, 65713, -61191, 36100, -12101, 85189,
+        -86160, 11130, -37070, 60220, -66684, 30606, -17594, 79696,
+        -81543, 15747, -32454, 64836, -62067, 35223, -12978, 84312,
+        -84567, 12723, -35477, 61813, -65091, 32199, -16001, 81289,
+        -79950, 17340, -30861, 66429, -60474, 36816, -11385, 85905,
+        -85444, 11847, -36354, 60936, -65967, 31323, -16878, 80412,
+        -80827, 16463, -31738, 65553, -61351, 35939, -12261, 85029,
+        -86278, 11013, -37188, 60102, -66802, 30489, -17712, 79578,
+        -81661, 15629, -32572, 64719, -62185, 35105, -13096, 84195,
+        -87154, 10136, -38065, 59225, -67678, 29612, -18589, 78702,
+        -82538, 14752, -33448, 63842, -63062, 34229, -13972, 83318,
+    },
+};
+
+/* Half-band 1: 23 taps, Kaiser beta 10.50 */
+const int32_t dsd_hb1[DSD_HB1_TAPS] = {
+    655880089, -156103656, 46061840, -10122766, 1166738, -13726,
+};
+
+/* Half-band 2: 27 taps, Kaiser beta 10.00 */
+const int32_t dsd_hb2[DSD_HB2_TAPS] = {
+    664623200, -176420054, 66012928, -22112980, 5555639, -807839,
+    18674,
+};
+
+/* Half-band 3: 139 taps, Kaiser beta 10.06 */
+const int32_t dsd_hb3[DSD_HB3_TAPS] = {
+    682880000, -225807448, 133324953, -92959845, 70004763, -55002757,
+    44322832, -36274909, 29967059, -24884433, 20708787, -17232191,
+    14312197, -11846998, 9760941, -7995735, 6504941, -5250441,
+    4200131, -3326402, 2605128, -2014995, 1537047, -1154383,
+    851946, -616371, 435869, -300129, 200222, -128508,
+    78545, -44981, 23452, -10473, 3324,
+};
+
+/* DSF stores bits LSB first */
+const uint8_t dsd_bit_reverse[256] = {
+    0, 128, 64, 192, 32, 160, 96, 224, 16, 144, 80, 208, 48, 176, 112, 240,
+    8, 136, 72, 200, 40, 168, 104, 232, 24, 152, 88, 216, 56, 184, 120, 248,
+    4, 132, 68, 196, 36, 164, 100, 228, 20, 148, 84, 212, 52, 180, 116, 244,
+    12, 140, 76, 204, 44, 172, 108, 236, 28, 156, 92, 220, 60, 188, 124, 252,
+    2, 130, 66, 194, 34, 162, 98, 226, 18, 146, 82, 210, 50, 178, 114, 242,
+    10, 138, 74, 202, 42, 170, 106, 234, 26, 154, 90, 218, 58, 186, 122, 250,
+    6, 134, 70, 198, 38, 166, 102, 230, 22, 150, 86, 214, 54, 182, 118, 246,
+    14, 142, 78, 206, 46, 174, 110, 238, 30, 158, 94, 222, 62, 190, 126, 254,
+    1, 129, 65, 193, 33, 161, 97, 225, 17, 145, 81, 209, 49, 177, 113, 241,
+    9, 137, 73, 201, 41, 169, 105, 233, 25, 153, 89, 217, 57, 185, 121, 249,
+    5, 133, 69, 197, 37, 165, 101, 229, 21, 149, 85, 213, 53, 181, 117, 245,
+    13, 141, 77, 205, 45, 173, 109, 237, 29, 157, 93, 221, 61, 189, 125, 253,
+    3, 131, 67, 195, 35, 163, 99, 227, 19, 147, 83, 211, 51, 179, 115, 243,
+    11, 139, 75, 203, 43, 171, 107, 235, 27, 155, 91, 219, 59, 187, 123, 251,
+    7, 135, 71, 199, 39, 167, 103, 231, 23, 151, 87, 215, 55, 183, 119, 247,
+    15, 143, 79, 207, 47, 175, 111, 239, 31, 159, 95, 223, 63, 191, 127, 255,
+};
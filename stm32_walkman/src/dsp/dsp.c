@@ -0,0 +1,178 @@
+/**
+ * Fixed-Point DSP Kernels - Implementation
+ */
+
+#include "dsp.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * Widen s16 to q31 (exact)
+ */
+void dsp_s16_to_q31(const int16_t* in, int32_t* out, uint32_t samples) {
+    for (uint32_t i = 0; i < samples; i++) {
+        out[i] = (int32_t)in[i] << 16;
+    }
+}
+
+/**
+ * Apply Q16.16 gain to s16 samples in place
+ */
+void dsp_gain_s16(int16_t* buf, uint32_t samples, int32_t gain_q16) {
+    for (uint32_t i = 0; i < samples; i++) {
+        buf[i] = dsp_sat16((int32_t)(((int64_t)buf[i] * gain_q16) >> 16));
+    }
+}
+
+/**
+ * Apply Q16.16 gain to q31 samples in place
+ */
+void dsp_gain_q31(int32_t* buf, uint32_t samples, int32_t gain_q16) {
+    for (uint32_t i = 0; i < samples; i++) {
+        buf[i] = dsp_sat32(((int64_t)buf[i] * gain_q16) >> 16);
+    }
+}
+
+/**
+ * Convert decibels to Q16.16 linear gain (clamped to +42 dB)
+ */
+int32_t dsp_gain_from_db(float db) {
+    if (db > 42.0f) db = 42.0f;
+    return (int32_t)(powf(10.0f, db / 20.0f) * 65536.0f + 0.5f);
+}
+
+static int32_t dsp_coef_q30(double v) {
+    double scaled = v * 1073741824.0;
+    if (scaled > 2147483647.0) scaled = 2147483647.0;
+    if (scaled < -2147483648.0) scaled = -2147483648.0;
+    return (int32_t)lrint(scaled);
+}
+
+/**
+ * Design biquad coefficients (RBJ audio EQ cookbook)
+ */
+void dsp_biquad_design(dsp_biquad_coef_t* coef, dsp_biquad_type_t type,
+                       float sample_rate, float freq, float q, float gain_db) {
+    double A = pow(10.0, gain_db / 40.0);
+    double w0 = 2.0 * M_PI * freq / sample_rate;
+    double cw = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    double b0, b1, b2, a0, a1, a2;
+
+    switch (type) {
+        case DSP_BIQUAD_LOWPASS:
+            b0 = (1.0 - cw) / 2.0; b1 = 1.0 - cw; b2 = b0;
+            a0 = 1.0 + alpha; a1 = -2.0 * cw; a2 = 1.0 - alpha;
+            break;
+        case DSP_BIQUAD_HIGHPASS:
+            b0 = (1.0 + cw) / 2.0; b1 = -(1.0 + cw); b2 = b0;
+            a0 = 1.0 + alpha; a1 = -2.0 * cw; a2 = 1.0 - alpha;
+            break;
+        case DSP_BIQUAD_PEAK:
+            b0 = 1.0 + alpha * A; b1 = -2.0 * cw; b2 = 1.0 - alpha * A;
+            a0 = 1.0 + alpha / A; a1 = -2.0 * cw; a2 = 1.0 - alpha / A;
+            break;
+        case DSP_BIQUAD_LOWSHELF: {
+            double sa = 2.0 * sqrt(A) * alpha;
+            b0 = A * ((A + 1) - (A - 1) * cw + sa);
+            b1 = 2 * A * ((A - 1) - (A + 1) * cw);
+            b2 = A * ((A + 1) - (A - 1) * cw - sa);
+            a0 = (A + 1) + (A - 1) * cw + sa;
+            a1 = -2 * ((A - 1) + (A + 1) * cw);
+            a2 = (A + 1) + (A - 1) * cw - sa;
+            break;
+        }
+        case DSP_BIQUAD_HIGHSHELF:
+        default: {
+            double sa = 2.0 * sqrt(A) * alpha;
+            b0 = A * ((A + 1) + (A - 1) * cw + sa);
+            b1 = -2 * A * ((A - 1) + (A + 1) * cw);
+            b2 = A * ((A + 1) + (A - 1) * cw - sa);
+            a0 = (A + 1) - (A - 1) * cw + sa;
+            a1 = 2 * ((A - 1) - (A + 1) * cw);
+            a2 = (A + 1) - (A - 1) * cw - sa;
+            break;
+        }
+    }
+
+    coef->b0 = dsp_coef_q30(b0 / a0);
+    coef->b1 = dsp_coef_q30(b1 / a0);
+    coef->b2 = dsp_coef_q30(b2 / a0);
+    coef->a1 = dsp_coef_q30(a1 / a0);
+    coef->a2 = dsp_coef_q30(a2 / a0);
+}
+
+void dsp_biquad_init(dsp_biquad_t* bq, const dsp_biquad_coef_t* coef) {
+    bq->coef = *coef;
+    dsp_biquad_reset(bq);
+}
+
+void dsp_biquad_reset(dsp_biquad_t* bq) {
+    for (int c = 0; c < DSP_CHANNELS; c++) {
+        bq->x1[c] = bq->x2[c] = 0;
+        bq->y1[c] = bq->y2[c] = 0;
+    }
+}
+
+/**
+ * Filter stereo q31 frames in place
+ * 64-bit accumulator, coefficients Q2.30 -> shift 30 on output
+ */
+void dsp_biquad_q31(dsp_biquad_t* bq, int32_t* buf, uint32_t frames) {
+    const dsp_biquad_coef_t c = bq->coef;
+
+    for (int ch = 0; ch < DSP_CHANNELS; ch++) {
+        int32_t x1 = bq->x1[ch], x2 = bq->x2[ch];
+        int32_t y1 = bq->y1[ch], y2 = bq->y2[ch];
+        int32_t* p = buf + ch;
+
+        for (uint32_t i = 0; i < frames; i++) {
+            int32_t x0 = *p;
+            int64_t acc = (int64_t)c.b0 * x0;
+            acc += (int64_t)c.b1 * x1;
+            acc += (int64_t)c.b2 * x2;
+            acc -= (int64_t)c.a1 * y1;
+            acc -= (int64_t)c.a2 * y2;
+            int32_t y0 = dsp_sat32(acc >> 30);
+
+            x2 = x1; x1 = x0;
+            y2 = y1; y1 = y0;
+            *p = y0;
+            p += DSP_CHANNELS;
+        }
+
+        bq->x1[ch] = x1; bq->x2[ch] = x2;
+        bq->y1[ch] = y1; bq->y2[ch] = y2;
+    }
+}
+
+/**
+ * Requantize q31 to s16 with TPDF dither
+ * Two uniform draws of +-0.5 LSB from one 32-bit LCG step
+ */
+void dsp_dither_q31_to_s16(const int32_t* in, int16_t* out, uint32_t samples,
+                           uint32_t* seed) {
+    uint32_t s = *seed;
+
+    for (uint32_t i = 0; i < samples; i++) {
+        s = s * 1664525u + 1013904223u;
+        int32_t d = (int32_t)(s & 0xFFFF) + (int32_t)(s >> 16) - 0xFFFF;  /* +-1 LSB */
+        int64_t v = ((int64_t)in[i] + d + 0x8000) >> 16;
+        out[i] = dsp_sat16((int32_t)v);
+    }
+
+    *seed = s;
+}
+
+/**
+ * Requantize q31 to s16 with round-half-up
+ */
+void dsp_round_q31_to_s16(const int32_t* in, int16_t* out, uint32_t samples) {
+    for (uint32_t i = 0; i < samples; i++) {
+        int64_t v = ((int64_t)in[i] + 0x8000) >> 16;
+        out[i] = dsp_sat16((int32_t)v);
+    }
+}
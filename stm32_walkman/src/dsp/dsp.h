@@ -0,0 +1,104 @@
+/**
+ * Fixed-Point DSP Kernels
+ *
+ * Sample formats:
+ * - s16: interleaved stereo int16_t, as decoded and as sent to the DAC
+ * - q31: interleaved stereo int32_t, full scale = 1.0, used between
+ *        processing stages so gain and filters keep headroom bits
+ *
+ * Kernels are plain C written so GCC maps them onto Cortex-M4 DSP
+ * instructions (SMULL/SMLAL, SSAT). Coefficient design uses the FPU and
+ * runs only when a setting changes.
+ */
+
+#ifndef __DSP_H
+#define __DSP_H
+
+#include <stdint.h>
+
+#define DSP_CHANNELS 2
+
+/* ============ Saturation helpers ============ */
+
+static inline int16_t dsp_sat16(int32_t x) {
+    if (x > 32767) return 32767;
+    if (x < -32768) return -32768;
+    return (int16_t)x;
+}
+
+static inline int32_t dsp_sat32(int64_t x) {
+    if (x > INT32_MAX) return INT32_MAX;
+    if (x < INT32_MIN) return INT32_MIN;
+    return (int32_t)x;
+}
+
+/* ============ Dual 16-bit MAC ============ */
+
+/**
+ * acc + lo(a) * lo(b) + hi(a) * hi(b) for two packed s16 (a stereo frame)
+ * GCC does not form SMLALD from C, so the M4 gets it spelled out; the
+ * 64-bit accumulator takes full-scale sums over thousands of frames.
+ */
+static inline int64_t dsp_smlald(uint32_t a, uint32_t b, int64_t acc) {
+#if defined(__ARM_FEATURE_DSP)
+    uint32_t lo = (uint32_t)acc, hi = (uint32_t)((uint64_t)acc >> 32);
+    __asm__("smlald %0, %1, %2, %3" : "+r"(lo), "+r"(hi) : "r"(a), "r"(b));
+    return (int64_t)(((uint64_t)hi << 32) | lo);
+#else
+    return acc + (int32_t)(int16_t)a * (int16_t)b +
+           (int64_t)((int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16));
+#endif
+}
+
+/* ============ Format conversion ============ */
+
+void dsp_s16_to_q31(const int16_t* in, int32_t* out, uint32_t samples);
+
+/* ============ Gain ============ */
+
+/* Gain in Q16.16 (65536 = unity), saturating */
+#define DSP_GAIN_UNITY 65536
+
+void dsp_gain_s16(int16_t* buf, uint32_t samples, int32_t gain_q16);
+void dsp_gain_q31(int32_t* buf, uint32_t samples, int32_t gain_q16);
+int32_t dsp_gain_from_db(float db);
+
+/* ============ Biquad filter ============ */
+
+typedef enum {
+    DSP_BIQUAD_LOWPASS = 0,
+    DSP_BIQUAD_HIGHPASS,
+    DSP_BIQUAD_PEAK,
+    DSP_BIQUAD_LOWSHELF,
+    DSP_BIQUAD_HIGHSHELF
+} dsp_biquad_type_t;
+
+/* Coefficients in Q2.30: y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2 */
+typedef struct {
+    int32_t b0, b1, b2, a1, a2;
+} dsp_biquad_coef_t;
+
+/* Direct form I, per-channel state, stereo interleaved q31 data */
+typedef struct {
+    dsp_biquad_coef_t coef;
+    int32_t x1[DSP_CHANNELS], x2[DSP_CHANNELS];
+    int32_t y1[DSP_CHANNELS], y2[DSP_CHANNELS];
+} dsp_biquad_t;
+
+/* RBJ audio EQ cookbook designs; gain_db is ignored for pass filters */
+void dsp_biquad_design(dsp_biquad_coef_t* coef, dsp_biquad_type_t type,
+                       float sample_rate, float freq, float q, float gain_db);
+void dsp_biquad_init(dsp_biquad_t* bq, const dsp_biquad_coef_t* coef);
+void dsp_biquad_reset(dsp_biquad_t* bq);
+void dsp_biquad_q31(dsp_biquad_t* bq, int32_t* buf, uint32_t frames);
+
+/* ============ Requantization ============ */
+
+/* q31 -> s16 with TPDF dither (+-1 LSB triangular), saturating */
+void dsp_dither_q31_to_s16(const int32_t* in, int16_t* out, uint32_t samples,
+                           uint32_t* seed);
+
+/* q31 -> s16 with rounding only (bit-exact path for s16 sources) */
+void dsp_round_q31_to_s16(const int32_t* in, int16_t* out, uint32_t samples);
+
+#endif /* __DSP_H */
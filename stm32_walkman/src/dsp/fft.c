@@ -0,0 +1,92 @@
+/**
+ * Fixed-Point FFT - Implementation
+ */
+
+#include "fft.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* exp(-j 2 pi k / FFT_MAX_SIZE), k < FFT_MAX_SIZE / 2 */
+static fft_q31_t fft_twiddle[FFT_MAX_SIZE / 2];
+static uint8_t fft_ready = 0;
+
+/* Symmetric range: the inverse transform negates the table entries */
+static int32_t fft_q31_from_double(double v) {
+    double scaled = v * 2147483648.0;
+    if (scaled > 2147483647.0) scaled = 2147483647.0;
+    if (scaled < -2147483647.0) scaled = -2147483647.0;
+    return (int32_t)lrint(scaled);
+}
+
+/**
+ * Build twiddle table
+ */
+void fft_init(void) {
+    if (fft_ready) return;
+
+    for (uint32_t k = 0; k < FFT_MAX_SIZE / 2; k++) {
+        double a = 2.0 * M_PI * k / FFT_MAX_SIZE;
+        fft_twiddle[k].re = fft_q31_from_double(cos(a));
+        fft_twiddle[k].im = fft_q31_from_double(-sin(a));
+    }
+    fft_ready = 1;
+}
+
+/**
+ * Bit-reversal permutation
+ */
+static void fft_bit_reverse(fft_q31_t* data, uint32_t n) {
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            fft_q31_t t = data[i];
+            data[i] = data[j];
+            data[j] = t;
+        }
+    }
+}
+
+/**
+ * Radix-2 decimation in time, scaled by 1/2 per stage
+ */
+int fft_q31(fft_q31_t* data, uint32_t log2n, uint8_t inverse) {
+    if (log2n == 0 || log2n > FFT_MAX_LOG2) return FFT_ERROR;
+    if (!fft_ready) fft_init();
+
+    uint32_t n = 1u << log2n;
+    fft_bit_reverse(data, n);
+
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        uint32_t half = len >> 1;
+        uint32_t tw_step = FFT_MAX_SIZE / len;
+
+        for (uint32_t i = 0; i < n; i += len) {
+            fft_q31_t* a = &data[i];
+            fft_q31_t* b = &data[i + half];
+
+            for (uint32_t j = 0; j < half; j++) {
+                int32_t wr = fft_twiddle[j * tw_step].re;
+                int32_t wi = fft_twiddle[j * tw_step].im;
+                if (inverse) wi = -wi;
+
+                /* t = b * w / 2 (Q31 x Q31 >> 32) */
+                int32_t tr = (int32_t)(((int64_t)b[j].re * wr - (int64_t)b[j].im * wi) >> 32);
+                int32_t ti = (int32_t)(((int64_t)b[j].re * wi + (int64_t)b[j].im * wr) >> 32);
+                int32_t ar = a[j].re >> 1;
+                int32_t ai = a[j].im >> 1;
+
+                a[j].re = ar + tr;
+                a[j].im = ai + ti;
+                b[j].re = ar - tr;
+                b[j].im = ai - ti;
+            }
+        }
+    }
+
+    return FFT_OK;
+}
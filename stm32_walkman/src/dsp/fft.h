@@ -0,0 +1,34 @@
+/**
+ * Fixed-Point FFT
+ *
+ * In-place radix-2 complex FFT on Q31 data. Every butterfly stage halves
+ * its output, so a forward transform returns X[k] / N and the result can
+ * never overflow provided input magnitudes stay below 1.0. The inverse
+ * transform scales by 1/N as well; callers undo the scaling with shifts.
+ */
+
+#ifndef __FFT_H
+#define __FFT_H
+
+#include <stdint.h>
+
+#define FFT_MAX_LOG2   10
+#define FFT_MAX_SIZE   (1u << FFT_MAX_LOG2)
+
+typedef enum {
+    FFT_OK = 0,
+    FFT_ERROR = 1
+} fft_status_t;
+
+typedef struct {
+    int32_t re;
+    int32_t im;
+} fft_q31_t;
+
+/* Build the shared twiddle table (idempotent) */
+void fft_init(void);
+
+/* Transform 2^log2n points; inverse = 1 for the inverse transform */
+int fft_q31(fft_q31_t* data, uint32_t log2n, uint8_t inverse);
+
+#endif /* __FFT_H */
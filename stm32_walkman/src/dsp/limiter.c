@@ -0,0 +1,188 @@
+/**
+ * Look-Ahead Peak Limiter and Dynamic Range Compressor - Implementation
+ */
+
+#include "limiter.h"
+#include <math.h>
+#include <string.h>
+
+#define LIMITER_MASK (LIMITER_MAX_LOOKAHEAD - 1)
+#define LIMITER_UNITY (1 << 30)
+
+/* One-pole coefficient that closes all but e^-k of a gap in n steps */
+static int32_t limiter_pole_q30(double n, double k) {
+    return (int32_t)lrint((1.0 - exp(-k / (n > 1.0 ? n : 1.0))) * LIMITER_UNITY);
+}
+
+/* Q16.16 DRC gain for a peak envelope: static curve above the knee plus make-up */
+static int32_t limiter_drc_gain(const limiter_t* lim, uint32_t env) {
+    float level_db = (env > 0) ? 20.0f * log10f((float)env / 2147483648.0f) : -200.0f;
+    float over = level_db - lim->drc_threshold_db;
+    float gain_db = lim->drc_makeup_db - ((over > 0.0f) ? over * lim->drc_slope : 0.0f);
+    return dsp_gain_from_db(gain_db);
+}
+
+/**
+ * Design the limiter and compressor for a sample rate
+ * The attack closes 99 % of a gain step within the look-ahead; the DRC
+ * starts disabled (limiter_set_drc). Ceilings go down to -20 dBFS, which
+ * keeps 11 bits in the gain division.
+ */
+int limiter_init(limiter_t* lim, const limiter_config_t* config, uint32_t sample_rate) {
+    double lookahead = config->lookahead_ms * 1e-3 * sample_rate;
+
+    if (sample_rate == 0 || config->lookahead_ms < 1.0f || config->lookahead_ms > 5.0f ||
+        lookahead + 1.0 > LIMITER_MAX_LOOKAHEAD || config->drc_ratio < 1.0f ||
+        config->ceiling_db > 0.0f || config->ceiling_db < -20.0f) {
+        return LIMITER_ERROR;
+    }
+
+    uint32_t limited_frames = lim->limited_frames;
+    memset(lim, 0, sizeof(*lim));
+    lim->sample_rate = sample_rate;
+    lim->limited_frames = limited_frames;
+    lim->lookahead = (uint32_t)lrint(lookahead);
+    lim->ceiling = (int32_t)lrint(pow(10.0, config->ceiling_db / 20.0) * 2147483647.0);
+    lim->attack = limiter_pole_q30(lookahead, 4.6);
+    lim->release = limiter_pole_q30(config->release_ms * 1e-3 * sample_rate, 1.0);
+
+    double block_rate = (double)sample_rate / LIMITER_DRC_BLOCK;
+    lim->drc_threshold_db = config->drc_threshold_db;
+    lim->drc_slope = 1.0f - 1.0f / config->drc_ratio;
+    lim->drc_makeup_db = config->drc_makeup_db;
+    lim->drc_attack = limiter_pole_q30(config->drc_attack_ms * 1e-3 * block_rate, 1.0);
+    lim->drc_release = limiter_pole_q30(config->drc_release_ms * 1e-3 * block_rate, 1.0);
+
+    limiter_reset(lim);
+    return LIMITER_OK;
+}
+
+/**
+ * Clear the delay line and envelopes (new track, seek)
+ */
+void limiter_reset(limiter_t* lim) {
+    memset(lim->line, 0, sizeof(lim->line));
+    lim->head = lim->tail = lim->pos = 0;
+    lim->gain = lim->target = lim->min_gain = LIMITER_UNITY;
+    lim->target_peak = 0;
+
+    lim->drc_env = 0;
+    lim->drc_block_peak = 0;
+    lim->drc_count = 0;
+    lim->drc_gain = limiter_drc_gain(lim, 0);
+    lim->drc_step = 0;
+}
+
+void limiter_set_drc(limiter_t* lim, uint8_t enabled) {
+    if (enabled && !lim->drc_enabled) {
+        lim->drc_gain = limiter_drc_gain(lim, lim->drc_env);
+        lim->drc_step = 0;
+    }
+    lim->drc_enabled = enabled ? 1 : 0;
+}
+
+/**
+ * Read the gain reduction meter and restart its peak hold
+ */
+void limiter_read_meter(limiter_t* lim, limiter_meter_t* meter) {
+    meter->reduction_db = -20.0f * log10f((float)lim->min_gain / (float)LIMITER_UNITY);
+    meter->drc_gain_db = lim->drc_enabled ?
+                         20.0f * log10f((float)lim->drc_gain / (float)DSP_GAIN_UNITY) : 0.0f;
+    meter->limited_frames = lim->limited_frames;
+    lim->min_gain = lim->gain;
+}
+
+/**
+ * Compressor gain, ramped per frame; envelope and target once per block
+ */
+static void limiter_drc(limiter_t* lim, int32_t* buf, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; i++) {
+        int32_t l = dsp_sat32(((int64_t)buf[0] * lim->drc_gain) >> 16);
+        int32_t r = dsp_sat32(((int64_t)buf[1] * lim->drc_gain) >> 16);
+        uint32_t al = (buf[0] < 0) ? 0u - (uint32_t)buf[0] : (uint32_t)buf[0];
+        uint32_t ar = (buf[1] < 0) ? 0u - (uint32_t)buf[1] : (uint32_t)buf[1];
+        uint32_t peak = (al > ar) ? al : ar;
+
+        if (peak > lim->drc_block_peak) lim->drc_block_peak = peak;
+        buf[0] = l;
+        buf[1] = r;
+        buf += DSP_CHANNELS;
+        lim->drc_gain += lim->drc_step;
+
+        if (++lim->drc_count == LIMITER_DRC_BLOCK) {
+            int64_t diff = (int64_t)lim->drc_block_peak - lim->drc_env;
+            int32_t coef = (diff > 0) ? lim->drc_attack : lim->drc_release;
+            lim->drc_env = (uint32_t)((int64_t)lim->drc_env + ((diff * coef) >> 30));
+            lim->drc_step = (limiter_drc_gain(lim, lim->drc_env) - lim->drc_gain) / LIMITER_DRC_BLOCK;
+            lim->drc_block_peak = 0;
+            lim->drc_count = 0;
+        }
+    }
+}
+
+/**
+ * Limit stereo q31 frames in place
+ * Per frame: push the linked peak into the deque (dropping smaller ones
+ * from the tail, the expired head), smooth the gain towards the window
+ * peak's target and apply it to the frame leaving the delay line.
+ */
+void limiter_q31(limiter_t* lim, int32_t* buf, uint32_t frames) {
+    if (lim->drc_enabled) {
+        limiter_drc(lim, buf, frames);
+    }
+
+    const uint32_t lookahead = lim->lookahead;
+    const int32_t ceiling = lim->ceiling;
+    uint32_t head = lim->head, tail = lim->tail, pos = lim->pos;
+    int32_t gain = lim->gain, min_gain = lim->min_gain;
+    uint32_t limited = 0;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        int32_t xl = buf[0], xr = buf[1];
+        uint32_t al = (xl < 0) ? 0u - (uint32_t)xl : (uint32_t)xl;
+        uint32_t ar = (xr < 0) ? 0u - (uint32_t)xr : (uint32_t)xr;
+        uint32_t peak = (al > ar) ? al : ar;
+
+        while (tail != head && lim->deque_peak[(tail - 1) & LIMITER_MASK] <= peak) tail--;
+        lim->deque_peak[tail & LIMITER_MASK] = peak;
+        lim->deque_pos[tail & LIMITER_MASK] = pos;
+        tail++;
+        if (pos - lim->deque_pos[head & LIMITER_MASK] > lookahead) head++;
+
+        /* 32-bit divide (UDIV); window >> 16 is at least ceiling >> 16,
+         * so the quotient keeps 15 bits and the clip below absorbs its
+         * rounding */
+        uint32_t window = lim->deque_peak[head & LIMITER_MASK];
+        if (window != lim->target_peak) {
+            lim->target_peak = window;
+            lim->target = (window > (uint32_t)ceiling) ?
+                          (int32_t)(((uint32_t)ceiling / (window >> 16)) << 14) : LIMITER_UNITY;
+        }
+
+        /* Round towards the target so the release reaches unity */
+        int64_t step = (int64_t)(lim->target - gain) * ((lim->target < gain) ? lim->attack : lim->release);
+        gain += (int32_t)((step + ((step > 0) ? LIMITER_UNITY - 1 : 0)) >> 30);
+        if (gain < min_gain) min_gain = gain;
+        if (gain < LIMITER_UNITY) limited++;
+
+        int32_t* line = lim->line[pos & LIMITER_MASK];
+        line[0] = xl;
+        line[1] = xr;
+        const int32_t* out = lim->line[(pos - lookahead) & LIMITER_MASK];
+        int32_t yl = (int32_t)(((int64_t)out[0] * gain) >> 30);
+        int32_t yr = (int32_t)(((int64_t)out[1] * gain) >> 30);
+        if (yl > ceiling) yl = ceiling; else if (yl < -ceiling) yl = -ceiling;
+        if (yr > ceiling) yr = ceiling; else if (yr < -ceiling) yr = -ceiling;
+        buf[0] = yl;
+        buf[1] = yr;
+        buf += DSP_CHANNELS;
+        pos++;
+    }
+
+    lim->head = head;
+    lim->tail = tail;
+    lim->pos = pos;
+    lim->gain = gain;
+    lim->min_gain = min_gain;
+    lim->limited_frames += limited;
+}
@@ -0,0 +1,91 @@
+/**
+ * Look-Ahead Peak Limiter and Dynamic Range Compressor
+ *
+ * Last stage before requantization for interleaved stereo q31. The
+ * limiter delays the signal by a look-ahead of 1-5 ms and takes the
+ * stereo-linked peak over that window with a sliding-window maximum (a
+ * monotonic deque, O(1) per frame), so the gain is already down when a
+ * peak leaves the delay line. The gain follows the window peak through
+ * one-pole attack/release smoothing in Q2.30; what the attack has not
+ * caught up with yet is clipped at the ceiling.
+ *
+ * The optional compressor (DRC, for noisy surroundings) runs in front of
+ * the limiter on a peak envelope: level and gain are computed once per
+ * LIMITER_DRC_BLOCK frames with the FPU and the gain is ramped linearly
+ * across the block. Its make-up gain is what the limiter then catches.
+ */
+
+#ifndef __LIMITER_H
+#define __LIMITER_H
+
+#include <stdint.h>
+#include "dsp.h"
+
+#define LIMITER_MAX_LOOKAHEAD 512   // Delay line / deque frames (power of 2)
+#define LIMITER_DRC_BLOCK 32        // Frames per DRC gain update
+
+typedef enum {
+    LIMITER_OK = 0,
+    LIMITER_ERROR = 1
+} limiter_status_t;
+
+typedef struct {
+    float ceiling_db;           // Limiter ceiling, -20 to 0 dBFS
+    float lookahead_ms;         // 1 to 5
+    float release_ms;           // Limiter gain recovery
+    float drc_threshold_db;     // DRC knee, dBFS
+    float drc_ratio;            // Above the knee, > 1
+    float drc_makeup_db;
+    float drc_attack_ms;
+    float drc_release_ms;
+} limiter_config_t;
+
+/* Gain reduction meter (limiter_read_meter) */
+typedef struct {
+    float reduction_db;         // Deepest limiter reduction since the last read
+    float drc_gain_db;          // DRC gain now incl. make-up (0 if off)
+    uint32_t limited_frames;    // Frames leaving below unity gain, in total
+} limiter_meter_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t lookahead;         // Frames
+    int32_t ceiling;            // q31
+    int32_t attack, release;    // One-pole coefficients, Q2.30
+    int32_t gain;               // Q2.30, unity = 1 << 30
+    int32_t target;             // Gain for target_peak
+    uint32_t target_peak;
+    int32_t min_gain;           // Meter: lowest gain since the last read
+    uint32_t limited_frames;
+
+    /* Sliding-window maximum: peaks decreasing from head to tail */
+    uint32_t deque_peak[LIMITER_MAX_LOOKAHEAD];
+    uint32_t deque_pos[LIMITER_MAX_LOOKAHEAD];
+    uint32_t head, tail;
+    int32_t line[LIMITER_MAX_LOOKAHEAD][DSP_CHANNELS];
+    uint32_t pos;               // Frames in since the reset
+
+    /* Compressor */
+    uint8_t drc_enabled;
+    float drc_threshold_db, drc_slope, drc_makeup_db;
+    int32_t drc_attack, drc_release;    // Envelope per block, Q2.30
+    uint32_t drc_env;                   // Peak envelope, q31
+    uint32_t drc_block_peak;
+    uint32_t drc_count;                 // Frames into the block
+    int32_t drc_gain, drc_step;         // Q16.16, ramp per frame
+} limiter_t;
+
+int limiter_init(limiter_t* lim, const limiter_config_t* config, uint32_t sample_rate);
+void limiter_reset(limiter_t* lim);
+void limiter_set_drc(limiter_t* lim, uint8_t enabled);
+void limiter_read_meter(limiter_t* lim, limiter_meter_t* meter);
+
+/* Frames of delay through limiter_q31 */
+static inline uint32_t limiter_latency(const limiter_t* lim) {
+    return lim->lookahead;
+}
+
+/* Process stereo q31 frames in place (output delayed by the look-ahead) */
+void limiter_q31(limiter_t* lim, int32_t* buf, uint32_t frames);
+
+#endif /* __LIMITER_H */
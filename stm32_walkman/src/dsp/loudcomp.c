@@ -0,0 +1,116 @@
+/**
+ * Loudness Compensation - Implementation
+ */
+
+#include "loudcomp.h"
+#include <math.h>
+#include <string.h>
+
+static uint8_t loudcomp_step(uint8_t volume) {
+    uint32_t step = ((uint32_t)volume + 2) / 5;
+    return (uint8_t)((step > LOUDCOMP_FLAT) ? LOUDCOMP_FLAT : step);
+}
+
+int loudcomp_init(loudcomp_t* lc, uint32_t sample_rate) {
+    lc->steps = NULL;
+    lc->sample_rate = sample_rate;
+    lc->step = lc->target = LOUDCOMP_FLAT;
+    for (uint32_t i = 0; i < loudcomp_table_count; i++) {
+        if (loudcomp_tables[i].sample_rate == sample_rate) {
+            lc->steps = loudcomp_tables[i].steps;
+            dsp_biquad_init(&lc->low, &lc->steps[LOUDCOMP_FLAT].low);
+            dsp_biquad_init(&lc->high, &lc->steps[LOUDCOMP_FLAT].high);
+            return LOUDCOMP_OK;
+        }
+    }
+    return LOUDCOMP_ERROR;
+}
+
+/**
+ * Clear the filter state (new track, seek); a pending fade becomes a jump
+ */
+void loudcomp_reset(loudcomp_t* lc) {
+    if (lc->steps == NULL) {
+        return;
+    }
+    lc->step = lc->target;
+    dsp_biquad_init(&lc->low, &lc->steps[lc->step].low);
+    dsp_biquad_init(&lc->high, &lc->steps[lc->step].high);
+}
+
+void loudcomp_set_volume(loudcomp_t* lc, uint8_t volume) {
+    if (lc->steps == NULL) {
+        return;
+    }
+    lc->target = loudcomp_step(volume);
+}
+
+/**
+ * Gain of a biquad at DC (sign 1) or Nyquist (sign -1), in dB
+ */
+static float loudcomp_edge_gain(const dsp_biquad_coef_t* c, float sign) {
+    float num = (float)c->b0 + sign * (float)c->b1 + (float)c->b2;
+    float den = (float)(1 << 30) + sign * (float)c->a1 + (float)c->a2;
+    return 20.0f * log10f(num / den);
+}
+
+void loudcomp_shelf_gains(const loudcomp_t* lc, uint8_t volume, float* low_db, float* high_db) {
+    if (lc->steps == NULL) {
+        *low_db = *high_db = 0.0f;
+        return;
+    }
+    const loudcomp_coef_t* entry = &lc->steps[loudcomp_step(volume)];
+    *low_db = loudcomp_edge_gain(&entry->low, 1.0f);
+    *high_db = loudcomp_edge_gain(&entry->high, -1.0f);
+}
+
+/**
+ * Run the new table entry next to the old one over one block and
+ * crossfade (Q15 ramp); the new filters take over after it
+ */
+static void loudcomp_fade(loudcomp_t* lc, int32_t* buf, uint32_t frames) {
+    const loudcomp_coef_t* next = &lc->steps[lc->target];
+
+    lc->fade_low = lc->low;
+    lc->fade_high = lc->high;
+    lc->fade_low.coef = next->low;
+    lc->fade_high.coef = next->high;
+
+    memcpy(lc->fade, buf, frames * DSP_CHANNELS * sizeof(int32_t));
+    dsp_biquad_q31(&lc->low, buf, frames);
+    dsp_biquad_q31(&lc->high, buf, frames);
+    dsp_biquad_q31(&lc->fade_low, lc->fade, frames);
+    dsp_biquad_q31(&lc->fade_high, lc->fade, frames);
+
+    for (uint32_t i = 0; i < frames; i++) {
+        int32_t w = (int32_t)(((i + 1) << 15) / frames);
+        for (int ch = 0; ch < DSP_CHANNELS; ch++) {
+            int32_t a = buf[i * DSP_CHANNELS + ch];
+            int32_t b = lc->fade[i * DSP_CHANNELS + ch];
+            buf[i * DSP_CHANNELS + ch] = a + (int32_t)(((int64_t)b - a) * w >> 15);
+        }
+    }
+
+    lc->low = lc->fade_low;
+    lc->high = lc->fade_high;
+    lc->step = lc->target;
+}
+
+void loudcomp_q31(loudcomp_t* lc, int32_t* buf, uint32_t frames) {
+    if (lc->steps == NULL || loudcomp_is_flat(lc)) {
+        return;
+    }
+
+    while (frames > 0) {
+        uint32_t n = (frames > LOUDCOMP_FADE_FRAMES) ? LOUDCOMP_FADE_FRAMES : frames;
+
+        if (lc->target != lc->step) {
+            loudcomp_fade(lc, buf, n);
+        } else {
+            dsp_biquad_q31(&lc->low, buf, n);
+            dsp_biquad_q31(&lc->high, buf, n);
+        }
+        buf += n * DSP_CHANNELS;
+        frames -= n;
+    }
+}
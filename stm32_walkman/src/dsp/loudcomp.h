@@ -0,0 +1,71 @@
+/**
+ * Loudness Compensation
+ *
+ * A low and a high shelf whose gains follow the volume along the ISO 226
+ * equal-loudness contours, so bass and treble do not fade away at low
+ * listening levels. The coefficients for each volume step and codec rate
+ * are a const table generated offline (tools/loudcomp_table.py), so a
+ * volume change only selects another table entry.
+ *
+ * A new entry is faded in over one LOUDCOMP_FADE_FRAMES block: old and
+ * new filters (the new one started from the old state) both run over the
+ * block and the output crossfades linearly between them.
+ */
+
+#ifndef __LOUDCOMP_H
+#define __LOUDCOMP_H
+
+#include <stdint.h>
+#include "dsp.h"
+
+#define LOUDCOMP_STEPS 21           // Volume 0, 5, ..., 100
+#define LOUDCOMP_FLAT (LOUDCOMP_STEPS - 1)  // Full volume: reference level, no boost
+#define LOUDCOMP_FADE_FRAMES 256
+
+typedef enum {
+    LOUDCOMP_OK = 0,
+    LOUDCOMP_ERROR = 1
+} loudcomp_status_t;
+
+typedef struct {
+    dsp_biquad_coef_t low, high;
+} loudcomp_coef_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    const loudcomp_coef_t* steps;   // LOUDCOMP_STEPS entries
+} loudcomp_table_t;
+
+/* loudcomp_table.c (generated) */
+extern const loudcomp_table_t loudcomp_tables[];
+extern const uint32_t loudcomp_table_count;
+
+typedef struct {
+    const loudcomp_coef_t* steps;   // Table for the sample rate
+    uint32_t sample_rate;
+    uint8_t step, target;           // Entry in use, entry to fade to
+    dsp_biquad_t low, high;
+    dsp_biquad_t fade_low, fade_high;
+    int32_t fade[LOUDCOMP_FADE_FRAMES * DSP_CHANNELS];
+} loudcomp_t;
+
+/* Starts flat; LOUDCOMP_ERROR (and audio passes through) if the table has no such rate */
+int loudcomp_init(loudcomp_t* lc, uint32_t sample_rate);
+void loudcomp_reset(loudcomp_t* lc);
+
+/* Volume 0-100 (rounded to the 5 % table steps); faded in from the next block */
+void loudcomp_set_volume(loudcomp_t* lc, uint8_t volume);
+
+/* Shelf gains (dB) of the entry for volume, low shelf at DC and high
+ * shelf at Nyquist; 0 if the table has no such rate */
+void loudcomp_shelf_gains(const loudcomp_t* lc, uint8_t volume, float* low_db, float* high_db);
+
+/* Flat and not fading: the stage can be left out */
+static inline uint8_t loudcomp_is_flat(const loudcomp_t* lc) {
+    return lc->step == LOUDCOMP_FLAT && lc->target == LOUDCOMP_FLAT;
+}
+
+/* Process stereo q31 frames in place */
+void loudcomp_q31(loudcomp_t* lc, int32_t* buf, uint32_t frames);
+
+#endif /* __LOUDCOMP_H */
@@ -0,0 +1,212 @@
+/**
+ * Loudness Compensation - Coefficient Table
+ * Generated by tools/loudcomp_table.py (make loudcomp-table), do not edit
+ */
+
+#include "loudcomp.h"
+
+static const loudcomp_coef_t loudcomp_44100[LOUDCOMP_STEPS] = {
+    /*   0 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*   5 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  10 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  15 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  20 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  25 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  30 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  35 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  40 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  45 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  50 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1324994983, -793190881, 312228990, -447005773, 217297042}},
+    /*  55 %: 25.0 phon, bass +15.00 dB, treble +3.05 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1338659169, -807153034, 316705821, -442101151, 216571283}},
+    /*  60 %: 32.0 phon, bass +15.00 dB, treble +3.02 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1335514950, -803935801, 315673872, -443225781, 216736977}},
+    /*  65 %: 38.0 phon, bass +15.00 dB, treble +2.85 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1319011793, -787093111, 310275125, -449167544, 217619527}},
+    /*  70 %: 44.0 phon, bass +15.00 dB, treble +2.59 dB */
+    {{1085363750, -2130320786, 1045695546, -2130624377, 1057013881},
+     {1294402296, -762115544, 302280180, -458151691, 218976799}},
+    /*  75 %: 51.0 phon, bass +13.10 dB, treble +2.21 dB */
+    {{1083809426, -2129418377, 1046270595, -2129675972, 1056080603},
+     {1259353597, -726835361, 291010722, -471211782, 220998916}},
+    /*  80 %: 57.0 phon, bass +10.71 dB, treble +1.84 dB */
+    {{1081898876, -2128202145, 1046879423, -2128406228, 1054832391},
+     {1226136760, -693726316, 280459583, -483889316, 223017519}},
+    /*  85 %: 63.0 phon, bass +8.27 dB, treble +1.44 dB */
+    {{1079999239, -2126868493, 1047369773, -2127022190, 1053473490},
+     {1191384036, -659439072, 269558324, -497481376, 225242839}},
+    /*  90 %: 70.0 phon, bass +5.40 dB, treble +0.95 dB */
+    {{1077798966, -2125159754, 1047784639, -2125257839, 1051743696},
+     {1150052539, -619148624, 256781296, -514107731, 228051118}},
+    /*  95 %: 76.0 phon, bass +2.91 dB, treble +0.52 dB */
+    {{1075923891, -2123558613, 1048001822, -2123610925, 1050131577},
+     {1114605125, -585032818, 245989973, -528789540, 230609995}},
+    /* 100 %: 83.0 phon, bass +0.00 dB, treble +0.00 dB */
+    {{1073741824, -2121522692, 1048090978, -2121522692, 1048090978},
+     {1073741824, -546229238, 233746146, -546229238, 233746146}},
+};
+
+static const loudcomp_coef_t loudcomp_48000[LOUDCOMP_STEPS] = {
+    /*   0 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*   5 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  10 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  15 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  20 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  25 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  30 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  35 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  40 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  45 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  50 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1337427739, -944963323, 349390177, -570095852, 238208620}},
+    /*  55 %: 25.0 phon, bass +15.00 dB, treble +3.05 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1351835459, -960733778, 354600863, -565343589, 237304310}},
+    /*  60 %: 32.0 phon, bass +15.00 dB, treble +3.02 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1348519575, -957099871, 353399712, -566433407, 237510999}},
+    /*  65 %: 38.0 phon, bass +15.00 dB, treble +2.85 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1331121020, -938075783, 347116178, -572190021, 238609612}},
+    /*  70 %: 44.0 phon, bass +15.00 dB, treble +2.59 dB */
+    {{1084414903, -2131737754, 1047946622, -2131994178, 1058363278},
+     {1305194060, -909862918, 337812254, -580890297, 240291869}},
+    /*  75 %: 51.0 phon, bass +13.10 dB, treble +2.21 dB */
+    {{1082988011, -2130905240, 1048476096, -2131122821, 1057504702},
+     {1268306479, -870011734, 324700430, -593529330, 242782681}},
+    /*  80 %: 57.0 phon, bass +10.71 dB, treble +1.84 dB */
+    {{1081233876, -2129783838, 1049036642, -2129956228, 1056356304},
+     {1233388500, -832610796, 312427415, -605788641, 245251936}},
+    /*  85 %: 63.0 phon, bass +8.27 dB, treble +1.44 dB */
+    {{1079489513, -2128554788, 1049488087, -2128684624, 1055105941},
+     {1196900588, -793875562, 299750441, -618921940, 247955584}},
+    /*  90 %: 70.0 phon, bass +5.40 dB, treble +0.95 dB */
+    {{1077468781, -2126980732, 1049870024, -2127063595, 1053514118},
+     {1153566688, -748352165, 284896730, -634972574, 251342004}},
+    /*  95 %: 76.0 phon, bass +2.91 dB, treble +0.52 dB */
+    {{1075746448, -2125506262, 1050069962, -2125550458, 1052030390},
+     {1116456706, -709798357, 272355618, -649132726, 254404869}},
+    /* 100 %: 83.0 phon, bass +0.00 dB, treble +0.00 dB */
+    {{1073741824, -2123631843, 1050152038, -2123631843, 1050152038},
+     {1073741824, -665936659, 258131494, -665936659, 258131494}},
+};
+
+static const loudcomp_coef_t loudcomp_96000[LOUDCOMP_STEPS] = {
+    /*   0 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*   5 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  10 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  15 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  20 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  25 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  30 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  35 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  40 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  45 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  50 %: 20.0 phon, bass +15.00 dB, treble +2.91 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1413424650, -1884220778, 714386156, -1312752255, 482600460}},
+    /*  55 %: 25.0 phon, bass +15.00 dB, treble +3.05 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1432509070, -1913271887, 725963446, -1309662921, 481121725}},
+    /*  60 %: 32.0 phon, bass +15.00 dB, treble +3.02 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1428112302, -1906575706, 723294066, -1310371838, 481460675}},
+    /*  65 %: 38.0 phon, bass +15.00 dB, treble +2.85 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1405087032, -1871540439, 709335898, -1314112006, 483252673}},
+    /*  70 %: 44.0 phon, bass +15.00 dB, treble +2.59 dB */
+    {{1079065393, -2139674546, 1060765655, -2139738882, 1066024888},
+     {1370915843, -1819645544, 688687083, -1319750555, 485966113}},
+    /*  75 %: 51.0 phon, bass +13.10 dB, treble +2.21 dB */
+    {{1078355189, -2139248582, 1061033639, -2139303183, 1065592403},
+     {1322593217, -1746469865, 659625723, -1327911586, 489918838}},
+    /*  80 %: 57.0 phon, bass +10.71 dB, treble +1.84 dB */
+    {{1077481474, -2138676583, 1061317273, -2138719856, 1065013651},
+     {1277175465, -1677927213, 632465039, -1335793551, 493765018}},
+    /*  85 %: 63.0 phon, bass +8.27 dB, treble +1.44 dB */
+    {{1076611930, -2138051412, 1061545646, -2138084013, 1064383152},
+     {1230060462, -1607074045, 604453279, -1344200761, 497898633}},
+    /*  90 %: 70.0 phon, bass +5.40 dB, treble +0.95 dB */
+    {{1075603747, -2137252622, 1061738816, -2137273436, 1063579926},
+     {1174574188, -1523976197, 571688235, -1354424490, 502968892}},
+    /*  95 %: 76.0 phon, bass +2.91 dB, treble +0.52 dB */
+    {{1074743699, -2136505692, 1061839924, -2136516797, 1062830694},
+     {1127471815, -1453742257, 544072961, -1363397958, 507458654}},
+    /* 100 %: 83.0 phon, bass +0.00 dB, treble +0.00 dB */
+    {{1073741824, -2135557383, 1061881427, -2135557383, 1061881427},
+     {1073741824, -1373991412, 512806799, -1373991412, 512806799}},
+};
+
+const loudcomp_table_t loudcomp_tables[] = {
+    {44100, loudcomp_44100},
+    {48000, loudcomp_48000},
+    {96000, loudcomp_96000},
+};
+
+const uint32_t loudcomp_table_count = sizeof(loudcomp_tables) / sizeof(loudcomp_tables[0]);
@@ -0,0 +1,179 @@
+/**
+ * Sample Rate Converter - Implementation
+ */
+
+#include "resample.h"
+#include "dsp.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RESAMPLE_KAISER_BETA  7.0
+#define RESAMPLE_CUTOFF       0.90   // Fraction of the lower Nyquist
+
+/* Zeroth order modified Bessel function (Kaiser window) */
+static double resample_bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+/**
+ * Design the phase table: phase p holds taps for a fractional delay of
+ * p / RESAMPLE_PHASES, each phase normalized to unity DC gain
+ */
+static void resample_design(resample_t* rs) {
+    double fc = RESAMPLE_CUTOFF;
+    if (rs->out_rate < rs->in_rate) {
+        fc *= (double)rs->out_rate / rs->in_rate;
+    }
+
+    const double half = RESAMPLE_TAPS / 2.0;
+    const double i0_beta = resample_bessel_i0(RESAMPLE_KAISER_BETA);
+    double taps[RESAMPLE_TAPS];
+
+    for (int p = 0; p <= RESAMPLE_PHASES; p++) {
+        double frac = (double)p / RESAMPLE_PHASES;
+        double sum = 0.0;
+
+        for (int k = 0; k < RESAMPLE_TAPS; k++) {
+            double d = k - (half - 1.0) - frac;   // distance from output instant
+            double x = fc * d;
+            double sinc = (fabs(x) < 1e-9) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double r = d / half;
+            double w = (fabs(r) >= 1.0) ? 0.0 :
+                       resample_bessel_i0(RESAMPLE_KAISER_BETA * sqrt(1.0 - r * r)) / i0_beta;
+            taps[k] = fc * sinc * w;
+            sum += taps[k];
+        }
+
+        for (int k = 0; k < RESAMPLE_TAPS; k++) {
+            rs->coef[p * RESAMPLE_TAPS + k] = dsp_sat16((int32_t)lrint(taps[k] / sum * 32768.0));
+        }
+    }
+}
+
+/**
+ * Initialize converter for a rate pair
+ */
+int resample_init(resample_t* rs, uint32_t in_rate, uint32_t out_rate) {
+    if (in_rate == 0 || out_rate == 0) return RESAMPLE_ERROR;
+
+    /* Downsampling by more than 2:1 would need longer filters */
+    if (in_rate > out_rate * 2) return RESAMPLE_ERROR;
+
+    rs->in_rate = in_rate;
+    rs->out_rate = out_rate;
+    rs->step = ((uint64_t)in_rate << 32) / out_rate;
+    resample_design(rs);
+    resample_reset(rs);
+
+    return RESAMPLE_OK;
+}
+
+/**
+ * Flush history (seek/track change); primes the filter delay with silence
+ */
+void resample_reset(resample_t* rs) {
+    rs->fill = RESAMPLE_TAPS / 2 - 1;
+    rs->flush_left = RESAMPLE_TAPS / 2;
+    rs->pos = 0;
+    memset(rs->history, 0, sizeof(rs->history));
+}
+
+uint32_t resample_max_output(const resample_t* rs, uint32_t in_frames) {
+    return (uint32_t)((((uint64_t)in_frames + RESAMPLE_TAPS) << 32) / rs->step) + 1;
+}
+
+/**
+ * Filter one output frame at the current position
+ */
+static inline void resample_frame(const resample_t* rs, int16_t* out) {
+    uint32_t idx = (uint32_t)(rs->pos >> 32);
+    uint32_t frac = (uint32_t)rs->pos;
+    uint32_t phase = frac >> (32 - RESAMPLE_PHASE_BITS);
+    int32_t interp = (int32_t)((frac >> (32 - RESAMPLE_PHASE_BITS - 15)) & 0x7FFF);
+
+    const int16_t* c0 = &rs->coef[phase * RESAMPLE_TAPS];
+    const int16_t* c1 = c0 + RESAMPLE_TAPS;
+    const int16_t* x = &rs->history[idx * 2];
+
+    int64_t l0 = 0, r0 = 0, l1 = 0, r1 = 0;
+    for (int k = 0; k < RESAMPLE_TAPS; k++) {
+        int32_t xl = x[2 * k];
+        int32_t xr = x[2 * k + 1];
+        l0 += xl * c0[k];
+        r0 += xr * c0[k];
+        l1 += xl * c1[k];
+        r1 += xr * c1[k];
+    }
+
+    int64_t l = l0 + (((l1 - l0) * interp) >> 15);
+    int64_t r = r0 + (((r1 - r0) * interp) >> 15);
+    out[0] = dsp_sat16((int32_t)((l + 0x4000) >> 15));
+    out[1] = dsp_sat16((int32_t)((r + 0x4000) >> 15));
+}
+
+/**
+ * Convert a block of stereo frames (in == NULL feeds silence)
+ */
+static uint32_t resample_run(resample_t* rs, const int16_t* in, uint32_t in_frames,
+                             uint32_t* consumed, int16_t* out, uint32_t out_frames) {
+    uint32_t produced = 0;
+    uint32_t taken = 0;
+
+    for (;;) {
+        while (produced < out_frames &&
+               (uint32_t)(rs->pos >> 32) + RESAMPLE_TAPS <= rs->fill) {
+            resample_frame(rs, &out[produced * 2]);
+            produced++;
+            rs->pos += rs->step;
+        }
+
+        /* Drop history the filter has moved past */
+        uint32_t drop = (uint32_t)(rs->pos >> 32);
+        if (drop > rs->fill) drop = rs->fill;
+        if (drop > 0) {
+            memmove(rs->history, &rs->history[drop * 2],
+                    (rs->fill - drop) * 2 * sizeof(int16_t));
+            rs->fill -= drop;
+            rs->pos -= (uint64_t)drop << 32;
+        }
+
+        if (produced >= out_frames || taken >= in_frames) break;
+
+        uint32_t n = in_frames - taken;
+        uint32_t room = RESAMPLE_TAPS + RESAMPLE_BLOCK - rs->fill;
+        if (n > room) n = room;
+
+        if (in) {
+            memcpy(&rs->history[rs->fill * 2], &in[taken * 2], n * 2 * sizeof(int16_t));
+        } else {
+            memset(&rs->history[rs->fill * 2], 0, n * 2 * sizeof(int16_t));
+        }
+        rs->fill += n;
+        taken += n;
+    }
+
+    if (consumed) *consumed = taken;
+    return produced;
+}
+
+uint32_t resample_process(resample_t* rs, const int16_t* in, uint32_t in_frames,
+                          uint32_t* consumed, int16_t* out, uint32_t out_frames) {
+    return resample_run(rs, in, in_frames, consumed, out, out_frames);
+}
+
+uint32_t resample_flush(resample_t* rs, int16_t* out, uint32_t out_frames) {
+    uint32_t padded = 0;
+    uint32_t n = resample_run(rs, NULL, rs->flush_left, &padded, out, out_frames);
+    rs->flush_left -= padded;
+    return n;
+}
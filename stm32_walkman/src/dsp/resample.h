@@ -0,0 +1,58 @@
+/**
+ * Sample Rate Converter
+ *
+ * Polyphase windowed-sinc resampler for interleaved stereo s16 audio at
+ * arbitrary rate ratios (22.05k/32k/48k/96k -> 44.1k and the reverse).
+ * Each output frame is the linear interpolation of the two nearest of
+ * RESAMPLE_PHASES filter phases; the table is designed once per ratio with
+ * the cutoff lowered for downsampling so the stop band lands below the
+ * output Nyquist.
+ */
+
+#ifndef __RESAMPLE_H
+#define __RESAMPLE_H
+
+#include <stdint.h>
+
+#define RESAMPLE_TAPS      32     // Filter length per phase (input frames)
+#define RESAMPLE_PHASE_BITS 7
+#define RESAMPLE_PHASES    (1 << RESAMPLE_PHASE_BITS)  // Phase table resolution
+#define RESAMPLE_BLOCK     256    // Input frames buffered per pass
+
+typedef enum {
+    RESAMPLE_OK = 0,
+    RESAMPLE_ERROR = 1
+} resample_status_t;
+
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+    uint64_t step;            // Input frames per output frame, Q32.32
+    uint64_t pos;             // Read position in history, Q32.32
+    uint32_t fill;            // Frames held in history
+    uint32_t flush_left;      // Silence still to append at end of stream
+    int16_t history[(RESAMPLE_TAPS + RESAMPLE_BLOCK) * 2];
+    int16_t coef[(RESAMPLE_PHASES + 1) * RESAMPLE_TAPS];  // Q15
+} resample_t;
+
+int resample_init(resample_t* rs, uint32_t in_rate, uint32_t out_rate);
+void resample_reset(resample_t* rs);
+
+/* Upper bound on output frames produced for in_frames of input */
+uint32_t resample_max_output(const resample_t* rs, uint32_t in_frames);
+
+/**
+ * Convert up to in_frames input frames into at most out_frames output
+ * frames. Returns frames written; *consumed receives input frames taken.
+ * Output lags input by RESAMPLE_TAPS/2 frames of filter delay.
+ */
+uint32_t resample_process(resample_t* rs, const int16_t* in, uint32_t in_frames,
+                          uint32_t* consumed, int16_t* out, uint32_t out_frames);
+
+/**
+ * End of stream: emit what is still buffered, padding the filter with
+ * silence so the last input frames come out. Call until it returns 0.
+ */
+uint32_t resample_flush(resample_t* rs, int16_t* out, uint32_t out_frames);
+
+#endif /* __RESAMPLE_H */
@@ -0,0 +1,239 @@
+/**
+ * Time Stretch (WSOLA) - Implementation
+ */
+
+#include "wsola.h"
+#include "dsp.h"
+#include <math.h>
+#include <string.h>
+
+#define WSOLA_FRAME_BYTES (2 * sizeof(int16_t))
+
+/* One stereo frame as a packed word (a single LDR) */
+static inline uint32_t wsola_frame(const int16_t* p) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/**
+ * Set up for a rate and a speed
+ * The window lengths scale with the rate; the input buffer holds what one
+ * sequence needs at up to 2x and WSOLA_MAX_RATE.
+ */
+int wsola_init(wsola_t* ws, uint32_t sample_rate, uint32_t speed) {
+    if (sample_rate == 0 || sample_rate > WSOLA_MAX_RATE ||
+        speed < WSOLA_SPEED_MIN || speed > WSOLA_SPEED_MAX) {
+        return WSOLA_ERROR;
+    }
+
+    uint32_t sequence = sample_rate * WSOLA_SEQUENCE_MS / 1000;
+    uint32_t seek = sample_rate * WSOLA_SEEK_MS / 1000;
+    uint32_t overlap = sample_rate * WSOLA_OVERLAP_MS / 1000;
+    uint32_t hop = (uint32_t)(((uint64_t)(sequence - overlap) << 16) * speed / 100);
+    uint32_t need = sequence + seek;
+
+    if ((hop >> 16) + 1 > need) need = (hop >> 16) + 1;
+    if (overlap == 0 || overlap > WSOLA_MAX_OVERLAP || need > WSOLA_BUFFER_FRAMES) {
+        return WSOLA_ERROR;
+    }
+
+    ws->sample_rate = sample_rate;
+    ws->speed = speed;
+    ws->sequence = sequence;
+    ws->seek = seek;
+    ws->overlap = overlap;
+    ws->hop = hop;
+    ws->need = need;
+    wsola_reset(ws);
+    return WSOLA_OK;
+}
+
+/**
+ * Drop the buffered input (new track, seek); the next sequence starts
+ * without a crossfade
+ */
+void wsola_reset(wsola_t* ws) {
+    ws->hop_frac = 0;
+    ws->fill = 0;
+    ws->offset = 0;
+    ws->emitted = 0;
+    ws->emitting = 0;
+    ws->primed = 0;
+    ws->fade = 0;
+    ws->flushing = 0;
+    ws->flush_left = 0;
+}
+
+/* Sum of frame . frame over n frames (both channels) */
+static int64_t wsola_energy(const int16_t* p, uint32_t n) {
+    int64_t energy = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t f = wsola_frame(&p[i * 2]);
+        energy = dsp_smlald(f, f, energy);
+    }
+    return energy;
+}
+
+/* Correlation of the held overlap with the candidate at offset, over the
+ * square root of the candidate's energy */
+static float wsola_score(const wsola_t* ws, uint32_t offset, int64_t energy) {
+    const int16_t* cand = &ws->buffer[offset * 2];
+    int64_t corr = 0;
+
+    for (uint32_t i = 0; i < ws->overlap; i++) {
+        corr = dsp_smlald(wsola_frame(&ws->held[i * 2]), wsola_frame(&cand[i * 2]), corr);
+    }
+    return (energy > 0) ? (float)corr / sqrtf((float)energy) : 0.0f;
+}
+
+/**
+ * Offset in [0, seek) that continues the held overlap best: every
+ * WSOLA_COARSE_STEP-th offset first (the energy slides along with it),
+ * then the neighbours of the winner
+ */
+static uint32_t wsola_search(const wsola_t* ws) {
+    const uint32_t overlap = ws->overlap;
+    int64_t energy = wsola_energy(ws->buffer, overlap);
+    uint32_t best = 0;
+    float best_score = -INFINITY;
+
+    for (uint32_t offset = 0; offset < ws->seek; offset += WSOLA_COARSE_STEP) {
+        float score = wsola_score(ws, offset, energy);
+        if (score > best_score) {
+            best_score = score;
+            best = offset;
+        }
+        energy += wsola_energy(&ws->buffer[(offset + overlap) * 2], WSOLA_COARSE_STEP) -
+                  wsola_energy(&ws->buffer[offset * 2], WSOLA_COARSE_STEP);
+    }
+
+    uint32_t lo = (best >= WSOLA_COARSE_STEP - 1) ? best - (WSOLA_COARSE_STEP - 1) : 0;
+    uint32_t hi = best + WSOLA_COARSE_STEP - 1;
+    uint32_t center = best;
+    if (hi >= ws->seek) hi = ws->seek - 1;
+    energy = wsola_energy(&ws->buffer[lo * 2], overlap);
+    for (uint32_t offset = lo; offset <= hi; offset++) {
+        if (offset != center) {
+            float score = wsola_score(ws, offset, energy);
+            if (score > best_score) {
+                best_score = score;
+                best = offset;
+            }
+        }
+        energy += wsola_energy(&ws->buffer[(offset + overlap) * 2], 1) -
+                  wsola_energy(&ws->buffer[offset * 2], 1);
+    }
+    return best;
+}
+
+/* Next sequence: the first one of a stream is taken as it comes */
+static void wsola_start(wsola_t* ws) {
+    ws->offset = ws->primed ? wsola_search(ws) : 0;
+    ws->fade = ws->primed;
+    ws->emitted = 0;
+    ws->emitting = 1;
+}
+
+/**
+ * Sequence done: keep the overlap that follows it and advance the input
+ * by the hop (fractions carried, so the average ratio is exact)
+ */
+static void wsola_advance(wsola_t* ws) {
+    uint32_t hop = ws->hop + ws->hop_frac;
+    uint32_t skip = hop >> 16;
+
+    memcpy(ws->held, &ws->buffer[(ws->offset + ws->sequence - ws->overlap) * 2],
+           ws->overlap * WSOLA_FRAME_BYTES);
+    ws->hop_frac = hop & 0xFFFF;
+    if (ws->flushing) ws->flush_left -= (int32_t)skip;
+    ws->fill -= skip;
+    memmove(ws->buffer, &ws->buffer[skip * 2], ws->fill * WSOLA_FRAME_BYTES);
+    ws->emitting = 0;
+    ws->primed = 1;
+}
+
+/**
+ * Write the current sequence on from where the last call stopped; its
+ * first overlap frames crossfade from the held ones (Q15 ramp)
+ */
+static uint32_t wsola_emit(wsola_t* ws, int16_t* out, uint32_t out_frames) {
+    uint32_t length = ws->sequence - ws->overlap;
+    uint32_t n = length - ws->emitted;
+    const int16_t* src = &ws->buffer[ws->offset * 2];
+
+    if (n > out_frames) n = out_frames;
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t i = ws->emitted + k;
+        if (ws->fade && i < ws->overlap) {
+            int32_t w = (int32_t)((i << 15) / ws->overlap);
+            for (int ch = 0; ch < 2; ch++) {
+                int32_t a = ws->held[i * 2 + ch];
+                int32_t b = src[i * 2 + ch];
+                out[k * 2 + ch] = (int16_t)(a + (((b - a) * w) >> 15));
+            }
+        } else {
+            out[k * 2] = src[i * 2];
+            out[k * 2 + 1] = src[i * 2 + 1];
+        }
+    }
+
+    ws->emitted += n;
+    if (ws->emitted == length) {
+        wsola_advance(ws);
+    }
+    return n;
+}
+
+uint32_t wsola_process(wsola_t* ws, const int16_t* in, uint32_t in_frames,
+                       uint32_t* consumed, int16_t* out, uint32_t out_frames) {
+    uint32_t produced = 0, taken = 0;
+
+    while (produced < out_frames) {
+        if (ws->emitting) {
+            produced += wsola_emit(ws, &out[produced * 2], out_frames - produced);
+            continue;
+        }
+        if (ws->fill < ws->need) {
+            uint32_t n = ws->need - ws->fill;
+            if (n > in_frames - taken) n = in_frames - taken;
+            if (n == 0) break;
+            memcpy(&ws->buffer[ws->fill * 2], &in[taken * 2], n * WSOLA_FRAME_BYTES);
+            ws->fill += n;
+            taken += n;
+            continue;
+        }
+
+        wsola_start(ws);
+    }
+
+    *consumed = taken;
+    return produced;
+}
+
+/**
+ * Pad the input with silence and keep going until the sequences have
+ * moved past the last real frame
+ */
+uint32_t wsola_flush(wsola_t* ws, int16_t* out, uint32_t out_frames) {
+    uint32_t produced = 0;
+
+    if (!ws->flushing) {
+        ws->flushing = 1;
+        ws->flush_left = (int32_t)ws->fill;
+    }
+
+    while (produced < out_frames) {
+        if (ws->emitting) {
+            produced += wsola_emit(ws, &out[produced * 2], out_frames - produced);
+            continue;
+        }
+        if (ws->flush_left <= 0) break;
+        if (ws->fill < ws->need) {
+            memset(&ws->buffer[ws->fill * 2], 0, (ws->need - ws->fill) * WSOLA_FRAME_BYTES);
+            ws->fill = ws->need;
+        }
+        wsola_start(ws);
+    }
+    return produced;
+}
@@ -0,0 +1,76 @@
+/**
+ * Time Stretch (WSOLA)
+ *
+ * Changes the playback speed of interleaved stereo s16 audio without
+ * changing its pitch. The output is built from sequences of the input
+ * taken WSOLA_SEQUENCE_MS apart on the output side and speed times that
+ * apart on the input side; each sequence starts at the offset within
+ * WSOLA_SEEK_MS whose first WSOLA_OVERLAP_MS best matches (normalized
+ * cross-correlation) what followed the previous one, and is crossfaded
+ * into it linearly. The correlation runs on packed stereo frames, one
+ * dual 16-bit MAC per frame (dsp_smlald), with a coarse pass every
+ * WSOLA_COARSE_STEP offsets refined around the best one.
+ *
+ * Streaming like resample_process: input is buffered only as far as the
+ * next sequence needs, output is written as the caller has room. The
+ * buffers are sized for WSOLA_MAX_RATE (9KB); faster streams play at 1x.
+ */
+
+#ifndef __WSOLA_H
+#define __WSOLA_H
+
+#include <stdint.h>
+
+#define WSOLA_SPEED_MIN 75          // Percent
+#define WSOLA_SPEED_MAX 200
+#define WSOLA_SEQUENCE_MS 25
+#define WSOLA_SEEK_MS 10
+#define WSOLA_OVERLAP_MS 5
+#define WSOLA_COARSE_STEP 4
+#define WSOLA_MAX_RATE 48000
+#define WSOLA_BUFFER_FRAMES 2048    // Input for one sequence at 2x and 48kHz
+#define WSOLA_MAX_OVERLAP 256
+
+typedef enum {
+    WSOLA_OK = 0,
+    WSOLA_ERROR = 1
+} wsola_status_t;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t speed;             // Percent
+    uint32_t sequence, seek, overlap;   // Frames
+    uint32_t need;              // Input frames buffered before a sequence starts
+    uint32_t hop;               // Input frames per sequence, Q16.16
+    uint32_t hop_frac;          // Fraction carried to the next sequence
+    uint32_t fill;              // Frames in buffer
+    uint32_t offset;            // Start of the current sequence in buffer
+    uint32_t emitted;           // Frames of it written
+    uint8_t emitting;           // A sequence is being written
+    uint8_t primed;             // held is valid: crossfade into the next sequence
+    uint8_t fade;               // Current sequence crossfades from held
+    uint8_t flushing;
+    int32_t flush_left;         // Real input frames not yet passed at end of stream
+    int16_t buffer[WSOLA_BUFFER_FRAMES * 2] __attribute__((aligned(4)));
+    int16_t held[WSOLA_MAX_OVERLAP * 2] __attribute__((aligned(4)));  // Overlap after the last sequence
+} wsola_t;
+
+/* WSOLA_ERROR for speeds outside WSOLA_SPEED_MIN..MAX or rates above WSOLA_MAX_RATE */
+int wsola_init(wsola_t* ws, uint32_t sample_rate, uint32_t speed);
+void wsola_reset(wsola_t* ws);
+
+/**
+ * Stretch up to in_frames input frames into at most out_frames output
+ * frames. Returns frames written; *consumed receives input frames taken.
+ * Output lags input by up to one sequence plus the seek window.
+ */
+uint32_t wsola_process(wsola_t* ws, const int16_t* in, uint32_t in_frames,
+                       uint32_t* consumed, int16_t* out, uint32_t out_frames);
+
+/**
+ * End of stream: stretch what is still buffered, padded with silence.
+ * Call until it returns 0.
+ */
+uint32_t wsola_flush(wsola_t* ws, int16_t* out, uint32_t out_frames);
+
+#endif /* __WSOLA_H */
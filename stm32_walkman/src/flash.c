@@ -0,0 +1,172 @@
+/**
+ * Bare Metal Internal Flash Implementation - STM32F407
+ * Direct register access to the flash interface (RM0090 section 3)
+ *
+ * Operations run at 32-bit parallelism (PSIZE x32, VDD 2.7-3.6 V). The
+ * control register is unlocked for one operation and locked again, so a
+ * runaway write elsewhere cannot reach the array. Instruction fetches from
+ * flash stall while the array is busy: an erase holds off every interrupt
+ * whose handler lives in flash, programming a word costs ~16 us.
+ */
+
+#include "flash.h"
+#include "stm32f4xx.h"
+#include <stddef.h>
+
+/* Flash memory word at a bus address (the host fakes map it to a buffer) */
+#ifndef FLASH_MEMORY_WORD
+#define FLASH_MEMORY_WORD(address) (*(volatile uint32_t*)(uintptr_t)(address))
+#endif
+
+/* Unlock sequence for FLASH_CR (RM0090 3.5.1) */
+#define FLASH_KEY1 0x45670123u
+#define FLASH_KEY2 0xCDEF89ABu
+
+/* Program size x32 */
+#define FLASH_PSIZE_WORD (2u << FLASH_CR_PSIZE_Pos)
+
+/* SR flags that end an operation with an error */
+#define FLASH_SR_ERRORS (FLASH_SR_OPERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR | \
+                         FLASH_SR_PGPERR | FLASH_SR_PGSERR)
+
+/* BSY polls before giving up (an erase stalls the poll loop itself) */
+#define FLASH_TIMEOUT_POLLS 50000000u
+
+/* Sector sizes in KB */
+static const uint16_t flash_sector_kb[FLASH_SECTOR_COUNT] = {
+    16, 16, 16, 16, 64, 128, 128, 128, 128, 128, 128, 128
+};
+
+/**
+ * First address of a sector (0 if out of range)
+ */
+uint32_t flash_sector_address(uint8_t sector) {
+    if (sector >= FLASH_SECTOR_COUNT) return 0;
+
+    uint32_t address = FLASH_MEMORY_BASE;
+    for (uint8_t i = 0; i < sector; i++) {
+        address += flash_sector_kb[i] * 1024u;
+    }
+    return address;
+}
+
+/**
+ * Sector size in bytes (0 if out of range)
+ */
+uint32_t flash_sector_size(uint8_t sector) {
+    return sector < FLASH_SECTOR_COUNT ? flash_sector_kb[sector] * 1024u : 0;
+}
+
+/**
+ * Wait for BSY to clear and collect the error flags
+ */
+static int flash_wait(void) {
+    uint32_t polls = 0;
+
+    while (READ_BIT(FLASH->SR, FLASH_SR_BSY)) {
+        if (++polls >= FLASH_TIMEOUT_POLLS) return FLASH_ERROR_TIMEOUT;
+    }
+
+    uint32_t sr = READ_REG(FLASH->SR);
+    if (sr & FLASH_SR_ERRORS) {
+        WRITE_REG(FLASH->SR, sr & FLASH_SR_ERRORS);  /* rc_w1 */
+        return (sr & FLASH_SR_WRPERR) ? FLASH_ERROR_PROTECTED : FLASH_ERROR;
+    }
+    return FLASH_OK;
+}
+
+/**
+ * Unlock FLASH_CR and clear flags left by an earlier operation
+ */
+static int flash_unlock(void) {
+    if (READ_BIT(FLASH->CR, FLASH_CR_LOCK)) {
+        WRITE_REG(FLASH->KEYR, FLASH_KEY1);
+        WRITE_REG(FLASH->KEYR, FLASH_KEY2);
+        if (READ_BIT(FLASH->CR, FLASH_CR_LOCK)) {
+            return FLASH_ERROR;  /* Locked until reset after a bad key */
+        }
+    }
+    WRITE_REG(FLASH->SR, FLASH_SR_EOP | FLASH_SR_ERRORS);
+    return FLASH_OK;
+}
+
+static void flash_lock(void) {
+    SET_BIT(FLASH->CR, FLASH_CR_LOCK);
+}
+
+/**
+ * Erase one sector
+ * The data cache may hold lines of the old contents; it is reset after
+ * the erase so reads see 0xFF.
+ */
+int flash_erase_sector(uint8_t sector) {
+    if (sector >= FLASH_SECTOR_COUNT) return FLASH_ERROR_ARGUMENT;
+
+    int status = flash_unlock();
+    if (status != FLASH_OK) return status;
+
+    status = flash_wait();
+    if (status == FLASH_OK) {
+        WRITE_REG(FLASH->CR, FLASH_PSIZE_WORD | FLASH_CR_SER |
+                             ((uint32_t)sector << FLASH_CR_SNB_Pos));
+        SET_BIT(FLASH->CR, FLASH_CR_STRT);
+        status = flash_wait();
+        CLEAR_BIT(FLASH->CR, FLASH_CR_SER | FLASH_CR_SNB);
+    }
+    flash_lock();
+
+    if (READ_BIT(FLASH->ACR, FLASH_ACR_DCEN)) {
+        CLEAR_BIT(FLASH->ACR, FLASH_ACR_DCEN);
+        SET_BIT(FLASH->ACR, FLASH_ACR_DCRST);
+        CLEAR_BIT(FLASH->ACR, FLASH_ACR_DCRST);
+        SET_BIT(FLASH->ACR, FLASH_ACR_DCEN);
+    }
+    return status;
+}
+
+/**
+ * Program words; stops at the first word that fails
+ * Bits only go from 1 to 0: the target range should be erased.
+ */
+int flash_program(uint32_t address, const void* data, uint32_t len) {
+    const uint8_t* src = (const uint8_t*)data;
+
+    if ((address & 3) || (len & 3) || address < FLASH_MEMORY_BASE ||
+        address - FLASH_MEMORY_BASE + len > FLASH_MEMORY_SIZE) {
+        return FLASH_ERROR_ARGUMENT;
+    }
+
+    int status = flash_unlock();
+    if (status != FLASH_OK) return status;
+
+    status = flash_wait();
+    if (status == FLASH_OK) {
+        WRITE_REG(FLASH->CR, FLASH_PSIZE_WORD | FLASH_CR_PG);
+        for (uint32_t i = 0; i < len && status == FLASH_OK; i += 4) {
+            uint32_t word = (uint32_t)src[i] | ((uint32_t)src[i + 1] << 8) |
+                            ((uint32_t)src[i + 2] << 16) | ((uint32_t)src[i + 3] << 24);
+            WRITE_REG(FLASH_MEMORY_WORD(address + i), word);
+            status = flash_wait();
+        }
+        CLEAR_BIT(FLASH->CR, FLASH_CR_PG);
+    }
+    flash_lock();
+
+    return status;
+}
+
+/**
+ * Read bytes through aligned word accesses
+ */
+void flash_read(uint32_t address, void* data, uint32_t len) {
+    uint8_t* dst = (uint8_t*)data;
+    uint32_t i = 0;
+
+    while (i < len) {
+        uint32_t a = address + i;
+        uint32_t word = READ_REG(FLASH_MEMORY_WORD(a & ~3u));
+        for (uint32_t byte = a & 3; byte < 4 && i < len; byte++) {
+            dst[i++] = (uint8_t)(word >> (byte * 8));
+        }
+    }
+}
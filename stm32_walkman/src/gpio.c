@@ -4,7 +4,7 @@
  */
 
 #include "gpio.h"
-#include "stm32f407xx.h"
+#include "stm32f4xx.h"
 
 /* GPIO base addresses */
 static GPIO_TypeDef* const gpio_bases[9] = {
@@ -18,10 +18,10 @@ void gpio_init_port(gpio_port_t port) {
     if (port >= 9) return;
     
     /* Enable clock for the GPIO port */
-    RCC->AHB1ENR |= (1 << port);
+    SET_BIT(RCC->AHB1ENR, 1u << port);
     
     /* Read back for synchronization */
-    (void)RCC->AHB1ENR;
+    (void)READ_REG(RCC->AHB1ENR);
 }
 
 /**
@@ -45,22 +45,18 @@ void gpio_config(gpio_port_t port, gpio_pin_t pin, gpio_mode_t mode,
     gpio_init_port(port);
     
     /* Configure mode bits (MODER register) */
-    gpio->MODER &= ~(3 << (pin * 2));
-    gpio->MODER |= (mode << (pin * 2));
+    MODIFY_REG(gpio->MODER, 3u << (pin * 2), (uint32_t)mode << (pin * 2));
     
     /* Configure output type (OTYPER register) */
     if (mode == GPIO_MODE_OUTPUT || mode == GPIO_MODE_ALT_FUNC) {
-        gpio->OTYPER &= ~(1 << pin);
-        gpio->OTYPER |= (output_type << pin);
+        MODIFY_REG(gpio->OTYPER, 1u << pin, (uint32_t)output_type << pin);
     }
     
     /* Configure speed (OSPEEDR register) */
-    gpio->OSPEEDR &= ~(3 << (pin * 2));
-    gpio->OSPEEDR |= (speed << (pin * 2));
+    MODIFY_REG(gpio->OSPEEDR, 3u << (pin * 2), (uint32_t)speed << (pin * 2));
     
     /* Configure pull (PUPDR register) */
-    gpio->PUPDR &= ~(3 << (pin * 2));
-    gpio->PUPDR |= (pull << (pin * 2));
+    MODIFY_REG(gpio->PUPDR, 3u << (pin * 2), (uint32_t)pull << (pin * 2));
 }
 
 /**
@@ -92,12 +88,10 @@ void gpio_config_alt_func(gpio_port_t port, gpio_pin_t pin, uint8_t alt_func) {
     /* Set the alternate function */
     if (pin < 8) {
         /* AFRL (pins 0-7) */
-        gpio->AFR[0] &= ~(15 << (pin * 4));
-        gpio->AFR[0] |= (alt_func << (pin * 4));
+        MODIFY_REG(gpio->AFR[0], 15u << (pin * 4), (uint32_t)alt_func << (pin * 4));
     } else {
         /* AFRH (pins 8-15) */
-        gpio->AFR[1] &= ~(15 << ((pin - 8) * 4));
-        gpio->AFR[1] |= (alt_func << ((pin - 8) * 4));
+        MODIFY_REG(gpio->AFR[1], 15u << ((pin - 8) * 4), (uint32_t)alt_func << ((pin - 8) * 4));
     }
 }
 
@@ -108,7 +102,7 @@ void gpio_set(gpio_port_t port, gpio_pin_t pin) {
     if (port >= 9 || pin >= 16) return;
     
     GPIO_TypeDef* gpio = gpio_bases[port];
-    gpio->BSRR = (1 << pin);  /* Set bit - atomic write */
+    WRITE_REG(gpio->BSRR, 1u << pin);  /* Set bit - atomic write */
 }
 
 /**
@@ -118,7 +112,7 @@ void gpio_clear(gpio_port_t port, gpio_pin_t pin) {
     if (port >= 9 || pin >= 16) return;
     
     GPIO_TypeDef* gpio = gpio_bases[port];
-    gpio->BSRR = (1 << (pin + 16));  /* Reset bit - atomic write */
+    WRITE_REG(gpio->BSRR, 1u << (pin + 16));  /* Reset bit - atomic write */
 }
 
 /**
@@ -128,7 +122,7 @@ void gpio_toggle(gpio_port_t port, gpio_pin_t pin) {
     if (port >= 9 || pin >= 16) return;
     
     GPIO_TypeDef* gpio = gpio_bases[port];
-    gpio->ODR ^= (1 << pin);
+    WRITE_REG(gpio->ODR, READ_REG(gpio->ODR) ^ (1u << pin));
 }
 
 /**
@@ -138,7 +132,7 @@ uint8_t gpio_read(gpio_port_t port, gpio_pin_t pin) {
     if (port >= 9 || pin >= 16) return 0;
     
     GPIO_TypeDef* gpio = gpio_bases[port];
-    return (gpio->IDR >> pin) & 1;
+    return (READ_REG(gpio->IDR) >> pin) & 1;
 }
 
 /**
@@ -154,6 +148,8 @@ void gpio_write(gpio_port_t port, gpio_pin_t pin, uint8_t value) {
     }
 }
 
+static IRQn_Type gpio_exti_irqn(gpio_pin_t pin);
+
 /**
  * Configure external interrupt for GPIO pin
  * This configures EXTI + SYSCFG for interrupt handling
@@ -161,53 +157,75 @@ void gpio_write(gpio_port_t port, gpio_pin_t pin, uint8_t value) {
 void gpio_config_interrupt(gpio_port_t port, gpio_pin_t pin, gpio_int_trigger_t trigger) {
     if (port >= 9 || pin >= 16) return;
     
-    GPIO_TypeDef* gpio = gpio_bases[port];
-    
     /* Configure pin as input first */
     gpio_config(port, pin, GPIO_MODE_INPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_PULL_UP);
     
     /* Enable SYSCFG clock for EXTI configuration */
-    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    SET_BIT(RCC->APB2ENR, RCC_APB2ENR_SYSCFGEN);
     
     /* Configure SYSCFG EXTI for the pin */
-    uint32_t exti_reg = EXTI1_Pos + (pin / 4);
     uint32_t exti_shift = (pin % 4) * 4;
     
-    SYSCFG->EXTICR[pin / 4] &= ~(15 << exti_shift);
-    SYSCFG->EXTICR[pin / 4] |= (port << exti_shift);
+    MODIFY_REG(SYSCFG->EXTICR[pin / 4], 15u << exti_shift, (uint32_t)port << exti_shift);
     
     /* Configure EXTI trigger */
-    uint32_t exti_line = 1 << pin;
+    uint32_t exti_line = 1u << pin;
     
     if (trigger == GPIO_INT_RISING) {
-        EXTI->RTSR |= exti_line;  /* Rising edge */
-        EXTI->FTSR &= ~exti_line;
+        SET_BIT(EXTI->RTSR, exti_line);  /* Rising edge */
+        CLEAR_BIT(EXTI->FTSR, exti_line);
     } else if (trigger == GPIO_INT_FALLING) {
-        EXTI->FTSR |= exti_line;  /* Falling edge */
-        EXTI->RTSR &= ~exti_line;
+        SET_BIT(EXTI->FTSR, exti_line);  /* Falling edge */
+        CLEAR_BIT(EXTI->RTSR, exti_line);
     } else if (trigger == GPIO_INT_BOTH) {
-        EXTI->RTSR |= exti_line;  /* Both edges */
-        EXTI->FTSR |= exti_line;
+        SET_BIT(EXTI->RTSR, exti_line);  /* Both edges */
+        SET_BIT(EXTI->FTSR, exti_line);
     }
     
     /* Enable EXTI interrupt */
-    EXTI->IMR |= exti_line;
+    SET_BIT(EXTI->IMR, exti_line);
     
     /* Enable NVIC interrupt for this EXTI line */
+    NVIC_EnableIRQ(gpio_exti_irqn(pin));
+}
+
+/**
+ * Get the NVIC interrupt line for an EXTI pin
+ * EXTI0-4 have dedicated vectors, 5-9 and 10-15 are shared
+ */
+static IRQn_Type gpio_exti_irqn(gpio_pin_t pin) {
     if (pin < 5) {
-        NVIC_EnableIRQ(EXTI0_IRQn + pin);
+        return (IRQn_Type)(EXTI0_IRQn + pin);
     } else if (pin < 10) {
-        NVIC_EnableIRQ(EXTI9_5_IRQn);
-    } else {
-        NVIC_EnableIRQ(EXTI15_10_IRQn);
+        return EXTI9_5_IRQn;
     }
+    return EXTI15_10_IRQn;
+}
+
+/**
+ * Set NVIC priority of the EXTI line serving a pin
+ * Lower number = higher priority
+ */
+void gpio_set_interrupt_priority(gpio_pin_t pin, uint8_t priority) {
+    if (pin >= 16) return;
+    NVIC_SetPriority(gpio_exti_irqn(pin), priority);
+}
+
+/**
+ * Check external interrupt pending flag
+ */
+uint8_t gpio_exti_pending(gpio_pin_t pin) {
+    if (pin >= 16) return 0;
+    return READ_BIT(EXTI->PR, 1u << pin) ? 1 : 0;
 }
 
 /**
  * Clear external interrupt pending flag
- * Call this in interrupt handler to clear the flag
+ * Call this in interrupt handler to clear the flag. PR is write-1-to-clear,
+ * so only this line's bit is written (a read-modify-write would also clear
+ * every other pending line).
  */
 void gpio_exti_clear(gpio_pin_t pin) {
     if (pin >= 16) return;
-    EXTI->PR |= (1 << pin);  /* Clear pending flag */
+    WRITE_REG(EXTI->PR, 1u << pin);  /* Clear pending flag */
 }
@@ -8,12 +8,16 @@
  * 
  * Pins:
  * I2C1: PB6 (SCL), PB7 (SDA) - AF4
+ *
+ * Every transfer step checks the error flags (AF = NACK, BERR, ARLO) as well
+ * as its own event flag, so a missing or misbehaving slave ends the transfer
+ * with a STOP and a -1 return instead of clocking on regardless.
  */
 
 #include "i2c.h"
 #include "gpio.h"
 #include "system.h"
-#include "stm32f407xx.h"
+#include "stm32f4xx.h"
 
 /* I2C base addresses */
 static I2C_TypeDef* const i2c_bases[4] = {NULL, I2C1, I2C2, I2C3};
@@ -21,6 +25,9 @@ static I2C_TypeDef* const i2c_bases[4] = {NULL, I2C1, I2C2, I2C3};
 /* I2C timeout in milliseconds */
 #define I2C_TIMEOUT_MS 1000
 
+/* SR1 error flags that abort a transfer */
+#define I2C_SR1_ERRORS (I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO)
+
 /**
  * Calculate I2C CCR value for given clock speed
  * F407 APB1 clock is 42 MHz
@@ -47,12 +54,14 @@ static uint16_t i2c_calculate_ccr(uint32_t clock_speed) {
 static uint16_t i2c_calculate_trise(uint32_t clock_speed) {
     uint32_t pclk = 42000000;  /* APB1 = 42MHz for I2C */
     
+    uint32_t pclk_mhz = pclk / 1000000;  /* ns * MHz / 1000 stays in 32 bits */
+    
     if (clock_speed <= 100000) {
         /* Standard mode: max rise time = 1000ns */
-        return ((1000 * pclk) / 1000000000) + 1;
+        return ((1000 * pclk_mhz) / 1000) + 1;
     } else {
         /* Fast mode: max rise time = 300ns */
-        return ((300 * pclk) / 1000000000) + 1;
+        return ((300 * pclk_mhz) / 1000) + 1;
     }
 }
 
@@ -68,7 +77,7 @@ void i2c_init(i2c_bus_t bus, uint32_t clock_speed) {
     
     if (bus == I2C_BUS_1) {
         /* Enable I2C1 clock */
-        RCC->APB1ENR |= RCC_APB1ENR_I2C1EN;
+        SET_BIT(RCC->APB1ENR, RCC_APB1ENR_I2C1EN);
         
         /* Configure PB6 (SCL), PB7 (SDA) as open-drain alternate function AF4 */
         gpio_init_port(GPIO_PORT_B);
@@ -79,28 +88,27 @@ void i2c_init(i2c_bus_t bus, uint32_t clock_speed) {
     }
     
     /* Disable I2C peripheral */
-    i2c->CR1 &= ~I2C_CR1_PE;
+    CLEAR_BIT(i2c->CR1, I2C_CR1_PE);
     
     /* Configure I2C clock */
     uint16_t ccr = i2c_calculate_ccr(clock_speed);
     uint16_t trise = i2c_calculate_trise(clock_speed);
     
     /* Set CCR value */
-    i2c->CCR &= ~0xFFF;
-    i2c->CCR |= ccr;
+    MODIFY_REG(i2c->CCR, 0xFFF, ccr);
     
     /* Set TRISE value */
-    i2c->TRISE = trise;
+    WRITE_REG(i2c->TRISE, trise);
     
     /* Enable I2C, ACK generation, generate START */
-    i2c->CR1 |= I2C_CR1_PE;
-    i2c->CR1 |= I2C_CR1_ACK;
-    i2c->CR1 |= I2C_CR1_ENGC;  /* General call */
+    SET_BIT(i2c->CR1, I2C_CR1_PE);
+    SET_BIT(i2c->CR1, I2C_CR1_ACK);
+    SET_BIT(i2c->CR1, I2C_CR1_ENGC);  /* General call */
 }
 
 /**
  * Wait for I2C event
- * Returns 1 if event occurred, 0 if timeout
+ * Returns 1 if event occurred, 0 on timeout or bus error (NACK, BERR, ARLO)
  */
 static uint8_t i2c_wait_event(i2c_bus_t bus, uint32_t event_flag) {
     I2C_TypeDef* i2c = i2c_bases[bus];
@@ -109,75 +117,96 @@ static uint8_t i2c_wait_event(i2c_bus_t bus, uint32_t event_flag) {
     uint32_t timeout = 0;
     uint32_t timeout_max = I2C_TIMEOUT_MS * 1000;  /* Approximate */
     
-    while (!(i2c->SR1 & event_flag) && timeout < timeout_max) {
+    while (timeout < timeout_max) {
+        uint32_t sr1 = READ_REG(i2c->SR1);
+        if (sr1 & I2C_SR1_ERRORS) return 0;
+        if (sr1 & event_flag) return 1;
         timeout++;
     }
     
-    return (i2c->SR1 & event_flag) ? 1 : 0;
+    return 0;
 }
 
 /**
- * I2C start condition
+ * I2C stop condition
  */
-static void i2c_start(i2c_bus_t bus) {
+static void i2c_stop(i2c_bus_t bus) {
     I2C_TypeDef* i2c = i2c_bases[bus];
     if (!i2c) return;
     
-    i2c->CR1 |= I2C_CR1_START;
-    i2c_wait_event(bus, I2C_SR1_SB);  /* Wait for START to complete */
+    SET_BIT(i2c->CR1, I2C_CR1_STOP);
 }
 
 /**
- * I2C stop condition
+ * Abort a failed transfer
+ * Error flags are rc_w0 (cleared by writing 0); STOP releases the bus
  */
-static void i2c_stop(i2c_bus_t bus) {
+static int i2c_abort(i2c_bus_t bus) {
     I2C_TypeDef* i2c = i2c_bases[bus];
-    if (!i2c) return;
     
-    i2c->CR1 |= I2C_CR1_STOP;
+    WRITE_REG(i2c->SR1, READ_REG(i2c->SR1) & ~I2C_SR1_ERRORS);
+    i2c_stop(bus);
+    SET_BIT(i2c->CR1, I2C_CR1_ACK);
+    
+    return -1;
+}
+
+/**
+ * I2C start condition
+ */
+static uint8_t i2c_start(i2c_bus_t bus) {
+    I2C_TypeDef* i2c = i2c_bases[bus];
+    if (!i2c) return 0;
+    
+    SET_BIT(i2c->CR1, I2C_CR1_START);
+    return i2c_wait_event(bus, I2C_SR1_SB);  /* Wait for START to complete */
 }
 
 /**
  * I2C send address byte
  * Bit 0 = read/write (0 for write, 1 for read)
+ * Returns 0 if the slave did not acknowledge
  */
-static void i2c_send_address(i2c_bus_t bus, uint8_t addr) {
+static uint8_t i2c_send_address(i2c_bus_t bus, uint8_t addr) {
     I2C_TypeDef* i2c = i2c_bases[bus];
-    if (!i2c) return;
+    if (!i2c) return 0;
     
-    i2c->DR = addr;
-    i2c_wait_event(bus, I2C_SR1_ADDR);  /* Wait for address sent */
+    WRITE_REG(i2c->DR, addr);
+    if (!i2c_wait_event(bus, I2C_SR1_ADDR)) return 0;  /* Wait for address sent */
     
     /* Clear ADDR flag by reading SR2 */
-    (void)i2c->SR2;
+    (void)READ_REG(i2c->SR2);
+    return 1;
 }
 
 /**
  * I2C write byte
  */
-static void i2c_write_byte(i2c_bus_t bus, uint8_t byte) {
+static uint8_t i2c_write_byte(i2c_bus_t bus, uint8_t byte) {
     I2C_TypeDef* i2c = i2c_bases[bus];
-    if (!i2c) return;
+    if (!i2c) return 0;
     
-    i2c_wait_event(bus, I2C_SR1_TXE);  /* Wait for TX ready */
-    i2c->DR = byte;
+    if (!i2c_wait_event(bus, I2C_SR1_TXE)) return 0;  /* Wait for TX ready */
+    WRITE_REG(i2c->DR, byte);
+    return 1;
 }
 
 /**
  * I2C read byte
  */
-static uint8_t i2c_read_byte(i2c_bus_t bus, uint8_t ack) {
+static uint8_t i2c_read_byte(i2c_bus_t bus, uint8_t ack, uint8_t* byte) {
     I2C_TypeDef* i2c = i2c_bases[bus];
     if (!i2c) return 0;
     
     if (ack) {
-        i2c->CR1 |= I2C_CR1_ACK;
+        SET_BIT(i2c->CR1, I2C_CR1_ACK);
     } else {
-        i2c->CR1 &= ~I2C_CR1_ACK;
+        CLEAR_BIT(i2c->CR1, I2C_CR1_ACK);
     }
     
-    i2c_wait_event(bus, I2C_SR1_RXNE);  /* Wait for RX ready */
-    return i2c->DR;
+    if (!i2c_wait_event(bus, I2C_SR1_RXNE)) return 0;  /* Wait for RX ready */
+    *byte = (uint8_t)READ_REG(i2c->DR);
+    return 1;
 }
 
 /**
@@ -187,7 +216,7 @@ uint8_t i2c_is_busy(i2c_bus_t bus) {
     I2C_TypeDef* i2c = i2c_bases[bus];
     if (!i2c) return 0;
     
-    return (i2c->SR2 & I2C_SR2_BUSY) ? 1 : 0;
+    return READ_BIT(i2c->SR2, I2C_SR2_BUSY) ? 1 : 0;
 }
 
 /**
@@ -195,6 +224,7 @@ uint8_t i2c_is_busy(i2c_bus_t bus) {
  * addr: 7-bit slave address (will be shifted left by 1)
  * data: pointer to data buffer
  * len: number of bytes to write
+ * Returns 0 on success, -1 on NACK, bus error or timeout
  */
 int i2c_write(i2c_bus_t bus, uint8_t addr, const uint8_t* data, uint32_t len) {
     if (!data || len == 0 || bus < 1 || bus > 3) return -1;
@@ -203,18 +233,18 @@ int i2c_write(i2c_bus_t bus, uint8_t addr, const uint8_t* data, uint32_t len) {
     if (!i2c) return -1;
     
     /* Generate START condition */
-    i2c_start(bus);
+    if (!i2c_start(bus)) return i2c_abort(bus);
     
     /* Send address byte (write mode = addr << 1 | 0) */
-    i2c_send_address(bus, (addr << 1) | 0);
+    if (!i2c_send_address(bus, (addr << 1) | 0)) return i2c_abort(bus);
     
     /* Write data bytes */
     for (uint32_t i = 0; i < len; i++) {
-        i2c_write_byte(bus, data[i]);
+        if (!i2c_write_byte(bus, data[i])) return i2c_abort(bus);
     }
     
     /* Wait for last byte transmitted */
-    i2c_wait_event(bus, I2C_SR1_BTF);
+    if (!i2c_wait_event(bus, I2C_SR1_BTF)) return i2c_abort(bus);
     
     /* Generate STOP condition */
     i2c_stop(bus);
@@ -227,6 +257,7 @@ int i2c_write(i2c_bus_t bus, uint8_t addr, const uint8_t* data, uint32_t len) {
  * addr: 7-bit slave address
  * data: pointer to receive buffer
  * len: number of bytes to read
+ * Returns 0 on success, -1 on NACK, bus error or timeout
  */
 int i2c_read(i2c_bus_t bus, uint8_t addr, uint8_t* data, uint32_t len) {
     if (!data || len == 0 || bus < 1 || bus > 3) return -1;
@@ -235,24 +266,22 @@ int i2c_read(i2c_bus_t bus, uint8_t addr, uint8_t* data, uint32_t len) {
     if (!i2c) return -1;
     
     /* Generate START condition */
-    i2c_start(bus);
+    if (!i2c_start(bus)) return i2c_abort(bus);
     
     /* Send address byte (read mode = addr << 1 | 1) */
-    i2c_send_address(bus, (addr << 1) | 1);
+    if (!i2c_send_address(bus, (addr << 1) | 1)) return i2c_abort(bus);
     
-    /* Read data bytes */
+    /* Read data bytes (NACK on the last one) */
     for (uint32_t i = 0; i < len; i++) {
-        if (i == (len - 1)) {
-            /* Last byte - send NACK */
-            data[i] = i2c_read_byte(bus, 0);
-        } else {
-            data[i] = i2c_read_byte(bus, 1);
-        }
+        if (!i2c_read_byte(bus, i != (len - 1), &data[i])) return i2c_abort(bus);
     }
     
     /* Generate STOP condition */
     i2c_stop(bus);
     
+    /* Re-arm ACK for the next transfer */
+    SET_BIT(i2c->CR1, I2C_CR1_ACK);
+    
     return 0;
 }
 
@@ -3,34 +3,79 @@
  * Direct register access for I2S3 with DMA support
  * 
  * I2S3 is connected to SPI3 peripheral
- * Uses DMA1 stream 5 for transmit
+ * Transmit DMA comes from the stream manager (dma.c): DMA1 stream 5, or
+ * stream 7 if 5 is taken, at very high priority with the FIFO and 4-beat
+ * memory bursts
  * 
  * Configuration:
  * - Master mode
  * - 16-bit data
  * - Stereo mode
  * - Slave transmit (data goes to codec)
- * - DMA for continuous streaming
+ * - Circular DMA for continuous streaming: the buffer is split in two
+ *   halves, the half-transfer and transfer-complete interrupts tell the
+ *   caller which half may be refilled
  */
 
 #include "i2s.h"
+#include "dma.h"
 #include "gpio.h"
 #include "system.h"
-#include "stm32f407xx.h"
+#include "stm32f4xx.h"
 
 /* I2S3 DMA status */
 static volatile uint32_t i2s_dma_complete_flag = 0;
+static i2s_callback_t i2s_callback = 0;
+static dma_stream_t* i2s_dma = NULL;
+static uint32_t i2s_samples = 0;        // Buffer length of the running stream
+
+/* SPI3 TX stream: 16-bit items, circular double buffer. Very high
+ * priority so SD and LCD transfers on DMA1 never hold the audio back. */
+static const dma_config_t i2s_dma_config = {
+    .request = DMA_REQUEST_SPI3_TX,
+    .priority = DMA_PRIORITY_VERY_HIGH,
+    .direction = DMA_DIR_MEM_TO_PERIPH,
+    .item_size = 2,
+    .circular = 1,
+    .fifo = 1,
+    .interrupts = DMA_FLAG_HT | DMA_FLAG_TC | DMA_FLAG_TE | DMA_FLAG_FE,
+    .irq_priority = 5
+};
 
 /**
- * DMA1 Stream 5 interrupt handler (I2S3 TX complete)
+ * I2S3 TX DMA interrupt (half/complete)
+ * A transfer error disables the stream in hardware; dma_irq_ack() counts
+ * it and the stream stays down until the next i2s_start_dma().
  */
-void DMA1_Stream5_IRQHandler(void) {
-    if (DMA1->HISR & DMA_HISR_TCIF5) {
+static void i2s_dma_interrupt(void) {
+    if (i2s_dma == NULL) return;
+    
+    uint32_t flags = dma_irq_ack(i2s_dma);
+    if (flags & DMA_FLAG_HT) {
+        if (i2s_callback) i2s_callback(0);
+    }
+    if (flags & DMA_FLAG_TC) {
         i2s_dma_complete_flag = 1;
-        DMA1->HIFCR |= DMA_HIFCR_CTCIF5;  /* Clear flag */
+        if (i2s_callback) i2s_callback(1);
     }
 }
 
+void DMA1_Stream5_IRQHandler(void) {
+    i2s_dma_interrupt();
+}
+
+/* Fallback stream when stream 5 is claimed by another driver */
+void DMA1_Stream7_IRQHandler(void) {
+    i2s_dma_interrupt();
+}
+
+/**
+ * Register the half/complete transfer callback
+ */
+void i2s_set_callback(i2s_callback_t callback) {
+    i2s_callback = callback;
+}
+
 /**
  * Calculate I2S prescaler and lin prescaler for given sample rate
  * F407 APB1 = 42MHz, APB2 = 84MHz
@@ -72,10 +117,7 @@ void i2s_init(i2s_sample_rate_t sample_rate) {
     uint8_t prescaler, lin_pres;
     
     /* Enable SPI3 (I2S3) clock on APB1 */
-    RCC->APB1ENR |= RCC_APB1ENR_SPI3EN;
-    
-    /* Enable DMA1 clock on AHB */
-    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    SET_BIT(RCC->APB1ENR, RCC_APB1ENR_SPI3EN);
     
     /* Configure I2S3 pins */
     /* PC7 (MCLK), PC10 (CK), PC12 (SD) - AF6 */
@@ -96,8 +138,8 @@ void i2s_init(i2s_sample_rate_t sample_rate) {
     i2s_calculate_prescaler(sample_rate, &prescaler, &lin_pres);
     
     /* Configure SPI3 as I2S master transmitter */
-    SPI3->I2SCFGR = 0;
-    SPI3->I2SPR = 0;
+    WRITE_REG(SPI3->I2SCFGR, 0);
+    WRITE_REG(SPI3->I2SPR, 0);
     
     /* I2SCFGR settings */
     uint32_t i2scfgr = 0;
@@ -108,7 +150,7 @@ void i2s_init(i2s_sample_rate_t sample_rate) {
     i2scfgr |= (0 << SPI_I2SCFGR_CHLEN_Pos);  /* 16-bit channel length */
     i2scfgr |= SPI_I2SCFGR_CKPOL;            /* Clock polarity */
     
-    SPI3->I2SCFGR = i2scfgr;
+    WRITE_REG(SPI3->I2SCFGR, i2scfgr);
     
     /* I2SPR settings (prescaler) */
     uint32_t i2spr = 0;
@@ -116,32 +158,16 @@ void i2s_init(i2s_sample_rate_t sample_rate) {
     i2spr |= (lin_pres << SPI_I2SPR_ODD_Pos);
     i2spr |= SPI_I2SPR_MCKOE;                 /* Enable master clock output */
     
-    SPI3->I2SPR = i2spr;
-    
-    /* Configure DMA1 Stream 5 for SPI3 TX */
-    /* Stream 5, Channel 0 is SPI3_TX */
-    DMA1_Stream5->CR = 0;  /* Reset */
-    
-    uint32_t dma_cr = 0;
-    dma_cr |= (0 << DMA_SxCR_CHSEL_Pos);      /* Channel 0 for SPI3 */
-    dma_cr |= (1 << DMA_SxCR_PL_Pos);         /* Medium priority */
-    dma_cr |= (1 << DMA_SxCR_MSIZE_Pos);      /* Memory size 16-bit */
-    dma_cr |= (1 << DMA_SxCR_PSIZE_Pos);      /* Peripheral size 16-bit */
-    dma_cr |= DMA_SxCR_MINC;                  /* Memory increment */
-    dma_cr |= DMA_SxCR_DIR_0;                 /* Memory to peripheral */
-    dma_cr |= DMA_SxCR_TCIE;                  /* Transfer complete interrupt */
-    
-    DMA1_Stream5->CR = dma_cr;
-    
-    /* Set DMA peripheral address (SPI3 data register) */
-    DMA1_Stream5->PAR = (uint32_t)&(SPI3->DR);
+    WRITE_REG(SPI3->I2SPR, i2spr);
     
-    /* Enable DMA interrupt */
-    NVIC_SetPriority(DMA1_Stream5_IRQn, 5);
-    NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+    /* TX DMA stream, claimed once (re-init only re-clocks the I2S) */
+    if (i2s_dma == NULL && dma_claim(&i2s_dma_config, &i2s_dma) != DMA_OK) {
+        i2s_dma = NULL;
+        return;
+    }
     
     /* Enable I2S peripheral */
-    SPI3->I2SCFGR |= SPI_I2SCFGR_I2SE;
+    SET_BIT(SPI3->I2SCFGR, SPI_I2SCFGR_I2SE);
     
     i2s_dma_complete_flag = 0;
 }
@@ -152,24 +178,20 @@ void i2s_init(i2s_sample_rate_t sample_rate) {
  * Parameters:
  * - buffer: 16-bit audio samples (stereo interleaved: L R L R ...)
  * - samples: number of samples to transfer (not bytes)
+ *
+ * The stream runs in circular mode until i2s_stop(); each half of the
+ * buffer is reported through the registered callback once it is sent.
  */
 void i2s_start_dma(const int16_t* buffer, uint32_t samples) {
-    if (!buffer || samples == 0) return;
-    
-    /* Disable DMA stream first */
-    DMA1_Stream5->CR &= ~DMA_SxCR_EN;
-    while (DMA1_Stream5->CR & DMA_SxCR_EN);  /* Wait for disable */
-    
-    /* Clear all flags for stream 5 */
-    DMA1->HIFCR |= (DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5 | 
-                    DMA_HIFCR_CTCIF5);
+    if (!buffer || samples == 0 || i2s_dma == NULL) return;
     
-    /* Set memory address and number of items to transfer */
-    DMA1_Stream5->M0AR = (uint32_t)buffer;
-    DMA1_Stream5->NDTR = samples;
+    /* Stream restarted on the buffer, flags cleared */
+    i2s_samples = samples;
+    dma_start(i2s_dma, (uint32_t)(uintptr_t)&(SPI3->DR), buffer, samples);
     
-    /* Enable DMA stream */
-    DMA1_Stream5->CR |= DMA_SxCR_EN;
+    /* Enable DMA requests and I2S (i2s_stop() may have disabled it) */
+    SET_BIT(SPI3->CR2, SPI_CR2_TXDMAEN);
+    SET_BIT(SPI3->I2SCFGR, SPI_I2SCFGR_I2SE);
     
     /* Clear complete flag */
     i2s_dma_complete_flag = 0;
@@ -180,11 +202,45 @@ void i2s_start_dma(const int16_t* buffer, uint32_t samples) {
  */
 void i2s_stop(void) {
     /* Disable I2S */
-    SPI3->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+    CLEAR_BIT(SPI3->I2SCFGR, SPI_I2SCFGR_I2SE);
     
     /* Disable DMA */
-    DMA1_Stream5->CR &= ~DMA_SxCR_EN;
-    while (DMA1_Stream5->CR & DMA_SxCR_EN);
+    if (i2s_dma != NULL) {
+        dma_stop(i2s_dma);
+    }
+}
+
+/**
+ * Pause I2S streaming
+ * Stops DMA requests from SPI3; the stream keeps its NDTR position
+ */
+void i2s_pause(void) {
+    CLEAR_BIT(SPI3->CR2, SPI_CR2_TXDMAEN);
+}
+
+/**
+ * Resume I2S streaming from the paused position
+ */
+void i2s_resume(void) {
+    SET_BIT(SPI3->CR2, SPI_CR2_TXDMAEN);
+}
+
+/**
+ * Read index of the circular buffer: length minus NDTR
+ */
+uint32_t i2s_get_position(void) {
+    if (i2s_dma == NULL || i2s_samples == 0) return 0;
+    uint32_t remaining = dma_remaining(i2s_dma);
+    return (remaining == 0) ? 0 : i2s_samples - remaining;
+}
+
+/**
+ * Mask the stream interrupt (keep it short: the DMA runs on)
+ */
+void i2s_hold_callback(uint8_t hold) {
+    if (i2s_dma != NULL) {
+        dma_irq_mask(i2s_dma, hold);
+    }
 }
 
 /**
@@ -193,3 +249,17 @@ void i2s_stop(void) {
 uint8_t i2s_dma_complete(void) {
     return i2s_dma_complete_flag;
 }
+
+/**
+ * Number of DMA transfer errors since the stream was claimed
+ */
+uint32_t i2s_get_errors(void) {
+    return i2s_dma ? i2s_dma->transfer_errors : 0;
+}
+
+/**
+ * Number of DMA FIFO errors since the stream was claimed
+ */
+uint32_t i2s_get_fifo_errors(void) {
+    return i2s_dma ? i2s_dma->fifo_errors : 0;
+}
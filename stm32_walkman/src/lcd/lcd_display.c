@@ -14,6 +14,7 @@
  */
 
 #include "lcd_display.h"
+#include "lcd_render.h"
 #include "gpio.h"
 #include "spi.h"
 #include "system.h"
@@ -23,12 +24,8 @@
 /* Display buffer and state */
 static lcd_state_t lcd_state = {0};
 
-/* Font data (simple 5x7 bitmap font) */
-static const uint8_t font_5x7[256][5] = {
-    /* Space: 0x20 */
-    {0x00, 0x00, 0x00, 0x00, 0x00},
-    /* More font data would go here - simplified for demo */
-};
+/* Span buffer: fills and text cells are rendered here, then sent in one transfer */
+static uint8_t lcd_line_buffer[LCD_LINE_BUFFER_PIXELS * 2];
 
 /**
  * Initialize LCD display
@@ -41,12 +38,12 @@ int lcd_init(void) {
              SPI_CPOL_LOW, SPI_CPHA_1EDGE);
     
     /* Initialize GPIO for LCD control pins (CS, DC, RST) */
-    gpio_init_port(GPIO_PORT_F);
+    gpio_init_port(LCD_GPIO_PORT);
     
     /* Configure PF6 (CS), PF10 (DC), PF11 (RST) as GPIO outputs */
-    gpio_config(GPIO_PORT_F, 6, GPIO_MODE_OUTPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_NO_PULL);
-    gpio_config(GPIO_PORT_F, 10, GPIO_MODE_OUTPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_NO_PULL);
-    gpio_config(GPIO_PORT_F, 11, GPIO_MODE_OUTPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_NO_PULL);
+    gpio_config(LCD_GPIO_PORT, LCD_CS_PIN, GPIO_MODE_OUTPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_NO_PULL);
+    gpio_config(LCD_GPIO_PORT, LCD_DC_PIN, GPIO_MODE_OUTPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_NO_PULL);
+    gpio_config(LCD_GPIO_PORT, LCD_RST_PIN, GPIO_MODE_OUTPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_NO_PULL);
     
     /* Initialize display */
     lcd_reset();
@@ -71,11 +68,11 @@ int lcd_init(void) {
  * Uses bare metal GPIO
  */
 void lcd_reset(void) {
-    gpio_set(GPIO_PORT_F, 11);     /* RST = 1 */
+    gpio_set(LCD_GPIO_PORT, LCD_RST_PIN);     /* RST = 1 */
     system_delay_ms(10);
-    gpio_clear(GPIO_PORT_F, 11);   /* RST = 0 */
+    gpio_clear(LCD_GPIO_PORT, LCD_RST_PIN);   /* RST = 0 */
     system_delay_ms(10);
-    gpio_set(GPIO_PORT_F, 11);     /* RST = 1 */
+    gpio_set(LCD_GPIO_PORT, LCD_RST_PIN);     /* RST = 1 */
     system_delay_ms(150);
 }
 
@@ -84,10 +81,10 @@ void lcd_reset(void) {
  * Uses bare metal SPI5 and GPIO
  */
 void lcd_write_cmd(uint8_t cmd) {
-    gpio_clear(GPIO_PORT_F, 10);   /* DC = 0 for command */
-    gpio_clear(GPIO_PORT_F, 6);    /* CS = 0 */
+    gpio_clear(LCD_GPIO_PORT, LCD_DC_PIN);   /* DC = 0 for command */
+    gpio_clear(LCD_GPIO_PORT, LCD_CS_PIN);   /* CS = 0 */
     spi_write_byte(SPI_BUS_5, cmd);
-    gpio_set(GPIO_PORT_F, 6);      /* CS = 1 */
+    gpio_set(LCD_GPIO_PORT, LCD_CS_PIN);     /* CS = 1 */
 }
 
 /**
@@ -95,10 +92,10 @@ void lcd_write_cmd(uint8_t cmd) {
  * Uses bare metal SPI5 and GPIO
  */
 void lcd_write_data(uint8_t data) {
-    gpio_set(GPIO_PORT_F, 10);     /* DC = 1 for data */
-    gpio_clear(GPIO_PORT_F, 6);    /* CS = 0 */
+    gpio_set(LCD_GPIO_PORT, LCD_DC_PIN);     /* DC = 1 for data */
+    gpio_clear(LCD_GPIO_PORT, LCD_CS_PIN);   /* CS = 0 */
     spi_write_byte(SPI_BUS_5, data);
-    gpio_set(GPIO_PORT_F, 6);      /* CS = 1 */
+    gpio_set(LCD_GPIO_PORT, LCD_CS_PIN);     /* CS = 1 */
 }
 
 /**
@@ -123,10 +120,23 @@ void lcd_set_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     lcd_write_cmd(0x2C);
 }
 
+/**
+ * Send pixel data for the current window (DC/CS framing around one burst)
+ */
+static void lcd_write_pixels(const uint8_t* data, uint32_t pixels) {
+    gpio_set(LCD_GPIO_PORT, LCD_DC_PIN);     // DC = 1 for data
+    gpio_clear(LCD_GPIO_PORT, LCD_CS_PIN);   // CS = 0
+    spi_write(SPI_BUS_5, data, pixels * 2);
+    gpio_set(LCD_GPIO_PORT, LCD_CS_PIN);     // CS = 1
+}
+
 /**
  * Fill rectangular area with color
+ * The span buffer is filled once and streamed repeatedly
  */
 void lcd_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    if (x >= LCD_WIDTH || y >= LCD_HEIGHT || w == 0 || h == 0) return;
+    
     uint16_t x_end = x + w - 1;
     uint16_t y_end = y + h - 1;
     
@@ -135,19 +145,20 @@ void lcd_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t colo
     
     lcd_set_window(x, y, x_end, y_end);
     
-    uint32_t pixels = w * h;
-    uint8_t color_h = color >> 8;
-    uint8_t color_l = color & 0xFF;
+    uint32_t pixels = (uint32_t)(x_end - x + 1) * (y_end - y + 1);
+    uint32_t chunk = (pixels < LCD_LINE_BUFFER_PIXELS) ? pixels : LCD_LINE_BUFFER_PIXELS;
+    lcd_render_fill_span(lcd_line_buffer, color, chunk);
     
-    HAL_GPIO_WritePin(LCD_GPIO_PORT, LCD_DC_PIN, GPIO_PIN_SET);    // DC = 1 for data
-    HAL_GPIO_WritePin(LCD_GPIO_PORT, LCD_CS_PIN, GPIO_PIN_RESET);  // CS = 0
+    gpio_set(LCD_GPIO_PORT, LCD_DC_PIN);     // DC = 1 for data
+    gpio_clear(LCD_GPIO_PORT, LCD_CS_PIN);   // CS = 0
     
-    for (uint32_t i = 0; i < pixels; i++) {
-        HAL_SPI_Transmit(&hspi1, &color_h, 1, HAL_MAX_DELAY);
-        HAL_SPI_Transmit(&hspi1, &color_l, 1, HAL_MAX_DELAY);
+    while (pixels > 0) {
+        uint32_t n = (pixels < chunk) ? pixels : chunk;
+        spi_write(SPI_BUS_5, lcd_line_buffer, n * 2);
+        pixels -= n;
     }
     
-    HAL_GPIO_WritePin(LCD_GPIO_PORT, LCD_CS_PIN, GPIO_PIN_SET);    // CS = 1
+    gpio_set(LCD_GPIO_PORT, LCD_CS_PIN);     // CS = 1
 }
 
 /**
@@ -158,14 +169,8 @@ void lcd_draw_pixel(uint16_t x, uint16_t y, uint16_t color) {
     
     lcd_set_window(x, y, x, y);
     
-    uint8_t color_h = color >> 8;
-    uint8_t color_l = color & 0xFF;
-    
-    HAL_GPIO_WritePin(LCD_GPIO_PORT, LCD_DC_PIN, GPIO_PIN_SET);    // DC = 1 for data
-    HAL_GPIO_WritePin(LCD_GPIO_PORT, LCD_CS_PIN, GPIO_PIN_RESET);  // CS = 0
-    HAL_SPI_Transmit(&hspi1, &color_h, 1, HAL_MAX_DELAY);
-    HAL_SPI_Transmit(&hspi1, &color_l, 1, HAL_MAX_DELAY);
-    HAL_GPIO_WritePin(LCD_GPIO_PORT, LCD_CS_PIN, GPIO_PIN_SET);    // CS = 1
+    uint8_t color_bytes[2] = {color >> 8, color & 0xFF};
+    lcd_write_pixels(color_bytes, 1);
 }
 
 /**
@@ -220,13 +225,14 @@ void lcd_display_song_info(const char* title, const char* artist,
     uint32_t total_mins = duration_sec / 60;
     uint32_t total_secs = duration_sec % 60;
     
-    sprintf(time_str, "%02d:%02d / %02d:%02d", mins, secs, total_mins, total_secs);
+    sprintf(time_str, "%02u:%02u / %02u:%02u", (unsigned)mins, (unsigned)secs,
+            (unsigned)total_mins, (unsigned)total_secs);
     lcd_draw_text(10, 180, time_str, COLOR_WHITE, COLOR_BLACK, 1);
     
     // Control buttons area
-    lcd_draw_button(20, 240, 60, 40, "◀", COLOR_GRAY, COLOR_WHITE);      // Previous
-    lcd_draw_button(110, 240, 60, 40, "▶", COLOR_GREEN, COLOR_BLACK);    // Play/Pause
-    lcd_draw_button(200, 240, 60, 40, "▶▶", COLOR_GRAY, COLOR_WHITE);    // Next
+    lcd_draw_button(20, 240, 60, 40, "|<", COLOR_GRAY, COLOR_WHITE);      // Previous
+    lcd_draw_button(110, 240, 60, 40, ">", COLOR_GREEN, COLOR_BLACK);    // Play/Pause
+    lcd_draw_button(200, 240, 60, 40, ">|", COLOR_GRAY, COLOR_WHITE);    // Next
 }
 
 /**
@@ -241,30 +247,30 @@ void lcd_display_status(const char* status_text) {
 }
 
 /**
- * Draw text on LCD (simplified - uses simple character positioning)
+ * Draw text on LCD
+ * Each character cell is rendered into the span buffer and sent as one
+ * window; text is clipped at the right edge. Non-ASCII (UTF-8) characters
+ * draw as a single fallback box.
  */
 void lcd_draw_text(uint16_t x, uint16_t y, const char* text, 
                    uint16_t fg_color, uint16_t bg_color, uint8_t size) {
-    if (text == NULL) return;
+    if (text == NULL || size == 0) return;
+    if (size > LCD_TEXT_MAX_SIZE) size = LCD_TEXT_MAX_SIZE;
     
-    // Simple text drawing - character by character
-    // Each character is approximately 5 pixels wide (size 1)
-    uint16_t px = x;
-    uint16_t py = y;
+    uint16_t cell_w = LCD_CHAR_WIDTH * size;
+    uint16_t cell_h = LCD_CHAR_HEIGHT * size;
+    if (y + cell_h > LCD_HEIGHT) return;
     
+    uint16_t px = x;
     for (const char* p = text; *p; p++) {
-        // Draw character box as placeholder
-        // In real implementation, would use bitmap font
-        if (*p == ' ') {
-            px += 5 * size;
-        } else {
-            // Draw simple character background
-            lcd_fill_rect(px, py, 5 * size, 8 * size, bg_color);
-            
-            // TODO: Draw character bitmap
-            // For now, just advance position
-            px += 5 * size;
-        }
+        /* UTF-8 continuation bytes belong to the previous character */
+        if (((uint8_t)*p & 0xC0) == 0x80) continue;
+        if (px + cell_w > LCD_WIDTH) break;
+        
+        lcd_render_glyph(lcd_line_buffer, cell_w, *p, fg_color, bg_color, size);
+        lcd_set_window(px, y, px + cell_w - 1, y + cell_h - 1);
+        lcd_write_pixels(lcd_line_buffer, (uint32_t)cell_w * cell_h);
+        px += cell_w;
     }
 }
 
@@ -282,7 +288,16 @@ void lcd_draw_button(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
     lcd_draw_vline(x, y, h, COLOR_WHITE);
     lcd_draw_vline(x + w - 1, y, h, COLOR_DARK_GRAY);
     
-    // TODO: Draw label
+    // Centered label
+    if (label == NULL) return;
+    uint16_t chars = 0;
+    for (const char* p = label; *p; p++) {
+        if (((uint8_t)*p & 0xC0) != 0x80) chars++;
+    }
+    uint16_t text_w = chars * LCD_CHAR_WIDTH * 2;
+    uint16_t tx = (text_w < w) ? x + (w - text_w) / 2 : x;
+    uint16_t ty = y + (h - LCD_CHAR_HEIGHT * 2) / 2;
+    lcd_draw_text(tx, ty, label, fg_color, bg_color, 2);
 }
 
 /**
@@ -12,11 +12,15 @@
 #define LCD_WIDTH 240
 #define LCD_HEIGHT 320
 
-/* LCD Control Pins (STM32F407 Discovery) */
-#define LCD_GPIO_PORT GPIOF
-#define LCD_CS_PIN    GPIO_PIN_6   // Chip Select
-#define LCD_DC_PIN    GPIO_PIN_10  // Data/Command
-#define LCD_RST_PIN   GPIO_PIN_11  // Reset
+/* Span buffer for fills and text cells (pixels) */
+#define LCD_LINE_BUFFER_PIXELS (LCD_WIDTH * 2)
+#define LCD_TEXT_MAX_SIZE      3   // 18x24 cell fits the span buffer
+
+/* LCD Control Pins (STM32F407 Discovery) - gpio_port_t / pin number */
+#define LCD_GPIO_PORT GPIO_PORT_F
+#define LCD_CS_PIN    6    // Chip Select
+#define LCD_DC_PIN    10   // Data/Command
+#define LCD_RST_PIN   11   // Reset
 
 /* RGB565 Color Definitions */
 #define COLOR_BLACK       0x0000
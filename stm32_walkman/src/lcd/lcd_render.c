@@ -0,0 +1,173 @@
+/**
+ * LCD Rendering Kernels - Implementation
+ */
+
+#include "lcd_render.h"
+
+/* Column-major glyphs, bit 0 = top row; last entry is the fallback box */
+static const uint8_t lcd_font[LCD_FONT_LAST - LCD_FONT_FIRST + 2][LCD_FONT_WIDTH] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, /* ' ' */
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, /* '!' */
+    {0x00, 0x07, 0x00, 0x07, 0x00}, /* '"' */
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, /* '#' */
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, /* '$' */
+    {0x23, 0x13, 0x08, 0x64, 0x62}, /* '%' */
+    {0x36, 0x49, 0x56, 0x20, 0x50}, /* '&' */
+    {0x00, 0x08, 0x07, 0x03, 0x00}, /* ''' */
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, /* '(' */
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, /* ')' */
+    {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, /* '*' */
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, /* '+' */
+    {0x00, 0x80, 0x70, 0x30, 0x00}, /* ',' */
+    {0x08, 0x08, 0x08, 0x08, 0x08}, /* '-' */
+    {0x00, 0x00, 0x60, 0x60, 0x00}, /* '.' */
+    {0x20, 0x10, 0x08, 0x04, 0x02}, /* '/' */
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, /* '0' */
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, /* '1' */
+    {0x72, 0x49, 0x49, 0x49, 0x46}, /* '2' */
+    {0x21, 0x41, 0x49, 0x4D, 0x33}, /* '3' */
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, /* '4' */
+    {0x27, 0x45, 0x45, 0x45, 0x39}, /* '5' */
+    {0x3C, 0x4A, 0x49, 0x49, 0x31}, /* '6' */
+    {0x41, 0x21, 0x11, 0x09, 0x07}, /* '7' */
+    {0x36, 0x49, 0x49, 0x49, 0x36}, /* '8' */
+    {0x46, 0x49, 0x49, 0x29, 0x1E}, /* '9' */
+    {0x00, 0x00, 0x14, 0x00, 0x00}, /* ':' */
+    {0x00, 0x40, 0x34, 0x00, 0x00}, /* ';' */
+    {0x00, 0x08, 0x14, 0x22, 0x41}, /* '<' */
+    {0x14, 0x14, 0x14, 0x14, 0x14}, /* '=' */
+    {0x00, 0x41, 0x22, 0x14, 0x08}, /* '>' */
+    {0x02, 0x01, 0x59, 0x09, 0x06}, /* '?' */
+    {0x3E, 0x41, 0x5D, 0x59, 0x4E}, /* '@' */
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, /* 'A' */
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, /* 'B' */
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, /* 'C' */
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, /* 'D' */
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, /* 'E' */
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, /* 'F' */
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, /* 'G' */
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, /* 'H' */
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, /* 'I' */
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, /* 'J' */
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, /* 'K' */
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, /* 'L' */
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, /* 'M' */
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, /* 'N' */
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, /* 'O' */
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, /* 'P' */
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, /* 'Q' */
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, /* 'R' */
+    {0x26, 0x49, 0x49, 0x49, 0x32}, /* 'S' */
+    {0x03, 0x01, 0x7F, 0x01, 0x03}, /* 'T' */
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, /* 'U' */
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, /* 'V' */
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, /* 'W' */
+    {0x63, 0x14, 0x08, 0x14, 0x63}, /* 'X' */
+    {0x03, 0x04, 0x78, 0x04, 0x03}, /* 'Y' */
+    {0x61, 0x59, 0x49, 0x4D, 0x43}, /* 'Z' */
+    {0x00, 0x7F, 0x41, 0x41, 0x41}, /* '[' */
+    {0x02, 0x04, 0x08, 0x10, 0x20}, /* '\' */
+    {0x00, 0x41, 0x41, 0x41, 0x7F}, /* ']' */
+    {0x04, 0x02, 0x01, 0x02, 0x04}, /* '^' */
+    {0x40, 0x40, 0x40, 0x40, 0x40}, /* '_' */
+    {0x00, 0x03, 0x07, 0x08, 0x00}, /* '`' */
+    {0x20, 0x54, 0x54, 0x78, 0x40}, /* 'a' */
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, /* 'b' */
+    {0x38, 0x44, 0x44, 0x44, 0x28}, /* 'c' */
+    {0x38, 0x44, 0x44, 0x28, 0x7F}, /* 'd' */
+    {0x38, 0x54, 0x54, 0x54, 0x18}, /* 'e' */
+    {0x00, 0x08, 0x7E, 0x09, 0x02}, /* 'f' */
+    {0x18, 0xA4, 0xA4, 0x9C, 0x78}, /* 'g' */
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, /* 'h' */
+    {0x00, 0x44, 0x7D, 0x40, 0x00}, /* 'i' */
+    {0x20, 0x40, 0x40, 0x3D, 0x00}, /* 'j' */
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, /* 'k' */
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, /* 'l' */
+    {0x7C, 0x04, 0x78, 0x04, 0x78}, /* 'm' */
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, /* 'n' */
+    {0x38, 0x44, 0x44, 0x44, 0x38}, /* 'o' */
+    {0xFC, 0x18, 0x24, 0x24, 0x18}, /* 'p' */
+    {0x18, 0x24, 0x24, 0x18, 0xFC}, /* 'q' */
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, /* 'r' */
+    {0x48, 0x54, 0x54, 0x54, 0x24}, /* 's' */
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, /* 't' */
+    {0x3C, 0x40, 0x40, 0x20, 0x7C}, /* 'u' */
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, /* 'v' */
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, /* 'w' */
+    {0x44, 0x28, 0x10, 0x28, 0x44}, /* 'x' */
+    {0x4C, 0x90, 0x90, 0x90, 0x7C}, /* 'y' */
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, /* 'z' */
+    {0x00, 0x08, 0x36, 0x41, 0x00}, /* '{' */
+    {0x00, 0x00, 0x77, 0x00, 0x00}, /* '|' */
+    {0x00, 0x41, 0x36, 0x08, 0x00}, /* '}' */
+    {0x02, 0x01, 0x02, 0x04, 0x02}, /* '~' */
+    {0x7F, 0x7F, 0x7F, 0x7F, 0x7F}, /* fallback */
+};
+
+/**
+ * Fill a span with one color
+ * Writes two pixels per 32-bit store once the destination is aligned
+ */
+void lcd_render_fill_span(uint8_t* dst, uint16_t color, uint32_t pixels) {
+    uint8_t hi = (uint8_t)(color >> 8);
+    uint8_t lo = (uint8_t)(color & 0xFF);
+
+    while (pixels > 0 && ((uintptr_t)dst & 3u) != 0) {
+        *dst++ = hi;
+        *dst++ = lo;
+        pixels--;
+    }
+
+    uint32_t pair;
+    uint8_t* pb = (uint8_t*)&pair;
+    pb[0] = hi; pb[1] = lo; pb[2] = hi; pb[3] = lo;
+
+    uint32_t* dst32 = (uint32_t*)dst;
+    for (uint32_t i = 0; i < pixels / 2; i++) {
+        dst32[i] = pair;
+    }
+
+    if (pixels & 1u) {
+        dst += (pixels - 1) * 2;
+        dst[0] = hi;
+        dst[1] = lo;
+    }
+}
+
+/**
+ * Render one scaled character cell
+ */
+void lcd_render_glyph(uint8_t* dst, uint32_t stride_px, char c,
+                      uint16_t fg_color, uint16_t bg_color, uint8_t size) {
+    uint8_t ch = (uint8_t)c;
+    const uint8_t* glyph = (ch >= LCD_FONT_FIRST && ch <= LCD_FONT_LAST) ?
+                           lcd_font[ch - LCD_FONT_FIRST] :
+                           lcd_font[LCD_FONT_LAST - LCD_FONT_FIRST + 1];
+    uint8_t colors[2][2] = {
+        {(uint8_t)(bg_color >> 8), (uint8_t)(bg_color & 0xFF)},
+        {(uint8_t)(fg_color >> 8), (uint8_t)(fg_color & 0xFF)}
+    };
+    uint32_t cell_w = (uint32_t)LCD_CHAR_WIDTH * size;
+
+    for (uint32_t row = 0; row < LCD_CHAR_HEIGHT; row++) {
+        /* Build one scaled row, then replicate it size times */
+        uint8_t* line = dst + row * size * stride_px * 2;
+        uint8_t* p = line;
+
+        for (uint32_t col = 0; col < LCD_CHAR_WIDTH; col++) {
+            uint8_t on = (col < LCD_FONT_WIDTH) ? ((glyph[col] >> row) & 1u) : 0;
+            const uint8_t* rgb = colors[on];
+            for (uint8_t s = 0; s < size; s++) {
+                *p++ = rgb[0];
+                *p++ = rgb[1];
+            }
+        }
+
+        for (uint8_t s = 1; s < size; s++) {
+            uint8_t* copy = line + s * stride_px * 2;
+            for (uint32_t i = 0; i < cell_w * 2; i++) {
+                copy[i] = line[i];
+            }
+        }
+    }
+}
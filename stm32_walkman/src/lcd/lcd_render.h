@@ -0,0 +1,34 @@
+/**
+ * LCD Rendering Kernels
+ *
+ * Pixel generation into RAM buffers in panel byte order (RGB565, big
+ * endian), kept separate from the SPI transport so the display driver can
+ * send whole spans in one transfer and the kernels can be benchmarked
+ * on their own.
+ */
+
+#ifndef __LCD_RENDER_H
+#define __LCD_RENDER_H
+
+#include <stdint.h>
+
+/* 5x8 font (row 7 holds descenders), drawn in a 6x8 cell */
+#define LCD_FONT_WIDTH    5
+#define LCD_FONT_HEIGHT   8
+#define LCD_CHAR_WIDTH    6
+#define LCD_CHAR_HEIGHT   8
+#define LCD_FONT_FIRST    0x20
+#define LCD_FONT_LAST     0x7E
+
+/* Fill pixels with one color */
+void lcd_render_fill_span(uint8_t* dst, uint16_t color, uint32_t pixels);
+
+/**
+ * Render one character cell (LCD_CHAR_WIDTH*size x LCD_CHAR_HEIGHT*size)
+ * at dst, rows stride_px pixels apart. Characters outside the font use a
+ * filled box.
+ */
+void lcd_render_glyph(uint8_t* dst, uint32_t stride_px, char c,
+                      uint16_t fg_color, uint16_t bg_color, uint8_t size);
+
+#endif /* __LCD_RENDER_H */
@@ -15,6 +15,8 @@
  * - Play/Pause/Stop controls
  * - Volume control (0-100%) via WM8994 codec
  * - Shuffle and loop modes
+ * - Scrub: hold Next/Prev to skim through the track with short previews
+ * - Resume: track, position, volume and modes survive power loss
  * - Real-time playback display
  * - MP3/WAV file support (via codec DAC)
  * - True stereo audio output
@@ -34,7 +36,11 @@
 #include "spi.h"
 #include "i2c.h"
 #include "i2s.h"
+#include "storage.h"
+#include "journal.h"
+#include "library.h"
 #include "player.h"
+#include "shuffle.h"
 #include "lcd_display.h"
 #include "buttons.h"
 #include <stdio.h>
@@ -44,12 +50,73 @@
 #define UPDATE_INTERVAL_MS 100
 #define VOLUME_STEP 5
 
+/* Loudness and compressor on the codec's DSP: saves MCU cycles (battery)
+ * at 44.1/48kHz, 0 keeps them on the MCU's finer filters */
+#define APP_CODEC_DSP (PLAYER_CODEC_LOUDNESS | PLAYER_CODEC_DRC)
+
+/* Headphone/room correction filter, loaded at startup when present */
+#define APP_FIR_PATH "/correction.wav"
+
+/* Playback speeds (percent) stepped through by holding Volume- */
+static const uint16_t app_speeds[] = {100, 125, 150, 200, 75};
+#define APP_SPEED_COUNT (sizeof(app_speeds) / sizeof(app_speeds[0]))
+
+/* Scrub (hold Next/Prev): play SCRUB_SNIPPET_MS, jump, repeat. The jump
+ * doubles every SCRUB_ACCEL_MS of holding, up to SCRUB_STEP_MAX_MS. */
+#define SCRUB_SNIPPET_MS 150
+#define SCRUB_STEP_MS 1000
+#define SCRUB_STEP_MAX_MS 16000
+#define SCRUB_ACCEL_MS 1500
+
+/* Resume state journal in flash sectors 10 and 11 (kept out of the image
+ * by the linker script). While playing the position is written at most
+ * every RESUME_SAVE_PLAYING_MS and never with a sector erase (which stalls
+ * the core for a second or more); otherwise changes go out at most every
+ * RESUME_SAVE_IDLE_MS. At 10 s per record one sector holds 11 hours of
+ * play, so the pair outlasts the player. */
+#define RESUME_SECTOR_A 10
+#define RESUME_SECTOR_B 11
+#define RESUME_SAVE_PLAYING_MS 10000
+#define RESUME_SAVE_IDLE_MS 1000
+
+#define RESUME_FLAG_SHUFFLE 0x01
+#define RESUME_FLAG_LOADED  0x02    // Track open (playing or paused)
+#define RESUME_FLAG_PLAYING 0x04
+#define RESUME_FLAG_DRC     0x08
+#define RESUME_FLAG_LOUDNESS 0x10
+
+/* Journal payload (JOURNAL_PAYLOAD_BYTES) */
+typedef struct {
+    uint32_t path_crc;          // CRC-32 of the track path
+    uint32_t position_ms;
+    uint32_t shuffle_seed;
+    uint8_t track;
+    uint8_t volume;
+    uint8_t loop_mode;
+    uint8_t flags;              // RESUME_FLAG_*
+    uint8_t crossfeed;          // crossfeed_preset_t (0 = off in older records)
+    uint8_t speed;              // Percent (0 = normal in older records)
+    uint8_t reserved[2];
+} resume_state_t;
+
 /* Global state */
 typedef struct {
     uint32_t last_update;
     char playlist[100][256];
     uint8_t playlist_count;
     uint8_t current_track;
+    int8_t scrub_dir;           // +1 forward, -1 back, 0 idle
+    uint8_t scrubbed;           // This press scrubbed: no track change
+    uint32_t scrub_start;
+    uint32_t scrub_next;
+    uint32_t shuffle_seed;      // Track order while shuffle is on
+    uint8_t loop_held;          // Loop held: crossfeed changed, no loop change
+    uint8_t shuffle_held;       // Shuffle held: DRC toggled, no shuffle change
+    uint8_t volup_held;         // Volume+ held: loudness toggled, no volume step
+    uint8_t voldown_held;       // Volume- held: speed stepped, no volume step
+    journal_t journal;
+    uint8_t journal_ready;
+    uint32_t resume_changed;    // When the state last differed from flash
 } app_state_t;
 
 static app_state_t app;
@@ -67,6 +134,9 @@ void app_button_shuffle(button_event_t event);
 void app_button_loop(button_event_t event);
 void app_load_playlist(const char* directory);
 void app_update_display(void);
+void app_scrub(uint32_t now);
+void app_resume_restore(void);
+void app_resume_save(uint32_t now);
 
 /**
  * Main application entry point
@@ -76,7 +146,10 @@ int main(void) {
     system_init();
     
     /* Enable SysTick timer */
-    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    system_tick_start();
+    
+    /* Cycle counter for audio pipeline profiling */
+    system_cycles_init();
     
     /* Initialize subsystems */
     app_init();
@@ -116,6 +189,11 @@ void app_init(void) {
     }
     printf("Buttons initialized\n");
     
+    /* Mount SD card */
+    if (storage_init() != STORAGE_OK) {
+        printf("Warning: No SD card\n");
+    }
+    
     /* Register button callbacks */
     buttons_register_callback(BTN_PREVIOUS, app_button_prev);
     buttons_register_callback(BTN_PLAY_PAUSE, app_button_play);
@@ -125,15 +203,28 @@ void app_init(void) {
     buttons_register_callback(BTN_SHUFFLE, app_button_shuffle);
     buttons_register_callback(BTN_LOOP, app_button_loop);
     
+    player_set_codec_dsp(APP_CODEC_DSP);
+    
+    /* Correction filter from SD card (optional) */
+    int fir_status = player_load_fir(APP_FIR_PATH);
+    if (fir_status == PLAYER_OK) {
+        printf("Correction filter: %u taps\n", (unsigned)player_get_state()->fir_taps);
+    } else if (fir_status != PLAYER_ERROR_NO_FILE) {
+        printf("Warning: %s not usable\n", APP_FIR_PATH);
+    }
+    
     /* Load playlist from SD card */
     app_load_playlist("/music");
     
+    /* Back to where the last session left off */
+    app_resume_restore();
+    
     /* Display startup message */
     lcd_fill_rect(0, 0, LCD_WIDTH, LCD_HEIGHT, COLOR_BLACK);
     lcd_draw_text(10, 150, "WALKMAN PLAYER", COLOR_GREEN, COLOR_BLACK, 2);
     lcd_draw_text(10, 180, "Loading...", COLOR_GRAY, COLOR_BLACK, 1);
     
-    app.last_update = HAL_GetTick();
+    app.last_update = system_get_tick();
     printf("Application initialized\n");
 }
 
@@ -145,22 +236,102 @@ void app_loop(void) {
     
     /* Poll button inputs */
     buttons_poll();
+    app_scrub(current_time);
+    
+    /* Decode ahead into the audio queue */
+    player_process();
+    
+    app_resume_save(current_time);
     
     /* Update display periodically */
     if ((current_time - app.last_update) >= UPDATE_INTERVAL_MS) {
         app_update_display();
         app.last_update = current_time;
     }
+    
+    /* Nothing left until the next tick or interrupt */
+    system_idle();
+}
+
+/**
+ * Hold on Next/Prev: start scrubbing, the release ends it
+ */
+static void app_scrub_event(button_event_t event, int8_t dir) {
+    if (event == BUTTON_LONG_PRESSED && player_get_state()->is_playing) {
+        printf("Scrub: %s\n", dir > 0 ? "forward" : "back");
+        app.scrub_dir = dir;
+        app.scrubbed = 1;
+        app.scrub_start = system_get_tick();
+        app.scrub_next = app.scrub_start;
+    } else if (event == BUTTON_PRESSED) {
+        app.scrubbed = 0;
+    } else if (event == BUTTON_RELEASED) {
+        app.scrub_dir = 0;
+    }
+}
+
+/**
+ * Jump to the next scrub preview when the current one has played
+ */
+void app_scrub(uint32_t now) {
+    if (app.scrub_dir == 0 || (int32_t)(now - app.scrub_next) < 0) {
+        return;
+    }
+    
+    player_t* state = player_get_state();
+    if (!state->is_playing) {
+        app.scrub_dir = 0;
+        return;
+    }
+    
+    uint32_t step = SCRUB_STEP_MS;
+    for (uint32_t held = now - app.scrub_start; held >= SCRUB_ACCEL_MS &&
+         step < SCRUB_STEP_MAX_MS; held -= SCRUB_ACCEL_MS) {
+        step *= 2;
+    }
+    
+    uint32_t position = player_get_position_ms();
+    if (app.scrub_dir > 0) {
+        position += step;
+    } else {
+        position = position > step ? position - step : 0;
+    }
+    
+    if (player_seek(position) != PLAYER_OK) {
+        app.scrub_dir = 0;
+    }
+    app.scrub_next = now + SCRUB_SNIPPET_MS;
+}
+
+/**
+ * Move dir tracks through the play order; 0 at either end
+ */
+static uint8_t app_step_track(int8_t dir) {
+    uint16_t order[MAX_PLAYLIST_SIZE];
+    uint8_t pos = app.current_track;
+    
+    if (player_get_state()->shuffle_enabled) {
+        shuffle_order(app.shuffle_seed, order, app.playlist_count);
+        for (pos = 0; pos < app.playlist_count && order[pos] != app.current_track; pos++);
+    }
+    if ((dir < 0 && pos == 0) || (dir > 0 && pos + 1 >= app.playlist_count)) {
+        return 0;
+    }
+    pos += dir;
+    
+    app.current_track = player_get_state()->shuffle_enabled ? order[pos] : pos;
+    return 1;
 }
 
 /**
  * Button callbacks
+ * Next/Prev change track on release so that holding them can scrub
  */
 void app_button_prev(button_event_t event) {
-    if (event == BUTTON_PRESSED) {
+    app_scrub_event(event, -1);
+    if (event == BUTTON_RELEASED && !app.scrubbed) {
         printf("Button: Previous\n");
-        if (app.current_track > 0) {
-            app.current_track--;
+        if (app_step_track(-1)) {
             player_load_file(app.playlist[app.current_track]);
             player_play();
         }
@@ -186,67 +357,294 @@ void app_button_play(button_event_t event) {
 }
 
 void app_button_next(button_event_t event) {
-    if (event == BUTTON_PRESSED) {
+    app_scrub_event(event, 1);
+    if (event == BUTTON_RELEASED && !app.scrubbed) {
         printf("Button: Next\n");
-        if (app.current_track < app.playlist_count - 1) {
-            app.current_track++;
+        if (app_step_track(1)) {
             player_load_file(app.playlist[app.current_track]);
             player_play();
         }
     }
 }
 
+/**
+ * Volume+: tap steps the volume (on release), hold switches loudness
+ * compensation
+ */
 void app_button_vol_up(button_event_t event) {
-    if (event == BUTTON_PRESSED) {
+    if (event == BUTTON_LONG_PRESSED) {
+        app.volup_held = 1;
+        player_set_loudness(!player_get_state()->loudness);
+        printf("Loudness: %s\n", player_get_state()->loudness ? "on" : "off");
+        player_play_sfx(SFX_CONFIRM);
+    } else if (event == BUTTON_PRESSED) {
+        app.volup_held = 0;
+    } else if (event == BUTTON_RELEASED && !app.volup_held) {
         printf("Button: Volume Up\n");
         player_t* state = player_get_state();
         uint8_t new_vol = state->volume + VOLUME_STEP;
         if (new_vol > 100) new_vol = 100;
         player_set_volume(new_vol);
+        player_play_sfx(SFX_CLICK);
     }
 }
 
+/**
+ * Volume-: tap steps the volume (on release), hold steps the playback
+ * speed through app_speeds
+ */
 void app_button_vol_down(button_event_t event) {
-    if (event == BUTTON_PRESSED) {
+    if (event == BUTTON_LONG_PRESSED) {
+        app.voldown_held = 1;
+        uint16_t speed = player_get_state()->speed;
+        uint32_t i = 0;
+        while (i < APP_SPEED_COUNT && app_speeds[i] != speed) i++;
+        if (player_set_speed(app_speeds[(i + 1) % APP_SPEED_COUNT]) == PLAYER_ERROR_UNSUPPORTED) {
+            printf("Speed: 100%% only at this sample rate\n");
+            return;
+        }
+        printf("Speed: %u%%\n", (unsigned)player_get_state()->speed);
+        player_play_sfx(SFX_CONFIRM);
+    } else if (event == BUTTON_PRESSED) {
+        app.voldown_held = 0;
+    } else if (event == BUTTON_RELEASED && !app.voldown_held) {
         printf("Button: Volume Down\n");
         player_t* state = player_get_state();
         int new_vol = (int)state->volume - VOLUME_STEP;
         if (new_vol < 0) new_vol = 0;
         player_set_volume((uint8_t)new_vol);
+        player_play_sfx(SFX_CLICK);
     }
 }
 
+/**
+ * Shuffle: tap toggles shuffle (on release), hold toggles the compressor
+ */
 void app_button_shuffle(button_event_t event) {
-    if (event == BUTTON_PRESSED) {
+    if (event == BUTTON_LONG_PRESSED) {
+        app.shuffle_held = 1;
+        player_set_drc(!player_get_state()->drc_enabled);
+        printf("DRC: %s\n", player_get_state()->drc_enabled ? "on" : "off");
+        player_play_sfx(SFX_CONFIRM);
+    } else if (event == BUTTON_PRESSED) {
+        app.shuffle_held = 0;
+    } else if (event == BUTTON_RELEASED && !app.shuffle_held) {
         printf("Button: Shuffle\n");
         player_toggle_shuffle();
+        if (player_get_state()->shuffle_enabled) {
+            app.shuffle_seed = app.shuffle_seed * 1664525u + 1013904223u + system_get_tick();
+        }
+        player_play_sfx(SFX_CONFIRM);
     }
 }
 
+/**
+ * Loop: tap cycles the loop mode (on release), hold cycles the headphone
+ * crossfeed strength
+ */
 void app_button_loop(button_event_t event) {
-    if (event == BUTTON_PRESSED) {
+    if (event == BUTTON_LONG_PRESSED) {
+        player_t* state = player_get_state();
+        app.loop_held = 1;
+        player_set_crossfeed((crossfeed_preset_t)((state->crossfeed + 1) % CROSSFEED_PRESET_COUNT));
+        printf("Crossfeed: %s\n", crossfeed_preset_name(state->crossfeed));
+        player_play_sfx(SFX_CONFIRM);
+    } else if (event == BUTTON_PRESSED) {
+        app.loop_held = 0;
+    } else if (event == BUTTON_RELEASED && !app.loop_held) {
         printf("Button: Loop\n");
         player_cycle_loop();
+        player_play_sfx(SFX_CONFIRM);
     }
 }
 
 /**
- * Load playlist from directory (stub - would enumerate SD card)
+ * Playlist directory callback - keep supported audio files
  */
-void app_load_playlist(const char* directory) {
-    /* TODO: Enumerate SD card directory and load music files */
-    /* For now, add some test files */
+static void app_playlist_add(const char* path, uint32_t size, void* ctx) {
+    (void)size;
+    (void)ctx;
     
-    strcpy(app.playlist[0], "song1.mp3");
-    strcpy(app.playlist[1], "song2.wav");
-    strcpy(app.playlist[2], "song3.mp3");
+    size_t len = strlen(path);
+    if (app.playlist_count >= MAX_PLAYLIST_SIZE || len < 4 || len >= MAX_FILENAME_LEN) {
+        return;
+    }
     
-    app.playlist_count = 3;
+    const char* ext = path + len - 4;
+    if (strcmp(ext, ".wav") != 0 && strcmp(ext, ".WAV") != 0 &&
+        strcmp(ext, ".mp3") != 0 && strcmp(ext, ".MP3") != 0 &&
+        strcmp(ext, ".wnf") != 0 && strcmp(ext, ".WNF") != 0 &&
+        strcmp(ext, ".dsf") != 0 && strcmp(ext, ".DSF") != 0 &&
+        strcmp(ext, ".dff") != 0 && strcmp(ext, ".DFF") != 0) {
+        return;
+    }
+    
+    strcpy(app.playlist[app.playlist_count++], path);
+}
+
+/**
+ * Playlist from the library index the host indexer left in the directory
+ * (wmindex): no listing, subfolders included, only playable files
+ */
+static int app_load_library(const char* directory) {
+    char path[MAX_FILENAME_LEN];
+    library_t lib;
+    library_entry_t entry;
+    
+    snprintf(path, sizeof(path), "%s/%s", directory, LIBRARY_INDEX_NAME);
+    int status = library_open(&lib, path);
+    if (status != LIBRARY_OK) {
+        if (status != LIBRARY_ERROR_NO_FILE) {
+            printf("Warning: %s unreadable (%d), listing %s\n", path, status, directory);
+        }
+        return status;
+    }
+    
+    for (uint32_t i = 0; i < lib.track_count && app.playlist_count < MAX_PLAYLIST_SIZE; i++) {
+        if (library_read_entry(&lib, i, &entry) != LIBRARY_OK ||
+            library_read_string(&lib, entry.path, app.playlist[app.playlist_count],
+                                MAX_FILENAME_LEN) != LIBRARY_OK) {
+            break;
+        }
+        app.playlist_count++;
+    }
+    
+    printf("Library index: %lu tracks\n", (unsigned long)lib.track_count);
+    library_close(&lib);
+    return LIBRARY_OK;
+}
+
+/**
+ * Load playlist from directory on the SD card
+ */
+void app_load_playlist(const char* directory) {
+    app.playlist_count = 0;
     app.current_track = 0;
     
+    if (app_load_library(directory) != LIBRARY_OK) {
+        storage_list_dir(directory, app_playlist_add, NULL);
+    }
+    
     printf("Loaded %d tracks\n", app.playlist_count);
 }
 
+/**
+ * Snapshot of what a resume needs
+ * A stopped track restarts from the top, so only an open one has a position.
+ */
+static void app_resume_capture(resume_state_t* rs) {
+    player_t* state = player_get_state();
+    
+    memset(rs, 0, sizeof(*rs));
+    rs->track = app.current_track;
+    rs->volume = state->volume;
+    rs->loop_mode = (uint8_t)state->loop_mode;
+    rs->crossfeed = (uint8_t)state->crossfeed;
+    rs->speed = (uint8_t)state->speed;
+    rs->shuffle_seed = app.shuffle_seed;
+    if (state->shuffle_enabled) rs->flags |= RESUME_FLAG_SHUFFLE;
+    if (state->drc_enabled) rs->flags |= RESUME_FLAG_DRC;
+    if (state->loudness) rs->flags |= RESUME_FLAG_LOUDNESS;
+    
+    if (state->is_playing && state->current_file[0] != '\0') {
+        rs->flags |= RESUME_FLAG_LOADED;
+        if (!state->is_paused) rs->flags |= RESUME_FLAG_PLAYING;
+        rs->path_crc = journal_crc32(state->current_file, strlen(state->current_file));
+        rs->position_ms = player_get_position_ms();
+    }
+}
+
+/**
+ * Restore the journalled state: modes, volume, then the track at its
+ * position, playing or paused as it was
+ * The path CRC finds the track again if the playlist order changed.
+ */
+void app_resume_restore(void) {
+    resume_state_t rs;
+    
+    if (journal_init(&app.journal, RESUME_SECTOR_A, RESUME_SECTOR_B) != JOURNAL_OK) {
+        printf("Warning: Resume journal unavailable\n");
+        return;
+    }
+    app.journal_ready = 1;
+    if (journal_read(&app.journal, &rs) != JOURNAL_OK) {
+        return;
+    }
+    
+    if (rs.volume <= 100) player_set_volume(rs.volume);
+    player_set_crossfeed((crossfeed_preset_t)rs.crossfeed);
+    player_set_drc((rs.flags & RESUME_FLAG_DRC) != 0);
+    player_set_loudness((rs.flags & RESUME_FLAG_LOUDNESS) != 0);
+    player_set_speed(rs.speed ? rs.speed : 100);
+    for (int i = 0; i < 3 && player_get_state()->loop_mode != (loop_mode_t)rs.loop_mode; i++) {
+        player_cycle_loop();
+    }
+    if (!(rs.flags & RESUME_FLAG_SHUFFLE) != !player_get_state()->shuffle_enabled) {
+        player_toggle_shuffle();
+    }
+    app.shuffle_seed = rs.shuffle_seed;
+    
+    if (rs.track < app.playlist_count) {
+        app.current_track = rs.track;
+    }
+    if (!(rs.flags & RESUME_FLAG_LOADED)) {
+        return;
+    }
+    
+    uint8_t track = rs.track;
+    if (track >= app.playlist_count ||
+        journal_crc32(app.playlist[track], strlen(app.playlist[track])) != rs.path_crc) {
+        for (track = 0; track < app.playlist_count; track++) {
+            if (journal_crc32(app.playlist[track], strlen(app.playlist[track])) == rs.path_crc) break;
+        }
+        if (track == app.playlist_count) {
+            printf("Resume: track no longer on the card\n");
+            return;
+        }
+    }
+    
+    app.current_track = track;
+    if (player_load_file(app.playlist[track]) != PLAYER_OK ||
+        (rs.position_ms > 0 && player_seek(rs.position_ms) != PLAYER_OK) ||
+        player_play() != PLAYER_OK) {
+        return;
+    }
+    if (!(rs.flags & RESUME_FLAG_PLAYING)) {
+        player_pause();
+    }
+    printf("Resume: %s at %lu ms\n", app.playlist[track], (unsigned long)rs.position_ms);
+}
+
+/**
+ * Write the resume state when it changed (coalesced, see RESUME_SAVE_*)
+ */
+void app_resume_save(uint32_t now) {
+    resume_state_t rs, saved;
+    
+    if (!app.journal_ready) {
+        return;
+    }
+    
+    app_resume_capture(&rs);
+    if (journal_read(&app.journal, &saved) == JOURNAL_OK && memcmp(&rs, &saved, sizeof(rs)) == 0) {
+        app.resume_changed = now;
+        return;
+    }
+    
+    uint8_t playing = (rs.flags & RESUME_FLAG_PLAYING) != 0;
+    if (now - app.resume_changed < (playing ? RESUME_SAVE_PLAYING_MS : RESUME_SAVE_IDLE_MS)) {
+        return;
+    }
+    
+    int status = journal_append(&app.journal, &rs, !playing);
+    if (status == JOURNAL_OK) {
+        app.resume_changed = now;
+    } else if (status != JOURNAL_ERROR_FULL) {
+        printf("Warning: Resume state not saved (%d)\n", status);
+        app.resume_changed = now;  /* Retry after another interval */
+    }
+}
+
 /**
  * Update display with current playback info
  */
@@ -280,7 +678,7 @@ void app_update_display(void) {
     }
     
     /* Show shuffle/loop status */
-    char mode_str[32] = "";
+    char mode_str[48] = "";
     if (state->shuffle_enabled) {
         strcat(mode_str, "🔀 ");
     }
@@ -295,8 +693,32 @@ void app_update_display(void) {
             break;
     }
     
+    /* Speed, loudness, correction filter and compressor on, how deep the limiter went since the last update */
+    limiter_meter_t meter;
+    player_get_limiter_meter(&meter);
+    if (state->speed != 100) {
+        char speed[12];
+        snprintf(speed, sizeof(speed), " %u.%02ux", state->speed / 100u, state->speed % 100u);
+        strcat(mode_str, speed);
+    }
+    if (state->loudness) {
+        strcat(mode_str, " LD");
+    }
+    if (state->fir_taps) {
+        strcat(mode_str, " FIR");
+    }
+    if (state->drc_enabled) {
+        strcat(mode_str, " DRC");
+    }
+    unsigned reduction = (unsigned)(meter.reduction_db * 10.0f + 0.5f);  /* 0.1 dB */
+    if (reduction > 0) {
+        char gr[12];
+        snprintf(gr, sizeof(gr), " -%u.%udB", reduction / 10 % 100, reduction % 10);
+        strcat(mode_str, gr);
+    }
+    
     /* Display on LCD */
-    lcd_display_song_info(filename, status, 180, position);
+    lcd_display_song_info(filename, status, state->duration_sec, position);
     
     if (mode_str[0]) {
         lcd_display_status(mode_str);
@@ -315,5 +737,5 @@ void app_update_display(void) {
  * Assert failed handler
  */
 void assert_failed(uint8_t* file, uint32_t line) {
-    printf("Assert failed at %s:%lu\n", (char*)file, line);
+    printf("Assert failed at %s:%lu\n", (char*)file, (unsigned long)line);
 }
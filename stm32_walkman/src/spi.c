@@ -7,11 +7,16 @@
  * SPI3: APB1 (42MHz)
  * SPI4: APB2 (84MHz)
  * SPI5: APB2 (84MHz) - used for LCD on F407 Discovery
+ *
+ * Registers are accessed through the CMSIS READ_REG/WRITE_REG family so the
+ * host driver tests can route them to the fake peripherals in test/fakes.
+ * The F4 SPI has no data packing: with DFF=0 a word write to DR sends the
+ * low byte only.
  */
 
 #include "spi.h"
 #include "gpio.h"
-#include "stm32f407xx.h"
+#include "stm32f4xx.h"
 
 /* SPI base addresses */
 static SPI_TypeDef* const spi_bases[6] = {NULL, SPI1, SPI2, SPI3, SPI4, SPI5};
@@ -37,7 +42,7 @@ void spi_init(spi_bus_t bus, spi_datasize_t datasize, spi_prescaler_t prescaler,
     
     /* Enable SPI clock and configure GPIO pins */
     if (bus == SPI_BUS_1) {
-        RCC->APB2ENR |= RCC_APB2ENR_SPI1EN;
+        SET_BIT(RCC->APB2ENR, RCC_APB2ENR_SPI1EN);
         
         /* Configure PB3 (SCK), PB4 (MISO), PB5 (MOSI) as alternate function AF5 */
         gpio_init_port(GPIO_PORT_B);
@@ -53,7 +58,7 @@ void spi_init(spi_bus_t bus, spi_datasize_t datasize, spi_prescaler_t prescaler,
         gpio_set(GPIO_PORT_A, 4);
         
     } else if (bus == SPI_BUS_5) {
-        RCC->APB2ENR |= RCC_APB2ENR_SPI5EN;
+        SET_BIT(RCC->APB2ENR, RCC_APB2ENR_SPI5EN);
         
         /* Configure PF7 (SCK), PF8 (MISO), PF9 (MOSI) as alternate function AF5 */
         gpio_init_port(GPIO_PORT_F);
@@ -74,7 +79,7 @@ void spi_init(spi_bus_t bus, spi_datasize_t datasize, spi_prescaler_t prescaler,
     }
     
     /* Reset SPI peripheral */
-    spi->CR1 = 0;
+    WRITE_REG(spi->CR1, 0);
     
     /* Configure SPI */
     uint32_t cr1 = 0;
@@ -107,10 +112,10 @@ void spi_init(spi_bus_t bus, spi_datasize_t datasize, spi_prescaler_t prescaler,
     /* MSB first */
     cr1 &= ~SPI_CR1_LSBFIRST;
     
-    spi->CR1 = cr1;
+    WRITE_REG(spi->CR1, cr1);
     
     /* Enable SPI */
-    spi->CR1 |= SPI_CR1_SPE;
+    SET_BIT(spi->CR1, SPI_CR1_SPE);
 }
 
 /**
@@ -127,7 +132,7 @@ static SPI_TypeDef* spi_get_periph(spi_bus_t bus) {
 uint8_t spi_is_busy(spi_bus_t bus) {
     SPI_TypeDef* spi = spi_get_periph(bus);
     if (!spi) return 0;
-    return (spi->SR & SPI_SR_BSY) ? 1 : 0;
+    return READ_BIT(spi->SR, SPI_SR_BSY) ? 1 : 0;
 }
 
 /**
@@ -136,7 +141,7 @@ uint8_t spi_is_busy(spi_bus_t bus) {
 static void spi_wait_txe(spi_bus_t bus) {
     SPI_TypeDef* spi = spi_get_periph(bus);
     if (!spi) return;
-    while (!(spi->SR & SPI_SR_TXE));
+    while (!READ_BIT(spi->SR, SPI_SR_TXE));
 }
 
 /**
@@ -145,7 +150,7 @@ static void spi_wait_txe(spi_bus_t bus) {
 static void spi_wait_rxne(spi_bus_t bus) {
     SPI_TypeDef* spi = spi_get_periph(bus);
     if (!spi) return;
-    while (!(spi->SR & SPI_SR_RXNE));
+    while (!READ_BIT(spi->SR, SPI_SR_RXNE));
 }
 
 /**
@@ -154,7 +159,7 @@ static void spi_wait_rxne(spi_bus_t bus) {
 static void spi_wait_busy(spi_bus_t bus) {
     SPI_TypeDef* spi = spi_get_periph(bus);
     if (!spi) return;
-    while (spi->SR & SPI_SR_BSY);
+    while (READ_BIT(spi->SR, SPI_SR_BSY));
 }
 
 /**
@@ -165,11 +170,11 @@ void spi_write_byte(spi_bus_t bus, uint8_t byte) {
     if (!spi) return;
     
     spi_wait_txe(bus);
-    *((__IO uint8_t*)&spi->DR) = byte;
+    WRITE_REG(spi->DR, byte);
     spi_wait_busy(bus);
     
     /* Read dummy byte to clear RXNE flag */
-    (void)spi->DR;
+    (void)READ_REG(spi->DR);
 }
 
 /**
@@ -180,10 +185,10 @@ uint8_t spi_read_byte(spi_bus_t bus) {
     if (!spi) return 0;
     
     spi_wait_txe(bus);
-    *((__IO uint8_t*)&spi->DR) = 0xFF;  /* Send dummy byte */
+    WRITE_REG(spi->DR, 0xFF);  /* Send dummy byte */
     spi_wait_rxne(bus);
     
-    return *((__IO uint8_t*)&spi->DR);
+    return (uint8_t)READ_REG(spi->DR);
 }
 
 /**
@@ -197,14 +202,14 @@ void spi_write(spi_bus_t bus, const uint8_t* data, uint32_t len) {
     
     for (uint32_t i = 0; i < len; i++) {
         spi_wait_txe(bus);
-        *((__IO uint8_t*)&spi->DR) = data[i];
+        WRITE_REG(spi->DR, data[i]);
     }
     
     spi_wait_busy(bus);
     
     /* Read dummy bytes to clear RXNE flags */
-    while (spi->SR & SPI_SR_RXNE) {
-        (void)spi->DR;
+    while (READ_BIT(spi->SR, SPI_SR_RXNE)) {
+        (void)READ_REG(spi->DR);
     }
 }
 
@@ -220,9 +225,9 @@ void spi_read(spi_bus_t bus, uint8_t* data, uint32_t len) {
     
     for (uint32_t i = 0; i < len; i++) {
         spi_wait_txe(bus);
-        *((__IO uint8_t*)&spi->DR) = 0xFF;  /* Send dummy byte */
+        WRITE_REG(spi->DR, 0xFF);  /* Send dummy byte */
         spi_wait_rxne(bus);
-        data[i] = *((__IO uint8_t*)&spi->DR);
+        data[i] = (uint8_t)READ_REG(spi->DR);
     }
     
     spi_wait_busy(bus);
@@ -240,9 +245,9 @@ void spi_transfer(spi_bus_t bus, const uint8_t* tx, uint8_t* rx, uint32_t len) {
     for (uint32_t i = 0; i < len; i++) {
         spi_wait_txe(bus);
         uint8_t byte = (tx) ? tx[i] : 0xFF;
-        *((__IO uint8_t*)&spi->DR) = byte;
+        WRITE_REG(spi->DR, byte);
         spi_wait_rxne(bus);
-        byte = *((__IO uint8_t*)&spi->DR);
+        byte = (uint8_t)READ_REG(spi->DR);
         if (rx) rx[i] = byte;
     }
     
@@ -0,0 +1,167 @@
+/**
+ * Flash Record Journal Implementation
+ *
+ * Record (32 bytes, little endian):
+ *   0  magic "WJR1"
+ *   4  sequence
+ *   8  payload (JOURNAL_PAYLOAD_BYTES)
+ *   28 CRC-32 of bytes 0-27
+ *
+ * Slots fill strictly in order, so a scan stops at the first blank slot.
+ * A slot that fails its read-back is left behind (unless it is still
+ * blank) and the next append takes the slot after it.
+ */
+
+#include "journal.h"
+#include "flash.h"
+#include <string.h>
+
+#define JOURNAL_MAGIC       0x31524A57u   /* "WJR1" */
+#define JOURNAL_CRC_OFFSET  (JOURNAL_RECORD_BYTES - 4)
+
+static uint32_t journal_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void journal_put_le32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * CRC-32, one nibble at a time (16-entry table)
+ */
+uint32_t journal_crc32(const void* data, uint32_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ table[crc & 15];
+        crc = (crc >> 4) ^ table[crc & 15];
+    }
+    return ~crc;
+}
+
+static uint8_t journal_blank(const uint8_t* record) {
+    for (uint32_t i = 0; i < JOURNAL_RECORD_BYTES; i++) {
+        if (record[i] != 0xFF) return 0;
+    }
+    return 1;
+}
+
+static uint8_t journal_valid(const uint8_t* record) {
+    return journal_le32(record) == JOURNAL_MAGIC &&
+           journal_le32(record + JOURNAL_CRC_OFFSET) ==
+           journal_crc32(record, JOURNAL_CRC_OFFSET);
+}
+
+/**
+ * Scan one sector: newest valid record and first blank slot
+ */
+static uint32_t journal_scan(journal_t* journal, uint8_t index) {
+    uint8_t record[JOURNAL_RECORD_BYTES];
+    uint32_t slots = journal->size / JOURNAL_RECORD_BYTES;
+    uint32_t slot;
+
+    for (slot = 0; slot < slots; slot++) {
+        flash_read(journal->base[index] + slot * JOURNAL_RECORD_BYTES, record, sizeof(record));
+        if (journal_blank(record)) break;
+        if (!journal_valid(record)) continue;  /* Torn write */
+
+        uint32_t sequence = journal_le32(record + 4);
+        if (!journal->has_record || sequence > journal->sequence) {
+            journal->has_record = 1;
+            journal->sequence = sequence;
+            journal->active = index;
+            memcpy(journal->payload, record + 8, JOURNAL_PAYLOAD_BYTES);
+        }
+    }
+    return slot;
+}
+
+/**
+ * Find the newest record and the append position
+ */
+int journal_init(journal_t* journal, uint8_t sector_a, uint8_t sector_b) {
+    uint32_t first_blank[2];
+
+    memset(journal, 0, sizeof(*journal));
+    journal->sector[0] = sector_a;
+    journal->sector[1] = sector_b;
+    journal->base[0] = flash_sector_address(sector_a);
+    journal->base[1] = flash_sector_address(sector_b);
+    journal->size = flash_sector_size(sector_a);
+    if (journal->size == 0 || journal->size != flash_sector_size(sector_b) || sector_a == sector_b) {
+        return JOURNAL_ERROR;
+    }
+
+    first_blank[0] = journal_scan(journal, 0);
+    first_blank[1] = journal_scan(journal, 1);
+    journal->next_slot = first_blank[journal->active];
+
+    return JOURNAL_OK;
+}
+
+int journal_read(const journal_t* journal, void* payload) {
+    if (!journal->has_record) {
+        return JOURNAL_ERROR_EMPTY;
+    }
+    memcpy(payload, journal->payload, JOURNAL_PAYLOAD_BYTES);
+    return JOURNAL_OK;
+}
+
+/**
+ * Append one record, moving to the other sector when this one is full
+ */
+int journal_append(journal_t* journal, const void* payload, uint8_t allow_erase) {
+    uint8_t record[JOURNAL_RECORD_BYTES];
+    uint8_t check[JOURNAL_RECORD_BYTES];
+
+    if (journal->size == 0) {
+        return JOURNAL_ERROR;
+    }
+
+    if (journal->next_slot >= journal->size / JOURNAL_RECORD_BYTES) {
+        if (!allow_erase) {
+            return JOURNAL_ERROR_FULL;
+        }
+        uint8_t other = journal->active ^ 1;
+        if (flash_erase_sector(journal->sector[other]) != FLASH_OK) {
+            return JOURNAL_ERROR;
+        }
+        journal->active = other;
+        journal->next_slot = 0;
+    }
+
+    journal_put_le32(record, JOURNAL_MAGIC);
+    journal_put_le32(record + 4, journal->sequence + 1);
+    memcpy(record + 8, payload, JOURNAL_PAYLOAD_BYTES);
+    journal_put_le32(record + JOURNAL_CRC_OFFSET, journal_crc32(record, JOURNAL_CRC_OFFSET));
+
+    uint32_t address = journal->base[journal->active] + journal->next_slot * JOURNAL_RECORD_BYTES;
+    int status = flash_program(address, record, sizeof(record));
+
+    /* A slot that took any bits is used up, even if the record is bad */
+    flash_read(address, check, sizeof(check));
+    if (!journal_blank(check)) {
+        journal->next_slot++;
+    }
+    if (status != FLASH_OK || memcmp(record, check, sizeof(record)) != 0) {
+        return JOURNAL_ERROR;
+    }
+
+    journal->sequence++;
+    journal->has_record = 1;
+    memcpy(journal->payload, payload, JOURNAL_PAYLOAD_BYTES);
+    return JOURNAL_OK;
+}
@@ -0,0 +1,55 @@
+/**
+ * Flash Record Journal
+ *
+ * Append-only log of fixed-size records in two internal flash sectors.
+ * Each record carries a sequence number and a CRC-32, is written into the
+ * next blank slot and never rewritten; the newest valid record wins. When
+ * the active sector is full the other one is erased and takes over, so
+ * erases alternate between the two sectors and each slot is programmed
+ * once per erase cycle.
+ *
+ * A record torn by power loss fails its CRC and is skipped: the previous
+ * record stays the newest one. A torn slot is never programmed again.
+ */
+
+#ifndef __JOURNAL_H
+#define __JOURNAL_H
+
+#include <stdint.h>
+
+#define JOURNAL_RECORD_BYTES  32
+#define JOURNAL_PAYLOAD_BYTES 20
+
+typedef enum {
+    JOURNAL_OK = 0,
+    JOURNAL_ERROR = 1,          // Flash program / erase failed
+    JOURNAL_ERROR_EMPTY = 2,    // No valid record
+    JOURNAL_ERROR_FULL = 3      // Sector switch needs an erase, not allowed now
+} journal_status_t;
+
+typedef struct {
+    uint8_t sector[2];          // Flash sectors (flash.h numbering)
+    uint32_t base[2];
+    uint32_t size;              // Bytes per sector (both the same size)
+    uint8_t active;             // Index of the sector with the newest record
+    uint32_t next_slot;         // First blank slot in the active sector
+    uint32_t sequence;          // Sequence of the newest record
+    uint8_t has_record;
+    uint8_t payload[JOURNAL_PAYLOAD_BYTES];   // Newest record
+} journal_t;
+
+/* Scan both sectors; an uninitialized (blank) journal is valid and empty */
+int journal_init(journal_t* journal, uint8_t sector_a, uint8_t sector_b);
+
+/* Copy the newest payload */
+int journal_read(const journal_t* journal, void* payload);
+
+/* Append a record. Switching sectors erases the other sector, which
+ * stalls the core for up to seconds: with allow_erase == 0 the write is
+ * refused instead (JOURNAL_ERROR_FULL) and the newest record stays. */
+int journal_append(journal_t* journal, const void* payload, uint8_t allow_erase);
+
+/* CRC-32 (IEEE 802.3, reflected) */
+uint32_t journal_crc32(const void* data, uint32_t len);
+
+#endif /* __JOURNAL_H */
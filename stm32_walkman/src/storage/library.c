@@ -0,0 +1,174 @@
+/**
+ * Library Index - Reader and Layout
+ * Shared by the player (app_load_playlist) and the host indexer
+ */
+
+#include "library.h"
+#include <string.h>
+
+/* Header byte offsets */
+#define LIBRARY_OFS_MAGIC           0
+#define LIBRARY_OFS_VERSION         4
+#define LIBRARY_OFS_ENTRY_BYTES     6
+#define LIBRARY_OFS_TRACK_COUNT     8
+#define LIBRARY_OFS_STRINGS_OFFSET  12
+#define LIBRARY_OFS_STRINGS_SIZE    16
+#define LIBRARY_OFS_FILE_SIZE       20
+#define LIBRARY_OFS_FLAGS           24
+
+/* Entry byte offsets */
+#define LIBRARY_ENT_PATH            0
+#define LIBRARY_ENT_TITLE           4
+#define LIBRARY_ENT_ARTIST          8
+#define LIBRARY_ENT_ALBUM           12
+#define LIBRARY_ENT_FILE_SIZE       16
+#define LIBRARY_ENT_SAMPLE_RATE     20
+#define LIBRARY_ENT_TOTAL_FRAMES    24
+#define LIBRARY_ENT_DURATION_MS     28
+#define LIBRARY_ENT_REPLAY_GAIN     32
+#define LIBRARY_ENT_REPLAY_PEAK     34
+#define LIBRARY_ENT_CODEC           36
+#define LIBRARY_ENT_CHANNELS        37
+#define LIBRARY_ENT_BITS            38
+#define LIBRARY_ENT_FLAGS           39
+
+static uint16_t library_get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t library_get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void library_put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void library_put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * Open an index, checking its layout against the file size
+ */
+int library_open(library_t* lib, const char* path) {
+    uint8_t hdr[LIBRARY_HEADER_BYTES];
+    int status;
+
+    memset(lib, 0, sizeof(*lib));
+    status = storage_open(&lib->file, path);
+    if (status != STORAGE_OK) {
+        return (status == STORAGE_ERROR_NO_FILE) ? LIBRARY_ERROR_NO_FILE : LIBRARY_ERROR;
+    }
+
+    if (storage_read(&lib->file, hdr, sizeof(hdr)) != (int32_t)sizeof(hdr)) {
+        storage_close(&lib->file);
+        return LIBRARY_ERROR_FORMAT;
+    }
+
+    lib->track_count = library_get32(hdr + LIBRARY_OFS_TRACK_COUNT);
+    lib->strings_offset = library_get32(hdr + LIBRARY_OFS_STRINGS_OFFSET);
+    lib->strings_size = library_get32(hdr + LIBRARY_OFS_STRINGS_SIZE);
+    lib->flags = library_get32(hdr + LIBRARY_OFS_FLAGS);
+
+    /* 64-bit so a corrupt count cannot wrap into a valid-looking layout */
+    uint64_t entries_end = LIBRARY_HEADER_BYTES + (uint64_t)lib->track_count * LIBRARY_ENTRY_BYTES;
+    if (library_get32(hdr + LIBRARY_OFS_MAGIC) != LIBRARY_MAGIC ||
+        library_get16(hdr + LIBRARY_OFS_VERSION) != LIBRARY_VERSION ||
+        library_get16(hdr + LIBRARY_OFS_ENTRY_BYTES) != LIBRARY_ENTRY_BYTES ||
+        lib->strings_offset != entries_end ||
+        (uint64_t)lib->strings_offset + lib->strings_size != lib->file.size ||
+        library_get32(hdr + LIBRARY_OFS_FILE_SIZE) != lib->file.size) {
+        storage_close(&lib->file);
+        return LIBRARY_ERROR_FORMAT;
+    }
+
+    return LIBRARY_OK;
+}
+
+int library_read_entry(library_t* lib, uint32_t index, library_entry_t* entry) {
+    uint8_t raw[LIBRARY_ENTRY_BYTES];
+
+    if (index >= lib->track_count ||
+        storage_seek(&lib->file, LIBRARY_HEADER_BYTES + index * LIBRARY_ENTRY_BYTES) != STORAGE_OK ||
+        storage_read(&lib->file, raw, sizeof(raw)) != (int32_t)sizeof(raw)) {
+        return LIBRARY_ERROR;
+    }
+
+    library_entry_parse(entry, raw);
+    return LIBRARY_OK;
+}
+
+int library_read_string(library_t* lib, uint32_t offset, char* out, uint32_t len) {
+    uint32_t avail;
+    int32_t n;
+
+    if (len == 0 || offset >= lib->strings_size) {
+        return LIBRARY_ERROR;
+    }
+
+    avail = lib->strings_size - offset;
+    if (avail > len - 1) avail = len - 1;
+
+    if (storage_seek(&lib->file, lib->strings_offset + offset) != STORAGE_OK ||
+        (n = storage_read(&lib->file, out, avail)) < 0) {
+        return LIBRARY_ERROR;
+    }
+    out[n] = '\0';
+    return LIBRARY_OK;
+}
+
+void library_close(library_t* lib) {
+    storage_close(&lib->file);
+}
+
+void library_header_write(const library_t* lib, uint8_t* out) {
+    memset(out, 0, LIBRARY_HEADER_BYTES);
+    library_put32(out + LIBRARY_OFS_MAGIC, LIBRARY_MAGIC);
+    library_put16(out + LIBRARY_OFS_VERSION, LIBRARY_VERSION);
+    library_put16(out + LIBRARY_OFS_ENTRY_BYTES, LIBRARY_ENTRY_BYTES);
+    library_put32(out + LIBRARY_OFS_TRACK_COUNT, lib->track_count);
+    library_put32(out + LIBRARY_OFS_STRINGS_OFFSET, lib->strings_offset);
+    library_put32(out + LIBRARY_OFS_STRINGS_SIZE, lib->strings_size);
+    library_put32(out + LIBRARY_OFS_FILE_SIZE, lib->strings_offset + lib->strings_size);
+    library_put32(out + LIBRARY_OFS_FLAGS, lib->flags);
+}
+
+void library_entry_write(const library_entry_t* entry, uint8_t* out) {
+    library_put32(out + LIBRARY_ENT_PATH, entry->path);
+    library_put32(out + LIBRARY_ENT_TITLE, entry->title);
+    library_put32(out + LIBRARY_ENT_ARTIST, entry->artist);
+    library_put32(out + LIBRARY_ENT_ALBUM, entry->album);
+    library_put32(out + LIBRARY_ENT_FILE_SIZE, entry->file_size);
+    library_put32(out + LIBRARY_ENT_SAMPLE_RATE, entry->sample_rate);
+    library_put32(out + LIBRARY_ENT_TOTAL_FRAMES, entry->total_frames);
+    library_put32(out + LIBRARY_ENT_DURATION_MS, entry->duration_ms);
+    library_put16(out + LIBRARY_ENT_REPLAY_GAIN, (uint16_t)entry->replay_gain);
+    library_put16(out + LIBRARY_ENT_REPLAY_PEAK, entry->replay_peak);
+    out[LIBRARY_ENT_CODEC] = entry->codec;
+    out[LIBRARY_ENT_CHANNELS] = entry->channels;
+    out[LIBRARY_ENT_BITS] = entry->bits_per_sample;
+    out[LIBRARY_ENT_FLAGS] = entry->flags;
+}
+
+void library_entry_parse(library_entry_t* entry, const uint8_t* in) {
+    entry->path = library_get32(in + LIBRARY_ENT_PATH);
+    entry->title = library_get32(in + LIBRARY_ENT_TITLE);
+    entry->artist = library_get32(in + LIBRARY_ENT_ARTIST);
+    entry->album = library_get32(in + LIBRARY_ENT_ALBUM);
+    entry->file_size = library_get32(in + LIBRARY_ENT_FILE_SIZE);
+    entry->sample_rate = library_get32(in + LIBRARY_ENT_SAMPLE_RATE);
+    entry->total_frames = library_get32(in + LIBRARY_ENT_TOTAL_FRAMES);
+    entry->duration_ms = library_get32(in + LIBRARY_ENT_DURATION_MS);
+    entry->replay_gain = (int16_t)library_get16(in + LIBRARY_ENT_REPLAY_GAIN);
+    entry->replay_peak = library_get16(in + LIBRARY_ENT_REPLAY_PEAK);
+    entry->codec = in[LIBRARY_ENT_CODEC];
+    entry->channels = in[LIBRARY_ENT_CHANNELS];
+    entry->bits_per_sample = in[LIBRARY_ENT_BITS];
+    entry->flags = in[LIBRARY_ENT_FLAGS];
+}
@@ -0,0 +1,91 @@
+/**
+ * Library Index
+ *
+ * Card-side index of the music collection, built on the host by wmindex
+ * (tools/wmindex.c) so the player does not list and probe directories at
+ * boot. All fields are little endian:
+ *
+ *   header   LIBRARY_HEADER_BYTES
+ *   entries  track_count x LIBRARY_ENTRY_BYTES, sorted by path
+ *   strings  NUL-terminated, deduplicated; offset 0 is the empty string
+ *
+ * Entries refer to their path and tags by string pool offset. Paths are
+ * card paths and may be in subdirectories of the music folder. Only files
+ * the decoders open are indexed.
+ *
+ * The header records the file size, so an index cut short by an
+ * interrupted copy is rejected and the player falls back to the listing.
+ */
+
+#ifndef __LIBRARY_H
+#define __LIBRARY_H
+
+#include <stdint.h>
+#include "storage.h"
+
+#define LIBRARY_INDEX_NAME "LIBRARY.IDX"    // In the music folder
+#define LIBRARY_MAGIC 0x584C4D57u           // "WMLX"
+#define LIBRARY_VERSION 1
+#define LIBRARY_HEADER_BYTES 32
+#define LIBRARY_ENTRY_BYTES 40
+
+typedef enum {
+    LIBRARY_OK = 0,
+    LIBRARY_ERROR = 1,
+    LIBRARY_ERROR_NO_FILE = 2,
+    LIBRARY_ERROR_FORMAT = 3        // Not an index, other version or truncated
+} library_status_t;
+
+typedef enum {
+    LIBRARY_CODEC_WAV = 1,
+    LIBRARY_CODEC_WNF = 2
+} library_codec_t;
+
+/* Entry flags */
+#define LIBRARY_ENTRY_GAIN 0x01     // replay_gain / replay_peak are valid
+
+/* Header flags */
+#define LIBRARY_FLAG_ANALYSED 0x01  // Gain measured for tracks without one
+
+typedef struct {
+    uint32_t path;                  // String pool offsets
+    uint32_t title;
+    uint32_t artist;
+    uint32_t album;
+    uint32_t file_size;             // Bytes, to tell a replaced file
+    uint32_t sample_rate;
+    uint32_t total_frames;
+    uint32_t duration_ms;
+    int16_t replay_gain;            // Track gain in 0.01 dB
+    uint16_t replay_peak;           // Q15, 32768 = full scale
+    uint8_t codec;                  // library_codec_t
+    uint8_t channels;
+    uint8_t bits_per_sample;        // Of the stored samples (4 for ADPCM)
+    uint8_t flags;                  // LIBRARY_ENTRY_*
+} library_entry_t;
+
+/* Open index */
+typedef struct {
+    storage_file_t file;
+    uint32_t track_count;
+    uint32_t strings_offset;
+    uint32_t strings_size;
+    uint32_t flags;                 // LIBRARY_FLAG_*
+} library_t;
+
+/* Open and validate an index */
+int library_open(library_t* lib, const char* path);
+
+int library_read_entry(library_t* lib, uint32_t index, library_entry_t* entry);
+
+/* Copy a pool string, truncated to len - 1 characters */
+int library_read_string(library_t* lib, uint32_t offset, char* out, uint32_t len);
+
+void library_close(library_t* lib);
+
+/* Serialization, shared with the host indexer */
+void library_header_write(const library_t* lib, uint8_t* out);
+void library_entry_write(const library_entry_t* entry, uint8_t* out);
+void library_entry_parse(library_entry_t* entry, const uint8_t* in);
+
+#endif /* __LIBRARY_H */
@@ -0,0 +1,48 @@
+/**
+ * SD Card Storage Interface
+ *
+ * Thin file API used by the player and playlist code. The target build
+ * implements it on top of FatFs over SDIO (storage_fatfs.c), the host
+ * simulation maps it onto a directory of the host filesystem and the
+ * core library (core/) opens host paths directly.
+ *
+ * Paths are absolute from the card root, e.g. "/music/song1.wav".
+ */
+
+#ifndef __STORAGE_H
+#define __STORAGE_H
+
+#include <stdint.h>
+
+#define STORAGE_MAX_OPEN_FILES 4
+
+typedef enum {
+    STORAGE_OK = 0,
+    STORAGE_ERROR = 1,
+    STORAGE_ERROR_NO_FILE = 2,
+    STORAGE_ERROR_NO_CARD = 3
+} storage_status_t;
+
+/* Open file handle */
+typedef struct {
+    void* handle;     // Backend file object (FatFs FIL / host FILE)
+    uint32_t size;    // File size in bytes
+    uint32_t pos;     // Current read offset in bytes
+} storage_file_t;
+
+/* Directory listing callback: called once per regular file */
+typedef void (*storage_dir_callback_t)(const char* path, uint32_t size, void* ctx);
+
+/* Initialization (mounts the card) */
+int storage_init(void);
+
+/* File access */
+int storage_open(storage_file_t* file, const char* path);
+int32_t storage_read(storage_file_t* file, void* buffer, uint32_t len);
+int storage_seek(storage_file_t* file, uint32_t offset);
+void storage_close(storage_file_t* file);
+
+/* Enumerate regular files of a directory (non-recursive) */
+int storage_list_dir(const char* directory, storage_dir_callback_t callback, void* ctx);
+
+#endif /* __STORAGE_H */
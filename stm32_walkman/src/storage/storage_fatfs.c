@@ -0,0 +1,158 @@
+/**
+ * SD Card Storage - FatFs Backend for STM32F407
+ *
+ * Uses the FatFs generic FAT filesystem module with the SDIO disk I/O
+ * layer (4-bit bus, DMA2 Stream 3). File objects come from a static pool
+ * so no heap is needed.
+ */
+
+#include "storage.h"
+#include "dma.h"
+#include "ff.h"
+#include <string.h>
+#include <stdio.h>
+
+static FATFS storage_fs;
+static FIL storage_files[STORAGE_MAX_OPEN_FILES];
+static uint8_t storage_file_used[STORAGE_MAX_OPEN_FILES];
+static uint8_t storage_mounted = 0;
+static dma_stream_t* storage_sdio_dma = NULL;
+
+/* SDIO RX stream. Transfers are driven by the SD disk I/O layer; the
+ * stream is claimed here so no other driver can take it, set up as RM0090
+ * requires for SDIO: FIFO with 4-beat bursts on both sides (the SDIO FIFO
+ * is read in bursts of four words) and the SDIO as flow controller. */
+static const dma_config_t storage_sdio_dma_config = {
+    .request = DMA_REQUEST_SDIO,
+    .priority = DMA_PRIORITY_HIGH,
+    .direction = DMA_DIR_PERIPH_TO_MEM,
+    .item_size = 4,
+    .fifo = 1,
+    .periph_burst = 1,
+    .periph_flow = 1
+};
+
+/**
+ * Mount the SD card
+ */
+int storage_init(void) {
+    if (storage_mounted) {
+        return STORAGE_OK;
+    }
+
+    if (storage_sdio_dma == NULL &&
+        dma_claim(&storage_sdio_dma_config, &storage_sdio_dma) != DMA_OK) {
+        storage_sdio_dma = NULL;
+        return STORAGE_ERROR;
+    }
+
+    if (f_mount(&storage_fs, "", 1) != FR_OK) {
+        return STORAGE_ERROR_NO_CARD;
+    }
+
+    memset(storage_file_used, 0, sizeof(storage_file_used));
+    storage_mounted = 1;
+    return STORAGE_OK;
+}
+
+/**
+ * Open file for reading
+ */
+int storage_open(storage_file_t* file, const char* path) {
+    if (!storage_mounted || file == NULL || path == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    for (int i = 0; i < STORAGE_MAX_OPEN_FILES; i++) {
+        if (storage_file_used[i]) continue;
+
+        FRESULT res = f_open(&storage_files[i], path, FA_READ);
+        if (res != FR_OK) {
+            return (res == FR_NO_FILE || res == FR_NO_PATH) ?
+                   STORAGE_ERROR_NO_FILE : STORAGE_ERROR;
+        }
+
+        storage_file_used[i] = 1;
+        file->handle = &storage_files[i];
+        file->size = (uint32_t)f_size(&storage_files[i]);
+        file->pos = 0;
+        return STORAGE_OK;
+    }
+
+    return STORAGE_ERROR;  /* Pool exhausted */
+}
+
+/**
+ * Read bytes from current position
+ * Returns bytes read, or -1 on error
+ */
+int32_t storage_read(storage_file_t* file, void* buffer, uint32_t len) {
+    UINT br = 0;
+
+    if (file == NULL || file->handle == NULL) {
+        return -1;
+    }
+
+    if (f_read((FIL*)file->handle, buffer, len, &br) != FR_OK) {
+        return -1;
+    }
+
+    file->pos += br;
+    return (int32_t)br;
+}
+
+/**
+ * Seek to absolute byte offset
+ */
+int storage_seek(storage_file_t* file, uint32_t offset) {
+    if (file == NULL || file->handle == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    if (f_lseek((FIL*)file->handle, offset) != FR_OK) {
+        return STORAGE_ERROR;
+    }
+
+    file->pos = offset;
+    return STORAGE_OK;
+}
+
+/**
+ * Close file and return it to the pool
+ */
+void storage_close(storage_file_t* file) {
+    if (file == NULL || file->handle == NULL) {
+        return;
+    }
+
+    f_close((FIL*)file->handle);
+    storage_file_used[(FIL*)file->handle - storage_files] = 0;
+    file->handle = NULL;
+}
+
+/**
+ * Enumerate regular files in a directory
+ */
+int storage_list_dir(const char* directory, storage_dir_callback_t callback, void* ctx) {
+    DIR dir;
+    FILINFO info;
+    char path[256];
+
+    if (!storage_mounted || callback == NULL) {
+        return STORAGE_ERROR;
+    }
+
+    if (f_opendir(&dir, directory) != FR_OK) {
+        return STORAGE_ERROR_NO_FILE;
+    }
+
+    while (f_readdir(&dir, &info) == FR_OK && info.fname[0] != '\0') {
+        if (info.fattrib & (AM_DIR | AM_HID | AM_SYS)) continue;
+
+        snprintf(path, sizeof(path), "%s/%s", directory, info.fname);
+        callback(path, (uint32_t)info.fsize, ctx);
+    }
+
+    f_closedir(&dir);
+    return STORAGE_OK;
+}
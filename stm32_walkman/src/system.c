@@ -20,6 +20,13 @@ void SysTick_Handler(void) {
     system_tick++;
 }
 
+/**
+ * Start the 1ms SysTick interrupt (system_init() leaves it disabled)
+ */
+void system_tick_start(void) {
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+}
+
 /**
  * Get system tick in milliseconds
  */
@@ -43,6 +50,31 @@ void system_delay_us(uint32_t us) {
     while (ticks--);
 }
 
+/**
+ * Sleep until the next interrupt
+ * The main loop idles here once a pass has done its work; SysTick, the
+ * audio DMA and button EXTI all wake the core.
+ */
+void system_idle(void) {
+    __WFI();
+}
+
+/**
+ * Enable the DWT cycle counter (wraps every ~25 s at 168 MHz)
+ */
+void system_cycles_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * Read the cycle counter; differences are valid across one wrap
+ */
+uint32_t system_get_cycles(void) {
+    return DWT->CYCCNT;
+}
+
 /**
  * Initialize system clock to 168 MHz
  * Uses HSI (16MHz internal oscillator) with PLL
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+Linux playback daemon test.
+
+Runs walkmand with the paced WAV file output (file:<path>), drives it over
+its control socket and checks:
+
+- gapless: a queued track follows the current one with no frame dropped
+  or inserted (the capture holds both sources back to back, bit-exact)
+- events: "event track" for each track as it reaches the output, then
+  "event end"
+- position: status positions advance with the output clock, freeze while
+  paused and restart from the seek point; no underruns
+- buttons: "button <name> <action>" from the input service reaches
+  subscribers as "event button <name> <action>"
+
+Usage: daemon_test.py --daemon build/linux/walkmand
+"""
+
+import argparse
+import os
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+RATE = 44100
+
+
+def write_wav(path, frames, seed):
+    """Stereo 16-bit ramp, distinct per track and never all-zero."""
+    samples = []
+    for i in range(frames):
+        v = (i * 7 + seed) % 30000 - 15000 or 1
+        samples += [v, -v]
+    data = struct.pack(f"<{len(samples)}h", *samples)
+    fmt = struct.pack("<4sIHHIIHH", b"fmt ", 16, 1, 2, RATE, RATE * 4, 4, 16)
+    body = b"WAVE" + fmt + b"data" + struct.pack("<I", len(data)) + data
+    with open(path, "wb") as f:
+        f.write(b"RIFF" + struct.pack("<I", len(body)) + body)
+    return samples
+
+
+def read_capture(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    return struct.unpack(f"<{(len(data) - 44) // 2}h", data[44:])
+
+
+class Control:
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        for _ in range(50):
+            try:
+                self.sock.connect(path)
+                break
+            except OSError:
+                time.sleep(0.05)
+        self.file = self.sock.makefile("r")
+
+    def command(self, line):
+        self.sock.sendall((line + "\n").encode())
+        return self.file.readline().strip()
+
+    def status(self):
+        reply = self.command("status").split()
+        assert reply[0] == "ok", reply
+        return dict(field.split("=") for field in reply[1:])
+
+    def event(self, timeout):
+        self.sock.settimeout(timeout)
+        try:
+            return self.file.readline().strip()
+        finally:
+            self.sock.settimeout(None)
+
+
+def check(cond, what, failures):
+    print(f"  {'ok  ' if cond else 'FAIL'} {what}")
+    if not cond:
+        failures.append(what)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--daemon", required=True)
+    args = parser.parse_args()
+
+    failures = []
+    with tempfile.TemporaryDirectory() as tmp:
+        a = os.path.join(tmp, "a.wav")
+        b = os.path.join(tmp, "b.wav")
+        capture = os.path.join(tmp, "out.wav")
+        sock = os.path.join(tmp, "walkmand.sock")
+        src_a = write_wav(a, RATE, 0)
+        src_b = write_wav(b, RATE // 2, 12345)
+
+        daemon = subprocess.Popen([args.daemon, "-s", sock, "-D", "file:" + capture],
+                                  stdout=subprocess.DEVNULL)
+        try:
+            ctl = Control(sock)
+            events = Control(sock)
+            check(events.command("subscribe") == "ok", "subscribe", failures)
+
+            print("gapless queue:")
+            check(ctl.command(f"play {a}") == "ok 1", "play a", failures)
+            check(ctl.command(f"queue {b}") == "ok 2", "queue b", failures)
+            check(events.event(2.0) == "event track 1", "event track 1", failures)
+            time.sleep(0.5)
+            pos = int(ctl.status()["position_ms"])
+            check(400 <= pos <= 600, f"position after 0.5 s: {pos} ms", failures)
+            check(events.event(2.0) == "event track 2", "event track 2", failures)
+            check(events.event(2.0) == "event end", "event end", failures)
+            check(ctl.status()["state"] == "stopped", "stopped at end", failures)
+
+            print("buttons:")
+            check(ctl.command("button play_pause pressed") == "ok", "button play_pause pressed", failures)
+            check(events.event(2.0) == "event button play_pause pressed", "event button", failures)
+            check(ctl.command("button next sideways") == "error unknown command", "bad action", failures)
+            check(ctl.command("button") == "error unknown command", "button without name", failures)
+
+            print("pause / seek:")
+            ctl.command(f"play {a}")
+            events.event(2.0)
+            time.sleep(0.2)
+            ctl.command("pause")
+            time.sleep(0.2)
+            paused = ctl.status()
+            time.sleep(0.3)
+            check(paused["state"] == "paused" and ctl.status()["position_frames"] == paused["position_frames"],
+                  f"position frozen while paused at {paused['position_ms']} ms", failures)
+            ctl.command("resume")
+            check(ctl.command("seek 800") == "ok", "seek 800 ms", failures)
+            time.sleep(0.1)
+            pos = int(ctl.status()["position_ms"])
+            check(800 <= pos <= 950, f"position after seek: {pos} ms", failures)
+            check(ctl.command("seek") == "error unknown command", "seek without position", failures)
+            check(ctl.command("play /nonexistent.wav") == "error no such file", "missing file", failures)
+            check(ctl.command("bogus") == "error unknown command", "unknown command", failures)
+            check(ctl.status()["underruns"] == "0", "no underruns", failures)
+            ctl.command("stop")
+        finally:
+            daemon.terminate()
+            daemon.wait(timeout=5)
+
+        print("capture:")
+        out = read_capture(capture)
+        start = next(i for i, s in enumerate(out) if s != 0)
+        joined = tuple(src_a + src_b)
+        check(out[start:start + len(joined)] == joined,
+              f"a + b back to back, bit-exact ({len(joined) // 2} frames)", failures)
+        check(all(s == 0 for s in out[start + len(joined):start + len(joined) + 2048]),
+              "silence after the queue ends", failures)
+
+    print(f"daemon test: {len(failures)} failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,653 @@
+/**
+ * Host Driver Tests
+ *
+ * Runs the bare metal drivers (src/gpio.c, spi.c, i2c.c, i2s.c, dma.c, flash.c)
+ * against the register models in test/fakes: configuration values, flag
+ * sequencing, interrupt paths and recovery from injected faults, plus a
+ * seeded fuzz loop over I2C transfers with random faults. The flash journal
+ * (src/storage/journal.c) runs on the flash model through power cuts, the
+ * button debounce (src/buttons/button_tracker.c) on scripted levels.
+ *
+ * Usage: test_drivers [fuzz iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fake_periph.h"
+#include "gpio.h"
+#include "spi.h"
+#include "i2c.h"
+#include "i2s.h"
+#include "dma.h"
+#include "flash.h"
+#include "journal.h"
+#include "button_tracker.h"
+
+static int checks_failed = 0;
+static int checks_run = 0;
+
+#define CHECK(cond) do { \
+    checks_run++; \
+    if (!(cond)) { \
+        checks_failed++; \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+/* i2c.c waits between the register write and the read of i2c_write_read() */
+void system_delay_us(uint32_t us) {
+    (void)us;
+}
+
+/* ============ GPIO / EXTI ============ */
+
+static volatile uint32_t exti15_10_calls;
+
+void EXTI15_10_IRQHandler(void) {
+    exti15_10_calls++;
+    for (gpio_pin_t pin = 10; pin < 16; pin++) {
+        if (gpio_exti_pending(pin)) gpio_exti_clear(pin);
+    }
+}
+
+static void test_gpio(void) {
+    fake_reset();
+
+    gpio_config(GPIO_PORT_D, 12, GPIO_MODE_OUTPUT, GPIO_OUTPUT_PP, GPIO_SPEED_HIGH, GPIO_NO_PULL);
+    CHECK(((fake_gpio[3].MODER >> 24) & 3) == 1);
+    CHECK(((fake_gpio[3].OSPEEDR >> 24) & 3) == 3);
+
+    gpio_set(GPIO_PORT_D, 12);
+    CHECK(fake_gpio_output(GPIO_PORT_D, 12) == 1);
+    CHECK(gpio_read(GPIO_PORT_D, 12) == 1);
+    gpio_toggle(GPIO_PORT_D, 12);
+    CHECK(fake_gpio_output(GPIO_PORT_D, 12) == 0);
+
+    gpio_config_alt_func(GPIO_PORT_B, 7, 4);
+    gpio_config_alt_func(GPIO_PORT_B, 9, 5);
+    CHECK(((fake_gpio[1].AFR[0] >> 28) & 15) == 4);
+    CHECK(((fake_gpio[1].AFR[1] >> 4) & 15) == 5);
+
+    /* Buttons on PD13/PD14: pull-ups, falling edge */
+    gpio_init_port(GPIO_PORT_D);
+    gpio_config_interrupt(GPIO_PORT_D, 13, GPIO_INT_FALLING);
+    gpio_config_interrupt(GPIO_PORT_D, 14, GPIO_INT_FALLING);
+    gpio_set_interrupt_priority(13, 5);
+    CHECK(fake_syscfg.EXTICR[3] == 0x0330);
+    CHECK(fake_nvic_enabled(EXTI15_10_IRQn));
+    CHECK(fake_nvic_priority(EXTI15_10_IRQn) == 5);
+    CHECK(gpio_read(GPIO_PORT_D, 13) == 1);
+
+    /* Press without NVIC service: both lines stay pending */
+    NVIC_DisableIRQ(EXTI15_10_IRQn);
+    fake_gpio_drive(GPIO_PORT_D, 13, 0);
+    fake_gpio_drive(GPIO_PORT_D, 14, 0);
+    CHECK(gpio_exti_pending(13) && gpio_exti_pending(14));
+
+    /* Clearing one line must leave the other pending (PR is rc_w1) */
+    gpio_exti_clear(13);
+    CHECK(!gpio_exti_pending(13));
+    CHECK(gpio_exti_pending(14));
+    gpio_exti_clear(14);
+
+    /* Release is a rising edge: no event on a falling-edge line */
+    NVIC_EnableIRQ(EXTI15_10_IRQn);
+    exti15_10_calls = 0;
+    fake_gpio_drive(GPIO_PORT_D, 13, 1);
+    CHECK(exti15_10_calls == 0);
+    fake_gpio_drive(GPIO_PORT_D, 13, 0);
+    CHECK(exti15_10_calls == 1);
+    CHECK(fake_exti.PR == 0);
+
+    /* A pin of another port on the same line does not trigger */
+    fake_gpio_drive(GPIO_PORT_E, 13, 1);
+    fake_gpio_drive(GPIO_PORT_E, 13, 0);
+    CHECK(exti15_10_calls == 1);
+}
+
+/* ============ SPI ============ */
+
+static uint8_t spi_echo_plus_one(uint8_t bus, uint8_t mosi) {
+    (void)bus;
+    return mosi + 1;
+}
+
+static void test_spi(void) {
+    uint8_t log[64];
+    fake_reset();
+
+    spi_init(SPI_BUS_5, SPI_DATASIZE_8BIT, SPI_PRESCALER_4, SPI_CPOL_LOW, SPI_CPHA_1EDGE);
+    CHECK(fake_rcc.APB2ENR & RCC_APB2ENR_SPI5EN);
+    CHECK(fake_spi[5].CR1 == (SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_SPE |
+                              (SPI_PRESCALER_4 << SPI_CR1_BR_Pos)));
+    CHECK(fake_gpio_output(GPIO_PORT_F, 6) == 1);    /* CS idles high */
+
+    const uint8_t frame[] = {0x2A, 0x00, 0x10, 0x00, 0xEF};
+    spi_write(SPI_BUS_5, frame, sizeof(frame));
+    CHECK(fake_spi_sent(SPI_BUS_5, log, sizeof(log)) == sizeof(frame));
+    CHECK(memcmp(log, frame, sizeof(frame)) == 0);
+    CHECK(!spi_is_busy(SPI_BUS_5));
+    CHECK(!(fake_spi[5].SR & SPI_SR_RXNE));
+    CHECK(fake_spi_tx_overwrites(SPI_BUS_5) == 0);
+
+    /* Full duplex, then a slow bus: data must not be lost either way */
+    fake_spi_set_responder(SPI_BUS_5, spi_echo_plus_one);
+    uint8_t rx[4];
+    const uint8_t tx[4] = {1, 2, 3, 4};
+    spi_transfer(SPI_BUS_5, tx, rx, 4);
+    CHECK(rx[0] == 2 && rx[3] == 5);
+
+    fake_spi_set_byte_steps(SPI_BUS_5, 40);
+    spi_write(SPI_BUS_5, frame, sizeof(frame));
+    CHECK(spi_read_byte(SPI_BUS_5) == 0x00);         /* Dummy 0xFF + 1 */
+    uint32_t sent = fake_spi_sent(SPI_BUS_5, log, sizeof(log));
+    CHECK(sent == 5 + 4 + 5 + 1);
+    CHECK(memcmp(&log[9], frame, sizeof(frame)) == 0);
+    CHECK(fake_spi_tx_overwrites(SPI_BUS_5) == 0);
+}
+
+/* ============ I2C ============ */
+
+#define CODEC_ADDR 0x1A
+
+static void test_i2c(void) {
+    fake_i2c_mem_t codec;
+    fake_reset();
+    fake_i2c_mem_init(&codec, CODEC_ADDR);
+    fake_i2c_attach(I2C_BUS_1, &codec.device);
+
+    i2c_init(I2C_BUS_1, 100000);
+    CHECK((fake_i2c[1].CCR & 0xFFF) == 210);
+    CHECK(fake_i2c[1].TRISE == 43);
+    CHECK(fake_i2c[1].CR1 & I2C_CR1_PE);
+
+    const uint8_t write[] = {0x10, 0xAB, 0xCD};
+    CHECK(i2c_write(I2C_BUS_1, CODEC_ADDR, write, sizeof(write)) == 0);
+    CHECK(codec.regs[0x10] == 0xAB && codec.regs[0x11] == 0xCD);
+    CHECK(!i2c_is_busy(I2C_BUS_1));
+
+    uint8_t read[2] = {0};
+    CHECK(i2c_write_read(I2C_BUS_1, CODEC_ADDR, 0x10, read, 2) == 0);
+    CHECK(read[0] == 0xAB && read[1] == 0xCD);
+    CHECK(fake_i2c[1].CR1 & I2C_CR1_ACK);            /* Re-armed after NACK */
+
+    /* Nobody at the address: AF, STOP, bus released, error reported */
+    uint32_t stops = fake_i2c_stops(I2C_BUS_1);
+    CHECK(i2c_write(I2C_BUS_1, 0x22, write, 1) == -1);
+    CHECK(fake_i2c_stops(I2C_BUS_1) == stops + 1);
+    CHECK(!i2c_is_busy(I2C_BUS_1));
+    CHECK(!(fake_i2c[1].SR1 & I2C_SR1_AF));
+
+    /* NACK on the second data byte: the first one landed, nothing after */
+    codec.writes = 0;
+    fake_i2c_inject(I2C_BUS_1, FAKE_I2C_NACK, 2);
+    CHECK(i2c_write(I2C_BUS_1, CODEC_ADDR, write, sizeof(write)) == -1);
+    CHECK(codec.writes == 0);
+
+    /* Bus error, arbitration loss and a stuck slave during a read */
+    fake_i2c_inject(I2C_BUS_1, FAKE_I2C_BUS_ERROR, 1);
+    CHECK(i2c_read(I2C_BUS_1, CODEC_ADDR, read, 2) == -1);
+    fake_i2c_inject(I2C_BUS_1, FAKE_I2C_ARB_LOST, 0);
+    CHECK(i2c_read(I2C_BUS_1, CODEC_ADDR, read, 2) == -1);
+    fake_i2c_inject(I2C_BUS_1, FAKE_I2C_STUCK, 0);
+    CHECK(i2c_write(I2C_BUS_1, CODEC_ADDR, write, 1) == -1);
+    CHECK(fake_i2c[1].SR1 == 0);
+
+    /* And the bus works again afterwards */
+    CHECK(i2c_write_read(I2C_BUS_1, CODEC_ADDR, 0x11, read, 1) == 0);
+    CHECK(read[0] == 0xCD);
+}
+
+/* ============ I2S / DMA ============ */
+
+#define I2S_TEST_SAMPLES 64
+
+static uint32_t i2s_halves[2];
+static uint8_t i2s_last_half = 0xFF;
+
+static void i2s_test_callback(uint8_t half) {
+    i2s_halves[half]++;
+    i2s_last_half = half;
+}
+
+static void test_i2s(void) {
+    static int16_t buffer[I2S_TEST_SAMPLES];
+    int16_t out[I2S_TEST_SAMPLES * 3];
+
+    fake_reset();
+    memset(i2s_halves, 0, sizeof(i2s_halves));
+    for (int i = 0; i < I2S_TEST_SAMPLES; i++) buffer[i] = (int16_t)(i * 3 - 100);
+    fake_mem_map(buffer, sizeof(buffer));
+
+    i2s_init(I2S_SR_44100);
+    i2s_set_callback(i2s_test_callback);
+    CHECK(fake_nvic_enabled(DMA1_Stream5_IRQn));
+    CHECK(fake_dma_stream[0][5].CR & DMA_SxCR_CIRC);
+    CHECK((fake_dma_stream[0][5].CR & DMA_SxCR_PL) == DMA_SxCR_PL);   /* Very high */
+    CHECK(fake_dma_stream[0][5].FCR & DMA_SxFCR_DMDIS);                /* FIFO mode */
+    CHECK(fake_spi[3].I2SCFGR & SPI_I2SCFGR_I2SE);
+
+    i2s_start_dma(buffer, I2S_TEST_SAMPLES);
+    CHECK(fake_dma_stream[0][5].PAR == (uint32_t)(uintptr_t)&SPI3->DR);
+    CHECK(fake_dma_stream[0][5].NDTR == I2S_TEST_SAMPLES);
+
+    /* Half, full, and the circular wrap */
+    CHECK(fake_i2s_clock(3, out, I2S_TEST_SAMPLES / 2) == I2S_TEST_SAMPLES / 2);
+    CHECK(i2s_halves[0] == 1 && i2s_halves[1] == 0);
+    CHECK(fake_i2s_clock(3, out + I2S_TEST_SAMPLES / 2, I2S_TEST_SAMPLES * 5 / 2) ==
+          I2S_TEST_SAMPLES * 5 / 2);
+    CHECK(i2s_halves[0] == 3 && i2s_halves[1] == 3);
+    CHECK(i2s_last_half == 1);
+    CHECK(i2s_dma_complete());
+    CHECK(memcmp(out, buffer, sizeof(buffer)) == 0);
+    CHECK(memcmp(out + I2S_TEST_SAMPLES * 2, buffer, sizeof(buffer)) == 0);
+    CHECK((fake_dma[0].HISR & (DMA_HISR_HTIF5 | DMA_HISR_TCIF5)) == 0);
+    CHECK(fake_i2s_underruns(3) == 0);
+
+    /* Paused: the codec keeps clocking, slots underrun, position is kept */
+    fake_i2s_clock(3, out, 5);
+    CHECK(i2s_get_position() == 5);
+    i2s_hold_callback(1);
+    CHECK(!fake_nvic_enabled(DMA1_Stream5_IRQn));
+    i2s_hold_callback(0);
+    CHECK(fake_nvic_enabled(DMA1_Stream5_IRQn));
+    i2s_pause();
+    CHECK(fake_i2s_clock(3, NULL, 10) == 0);
+    CHECK(fake_i2s_underruns(3) == 10);
+    CHECK(fake_spi[3].SR & SPI_SR_UDR);
+    CHECK(i2s_get_position() == 5);
+    i2s_resume();
+    fake_i2s_clock(3, out, 1);
+    CHECK(out[0] == buffer[5]);
+
+    /* DMA stalls show up as underruns without losing data */
+    fake_dma_stall(0, 5, 3);
+    CHECK(fake_i2s_clock(3, out, 4) == 1);
+    CHECK(out[3] == buffer[6]);
+    CHECK(fake_i2s_underruns(3) == 13);
+
+    /* FIFO error: counted, the stream keeps running */
+    fake_dma_inject_fifo_error(0, 5);
+    CHECK(i2s_get_fifo_errors() == 1);
+    CHECK(fake_dma_stream[0][5].CR & DMA_SxCR_EN);
+    CHECK((fake_dma[0].HISR & DMA_HISR_FEIF5) == 0);
+
+    /* Transfer error: counted, stream stopped until restarted */
+    fake_dma_inject_error(0, 5);
+    CHECK(i2s_get_errors() == 1);
+    CHECK(!(fake_dma_stream[0][5].CR & DMA_SxCR_EN));
+    CHECK(fake_i2s_clock(3, NULL, 4) == 0);
+    i2s_start_dma(buffer, I2S_TEST_SAMPLES);
+    fake_i2s_clock(3, out, 1);
+    CHECK(out[0] == buffer[0]);
+
+    /* A buffer the DMA cannot reach is a bus error too */
+    static int16_t unmapped[8];
+    i2s_start_dma(unmapped, 8);
+    CHECK(fake_i2s_clock(3, NULL, 1) == 0);
+    CHECK(i2s_get_errors() == 2);
+
+    i2s_stop();
+    CHECK(!(fake_spi[3].I2SCFGR & SPI_I2SCFGR_I2SE));
+}
+
+/* ============ DMA stream manager ============ */
+
+static void test_dma(void) {
+    static int16_t aligned[16] __attribute__((aligned(8)));
+    dma_stream_t* sdio;
+    dma_stream_t* spi1;
+    dma_stream_t* lcd;
+    dma_stream_t* other;
+
+    fake_reset();
+    fake_mem_map(aligned, sizeof(aligned));
+
+    dma_config_t config = {
+        .request = DMA_REQUEST_SDIO,
+        .priority = DMA_PRIORITY_HIGH,
+        .direction = DMA_DIR_PERIPH_TO_MEM,
+        .item_size = 4,
+        .fifo = 1,
+        .periph_burst = 1,
+        .periph_flow = 1
+    };
+    CHECK(dma_claim(&config, &sdio) == DMA_OK);
+    CHECK(sdio->controller == 2 && sdio->stream == 3 && sdio->channel == 4);
+    CHECK(fake_rcc.AHB1ENR & RCC_AHB1ENR_DMA2EN);
+    uint32_t cr = fake_dma_stream[1][3].CR;
+    CHECK(((cr & DMA_SxCR_CHSEL) >> DMA_SxCR_CHSEL_Pos) == 4);
+    CHECK(((cr & DMA_SxCR_PL) >> DMA_SxCR_PL_Pos) == DMA_PRIORITY_HIGH);
+    CHECK(((cr & DMA_SxCR_PBURST) >> DMA_SxCR_PBURST_Pos) == 1);
+    CHECK(((cr & DMA_SxCR_MBURST) >> DMA_SxCR_MBURST_Pos) == 1);
+    CHECK((cr & DMA_SxCR_PFCTRL) && !(cr & DMA_SxCR_DIR_0));
+    CHECK(!fake_nvic_enabled(DMA2_Stream3_IRQn));
+
+    /* SPI1 TX shares stream 3 with SDIO: it moves to stream 5 */
+    config = (dma_config_t){
+        .request = DMA_REQUEST_SPI1_TX,
+        .priority = DMA_PRIORITY_LOW,
+        .direction = DMA_DIR_MEM_TO_PERIPH,
+        .item_size = 1,
+        .interrupts = DMA_FLAG_TC,
+        .irq_priority = 9
+    };
+    CHECK(dma_claim(&config, &spi1) == DMA_OK);
+    CHECK(spi1->controller == 2 && spi1->stream == 5 && spi1->channel == 3);
+    CHECK(fake_nvic_enabled(DMA2_Stream5_IRQn));
+    CHECK(!(fake_dma_stream[1][5].FCR & DMA_SxFCR_DMDIS));     /* Direct mode */
+
+    /* Both SPI1 TX streams taken: a conflict, not a silent takeover */
+    CHECK(dma_claim(&config, &other) == DMA_ERROR_CONFLICT);
+    config.request = DMA_REQUEST_SDIO;
+    config.circular = 1;
+    config.periph_flow = 1;
+    CHECK(dma_claim(&config, &other) == DMA_ERROR_ARGUMENT);  /* Flow control + circular */
+
+    config = (dma_config_t){
+        .request = DMA_REQUEST_SPI5_TX,
+        .priority = DMA_PRIORITY_MEDIUM,
+        .direction = DMA_DIR_MEM_TO_PERIPH,
+        .item_size = 2,
+        .fifo = 1,
+        .interrupts = DMA_FLAG_TC | DMA_FLAG_TE
+    };
+    CHECK(dma_claim(&config, &lcd) == DMA_OK);
+    CHECK(lcd->stream == 4 && dma_get_stream(2, 4) == lcd);
+    CHECK(dma_get_stream(2, 6) == NULL);
+
+    /* Bursts only for aligned buffers holding whole bursts */
+    dma_start(lcd, (uint32_t)(uintptr_t)&SPI5->DR, aligned, 16);
+    CHECK(((fake_dma_stream[1][4].CR & DMA_SxCR_MBURST) >> DMA_SxCR_MBURST_Pos) == 1);
+    CHECK(dma_remaining(lcd) == 16);
+    dma_start(lcd, (uint32_t)(uintptr_t)&SPI5->DR, &aligned[1], 8);
+    CHECK((fake_dma_stream[1][4].CR & DMA_SxCR_MBURST) == 0);
+    dma_start(lcd, (uint32_t)(uintptr_t)&SPI5->DR, aligned, 6);
+    CHECK((fake_dma_stream[1][4].CR & DMA_SxCR_MBURST) == 0);
+    CHECK(fake_dma_stream[1][4].CR & DMA_SxCR_EN);
+
+    /* Flags of neighbouring streams in HISR stay untouched */
+    fake_dma_inject_fifo_error(1, 5);
+    fake_dma_inject_error(1, 4);
+    CHECK(dma_irq_ack(lcd) == DMA_FLAG_TE);
+    CHECK(lcd->transfer_errors == 1 && lcd->fifo_errors == 0);
+    CHECK(dma_irq_ack(spi1) == DMA_FLAG_FE);
+    CHECK(spi1->fifo_errors == 1);
+    CHECK(fake_dma[1].HISR == 0);
+
+    dma_release(lcd);
+    CHECK(dma_get_stream(2, 4) == NULL);
+    CHECK(!(fake_dma_stream[1][4].CR & DMA_SxCR_EN));
+    CHECK(dma_claim(&config, &other) == DMA_OK && other->stream == 4);
+    dma_release(other);
+    dma_release(spi1);
+    dma_release(sdio);
+}
+
+/* ============ Flash ============ */
+
+static void test_flash(void) {
+    const uint8_t data[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    const uint8_t ones[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t back[8];
+
+    fake_reset();
+    fake_flash_fill(0xFF);
+    fake_flash_protect(0);
+
+    CHECK(flash_sector_address(5) == 0x08020000);
+    CHECK(flash_sector_address(11) == 0x080E0000);
+    CHECK(flash_sector_size(4) == 64 * 1024);
+    CHECK(flash_sector_size(12) == 0);
+
+    uint32_t address = flash_sector_address(2);
+    CHECK(flash_program(address, data, sizeof(data)) == FLASH_OK);
+    flash_read(address, back, sizeof(back));
+    CHECK(memcmp(back, data, sizeof(data)) == 0);
+    CHECK(fake_flash.CR & FLASH_CR_LOCK);
+    CHECK(!(fake_flash.CR & FLASH_CR_PG));
+
+    /* Programming cannot set bits back to 1 */
+    CHECK(flash_program(address, ones, sizeof(ones)) == FLASH_OK);
+    flash_read(address, back, sizeof(back));
+    CHECK(memcmp(back, data, sizeof(data)) == 0);
+
+    CHECK(flash_program(address + 2, data, 4) == FLASH_ERROR_ARGUMENT);
+    CHECK(flash_program(address, data, 6) == FLASH_ERROR_ARGUMENT);
+    CHECK(flash_erase_sector(12) == FLASH_ERROR_ARGUMENT);
+
+    CHECK(flash_erase_sector(2) == FLASH_OK);
+    CHECK(fake_flash_erases(2) == 1);
+    flash_read(address, back, sizeof(back));
+    CHECK(memcmp(back, ones, sizeof(ones)) == 0);
+    CHECK(!(fake_flash.CR & (FLASH_CR_SER | FLASH_CR_SNB)));
+
+    /* Write protection: error reported, flags cleared, array untouched */
+    fake_flash_protect(1u << 2);
+    CHECK(flash_erase_sector(2) == FLASH_ERROR_PROTECTED);
+    CHECK(flash_program(address, data, sizeof(data)) == FLASH_ERROR_PROTECTED);
+    CHECK((fake_flash.SR & (FLASH_SR_WRPERR | FLASH_SR_PGSERR)) == 0);
+    CHECK(fake_flash_erases(2) == 1);
+    flash_read(address, back, sizeof(back));
+    CHECK(memcmp(back, ones, sizeof(ones)) == 0);
+    fake_flash_protect(0);
+
+    /* A bad unlock key keeps the interface locked until reset */
+    WRITE_REG(FLASH->KEYR, 0x12345678u);
+    CHECK(flash_program(address, data, sizeof(data)) == FLASH_ERROR);
+    fake_reset();
+    CHECK(flash_program(address, data, sizeof(data)) == FLASH_OK);
+}
+
+/* ============ Journal on the flash model ============ */
+
+#define TEST_JOURNAL_SLOTS (16 * 1024 / JOURNAL_RECORD_BYTES)
+
+static int journal_append_n(journal_t* j, uint32_t n, uint32_t* counter) {
+    uint8_t payload[JOURNAL_PAYLOAD_BYTES];
+    int status = JOURNAL_OK;
+
+    for (uint32_t i = 0; i < n && status == JOURNAL_OK; i++) {
+        memset(payload, 0, sizeof(payload));
+        memcpy(payload, counter, sizeof(*counter));
+        status = journal_append(j, payload, 1);
+        (*counter)++;
+    }
+    return status;
+}
+
+static uint32_t journal_newest(const journal_t* j) {
+    uint8_t payload[JOURNAL_PAYLOAD_BYTES];
+    uint32_t value = 0xFFFFFFFFu;
+
+    if (journal_read(j, payload) == JOURNAL_OK) memcpy(&value, payload, sizeof(value));
+    return value;
+}
+
+static void test_journal(void) {
+    uint8_t payload[JOURNAL_PAYLOAD_BYTES];
+    uint32_t counter = 0;
+    journal_t j;
+
+    fake_reset();
+    fake_flash_fill(0xFF);
+    fake_flash_protect(0);
+
+    CHECK(journal_crc32("123456789", 9) == 0xCBF43926u);
+    CHECK(journal_init(&j, 2, 4) == JOURNAL_ERROR);    /* Unequal sizes */
+
+    CHECK(journal_init(&j, 2, 3) == JOURNAL_OK);
+    CHECK(journal_read(&j, payload) == JOURNAL_ERROR_EMPTY);
+
+    CHECK(journal_append_n(&j, 3, &counter) == JOURNAL_OK);
+    CHECK(journal_init(&j, 2, 3) == JOURNAL_OK);
+    CHECK(journal_newest(&j) == 2);
+    CHECK(j.sequence == 3 && j.next_slot == 3);
+
+    /* Filling a sector moves to the other one; erases alternate */
+    CHECK(journal_append_n(&j, TEST_JOURNAL_SLOTS, &counter) == JOURNAL_OK);
+    CHECK(fake_flash_erases(3) == 1 && fake_flash_erases(2) == 0);
+    CHECK(journal_append_n(&j, TEST_JOURNAL_SLOTS, &counter) == JOURNAL_OK);
+    CHECK(fake_flash_erases(3) == 1 && fake_flash_erases(2) == 1);
+    CHECK(journal_init(&j, 2, 3) == JOURNAL_OK);
+    CHECK(journal_newest(&j) == counter - 1);
+    CHECK(j.active == 0);
+
+    /* Full sector without permission to erase: refused, nothing lost */
+    CHECK(journal_append_n(&j, TEST_JOURNAL_SLOTS - j.next_slot, &counter) == JOURNAL_OK);
+    memset(payload, 0xAA, sizeof(payload));
+    CHECK(journal_append(&j, payload, 0) == JOURNAL_ERROR_FULL);
+    CHECK(fake_flash_erases(3) == 1);
+    CHECK(journal_newest(&j) == counter - 1);
+
+    /* Power lost while the sector switch erases: the old record survives */
+    fake_flash_power_cut(1);
+    CHECK(journal_append(&j, payload, 1) == JOURNAL_ERROR);
+    CHECK(!fake_flash_powered());
+    fake_reset();
+    CHECK(journal_init(&j, 2, 3) == JOURNAL_OK);
+    CHECK(journal_newest(&j) == counter - 1);
+    CHECK(journal_append_n(&j, 1, &counter) == JOURNAL_OK);
+    CHECK(fake_flash_erases(3) == 1 && j.active == 1);
+
+    /* Power lost in the middle of a record: torn slot skipped */
+    fake_flash_power_cut(3);
+    CHECK(journal_append(&j, payload, 1) == JOURNAL_ERROR);
+    fake_reset();
+    CHECK(journal_init(&j, 2, 3) == JOURNAL_OK);
+    CHECK(journal_newest(&j) == counter - 1);
+    uint32_t torn_slot = j.next_slot - 1;
+    CHECK(journal_append_n(&j, 1, &counter) == JOURNAL_OK);
+    CHECK(journal_init(&j, 2, 3) == JOURNAL_OK);
+    CHECK(journal_newest(&j) == counter - 1);
+    CHECK(j.next_slot == torn_slot + 2);
+
+    /* Write protected: failed appends do not burn blank slots */
+    uint32_t next = j.next_slot;
+    fake_flash_protect((1u << 2) | (1u << 3));
+    CHECK(journal_append(&j, payload, 1) == JOURNAL_ERROR);
+    CHECK(j.next_slot == next);
+    fake_flash_protect(0);
+    CHECK(journal_append_n(&j, 1, &counter) == JOURNAL_OK);
+    CHECK(journal_init(&j, 2, 3) == JOURNAL_OK);
+    CHECK(journal_newest(&j) == counter - 1);
+}
+
+/* ============ Button debounce and long press ============ */
+
+static void test_buttons(void) {
+    button_tracker_t t;
+    button_event_t event = BUTTON_RELEASED;
+
+    button_tracker_init(&t);
+    CHECK(button_tracker_deadline(&t, 0) == BUTTON_NO_DEADLINE);
+
+    /* Contact bounce shorter than the debounce time: nothing */
+    CHECK(!button_tracker_update(&t, 1, 100, &event));
+    CHECK(button_tracker_deadline(&t, 105) == 15);
+    CHECK(!button_tracker_update(&t, 0, 110, &event));
+    CHECK(button_tracker_deadline(&t, 110) == BUTTON_NO_DEADLINE);
+
+    /* Press held through the debounce, then long press once */
+    CHECK(!button_tracker_update(&t, 1, 200, &event));
+    CHECK(!button_tracker_update(&t, 1, 219, &event));
+    CHECK(button_tracker_update(&t, 1, 220, &event) && event == BUTTON_PRESSED);
+    CHECK(button_tracker_deadline(&t, 220) == BUTTON_LONG_PRESS_MS);
+    CHECK(!button_tracker_update(&t, 1, 1219, &event));
+    CHECK(button_tracker_update(&t, 1, 1220, &event) && event == BUTTON_LONG_PRESSED);
+    CHECK(!button_tracker_update(&t, 1, 3000, &event));
+    CHECK(button_tracker_deadline(&t, 3000) == BUTTON_NO_DEADLINE);
+
+    /* Release; an overdue deadline reads as 0 */
+    CHECK(!button_tracker_update(&t, 0, 3100, &event));
+    CHECK(button_tracker_deadline(&t, 3200) == 0);
+    CHECK(button_tracker_update(&t, 0, 3200, &event) && event == BUTTON_RELEASED);
+
+    /* Across the 32-bit millisecond wrap */
+    CHECK(!button_tracker_update(&t, 1, 0xFFFFFFF0u, &event));
+    CHECK(button_tracker_update(&t, 1, 0x00000004u, &event) && event == BUTTON_PRESSED);
+    CHECK(button_tracker_deadline(&t, 0x00000004u) == BUTTON_LONG_PRESS_MS);
+}
+
+/* ============ Fuzz: I2C transfers with random faults ============ */
+
+static uint32_t fuzz_rand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static void test_i2c_fuzz(uint32_t iterations) {
+    fake_i2c_mem_t mem;
+    uint8_t shadow[256];
+    uint32_t seed = 0x5EED1234;
+    uint32_t failures = 0;
+
+    fake_reset();
+    fake_i2c_mem_init(&mem, CODEC_ADDR);
+    fake_i2c_attach(I2C_BUS_1, &mem.device);
+    i2c_init(I2C_BUS_1, 400000);
+    memset(shadow, 0, sizeof(shadow));
+
+    for (uint32_t it = 0; it < iterations; it++) {
+        uint8_t data[9];
+        uint32_t len = 1 + fuzz_rand(&seed) % 8;
+        uint8_t reg = fuzz_rand(&seed);
+        uint8_t addr = (fuzz_rand(&seed) % 16) ? CODEC_ADDR : 0x50;
+        uint8_t faulty = (fuzz_rand(&seed) % 4) == 0;
+
+        data[0] = reg;
+        for (uint32_t i = 1; i <= len; i++) data[i] = fuzz_rand(&seed);
+
+        if (faulty) {
+            /* STUCK costs a full timeout; keep it rare */
+            fake_i2c_fault_t fault = fuzz_rand(&seed) % 16 ? fuzz_rand(&seed) % 3 : FAKE_I2C_STUCK;
+            fake_i2c_inject(I2C_BUS_1, fault, fuzz_rand(&seed) % (len + 2));
+        }
+
+        int written = i2c_write(I2C_BUS_1, addr, data, len + 1);
+        uint8_t expect_ok = (addr == CODEC_ADDR) && !faulty;
+        if (expect_ok != (written == 0)) {
+            /* A fault armed past the last byte never fires: still fine */
+            if (!(faulty && written == 0)) failures++;
+        }
+        if (written == 0) {
+            for (uint32_t i = 1; i <= len; i++) shadow[(uint8_t)(reg + i - 1)] = data[i];
+        }
+        fake_i2c_inject(I2C_BUS_1, FAKE_I2C_NACK, 1000);  /* Disarm leftovers */
+
+        if (i2c_is_busy(I2C_BUS_1) || fake_i2c[1].SR1 != 0) failures++;
+        if (memcmp(shadow, mem.regs, sizeof(shadow)) != 0) {
+            /* Bytes before a mid-transfer fault did land: resync and go on */
+            if (written == 0) failures++;
+            memcpy(shadow, mem.regs, sizeof(shadow));
+        }
+
+        uint8_t back[8];
+        if (i2c_write_read(I2C_BUS_1, CODEC_ADDR, reg, back, len) != 0 ||
+            memcmp(back, &mem.regs[reg], len > 256u - reg ? 256u - reg : len) != 0) {
+            failures++;
+        }
+    }
+
+    CHECK(failures == 0);
+}
+
+int main(int argc, char** argv) {
+    uint32_t fuzz = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 2000;
+
+    test_gpio();
+    test_spi();
+    test_i2c();
+    test_i2s();
+    test_dma();
+    test_flash();
+    test_journal();
+    test_buttons();
+    test_i2c_fuzz(fuzz);
+
+    printf("driver tests: %d checks, %d failed (%llu register accesses)\n",
+           checks_run, checks_failed, (unsigned long long)fake_steps());
+    return checks_failed ? 1 : 0;
+}
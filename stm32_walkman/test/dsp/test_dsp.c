@@ -0,0 +1,307 @@
+/**
+ * Host DSP Tests
+ *
+ * Runs the output-path stages of src/dsp on synthetic signals and checks
+ * the properties the player relies on, which the goldens only see end to
+ * end and the benchmarks only time: crossfeed passes mono bit-exact, the
+ * limiter holds its ceiling and meters what it took off, loudness
+ * compensation steps out of the way at full volume, time stretch changes
+ * the length and not the pitch.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crossfeed.h"
+#include "limiter.h"
+#include "loudcomp.h"
+#include "wsola.h"
+
+static int checks_failed = 0;
+static int checks_run = 0;
+
+#define CHECK(cond) do { \
+    checks_run++; \
+    if (!(cond)) { \
+        checks_failed++; \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TEST_FRAMES 4096
+
+static const uint32_t test_rates[] = {44100, 48000, 96000};
+#define TEST_RATE_COUNT (sizeof(test_rates) / sizeof(test_rates[0]))
+
+static int32_t test_buf[TEST_FRAMES * DSP_CHANNELS];
+static int32_t test_ref[TEST_FRAMES * DSP_CHANNELS];
+
+static uint32_t test_rand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state;
+}
+
+/* Full-scale white noise, the same sample on both channels */
+static void test_noise_mono(int32_t* buf, uint32_t frames, uint32_t seed) {
+    for (uint32_t i = 0; i < frames; i++) {
+        buf[2 * i] = buf[2 * i + 1] = (int32_t)test_rand(&seed);
+    }
+}
+
+/* Stereo sine at level dBFS */
+static void test_sine(int32_t* buf, uint32_t frames, float hz, float db, uint32_t rate) {
+    double amp = 2147483647.0 * pow(10.0, db / 20.0);
+    for (uint32_t i = 0; i < frames; i++) {
+        buf[2 * i] = buf[2 * i + 1] = (int32_t)lrint(amp * sin(2.0 * M_PI * hz * i / rate));
+    }
+}
+
+/* Largest magnitude in buf */
+static uint32_t test_peak(const int32_t* buf, uint32_t samples) {
+    uint32_t peak = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+        uint32_t a = (buf[i] < 0) ? 0u - (uint32_t)buf[i] : (uint32_t)buf[i];
+        if (a > peak) peak = a;
+    }
+    return peak;
+}
+
+/* ============ Crossfeed ============ */
+
+static void test_crossfeed(void) {
+    crossfeed_t cf;
+
+    /* Mono: the direct path gives up exactly what the cross path adds */
+    for (uint32_t r = 0; r < TEST_RATE_COUNT; r++) {
+        for (crossfeed_preset_t p = CROSSFEED_OFF; p < CROSSFEED_PRESET_COUNT; p++) {
+            CHECK(crossfeed_init(&cf, p, test_rates[r]) == CROSSFEED_OK);
+            test_noise_mono(test_ref, TEST_FRAMES, 0xC0FFEE + p);
+            memcpy(test_buf, test_ref, sizeof(test_buf));
+            /* Uneven blocks, as the player hands them over */
+            for (uint32_t done = 0, n = 1; done < TEST_FRAMES; done += n, n = n * 3 + 1) {
+                if (n > TEST_FRAMES - done) n = TEST_FRAMES - done;
+                crossfeed_q31(&cf, &test_buf[done * DSP_CHANNELS], n);
+            }
+            CHECK(memcmp(test_buf, test_ref, sizeof(test_buf)) == 0);
+        }
+    }
+
+    /* Left only: the right ear hears it, so the mono check is not vacuous */
+    CHECK(crossfeed_init(&cf, CROSSFEED_HIGH, 44100) == CROSSFEED_OK);
+    test_noise_mono(test_buf, TEST_FRAMES, 0xC0FFEE);
+    int64_t right = 0;
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        test_buf[2 * i] >>= 1;
+        test_buf[2 * i + 1] = 0;
+    }
+    crossfeed_q31(&cf, test_buf, TEST_FRAMES);
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        right += llabs(test_buf[2 * i + 1]);
+    }
+    CHECK(right > 0);
+}
+
+/* ============ Limiter / DRC ============ */
+
+/* The player's settings (player.c) */
+static const limiter_config_t test_limiter_config = {
+    .ceiling_db = -1.0f,
+    .lookahead_ms = 2.0f,
+    .release_ms = 80.0f,
+    .drc_threshold_db = -30.0f,
+    .drc_ratio = 3.0f,
+    .drc_makeup_db = 10.0f,
+    .drc_attack_ms = 10.0f,
+    .drc_release_ms = 300.0f
+};
+
+/* Zeroed like the player's static one: limited_frames counts across inits */
+static int test_limiter_init(limiter_t* lim, uint32_t rate, uint8_t drc) {
+    memset(lim, 0, sizeof(*lim));
+    int status = limiter_init(lim, &test_limiter_config, rate);
+    limiter_set_drc(lim, drc);
+    return status;
+}
+
+/* Run a sine through the limiter in player-sized blocks; returns the output peak */
+static uint32_t test_limit(limiter_t* lim, float db, uint32_t rate) {
+    test_sine(test_buf, TEST_FRAMES, 997.0f, db, rate);
+    for (uint32_t done = 0; done < TEST_FRAMES; done += 256) {
+        limiter_q31(lim, &test_buf[done * DSP_CHANNELS], 256);
+    }
+    return test_peak(test_buf, TEST_FRAMES * DSP_CHANNELS);
+}
+
+static void test_limiter(void) {
+    const uint32_t ceiling = (uint32_t)(2147483647.0 * pow(10.0, -1.0 / 20.0));
+    const uint32_t quiet = (uint32_t)(2147483647.0 * pow(10.0, -40.0 / 20.0));
+    static limiter_t lim;
+    limiter_meter_t meter;
+
+    for (uint32_t r = 0; r < TEST_RATE_COUNT; r++) {
+        /* Full scale: held at -1 dBFS, about 1 dB taken off and metered */
+        CHECK(test_limiter_init(&lim, test_rates[r], 0) == LIMITER_OK);
+        uint32_t peak = test_limit(&lim, 0.0f, test_rates[r]);
+        CHECK(peak <= ceiling);
+        CHECK(peak > ceiling / 2);
+        limiter_read_meter(&lim, &meter);
+        CHECK(meter.reduction_db > 0.9f && meter.reduction_db < 1.5f);
+        CHECK(meter.limited_frames > 0);
+        CHECK(meter.drc_gain_db == 0.0f);
+
+        /* DRC make-up on full scale: the limiter catches the boost until
+         * the compressor has come down */
+        CHECK(test_limiter_init(&lim, test_rates[r], 1) == LIMITER_OK);
+        CHECK(test_limit(&lim, 0.0f, test_rates[r]) <= ceiling);
+        limiter_read_meter(&lim, &meter);
+        CHECK(meter.reduction_db > 0.9f);
+        CHECK(meter.limited_frames > 0);
+        CHECK(meter.drc_gain_db < 0.0f);
+
+        /* Quiet: untouched, delayed by the look-ahead */
+        CHECK(test_limiter_init(&lim, test_rates[r], 0) == LIMITER_OK);
+        test_limit(&lim, -20.0f, test_rates[r]);
+        uint32_t latency = limiter_latency(&lim);
+        test_sine(test_ref, TEST_FRAMES, 997.0f, -20.0f, test_rates[r]);
+        CHECK(memcmp(&test_buf[latency * DSP_CHANNELS], test_ref,
+                     (TEST_FRAMES - latency) * DSP_CHANNELS * sizeof(int32_t)) == 0);
+        limiter_read_meter(&lim, &meter);
+        CHECK(meter.reduction_db == 0.0f);
+        CHECK(meter.limited_frames == 0);
+
+        /* Quiet with DRC: lifted by the make-up, still nothing limited */
+        CHECK(test_limiter_init(&lim, test_rates[r], 1) == LIMITER_OK);
+        CHECK(test_limit(&lim, -40.0f, test_rates[r]) > 2 * quiet);
+        limiter_read_meter(&lim, &meter);
+        CHECK(meter.drc_gain_db > 9.0f);
+        CHECK(meter.limited_frames == 0);
+    }
+}
+
+/* ============ Loudness compensation ============ */
+
+static void test_loudcomp(void) {
+    static loudcomp_t lc;
+    float low_db, high_db;
+
+    for (uint32_t r = 0; r < TEST_RATE_COUNT; r++) {
+        /* Full volume is the reference level: no boost, stage left out */
+        CHECK(loudcomp_init(&lc, test_rates[r]) == LOUDCOMP_OK);
+        CHECK(loudcomp_is_flat(&lc));
+        loudcomp_set_volume(&lc, 100);
+        CHECK(loudcomp_is_flat(&lc));
+        loudcomp_set_volume(&lc, 98);       /* Rounds to the 100 % step */
+        CHECK(loudcomp_is_flat(&lc));
+        loudcomp_shelf_gains(&lc, 100, &low_db, &high_db);
+        CHECK(fabsf(low_db) < 0.01f && fabsf(high_db) < 0.01f);
+        test_noise_mono(test_ref, TEST_FRAMES, 0x10D + r);
+        memcpy(test_buf, test_ref, sizeof(test_buf));
+        loudcomp_q31(&lc, test_buf, TEST_FRAMES);
+        CHECK(memcmp(test_buf, test_ref, sizeof(test_buf)) == 0);
+
+        /* Lower volume: bass lifted, the signal changes */
+        loudcomp_set_volume(&lc, 30);
+        CHECK(!loudcomp_is_flat(&lc));
+        loudcomp_shelf_gains(&lc, 30, &low_db, &high_db);
+        CHECK(low_db > 3.0f);
+        loudcomp_q31(&lc, test_buf, TEST_FRAMES);
+        CHECK(memcmp(test_buf, test_ref, sizeof(test_buf)) != 0);
+
+        /* Back to full volume: fades out, then passes bit-exact again */
+        loudcomp_set_volume(&lc, 100);
+        CHECK(!loudcomp_is_flat(&lc));
+        loudcomp_q31(&lc, test_buf, LOUDCOMP_FADE_FRAMES);
+        CHECK(loudcomp_is_flat(&lc));
+        memcpy(test_buf, test_ref, sizeof(test_buf));
+        loudcomp_q31(&lc, test_buf, TEST_FRAMES);
+        CHECK(memcmp(test_buf, test_ref, sizeof(test_buf)) == 0);
+    }
+
+    /* No table for the rate: flat, audio passes through */
+    CHECK(loudcomp_init(&lc, 22050) == LOUDCOMP_ERROR);
+    loudcomp_set_volume(&lc, 30);
+    memcpy(test_buf, test_ref, sizeof(test_buf));
+    loudcomp_q31(&lc, test_buf, TEST_FRAMES);
+    CHECK(memcmp(test_buf, test_ref, sizeof(test_buf)) == 0);
+}
+
+/* ============ Time stretch (WSOLA) ============ */
+
+#define TEST_STRETCH_IN (WSOLA_MAX_RATE)                    // 1 s
+#define TEST_STRETCH_OUT (TEST_STRETCH_IN * 100 / WSOLA_SPEED_MIN + WSOLA_MAX_RATE / 10)
+
+static int16_t test_stretch_in[TEST_STRETCH_IN * 2];
+static int16_t test_stretch_out[TEST_STRETCH_OUT * 2];
+
+/* Stretch 1 s of a 1 kHz tone at the player's block sizes; returns output frames */
+static uint32_t test_stretch(wsola_t* ws, uint32_t rate) {
+    uint32_t in = 0, out = 0;
+
+    for (uint32_t i = 0; i < rate; i++) {
+        int16_t v = (int16_t)lrint(16384.0 * sin(2.0 * M_PI * 1000.0 * i / rate));
+        test_stretch_in[2 * i] = test_stretch_in[2 * i + 1] = v;
+    }
+    while (in < rate && out + 1024 <= TEST_STRETCH_OUT) {
+        uint32_t n = (rate - in > 441) ? 441 : rate - in;
+        uint32_t consumed;
+        out += wsola_process(ws, &test_stretch_in[in * 2], n, &consumed,
+                             &test_stretch_out[out * 2], 1024);
+        in += consumed;
+    }
+    for (uint32_t n = 1; n > 0 && out < TEST_STRETCH_OUT; out += n) {
+        uint32_t room = TEST_STRETCH_OUT - out;
+        n = wsola_flush(ws, &test_stretch_out[out * 2], room > 1024 ? 1024 : room);
+    }
+    return out;
+}
+
+/* Tone frequency from the zero crossings of the left channel in [from, to) */
+static double test_tone_hz(const int16_t* buf, uint32_t from, uint32_t to, uint32_t rate) {
+    uint32_t crossings = 0, first = 0, last = 0;
+    for (uint32_t i = from + 1; i < to; i++) {
+        if ((buf[2 * (i - 1)] < 0) != (buf[2 * i] < 0)) {
+            if (crossings++ == 0) first = i;
+            last = i;
+        }
+    }
+    return (crossings > 1) ? (crossings - 1) * 0.5 * rate / (last - first) : 0.0;
+}
+
+static void test_wsola(void) {
+    static wsola_t ws;
+    static const uint32_t speeds[] = {WSOLA_SPEED_MIN, 150, WSOLA_SPEED_MAX};
+
+    for (uint32_t r = 0; r < 2; r++) {
+        uint32_t rate = test_rates[r];
+        for (uint32_t s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++) {
+            CHECK(wsola_init(&ws, rate, speeds[s]) == WSOLA_OK);
+            uint32_t out = test_stretch(&ws, rate);
+
+            /* Length: input / speed, give or take the sequence the flush pads */
+            double expect = (double)rate * 100.0 / speeds[s];
+            CHECK(fabs(out - expect) <= ws.sequence + ws.seek);
+
+            /* Pitch: still 1 kHz away from the start and the padded end */
+            double hz = test_tone_hz(test_stretch_out, 2 * ws.sequence,
+                                     (uint32_t)expect - 2 * ws.sequence, rate);
+            CHECK(fabs(hz - 1000.0) < 10.0);
+        }
+    }
+
+    /* Above WSOLA_MAX_RATE and outside the speed range: refused */
+    CHECK(wsola_init(&ws, 88200, 150) == WSOLA_ERROR);
+    CHECK(wsola_init(&ws, 44100, WSOLA_SPEED_MIN - 1) == WSOLA_ERROR);
+    CHECK(wsola_init(&ws, 44100, WSOLA_SPEED_MAX + 1) == WSOLA_ERROR);
+}
+
+int main(void) {
+    test_crossfeed();
+    test_limiter();
+    test_loudcomp();
+    test_wsola();
+
+    printf("dsp tests: %d checks, %d failed\n", checks_run, checks_failed);
+    return checks_failed ? 1 : 0;
+}
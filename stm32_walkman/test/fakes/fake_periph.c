@@ -0,0 +1,1051 @@
+/**
+ * Host Fake - Peripheral Models and Fault Injection
+ *
+ * Every READ_REG/WRITE_REG from a driver lands in fake_reg_read() or
+ * fake_reg_write(), which advance the model clock by one step, find the
+ * register block the address belongs to and apply its side effects.
+ * Registers without a model behave as plain memory.
+ */
+
+#include "fake_periph.h"
+#include <stdlib.h>
+#include <string.h>
+
+GPIO_TypeDef fake_gpio[9];
+SPI_TypeDef fake_spi[6];
+I2C_TypeDef fake_i2c[4];
+DMA_TypeDef fake_dma[2];
+DMA_Stream_TypeDef fake_dma_stream[2][8];
+RCC_TypeDef fake_rcc;
+EXTI_TypeDef fake_exti;
+SYSCFG_TypeDef fake_syscfg;
+FLASH_TypeDef fake_flash;
+uint32_t fake_flash_memory[1024 * 1024 / 4];
+
+/* ============ Interrupt vectors (weak: tests link only what they use) ============ */
+
+void DMA1_Stream5_IRQHandler(void) __attribute__((weak));
+void DMA1_Stream7_IRQHandler(void) __attribute__((weak));
+void EXTI0_IRQHandler(void) __attribute__((weak));
+void EXTI1_IRQHandler(void) __attribute__((weak));
+void EXTI2_IRQHandler(void) __attribute__((weak));
+void EXTI3_IRQHandler(void) __attribute__((weak));
+void EXTI4_IRQHandler(void) __attribute__((weak));
+void EXTI9_5_IRQHandler(void) __attribute__((weak));
+void EXTI15_10_IRQHandler(void) __attribute__((weak));
+
+static void (*const fake_vectors[FAKE_IRQ_COUNT])(void) = {
+    [EXTI0_IRQn] = EXTI0_IRQHandler,
+    [EXTI1_IRQn] = EXTI1_IRQHandler,
+    [EXTI2_IRQn] = EXTI2_IRQHandler,
+    [EXTI3_IRQn] = EXTI3_IRQHandler,
+    [EXTI4_IRQn] = EXTI4_IRQHandler,
+    [DMA1_Stream5_IRQn] = DMA1_Stream5_IRQHandler,
+    [DMA1_Stream7_IRQn] = DMA1_Stream7_IRQHandler,
+    [EXTI9_5_IRQn] = EXTI9_5_IRQHandler,
+    [EXTI15_10_IRQn] = EXTI15_10_IRQHandler,
+};
+
+static struct {
+    uint8_t enabled[FAKE_IRQ_COUNT];
+    uint8_t priority[FAKE_IRQ_COUNT];
+} nvic;
+
+static uint64_t fake_step_count;
+
+/* ============ Model state ============ */
+
+#define SPI_LOG_MAX     65536
+#define I2C_MAX_DEVICES 4
+#define MEM_MAX_WINDOWS 8
+
+typedef struct {
+    uint8_t shifting;          // Shift register holds a byte
+    uint8_t shift_byte;
+    uint32_t countdown;        // Steps until the byte is on the wire
+    uint8_t tx_full;           // TX buffer holds the next byte
+    uint8_t tx_byte;
+    uint8_t rx_byte;
+    uint8_t ovr_clear_armed;   // DR read seen, SR read clears OVR
+    uint32_t byte_steps;
+    fake_spi_responder_t responder;
+    uint8_t* log;
+    uint32_t sent;
+    uint32_t tx_overwrites;
+    uint32_t underruns;
+} spi_model_t;
+
+typedef enum {
+    I2C_IDLE = 0,
+    I2C_START,                 // START requested, SB pending
+    I2C_ADDRESS,               // SB set, waiting for the address byte
+    I2C_ADDRESS_OUT,           // Address byte on the wire
+    I2C_ADDRESSED,             // ADDR set, waiting for the SR2 read
+    I2C_TX,
+    I2C_TX_OUT,                // Data byte on the wire
+    I2C_RX_IN,                 // Data byte coming in
+    I2C_RX,                    // Waiting for the DR read
+    I2C_HALTED                 // NACK / error, waiting for STOP
+} i2c_phase_t;
+
+typedef struct {
+    i2c_phase_t phase;
+    uint32_t countdown;
+    uint8_t read;              // Direction of the current transfer
+    uint8_t out_byte;
+    uint8_t rx_byte;
+    uint32_t index;            // 0 = address, n = data byte
+    const fake_i2c_device_t* devices[I2C_MAX_DEVICES];
+    const fake_i2c_device_t* active;
+    uint8_t fault_armed;
+    fake_i2c_fault_t fault;
+    uint32_t fault_phase;
+    uint32_t stops;
+} i2c_model_t;
+
+typedef struct {
+    uint32_t initial_ndtr;
+    uint32_t item;             // Items done in the current pass
+    uint32_t stall;
+} dma_model_t;
+
+typedef struct {
+    const uint8_t* base;
+    size_t bytes;
+} mem_window_t;
+
+typedef struct {
+    uint8_t key_seen;          // KEY1 written, KEY2 expected
+    uint8_t key_fault;         // Bad unlock sequence: locked until reset
+    uint32_t countdown;        // Steps until BSY clears
+    int8_t erasing;            // Sector being erased, -1 if none
+    uint16_t protect;          // Write protected sectors (nWRP cleared)
+    uint32_t cut_after;        // Operations until the power cut, 0 = none
+    uint8_t powered_off;
+    uint32_t erases[FAKE_FLASH_SECTORS];
+} flash_model_t;
+
+static uint16_t gpio_driven[9];     // Pins driven from outside
+static uint16_t gpio_levels[9];     // Levels of the driven pins
+static spi_model_t spi_model[6];
+static i2c_model_t i2c_model[4];
+static dma_model_t dma_model[2][8];
+static flash_model_t flash_model;
+static mem_window_t mem_windows[MEM_MAX_WINDOWS];
+static uint32_t mem_window_count;
+
+#define I2C_PHASE_STEPS 3
+#define SPI_BYTE_STEPS  2
+#define FLASH_PROGRAM_STEPS 2
+#define FLASH_ERASE_STEPS   64
+
+/* ============ NVIC ============ */
+
+static void fake_irq_raise(IRQn_Type irq) {
+    if (irq < 0 || irq >= FAKE_IRQ_COUNT) return;
+    if (!nvic.enabled[irq] || fake_vectors[irq] == NULL) return;
+    fake_vectors[irq]();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+    if (irq >= 0 && irq < FAKE_IRQ_COUNT) nvic.enabled[irq] = 1;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+    if (irq >= 0 && irq < FAKE_IRQ_COUNT) nvic.enabled[irq] = 0;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    if (irq >= 0 && irq < FAKE_IRQ_COUNT) nvic.priority[irq] = priority;
+}
+
+uint8_t fake_nvic_enabled(IRQn_Type irq) {
+    return (irq >= 0 && irq < FAKE_IRQ_COUNT) ? nvic.enabled[irq] : 0;
+}
+
+uint32_t fake_nvic_priority(IRQn_Type irq) {
+    return (irq >= 0 && irq < FAKE_IRQ_COUNT) ? nvic.priority[irq] : 0;
+}
+
+/* ============ GPIO / EXTI ============ */
+
+static uint16_t gpio_input_levels(uint8_t port) {
+    GPIO_TypeDef* gpio = &fake_gpio[port];
+    uint16_t idr = 0;
+
+    for (uint8_t pin = 0; pin < 16; pin++) {
+        uint32_t mode = (gpio->MODER >> (pin * 2)) & 3;
+        uint32_t pull = (gpio->PUPDR >> (pin * 2)) & 3;
+        uint8_t level;
+
+        if (mode == 1) {
+            level = (gpio->ODR >> pin) & 1;          /* Output: reads back ODR */
+        } else if (gpio_driven[port] & (1u << pin)) {
+            level = (gpio_levels[port] >> pin) & 1;
+        } else {
+            level = (pull == 1);                     /* Pull-up reads high */
+        }
+        idr |= (uint16_t)level << pin;
+    }
+    return idr;
+}
+
+static IRQn_Type exti_irqn(uint8_t line) {
+    if (line < 5) return (IRQn_Type)(EXTI0_IRQn + line);
+    if (line < 10) return EXTI9_5_IRQn;
+    return EXTI15_10_IRQn;
+}
+
+static void exti_pend(uint8_t line) {
+    fake_exti.PR |= 1u << line;
+    if (fake_exti.IMR & (1u << line)) fake_irq_raise(exti_irqn(line));
+}
+
+static void gpio_update_inputs(uint8_t port) {
+    uint16_t before = (uint16_t)fake_gpio[port].IDR;
+    uint16_t after = gpio_input_levels(port);
+    uint16_t changed = before ^ after;
+
+    fake_gpio[port].IDR = after;
+
+    for (uint8_t line = 0; line < 16; line++) {
+        if (!(changed & (1u << line))) continue;
+        if (((fake_syscfg.EXTICR[line / 4] >> ((line % 4) * 4)) & 15) != port) continue;
+
+        uint8_t rising = (after >> line) & 1;
+        if ((rising && (fake_exti.RTSR & (1u << line))) ||
+            (!rising && (fake_exti.FTSR & (1u << line)))) {
+            exti_pend(line);
+        }
+    }
+}
+
+void fake_gpio_drive(uint8_t port, uint8_t pin, uint8_t level) {
+    if (port >= 9 || pin >= 16) return;
+    gpio_driven[port] |= 1u << pin;
+    if (level) {
+        gpio_levels[port] |= 1u << pin;
+    } else {
+        gpio_levels[port] &= ~(1u << pin);
+    }
+    gpio_update_inputs(port);
+}
+
+void fake_gpio_release(uint8_t port, uint8_t pin) {
+    if (port >= 9 || pin >= 16) return;
+    gpio_driven[port] &= ~(1u << pin);
+    gpio_update_inputs(port);
+}
+
+uint8_t fake_gpio_output(uint8_t port, uint8_t pin) {
+    if (port >= 9 || pin >= 16) return 0;
+    return (fake_gpio[port].ODR >> pin) & 1;
+}
+
+static void gpio_model_write(uint8_t port, size_t offset, volatile uint32_t* reg, uint32_t value) {
+    GPIO_TypeDef* gpio = &fake_gpio[port];
+
+    if (offset == offsetof(GPIO_TypeDef, BSRR)) {
+        gpio->ODR = (gpio->ODR & ~(value >> 16)) | (value & 0xFFFF);  /* Set wins */
+    } else if (offset == offsetof(GPIO_TypeDef, IDR)) {
+        return;                                      /* Read-only */
+    } else {
+        *reg = value;
+    }
+    gpio_update_inputs(port);
+}
+
+static uint32_t gpio_model_read(uint8_t port, size_t offset, volatile uint32_t* reg) {
+    if (offset == offsetof(GPIO_TypeDef, BSRR)) return 0;  /* Write-only */
+    if (offset == offsetof(GPIO_TypeDef, IDR)) gpio_update_inputs(port);
+    return *reg;
+}
+
+static void exti_model_write(size_t offset, volatile uint32_t* reg, uint32_t value) {
+    if (offset == offsetof(EXTI_TypeDef, PR)) {
+        fake_exti.PR &= ~value;                      /* rc_w1 */
+    } else if (offset == offsetof(EXTI_TypeDef, SWIER)) {
+        for (uint8_t line = 0; line < 16; line++) {
+            if (value & (1u << line)) exti_pend(line);
+        }
+    } else {
+        *reg = value;
+    }
+}
+
+/* ============ SPI ============ */
+
+static void spi_model_update_sr(uint8_t bus) {
+    spi_model_t* m = &spi_model[bus];
+    uint32_t sr = fake_spi[bus].SR & (SPI_SR_RXNE | SPI_SR_OVR | SPI_SR_UDR | SPI_SR_MODF);
+
+    if (!m->tx_full) sr |= SPI_SR_TXE;
+    if (m->shifting) sr |= SPI_SR_BSY;
+    fake_spi[bus].SR = sr;
+}
+
+static void spi_model_step(uint8_t bus) {
+    spi_model_t* m = &spi_model[bus];
+    if (!m->shifting || --m->countdown > 0) return;
+
+    /* Byte complete: MOSI logged, MISO lands in DR */
+    if (m->sent < SPI_LOG_MAX && m->log) m->log[m->sent] = m->shift_byte;
+    m->sent++;
+
+    if (fake_spi[bus].SR & SPI_SR_RXNE) fake_spi[bus].SR |= SPI_SR_OVR;
+    m->rx_byte = m->responder ? m->responder(bus, m->shift_byte) : 0xFF;
+    fake_spi[bus].SR |= SPI_SR_RXNE;
+
+    if (m->tx_full) {
+        m->shift_byte = m->tx_byte;
+        m->tx_full = 0;
+        m->countdown = m->byte_steps;
+    } else {
+        m->shifting = 0;
+    }
+    spi_model_update_sr(bus);
+}
+
+static void spi_model_write(uint8_t bus, size_t offset, volatile uint32_t* reg, uint32_t value) {
+    spi_model_t* m = &spi_model[bus];
+    SPI_TypeDef* spi = &fake_spi[bus];
+
+    if (offset == offsetof(SPI_TypeDef, DR)) {
+        if (!(spi->CR1 & SPI_CR1_SPE) || (spi->I2SCFGR & SPI_I2SCFGR_I2SMOD)) return;
+        uint8_t byte = (uint8_t)value;               /* DFF=0: low byte only */
+        if (!m->shifting) {
+            m->shifting = 1;
+            m->shift_byte = byte;
+            m->countdown = m->byte_steps;
+        } else {
+            if (m->tx_full) m->tx_overwrites++;
+            m->tx_full = 1;
+            m->tx_byte = byte;
+        }
+        spi_model_update_sr(bus);
+    } else if (offset == offsetof(SPI_TypeDef, SR)) {
+        /* Only the error flags are writable (rc_w0) */
+        spi->SR &= value | ~(uint32_t)(SPI_SR_UDR | SPI_SR_MODF);
+    } else {
+        *reg = value;
+    }
+}
+
+static uint32_t spi_model_read(uint8_t bus, size_t offset, volatile uint32_t* reg) {
+    spi_model_t* m = &spi_model[bus];
+    SPI_TypeDef* spi = &fake_spi[bus];
+
+    if (offset == offsetof(SPI_TypeDef, DR)) {
+        spi->SR &= ~SPI_SR_RXNE;
+        m->ovr_clear_armed = 1;
+        return m->rx_byte;
+    }
+    if (offset == offsetof(SPI_TypeDef, SR)) {
+        uint32_t sr = spi->SR;
+        if (m->ovr_clear_armed) {
+            spi->SR &= ~SPI_SR_OVR;
+            m->ovr_clear_armed = 0;
+        }
+        /* UDR is cleared by reading SR */
+        spi->SR &= ~SPI_SR_UDR;
+        return sr;
+    }
+    return *reg;
+}
+
+void fake_spi_set_responder(uint8_t bus, fake_spi_responder_t responder) {
+    if (bus < 6) spi_model[bus].responder = responder;
+}
+
+void fake_spi_set_byte_steps(uint8_t bus, uint32_t steps) {
+    if (bus < 6) spi_model[bus].byte_steps = steps ? steps : 1;
+}
+
+uint32_t fake_spi_sent(uint8_t bus, uint8_t* out, uint32_t max) {
+    if (bus >= 6) return 0;
+    spi_model_t* m = &spi_model[bus];
+    uint32_t n = m->sent < max ? m->sent : max;
+    if (n > SPI_LOG_MAX) n = SPI_LOG_MAX;
+    if (out && m->log) memcpy(out, m->log, n);
+    return m->sent;
+}
+
+uint32_t fake_spi_tx_overwrites(uint8_t bus) {
+    return bus < 6 ? spi_model[bus].tx_overwrites : 0;
+}
+
+/* ============ I2C ============ */
+
+static void i2c_model_release(uint8_t bus) {
+    i2c_model_t* m = &i2c_model[bus];
+    I2C_TypeDef* i2c = &fake_i2c[bus];
+
+    if (m->active && m->active->stop) m->active->stop(m->active->ctx);
+    m->active = NULL;
+    m->phase = I2C_IDLE;
+    m->countdown = 0;
+    if (m->fault_armed && m->fault == FAKE_I2C_STUCK) m->fault_armed = 0;  /* Slave lets go */
+    i2c->SR1 &= I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF;
+    i2c->SR2 = 0;
+}
+
+/* Returns 1 if an armed fault fires in the phase now completing */
+static uint8_t i2c_model_fault(uint8_t bus, fake_i2c_fault_t fault) {
+    i2c_model_t* m = &i2c_model[bus];
+    if (!m->fault_armed || m->fault != fault || m->fault_phase != m->index) return 0;
+    if (fault != FAKE_I2C_STUCK) m->fault_armed = 0;
+    return 1;
+}
+
+/* A phase finished on the wire: apply faults and the slave's answer */
+static void i2c_model_complete(uint8_t bus) {
+    i2c_model_t* m = &i2c_model[bus];
+    I2C_TypeDef* i2c = &fake_i2c[bus];
+
+    if (m->phase == I2C_START) {
+        i2c->CR1 &= ~I2C_CR1_START;
+        i2c->SR1 |= I2C_SR1_SB;
+        i2c->SR2 |= I2C_SR2_MSL | I2C_SR2_BUSY;
+        m->phase = I2C_ADDRESS;
+        m->index = 0;
+        return;
+    }
+    if (i2c_model_fault(bus, FAKE_I2C_STUCK)) {
+        m->countdown = 1;                            /* Never finishes */
+        return;
+    }
+    if (i2c_model_fault(bus, FAKE_I2C_BUS_ERROR)) {
+        i2c->SR1 |= I2C_SR1_BERR;
+        m->phase = I2C_HALTED;
+        return;
+    }
+    if (i2c_model_fault(bus, FAKE_I2C_ARB_LOST)) {
+        i2c->SR1 |= I2C_SR1_ARLO;
+        i2c->SR2 &= ~I2C_SR2_MSL;
+        m->phase = I2C_HALTED;
+        return;
+    }
+    uint8_t nack = i2c_model_fault(bus, FAKE_I2C_NACK);
+
+    switch (m->phase) {
+    case I2C_ADDRESS_OUT: {
+        uint8_t address = m->out_byte >> 1;
+        m->read = m->out_byte & 1;
+        m->active = NULL;
+        for (int i = 0; i < I2C_MAX_DEVICES; i++) {
+            if (m->devices[i] && m->devices[i]->address == address) {
+                m->active = m->devices[i];
+            }
+        }
+        if (m->active == NULL || nack) {
+            m->active = NULL;
+            i2c->SR1 |= I2C_SR1_AF;
+            m->phase = I2C_HALTED;
+            break;
+        }
+        if (m->active->start) m->active->start(m->active->ctx, m->read);
+        i2c->SR1 |= I2C_SR1_ADDR;
+        if (!m->read) i2c->SR2 |= I2C_SR2_TRA;
+        m->phase = I2C_ADDRESSED;
+        break;
+    }
+
+    case I2C_TX_OUT: {
+        uint8_t ack = !nack && (!m->active->write || m->active->write(m->active->ctx, m->out_byte));
+        if (!ack) {
+            i2c->SR1 |= I2C_SR1_AF;
+            m->phase = I2C_HALTED;
+            break;
+        }
+        i2c->SR1 |= I2C_SR1_TXE | I2C_SR1_BTF;
+        m->phase = I2C_TX;
+        break;
+    }
+
+    case I2C_RX_IN:
+        m->rx_byte = m->active->read ? m->active->read(m->active->ctx) : 0xFF;
+        i2c->SR1 |= I2C_SR1_RXNE;
+        m->phase = I2C_RX;
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void i2c_model_step(uint8_t bus) {
+    i2c_model_t* m = &i2c_model[bus];
+    if (m->countdown == 0 || --m->countdown > 0) return;
+    i2c_model_complete(bus);
+}
+
+static void i2c_model_schedule(uint8_t bus, i2c_phase_t phase) {
+    i2c_model[bus].phase = phase;
+    i2c_model[bus].countdown = I2C_PHASE_STEPS;
+}
+
+static void i2c_model_write(uint8_t bus, size_t offset, volatile uint32_t* reg, uint32_t value) {
+    i2c_model_t* m = &i2c_model[bus];
+    I2C_TypeDef* i2c = &fake_i2c[bus];
+
+    if (offset == offsetof(I2C_TypeDef, CR1)) {
+        uint32_t old = i2c->CR1;
+        i2c->CR1 = value;
+        if (!(value & I2C_CR1_PE)) {
+            i2c_model_release(bus);
+            i2c->SR1 = 0;
+            return;
+        }
+        if ((value & I2C_CR1_STOP) && !(old & I2C_CR1_STOP)) {
+            i2c->CR1 &= ~I2C_CR1_STOP;               /* Cleared once generated */
+            if (i2c->SR2 & I2C_SR2_BUSY) m->stops++;
+            i2c_model_release(bus);
+        }
+        if ((value & I2C_CR1_START) && !(old & I2C_CR1_START)) {
+            i2c_model_schedule(bus, I2C_START);
+        }
+    } else if (offset == offsetof(I2C_TypeDef, DR)) {
+        i2c->DR = value & 0xFF;
+        if (m->phase == I2C_ADDRESS && (i2c->SR1 & I2C_SR1_SB)) {
+            i2c->SR1 &= ~I2C_SR1_SB;
+            m->out_byte = (uint8_t)value;
+            i2c_model_schedule(bus, I2C_ADDRESS_OUT);
+        } else if (m->phase == I2C_TX) {
+            i2c->SR1 &= ~(I2C_SR1_TXE | I2C_SR1_BTF);
+            m->out_byte = (uint8_t)value;
+            m->index++;
+            i2c_model_schedule(bus, I2C_TX_OUT);
+        }
+    } else if (offset == offsetof(I2C_TypeDef, SR1)) {
+        /* Error flags are rc_w0, the rest is read-only */
+        uint32_t errors = I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF;
+        i2c->SR1 &= value | ~errors;
+    } else if (offset == offsetof(I2C_TypeDef, SR2)) {
+        return;
+    } else {
+        *reg = value;
+    }
+}
+
+static uint32_t i2c_model_read(uint8_t bus, size_t offset, volatile uint32_t* reg) {
+    i2c_model_t* m = &i2c_model[bus];
+    I2C_TypeDef* i2c = &fake_i2c[bus];
+
+    if (offset == offsetof(I2C_TypeDef, SR2)) {
+        uint32_t sr2 = i2c->SR2;
+        if (m->phase == I2C_ADDRESSED && (i2c->SR1 & I2C_SR1_ADDR)) {
+            /* SR1 then SR2 read clears ADDR and starts the data phase */
+            i2c->SR1 &= ~I2C_SR1_ADDR;
+            if (m->read) {
+                m->index++;
+                i2c_model_schedule(bus, I2C_RX_IN);
+            } else {
+                i2c->SR1 |= I2C_SR1_TXE;
+                m->phase = I2C_TX;
+            }
+        }
+        return sr2;
+    }
+    if (offset == offsetof(I2C_TypeDef, DR) && m->phase == I2C_RX) {
+        i2c->SR1 &= ~I2C_SR1_RXNE;
+        if (i2c->CR1 & I2C_CR1_ACK) {
+            m->index++;
+            i2c_model_schedule(bus, I2C_RX_IN);
+        } else {
+            m->phase = I2C_HALTED;                   /* NACKed, STOP next */
+        }
+        return m->rx_byte;
+    }
+    return *reg;
+}
+
+void fake_i2c_attach(uint8_t bus, const fake_i2c_device_t* device) {
+    if (bus >= 4) return;
+    for (int i = 0; i < I2C_MAX_DEVICES; i++) {
+        if (i2c_model[bus].devices[i] == NULL) {
+            i2c_model[bus].devices[i] = device;
+            return;
+        }
+    }
+}
+
+void fake_i2c_inject(uint8_t bus, fake_i2c_fault_t fault, uint32_t phase) {
+    if (bus >= 4) return;
+    i2c_model[bus].fault_armed = 1;
+    i2c_model[bus].fault = fault;
+    i2c_model[bus].fault_phase = phase;
+}
+
+uint32_t fake_i2c_stops(uint8_t bus) {
+    return bus < 4 ? i2c_model[bus].stops : 0;
+}
+
+static void i2c_mem_start(void* ctx, uint8_t read) {
+    fake_i2c_mem_t* mem = ctx;
+    if (!read) mem->pointer_set = 0;
+}
+
+static uint8_t i2c_mem_write(void* ctx, uint8_t byte) {
+    fake_i2c_mem_t* mem = ctx;
+    if (!mem->pointer_set) {
+        mem->pointer = byte;
+        mem->pointer_set = 1;
+    } else {
+        mem->regs[mem->pointer++] = byte;
+        mem->writes++;
+    }
+    return 1;
+}
+
+static uint8_t i2c_mem_read(void* ctx) {
+    fake_i2c_mem_t* mem = ctx;
+    return mem->regs[mem->pointer++];
+}
+
+void fake_i2c_mem_init(fake_i2c_mem_t* mem, uint8_t address) {
+    memset(mem, 0, sizeof(*mem));
+    mem->device.address = address;
+    mem->device.start = i2c_mem_start;
+    mem->device.write = i2c_mem_write;
+    mem->device.read = i2c_mem_read;
+    mem->device.ctx = mem;
+}
+
+/* ============ DMA ============ */
+
+static const IRQn_Type dma_irqn[2][8] = {
+    {11, 12, 13, 14, 15, 16, 17, 47},
+    {56, 57, 58, 59, 60, 68, 69, 70},
+};
+
+static volatile uint32_t* dma_model_isr(uint8_t dma, uint8_t stream) {
+    return stream < 4 ? &fake_dma[dma].LISR : &fake_dma[dma].HISR;
+}
+
+static uint32_t dma_model_flag_shift(uint8_t stream) {
+    static const uint8_t shift[4] = {0, 6, 16, 22};
+    return shift[stream % 4];
+}
+
+/* Flag offsets inside a stream's ISR field */
+#define DMA_FLAG_FE 0
+#define DMA_FLAG_TE 3
+#define DMA_FLAG_HT 4
+#define DMA_FLAG_TC 5
+
+static void dma_model_flag(uint8_t dma, uint8_t stream, uint32_t flag, uint32_t enable) {
+    *dma_model_isr(dma, stream) |= 1u << (dma_model_flag_shift(stream) + flag);
+    if (fake_dma_stream[dma][stream].CR & enable) fake_irq_raise(dma_irqn[dma][stream]);
+}
+
+static void dma_model_stream_write(uint8_t dma, uint8_t stream, size_t offset,
+                             volatile uint32_t* reg, uint32_t value) {
+    DMA_Stream_TypeDef* s = &fake_dma_stream[dma][stream];
+
+    if (offset == offsetof(DMA_Stream_TypeDef, CR)) {
+        if ((value & DMA_SxCR_EN) && !(s->CR & DMA_SxCR_EN)) {
+            dma_model[dma][stream].initial_ndtr = s->NDTR;
+            dma_model[dma][stream].item = 0;
+        }
+        s->CR = value;
+    } else if (s->CR & DMA_SxCR_EN) {
+        return;                                      /* Locked while enabled */
+    } else {
+        *reg = value;
+    }
+}
+
+static void dma_model_write(uint8_t dma, size_t offset, volatile uint32_t* reg, uint32_t value) {
+    if (offset == offsetof(DMA_TypeDef, LIFCR)) {
+        fake_dma[dma].LISR &= ~value;
+    } else if (offset == offsetof(DMA_TypeDef, HIFCR)) {
+        fake_dma[dma].HISR &= ~value;
+    } else if (offset == offsetof(DMA_TypeDef, LISR) || offset == offsetof(DMA_TypeDef, HISR)) {
+        return;                                      /* Read-only */
+    } else {
+        *reg = value;
+    }
+}
+
+static uint32_t dma_model_read(size_t offset, volatile uint32_t* reg) {
+    if (offset == offsetof(DMA_TypeDef, LIFCR) || offset == offsetof(DMA_TypeDef, HIFCR)) {
+        return 0;                                    /* Write-only */
+    }
+    return *reg;
+}
+
+static const uint8_t* mem_resolve(uint32_t address, uint32_t bytes) {
+    for (uint32_t i = 0; i < mem_window_count; i++) {
+        const uint8_t* base = mem_windows[i].base;
+        uint32_t low = (uint32_t)(uintptr_t)base;
+        if (address - low < mem_windows[i].bytes &&
+            address - low + bytes <= mem_windows[i].bytes) {
+            return base + (address - low);
+        }
+    }
+    return NULL;
+}
+
+void fake_mem_map(const void* base, size_t bytes) {
+    if (mem_window_count < MEM_MAX_WINDOWS) {
+        mem_windows[mem_window_count].base = base;
+        mem_windows[mem_window_count].bytes = bytes;
+        mem_window_count++;
+    }
+}
+
+void fake_dma_inject_error(uint8_t dma, uint8_t stream) {
+    if (dma >= 2 || stream >= 8) return;
+    fake_dma_stream[dma][stream].CR &= ~DMA_SxCR_EN;
+    dma_model_flag(dma, stream, DMA_FLAG_TE, DMA_SxCR_TEIE);
+}
+
+void fake_dma_inject_fifo_error(uint8_t dma, uint8_t stream) {
+    if (dma >= 2 || stream >= 8) return;
+    *dma_model_isr(dma, stream) |= 1u << (dma_model_flag_shift(stream) + DMA_FLAG_FE);
+    if (fake_dma_stream[dma][stream].FCR & DMA_SxFCR_FEIE) fake_irq_raise(dma_irqn[dma][stream]);
+}
+
+void fake_dma_stall(uint8_t dma, uint8_t stream, uint32_t requests) {
+    if (dma < 2 && stream < 8) dma_model[dma][stream].stall = requests;
+}
+
+/**
+ * Serve one peripheral request: move one item from memory, count NDTR
+ * down, raise HT/TC and reload in circular mode. Returns 0 if no item
+ * was delivered.
+ */
+static uint8_t dma_model_request(uint8_t dma, uint8_t stream, int16_t* item) {
+    DMA_Stream_TypeDef* s = &fake_dma_stream[dma][stream];
+    dma_model_t* m = &dma_model[dma][stream];
+
+    if (m->stall > 0) {
+        m->stall--;
+        return 0;
+    }
+
+    uint32_t msize = 1u << ((s->CR >> DMA_SxCR_MSIZE_Pos) & 3);
+    uint32_t offset = (s->CR & DMA_SxCR_MINC) ? m->item * msize : 0;
+    const uint8_t* src = mem_resolve(s->M0AR + offset, msize);
+    if (src == NULL) {
+        fake_dma_inject_error(dma, stream);          /* Bus error on the AHB */
+        return 0;
+    }
+
+    int16_t value = 0;
+    memcpy(&value, src, msize < 2 ? msize : 2);
+    *item = value;
+
+    m->item++;
+    s->NDTR--;
+    if (s->NDTR == m->initial_ndtr / 2) {
+        dma_model_flag(dma, stream, DMA_FLAG_HT, DMA_SxCR_HTIE);
+    }
+    if (s->NDTR == 0) {
+        if (s->CR & DMA_SxCR_CIRC) {
+            s->NDTR = m->initial_ndtr;
+            m->item = 0;
+        } else {
+            s->CR &= ~DMA_SxCR_EN;
+        }
+        dma_model_flag(dma, stream, DMA_FLAG_TC, DMA_SxCR_TCIE);
+    }
+    return 1;
+}
+
+/* ============ I2S ============ */
+
+uint32_t fake_i2s_clock(uint8_t bus, int16_t* out, uint32_t samples) {
+    if (bus >= 6) return 0;
+    SPI_TypeDef* spi = &fake_spi[bus];
+    uint32_t dr = (uint32_t)(uintptr_t)&spi->DR;
+    uint32_t delivered = 0;
+
+    for (uint32_t i = 0; i < samples; i++) {
+        uint32_t mode = SPI_I2SCFGR_I2SMOD | SPI_I2SCFGR_I2SE;
+        if ((spi->I2SCFGR & mode) != mode) break;    /* No bit clock */
+
+        int16_t sample = 0;
+        uint8_t served = 0;
+
+        if (spi->CR2 & SPI_CR2_TXDMAEN) {
+            for (uint8_t d = 0; d < 2 && !served; d++) {
+                for (uint8_t st = 0; st < 8; st++) {
+                    DMA_Stream_TypeDef* s = &fake_dma_stream[d][st];
+                    if ((s->CR & DMA_SxCR_EN) && s->PAR == dr) {
+                        served = dma_model_request(d, st, &sample);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (served) {
+            delivered++;
+        } else {
+            spi->SR |= SPI_SR_UDR;
+            spi_model[bus].underruns++;
+        }
+        if (out) out[i] = sample;
+    }
+    return delivered;
+}
+
+uint32_t fake_i2s_underruns(uint8_t bus) {
+    return bus < 6 ? spi_model[bus].underruns : 0;
+}
+
+/* ============ Flash ============ */
+
+static const uint16_t flash_sector_kb[FAKE_FLASH_SECTORS] = {
+    16, 16, 16, 16, 64, 128, 128, 128, 128, 128, 128, 128
+};
+
+static uint32_t flash_sector_offset(uint8_t sector) {
+    uint32_t offset = 0;
+    for (uint8_t i = 0; i < sector; i++) offset += flash_sector_kb[i] * 1024u;
+    return offset;
+}
+
+static uint8_t flash_sector_of(uint32_t offset) {
+    uint8_t sector = 0;
+    while (sector + 1 < FAKE_FLASH_SECTORS && offset >= flash_sector_offset(sector + 1)) sector++;
+    return sector;
+}
+
+/* Fill bytes of the array with the erased value */
+static void flash_model_blank(uint32_t offset, uint32_t bytes) {
+    memset((uint8_t*)fake_flash_memory + offset, 0xFF, bytes);
+}
+
+/* Count one program/erase operation; returns 1 if the power fails in it */
+static uint8_t flash_model_power_fails(void) {
+    if (flash_model.cut_after == 0) return 0;
+    if (--flash_model.cut_after > 0) return 0;
+    flash_model.powered_off = 1;
+    return 1;
+}
+
+static void flash_model_step(void) {
+    flash_model_t* m = &flash_model;
+    if (!(fake_flash.SR & FLASH_SR_BSY) || --m->countdown > 0) return;
+
+    if (m->erasing >= 0) {
+        flash_model_blank(flash_sector_offset(m->erasing), flash_sector_kb[m->erasing] * 1024u);
+        m->erases[m->erasing]++;
+        m->erasing = -1;
+    }
+    fake_flash.SR = (fake_flash.SR & ~FLASH_SR_BSY) | FLASH_SR_EOP;
+}
+
+static void flash_model_start_erase(uint8_t sector) {
+    flash_model_t* m = &flash_model;
+
+    if (m->protect & (1u << sector)) {
+        fake_flash.SR |= FLASH_SR_WRPERR;
+        return;
+    }
+    if (flash_model_power_fails()) {
+        /* Interrupted erase: part of the sector is blank, the rest is not */
+        flash_model_blank(flash_sector_offset(sector), flash_sector_kb[sector] * 512u);
+        return;
+    }
+    m->erasing = (int8_t)sector;
+    m->countdown = FLASH_ERASE_STEPS;
+    fake_flash.SR |= FLASH_SR_BSY;
+}
+
+static void flash_model_write(size_t offset, volatile uint32_t* reg, uint32_t value) {
+    flash_model_t* m = &flash_model;
+    uint32_t locked = fake_flash.CR & FLASH_CR_LOCK;
+
+    if (offset == offsetof(FLASH_TypeDef, KEYR)) {
+        if (!locked || m->key_fault) {
+            m->key_fault = 1;
+            fake_flash.CR |= FLASH_CR_LOCK;
+        } else if (!m->key_seen && value == 0x45670123u) {
+            m->key_seen = 1;
+        } else if (m->key_seen && value == 0xCDEF89ABu) {
+            m->key_seen = 0;
+            fake_flash.CR &= ~FLASH_CR_LOCK;
+        } else {
+            m->key_fault = 1;
+        }
+    } else if (offset == offsetof(FLASH_TypeDef, SR)) {
+        fake_flash.SR &= ~(value & (FLASH_SR_EOP | FLASH_SR_OPERR | FLASH_SR_WRPERR |
+                                    FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR));
+    } else if (offset == offsetof(FLASH_TypeDef, CR)) {
+        if (locked) return;                              /* Ignored while locked */
+        fake_flash.CR = value & ~FLASH_CR_STRT;
+        if ((value & FLASH_CR_STRT) && (value & FLASH_CR_SER) &&
+            !(fake_flash.SR & FLASH_SR_BSY)) {
+            flash_model_start_erase((value & FLASH_CR_SNB) >> FLASH_CR_SNB_Pos);
+        }
+    } else {
+        *reg = value;
+    }
+}
+
+/* Word write into the main array: programs when PG is set */
+static void flash_model_program(volatile uint32_t* word, uint32_t value) {
+    flash_model_t* m = &flash_model;
+    uint32_t cr = fake_flash.CR;
+    uint32_t offset = (uint32_t)((uintptr_t)word - (uintptr_t)fake_flash_memory);
+
+    if ((cr & FLASH_CR_LOCK) || !(cr & FLASH_CR_PG) || (cr & (FLASH_CR_SER | FLASH_CR_MER))) {
+        fake_flash.SR |= FLASH_SR_PGSERR;
+        return;
+    }
+    if (((cr & FLASH_CR_PSIZE) >> FLASH_CR_PSIZE_Pos) != 2) {
+        fake_flash.SR |= FLASH_SR_PGPERR;
+        return;
+    }
+    if (m->protect & (1u << flash_sector_of(offset))) {
+        fake_flash.SR |= FLASH_SR_WRPERR;
+        return;
+    }
+    if (flash_model_power_fails()) {
+        *word &= value | 0xFFFF0000u;                    /* Torn: low half only */
+        return;
+    }
+    *word &= value;                                      /* Bits only clear */
+    m->countdown = FLASH_PROGRAM_STEPS;
+    fake_flash.SR |= FLASH_SR_BSY;
+}
+
+void fake_flash_fill(uint8_t value) {
+    memset(fake_flash_memory, value, sizeof(fake_flash_memory));
+}
+
+void fake_flash_protect(uint16_t sectors) {
+    flash_model.protect = sectors;
+}
+
+void fake_flash_power_cut(uint32_t operations) {
+    flash_model.cut_after = operations;
+}
+
+uint8_t fake_flash_powered(void) {
+    return !flash_model.powered_off;
+}
+
+uint32_t fake_flash_erases(uint8_t sector) {
+    return sector < FAKE_FLASH_SECTORS ? flash_model.erases[sector] : 0;
+}
+
+/* ============ Register dispatch ============ */
+
+#define FAKE_IN(reg, block) \
+    ((uintptr_t)(reg) >= (uintptr_t)&(block) && \
+     (uintptr_t)(reg) < (uintptr_t)&(block) + sizeof(block))
+
+#define FAKE_INDEX(reg, array) \
+    (((uintptr_t)(reg) - (uintptr_t)(array)) / sizeof((array)[0]))
+
+#define FAKE_OFFSET(reg, element) ((size_t)((uintptr_t)(reg) - (uintptr_t)&(element)))
+
+static void fake_step(void) {
+    fake_step_count++;
+    for (uint8_t bus = 1; bus < 6; bus++) spi_model_step(bus);
+    for (uint8_t bus = 1; bus < 4; bus++) i2c_model_step(bus);
+    flash_model_step();
+}
+
+uint32_t fake_reg_read(volatile uint32_t* reg) {
+    fake_step();
+
+    if (FAKE_IN(reg, fake_spi)) {
+        uint8_t bus = FAKE_INDEX(reg, fake_spi);
+        return spi_model_read(bus, FAKE_OFFSET(reg, fake_spi[bus]), reg);
+    }
+    if (FAKE_IN(reg, fake_i2c)) {
+        uint8_t bus = FAKE_INDEX(reg, fake_i2c);
+        return i2c_model_read(bus, FAKE_OFFSET(reg, fake_i2c[bus]), reg);
+    }
+    if (FAKE_IN(reg, fake_gpio)) {
+        uint8_t port = FAKE_INDEX(reg, fake_gpio);
+        return gpio_model_read(port, FAKE_OFFSET(reg, fake_gpio[port]), reg);
+    }
+    if (FAKE_IN(reg, fake_dma)) {
+        uint8_t dma = FAKE_INDEX(reg, fake_dma);
+        return dma_model_read(FAKE_OFFSET(reg, fake_dma[dma]), reg);
+    }
+    return *reg;
+}
+
+void fake_reg_write(volatile uint32_t* reg, uint32_t value) {
+    fake_step();
+
+    /* Without power the flash interface takes no writes */
+    if (flash_model.powered_off && (FAKE_IN(reg, fake_flash) || FAKE_IN(reg, fake_flash_memory))) {
+        return;
+    }
+
+    if (FAKE_IN(reg, fake_spi)) {
+        uint8_t bus = FAKE_INDEX(reg, fake_spi);
+        spi_model_write(bus, FAKE_OFFSET(reg, fake_spi[bus]), reg, value);
+    } else if (FAKE_IN(reg, fake_i2c)) {
+        uint8_t bus = FAKE_INDEX(reg, fake_i2c);
+        i2c_model_write(bus, FAKE_OFFSET(reg, fake_i2c[bus]), reg, value);
+    } else if (FAKE_IN(reg, fake_gpio)) {
+        uint8_t port = FAKE_INDEX(reg, fake_gpio);
+        gpio_model_write(port, FAKE_OFFSET(reg, fake_gpio[port]), reg, value);
+    } else if (FAKE_IN(reg, fake_exti)) {
+        exti_model_write(FAKE_OFFSET(reg, fake_exti), reg, value);
+    } else if (FAKE_IN(reg, fake_dma_stream)) {
+        size_t index = FAKE_INDEX(reg, &fake_dma_stream[0][0]);
+        uint8_t dma = index / 8, stream = index % 8;
+        dma_model_stream_write(dma, stream, FAKE_OFFSET(reg, fake_dma_stream[dma][stream]), reg, value);
+    } else if (FAKE_IN(reg, fake_dma)) {
+        uint8_t dma = FAKE_INDEX(reg, fake_dma);
+        dma_model_write(dma, FAKE_OFFSET(reg, fake_dma[dma]), reg, value);
+    } else if (FAKE_IN(reg, fake_flash)) {
+        flash_model_write(FAKE_OFFSET(reg, fake_flash), reg, value);
+    } else if (FAKE_IN(reg, fake_flash_memory)) {
+        flash_model_program(reg, value);
+    } else {
+        *reg = value;
+    }
+}
+
+uint64_t fake_steps(void) {
+    return fake_step_count;
+}
+
+void fake_reset(void) {
+    static uint8_t spi_logs[6][SPI_LOG_MAX];
+
+    memset(fake_gpio, 0, sizeof(fake_gpio));
+    memset(fake_spi, 0, sizeof(fake_spi));
+    memset(fake_i2c, 0, sizeof(fake_i2c));
+    memset(fake_dma, 0, sizeof(fake_dma));
+    memset(fake_dma_stream, 0, sizeof(fake_dma_stream));
+    memset(&fake_rcc, 0, sizeof(fake_rcc));
+    memset(&fake_exti, 0, sizeof(fake_exti));
+    memset(&fake_syscfg, 0, sizeof(fake_syscfg));
+    memset(&nvic, 0, sizeof(nvic));
+    memset(gpio_driven, 0, sizeof(gpio_driven));
+    memset(gpio_levels, 0, sizeof(gpio_levels));
+    memset(spi_model, 0, sizeof(spi_model));
+    memset(i2c_model, 0, sizeof(i2c_model));
+    memset(dma_model, 0, sizeof(dma_model));
+    memset(&fake_flash, 0, sizeof(fake_flash));
+    memset(&flash_model, 0, sizeof(flash_model));
+    mem_window_count = 0;
+    fake_step_count = 0;
+
+    /* Reset values (RM0090): debug pins on PA13-15/PB3-4, SPI TXE */
+    fake_gpio[0].MODER = 0xA8000000;
+    fake_gpio[0].PUPDR = 0x64000000;
+    fake_gpio[1].MODER = 0x00000280;
+    fake_gpio[1].PUPDR = 0x00000100;
+    for (uint8_t port = 0; port < 9; port++) fake_gpio[port].IDR = gpio_input_levels(port);
+    fake_flash.CR = FLASH_CR_LOCK;
+    flash_model.erasing = -1;
+
+    for (uint8_t bus = 0; bus < 6; bus++) {
+        fake_spi[bus].SR = SPI_SR_TXE;
+        spi_model[bus].byte_steps = SPI_BYTE_STEPS;
+        spi_model[bus].log = spi_logs[bus];
+    }
+}
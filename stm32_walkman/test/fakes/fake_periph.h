@@ -0,0 +1,158 @@
+/**
+ * Host Fake - Peripheral Models and Fault Injection
+ *
+ * Behavioural models behind the fake register blocks of stm32f4xx.h.
+ * Time is counted in steps: every register access through the CMSIS
+ * macros is one step, so polling loops see flags change the way they do
+ * on the bus (an SPI byte takes a few SR reads, an I2C address phase a
+ * few more). Audio DMA is clocked explicitly by the test through
+ * fake_i2s_clock().
+ *
+ * Models:
+ * - GPIO:  ODR/BSRR outputs, IDR from externally driven levels and pulls
+ * - EXTI:  edge detection through SYSCFG routing, PR write-1-to-clear,
+ *          handler dispatch when the NVIC line is enabled
+ * - SPI:   TX buffer + shift register, TXE/BSY/RXNE sequencing, OVR,
+ *          MOSI capture and a MISO responder
+ * - I2C:   master START/address/data/STOP state machine against attached
+ *          slave devices with ACK/NACK
+ * - DMA:   NDTR countdown, circular reload, HT/TC/TE/FE flags and interrupts
+ * - I2S:   SPI in I2S mode pulling samples from its DMA stream, UDR on
+ *          underrun
+ * - Flash: KEYR unlock sequence, sector erase and word programming with
+ *          BSY/EOP/error flags over a 1 MB array; the array survives
+ *          fake_reset() like the real one survives a reset
+ *
+ * Faults: I2C NACK / bus error / arbitration loss / stuck clock at a chosen
+ * byte, DMA transfer and FIFO errors, DMA stalls (I2S underrun), slow SPI bus, flash
+ * write protection and power loss in the middle of a program or erase.
+ */
+
+#ifndef __FAKE_PERIPH_H
+#define __FAKE_PERIPH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+
+/* Put every register and model back into its reset state */
+void fake_reset(void);
+
+/* Register accesses so far (the model clock) */
+uint64_t fake_steps(void);
+
+/* ============ NVIC ============ */
+
+uint8_t fake_nvic_enabled(IRQn_Type irq);
+uint32_t fake_nvic_priority(IRQn_Type irq);
+
+/* ============ GPIO / EXTI ============ */
+
+/* Drive an input pin from outside; edges reach EXTI */
+void fake_gpio_drive(uint8_t port, uint8_t pin, uint8_t level);
+
+/* Release the pin (reads its pull-up/pull-down level again) */
+void fake_gpio_release(uint8_t port, uint8_t pin);
+
+/* Level the pin currently outputs (ODR) */
+uint8_t fake_gpio_output(uint8_t port, uint8_t pin);
+
+/* ============ SPI ============ */
+
+/* Returns the MISO byte clocked in while mosi is clocked out */
+typedef uint8_t (*fake_spi_responder_t)(uint8_t bus, uint8_t mosi);
+
+void fake_spi_set_responder(uint8_t bus, fake_spi_responder_t responder);
+
+/* Steps one byte takes on the wire (default 2) */
+void fake_spi_set_byte_steps(uint8_t bus, uint32_t steps);
+
+/* Bytes shifted out since reset; copies up to max into out */
+uint32_t fake_spi_sent(uint8_t bus, uint8_t* out, uint32_t max);
+
+/* DR writes that overwrote a full TX buffer (lost bytes) */
+uint32_t fake_spi_tx_overwrites(uint8_t bus);
+
+/* ============ I2C ============ */
+
+typedef struct {
+    uint8_t address;                          // 7-bit
+    void (*start)(void* ctx, uint8_t read);   // Addressed after (repeated) START
+    uint8_t (*write)(void* ctx, uint8_t byte);// Returns 1 = ACK, 0 = NACK
+    uint8_t (*read)(void* ctx);
+    void (*stop)(void* ctx);
+    void* ctx;
+} fake_i2c_device_t;
+
+/* Attach a slave (up to 4 per bus); the struct must outlive the test */
+void fake_i2c_attach(uint8_t bus, const fake_i2c_device_t* device);
+
+typedef enum {
+    FAKE_I2C_NACK = 0,      // Slave does not acknowledge
+    FAKE_I2C_BUS_ERROR,     // Misplaced START/STOP (BERR)
+    FAKE_I2C_ARB_LOST,      // Another master won (ARLO, MSL dropped)
+    FAKE_I2C_STUCK          // Slave holds SCL low, the phase never ends
+} fake_i2c_fault_t;
+
+/* One-shot fault at a phase of the next transfer: 0 = address byte,
+ * n = n-th data byte */
+void fake_i2c_inject(uint8_t bus, fake_i2c_fault_t fault, uint32_t phase);
+
+/* STOP conditions generated since reset */
+uint32_t fake_i2c_stops(uint8_t bus);
+
+/* Register-file slave: first written byte selects the register, further
+ * writes store and auto-increment, reads return from the pointer */
+typedef struct {
+    fake_i2c_device_t device;
+    uint8_t regs[256];
+    uint8_t pointer;
+    uint8_t pointer_set;
+    uint32_t writes;
+} fake_i2c_mem_t;
+
+void fake_i2c_mem_init(fake_i2c_mem_t* mem, uint8_t address);
+
+/* ============ DMA / I2S ============ */
+
+/* Memory the DMA may reach: M0AR holds 32 bits, so host buffers are
+ * registered and matched on their low address bits */
+void fake_mem_map(const void* base, size_t bytes);
+
+/* Clock an I2S transmitter for samples slots; each slot takes one item
+ * from the stream whose PAR points at the SPI DR. Missing items set UDR.
+ * Returns items delivered; out (optional) receives the samples. */
+uint32_t fake_i2s_clock(uint8_t bus, int16_t* out, uint32_t samples);
+
+/* Slots that found no data since reset */
+uint32_t fake_i2s_underruns(uint8_t bus);
+
+/* Transfer error on a stream: TEIF set, EN cleared by hardware */
+void fake_dma_inject_error(uint8_t dma, uint8_t stream);
+
+/* FIFO error flag on a stream (FEIF, interrupt if FEIE); the stream runs on */
+void fake_dma_inject_fifo_error(uint8_t dma, uint8_t stream);
+
+/* The next requests to a stream are not served (bus contention) */
+void fake_dma_stall(uint8_t dma, uint8_t stream, uint32_t requests);
+
+/* ============ Flash ============ */
+
+#define FAKE_FLASH_SECTORS 12
+
+/* Set every byte of the array (0xFF = factory erased) */
+void fake_flash_fill(uint8_t value);
+
+/* Write protect sectors (bit n = sector n): erase/program set WRPERR */
+void fake_flash_protect(uint16_t sectors);
+
+/* Power fails in the n-th program/erase operation from now: that word
+ * is half programmed (or the sector half erased) and the interface takes
+ * no further writes until fake_reset() */
+void fake_flash_power_cut(uint32_t operations);
+uint8_t fake_flash_powered(void);
+
+/* Completed erases of a sector since reset */
+uint32_t fake_flash_erases(uint8_t sector);
+
+#endif /* __FAKE_PERIPH_H */
@@ -0,0 +1,358 @@
+/**
+ * Host Fake - STM32F4xx Device Header
+ *
+ * Stands in for the CMSIS device header when the bare metal drivers are
+ * compiled for the host driver tests (make test-drivers). The register
+ * structs keep the CMSIS layout, but the peripheral instances are host
+ * arrays and the CMSIS access macros (READ_REG, WRITE_REG, SET_BIT, ...)
+ * call into the behavioural models in fake_periph.c. Drivers must therefore
+ * touch registers only through those macros.
+ *
+ * Only the registers and bit definitions used by src/gpio.c, spi.c, i2c.c,
+ * i2s.c, dma.c and flash.c are provided; values match RM0090. The flash main
+ * memory is a host array reached through FLASH_MEMORY_WORD().
+ */
+
+#ifndef __FAKE_STM32F4XX_H
+#define __FAKE_STM32F4XX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO volatile
+
+/* ============ Interrupt numbers ============ */
+
+typedef enum {
+    SysTick_IRQn       = -1,
+    EXTI0_IRQn         = 6,
+    EXTI1_IRQn         = 7,
+    EXTI2_IRQn         = 8,
+    EXTI3_IRQn         = 9,
+    EXTI4_IRQn         = 10,
+    DMA1_Stream0_IRQn  = 11,
+    DMA1_Stream1_IRQn  = 12,
+    DMA1_Stream2_IRQn  = 13,
+    DMA1_Stream3_IRQn  = 14,
+    DMA1_Stream4_IRQn  = 15,
+    DMA1_Stream5_IRQn  = 16,
+    DMA1_Stream6_IRQn  = 17,
+    EXTI9_5_IRQn       = 23,
+    EXTI15_10_IRQn     = 40,
+    DMA1_Stream7_IRQn  = 47,
+    DMA2_Stream0_IRQn  = 56,
+    DMA2_Stream1_IRQn  = 57,
+    DMA2_Stream2_IRQn  = 58,
+    DMA2_Stream3_IRQn  = 59,
+    DMA2_Stream4_IRQn  = 60,
+    DMA2_Stream5_IRQn  = 68,
+    DMA2_Stream6_IRQn  = 69,
+    DMA2_Stream7_IRQn  = 70,
+    FAKE_IRQ_COUNT     = 82
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+/* ============ Register blocks (CMSIS layout) ============ */
+
+typedef struct {
+    __IO uint32_t MODER;
+    __IO uint32_t OTYPER;
+    __IO uint32_t OSPEEDR;
+    __IO uint32_t PUPDR;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t LCKR;
+    __IO uint32_t AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t CRCPR;
+    __IO uint32_t RXCRCR;
+    __IO uint32_t TXCRCR;
+    __IO uint32_t I2SCFGR;
+    __IO uint32_t I2SPR;
+} SPI_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t OAR1;
+    __IO uint32_t OAR2;
+    __IO uint32_t DR;
+    __IO uint32_t SR1;
+    __IO uint32_t SR2;
+    __IO uint32_t CCR;
+    __IO uint32_t TRISE;
+    __IO uint32_t FLTR;
+} I2C_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t NDTR;
+    __IO uint32_t PAR;
+    __IO uint32_t M0AR;
+    __IO uint32_t M1AR;
+    __IO uint32_t FCR;
+} DMA_Stream_TypeDef;
+
+typedef struct {
+    __IO uint32_t LISR;
+    __IO uint32_t HISR;
+    __IO uint32_t LIFCR;
+    __IO uint32_t HIFCR;
+} DMA_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t PLLCFGR;
+    __IO uint32_t CFGR;
+    __IO uint32_t CIR;
+    __IO uint32_t AHB1RSTR;
+    __IO uint32_t AHB2RSTR;
+    __IO uint32_t AHB3RSTR;
+    uint32_t      RESERVED0;
+    __IO uint32_t APB1RSTR;
+    __IO uint32_t APB2RSTR;
+    uint32_t      RESERVED1[2];
+    __IO uint32_t AHB1ENR;
+    __IO uint32_t AHB2ENR;
+    __IO uint32_t AHB3ENR;
+    uint32_t      RESERVED2;
+    __IO uint32_t APB1ENR;
+    __IO uint32_t APB2ENR;
+} RCC_TypeDef;
+
+typedef struct {
+    __IO uint32_t IMR;
+    __IO uint32_t EMR;
+    __IO uint32_t RTSR;
+    __IO uint32_t FTSR;
+    __IO uint32_t SWIER;
+    __IO uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct {
+    __IO uint32_t MEMRMP;
+    __IO uint32_t PMC;
+    __IO uint32_t EXTICR[4];
+    uint32_t      RESERVED[2];
+    __IO uint32_t CMPCR;
+} SYSCFG_TypeDef;
+
+typedef struct {
+    __IO uint32_t ACR;
+    __IO uint32_t KEYR;
+    __IO uint32_t OPTKEYR;
+    __IO uint32_t SR;
+    __IO uint32_t CR;
+    __IO uint32_t OPTCR;
+    __IO uint32_t OPTCR1;
+} FLASH_TypeDef;
+
+/* ============ Instances (host memory, see fake_periph.c) ============ */
+
+extern GPIO_TypeDef fake_gpio[9];
+extern SPI_TypeDef fake_spi[6];              /* [1..5] = SPI1..SPI5 */
+extern I2C_TypeDef fake_i2c[4];              /* [1..3] = I2C1..I2C3 */
+extern DMA_TypeDef fake_dma[2];
+extern DMA_Stream_TypeDef fake_dma_stream[2][8];
+extern RCC_TypeDef fake_rcc;
+extern EXTI_TypeDef fake_exti;
+extern SYSCFG_TypeDef fake_syscfg;
+extern FLASH_TypeDef fake_flash;
+extern uint32_t fake_flash_memory[1024 * 1024 / 4];  /* 0x08000000, 1 MB */
+
+#define GPIOA           (&fake_gpio[0])
+#define GPIOB           (&fake_gpio[1])
+#define GPIOC           (&fake_gpio[2])
+#define GPIOD           (&fake_gpio[3])
+#define GPIOE           (&fake_gpio[4])
+#define GPIOF           (&fake_gpio[5])
+#define GPIOG           (&fake_gpio[6])
+#define GPIOH           (&fake_gpio[7])
+#define GPIOI           (&fake_gpio[8])
+#define SPI1            (&fake_spi[1])
+#define SPI2            (&fake_spi[2])
+#define SPI3            (&fake_spi[3])
+#define SPI4            (&fake_spi[4])
+#define SPI5            (&fake_spi[5])
+#define I2C1            (&fake_i2c[1])
+#define I2C2            (&fake_i2c[2])
+#define I2C3            (&fake_i2c[3])
+#define DMA1            (&fake_dma[0])
+#define DMA2            (&fake_dma[1])
+#define DMA1_Stream0    (&fake_dma_stream[0][0])
+#define DMA1_Stream1    (&fake_dma_stream[0][1])
+#define DMA1_Stream2    (&fake_dma_stream[0][2])
+#define DMA1_Stream3    (&fake_dma_stream[0][3])
+#define DMA1_Stream4    (&fake_dma_stream[0][4])
+#define DMA1_Stream5    (&fake_dma_stream[0][5])
+#define DMA1_Stream6    (&fake_dma_stream[0][6])
+#define DMA1_Stream7    (&fake_dma_stream[0][7])
+#define DMA2_Stream0    (&fake_dma_stream[1][0])
+#define DMA2_Stream1    (&fake_dma_stream[1][1])
+#define DMA2_Stream2    (&fake_dma_stream[1][2])
+#define DMA2_Stream3    (&fake_dma_stream[1][3])
+#define DMA2_Stream4    (&fake_dma_stream[1][4])
+#define DMA2_Stream5    (&fake_dma_stream[1][5])
+#define DMA2_Stream6    (&fake_dma_stream[1][6])
+#define DMA2_Stream7    (&fake_dma_stream[1][7])
+#define RCC             (&fake_rcc)
+#define EXTI            (&fake_exti)
+#define SYSCFG          (&fake_syscfg)
+#define FLASH           (&fake_flash)
+
+#define FLASH_MEMORY_WORD(address)  (fake_flash_memory[((address) - 0x08000000u) / 4])
+
+/* ============ Access macros (routed to the models) ============ */
+
+uint32_t fake_reg_read(volatile uint32_t* reg);
+void fake_reg_write(volatile uint32_t* reg, uint32_t value);
+
+#define READ_REG(REG)                       fake_reg_read(&(REG))
+#define WRITE_REG(REG, VAL)                 fake_reg_write(&(REG), (uint32_t)(VAL))
+#define READ_BIT(REG, BIT)                  (READ_REG(REG) & (BIT))
+#define SET_BIT(REG, BIT)                   WRITE_REG((REG), READ_REG(REG) | (BIT))
+#define CLEAR_BIT(REG, BIT)                 WRITE_REG((REG), READ_REG(REG) & ~(uint32_t)(BIT))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) \
+    WRITE_REG((REG), (READ_REG(REG) & ~(uint32_t)(CLEARMASK)) | (SETMASK))
+
+/* ============ RCC ============ */
+
+#define RCC_AHB1ENR_DMA1EN          (1u << 21)
+#define RCC_AHB1ENR_DMA2EN          (1u << 22)
+#define RCC_APB1ENR_SPI3EN          (1u << 15)
+#define RCC_APB1ENR_I2C1EN          (1u << 21)
+#define RCC_APB2ENR_SPI1EN          (1u << 12)
+#define RCC_APB2ENR_SYSCFGEN        (1u << 14)
+#define RCC_APB2ENR_SPI5EN          (1u << 20)
+
+/* ============ SPI / I2S ============ */
+
+#define SPI_CR1_CPHA                (1u << 0)
+#define SPI_CR1_CPOL                (1u << 1)
+#define SPI_CR1_MSTR                (1u << 2)
+#define SPI_CR1_BR_Pos              3
+#define SPI_CR1_SPE                 (1u << 6)
+#define SPI_CR1_LSBFIRST            (1u << 7)
+#define SPI_CR1_SSI                 (1u << 8)
+#define SPI_CR1_SSM                 (1u << 9)
+#define SPI_CR1_DFF                 (1u << 11)
+
+#define SPI_CR2_RXDMAEN             (1u << 0)
+#define SPI_CR2_TXDMAEN             (1u << 1)
+
+#define SPI_SR_RXNE                 (1u << 0)
+#define SPI_SR_TXE                  (1u << 1)
+#define SPI_SR_UDR                  (1u << 3)
+#define SPI_SR_MODF                 (1u << 5)
+#define SPI_SR_OVR                  (1u << 6)
+#define SPI_SR_BSY                  (1u << 7)
+
+#define SPI_I2SCFGR_CHLEN_Pos       0
+#define SPI_I2SCFGR_DATLEN_Pos      1
+#define SPI_I2SCFGR_CKPOL           (1u << 3)
+#define SPI_I2SCFGR_PCMSYNC         (1u << 7)
+#define SPI_I2SCFGR_I2SCFG_0        (1u << 8)
+#define SPI_I2SCFGR_I2SCFG_1        (1u << 9)
+#define SPI_I2SCFGR_I2SE            (1u << 10)
+#define SPI_I2SCFGR_I2SMOD          (1u << 11)
+
+#define SPI_I2SPR_I2SDIV_Pos        0
+#define SPI_I2SPR_ODD_Pos           8
+#define SPI_I2SPR_MCKOE             (1u << 9)
+
+/* ============ I2C ============ */
+
+#define I2C_CR1_PE                  (1u << 0)
+#define I2C_CR1_ENGC                (1u << 6)
+#define I2C_CR1_START               (1u << 8)
+#define I2C_CR1_STOP                (1u << 9)
+#define I2C_CR1_ACK                 (1u << 10)
+
+#define I2C_SR1_SB                  (1u << 0)
+#define I2C_SR1_ADDR                (1u << 1)
+#define I2C_SR1_BTF                 (1u << 2)
+#define I2C_SR1_RXNE                (1u << 6)
+#define I2C_SR1_TXE                 (1u << 7)
+#define I2C_SR1_BERR                (1u << 8)
+#define I2C_SR1_ARLO                (1u << 9)
+#define I2C_SR1_AF                  (1u << 10)
+
+#define I2C_SR2_MSL                 (1u << 0)
+#define I2C_SR2_BUSY                (1u << 1)
+#define I2C_SR2_TRA                 (1u << 2)
+
+/* ============ DMA ============ */
+
+#define DMA_SxCR_EN                 (1u << 0)
+#define DMA_SxCR_DMEIE              (1u << 1)
+#define DMA_SxCR_TEIE               (1u << 2)
+#define DMA_SxCR_HTIE               (1u << 3)
+#define DMA_SxCR_TCIE               (1u << 4)
+#define DMA_SxCR_PFCTRL             (1u << 5)
+#define DMA_SxCR_DIR_Pos            6
+#define DMA_SxCR_DIR_0              (1u << 6)
+#define DMA_SxCR_CIRC               (1u << 8)
+#define DMA_SxCR_PINC               (1u << 9)
+#define DMA_SxCR_MINC               (1u << 10)
+#define DMA_SxCR_PSIZE_Pos          11
+#define DMA_SxCR_MSIZE_Pos          13
+#define DMA_SxCR_PL_Pos             16
+#define DMA_SxCR_PL                 (3u << 16)
+#define DMA_SxCR_PBURST_Pos         21
+#define DMA_SxCR_PBURST             (3u << 21)
+#define DMA_SxCR_MBURST_Pos         23
+#define DMA_SxCR_MBURST             (3u << 23)
+#define DMA_SxCR_CHSEL_Pos          25
+#define DMA_SxCR_CHSEL              (7u << 25)
+
+#define DMA_SxFCR_FTH_Pos           0
+#define DMA_SxFCR_FTH               (3u << 0)
+#define DMA_SxFCR_DMDIS             (1u << 2)
+#define DMA_SxFCR_FEIE              (1u << 7)
+
+#define DMA_HISR_FEIF5              (1u << 6)
+#define DMA_HISR_DMEIF5             (1u << 8)
+#define DMA_HISR_TEIF5              (1u << 9)
+#define DMA_HISR_HTIF5              (1u << 10)
+#define DMA_HISR_TCIF5              (1u << 11)
+
+#define DMA_HIFCR_CFEIF5            (1u << 6)
+#define DMA_HIFCR_CDMEIF5           (1u << 8)
+#define DMA_HIFCR_CTEIF5            (1u << 9)
+#define DMA_HIFCR_CHTIF5            (1u << 10)
+#define DMA_HIFCR_CTCIF5            (1u << 11)
+
+/* ============ Flash interface ============ */
+
+#define FLASH_ACR_DCEN              (1u << 10)
+#define FLASH_ACR_DCRST             (1u << 12)
+
+#define FLASH_SR_EOP                (1u << 0)
+#define FLASH_SR_OPERR              (1u << 1)
+#define FLASH_SR_WRPERR             (1u << 4)
+#define FLASH_SR_PGAERR             (1u << 5)
+#define FLASH_SR_PGPERR             (1u << 6)
+#define FLASH_SR_PGSERR             (1u << 7)
+#define FLASH_SR_BSY                (1u << 16)
+
+#define FLASH_CR_PG                 (1u << 0)
+#define FLASH_CR_SER                (1u << 1)
+#define FLASH_CR_MER                (1u << 2)
+#define FLASH_CR_SNB_Pos            3
+#define FLASH_CR_SNB                (0x1Fu << 3)
+#define FLASH_CR_PSIZE_Pos          8
+#define FLASH_CR_PSIZE              (3u << 8)
+#define FLASH_CR_STRT               (1u << 16)
+#define FLASH_CR_LOCK               (1u << 31)
+
+#endif /* __FAKE_STM32F4XX_H */
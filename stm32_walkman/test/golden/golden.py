@@ -0,0 +1,577 @@
+#!/usr/bin/env python3
+"""
+Golden-output audio regression harness.
+
+Plays generated test vectors through the full player pipeline in the host
+simulation (decoder -> [SRC] -> PCM ring -> I2S DMA) and checks the PCM
+captured at the I2S output against goldens.json:
+
+- exact:     bit-exact paths. The capture must equal the expected PCM
+             (the source, mono duplicated to stereo) and its SHA-256 must
+             match the stored golden.
+- tolerance: fixed-point paths. SNR and THD of the captured test tone,
+             measured against an ideal float sinusoid, must meet the
+             stored thresholds.
+- transport: the test tone with pause, resume and scrubbing (seeks)
+             pressed during playback. The tone has to fade out at the
+             pause and no sample step may exceed the stored multiple of
+             the tone's steepest slope, so a cut waveform (a click) fails.
+- sfx:       a silent track with Volume+ tapped during playback. The key
+             click of every tap has to start within the stored latency of
+             its release, where the volume steps (measured against the
+             start of the track, which goes through the same button
+             debounce).
+
+Vectors with a "+fir" container also put a correction filter on the card
+(/correction.wav, a linear-phase lowpass with unity gain at the tone), so
+the tone goes through the partitioned convolver.
+
+Per-stage timing from the player profile (WALKMAN_SIM_STATS) is recorded
+with every result in the report.
+
+Usage: golden.py --sim build/sim/walkman_sim [--wnfpack build/tools/wnfpack]
+                 [--update] [--report FILE] [names...]
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+GOLDENS = os.path.join(HERE, "goldens.json")
+
+# name: (sample_rate, channels, seconds, signal, mode, container)
+# WNF vectors are packed from the generated WAV with tools/wnfpack; "+fir"
+# adds a correction filter of FIR_TAPS taps. DSD vectors hold the tone as
+# DSD64 (rate is the 44.1kHz PCM it decimates to).
+VECTORS = {
+    "pcm16_stereo_44k1": (44100, 2, 2.0, "multitone", "exact", "wav"),
+    "pcm16_mono_44k1":   (44100, 1, 1.5, "multitone", "exact", "wav"),
+    "pcm16_stereo_48k":  (48000, 2, 1.5, "multitone", "exact", "wav"),
+    "src_22k05_tone":    (22050, 2, 2.0, "tone", "tolerance", "wav"),
+    "src_32k_tone":      (32000, 2, 2.0, "tone", "tolerance", "wav"),
+    "wnf_pcm_44k1":      (44100, 2, 1.5, "multitone", "exact", "wnf-pcm"),
+    "wnf_adpcm_44k1":    (44100, 2, 2.0, "tone", "tolerance", "wnf-adpcm"),
+    "ima_adpcm_stereo":  (44100, 2, 2.0, "tone", "tolerance", "wav-ima"),
+    "ima_adpcm_mono":    (44100, 1, 2.0, "tone", "tolerance", "wav-ima"),
+    "ms_adpcm_stereo":   (44100, 2, 2.0, "tone", "tolerance", "wav-ms"),
+    "ms_adpcm_mono":     (44100, 1, 2.0, "tone", "tolerance", "wav-ms"),
+    "fir_tone_44k1":     (44100, 2, 2.0, "tone", "tolerance", "wav+fir"),
+    "dsd_dsf_stereo":    (44100, 2, 1.5, "tone", "tolerance", "dsf"),
+    "dsd_dff_mono":      (44100, 1, 1.5, "tone", "tolerance", "dff"),
+    "transport_44k1":    (44100, 2, 6.0, "tone", "transport", "wav"),
+    "transport_96k":     (96000, 2, 6.0, "tone", "transport", "wav"),
+    "sfx_click_44k1":    (44100, 2, 3.0, "silence", "sfx", "wav"),
+    "sfx_click_96k":     (96000, 2, 3.0, "silence", "sfx", "wav"),
+}
+
+# Button script of the transport vectors, ms after play: pause, resume,
+# then hold Next to scrub forward (a seek per snippet)
+TRANSPORT_SCRIPT = ((600, "tap play"), (900, "tap play"), (1300, "hold next 1300"))
+
+# Volume+ taps of the sfx vectors, ms after play: 300 ms apart, so they
+# walk through the DMA block phase but stay clear of the display refresh
+# (a tap during the LCD redraw is only polled after it)
+SFX_TAPS = (400, 700, 1000, 1300, 1600, 1900, 2200)
+TAP_MS = 80                     # Press to release of a tap (sim_script.c)
+
+ADPCM_BLOCK_ALIGN = 1024
+
+DSD_RATE = 2822400
+DSF_BLOCK = 4096
+
+FIR_TAPS = 2048
+FIR_CUTOFF_HZ = 8000.0
+
+BOOT_MS = 1000
+TONE_HZ = 997.0
+TONE_AMPLITUDE = 0.5
+
+
+# ============ Test vectors ============
+
+def generate(rate, channels, seconds, signal):
+    """Deterministic 16-bit PCM: a list of frames (tuples per channel)"""
+    frames = int(rate * seconds)
+    seed = 12345
+    out = []
+    for i in range(frames):
+        t = i / rate
+        if signal == "silence":
+            out.append((0,) * channels)
+            continue
+        if signal == "tone":
+            v = TONE_AMPLITUDE * math.sin(2 * math.pi * TONE_HZ * t)
+            s = int(round(v * 32767))
+            out.append((s,) * channels)
+            continue
+        # Two tones, LCG noise, and full-scale steps to exercise clipping edges
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF
+        noise = ((seed >> 8) & 0x3FF) - 512
+        left = 0.4 * math.sin(2 * math.pi * 440 * t) + 0.2 * math.sin(2 * math.pi * 6000 * t)
+        right = 0.5 * math.sin(2 * math.pi * 1000 * t + 1.0)
+        l = int(round(left * 32767)) + noise
+        r = int(round(right * 32767)) - noise
+        if (i // 4096) % 8 == 7:
+            l, r = (32767, -32768) if i & 1 else (-32768, 32767)
+        l = max(-32768, min(32767, l))
+        r = max(-32768, min(32767, r))
+        out.append((l, r)[:channels])
+    return out
+
+
+def write_wav(path, rate, channels, frames, container="wav"):
+    if container == "wav-ima":
+        fmt_tag, data, per_block = 0x11, ima_encode(frames, channels), ima_block_frames(channels)
+        extra = struct.pack("<HH", 2, per_block)
+    elif container == "wav-ms":
+        fmt_tag, data, per_block = 0x02, ms_encode(frames, channels), ms_block_frames(channels)
+        extra = struct.pack("<HHH", 32, per_block, len(MS_COEFS)) + \
+            b"".join(struct.pack("<hh", *c) for c in MS_COEFS)
+    else:
+        data = b"".join(struct.pack("<%dh" % channels, *f) for f in frames)
+        with open(path, "wb") as f:
+            f.write(b"RIFF" + struct.pack("<I", 36 + len(data)) + b"WAVE")
+            f.write(b"fmt " + struct.pack("<IHHIIHH", 16, 1, channels, rate,
+                                          rate * channels * 2, channels * 2, 16))
+            f.write(b"data" + struct.pack("<I", len(data)) + data)
+        return
+
+    fmt = struct.pack("<HHIIHH", fmt_tag, channels, rate,
+                      rate * ADPCM_BLOCK_ALIGN // per_block, ADPCM_BLOCK_ALIGN, 4) + extra
+    chunks = (b"fmt " + struct.pack("<I", len(fmt)) + fmt +
+              b"fact" + struct.pack("<II", 4, len(frames)) +
+              b"data" + struct.pack("<I", len(data)) + data)
+    with open(path, "wb") as f:
+        f.write(b"RIFF" + struct.pack("<I", 4 + len(chunks)) + b"WAVE" + chunks)
+
+
+def write_fir(path, rate):
+    """Blackman-windowed sinc lowpass as a stereo float32 WAV"""
+    fc = FIR_CUTOFF_HZ / rate
+    mid = (FIR_TAPS - 1) / 2
+    taps = []
+    for i in range(FIR_TAPS):
+        x = i - mid
+        sinc = 2 * fc if x == 0 else math.sin(2 * math.pi * fc * x) / (math.pi * x)
+        w = (0.42 - 0.5 * math.cos(2 * math.pi * i / (FIR_TAPS - 1)) +
+             0.08 * math.cos(4 * math.pi * i / (FIR_TAPS - 1)))
+        taps.append(sinc * w)
+    gain = sum(taps)
+    data = b"".join(struct.pack("<ff", t / gain, t / gain) for t in taps)
+    with open(path, "wb") as f:
+        f.write(b"RIFF" + struct.pack("<I", 36 + len(data)) + b"WAVE")
+        f.write(b"fmt " + struct.pack("<IHHIIHH", 16, 3, 2, rate, rate * 8, 8, 32))
+        f.write(b"data" + struct.pack("<I", len(data)) + data)
+
+
+def dsd_tone(frames):
+    """The test tone as DSD64 bytes (MSB first), 2nd-order sigma-delta"""
+    bits = frames * 64
+    step = 2 * math.pi * TONE_HZ / DSD_RATE
+    out = bytearray(bits // 8)
+    i1 = i2 = y = 0.0
+    for n in range(bits):
+        x = TONE_AMPLITUDE * math.sin(step * n)
+        i1 += x - y
+        i2 += i1 - y
+        y = 1.0 if i2 >= 0 else -1.0
+        if y > 0:
+            out[n >> 3] |= 0x80 >> (n & 7)
+    return bytes(out)
+
+
+def write_dsd(path, channels, frames, container):
+    tone = dsd_tone(len(frames))
+    if container == "dff":
+        data = bytes(b for b in tone for _ in range(channels))
+        prop = (b"SND " + b"FS  " + struct.pack(">QI", 4, DSD_RATE) +
+                b"CHNL" + struct.pack(">QH", 2 + 4 * channels, channels) +
+                (b"SLFTSRGT" if channels == 2 else b"C   ")[:4 * channels] +
+                b"CMPR" + struct.pack(">Q", 4) + b"DSD ")
+        body = (b"FVER" + struct.pack(">QI", 4, 0x01050000) +
+                b"PROP" + struct.pack(">Q", len(prop)) + prop +
+                b"DSD " + struct.pack(">Q", len(data)) + data)
+        with open(path, "wb") as f:
+            f.write(b"FRM8" + struct.pack(">Q", 4 + len(body)) + b"DSD " + body)
+        return
+
+    # DSF: per channel blocks, bits LSB first, last block zero padded
+    lsb = bytes(int("{:08b}".format(b)[::-1], 2) for b in tone)
+    groups = (len(lsb) + DSF_BLOCK - 1) // DSF_BLOCK
+    lsb += bytes(groups * DSF_BLOCK - len(lsb))
+    data = b"".join(lsb[g * DSF_BLOCK:(g + 1) * DSF_BLOCK] * channels for g in range(groups))
+    fmt = struct.pack("<4sQIIIIIIQII", b"fmt ", 52, 1, 0, channels, channels, DSD_RATE, 1,
+                      len(tone) * 8, DSF_BLOCK, 0)
+    with open(path, "wb") as f:
+        f.write(struct.pack("<4sQQQ", b"DSD ", 28, 28 + 52 + 12 + len(data), 0))
+        f.write(fmt + struct.pack("<4sQ", b"data", 12 + len(data)) + data)
+
+
+# ============ ADPCM encoders (WAV 0x0011 / 0x0002 block layout) ============
+
+IMA_STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767]
+IMA_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8] * 2
+MS_COEFS = [(256, 0), (512, -256), (0, 0), (192, 64), (240, 0), (460, -208), (392, -232)]
+MS_ADAPT = [230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230]
+
+
+def clamp16(v):
+    return max(-32768, min(32767, v))
+
+
+def ima_block_frames(channels):
+    return (ADPCM_BLOCK_ALIGN - 4 * channels) * 2 // channels + 1
+
+
+def ms_block_frames(channels):
+    return (ADPCM_BLOCK_ALIGN - 7 * channels) * 2 // channels + 2
+
+
+def blocks_of(frames, channels, per_block):
+    """Per block: one sample list per channel, the last block zero padded"""
+    for b in range(0, len(frames), per_block):
+        chunk = frames[b:b + per_block]
+        chunk += [(0,) * channels] * (per_block - len(chunk))
+        yield [[f[ch] for f in chunk] for ch in range(channels)]
+
+
+def ima_encode(frames, channels):
+    out = bytearray()
+    index = [0] * channels
+    for block in blocks_of(frames, channels, ima_block_frames(channels)):
+        nibbles = []
+        for ch, samples in enumerate(block):
+            pred = samples[0]
+            out += struct.pack("<hBB", pred, index[ch], 0)
+            codes = []
+            for x in samples[1:]:
+                step = IMA_STEPS[index[ch]]
+                diff, code = x - pred, 0
+                if diff < 0:
+                    code, diff = 8, -diff
+                if diff >= step:
+                    code |= 4; diff -= step
+                if diff >= step >> 1:
+                    code |= 2; diff -= step >> 1
+                if diff >= step >> 2:
+                    code |= 1
+                delta = (step >> 3) + (step if code & 4 else 0) + \
+                    (step >> 1 if code & 2 else 0) + (step >> 2 if code & 1 else 0)
+                pred = clamp16(pred - delta if code & 8 else pred + delta)
+                index[ch] = max(0, min(88, index[ch] + IMA_INDEX[code]))
+                codes.append(code)
+            nibbles.append(codes)
+        # 4-byte words of 8 nibbles, alternating channels, low nibble first
+        for w in range(0, len(nibbles[0]), 8):
+            for codes in nibbles:
+                group = codes[w:w + 8]
+                out += bytes(group[i] | (group[i + 1] << 4) for i in range(0, 8, 2))
+    return bytes(out)
+
+
+def ms_encode(frames, channels):
+    out = bytearray()
+    for block in blocks_of(frames, channels, ms_block_frames(channels)):
+        header = [], [], [], []
+        codes = []
+        for samples in block:
+            # Predictor with the smallest error over the block start
+            def cost(c):
+                return sum(abs(samples[i] - ((samples[i - 1] * c[0] + samples[i - 2] * c[1]) >> 8))
+                           for i in range(2, min(len(samples), 66)))
+            pred = min(range(len(MS_COEFS)), key=lambda k: cost(MS_COEFS[k]))
+            c1, c2 = MS_COEFS[pred]
+            s2, s1 = samples[0], samples[1]
+            delta = max(16, abs(samples[2] - ((s1 * c1 + s2 * c2) >> 8)) // 4)
+            header[0].append(pred); header[1].append(delta)
+            header[2].append(s1); header[3].append(s2)
+            ch_codes = []
+            for x in samples[2:]:
+                predict = (s1 * c1 + s2 * c2) >> 8
+                err = x - predict
+                code = max(-8, min(7, (err + (delta >> 1)) // delta if err >= 0
+                                   else -((-err + (delta >> 1)) // delta)))
+                s2, s1 = s1, clamp16(predict + code * delta)
+                delta = max(16, (MS_ADAPT[code & 15] * delta) >> 8)
+                ch_codes.append(code & 15)
+            codes.append(ch_codes)
+        out += bytes(header[0])
+        for field in header[1:]:
+            out += struct.pack("<%dh" % channels, *field)
+        if channels == 2:
+            out += bytes((l << 4) | r for l, r in zip(*codes))
+        else:
+            c = codes[0]
+            out += bytes((c[i] << 4) | c[i + 1] for i in range(0, len(c), 2))
+    return bytes(out)
+
+
+def read_wav(path):
+    with open(path, "rb") as f:
+        blob = f.read()
+    rate = struct.unpack_from("<I", blob, 24)[0]
+    data = blob[44:44 + struct.unpack_from("<I", blob, 40)[0]]
+    return rate, data
+
+
+# ============ Simulation ============
+
+def run_sim(sim, name, rate, channels, frames, container, wnfpack, workdir, mode):
+    sdcard = os.path.join(workdir, "sdcard")
+    os.makedirs(os.path.join(sdcard, "music"))
+    wav = os.path.join(sdcard, "music", name + ".wav")
+    if container in ("dsf", "dff"):
+        write_dsd(os.path.join(sdcard, "music", name + "." + container), channels, frames, container)
+    else:
+        write_wav(wav, rate, channels, frames, container)
+    if container.endswith("+fir"):
+        write_fir(os.path.join(sdcard, "correction.wav"), rate)
+    if container.startswith("wnf"):
+        if not wnfpack:
+            raise SystemExit("%s: --wnfpack is required for WNF vectors" % name)
+        subprocess.run([os.path.abspath(wnfpack), "-c", container[4:], wav,
+                        os.path.join(sdcard, "music", name + ".wnf")],
+                       check=True, stdout=subprocess.DEVNULL)
+        os.remove(wav)
+
+    # Press play once boot (LCD reset and clear) is done, quit after the track
+    run_ms = BOOT_MS + int(len(frames) * 1000 / rate) + 1000
+    script = os.path.join(workdir, "script.txt")
+    with open(script, "w") as f:
+        f.write("%d tap play\n" % BOOT_MS)
+        if mode == "transport":
+            for at, command in TRANSPORT_SCRIPT:
+                f.write("%d %s\n" % (BOOT_MS + at, command))
+        if mode == "sfx":
+            for at in SFX_TAPS:
+                f.write("%d tap volup\n" % (BOOT_MS + at))
+        f.write("%d quit\n" % run_ms)
+
+    env = dict(os.environ,
+               WALKMAN_SIM_SDCARD=sdcard,
+               WALKMAN_SIM_SCRIPT=script,
+               WALKMAN_SIM_WAV=os.path.join(workdir, "capture.wav"),
+               WALKMAN_SIM_LCD=os.path.join(workdir, "lcd.ppm"),
+               WALKMAN_SIM_STATS=os.path.join(workdir, "stats.json"),
+               WALKMAN_SIM_DURATION_MS=str(run_ms + 1000))
+    subprocess.run([os.path.abspath(sim)], cwd=workdir, env=env, check=True,
+                   stdout=subprocess.DEVNULL)
+
+    out_rate, pcm = read_wav(env["WALKMAN_SIM_WAV"])
+    with open(env["WALKMAN_SIM_STATS"]) as f:
+        stats = json.load(f)
+    return out_rate, pcm, stats
+
+
+# ============ Checks ============
+
+def check_exact(frames, channels, pcm, golden):
+    expected = b"".join(struct.pack("<hh", f[0], f[-1]) for f in frames)
+    head, tail = pcm[:len(expected)], pcm[len(expected):]
+    digest = hashlib.sha256(head).hexdigest()
+    result = {"sha256": digest}
+
+    if head != expected:
+        mismatch = next(i for i in range(0, min(len(head), len(expected)), 4)
+                        if head[i:i + 4] != expected[i:i + 4]) // 4 \
+            if len(head) == len(expected) else len(head) // 4
+        result["error"] = "capture differs from source at frame %d" % mismatch
+    elif tail.strip(b"\0"):
+        result["error"] = "non-silent output after end of track"
+    elif golden and golden.get("sha256") != digest:
+        result["error"] = "sha256 differs from golden"
+    return result
+
+
+def tone_metrics(samples, rate, freq):
+    """SNR and THD (dB) of a sinusoid
+
+    The fundamental is fitted by least squares; harmonics 2-5 are fitted on
+    the residual so leakage of the fundamental does not count as distortion.
+    """
+    def fit(x, f):
+        w = 2 * math.pi * f / rate
+        c = s = cc = ss = cs = 0.0
+        for i, v in enumerate(x):
+            cw, sw = math.cos(w * i), math.sin(w * i)
+            c += v * cw; s += v * sw
+            cc += cw * cw; ss += sw * sw; cs += cw * sw
+        det = cc * ss - cs * cs
+        a = (c * ss - s * cs) / det
+        b = (s * cc - c * cs) / det
+        model = [a * math.cos(w * i) + b * math.sin(w * i) for i in range(len(x))]
+        return math.hypot(a, b), model
+
+    amplitude, fundamental = fit(samples, freq)
+    residual = [x - m for x, m in zip(samples, fundamental)]
+    signal = sum(m * m for m in fundamental)
+    noise = sum(r * r for r in residual)
+
+    harmonics = 0.0
+    for k in range(2, 6):
+        if freq * k >= rate / 2:
+            break
+        _, model = fit(residual, freq * k)
+        harmonics += sum(m * m for m in model)
+
+    snr = 10 * math.log10(signal / max(noise, 1e-9))
+    thd = 10 * math.log10(max(harmonics, 1e-9) / signal)
+    return snr, thd, amplitude / 32767
+
+
+def check_tolerance(out_rate, pcm, seconds, golden):
+    count = len(pcm) // 4
+    left = struct.unpack_from("<%dh" % (count * 2), pcm)[0::2]
+    # Skip filter start-up and the tail; analyse 0.5 s from the middle
+    start = int(out_rate * 0.25)
+    window = left[start:start + int(out_rate * 0.5)]
+    snr, thd, amplitude = tone_metrics(window, out_rate, TONE_HZ)
+    result = {"snr_db": round(snr, 2), "thd_db": round(thd, 2),
+              "amplitude": round(amplitude, 4)}
+
+    expected_frames = int(seconds * out_rate)
+    if count < expected_frames - 64:
+        result["error"] = "capture too short (%d < %d frames)" % (count, expected_frames)
+    elif golden:
+        if snr < golden["snr_min_db"]:
+            result["error"] = "SNR %.1f dB below %.1f dB" % (snr, golden["snr_min_db"])
+        elif thd > golden["thd_max_db"]:
+            result["error"] = "THD %.1f dB above %.1f dB" % (thd, golden["thd_max_db"])
+        elif abs(amplitude - TONE_AMPLITUDE) > golden.get("amplitude_tol", 0.01):
+            result["error"] = "amplitude %.4f, expected %.2f" % (amplitude, TONE_AMPLITUDE)
+    return result
+
+
+def check_transport(out_rate, pcm, stats, golden):
+    count = len(pcm) // 4
+    left = struct.unpack_from("<%dh" % (count * 2), pcm)[0::2]
+    slope = 2 * math.sin(math.pi * TONE_HZ / out_rate) * TONE_AMPLITUDE * 32767
+    steps = [abs(b - a) for a, b in zip(left, left[1:])]
+    worst = max(range(len(steps)), key=steps.__getitem__)
+    ratio = steps[worst] / slope
+    seeks = next(s["calls"] for s in stats["stages"] if s["name"] == "seek")
+    result = {"step_ratio": round(ratio, 3), "seeks": seeks}
+
+    # A halted DMA emits nothing, so the capture runs on across the pause;
+    # ramped, the tone dies away before the gap and comes back after it.
+    # The envelope (peak over 0.5 ms) has to fall below a tenth of the tone
+    # in the first half (the second ends in the end-of-track silence).
+    half = max(1, out_rate // 4000)
+    peaks = [max(abs(v) for v in left[i:i + half]) for i in range(0, count // 2 - half, half)]
+    envelope = min(max(a, b) for a, b in zip(peaks, peaks[1:]))
+    if envelope > TONE_AMPLITUDE * 32767 / 10:
+        result["error"] = "the tone does not fade at the pause"
+    elif seeks == 0:
+        result["error"] = "no seek during the capture"
+    elif golden and ratio > golden["step_ratio_max"]:
+        result["error"] = "step of %d at frame %d, %.2f x the tone's slope" % (
+            steps[worst], worst + 1, ratio)
+    return result
+
+
+def check_sfx(out_rate, pcm, golden):
+    count = len(pcm) // 4
+    left = struct.unpack_from("<%dh" % (count * 2), pcm)[0::2]
+    onsets = [i for i in range(count) if left[i] and (i == 0 or not left[i - 1])]
+    latency = []
+    for at in SFX_TAPS:
+        start = (at + TAP_MS) * out_rate // 1000
+        first = next((i for i in onsets if i >= start), None)
+        if first is None:
+            break
+        latency.append((first - start) * 1000.0 / out_rate)
+    result = {"latency_ms": [round(v, 2) for v in latency]}
+
+    if len(latency) < len(SFX_TAPS):
+        result["error"] = "%d of %d clicks found" % (len(latency), len(SFX_TAPS))
+    elif golden and max(latency) > golden["latency_max_ms"]:
+        result["error"] = "click %.1f ms after the tap" % max(latency)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--sim", required=True, help="walkman_sim binary")
+    parser.add_argument("--wnfpack", help="WNF packer (tools/wnfpack) for the WNF vectors")
+    parser.add_argument("--update", action="store_true",
+                        help="rewrite exact-mode hashes in goldens.json")
+    parser.add_argument("--report", help="write JSON report (results and stage timing)")
+    parser.add_argument("names", nargs="*", help="vectors to run (default: all)")
+    args = parser.parse_args()
+
+    with open(GOLDENS) as f:
+        goldens = json.load(f)
+
+    names = args.names or list(VECTORS)
+    report = {}
+    failures = 0
+
+    for name in names:
+        rate, channels, seconds, signal, mode, container = VECTORS[name]
+        frames = generate(rate, channels, seconds, signal)
+        workdir = tempfile.mkdtemp(prefix="golden_")
+        try:
+            out_rate, pcm, stats = run_sim(args.sim, name, rate, channels, frames,
+                                            container, args.wnfpack, workdir, mode)
+        finally:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+        golden = goldens.get(name)
+        if mode == "exact":
+            result = check_exact(frames, channels, pcm, None if args.update else golden)
+            if args.update and "error" not in result:
+                goldens[name] = {"mode": "exact", "sha256": result["sha256"]}
+        elif mode == "transport":
+            result = check_transport(out_rate, pcm, stats, golden)
+        elif mode == "sfx":
+            result = check_sfx(out_rate, pcm, golden)
+        else:
+            result = check_tolerance(out_rate, pcm, seconds, golden)
+
+        result.update(mode=mode, output_rate=out_rate, underruns=stats["underruns"],
+                      stages={s["name"]: s for s in stats["stages"] if s["calls"]})
+        report[name] = result
+
+        status = "FAIL" if "error" in result else "ok"
+        failures += status == "FAIL"
+        detail = result.get("error") or (
+            "sha256 %s" % result["sha256"][:16] if mode == "exact" else
+            "max step %.2f x slope, %d seeks" % (result["step_ratio"], result["seeks"])
+            if mode == "transport" else
+            "click latency %.1f ms max" % max(result["latency_ms"])
+            if mode == "sfx" else
+            "SNR %.1f dB, THD %.1f dB" % (result["snr_db"], result["thd_db"]))
+        timing = ", ".join("%s %.1f ns/frame" % (k, v["per_frame"])
+                           for k, v in result["stages"].items())
+        print("%-20s %-9s %-4s %s  [%s]" % (name, mode, status, detail, timing))
+
+    if args.update:
+        with open(GOLDENS, "w") as f:
+            json.dump(goldens, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Updated %s" % GOLDENS)
+
+    if args.report:
+        with open(args.report, "w") as f:
+            json.dump(report, f, indent=2)
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
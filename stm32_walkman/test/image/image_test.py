@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""
+Card image builder test.
+
+Builds a small card tree (tracks in nested album folders, a long non-ASCII
+name, a stale index and a non-audio file), runs wmimage on it and reads the
+image back with an independent FAT32 reader:
+
+- volume: MBR partition at 4 MiB, FAT32 boot sector, cluster 2 on a
+  cluster boundary of the card, both FATs equal
+- files: every file of the tree present under its long name with the same
+  bytes, each in one contiguous run of clusters
+- layout: the index first, then the tracks back to back in index order
+- index: the embedded LIBRARY.IDX is what wmindex writes for the tree
+
+Usage: image_test.py --wmimage build/tools/wmimage --wmindex build/tools/wmindex
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+SECTOR = 512
+
+
+def write_wav(path, frames, rate, seed):
+    samples = [(i * 13 + seed) % 20000 - 10000 for i in range(frames * 2)]
+    data = struct.pack(f"<{len(samples)}h", *samples)
+    fmt = struct.pack("<4sIHHIIHH", b"fmt ", 16, 1, 2, rate, rate * 4, 4, 16)
+    body = b"WAVE" + fmt + b"data" + struct.pack("<I", len(data)) + data
+    with open(path, "wb") as f:
+        f.write(b"RIFF" + struct.pack("<I", len(body)) + body)
+
+
+class Fat32:
+    """Just enough FAT32 to list a tree and follow chains."""
+
+    def __init__(self, path):
+        self.f = open(path, "rb")
+        mbr = self.read(0, SECTOR)
+        assert mbr[510:512] == b"\x55\xaa", "no MBR signature"
+        kind, self.part, self.part_sectors = struct.unpack_from("<4xB3xII", mbr, 446)
+        assert kind == 0x0C, f"partition type {kind:#x}"
+        bs = self.read(self.part * SECTOR, SECTOR)
+        (self.bps, self.spc, self.reserved, self.nfats) = struct.unpack_from("<HBHB", bs, 11)
+        (self.fat_sectors,) = struct.unpack_from("<I", bs, 36)
+        (self.root,) = struct.unpack_from("<I", bs, 44)
+        self.fs_type = bs[82:90]
+        self.data = self.part + self.reserved + self.nfats * self.fat_sectors
+        fat_bytes = self.fat_sectors * SECTOR
+        fat_at = (self.part + self.reserved) * SECTOR
+        self.fat_raw = self.read(fat_at, fat_bytes)
+        self.fat_copy = self.read(fat_at + fat_bytes, fat_bytes)
+        self.fat = struct.unpack(f"<{fat_bytes // 4}I", self.fat_raw)
+        self.cluster_bytes = self.spc * SECTOR
+
+    def read(self, offset, size):
+        self.f.seek(offset)
+        return self.f.read(size)
+
+    def chain(self, first):
+        out = []
+        c = first
+        while 2 <= c < 0x0FFFFFF8:
+            out.append(c)
+            c = self.fat[c] & 0x0FFFFFFF
+        return out
+
+    def cluster_data(self, chain):
+        return b"".join(self.read((self.data + (c - 2) * self.spc) * SECTOR, self.cluster_bytes)
+                        for c in chain)
+
+    def entries(self, first):
+        raw = self.cluster_data(self.chain(first))
+        lfn = {}
+        for i in range(0, len(raw), 32):
+            e = raw[i:i + 32]
+            if e[0] == 0:
+                break
+            if e[11] == 0x0F:
+                part = e[1:11] + e[14:26] + e[28:32]
+                lfn[e[0] & 0x1F] = part
+                continue
+            name = e[0:11]
+            if e[11] & 0x08 or name in (b".          ", b"..         "):
+                lfn = {}
+                continue
+            if lfn:
+                units = b"".join(lfn[k] for k in sorted(lfn))
+                text = units.decode("utf-16-le")
+                long_name = text.split("\0")[0]
+            else:
+                base, ext = name[:8].decode().rstrip(), name[8:].decode().rstrip()
+                long_name = base + ("." + ext if ext else "")
+            lfn = {}
+            hi, lo = struct.unpack_from("<H", e, 20)[0], struct.unpack_from("<H", e, 26)[0]
+            size = struct.unpack_from("<I", e, 28)[0]
+            yield long_name, bool(e[11] & 0x10), hi << 16 | lo, size
+
+    def walk(self, first=None, prefix=""):
+        for name, is_dir, cluster, size in self.entries(first or self.root):
+            path = prefix + "/" + name
+            if is_dir:
+                yield from self.walk(cluster, path)
+            else:
+                yield path, cluster, size
+
+
+def check(cond, what, failures):
+    print(f"  {'ok  ' if cond else 'FAIL'} {what}")
+    if not cond:
+        failures.append(what)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--wmimage", required=True)
+    parser.add_argument("--wmindex", required=True)
+    args = parser.parse_args()
+
+    failures = []
+    with tempfile.TemporaryDirectory() as tmp:
+        card = os.path.join(tmp, "card")
+        albums = [("Artist A/First Album", 3), ("Artist A/Second", 2), ("Brass Band – Live", 2)]
+        tracks = []
+        for album, count in albums:
+            os.makedirs(os.path.join(card, "music", album))
+            for n in range(count):
+                name = f"{n + 1:02d} Track number {n + 1} with a long name.wav"
+                path = os.path.join(card, "music", album, name)
+                write_wav(path, 3000 + 1700 * n + len(album) * 50, 44100, n + len(album))
+                tracks.append(path)
+        write_wav(os.path.join(card, "music", "SINGLE.WAV"), 2500, 22050, 7)
+        with open(os.path.join(card, "music", "LIBRARY.IDX"), "wb") as f:
+            f.write(b"stale")
+        with open(os.path.join(card, "readme.txt"), "w") as f:
+            f.write("not audio\n")
+
+        image = os.path.join(tmp, "card.img")
+        report = os.path.join(tmp, "layout.txt")
+        result = subprocess.run([args.wmimage, "-s", "64M", "-r", report, card, image],
+                                capture_output=True, text=True)
+        print(result.stdout, end="")
+        check(result.returncode == 0, "wmimage ran", failures)
+        if result.returncode != 0:
+            print(result.stderr)
+            print(f"image test: {len(failures)} failed")
+            return 1
+
+        fs = Fat32(image)
+        print("volume:")
+        check(fs.part == 8192 and fs.fs_type == b"FAT32   ", "FAT32 partition at 4 MiB", failures)
+        check(fs.data % fs.spc == 0, f"cluster 2 at sector {fs.data}, {fs.cluster_bytes} B aligned",
+              failures)
+        check(fs.fat_raw == fs.fat_copy, "both FATs equal", failures)
+
+        print("files:")
+        files = {path: (cluster, size) for path, cluster, size in fs.walk()}
+        expected = {}
+        for top, _, names in os.walk(card):
+            for name in names:
+                host = os.path.join(top, name)
+                expected["/" + os.path.relpath(host, card)] = host
+        del expected["/music/LIBRARY.IDX"]
+        check(set(files) == set(expected) | {"/music/LIBRARY.IDX"},
+              f"{len(files)} files under their long names", failures)
+
+        contiguous = True
+        same = True
+        for path, (cluster, size) in files.items():
+            chain = fs.chain(cluster)
+            contiguous &= chain == list(range(cluster, cluster + len(chain)))
+            if path in expected:
+                with open(expected[path], "rb") as f:
+                    same &= fs.cluster_data(chain)[:size] == f.read()
+        check(contiguous, "every file one contiguous run", failures)
+        check(same, "file contents match the tree", failures)
+
+        print("index and layout:")
+        ref = os.path.join(tmp, "ref.idx")
+        subprocess.run([args.wmindex, "-o", ref, card], check=True, capture_output=True)
+        cluster, size = files["/music/LIBRARY.IDX"]
+        with open(ref, "rb") as f:
+            index = f.read()
+        check(fs.cluster_data(fs.chain(cluster))[:size] == index, "LIBRARY.IDX as wmindex writes it",
+              failures)
+
+        count, strings_offset = struct.unpack_from("<I", index, 8)[0], struct.unpack_from("<I", index, 12)[0]
+        order = []
+        for i in range(count):
+            path_offset = struct.unpack_from("<I", index, 32 + 40 * i)[0]
+            start = strings_offset + path_offset
+            order.append(index[start:index.index(b"\0", start)].decode())
+        check(count == len(tracks) + 1, f"{count} tracks indexed", failures)
+
+        at = cluster + len(fs.chain(cluster))
+        back_to_back = True
+        for path in order:
+            first, _ = files[path]
+            back_to_back &= first == at
+            at = first + len(fs.chain(first))
+        check(back_to_back, "tracks back to back after the index, in index order", failures)
+
+        with open(report) as f:
+            rows = [line for line in f if not line.startswith("#")]
+        check(len(rows) == count, "report row per track", failures)
+
+    print(f"image test: {len(failures)} failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
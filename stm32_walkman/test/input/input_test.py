@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+Button input service test.
+
+Creates a simulated GPIO chip with the kernel's gpio-sim (configfs), runs
+walkmand with file output and wminput on the simulated lines, drives the
+lines through the sim's pull attribute and checks what subscribers see:
+
+- glitch: a 5 ms pulse is debounced away, no event
+- short press: "pressed" then "released"
+- long press: a 1.2 s hold adds "long" about 1 s after the press
+
+Needs root and gpio-sim (CONFIG_GPIO_SIM); prints "skipped" and passes
+when either is missing.
+
+Usage: input_test.py --daemon build/linux/walkmand --wminput build/linux/wminput
+"""
+
+import argparse
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+CONFIGFS = "/sys/kernel/config"
+SIM = "wminput-test"
+NAMES = ["prev", "play_pause", "next", "vol_up", "vol_down", "shuffle", "loop"]
+
+
+def write(path, value):
+    with open(path, "w") as f:
+        f.write(value)
+
+
+class GpioSim:
+    """One gpio-sim chip with a single bank of len(NAMES) lines."""
+
+    def __init__(self):
+        if not os.path.isdir(CONFIGFS + "/gpio-sim"):
+            subprocess.run(["modprobe", "gpio-sim"], capture_output=True)
+            if not os.path.ismount(CONFIGFS):
+                subprocess.run(["mount", "-t", "configfs", "none", CONFIGFS], capture_output=True)
+        self.root = f"{CONFIGFS}/gpio-sim/{SIM}"
+        os.mkdir(self.root)
+        os.mkdir(self.root + "/gpio-bank0")
+        write(self.root + "/gpio-bank0/num_lines", str(len(NAMES)))
+        write(self.root + "/live", "1")
+        with open(self.root + "/dev_name") as f:
+            dev = f.read().strip()
+        with open(self.root + "/gpio-bank0/chip_name") as f:
+            self.chip = f.read().strip()
+        self.lines = f"/sys/devices/platform/{dev}/{self.chip}"
+        for line in range(len(NAMES)):
+            self.press(line, False)                 # Lines come up pulled down
+
+    def press(self, line, down):
+        # Buttons pull to ground: pressed is low
+        write(f"{self.lines}/sim_gpio{line}/pull", "pull-down" if down else "pull-up")
+
+    def close(self):
+        write(self.root + "/live", "0")
+        os.rmdir(self.root + "/gpio-bank0")
+        os.rmdir(self.root)
+
+
+def check(cond, what, failures):
+    print(f"  {'ok  ' if cond else 'FAIL'} {what}")
+    if not cond:
+        failures.append(what)
+
+
+def events(sock, seconds):
+    """Button events (with arrival time) seen within seconds."""
+    out = []
+    end = time.monotonic() + seconds
+    buf = b""
+    while (left := end - time.monotonic()) > 0:
+        sock.settimeout(left)
+        try:
+            data = sock.recv(4096)
+        except socket.timeout:
+            break
+        if not data:
+            break
+        buf += data
+        while b"\n" in buf:
+            line, buf = buf.split(b"\n", 1)
+            if line.startswith(b"event button "):
+                out.append((time.monotonic(), line.decode().split()[2:]))
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--daemon", required=True)
+    parser.add_argument("--wminput", required=True)
+    args = parser.parse_args()
+
+    try:
+        sim = GpioSim()
+    except OSError as e:
+        print(f"input test: skipped (no gpio-sim: {e.strerror})")
+        return 0
+
+    failures = []
+    procs = []
+    try:
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "walkmand.sock")
+            procs.append(subprocess.Popen([args.daemon, "-s", path, "-D", "file:" + os.path.join(tmp, "out.wav")],
+                                          stdout=subprocess.DEVNULL))
+            sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            for _ in range(50):
+                try:
+                    sock.connect(path)
+                    break
+                except OSError:
+                    time.sleep(0.05)
+            sock.sendall(b"subscribe\n")
+
+            mapping = ",".join(f"{name}={i}" for i, name in enumerate(NAMES))
+            procs.append(subprocess.Popen([args.wminput, "-c", "/dev/" + sim.chip, "-s", path, "-m", mapping]))
+            time.sleep(0.5)
+            events(sock, 0.1)                        # The "ok" for subscribe
+            play = NAMES.index("play_pause")
+
+            print("debounce:")
+            sim.press(play, True)
+            time.sleep(0.005)
+            sim.press(play, False)
+            seen = events(sock, 0.3)
+            check(seen == [], f"5 ms glitch ignored ({len(seen)} events)", failures)
+
+            print("short press:")
+            sim.press(play, True)
+            time.sleep(0.2)
+            sim.press(play, False)
+            seen = [e for _, e in events(sock, 0.3)]
+            check(seen == [["play_pause", "pressed"], ["play_pause", "released"]],
+                  f"pressed, released: {seen}", failures)
+
+            print("long press:")
+            start = time.monotonic()
+            sim.press(play, True)
+            time.sleep(1.2)
+            sim.press(play, False)
+            seen = events(sock, 0.3)
+            check([e for _, e in seen] == [["play_pause", "pressed"], ["play_pause", "long"],
+                                           ["play_pause", "released"]],
+                  f"pressed, long, released: {[e for _, e in seen]}", failures)
+            if len(seen) == 3:
+                held = seen[1][0] - start
+                check(0.95 <= held <= 1.15, f"long press after {held * 1000:.0f} ms", failures)
+            sock.close()
+    finally:
+        for proc in reversed(procs):
+            proc.terminate()
+            proc.wait(timeout=5)
+        sim.close()
+
+    print(f"input test: {len(failures)} failed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
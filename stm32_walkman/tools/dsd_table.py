@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Generate the DSD decimation filter tables (src/dsp/dsd_table.c).
+
+DSD64 (2.8224 MHz, 1 bit) comes down to 44.1 kHz in four stages:
+
+    /8  64-tap FIR run as byte lookups: the output for a byte position is
+        the sum of DSD_FIR_BYTES table entries, one per input byte, each
+        entry the filter's taps over that byte's 8 bits as +-1
+    /2  half-band, 352.8 -> 176.4 kHz
+    /2  half-band, 176.4 -> 88.2 kHz
+    /2  half-band, 88.2 -> 44.1 kHz (passband 20 kHz)
+
+All filters are Kaiser-windowed sincs. Every stage keeps its aliases into
+0-20 kHz 100 dB down; the passband is flat to 0.02 dB. Table entries are
+Q28 (the byte FIR, +-1 bits at DC gain 1 leave room for its overshoot),
+half-band taps Q31 (one side of the odd taps; the centre is 0.5).
+
+Usage: dsd_table.py <output.c>
+"""
+
+import math
+import sys
+
+DSD_RATE = 2822400
+FIR_TAPS = 64                       # 8 bytes
+FIR_CUTOFF_HZ = 150000.0
+FIR_BETA = 12.0
+HALFBANDS = [                       # (side taps, Kaiser beta)
+    ("hb1", 6, 10.5),
+    ("hb2", 7, 10.0),
+    ("hb3", 35, 10.06),
+]
+
+
+def i0(x):
+    total = term = 1.0
+    k = 1
+    while term > 1e-12 * total:
+        term *= (x / (2 * k)) ** 2
+        total += term
+        k += 1
+    return total
+
+
+def lowpass(n, cutoff, beta):
+    """Kaiser-windowed sinc, cutoff as a fraction of the rate, DC gain 1"""
+    mid = (n - 1) / 2
+    h = []
+    for i in range(n):
+        x = i - mid
+        sinc = 2 * cutoff if x == 0 else math.sin(2 * math.pi * cutoff * x) / (math.pi * x)
+        h.append(sinc * i0(beta * math.sqrt(1 - (2 * i / (n - 1) - 1) ** 2)) / i0(beta))
+    gain = sum(h)
+    return [v / gain for v in h]
+
+
+def fixed(v, bits):
+    scaled = round(v * (1 << bits))
+    if not -(1 << 31) <= scaled < (1 << 31):
+        raise SystemExit("coefficient %f does not fit Q%d" % (v, bits))
+    return scaled
+
+
+def rows(values, per_line, indent="    "):
+    return [indent + ", ".join(str(v) for v in values[i:i + per_line]) + ","
+            for i in range(0, len(values), per_line)]
+
+
+def main():
+    if len(sys.argv) != 2:
+        raise SystemExit(__doc__)
+
+    fir = lowpass(FIR_TAPS, FIR_CUTOFF_HZ / DSD_RATE, FIR_BETA)
+
+    out = ["/**",
+           " * DSD to PCM - Filter Tables",
+           " * Generated by tools/dsd_table.py (make dsd-table), do not edit",
+           " */",
+           "",
+           '#include "dsd.h"',
+           "",
+           "/* Byte j back (0 = newest), bits MSB first: sum of +-taps in Q28 */",
+           "const int32_t dsd_fir_table[DSD_FIR_BYTES][256] = {"]
+    for j in range(FIR_TAPS // 8):
+        entries = []
+        for byte in range(256):
+            # MSB is the oldest bit of the byte: age 8j + 7 - p for bit p (MSB = 0)
+            v = sum(fir[8 * j + 7 - p] * (1 if byte & (0x80 >> p) else -1) for p in range(8))
+            entries.append(fixed(v, 28))
+        out.append("    {")
+        out += rows(entries, 8, "        ")
+        out.append("    },")
+    out.append("};")
+    out.append("")
+
+    for name, taps, beta in HALFBANDS:
+        h = lowpass(4 * taps - 1, 0.25, beta)
+        centre = 2 * taps - 1
+        side = [fixed(h[centre - (2 * i + 1)], 31) for i in range(taps)]
+        out.append("/* Half-band %s: %d taps, Kaiser beta %.2f */" % (name[2:], 4 * taps - 1, beta))
+        out.append("const int32_t dsd_%s[DSD_%s_TAPS] = {" % (name, name.upper()))
+        out += rows(side, 6)
+        out.append("};")
+        out.append("")
+
+    out.append("/* DSF stores bits LSB first */")
+    out.append("const uint8_t dsd_bit_reverse[256] = {")
+    out += rows([int("{:08b}".format(b)[::-1], 2) for b in range(256)], 16)
+    out.append("};")
+
+    with open(sys.argv[1], "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Generate the loudness compensation coefficient table (src/dsp/loudcomp_table.c).
+
+For every volume step and codec sample rate, a low and a high shelf
+(the RBJ formulas of dsp_biquad_design(), Q2.30) restore what the
+ISO 226:2003 equal-loudness contours lose against the reference level:
+
+    boost(f) = (Lp(f, L) - Lp(f, REF)) - (L - REF)
+
+with L the listening level at that volume. The attenuation follows
+codec_set_volume(): volume v selects output volume code
+v * CODEC_VOLUME_CODE_MAX / 100 at 1 dB per code, so v plays
+CODEC_VOLUME_CODE_MAX - code dB below the reference; codes below
+CODEC_VOLUME_CODE_MUTE are muted and get the lowest contour. Both
+constants are read from src/audio/codec.h. The low shelf gain is the boost at 50 Hz, the high
+shelf gain the boost at 10 kHz; both are clamped so the coefficients fit
+Q2.30.
+
+Usage: loudcomp_table.py <output.c>
+"""
+
+import math
+import os
+import re
+import sys
+
+RATES = [44100, 48000, 96000]       # codec_sample_rate_t
+STEPS = 21                          # Volume 0, 5, ..., 100
+REF_PHON = 83.0                     # Level at volume 100
+MIN_PHON = 20.0                     # Contours are not defined much lower
+CODEC_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "audio", "codec.h")
+
+LOW_HZ, LOW_AT_HZ, LOW_MAX_DB = 120.0, 50.0, 15.0
+HIGH_HZ, HIGH_AT_HZ, HIGH_MAX_DB = 8000.0, 10000.0, 4.0
+SHELF_Q = 0.7071
+
+# ISO 226:2003 table 1: frequency, exponent af, transfer magnitude Lu, threshold Tf
+ISO226 = [
+    (20, 0.532, -31.6, 78.5), (25, 0.506, -27.2, 68.7), (31.5, 0.480, -23.0, 59.5),
+    (40, 0.455, -19.1, 51.1), (50, 0.432, -15.9, 44.0), (63, 0.409, -13.0, 37.5),
+    (80, 0.387, -10.3, 31.5), (100, 0.367, -8.1, 26.5), (125, 0.349, -6.2, 22.1),
+    (160, 0.330, -4.5, 17.9), (200, 0.315, -3.1, 14.4), (250, 0.301, -2.0, 11.4),
+    (315, 0.288, -1.1, 8.6), (400, 0.276, -0.4, 6.2), (500, 0.267, 0.0, 4.4),
+    (630, 0.259, 0.3, 3.0), (800, 0.253, 0.5, 2.2), (1000, 0.250, 0.0, 2.4),
+    (1250, 0.246, -2.7, 3.5), (1600, 0.244, -4.1, 1.7), (2000, 0.243, -1.0, -1.3),
+    (2500, 0.243, 1.7, -4.2), (3150, 0.243, 2.5, -6.0), (4000, 0.242, 1.2, -5.4),
+    (5000, 0.242, -2.1, -1.5), (6300, 0.245, -7.1, 6.0), (8000, 0.254, -11.2, 12.6),
+    (10000, 0.271, -10.7, 13.9), (12500, 0.301, -3.1, 12.3),
+]
+
+
+def spl(freq, phon):
+    """Sound pressure level (dB) that sounds as loud as phon at freq"""
+    _, af, lu, tf = next(row for row in ISO226 if row[0] == freq)
+    a = 4.47e-3 * (10 ** (0.025 * phon) - 1.15) + (0.4 * 10 ** ((tf + lu) / 10 - 9)) ** af
+    return 10 / af * math.log10(a) - lu + 94
+
+
+def boost(freq, phon):
+    return (spl(freq, phon) - spl(freq, REF_PHON)) - (phon - REF_PHON)
+
+
+def q30(v):
+    scaled = round(v * (1 << 30))
+    if not -(1 << 31) <= scaled < (1 << 31):
+        raise SystemExit("coefficient %f does not fit Q2.30" % v)
+    return scaled
+
+
+def shelf(high, rate, freq, gain_db):
+    """RBJ shelf as in dsp_biquad_design(): (b0, b1, b2, a1, a2) in Q2.30"""
+    A = 10 ** (gain_db / 40)
+    w0 = 2 * math.pi * freq / rate
+    cw = math.cos(w0)
+    sa = 2 * math.sqrt(A) * math.sin(w0) / (2 * SHELF_Q)
+    s = -1 if high else 1
+    b0 = A * ((A + 1) - s * (A - 1) * cw + sa)
+    b1 = s * 2 * A * ((A - 1) - s * (A + 1) * cw)
+    b2 = A * ((A + 1) - s * (A - 1) * cw - sa)
+    a0 = (A + 1) + s * (A - 1) * cw + sa
+    a1 = -s * 2 * ((A - 1) + s * (A + 1) * cw)
+    a2 = (A + 1) + s * (A - 1) * cw - sa
+    return [q30(c / a0) for c in (b0, b1, b2, a1, a2)]
+
+
+def codec_define(name):
+    with open(CODEC_H) as f:
+        match = re.search(r"#define\s+%s\s+(\w+)" % name, f.read())
+    if not match:
+        raise SystemExit("%s not found in %s" % (name, CODEC_H))
+    return int(match.group(1), 0)
+
+
+def listening_phon(volume, code_max, code_mute):
+    """Level at volume, as codec_volume_code() sets the output"""
+    code = volume * code_max // 100
+    if code < code_mute:
+        return MIN_PHON
+    return max(REF_PHON - (code_max - code), MIN_PHON)
+
+
+def main():
+    if len(sys.argv) != 2:
+        raise SystemExit(__doc__)
+
+    code_max = codec_define("CODEC_VOLUME_CODE_MAX")
+    code_mute = codec_define("CODEC_VOLUME_CODE_MUTE")
+    gains = []
+    for step in range(STEPS):
+        phon = listening_phon(step * 5, code_max, code_mute)
+        low = min(max(boost(LOW_AT_HZ, phon), 0.0), LOW_MAX_DB)
+        high = min(max(boost(HIGH_AT_HZ, phon), 0.0), HIGH_MAX_DB)
+        gains.append((phon, low, high))
+
+    out = ["/**",
+           " * Loudness Compensation - Coefficient Table",
+           " * Generated by tools/loudcomp_table.py (make loudcomp-table), do not edit",
+           " */",
+           "",
+           '#include "loudcomp.h"',
+           ""]
+    for rate in RATES:
+        out.append("static const loudcomp_coef_t loudcomp_%u[LOUDCOMP_STEPS] = {" % rate)
+        for step, (phon, low, high) in enumerate(gains):
+            lo = shelf(False, rate, LOW_HZ, low)
+            hi = shelf(True, rate, HIGH_HZ, high)
+            out.append("    /* %3d %%: %4.1f phon, bass %+5.2f dB, treble %+5.2f dB */"
+                       % (step * 5, phon, low, high))
+            out.append("    {{%d, %d, %d, %d, %d}," % tuple(lo))
+            out.append("     {%d, %d, %d, %d, %d}}," % tuple(hi))
+        out.append("};")
+        out.append("")
+    out.append("const loudcomp_table_t loudcomp_tables[] = {")
+    for rate in RATES:
+        out.append("    {%u, loudcomp_%u}," % (rate, rate))
+    out.append("};")
+    out.append("")
+    out.append("const uint32_t loudcomp_table_count = sizeof(loudcomp_tables) / sizeof(loudcomp_tables[0]);")
+
+    with open(sys.argv[1], "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+/**
+ * Track Loudness - Host Tools
+ */
+
+#include "loudness.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Loudness reference: 95th percentile of 50 ms RMS windows at -18 dBFS */
+#define LOUDNESS_REF_DBFS   -18.0
+#define LOUDNESS_WINDOW_MS  50
+#define LOUDNESS_PERCENTILE 0.95
+
+void loudness_init(loudness_t* ld, uint32_t sample_rate) {
+    memset(ld, 0, sizeof(*ld));
+    ld->window = sample_rate * LOUDNESS_WINDOW_MS / 1000;
+}
+
+void loudness_add(loudness_t* ld, const int16_t* pcm, uint32_t frames) {
+    for (uint32_t i = 0; i < frames * 2; i++) {
+        int32_t v = abs(pcm[i]);
+        if (v > ld->peak) ld->peak = v;
+    }
+    if (ld->window == 0) return;
+
+    for (uint32_t f = 0; f < frames; f++) {
+        double l = pcm[2 * f] / 32768.0;
+        double r = pcm[2 * f + 1] / 32768.0;
+        ld->sum += l * l;
+        ld->sum += r * r;
+        if (++ld->fill < ld->window) continue;
+
+        if (ld->count == ld->capacity) {
+            uint32_t capacity = ld->capacity ? ld->capacity * 2 : 1024;
+            double* levels = realloc(ld->levels, capacity * sizeof(double));
+            if (levels == NULL) return;     // Measure what fits
+            ld->levels = levels;
+            ld->capacity = capacity;
+        }
+        ld->levels[ld->count++] = ld->sum / (ld->window * 2);
+        ld->sum = 0.0;
+        ld->fill = 0;
+    }
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void loudness_finish(loudness_t* ld, int16_t* gain, uint16_t* peak) {
+    *peak = (uint16_t)ld->peak;
+    *gain = 0;
+
+    if (ld->count > 0) {
+        qsort(ld->levels, ld->count, sizeof(double), compare_double);
+        double level = ld->levels[(uint32_t)(LOUDNESS_PERCENTILE * (ld->count - 1))];
+        if (level > 0.0) {
+            double db = LOUDNESS_REF_DBFS - 10.0 * log10(level);
+            if (db > 64.0) db = 64.0;
+            if (db < -64.0) db = -64.0;
+            *gain = (int16_t)lround(db * 100.0);
+        }
+    }
+    free(ld->levels);
+    ld->levels = NULL;
+    ld->count = ld->capacity = 0;
+}
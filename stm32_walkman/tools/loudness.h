@@ -0,0 +1,33 @@
+/**
+ * Track Loudness - Host Tools
+ *
+ * ReplayGain-style track gain and sample peak, fed block by block so a
+ * track can be measured while it is decoded: the 95th percentile of 50 ms
+ * RMS windows is brought to -18 dBFS. Shared by wnfpack (WNF header) and
+ * wmindex (library index).
+ */
+
+#ifndef __LOUDNESS_H
+#define __LOUDNESS_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t window;            // Frames per RMS window
+    uint32_t fill;              // Frames in the current window
+    double sum;                 // Sum of squares of the current window
+    double* levels;             // Mean square of each full window
+    uint32_t count;
+    uint32_t capacity;
+    int32_t peak;
+} loudness_t;
+
+void loudness_init(loudness_t* ld, uint32_t sample_rate);
+
+/* Interleaved stereo frames */
+void loudness_add(loudness_t* ld, const int16_t* pcm, uint32_t frames);
+
+/* Track gain (0.01 dB) and peak (Q15); releases the window buffer */
+void loudness_finish(loudness_t* ld, int16_t* gain, uint16_t* peak);
+
+#endif /* __LOUDNESS_H */
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""
+Check the firmware's static RAM against the STM32F407's two regions.
+
+The linker script puts .data and .bss in the 128KB main SRAM and
+.ccmram (SYSTEM_CCM in inc/system.h) in the 64KB core-coupled RAM. The
+target link fails when a region overflows; this runs the same sums over
+the host build's objects, so `make sim` catches a buffer that outgrows
+its region without an ARM toolchain. Host pointers are wider, which
+only overstates the totals. The stack comes out of the main SRAM.
+
+Usage: ram_check.py [--stack BYTES] <system.h> <object.o>...
+"""
+
+import re
+import subprocess
+import sys
+
+REGIONS = [                         # (name, size define, section prefixes)
+    ("SRAM", "SYSTEM_SRAM_SIZE", (".data", ".bss")),
+    ("CCM", "SYSTEM_CCM_SIZE", (".ccmram",)),
+]
+
+
+def system_define(path, name):
+    """Value of a `#define NAME (a * b)` size in system.h"""
+    with open(path) as f:
+        for line in f:
+            m = re.match(r"#define\s+%s\s+\((\d+)\s*\*\s*(\d+)\)" % name, line)
+            if m:
+                return int(m.group(1)) * int(m.group(2))
+    sys.exit("ram_check: %s not found in %s" % (name, path))
+
+
+def section_sizes(obj):
+    """(section, bytes) pairs from `size -A`"""
+    out = subprocess.run(["size", "-A", obj], check=True, capture_output=True, text=True).stdout
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[0].startswith(".") and fields[1].isdigit():
+            yield fields[0], int(fields[1])
+
+
+def main(argv):
+    stack = 0
+    if len(argv) > 1 and argv[0] == "--stack":
+        stack = int(argv[1])
+        argv = argv[2:]
+    if len(argv) < 2:
+        sys.exit(__doc__.strip().splitlines()[-1])
+
+    used = {name: 0 for name, _, _ in REGIONS}
+    for obj in argv[1:]:
+        for section, size in section_sizes(obj):
+            for name, _, prefixes in REGIONS:
+                if any(section == p or section.startswith(p + ".") for p in prefixes):
+                    used[name] += size
+    used["SRAM"] += stack
+
+    failed = False
+    for name, define, _ in REGIONS:
+        limit = system_define(argv[0], define)
+        over = used[name] > limit
+        failed |= over
+        print("ram_check: %-4s %6d of %6d bytes%s%s" % (
+            name, used[name], limit, " (incl. %d stack)" % stack if name == "SRAM" else "",
+            "  OVER" if over else ""))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
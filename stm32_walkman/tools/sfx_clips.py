@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Generate the UI sound effect clips (src/audio/sfx_clips.c).
+
+Clips are mono at 44.1 kHz; the mixer steps through them at the output
+rate. Short clips stay 16-bit PCM, longer ones are stored as one IMA ADPCM
+block (the layout adpcm_ima_decode() reads: int16 first sample, step index,
+reserved byte, then 32-bit words of eight nibbles, low nibble first).
+
+    click    4 ms  3 kHz burst with a fast exponential decay (key press)
+    confirm  90 ms two raised-cosine notes, E6 then A6 (setting switched)
+
+Levels sit well below full scale so a clip on top of loud music rarely
+reaches the saturating add.
+
+Usage: sfx_clips.py <output.c>
+"""
+
+import math
+import sys
+
+RATE = 44100
+
+# name, enum, format, peak dBFS
+CLIPS = [
+    ("click", "SFX_CLICK", "pcm16", -14.0),
+    ("confirm", "SFX_CONFIRM", "ima", -18.0),
+]
+
+IMA_STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+    34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+    3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+IMA_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def click():
+    n = int(RATE * 0.004)
+    return [math.sin(2 * math.pi * 3000 * i / RATE) * math.exp(-i / (RATE * 0.0008)) *
+            min(1.0, i / 8.0) for i in range(n)]
+
+
+def confirm():
+    out = []
+    for freq in (1318.5, 1760.0):
+        n = int(RATE * 0.045)
+        out += [math.sin(2 * math.pi * freq * i / RATE) * 0.5 * (1 - math.cos(2 * math.pi * i / n))
+                for i in range(n)]
+    return out
+
+
+def scale(signal, peak_db):
+    peak = max(abs(v) for v in signal)
+    gain = 10 ** (peak_db / 20) * 32767 / peak
+    return [int(round(v * gain)) for v in signal]
+
+
+def ima_encode(samples):
+    """One mono block; padded with zeros to whole words"""
+    while (len(samples) - 1) % 8:
+        samples.append(0)
+    predictor, index = samples[0], 0
+    nibbles = []
+    for s in samples[1:]:
+        step = IMA_STEPS[index]
+        diff = s - predictor
+        nibble = 8 if diff < 0 else 0
+        diff = abs(diff)
+        for bit, part in ((4, step), (2, step >> 1), (1, step >> 2)):
+            if diff >= part:
+                nibble |= bit
+                diff -= part
+        # Track the decoder exactly (adpcm_ima_nibble)
+        delta = step >> 3
+        if nibble & 4: delta += step
+        if nibble & 2: delta += step >> 1
+        if nibble & 1: delta += step >> 2
+        predictor += -delta if nibble & 8 else delta
+        predictor = max(-32768, min(32767, predictor))
+        index = max(0, min(88, index + IMA_INDEX[nibble & 7]))
+        nibbles.append(nibble)
+
+    block = [samples[0] & 0xFF, (samples[0] >> 8) & 0xFF, 0, 0]
+    for i in range(0, len(nibbles), 2):
+        block.append(nibbles[i] | (nibbles[i + 1] << 4))
+    return block, len(samples)
+
+
+def rows(values, per_row, indent="    "):
+    return [indent + ", ".join(str(v) for v in values[i:i + per_row]) + ","
+            for i in range(0, len(values), per_row)]
+
+
+def main():
+    if len(sys.argv) != 2:
+        raise SystemExit(__doc__)
+
+    out = ["/**",
+           " * UI Sound Effects - Clips",
+           " * Generated by tools/sfx_clips.py (make sfx-clips), do not edit",
+           " */",
+           "",
+           '#include "sfx.h"',
+           ""]
+    table = []
+    for name, enum, fmt, peak_db in CLIPS:
+        samples = scale(globals()[name](), peak_db)
+        if fmt == "ima":
+            data, frames = ima_encode(samples)
+            out.append("/* %s: %d frames, IMA ADPCM, %.0f dBFS peak */" % (name, frames, peak_db))
+            out.append("static const uint8_t sfx_%s[%d] = {" % (name, len(data)))
+            out += rows(data, 16)
+            table.append("    [%s] = {sfx_%s, %d, %d, SFX_IMA}," % (enum, name, frames, RATE))
+        else:
+            out.append("/* %s: %d frames, 16-bit PCM, %.0f dBFS peak */" % (name, len(samples), peak_db))
+            out.append("static const int16_t sfx_%s[%d] = {" % (name, len(samples)))
+            out += rows(samples, 12)
+            table.append("    [%s] = {sfx_%s, %d, %d, SFX_PCM16}," % (enum, name, len(samples), RATE))
+        out.append("};")
+        out.append("")
+
+    out.append("const sfx_clip_t sfx_clips[SFX_COUNT] = {")
+    out += table
+    out.append("};")
+
+    with open(sys.argv[1], "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,957 @@
+/**
+ * SD Card Image Builder - Host Tool
+ *
+ * Builds a FAT32 card image from a card tree on the host (MBR, one
+ * partition at 4 MiB) with every file in one contiguous run of clusters.
+ * The tracks of the music folder are laid out back to back in the order of
+ * the library index, which is the playlist order, so playing through an
+ * album reads the card front to back. wmindex (next to this tool or on
+ * PATH) builds the index, which is stored first in the data area.
+ *
+ * Directories go first, then the index, the tracks, and all other files.
+ * The data area starts on a cluster boundary. The cluster size is
+ * picked for the collection: the largest power of two up to 64 KB that
+ * wastes at most 1% of the audio in partly used clusters and still gives
+ * a valid FAT32 volume. FatFs reads at most one cluster per SDIO command
+ * and follows the FAT at each cluster boundary, so larger clusters mean
+ * longer reads and fewer FAT lookups.
+ *
+ * The output can be an image file (sparse, size from -s) or the card's
+ * block device (size from the device). A host FAT driver copying files
+ * onto a mounted card cannot be told where to put them, so cards are
+ * written whole.
+ *
+ * The layout report estimates for each track the worst-case latency of
+ * refilling the player's PCM ring and of seeking to its end with FatFs
+ * (chain walk without fast seek), from an SD command cost and bus rate.
+ *
+ * Usage: wmimage [-s size] [-c cluster] [-d folder] [-g] [-j threads]
+ *                [-L access_us] [-B MB/s] [-r report] card_root output
+ *   e.g. wmimage -s 16G ~/card walkman.img; dd if=walkman.img of=/dev/sdX bs=4M
+ */
+
+#include "library.h"
+#include "player.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+#define WMIMAGE_PATH_LEN 4096
+#define WMIMAGE_SECTOR 512
+#define WMIMAGE_PART_START 8192         // Sectors: 4 MiB, SD erase aligned
+#define WMIMAGE_RESERVED 32             // Boot, FSInfo, backups at 6/7
+#define WMIMAGE_MIN_CLUSTERS 65525      // Fewer is FAT16 to every driver
+#define WMIMAGE_MAX_CLUSTERS 0x0FFFFFF5u
+#define WMIMAGE_MAX_CLUSTER_BYTES 65536
+#define WMIMAGE_SLACK_PERCENT 1
+#define WMIMAGE_FAT_PER_SECTOR (WMIMAGE_SECTOR / 4)
+#define WMIMAGE_RING_FRAMES 4096        // Player PCM ring (src/audio/player.c)
+#define WMIMAGE_LFN_CHARS 13
+#define WMIMAGE_COPY_BYTES (1 << 20)
+
+#define WMIMAGE_ATTR_DIR 0x10
+#define WMIMAGE_ATTR_ARCHIVE 0x20
+#define WMIMAGE_ATTR_LFN 0x0F
+#define WMIMAGE_ATTR_VOLUME 0x08
+
+typedef enum {
+    WMIMAGE_DIR = 0,
+    WMIMAGE_INDEX,
+    WMIMAGE_TRACK,
+    WMIMAGE_OTHER
+} wmimage_kind_t;
+
+typedef struct wmimage_node {
+    char* name;                         // Long name (UTF-8)
+    char* host_path;
+    char* card_path;
+    uint8_t kind;
+    uint64_t size;                      // Bytes; directories after layout
+    time_t mtime;
+    struct wmimage_node* parent;
+    struct wmimage_node** children;
+    uint32_t child_count;
+    uint32_t child_capacity;
+    uint8_t sfn[11];                    // 8.3 name as stored
+    uint8_t lfn_entries;                // 0 if the 8.3 name is exact
+    uint16_t* ucs;                      // Long name in UTF-16
+    uint32_t ucs_len;
+    uint32_t first_cluster;
+    uint32_t clusters;
+    library_entry_t entry;              // Tracks only
+} wmimage_node_t;
+
+typedef struct {
+    wmimage_node_t* root;
+    wmimage_node_t** files;             // All files, by card path
+    uint32_t file_count;
+    uint32_t file_capacity;
+    wmimage_node_t** order;             // Allocation order
+    uint32_t order_count;
+
+    /* Geometry, in sectors unless noted */
+    uint64_t total_sectors;
+    uint32_t part_sectors;
+    uint32_t cluster_bytes;
+    uint32_t spc;
+    uint32_t reserved;
+    uint32_t fat_sectors;
+    uint32_t clusters;
+    uint32_t data_start;                // Absolute sector of cluster 2
+    uint32_t used_clusters;
+
+    /* SD read cost model for the report */
+    double access_us;
+    double bus_mb_s;
+} wmimage_t;
+
+/* ============ Tree ============ */
+
+static void* wmimage_alloc(size_t bytes) {
+    void* p = calloc(1, bytes);
+    if (p == NULL) {
+        fprintf(stderr, "wmimage: out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+static wmimage_node_t* wmimage_node(wmimage_node_t* parent, const char* name, const char* host_path,
+                                    const char* card_path, uint8_t kind, const struct stat* st) {
+    wmimage_node_t* node = wmimage_alloc(sizeof(wmimage_node_t));
+
+    node->name = strdup(name);
+    node->host_path = strdup(host_path);
+    node->card_path = strdup(card_path);
+    node->kind = kind;
+    node->size = (kind == WMIMAGE_DIR) ? 0 : (uint64_t)st->st_size;
+    node->mtime = st->st_mtime;
+    node->parent = parent;
+    if (parent != NULL) {
+        if (parent->child_count == parent->child_capacity) {
+            parent->child_capacity = parent->child_capacity ? parent->child_capacity * 2 : 16;
+            parent->children = realloc(parent->children, parent->child_capacity * sizeof(wmimage_node_t*));
+        }
+        parent->children[parent->child_count++] = node;
+    }
+    return node;
+}
+
+static void wmimage_add_file(wmimage_t* im, wmimage_node_t* node) {
+    if (im->file_count == im->file_capacity) {
+        im->file_capacity = im->file_capacity ? im->file_capacity * 2 : 1024;
+        im->files = realloc(im->files, im->file_capacity * sizeof(wmimage_node_t*));
+        if (im->files == NULL) {
+            fprintf(stderr, "wmimage: out of memory\n");
+            exit(1);
+        }
+    }
+    im->files[im->file_count++] = node;
+}
+
+static int wmimage_compare_name(const void* a, const void* b) {
+    return strcmp((*(wmimage_node_t* const*)a)->name, (*(wmimage_node_t* const*)b)->name);
+}
+
+/* Hidden files stay behind, as do old indexes: the fresh one replaces them */
+static void wmimage_scan(wmimage_t* im, wmimage_node_t* dir, const char* index_card_path) {
+    char host_path[WMIMAGE_PATH_LEN], card_path[WMIMAGE_PATH_LEN];
+    struct dirent* de;
+    struct stat st;
+    DIR* d = opendir(dir->host_path);
+
+    if (d == NULL) {
+        fprintf(stderr, "wmimage: cannot open %s\n", dir->host_path);
+        return;
+    }
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_name[0] == '.') continue;
+        if (snprintf(host_path, sizeof(host_path), "%s/%s", dir->host_path, de->d_name) >= (int)sizeof(host_path) ||
+            snprintf(card_path, sizeof(card_path), "%s/%s", dir->card_path, de->d_name) >= (int)sizeof(card_path) ||
+            stat(host_path, &st) != 0) {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            wmimage_scan(im, wmimage_node(dir, de->d_name, host_path, card_path, WMIMAGE_DIR, &st),
+                         index_card_path);
+        } else if (S_ISREG(st.st_mode) && strcmp(card_path, index_card_path) != 0) {
+            if (st.st_size > 0xFFFFFFFFll) {
+                fprintf(stderr, "wmimage: %s: over 4 GB, left out\n", card_path);
+                continue;
+            }
+            wmimage_add_file(im, wmimage_node(dir, de->d_name, host_path, card_path, WMIMAGE_OTHER, &st));
+        }
+    }
+    closedir(d);
+
+    /* Entries in name order, so the same tree gives the same image */
+    qsort(dir->children, dir->child_count, sizeof(wmimage_node_t*), wmimage_compare_name);
+}
+
+static wmimage_node_t* wmimage_find_dir(wmimage_node_t* dir, const char* card_path) {
+    if (strcmp(dir->card_path, card_path) == 0) return dir;
+    for (uint32_t i = 0; i < dir->child_count; i++) {
+        wmimage_node_t* hit = NULL;
+        if (dir->children[i]->kind == WMIMAGE_DIR) hit = wmimage_find_dir(dir->children[i], card_path);
+        if (hit != NULL) return hit;
+    }
+    return NULL;
+}
+
+static int wmimage_compare_path(const void* a, const void* b) {
+    return strcmp((*(wmimage_node_t* const*)a)->card_path, (*(wmimage_node_t* const*)b)->card_path);
+}
+
+/* ============ Names ============ */
+
+static uint32_t wmimage_utf16(const char* s, uint16_t* out, uint32_t max) {
+    const uint8_t* p = (const uint8_t*)s;
+    uint32_t n = 0;
+
+    while (*p && n < max) {
+        uint32_t c = *p++;
+        uint32_t extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : 0;
+        if (extra) c &= 0x3F >> extra;
+        while (extra-- && (*p & 0xC0) == 0x80) c = (c << 6) | (*p++ & 0x3F);
+
+        if (c >= 0x10000 && n + 1 < max) {
+            c -= 0x10000;
+            out[n++] = (uint16_t)(0xD800 | (c >> 10));
+            out[n++] = (uint16_t)(0xDC00 | (c & 0x3FF));
+        } else if (c < 0x10000) {
+            out[n++] = (uint16_t)c;
+        } else {
+            break;
+        }
+    }
+    return n;
+}
+
+static int wmimage_sfn_char(int c) {
+    return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           (c != 0 && strchr("$%'-_@~`!(){}^#&", c) != NULL);
+}
+
+/**
+ * 8.3 name for a node: exact when the name fits (no long name entries
+ * then), else BASE~N.EXT with N making it unique in its directory
+ */
+static void wmimage_names(wmimage_node_t* dir) {
+    for (uint32_t i = 0; i < dir->child_count; i++) {
+        wmimage_node_t* node = dir->children[i];
+        const char* dot = strrchr(node->name, '.');
+        size_t base_len = (dot && dot != node->name) ? (size_t)(dot - node->name) : strlen(node->name);
+        const char* ext = (dot && dot != node->name) ? dot + 1 : "";
+        char base[9], ex[4];
+        uint32_t b = 0, e = 0;
+        int lossy = (base_len > 8 || strlen(ext) > 3);
+
+        for (size_t k = 0; k < base_len; k++) {
+            int c = (unsigned char)node->name[k];
+            if (c >= 'a' && c <= 'z') {
+                c -= 32;
+                lossy = 1;
+            }
+            if (!wmimage_sfn_char(c)) {
+                lossy = 1;
+                continue;
+            }
+            if (b < 8) base[b++] = (char)c;
+        }
+        for (const char* p = ext; *p; p++) {
+            int c = (unsigned char)*p;
+            if (c >= 'a' && c <= 'z') {
+                c -= 32;
+                lossy = 1;
+            }
+            if (!wmimage_sfn_char(c)) {
+                lossy = 1;
+                continue;
+            }
+            if (e < 3) ex[e++] = (char)c;
+        }
+        if (b == 0) {
+            base[b++] = '_';
+            lossy = 1;
+        }
+
+        memset(node->sfn, ' ', 11);
+        memcpy(node->sfn + 8, ex, e);
+        if (!lossy) {
+            memcpy(node->sfn, base, b);
+        } else {
+            /* ~N tail: first free number among the names already given */
+            for (uint32_t n = 1;; n++) {
+                char tail[12];
+                int t = snprintf(tail, sizeof(tail), "~%u", n);
+                uint32_t keep = b < (uint32_t)(8 - t) ? b : (uint32_t)(8 - t);
+                memset(node->sfn, ' ', 8);
+                memcpy(node->sfn, base, keep);
+                memcpy(node->sfn + keep, tail, (size_t)t);
+
+                uint32_t k = 0;
+                while (k < i && memcmp(dir->children[k]->sfn, node->sfn, 11) != 0) k++;
+                if (k == i) break;
+            }
+        }
+        if (node->sfn[0] == 0xE5) node->sfn[0] = 0x05;
+
+        node->ucs = wmimage_alloc(256 * sizeof(uint16_t));
+        node->ucs_len = wmimage_utf16(node->name, node->ucs, 255);
+        node->lfn_entries = lossy ? (uint8_t)((node->ucs_len + WMIMAGE_LFN_CHARS - 1) / WMIMAGE_LFN_CHARS) : 0;
+
+        if (node->kind == WMIMAGE_DIR) wmimage_names(node);
+    }
+}
+
+static uint8_t wmimage_sfn_checksum(const uint8_t* sfn) {
+    uint8_t sum = 0;
+    for (int i = 0; i < 11; i++) {
+        sum = (uint8_t)(((sum & 1) << 7) + (sum >> 1) + sfn[i]);
+    }
+    return sum;
+}
+
+/* ============ Geometry and layout ============ */
+
+static uint32_t wmimage_clusters_for(uint64_t bytes, uint32_t cluster_bytes) {
+    return (uint32_t)((bytes + cluster_bytes - 1) / cluster_bytes);
+}
+
+static uint32_t wmimage_dir_entries(const wmimage_node_t* dir) {
+    uint32_t n = (dir->parent == NULL) ? 1 : 2;     // Volume label, or . and ..
+    for (uint32_t i = 0; i < dir->child_count; i++) {
+        n += 1 + dir->children[i]->lfn_entries;
+    }
+    return n;
+}
+
+/**
+ * Volume layout for a cluster size: reserved sectors padded so cluster 2
+ * starts on a cluster boundary of the card. 0 if no FAT32 volume fits.
+ */
+static int wmimage_geometry(wmimage_t* im, uint32_t cluster_bytes) {
+    uint64_t part = im->total_sectors - WMIMAGE_PART_START;
+
+    if (im->total_sectors <= WMIMAGE_PART_START || part > 0xFFFFFFFFu) return 0;
+    im->part_sectors = (uint32_t)part;
+    im->cluster_bytes = cluster_bytes;
+    im->spc = cluster_bytes / WMIMAGE_SECTOR;
+
+    /* FAT sized for every sector being data: a few sectors too many at most */
+    im->fat_sectors = (uint32_t)(((uint64_t)im->part_sectors / im->spc + 2 + WMIMAGE_FAT_PER_SECTOR - 1) /
+                                 WMIMAGE_FAT_PER_SECTOR);
+    im->reserved = WMIMAGE_RESERVED;
+    uint32_t start = WMIMAGE_PART_START + im->reserved + 2 * im->fat_sectors;
+    im->reserved += (im->spc - start % im->spc) % im->spc;
+    im->data_start = WMIMAGE_PART_START + im->reserved + 2 * im->fat_sectors;
+
+    uint32_t meta = im->reserved + 2 * im->fat_sectors;
+    if (meta >= im->part_sectors) return 0;
+    im->clusters = (im->part_sectors - meta) / im->spc;
+    return im->clusters >= WMIMAGE_MIN_CLUSTERS && im->clusters <= WMIMAGE_MAX_CLUSTERS;
+}
+
+static uint64_t wmimage_slack(const wmimage_t* im, uint32_t cluster_bytes, uint64_t* audio) {
+    uint64_t slack = 0;
+
+    *audio = 0;
+    for (uint32_t i = 0; i < im->file_count; i++) {
+        uint64_t size = im->files[i]->size;
+        if (im->files[i]->kind != WMIMAGE_TRACK) continue;
+        *audio += size;
+        slack += (uint64_t)wmimage_clusters_for(size, cluster_bytes) * cluster_bytes - size;
+    }
+    return slack;
+}
+
+/**
+ * Largest cluster size with little slack that gives a valid volume;
+ * failing the slack limit, the smallest valid one
+ */
+static uint32_t wmimage_pick_cluster(wmimage_t* im) {
+    uint32_t fallback = 0;
+
+    for (uint32_t cb = WMIMAGE_MAX_CLUSTER_BYTES; cb >= WMIMAGE_SECTOR; cb /= 2) {
+        uint64_t audio;
+        uint64_t slack = wmimage_slack(im, cb, &audio);
+        if (!wmimage_geometry(im, cb)) continue;
+        if (slack * 100 <= audio * WMIMAGE_SLACK_PERCENT) return cb;
+        fallback = cb;
+    }
+    return fallback;
+}
+
+static void wmimage_place(wmimage_t* im, wmimage_node_t* node, uint32_t* next) {
+    uint64_t bytes = node->size;
+
+    if (node->kind == WMIMAGE_DIR) {
+        node->clusters = wmimage_clusters_for((uint64_t)wmimage_dir_entries(node) * 32, im->cluster_bytes);
+        node->size = (uint64_t)node->clusters * im->cluster_bytes;
+    } else {
+        node->clusters = wmimage_clusters_for(bytes, im->cluster_bytes);
+    }
+    node->first_cluster = node->clusters ? *next : 0;
+    *next += node->clusters;
+    im->order[im->order_count++] = node;
+}
+
+/* Directories breadth first from the root at cluster 2 */
+static void wmimage_place_dirs(wmimage_t* im, uint32_t* next) {
+    uint32_t head = im->order_count;
+
+    wmimage_place(im, im->root, next);
+    while (head < im->order_count) {
+        wmimage_node_t* dir = im->order[head++];
+        for (uint32_t i = 0; i < dir->child_count; i++) {
+            if (dir->children[i]->kind == WMIMAGE_DIR) wmimage_place(im, dir->children[i], next);
+        }
+    }
+}
+
+static uint32_t wmimage_count_dirs(const wmimage_node_t* dir) {
+    uint32_t n = 1;
+    for (uint32_t i = 0; i < dir->child_count; i++) {
+        if (dir->children[i]->kind == WMIMAGE_DIR) n += wmimage_count_dirs(dir->children[i]);
+    }
+    return n;
+}
+
+/* ============ Writing ============ */
+
+static void wmimage_put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void wmimage_put32(uint8_t* p, uint32_t v) {
+    wmimage_put16(p, (uint16_t)v);
+    wmimage_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static int wmimage_pwrite(int fd, const void* buf, size_t len, uint64_t offset) {
+    const uint8_t* p = buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, (off_t)offset);
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+static uint64_t wmimage_cluster_offset(const wmimage_t* im, uint32_t cluster) {
+    return ((uint64_t)im->data_start + (uint64_t)(cluster - 2) * im->spc) * WMIMAGE_SECTOR;
+}
+
+static void wmimage_fat_time(time_t t, uint16_t* date, uint16_t* tod) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    if (tm.tm_year < 80) {
+        *date = (1 << 5) | 1;
+        *tod = 0;
+        return;
+    }
+    *date = (uint16_t)(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday);
+    *tod = (uint16_t)((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2));
+}
+
+static void wmimage_short_entry(uint8_t* e, const uint8_t* sfn, uint8_t attr,
+                                uint32_t cluster, uint32_t size, time_t mtime) {
+    uint16_t date, tod;
+
+    memset(e, 0, 32);
+    memcpy(e, sfn, 11);
+    e[11] = attr;
+    wmimage_fat_time(mtime, &date, &tod);
+    wmimage_put16(e + 14, tod);
+    wmimage_put16(e + 16, date);
+    wmimage_put16(e + 18, date);
+    wmimage_put16(e + 20, (uint16_t)(cluster >> 16));
+    wmimage_put16(e + 22, tod);
+    wmimage_put16(e + 24, date);
+    wmimage_put16(e + 26, (uint16_t)cluster);
+    wmimage_put32(e + 28, size);
+}
+
+/* Long name entries, last part first, then the 8.3 entry */
+static uint8_t* wmimage_dir_entry(uint8_t* e, const wmimage_node_t* node) {
+    static const uint8_t slots[WMIMAGE_LFN_CHARS] = {1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30};
+    uint8_t sum = wmimage_sfn_checksum(node->sfn);
+
+    for (uint32_t part = node->lfn_entries; part > 0; part--, e += 32) {
+        memset(e, 0, 32);
+        e[0] = (uint8_t)(part | (part == node->lfn_entries ? 0x40 : 0));
+        e[11] = WMIMAGE_ATTR_LFN;
+        e[13] = sum;
+        for (uint32_t k = 0; k < WMIMAGE_LFN_CHARS; k++) {
+            uint32_t i = (part - 1) * WMIMAGE_LFN_CHARS + k;
+            uint16_t c = (i < node->ucs_len) ? node->ucs[i] : (i == node->ucs_len) ? 0x0000 : 0xFFFF;
+            wmimage_put16(e + slots[k], c);
+        }
+    }
+    wmimage_short_entry(e, node->sfn, node->kind == WMIMAGE_DIR ? WMIMAGE_ATTR_DIR : WMIMAGE_ATTR_ARCHIVE,
+                        node->first_cluster, node->kind == WMIMAGE_DIR ? 0 : (uint32_t)node->size,
+                        node->mtime);
+    return e + 32;
+}
+
+static int wmimage_write_dir(const wmimage_t* im, int fd, const wmimage_node_t* dir) {
+    uint8_t* buf = wmimage_alloc((size_t)dir->size);
+    uint8_t* e = buf;
+
+    if (dir->parent == NULL) {
+        static const uint8_t label[11] = {'W', 'A', 'L', 'K', 'M', 'A', 'N', ' ', ' ', ' ', ' '};
+        wmimage_short_entry(e, label, WMIMAGE_ATTR_VOLUME, 0, 0, dir->mtime);
+        e += 32;
+    } else {
+        static const uint8_t dot[11] = {'.', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '};
+        static const uint8_t dotdot[11] = {'.', '.', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '};
+        uint32_t up = dir->parent->parent ? dir->parent->first_cluster : 0;
+        wmimage_short_entry(e, dot, WMIMAGE_ATTR_DIR, dir->first_cluster, 0, dir->mtime);
+        wmimage_short_entry(e + 32, dotdot, WMIMAGE_ATTR_DIR, up, 0, dir->parent->mtime);
+        e += 64;
+    }
+    for (uint32_t i = 0; i < dir->child_count; i++) {
+        e = wmimage_dir_entry(e, dir->children[i]);
+    }
+
+    int status = wmimage_pwrite(fd, buf, (size_t)dir->size, wmimage_cluster_offset(im, dir->first_cluster));
+    free(buf);
+    return status;
+}
+
+static int wmimage_copy(const wmimage_t* im, int fd, const wmimage_node_t* node, uint8_t* buf) {
+    uint64_t offset = wmimage_cluster_offset(im, node->first_cluster);
+    uint64_t left = node->size;
+    FILE* f = fopen(node->host_path, "rb");
+
+    if (f == NULL) return -1;
+    while (left > 0) {
+        size_t n = fread(buf, 1, left < WMIMAGE_COPY_BYTES ? (size_t)left : WMIMAGE_COPY_BYTES, f);
+        if (n == 0 || wmimage_pwrite(fd, buf, n, offset) != 0) {
+            fclose(f);
+            return -1;
+        }
+        offset += n;
+        left -= n;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int wmimage_write(wmimage_t* im, int fd) {
+    uint8_t sector[WMIMAGE_SECTOR];
+    uint32_t free_clusters = im->clusters - im->used_clusters;
+
+    /* MBR: one FAT32 LBA partition */
+    memset(sector, 0, sizeof(sector));
+    uint8_t* pe = sector + 446;
+    pe[1] = 0xFE; pe[2] = 0xFF; pe[3] = 0xFF;
+    pe[4] = 0x0C;
+    pe[5] = 0xFE; pe[6] = 0xFF; pe[7] = 0xFF;
+    wmimage_put32(pe + 8, WMIMAGE_PART_START);
+    wmimage_put32(pe + 12, im->part_sectors);
+    sector[510] = 0x55;
+    sector[511] = 0xAA;
+    if (wmimage_pwrite(fd, sector, sizeof(sector), 0) != 0) return -1;
+
+    /* Boot sector, and its backup at 6 */
+    memset(sector, 0, sizeof(sector));
+    memcpy(sector, "\xEB\x58\x90WALKMAN ", 11);
+    wmimage_put16(sector + 11, WMIMAGE_SECTOR);
+    sector[13] = (uint8_t)im->spc;
+    wmimage_put16(sector + 14, (uint16_t)im->reserved);
+    sector[16] = 2;
+    sector[21] = 0xF8;
+    wmimage_put16(sector + 24, 63);
+    wmimage_put16(sector + 26, 255);
+    wmimage_put32(sector + 28, WMIMAGE_PART_START);
+    wmimage_put32(sector + 32, im->part_sectors);
+    wmimage_put32(sector + 36, im->fat_sectors);
+    wmimage_put32(sector + 44, 2);
+    wmimage_put16(sector + 48, 1);
+    wmimage_put16(sector + 50, 6);
+    sector[64] = 0x80;
+    sector[66] = 0x29;
+    wmimage_put32(sector + 67, (uint32_t)time(NULL));
+    memcpy(sector + 71, "WALKMAN    FAT32   ", 19);
+    sector[510] = 0x55;
+    sector[511] = 0xAA;
+    uint64_t part = (uint64_t)WMIMAGE_PART_START * WMIMAGE_SECTOR;
+    if (wmimage_pwrite(fd, sector, sizeof(sector), part) != 0 ||
+        wmimage_pwrite(fd, sector, sizeof(sector), part + 6 * WMIMAGE_SECTOR) != 0) {
+        return -1;
+    }
+
+    /* FSInfo at 1 and 7 */
+    memset(sector, 0, sizeof(sector));
+    wmimage_put32(sector, 0x41615252);
+    wmimage_put32(sector + 484, 0x61417272);
+    wmimage_put32(sector + 488, free_clusters);
+    wmimage_put32(sector + 492, 2 + im->used_clusters);
+    wmimage_put32(sector + 508, 0xAA550000);
+    if (wmimage_pwrite(fd, sector, sizeof(sector), part + WMIMAGE_SECTOR) != 0 ||
+        wmimage_pwrite(fd, sector, sizeof(sector), part + 7 * WMIMAGE_SECTOR) != 0) {
+        return -1;
+    }
+
+    /* Both FATs: one unbroken chain per file */
+    size_t fat_bytes = (size_t)im->fat_sectors * WMIMAGE_SECTOR;
+    uint8_t* fat = wmimage_alloc(fat_bytes);
+    wmimage_put32(fat, 0x0FFFFFF8);
+    wmimage_put32(fat + 4, 0x0FFFFFFF);
+    for (uint32_t i = 0; i < im->order_count; i++) {
+        const wmimage_node_t* node = im->order[i];
+        for (uint32_t k = 0; k < node->clusters; k++) {
+            uint32_t c = node->first_cluster + k;
+            wmimage_put32(fat + (size_t)c * 4, k + 1 < node->clusters ? c + 1 : 0x0FFFFFFF);
+        }
+    }
+    for (uint32_t copy = 0; copy < 2; copy++) {
+        uint64_t at = part + ((uint64_t)im->reserved + (uint64_t)copy * im->fat_sectors) * WMIMAGE_SECTOR;
+        if (wmimage_pwrite(fd, fat, fat_bytes, at) != 0) {
+            free(fat);
+            return -1;
+        }
+    }
+    free(fat);
+
+    uint8_t* buf = wmimage_alloc(WMIMAGE_COPY_BYTES);
+    for (uint32_t i = 0; i < im->order_count; i++) {
+        const wmimage_node_t* node = im->order[i];
+        int status = (node->kind == WMIMAGE_DIR) ? wmimage_write_dir(im, fd, node) :
+                     wmimage_copy(im, fd, node, buf);
+        if (status != 0) {
+            fprintf(stderr, "wmimage: cannot write %s\n", node->card_path);
+            free(buf);
+            return -1;
+        }
+    }
+    free(buf);
+    return 0;
+}
+
+/* ============ Index ============ */
+
+/* Build the index with wmindex into a temporary file */
+static int wmimage_run_wmindex(const char* self, const char* card_root, const char* folder,
+                               int analyse, const char* threads, const char* output) {
+    char tool[WMIMAGE_PATH_LEN];
+    const char* slash = strrchr(self, '/');
+    char* argv[12];
+    int argc = 0, status;
+
+    snprintf(tool, sizeof(tool), "%.*swmindex", slash ? (int)(slash - self + 1) : 0, self);
+    if (slash == NULL || access(tool, X_OK) != 0) snprintf(tool, sizeof(tool), "wmindex");
+
+    argv[argc++] = tool;
+    argv[argc++] = "-d";
+    argv[argc++] = (char*)folder;
+    argv[argc++] = "-o";
+    argv[argc++] = (char*)output;
+    if (analyse) argv[argc++] = "-g";
+    if (threads) {
+        argv[argc++] = "-j";
+        argv[argc++] = (char*)threads;
+    }
+    argv[argc++] = (char*)card_root;
+    argv[argc] = NULL;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) dup2(null, STDOUT_FILENO);
+        execvp(tool, argv);
+        _exit(127);
+    }
+    if (pid < 0 || waitpid(pid, &status, 0) != pid) return -1;
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+static int wmimage_find(const void* key, const void* item) {
+    return strcmp((const char*)key, (*(wmimage_node_t* const*)item)->card_path);
+}
+
+/* Mark the files the index lists as tracks, in index order */
+static uint32_t wmimage_tracks(wmimage_t* im, const char* index_path, wmimage_node_t** tracks) {
+    char path[MAX_FILENAME_LEN];
+    library_t lib;
+    uint32_t n = 0;
+
+    if (library_open(&lib, index_path) != LIBRARY_OK) return 0;
+    for (uint32_t i = 0; i < lib.track_count; i++) {
+        library_entry_t entry;
+        if (library_read_entry(&lib, i, &entry) != LIBRARY_OK ||
+            library_read_string(&lib, entry.path, path, sizeof(path)) != LIBRARY_OK) {
+            break;
+        }
+        wmimage_node_t** hit = bsearch(path, im->files, im->file_count, sizeof(wmimage_node_t*), wmimage_find);
+        if (hit != NULL && (*hit)->kind == WMIMAGE_OTHER) {
+            (*hit)->kind = WMIMAGE_TRACK;
+            (*hit)->entry = entry;
+            tracks[n++] = *hit;
+        }
+    }
+    library_close(&lib);
+    return n;
+}
+
+/* ============ Report ============ */
+
+static double wmimage_command_us(const wmimage_t* im, uint64_t bytes) {
+    return im->access_us + (double)bytes / im->bus_mb_s;
+}
+
+/**
+ * Worst case for one ring refill: every cluster is one read command, plus
+ * a FAT sector load each time the chain leaves the FAT sector FatFs holds
+ * (128 clusters per sector) and partial sectors at both ends
+ */
+static double wmimage_refill_us(const wmimage_t* im, uint64_t bytes) {
+    uint32_t clusters = wmimage_clusters_for(bytes, im->cluster_bytes) + 1;
+    uint32_t fat_loads = clusters / WMIMAGE_FAT_PER_SECTOR + 1;
+    return clusters * im->access_us + (double)bytes / im->bus_mb_s +
+           fat_loads * wmimage_command_us(im, WMIMAGE_SECTOR) + 2 * wmimage_command_us(im, WMIMAGE_SECTOR);
+}
+
+/* f_lseek without fast seek walks the chain, one FAT sector per load */
+static double wmimage_seek_us(const wmimage_t* im, const wmimage_node_t* node) {
+    uint32_t fat_loads = (node->clusters + WMIMAGE_FAT_PER_SECTOR - 1) / WMIMAGE_FAT_PER_SECTOR;
+    return fat_loads * wmimage_command_us(im, WMIMAGE_SECTOR) + wmimage_command_us(im, WMIMAGE_SECTOR);
+}
+
+static void wmimage_report(const wmimage_t* im, wmimage_node_t** tracks, uint32_t count, FILE* out) {
+    double worst = 0.0;
+    uint32_t worst_track = 0, gaps = 0, over = 0;
+
+    if (out) {
+        fprintf(out, "# cluster %u B, SD command %.0f us, bus %.1f MB/s, ring %u frames\n",
+                im->cluster_bytes, im->access_us, im->bus_mb_s, WMIMAGE_RING_FRAMES);
+        fprintf(out, "# first_cluster clusters bytes ring_ms refill_ms seek_ms path\n");
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const wmimage_node_t* t = tracks[i];
+        const library_entry_t* e = &t->entry;
+        uint32_t rate = e->sample_rate ? e->sample_rate : 44100;
+
+        /* Stored bytes behind one ring of output at the track's own rate */
+        double ring_ms = 1000.0 * WMIMAGE_RING_FRAMES / rate;
+        uint64_t ring_bytes = e->duration_ms ? (uint64_t)((double)t->size * ring_ms / e->duration_ms) : t->size;
+        if (ring_bytes > t->size) ring_bytes = t->size;
+        double refill_ms = wmimage_refill_us(im, ring_bytes) / 1000.0;
+        double seek_ms = wmimage_seek_us(im, t) / 1000.0;
+        double latency = refill_ms > seek_ms ? refill_ms : seek_ms;
+
+        if (i > 0 && tracks[i - 1]->clusters &&
+            t->first_cluster != tracks[i - 1]->first_cluster + tracks[i - 1]->clusters) {
+            gaps++;
+        }
+        if (latency > ring_ms) over++;
+        if (latency > worst) {
+            worst = latency;
+            worst_track = i;
+        }
+        if (out) {
+            fprintf(out, "%10u %8u %11llu %7.1f %9.2f %7.2f %s%s\n", t->first_cluster, t->clusters,
+                    (unsigned long long)t->size, ring_ms, refill_ms, seek_ms, t->card_path,
+                    latency > ring_ms ? "  (exceeds ring)" : "");
+        }
+    }
+
+    printf("layout: %u tracks in playlist order, 1 fragment each, %u gaps between neighbours\n",
+           count, gaps);
+    if (count > 0) {
+        printf("worst-case read latency %.2f ms (%s), %u tracks beyond the %u-frame ring\n",
+               worst, tracks[worst_track]->card_path, over, WMIMAGE_RING_FRAMES);
+    }
+}
+
+/* ============ Main ============ */
+
+static uint64_t wmimage_parse_size(const char* s) {
+    char* end;
+    double v = strtod(s, &end);
+    switch (*end) {
+        case 'k': case 'K': v *= 1024.0; break;
+        case 'm': case 'M': v *= 1024.0 * 1024.0; break;
+        case 'g': case 'G': v *= 1024.0 * 1024.0 * 1024.0; break;
+        case 't': case 'T': v *= 1024.0 * 1024.0 * 1024.0 * 1024.0; break;
+        default: break;
+    }
+    return v > 0 ? (uint64_t)v : 0;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: wmimage [-s size] [-c cluster] [-d folder] [-g] [-j threads]\n"
+            "               [-L access_us] [-B MB/s] [-r report] card_root output\n"
+            "  -s  card size, e.g. 16G (default: size of the output device)\n"
+            "  -c  cluster size in bytes (default: picked for the collection)\n"
+            "  -d  music folder on the card (default /music)\n"
+            "  -g  and -j are passed to wmindex\n"
+            "  -L  SD read command cost for the report (default 1000 us)\n"
+            "  -B  SDIO bus rate for the report (default 12 MB/s, 4-bit at 24 MHz)\n"
+            "  -r  per-track layout report\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    const char* folder = "/music";
+    const char* threads = NULL;
+    const char* report = NULL;
+    char index_tmp[] = "/tmp/wmimage-XXXXXX";
+    char index_card[WMIMAGE_PATH_LEN];
+    uint64_t size = 0;
+    uint32_t cluster = 0;
+    int analyse = 0, opt;
+    struct stat st;
+    wmimage_t im;
+
+    memset(&im, 0, sizeof(im));
+    im.access_us = 1000.0;
+    im.bus_mb_s = 12.0;
+    while ((opt = getopt(argc, argv, "s:c:d:gj:L:B:r:h")) != -1) {
+        switch (opt) {
+            case 's': size = wmimage_parse_size(optarg); break;
+            case 'c': cluster = (uint32_t)wmimage_parse_size(optarg); break;
+            case 'd': folder = optarg; break;
+            case 'g': analyse = 1; break;
+            case 'j': threads = optarg; break;
+            case 'L': im.access_us = strtod(optarg, NULL); break;
+            case 'B': im.bus_mb_s = strtod(optarg, NULL); break;
+            case 'r': report = optarg; break;
+            default: usage();
+        }
+    }
+    if (argc - optind != 2 || folder[0] != '/' || im.bus_mb_s <= 0.0) usage();
+    if (cluster && (cluster < WMIMAGE_SECTOR || cluster > WMIMAGE_MAX_CLUSTER_BYTES || (cluster & (cluster - 1)))) {
+        fprintf(stderr, "wmimage: cluster size must be a power of two from 512 to 65536\n");
+        return 2;
+    }
+    const char* card_root = argv[optind];
+    const char* output = argv[optind + 1];
+
+    /* The index first: it decides which files are tracks and their order */
+    int tmp_fd = mkstemp(index_tmp);
+    if (tmp_fd < 0) {
+        fprintf(stderr, "wmimage: cannot create a temporary file\n");
+        return 1;
+    }
+    close(tmp_fd);
+    if (wmimage_run_wmindex(argv[0], card_root, folder, analyse, threads, index_tmp) != 0) {
+        fprintf(stderr, "wmimage: wmindex failed\n");
+        remove(index_tmp);
+        return 1;
+    }
+
+    if (stat(card_root, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "wmimage: %s is not a folder\n", card_root);
+        remove(index_tmp);
+        return 1;
+    }
+    snprintf(index_card, sizeof(index_card), "%s/%s", folder, LIBRARY_INDEX_NAME);
+    im.root = wmimage_node(NULL, "", card_root, "", WMIMAGE_DIR, &st);
+    wmimage_scan(&im, im.root, index_card);
+    qsort(im.files, im.file_count, sizeof(wmimage_node_t*), wmimage_compare_path);
+
+    wmimage_node_t** tracks = wmimage_alloc((im.file_count + 1) * sizeof(wmimage_node_t*));
+    uint32_t track_count = wmimage_tracks(&im, index_tmp, tracks);
+
+    /* The index goes in the music folder, which holds the tracks */
+    wmimage_node_t* music = wmimage_find_dir(im.root, folder);
+    if (music == NULL || stat(index_tmp, &st) != 0) {
+        fprintf(stderr, "wmimage: no %s folder in %s\n", folder, card_root);
+        remove(index_tmp);
+        return 1;
+    }
+    st.st_mtime = time(NULL);
+    wmimage_node_t* index = wmimage_node(music, LIBRARY_INDEX_NAME, index_tmp, index_card, WMIMAGE_INDEX, &st);
+    wmimage_names(im.root);
+
+    /* Card size: given, or the block device's */
+    int fd = open(output, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "wmimage: cannot open %s\n", output);
+        remove(index_tmp);
+        return 1;
+    }
+    if (S_ISBLK(st.st_mode)) {
+#ifdef BLKGETSIZE64
+        uint64_t dev_size = 0;
+        if (ioctl(fd, BLKGETSIZE64, &dev_size) == 0 && (size == 0 || size > dev_size)) size = dev_size;
+#endif
+    } else if (size == 0) {
+        fprintf(stderr, "wmimage: give the card size with -s for an image file\n");
+        remove(index_tmp);
+        return 2;
+    }
+    im.total_sectors = size / WMIMAGE_SECTOR;
+
+    if (cluster == 0) cluster = wmimage_pick_cluster(&im);
+    if (cluster == 0 || !wmimage_geometry(&im, cluster)) {
+        fprintf(stderr, "wmimage: no FAT32 volume of that cluster size fits %llu bytes\n",
+                (unsigned long long)size);
+        remove(index_tmp);
+        return 1;
+    }
+
+    /* Layout: directories, index, tracks in playlist order, the rest */
+    uint32_t next = 2;
+    im.order = wmimage_alloc((im.file_count + wmimage_count_dirs(im.root) + 1) * sizeof(wmimage_node_t*));
+    wmimage_place_dirs(&im, &next);
+    wmimage_place(&im, index, &next);
+    for (uint32_t i = 0; i < track_count; i++) {
+        wmimage_place(&im, tracks[i], &next);
+    }
+    for (uint32_t i = 0; i < im.file_count; i++) {
+        if (im.files[i]->kind == WMIMAGE_OTHER) wmimage_place(&im, im.files[i], &next);
+    }
+    im.used_clusters = next - 2;
+    if (im.used_clusters > im.clusters) {
+        fprintf(stderr, "wmimage: %u clusters needed, the card has %u\n", im.used_clusters, im.clusters);
+        remove(index_tmp);
+        return 1;
+    }
+
+    if (S_ISREG(st.st_mode) && ftruncate(fd, 0) != 0) {
+        fprintf(stderr, "wmimage: cannot truncate %s\n", output);
+        remove(index_tmp);
+        return 1;
+    }
+    if ((S_ISREG(st.st_mode) && ftruncate(fd, (off_t)(im.total_sectors * WMIMAGE_SECTOR)) != 0) ||
+        wmimage_write(&im, fd) != 0 || fsync(fd) != 0) {
+        fprintf(stderr, "wmimage: cannot write %s\n", output);
+        close(fd);
+        remove(index_tmp);
+        return 1;
+    }
+    close(fd);
+    remove(index_tmp);
+
+    uint64_t audio, slack = wmimage_slack(&im, im.cluster_bytes, &audio);
+    printf("%s: FAT32, %u B clusters (%.2f%% slack on audio), %u of %u clusters used, %u files\n",
+           output, im.cluster_bytes, audio ? 100.0 * (double)slack / (double)audio : 0.0,
+           im.used_clusters, im.clusters, im.file_count + 1);
+
+    FILE* out = NULL;
+    if (report != NULL && (out = fopen(report, "w")) == NULL) {
+        fprintf(stderr, "wmimage: cannot create %s\n", report);
+    }
+    wmimage_report(&im, tracks, track_count, out);
+    if (out) fclose(out);
+    return 0;
+}
@@ -0,0 +1,464 @@
+/**
+ * Library Indexer - Host Tool
+ *
+ * Walks the music folder of a card (mounted, or its copy on the host),
+ * opens every WAV/WNF file with the firmware's decoders and writes the
+ * library index the player reads at boot (src/storage/library.h): format,
+ * duration and tags per track, tags in a deduplicated string pool.
+ *
+ * Files are opened on a pool of worker threads. Each worker owns a slice
+ * of the sorted file list and works through it from the front; a worker
+ * that runs dry steals the back half of the largest slice left, so a few
+ * long tracks do not hold up the rest. With -g, tracks whose container
+ * carries no gain (WAV) are decoded in full and measured as wnfpack does,
+ * which also catches files that are damaged past the header.
+ *
+ * Usage: wmindex [-j threads] [-g] [-d folder] [-o index] card_root
+ *   e.g. wmindex -g /media/sdcard   ->  /media/sdcard/music/LIBRARY.IDX
+ */
+
+#include "decoder.h"
+#include "library.h"
+#include "player.h"
+#include "loudness.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WMINDEX_MAX_THREADS 256
+#define WMINDEX_READ_FRAMES 4096
+#define WMINDEX_PATH_LEN 4096
+
+typedef struct {
+    char* host_path;
+    char* card_path;
+    int status;                     // decoder_status_t, or -1 if cut short
+    library_entry_t entry;          // String offsets filled when writing
+    char title[DECODER_TAG_LEN];
+    char artist[DECODER_TAG_LEN];
+    char album[DECODER_TAG_LEN];
+} wmindex_track_t;
+
+/* Slice of the track list owned by one worker: [next, end) */
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t next;
+    uint32_t end;
+    uint32_t steals;
+} wmindex_slice_t;
+
+typedef struct {
+    wmindex_track_t* tracks;
+    uint32_t count;
+    uint32_t capacity;
+    wmindex_slice_t* slices;
+    uint32_t workers;
+    int analyse;
+} wmindex_t;
+
+typedef struct {
+    wmindex_t* ix;
+    uint32_t id;
+} wmindex_worker_t;
+
+/* ============ Scan ============ */
+
+static int wmindex_is_audio(const char* name) {
+    const char* dot = strrchr(name, '.');
+    return dot != NULL && (strcasecmp(dot, ".wav") == 0 || strcasecmp(dot, ".wnf") == 0 ||
+                           strcasecmp(dot, ".dsf") == 0 || strcasecmp(dot, ".dff") == 0);
+}
+
+static void wmindex_add(wmindex_t* ix, const char* host_path, const char* card_path) {
+    if (ix->count == ix->capacity) {
+        ix->capacity = ix->capacity ? ix->capacity * 2 : 1024;
+        ix->tracks = realloc(ix->tracks, ix->capacity * sizeof(wmindex_track_t));
+        if (ix->tracks == NULL) {
+            fprintf(stderr, "wmindex: out of memory\n");
+            exit(1);
+        }
+    }
+    wmindex_track_t* t = &ix->tracks[ix->count++];
+    memset(t, 0, sizeof(*t));
+    t->host_path = strdup(host_path);
+    t->card_path = strdup(card_path);
+}
+
+/**
+ * Collect audio files below a folder (the listing itself is cheap next to
+ * opening every file, so it stays on one thread)
+ */
+static void wmindex_scan(wmindex_t* ix, const char* host_dir, const char* card_dir) {
+    char host_path[WMINDEX_PATH_LEN], card_path[WMINDEX_PATH_LEN];
+    struct dirent* de;
+    struct stat st;
+    DIR* dir = opendir(host_dir);
+
+    if (dir == NULL) {
+        fprintf(stderr, "wmindex: cannot open %s\n", host_dir);
+        return;
+    }
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_name[0] == '.') continue;
+        snprintf(host_path, sizeof(host_path), "%s/%s", host_dir, de->d_name);
+        snprintf(card_path, sizeof(card_path), "%s/%s", card_dir, de->d_name);
+        if (stat(host_path, &st) != 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            wmindex_scan(ix, host_path, card_path);
+        } else if (S_ISREG(st.st_mode) && wmindex_is_audio(de->d_name)) {
+            if (strlen(card_path) >= MAX_FILENAME_LEN) {
+                fprintf(stderr, "wmindex: %s: path too long for the player, skipped\n", card_path);
+                continue;
+            }
+            wmindex_add(ix, host_path, card_path);
+        }
+    }
+    closedir(dir);
+}
+
+static int wmindex_compare(const void* a, const void* b) {
+    return strcmp(((const wmindex_track_t*)a)->card_path, ((const wmindex_track_t*)b)->card_path);
+}
+
+/* ============ Workers ============ */
+
+/**
+ * Open one track with the firmware decoders and fill its entry
+ */
+static void wmindex_track(wmindex_t* ix, wmindex_track_t* t, decoder_t* dec, int16_t* pcm) {
+    library_entry_t* e = &t->entry;
+
+    t->status = decoder_open(dec, t->host_path);
+    if (t->status != DECODER_OK) {
+        return;
+    }
+
+    e->codec = (strcmp(dec->ops->name, "wnf") == 0) ? LIBRARY_CODEC_WNF : LIBRARY_CODEC_WAV;
+    e->channels = dec->channels;
+    e->bits_per_sample = dec->bits_per_sample;
+    e->sample_rate = dec->sample_rate;
+    e->total_frames = dec->total_frames;
+    e->duration_ms = (uint32_t)((uint64_t)dec->total_frames * 1000 / dec->sample_rate);
+    e->file_size = dec->file.size;
+    memcpy(t->title, dec->title, DECODER_TAG_LEN);
+    memcpy(t->artist, dec->artist, DECODER_TAG_LEN);
+    memcpy(t->album, dec->album, DECODER_TAG_LEN);
+
+    if (dec->replay_gain != 0 || dec->replay_peak != 0) {
+        e->replay_gain = dec->replay_gain;
+        e->replay_peak = dec->replay_peak;
+        e->flags |= LIBRARY_ENTRY_GAIN;
+    } else if (ix->analyse) {
+        loudness_t ld;
+        uint32_t frames = 0, n;
+
+        loudness_init(&ld, dec->sample_rate);
+        while ((n = decoder_read(dec, pcm, WMINDEX_READ_FRAMES)) > 0) {
+            loudness_add(&ld, pcm, n);
+            frames += n;
+        }
+        loudness_finish(&ld, &e->replay_gain, &e->replay_peak);
+        e->flags |= LIBRARY_ENTRY_GAIN;
+        if (frames < dec->total_frames) {
+            t->status = -1;
+        }
+    }
+
+    decoder_close(dec);
+}
+
+/**
+ * Next track for a worker: from its own slice, else stolen
+ */
+static int wmindex_next(wmindex_t* ix, uint32_t id, uint32_t* job) {
+    wmindex_slice_t* own = &ix->slices[id];
+
+    for (;;) {
+        pthread_mutex_lock(&own->lock);
+        if (own->next < own->end) {
+            *job = own->next++;
+            pthread_mutex_unlock(&own->lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&own->lock);
+
+        /* Largest slice left; the unlocked read is only a hint */
+        uint32_t victim = id, best = 0;
+        for (uint32_t i = 0; i < ix->workers; i++) {
+            uint32_t left = __atomic_load_n(&ix->slices[i].end, __ATOMIC_RELAXED) -
+                            __atomic_load_n(&ix->slices[i].next, __ATOMIC_RELAXED);
+            if (i != id && left > best && left <= ix->count) {
+                best = left;
+                victim = i;
+            }
+        }
+        if (victim == id) {
+            return 0;
+        }
+
+        wmindex_slice_t* v = &ix->slices[victim];
+        uint32_t from = 0, to = 0;
+        pthread_mutex_lock(&v->lock);
+        if (v->next < v->end) {
+            to = v->end;
+            from = v->end - (v->end - v->next + 1) / 2;
+            v->end = from;
+        }
+        pthread_mutex_unlock(&v->lock);
+        if (from == to) {
+            continue;   // Drained meanwhile, look again
+        }
+
+        pthread_mutex_lock(&own->lock);
+        own->next = from;
+        own->end = to;
+        own->steals++;
+        pthread_mutex_unlock(&own->lock);
+    }
+}
+
+static void* wmindex_worker(void* arg) {
+    wmindex_worker_t* w = (wmindex_worker_t*)arg;
+    decoder_t* dec = malloc(sizeof(decoder_t));
+    int16_t* pcm = malloc(WMINDEX_READ_FRAMES * 4);
+    uint32_t job;
+
+    if (dec == NULL || pcm == NULL) {
+        fprintf(stderr, "wmindex: out of memory\n");
+        exit(1);
+    }
+    while (wmindex_next(w->ix, w->id, &job)) {
+        wmindex_track(w->ix, &w->ix->tracks[job], dec, pcm);
+    }
+    free(dec);
+    free(pcm);
+    return NULL;
+}
+
+/* ============ Output ============ */
+
+typedef struct {
+    char* data;
+    uint32_t size;
+    uint32_t capacity;
+    uint32_t* slots;                // Offset + 1 of each hashed string, 0 = free
+    uint32_t slot_mask;
+} wmindex_pool_t;
+
+static uint32_t wmindex_hash(const char* s) {
+    uint32_t h = 2166136261u;       // FNV-1a
+    while (*s) {
+        h = (h ^ (uint8_t)*s++) * 16777619u;
+    }
+    return h;
+}
+
+static void wmindex_pool_init(wmindex_pool_t* pool, uint32_t strings) {
+    uint32_t slots = 64;
+    while (slots < strings * 2) slots *= 2;
+
+    memset(pool, 0, sizeof(*pool));
+    pool->slots = calloc(slots, sizeof(uint32_t));
+    pool->slot_mask = slots - 1;
+    pool->capacity = 65536;
+    pool->data = malloc(pool->capacity);
+    if (pool->slots == NULL || pool->data == NULL) {
+        fprintf(stderr, "wmindex: out of memory\n");
+        exit(1);
+    }
+    pool->data[0] = '\0';           // Offset 0: the empty string
+    pool->size = 1;
+}
+
+/**
+ * Offset of a string in the pool, added on first use
+ */
+static uint32_t wmindex_pool_add(wmindex_pool_t* pool, const char* s) {
+    uint32_t len = (uint32_t)strlen(s) + 1;
+    uint32_t slot;
+
+    if (len == 1) {
+        return 0;
+    }
+    for (slot = wmindex_hash(s) & pool->slot_mask; pool->slots[slot] != 0;
+         slot = (slot + 1) & pool->slot_mask) {
+        if (strcmp(pool->data + pool->slots[slot] - 1, s) == 0) {
+            return pool->slots[slot] - 1;
+        }
+    }
+
+    while (pool->size + len > pool->capacity) {
+        pool->capacity *= 2;
+        pool->data = realloc(pool->data, pool->capacity);
+        if (pool->data == NULL) {
+            fprintf(stderr, "wmindex: out of memory\n");
+            exit(1);
+        }
+    }
+    uint32_t offset = pool->size;
+    memcpy(pool->data + offset, s, len);
+    pool->size += len;
+    pool->slots[slot] = offset + 1;
+    return offset;
+}
+
+/**
+ * Write the index next to its final name and rename it into place, so the
+ * player never sees a half-written one
+ */
+static int wmindex_write(wmindex_t* ix, const char* path, uint32_t indexed) {
+    uint8_t hdr[LIBRARY_HEADER_BYTES], raw[LIBRARY_ENTRY_BYTES];
+    char tmp[WMINDEX_PATH_LEN + 8];
+    wmindex_pool_t pool;
+    library_t lib;
+
+    wmindex_pool_init(&pool, indexed * 4);
+    for (uint32_t i = 0; i < ix->count; i++) {
+        wmindex_track_t* t = &ix->tracks[i];
+        if (t->status != DECODER_OK) continue;
+        t->entry.path = wmindex_pool_add(&pool, t->card_path);
+        t->entry.title = wmindex_pool_add(&pool, t->title);
+        t->entry.artist = wmindex_pool_add(&pool, t->artist);
+        t->entry.album = wmindex_pool_add(&pool, t->album);
+    }
+
+    memset(&lib, 0, sizeof(lib));
+    lib.track_count = indexed;
+    lib.strings_offset = LIBRARY_HEADER_BYTES + indexed * LIBRARY_ENTRY_BYTES;
+    lib.strings_size = pool.size;
+    lib.flags = ix->analyse ? LIBRARY_FLAG_ANALYSED : 0;
+    library_header_write(&lib, hdr);
+
+    if (strlen(path) >= WMINDEX_PATH_LEN) {
+        fprintf(stderr, "wmindex: index path too long\n");
+        return -1;
+    }
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* f = fopen(tmp, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "wmindex: cannot create %s\n", tmp);
+        return -1;
+    }
+    fwrite(hdr, 1, sizeof(hdr), f);
+    for (uint32_t i = 0; i < ix->count; i++) {
+        if (ix->tracks[i].status != DECODER_OK) continue;
+        library_entry_write(&ix->tracks[i].entry, raw);
+        fwrite(raw, 1, sizeof(raw), f);
+    }
+    fwrite(pool.data, 1, pool.size, f);
+
+    int status = (ferror(f) | fclose(f)) ? -1 : 0;
+    if (status == 0 && rename(tmp, path) != 0) status = -1;
+    if (status != 0) {
+        fprintf(stderr, "wmindex: cannot write %s\n", path);
+        remove(tmp);
+    }
+    free(pool.data);
+    free(pool.slots);
+    return status;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: wmindex [-j threads] [-g] [-d folder] [-o index] card_root\n"
+            "  -j  worker threads (default: online CPUs)\n"
+            "  -g  measure gain of tracks without one (decodes them in full)\n"
+            "  -d  music folder on the card (default /music)\n"
+            "  -o  index path (default <card_root><folder>/" LIBRARY_INDEX_NAME ")\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    static const char* const errors[] = {
+        [DECODER_ERROR] = "unreadable",
+        [DECODER_ERROR_NO_FILE] = "cannot open",
+        [DECODER_ERROR_UNSUPPORTED] = "unsupported format",
+    };
+    pthread_t threads[WMINDEX_MAX_THREADS];
+    wmindex_worker_t workers[WMINDEX_MAX_THREADS];
+    const char* folder = "/music";
+    const char* output = NULL;
+    char host_dir[WMINDEX_PATH_LEN], index_path[WMINDEX_PATH_LEN + 16];
+    struct timespec t0, t1;
+    wmindex_t ix;
+    long threads_wanted = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    memset(&ix, 0, sizeof(ix));
+    while ((opt = getopt(argc, argv, "j:gd:o:h")) != -1) {
+        switch (opt) {
+            case 'j': threads_wanted = strtol(optarg, NULL, 10); break;
+            case 'g': ix.analyse = 1; break;
+            case 'd': folder = optarg; break;
+            case 'o': output = optarg; break;
+            default: usage();
+        }
+    }
+    if (argc - optind != 1 || folder[0] != '/') usage();
+    if (threads_wanted < 1) threads_wanted = 1;
+    if (threads_wanted > WMINDEX_MAX_THREADS) threads_wanted = WMINDEX_MAX_THREADS;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    snprintf(host_dir, sizeof(host_dir), "%s%s", argv[optind], folder);
+    wmindex_scan(&ix, host_dir, folder);
+    qsort(ix.tracks, ix.count, sizeof(wmindex_track_t), wmindex_compare);
+
+    /* Even slices to start with; stealing evens out the rest */
+    ix.workers = (uint32_t)threads_wanted;
+    if (ix.workers > ix.count) ix.workers = ix.count ? ix.count : 1;
+    ix.slices = calloc(ix.workers, sizeof(wmindex_slice_t));
+    for (uint32_t i = 0; i < ix.workers; i++) {
+        pthread_mutex_init(&ix.slices[i].lock, NULL);
+        ix.slices[i].next = (uint32_t)((uint64_t)ix.count * i / ix.workers);
+        ix.slices[i].end = (uint32_t)((uint64_t)ix.count * (i + 1) / ix.workers);
+    }
+    for (uint32_t i = 0; i < ix.workers; i++) {
+        workers[i].ix = &ix;
+        workers[i].id = i;
+        pthread_create(&threads[i], NULL, wmindex_worker, &workers[i]);
+    }
+    uint32_t steals = 0;
+    for (uint32_t i = 0; i < ix.workers; i++) {
+        pthread_join(threads[i], NULL);
+        steals += ix.slices[i].steals;
+    }
+
+    uint32_t indexed = 0;
+    for (uint32_t i = 0; i < ix.count; i++) {
+        wmindex_track_t* t = &ix.tracks[i];
+        if (t->status == DECODER_OK) {
+            indexed++;
+        } else {
+            fprintf(stderr, "wmindex: %s: %s, skipped\n", t->card_path,
+                    t->status < 0 ? "shorter than its header says" : errors[t->status]);
+        }
+    }
+
+    if (output == NULL) {
+        snprintf(index_path, sizeof(index_path), "%s/%s", host_dir, LIBRARY_INDEX_NAME);
+        output = index_path;
+    }
+    if (wmindex_write(&ix, output, indexed) != 0) return 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%s: %u tracks, %u skipped, %u ms on %u threads (%u steals)\n",
+           output, indexed, ix.count - indexed,
+           (unsigned)((t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_nsec - t0.tv_nsec) / 1000000),
+           ix.workers, steals);
+
+    for (uint32_t i = 0; i < ix.count; i++) {
+        free(ix.tracks[i].host_path);
+        free(ix.tracks[i].card_path);
+    }
+    free(ix.tracks);
+    free(ix.slices);
+    return 0;
+}
@@ -0,0 +1,839 @@
+/**
+ * WNF Batch Transcoder - Host Tool
+ *
+ * Converts a music tree into WNF files (src/audio/wnf.h) for the card,
+ * the batch counterpart of wnfpack. Each of the -j lanes runs three
+ * threads joined by bounded chunk queues:
+ *
+ *   decode   -> firmware WAV decoders, or ffmpeg as a pipe for anything
+ *               else (24/32-bit samples requantized with the firmware's
+ *               TPDF dither kernel)
+ *   resample -> firmware polyphase converter to the output rate, trimmed
+ *               to the source length like wnfpack
+ *   encode   -> shared WNF writer (tools/wnfwrite.c)
+ *
+ * so decoding, filtering and encoding of neighbouring files overlap and a
+ * slow stage only holds up its own lane. A 16-bit WAV comes out with the
+ * same audio and gain as from wnfpack.
+ *
+ * Sources whose content hash and options match the manifest in the output
+ * folder (.wnfbatch) are skipped when their output is still there.
+ *
+ * Usage: wnfbatch [-j lanes] [-c pcm|adpcm] [-r rate] [-f] input_dir output_dir
+ */
+
+#include "wnfwrite.h"
+#include "decoder.h"
+#include "resample.h"
+#include "dsp.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WNFBATCH_MAX_LANES 64
+#define WNFBATCH_CHUNK_FRAMES 4096
+#define WNFBATCH_QUEUE_DEPTH 8          // Chunks between two stages
+#define WNFBATCH_PATH_LEN 4096
+#define WNFBATCH_MANIFEST ".wnfbatch"
+#define WNFBATCH_DITHER_SEED 1          // Same output on every run
+
+typedef enum {
+    WNFBATCH_PENDING = 0,
+    WNFBATCH_DONE,
+    WNFBATCH_SKIPPED,
+    WNFBATCH_FAILED
+} wnfbatch_result_t;
+
+typedef struct {
+    char* src_path;
+    char* rel_path;                     // Below input_dir, source extension
+    char out_path[WNFBATCH_PATH_LEN];
+    uint64_t hash;                      // FNV-1a of the source bytes
+    uint64_t src_bytes;
+    wnfbatch_result_t result;
+    const char* error;
+
+    /* Set by the decode stage before its START chunk */
+    uint32_t sample_rate;
+    uint8_t channels;
+    char title[WNF_TAG_LEN];
+    char artist[WNF_TAG_LEN];
+    char album[WNF_TAG_LEN];
+} wnfbatch_job_t;
+
+typedef enum {
+    WNFBATCH_START = 0,
+    WNFBATCH_DATA,
+    WNFBATCH_END,
+    WNFBATCH_FAIL,
+    WNFBATCH_QUIT                       // No more jobs for this lane
+} wnfbatch_kind_t;
+
+typedef struct {
+    wnfbatch_job_t* job;
+    uint8_t kind;
+    uint32_t frames;
+    int16_t pcm[];                      // Stereo frames
+} wnfbatch_chunk_t;
+
+/* Bounded queue: a full queue blocks the stage before it */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    wnfbatch_chunk_t* items[WNFBATCH_QUEUE_DEPTH];
+    uint32_t head;
+    uint32_t count;
+} wnfbatch_queue_t;
+
+typedef struct {
+    char* rel_path;
+    uint64_t hash;
+    uint32_t options;
+} wnfbatch_manifest_entry_t;
+
+typedef struct {
+    wnfbatch_job_t* jobs;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t next_job;                  // Atomic
+    uint8_t codec;
+    uint32_t rate;                      // 0: keep 44.1/48 kHz, else 44.1 kHz
+    int force;
+    const char* input_dir;
+    const char* output_dir;
+    wnfbatch_manifest_entry_t* manifest;
+    uint32_t manifest_count;
+} wnfbatch_t;
+
+typedef struct {
+    wnfbatch_t* batch;
+    wnfbatch_queue_t decoded;
+    wnfbatch_queue_t resampled;
+    pthread_t threads[3];
+} wnfbatch_lane_t;
+
+/* ============ Queues ============ */
+
+static void wnfbatch_queue_init(wnfbatch_queue_t* q) {
+    memset(q, 0, sizeof(*q));
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+}
+
+static void wnfbatch_queue_push(wnfbatch_queue_t* q, wnfbatch_chunk_t* chunk) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == WNFBATCH_QUEUE_DEPTH) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    q->items[(q->head + q->count++) % WNFBATCH_QUEUE_DEPTH] = chunk;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static wnfbatch_chunk_t* wnfbatch_queue_pop(wnfbatch_queue_t* q) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    wnfbatch_chunk_t* chunk = q->items[q->head];
+    q->head = (q->head + 1) % WNFBATCH_QUEUE_DEPTH;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return chunk;
+}
+
+static wnfbatch_chunk_t* wnfbatch_chunk(wnfbatch_job_t* job, uint8_t kind, uint32_t capacity) {
+    wnfbatch_chunk_t* chunk = malloc(sizeof(wnfbatch_chunk_t) + (size_t)capacity * 4);
+    if (chunk == NULL) {
+        fprintf(stderr, "wnfbatch: out of memory\n");
+        exit(1);
+    }
+    chunk->job = job;
+    chunk->kind = kind;
+    chunk->frames = 0;
+    return chunk;
+}
+
+static void wnfbatch_send(wnfbatch_queue_t* q, wnfbatch_job_t* job, uint8_t kind) {
+    wnfbatch_queue_push(q, wnfbatch_chunk(job, kind, 0));
+}
+
+/* ============ Sources ============ */
+
+typedef struct {
+    decoder_t* dec;                     // Firmware decoders
+    FILE* pipe;                         // ffmpeg, WAV on stdout
+    pid_t pid;
+    uint8_t bytes;                      // Bytes per sample in the pipe
+    uint32_t seed;                      // Dither state
+    int32_t* q31;
+    uint8_t* raw;
+} wnfbatch_source_t;
+
+static uint32_t wnfbatch_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wnfbatch_tag(char* dst, const uint8_t* src, uint32_t len) {
+    if (len >= WNF_TAG_LEN) len = WNF_TAG_LEN - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+/**
+ * Header of the WAV stream ffmpeg writes to the pipe: format and the
+ * LIST/INFO tags it maps from the source metadata, up to the data chunk
+ */
+static int wnfbatch_pipe_header(wnfbatch_source_t* src, wnfbatch_job_t* job) {
+    uint8_t hdr[12], chunk[8], body[1024];
+
+    if (fread(hdr, 1, 12, src->pipe) != 12 ||
+        memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+        return -1;
+    }
+    while (fread(chunk, 1, 8, src->pipe) == 8) {
+        uint32_t len = wnfbatch_le32(chunk + 4);
+        if (memcmp(chunk, "data", 4) == 0) {
+            return (job->sample_rate != 0 && src->bytes != 0) ? 0 : -1;
+        }
+        uint32_t keep = len < sizeof(body) ? len : sizeof(body);
+        if (fread(body, 1, keep, src->pipe) != keep) return -1;
+        for (uint32_t skip = len - keep + (len & 1); skip > 0; skip--) {
+            if (fgetc(src->pipe) == EOF) return -1;
+        }
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && keep >= 16) {
+            uint16_t channels = (uint16_t)(body[2] | (body[3] << 8));
+            uint16_t bits = (uint16_t)(body[14] | (body[15] << 8));
+            if (channels < 1 || channels > 2 || (bits != 16 && bits != 32)) return -1;
+            job->channels = (uint8_t)channels;
+            job->sample_rate = wnfbatch_le32(body + 4);
+            src->bytes = (uint8_t)(bits / 8);
+        } else if (memcmp(chunk, "LIST", 4) == 0 && keep >= 4 && memcmp(body, "INFO", 4) == 0) {
+            for (uint32_t ofs = 4; ofs + 8 <= keep;) {
+                uint32_t n = wnfbatch_le32(body + ofs + 4);
+                if (ofs + 8 + n > keep) break;
+                if (memcmp(body + ofs, "INAM", 4) == 0) wnfbatch_tag(job->title, body + ofs + 8, n);
+                else if (memcmp(body + ofs, "IART", 4) == 0) wnfbatch_tag(job->artist, body + ofs + 8, n);
+                else if (memcmp(body + ofs, "IPRD", 4) == 0) wnfbatch_tag(job->album, body + ofs + 8, n);
+                ofs += 8 + n + (n & 1);
+            }
+        }
+    }
+    return -1;
+}
+
+static int wnfbatch_pipe_open(wnfbatch_source_t* src, wnfbatch_job_t* job) {
+    int fds[2];
+
+    if (pipe(fds) != 0) return -1;
+    src->pid = fork();
+    if (src->pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (src->pid == 0) {
+        /* Decode only: keep the rate, at most stereo, 32-bit samples */
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execlp("ffmpeg", "ffmpeg", "-v", "error", "-nostdin", "-i", job->src_path,
+               "-map", "0:a:0", "-af", "aformat=channel_layouts=mono|stereo",
+               "-c:a", "pcm_s32le", "-f", "wav", "-", (char*)NULL);
+        _exit(127);
+    }
+    close(fds[1]);
+    src->pipe = fdopen(fds[0], "rb");
+    src->q31 = malloc(WNFBATCH_CHUNK_FRAMES * 2 * sizeof(int32_t));
+    src->raw = malloc(WNFBATCH_CHUNK_FRAMES * 2 * 4);
+    src->seed = WNFBATCH_DITHER_SEED;
+    if (src->pipe == NULL || src->q31 == NULL || src->raw == NULL) return -1;
+    return wnfbatch_pipe_header(src, job);
+}
+
+/**
+ * Open a source: WAV and DSD through the firmware decoders, the rest (and
+ * files they do not take, e.g. 24-bit WAV) through ffmpeg
+ */
+static int wnfbatch_source_open(wnfbatch_source_t* src, wnfbatch_job_t* job) {
+    const char* dot = strrchr(job->src_path, '.');
+
+    memset(src, 0, sizeof(*src));
+    if (dot != NULL && (strcasecmp(dot, ".wav") == 0 || strcasecmp(dot, ".dsf") == 0 ||
+                        strcasecmp(dot, ".dff") == 0)) {
+        src->dec = malloc(sizeof(decoder_t));
+        if (src->dec != NULL && decoder_open(src->dec, job->src_path) == DECODER_OK) {
+            job->sample_rate = src->dec->sample_rate;
+            job->channels = src->dec->channels;
+            memcpy(job->title, src->dec->title, WNF_TAG_LEN);
+            memcpy(job->artist, src->dec->artist, WNF_TAG_LEN);
+            memcpy(job->album, src->dec->album, WNF_TAG_LEN);
+            return 0;
+        }
+        free(src->dec);
+        src->dec = NULL;
+    }
+    return wnfbatch_pipe_open(src, job);
+}
+
+static uint32_t wnfbatch_source_read(wnfbatch_source_t* src, uint8_t channels,
+                                     int16_t* out, uint32_t frames) {
+    if (src->dec != NULL) {
+        return decoder_read(src->dec, out, frames);
+    }
+
+    uint32_t frame_bytes = src->bytes * channels;
+    uint32_t n = (uint32_t)fread(src->raw, frame_bytes, frames, src->pipe);
+    uint32_t exact = 1;
+
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t c = 0; c < 2; c++) {
+            const uint8_t* s = src->raw + i * frame_bytes + (c < channels ? c : 0) * src->bytes;
+            int32_t v = (src->bytes == 4) ? (int32_t)wnfbatch_le32(s) : (int32_t)((uint32_t)s[0] << 16 | (uint32_t)s[1] << 24);
+            src->q31[2 * i + c] = v;
+            exact &= (v & 0xFFFF) == 0;
+        }
+    }
+    /* 16-bit content passes unchanged; finer samples get dithered */
+    if (exact) {
+        dsp_round_q31_to_s16(src->q31, out, n * 2);
+    } else {
+        dsp_dither_q31_to_s16(src->q31, out, n * 2, &src->seed);
+    }
+    return n;
+}
+
+/* 0 if the whole stream was read */
+static int wnfbatch_source_close(wnfbatch_source_t* src) {
+    int status = 0;
+
+    if (src->dec != NULL) {
+        decoder_close(src->dec);
+        free(src->dec);
+    }
+    if (src->pipe != NULL) {
+        int exited;
+        fclose(src->pipe);
+        waitpid(src->pid, &exited, 0);
+        status = (WIFEXITED(exited) && WEXITSTATUS(exited) == 0) ? 0 : -1;
+    } else if (src->pid > 0) {
+        waitpid(src->pid, NULL, 0);
+        status = -1;
+    }
+    free(src->q31);
+    free(src->raw);
+    return status;
+}
+
+/* ============ Manifest ============ */
+
+static uint32_t wnfbatch_options(const wnfbatch_t* batch) {
+    return batch->rate << 1 | batch->codec;
+}
+
+static int wnfbatch_manifest_compare(const void* a, const void* b) {
+    return strcmp(((const wnfbatch_manifest_entry_t*)a)->rel_path,
+                  ((const wnfbatch_manifest_entry_t*)b)->rel_path);
+}
+
+static void wnfbatch_manifest_load(wnfbatch_t* batch) {
+    char path[WNFBATCH_PATH_LEN], line[WNFBATCH_PATH_LEN + 64];
+    uint32_t capacity = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", batch->output_dir, WNFBATCH_MANIFEST);
+    FILE* f = fopen(path, "r");
+    if (f == NULL) return;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        unsigned long long hash;
+        unsigned options;
+        int ofs;
+        line[strcspn(line, "\n")] = '\0';
+        if (sscanf(line, "%16llx %x %n", &hash, &options, &ofs) != 2) continue;
+
+        if (batch->manifest_count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            batch->manifest = realloc(batch->manifest, capacity * sizeof(wnfbatch_manifest_entry_t));
+        }
+        wnfbatch_manifest_entry_t* e = &batch->manifest[batch->manifest_count++];
+        e->rel_path = strdup(line + ofs);
+        e->hash = hash;
+        e->options = options;
+    }
+    fclose(f);
+    qsort(batch->manifest, batch->manifest_count, sizeof(wnfbatch_manifest_entry_t),
+          wnfbatch_manifest_compare);
+}
+
+static int wnfbatch_manifest_save(const wnfbatch_t* batch) {
+    char path[WNFBATCH_PATH_LEN];
+
+    snprintf(path, sizeof(path), "%s/%s", batch->output_dir, WNFBATCH_MANIFEST);
+    FILE* f = fopen(path, "w");
+    if (f == NULL) return -1;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        const wnfbatch_job_t* job = &batch->jobs[i];
+        if (job->result == WNFBATCH_DONE || job->result == WNFBATCH_SKIPPED) {
+            fprintf(f, "%016llx %x %s\n", (unsigned long long)job->hash,
+                    wnfbatch_options(batch), job->rel_path);
+        }
+    }
+    return (ferror(f) | fclose(f)) ? -1 : 0;
+}
+
+static int wnfbatch_unchanged(const wnfbatch_t* batch, const wnfbatch_job_t* job) {
+    wnfbatch_manifest_entry_t key = {.rel_path = job->rel_path};
+    const wnfbatch_manifest_entry_t* e;
+    struct stat st;
+
+    e = bsearch(&key, batch->manifest, batch->manifest_count,
+                sizeof(wnfbatch_manifest_entry_t), wnfbatch_manifest_compare);
+    return e != NULL && e->hash == job->hash && e->options == wnfbatch_options(batch) &&
+           stat(job->out_path, &st) == 0;
+}
+
+static int wnfbatch_hash(wnfbatch_job_t* job) {
+    static const size_t block = 1 << 16;
+    uint8_t* buf = malloc(block);
+    uint64_t h = 14695981039346656037ull;
+    size_t n;
+    FILE* f = fopen(job->src_path, "rb");
+
+    if (f == NULL || buf == NULL) {
+        if (f) fclose(f);
+        free(buf);
+        return -1;
+    }
+    job->src_bytes = 0;
+    while ((n = fread(buf, 1, block, f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            h = (h ^ buf[i]) * 1099511628211ull;
+        }
+        job->src_bytes += n;
+    }
+    fclose(f);
+    free(buf);
+    job->hash = h;
+    return 0;
+}
+
+/* ============ Stages ============ */
+
+static wnfbatch_job_t* wnfbatch_next_job(wnfbatch_t* batch) {
+    uint32_t i = __atomic_fetch_add(&batch->next_job, 1, __ATOMIC_RELAXED);
+    return i < batch->count ? &batch->jobs[i] : NULL;
+}
+
+static void* wnfbatch_decode_stage(void* arg) {
+    wnfbatch_lane_t* lane = (wnfbatch_lane_t*)arg;
+    wnfbatch_t* batch = lane->batch;
+    wnfbatch_job_t* job;
+    wnfbatch_source_t src;
+
+    while ((job = wnfbatch_next_job(batch)) != NULL) {
+        if (wnfbatch_hash(job) != 0) {
+            job->result = WNFBATCH_FAILED;
+            job->error = "cannot read";
+            continue;
+        }
+        if (!batch->force && wnfbatch_unchanged(batch, job)) {
+            job->result = WNFBATCH_SKIPPED;
+            continue;
+        }
+
+        if (wnfbatch_source_open(&src, job) != 0) {
+            wnfbatch_source_close(&src);
+            job->result = WNFBATCH_FAILED;
+            job->error = "cannot decode (ffmpeg needed for this format)";
+            continue;
+        }
+        wnfbatch_send(&lane->decoded, job, WNFBATCH_START);
+
+        for (;;) {
+            wnfbatch_chunk_t* chunk = wnfbatch_chunk(job, WNFBATCH_DATA, WNFBATCH_CHUNK_FRAMES);
+            chunk->frames = wnfbatch_source_read(&src, job->channels, chunk->pcm, WNFBATCH_CHUNK_FRAMES);
+            if (chunk->frames == 0) {
+                free(chunk);
+                break;
+            }
+            wnfbatch_queue_push(&lane->decoded, chunk);
+        }
+
+        if (wnfbatch_source_close(&src) != 0) {
+            job->error = "decoder failed";
+            wnfbatch_send(&lane->decoded, job, WNFBATCH_FAIL);
+        } else {
+            wnfbatch_send(&lane->decoded, job, WNFBATCH_END);
+        }
+    }
+
+    wnfbatch_send(&lane->decoded, NULL, WNFBATCH_QUIT);
+    return NULL;
+}
+
+/**
+ * Output frames of the resampler that belong to the track: the filter
+ * delay is dropped and the length capped at in_frames * out / in, as
+ * wnfpack does (the cap follows the input read so far until the end)
+ */
+typedef struct {
+    resample_t rs;
+    uint8_t active;
+    uint32_t delay;                     // Output frames still to drop
+    uint64_t in_frames;
+    uint64_t out_frames;
+    int16_t* pending;                   // Produced beyond the current cap
+    uint32_t pending_frames;
+    uint32_t pending_capacity;
+} wnfbatch_resampler_t;
+
+static void wnfbatch_resample_emit(wnfbatch_resampler_t* r, wnfbatch_queue_t* out,
+                                   wnfbatch_job_t* job, uint64_t limit) {
+    uint32_t n = r->pending_frames;
+
+    if (r->out_frames + n > limit) n = (uint32_t)(limit - r->out_frames);
+    if (n == 0) return;
+
+    wnfbatch_chunk_t* chunk = wnfbatch_chunk(job, WNFBATCH_DATA, n);
+    memcpy(chunk->pcm, r->pending, (size_t)n * 4);
+    chunk->frames = n;
+    memmove(r->pending, &r->pending[n * 2], (size_t)(r->pending_frames - n) * 4);
+    r->pending_frames -= n;
+    r->out_frames += n;
+    wnfbatch_queue_push(out, chunk);
+}
+
+/* Append produced frames, dropping the filter delay first */
+static void wnfbatch_resample_keep(wnfbatch_resampler_t* r, const int16_t* pcm, uint32_t frames) {
+    uint32_t drop = frames < r->delay ? frames : r->delay;
+
+    r->delay -= drop;
+    pcm += drop * 2;
+    frames -= drop;
+    if (r->pending_frames + frames > r->pending_capacity) {
+        r->pending_capacity = (r->pending_frames + frames) * 2;
+        r->pending = realloc(r->pending, (size_t)r->pending_capacity * 4);
+        if (r->pending == NULL) {
+            fprintf(stderr, "wnfbatch: out of memory\n");
+            exit(1);
+        }
+    }
+    memcpy(&r->pending[r->pending_frames * 2], pcm, (size_t)frames * 4);
+    r->pending_frames += frames;
+}
+
+static uint32_t wnfbatch_output_rate(const wnfbatch_t* batch, uint32_t in_rate) {
+    if (batch->rate != 0) return batch->rate;
+    return (in_rate == 44100 || in_rate == 48000) ? in_rate : 44100;
+}
+
+static void* wnfbatch_resample_stage(void* arg) {
+    wnfbatch_lane_t* lane = (wnfbatch_lane_t*)arg;
+    wnfbatch_resampler_t* r = calloc(1, sizeof(wnfbatch_resampler_t));
+    int16_t* out = NULL;
+    uint32_t out_capacity = 0;
+
+    for (;;) {
+        wnfbatch_chunk_t* chunk = wnfbatch_queue_pop(&lane->decoded);
+        wnfbatch_job_t* job = chunk->job;
+        uint32_t rate = job ? wnfbatch_output_rate(lane->batch, job->sample_rate) : 0;
+
+        switch (chunk->kind) {
+            case WNFBATCH_START:
+                r->active = (job->sample_rate != rate);
+                r->in_frames = r->out_frames = 0;
+                r->pending_frames = 0;
+                if (r->active && resample_init(&r->rs, job->sample_rate, rate) != RESAMPLE_OK) {
+                    job->error = "unsupported sample rate";
+                    chunk->kind = WNFBATCH_FAIL;
+                    r->active = 0;
+                    break;
+                }
+                if (r->active) {
+                    r->delay = RESAMPLE_TAPS / 2 * rate / job->sample_rate;
+                    out_capacity = resample_max_output(&r->rs, WNFBATCH_CHUNK_FRAMES) + RESAMPLE_TAPS;
+                    out = realloc(out, (size_t)out_capacity * 4);
+                }
+                job->sample_rate = rate;    // What the encoder sees
+                break;
+
+            case WNFBATCH_DATA:
+                if (!r->active) break;
+                for (uint32_t pos = 0; pos < chunk->frames;) {
+                    uint32_t consumed = 0;
+                    uint32_t n = resample_process(&r->rs, &chunk->pcm[pos * 2], chunk->frames - pos,
+                                                  &consumed, out, out_capacity);
+                    wnfbatch_resample_keep(r, out, n);
+                    pos += consumed;
+                }
+                r->in_frames += chunk->frames;
+                wnfbatch_resample_emit(r, &lane->resampled, job,
+                                       r->in_frames * r->rs.out_rate / r->rs.in_rate);
+                free(chunk);
+                continue;
+
+            case WNFBATCH_END:
+                if (!r->active) break;
+                for (uint32_t n; (n = resample_flush(&r->rs, out, out_capacity)) > 0;) {
+                    wnfbatch_resample_keep(r, out, n);
+                }
+                wnfbatch_resample_emit(r, &lane->resampled, job,
+                                       r->in_frames * r->rs.out_rate / r->rs.in_rate);
+                break;
+
+            default:
+                break;
+        }
+
+        uint8_t quit = (chunk->kind == WNFBATCH_QUIT);
+        wnfbatch_queue_push(&lane->resampled, chunk);
+        if (quit) break;
+    }
+
+    free(r->pending);
+    free(r);
+    free(out);
+    return NULL;
+}
+
+static int wnfbatch_mkdirs(const char* file_path) {
+    char dir[WNFBATCH_PATH_LEN];
+
+    snprintf(dir, sizeof(dir), "%s", file_path);
+    for (char* p = dir + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(dir, 0755) != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    return 0;
+}
+
+static void* wnfbatch_encode_stage(void* arg) {
+    wnfbatch_lane_t* lane = (wnfbatch_lane_t*)arg;
+    char tmp[WNFBATCH_PATH_LEN + 8];
+    wnf_writer_t writer;
+    uint8_t open = 0;
+
+    for (;;) {
+        wnfbatch_chunk_t* chunk = wnfbatch_queue_pop(&lane->resampled);
+        wnfbatch_job_t* job = chunk->job;
+        uint8_t kind = chunk->kind;
+
+        if (kind == WNFBATCH_START) {
+            snprintf(tmp, sizeof(tmp), "%s.tmp", job->out_path);
+            open = (wnfbatch_mkdirs(job->out_path) == 0 &&
+                    wnf_writer_open(&writer, tmp, lane->batch->codec, job->channels,
+                                    job->sample_rate) == 0);
+            if (!open) job->error = "cannot create output";
+        } else if (kind == WNFBATCH_DATA && open) {
+            if (wnf_writer_write(&writer, chunk->pcm, chunk->frames) != 0) {
+                job->error = "write failed";
+            }
+        } else if (kind == WNFBATCH_END || kind == WNFBATCH_FAIL) {
+            if (open) {
+                /* Untagged sources are titled by file name, like wnfpack */
+                if (job->title[0] == '\0') {
+                    const char* base = strrchr(job->src_path, '/');
+                    snprintf(job->title, WNF_TAG_LEN, "%s", base ? base + 1 : job->src_path);
+                    char* dot = strrchr(job->title, '.');
+                    if (dot) *dot = '\0';
+                }
+                memcpy(writer.hdr.title, job->title, WNF_TAG_LEN);
+                memcpy(writer.hdr.artist, job->artist, WNF_TAG_LEN);
+                memcpy(writer.hdr.album, job->album, WNF_TAG_LEN);
+                if (wnf_writer_close(&writer) != 0 && job->error == NULL) {
+                    job->error = "write failed";
+                }
+                open = 0;
+            }
+            if (kind == WNFBATCH_END && job->error == NULL && rename(tmp, job->out_path) == 0) {
+                job->result = WNFBATCH_DONE;
+            } else {
+                if (job->error == NULL) job->error = "cannot rename output";
+                job->result = WNFBATCH_FAILED;
+                remove(tmp);
+            }
+        }
+
+        free(chunk);
+        if (kind == WNFBATCH_QUIT) break;
+    }
+    return NULL;
+}
+
+/* ============ Main ============ */
+
+static int wnfbatch_is_audio(const char* name) {
+    static const char* const exts[] = {".wav", ".mp3", ".flac", ".ogg", ".opus", ".m4a", ".aac", ".wma",
+                                       ".aiff", ".dsf", ".dff"};
+    const char* dot = strrchr(name, '.');
+
+    if (dot == NULL) return 0;
+    for (uint32_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+        if (strcasecmp(dot, exts[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+static void wnfbatch_scan(wnfbatch_t* batch, const char* dir_path, const char* rel_dir) {
+    char path[WNFBATCH_PATH_LEN], rel[WNFBATCH_PATH_LEN];
+    struct dirent* de;
+    struct stat st;
+    DIR* dir = opendir(dir_path);
+
+    if (dir == NULL) return;
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir_path, de->d_name);
+        snprintf(rel, sizeof(rel), "%s%s%s", rel_dir, rel_dir[0] ? "/" : "", de->d_name);
+        if (stat(path, &st) != 0) continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            wnfbatch_scan(batch, path, rel);
+        } else if (S_ISREG(st.st_mode) && wnfbatch_is_audio(de->d_name)) {
+            if (batch->count == batch->capacity) {
+                batch->capacity = batch->capacity ? batch->capacity * 2 : 256;
+                batch->jobs = realloc(batch->jobs, batch->capacity * sizeof(wnfbatch_job_t));
+            }
+            wnfbatch_job_t* job = &batch->jobs[batch->count];
+            memset(job, 0, sizeof(*job));
+
+            /* Output mirrors the tree with a .wnf extension */
+            if (snprintf(job->out_path, sizeof(job->out_path), "%s/%s",
+                         batch->output_dir, rel) >= (int)sizeof(job->out_path)) {
+                fprintf(stderr, "wnfbatch: %s: path too long\n", rel);
+                continue;
+            }
+            job->src_path = strdup(path);
+            job->rel_path = strdup(rel);
+            batch->count++;
+            char* dot = strrchr(job->out_path, '.');
+            snprintf(dot, sizeof(job->out_path) - (size_t)(dot - job->out_path), ".wnf");
+        }
+    }
+    closedir(dir);
+}
+
+static double wnfbatch_seconds(struct timeval tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: wnfbatch [-j lanes] [-c pcm|adpcm] [-r rate] [-f] input_dir output_dir\n"
+            "  -j  parallel lanes of decode/resample/encode threads (default: online CPUs)\n"
+            "  -c  WNF codec (default pcm)\n"
+            "  -r  output rate (default: 44.1/48 kHz kept, others to 44.1 kHz)\n"
+            "  -f  convert even if the source is unchanged\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    static wnfbatch_lane_t lanes[WNFBATCH_MAX_LANES];
+    static void* (*const stages[3])(void*) = {
+        wnfbatch_decode_stage, wnfbatch_resample_stage, wnfbatch_encode_stage
+    };
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long lane_count = cpus;
+    struct timespec t0, t1;
+    struct rusage self0, children0, self, children;
+    wnfbatch_t batch;
+    int opt;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.codec = WNF_CODEC_PCM16;
+    while ((opt = getopt(argc, argv, "j:c:r:fh")) != -1) {
+        switch (opt) {
+            case 'j': lane_count = strtol(optarg, NULL, 10); break;
+            case 'c':
+                if (strcmp(optarg, "pcm") == 0) batch.codec = WNF_CODEC_PCM16;
+                else if (strcmp(optarg, "adpcm") == 0) batch.codec = WNF_CODEC_IMA_ADPCM;
+                else usage();
+                break;
+            case 'r': batch.rate = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'f': batch.force = 1; break;
+            default: usage();
+        }
+    }
+    if (argc - optind != 2) usage();
+    if (lane_count < 1) lane_count = 1;
+    if (lane_count > WNFBATCH_MAX_LANES) lane_count = WNFBATCH_MAX_LANES;
+    if (cpus < 1) cpus = 1;
+    batch.input_dir = argv[optind];
+    batch.output_dir = argv[optind + 1];
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    getrusage(RUSAGE_SELF, &self0);
+    getrusage(RUSAGE_CHILDREN, &children0);
+    if (mkdir(batch.output_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "wnfbatch: cannot create %s\n", batch.output_dir);
+        return 1;
+    }
+    wnfbatch_scan(&batch, batch.input_dir, "");
+    wnfbatch_manifest_load(&batch);
+    if ((uint32_t)lane_count > batch.count) lane_count = batch.count ? batch.count : 1;
+
+    for (long i = 0; i < lane_count; i++) {
+        lanes[i].batch = &batch;
+        wnfbatch_queue_init(&lanes[i].decoded);
+        wnfbatch_queue_init(&lanes[i].resampled);
+        for (int s = 0; s < 3; s++) {
+            pthread_create(&lanes[i].threads[s], NULL, stages[s], &lanes[i]);
+        }
+    }
+    for (long i = 0; i < lane_count; i++) {
+        for (int s = 0; s < 3; s++) {
+            pthread_join(lanes[i].threads[s], NULL);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    uint32_t done = 0, skipped = 0, failed = 0;
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < batch.count; i++) {
+        wnfbatch_job_t* job = &batch.jobs[i];
+        if (job->result == WNFBATCH_DONE) {
+            done++;
+            bytes += job->src_bytes;
+        } else if (job->result == WNFBATCH_SKIPPED) {
+            skipped++;
+        } else {
+            failed++;
+            fprintf(stderr, "wnfbatch: %s: %s\n", job->rel_path, job->error ? job->error : "failed");
+        }
+    }
+    if (wnfbatch_manifest_save(&batch) != 0) {
+        fprintf(stderr, "wnfbatch: cannot write the manifest\n");
+    }
+
+    /* CPU time of all threads and the ffmpeg decoders against wall time */
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    double cpu = wnfbatch_seconds(self.ru_utime) - wnfbatch_seconds(self0.ru_utime) +
+                 wnfbatch_seconds(self.ru_stime) - wnfbatch_seconds(self0.ru_stime) +
+                 wnfbatch_seconds(children.ru_utime) - wnfbatch_seconds(children0.ru_utime) +
+                 wnfbatch_seconds(children.ru_stime) - wnfbatch_seconds(children0.ru_stime);
+    if (wall <= 0.0) wall = 1e-9;
+
+    printf("%u converted, %u unchanged, %u failed in %.2f s: %.1f files/s, %.1f MB/s, "
+           "CPU %.0f%% of %ld cores (%ld lanes)\n",
+           done, skipped, failed, wall, done / wall, bytes / wall / 1e6,
+           100.0 * cpu / (wall * cpus), cpus, lane_count);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,261 @@
+/**
+ * WNF Packer - Host Tool
+ *
+ * Transcodes a 16-bit PCM WAV file into the Walkman Native Format
+ * (src/audio/wnf.h): resampled to the output rate with the firmware's
+ * polyphase converter, stereo PCM16 or IMA ADPCM blocks, tags from the
+ * command line or the WAV LIST/INFO chunk, and a ReplayGain-style track
+ * gain and peak.
+ *
+ * Usage: wnfpack [-c pcm|adpcm] [-r rate] [-t title] [-a artist]
+ *                [-l album] [-n track] input.wav output.wnf
+ *
+ * Other formats go through ffmpeg first:
+ *   ffmpeg -i song.mp3 -ac 2 -c:a pcm_s16le song.wav
+ */
+
+#include "wnfwrite.h"
+#include "resample.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t channels;
+    uint32_t frames;
+    int16_t* pcm;              // Interleaved stereo after loading
+    char title[WNF_TAG_LEN];
+    char artist[WNF_TAG_LEN];
+    char album[WNF_TAG_LEN];
+    uint16_t track_number;
+} wnfpack_audio_t;
+
+static uint16_t le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void copy_tag(char* dst, const uint8_t* src, uint32_t len) {
+    if (len >= WNF_TAG_LEN) len = WNF_TAG_LEN - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+/**
+ * Read the LIST/INFO sub-chunks we map onto WNF tags
+ */
+static void wav_parse_info(wnfpack_audio_t* audio, const uint8_t* p, uint32_t size) {
+    if (size < 4 || memcmp(p, "INFO", 4) != 0) return;
+
+    for (uint32_t ofs = 4; ofs + 8 <= size;) {
+        uint32_t len = le32(p + ofs + 4);
+        const uint8_t* text = p + ofs + 8;
+        if (ofs + 8 + len > size) break;
+
+        if (memcmp(p + ofs, "INAM", 4) == 0) copy_tag(audio->title, text, len);
+        else if (memcmp(p + ofs, "IART", 4) == 0) copy_tag(audio->artist, text, len);
+        else if (memcmp(p + ofs, "IPRD", 4) == 0) copy_tag(audio->album, text, len);
+        else if (memcmp(p + ofs, "ITRK", 4) == 0) audio->track_number = (uint16_t)atoi((const char*)text);
+
+        ofs += 8 + len + (len & 1);
+    }
+}
+
+/**
+ * Load a 16-bit PCM WAV file as interleaved stereo
+ */
+static int wav_load(wnfpack_audio_t* audio, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "wnfpack: cannot open %s\n", path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t* blob = malloc(size > 0 ? (size_t)size : 1);
+    if (blob == NULL || fread(blob, 1, (size_t)size, f) != (size_t)size) {
+        fclose(f);
+        free(blob);
+        return -1;
+    }
+    fclose(f);
+
+    if (size < 12 || memcmp(blob, "RIFF", 4) != 0 || memcmp(blob + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "wnfpack: %s is not a WAV file\n", path);
+        free(blob);
+        return -1;
+    }
+
+    const uint8_t* data = NULL;
+    uint32_t data_size = 0;
+    for (uint32_t ofs = 12; ofs + 8 <= (uint32_t)size;) {
+        const uint8_t* chunk = blob + ofs;
+        uint32_t len = le32(chunk + 4);
+        if (len > (uint32_t)size - ofs - 8) len = (uint32_t)size - ofs - 8;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && len >= 16) {
+            if (le16(chunk + 8) != 1 || le16(chunk + 22) != 16 ||
+                le16(chunk + 10) < 1 || le16(chunk + 10) > 2) {
+                fprintf(stderr, "wnfpack: %s: only 16-bit PCM mono/stereo is supported\n", path);
+                free(blob);
+                return -1;
+            }
+            audio->channels = (uint8_t)le16(chunk + 10);
+            audio->sample_rate = le32(chunk + 12);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            data_size = len;
+        } else if (memcmp(chunk, "LIST", 4) == 0) {
+            wav_parse_info(audio, chunk + 8, len);
+        }
+        ofs += 8 + len + (len & 1);
+    }
+
+    if (data == NULL || audio->channels == 0 || audio->sample_rate == 0) {
+        fprintf(stderr, "wnfpack: %s: missing fmt or data chunk\n", path);
+        free(blob);
+        return -1;
+    }
+
+    audio->frames = data_size / (2u * audio->channels);
+    audio->pcm = malloc((size_t)audio->frames * 4 + 4);
+    for (uint32_t i = 0; i < audio->frames; i++) {
+        const uint8_t* s = data + (size_t)i * 2 * audio->channels;
+        audio->pcm[2 * i] = (int16_t)le16(s);
+        audio->pcm[2 * i + 1] = (int16_t)le16(s + 2 * (audio->channels - 1));
+    }
+
+    free(blob);
+    return 0;
+}
+
+/**
+ * Convert the stereo PCM to out_rate with the firmware resampler
+ */
+static int resample_audio(wnfpack_audio_t* audio, uint32_t out_rate) {
+    static resample_t rs;
+
+    if (audio->sample_rate == out_rate) return 0;
+    if (resample_init(&rs, audio->sample_rate, out_rate) != RESAMPLE_OK) {
+        fprintf(stderr, "wnfpack: cannot resample %u Hz to %u Hz\n",
+                audio->sample_rate, out_rate);
+        return -1;
+    }
+
+    uint32_t capacity = resample_max_output(&rs, audio->frames) + RESAMPLE_TAPS;
+    int16_t* out = malloc((size_t)capacity * 4);
+    uint32_t produced = 0, pos = 0;
+
+    while (pos < audio->frames) {
+        uint32_t consumed = 0;
+        produced += resample_process(&rs, &audio->pcm[pos * 2], audio->frames - pos, &consumed,
+                                     &out[produced * 2], capacity - produced);
+        pos += consumed;
+    }
+    uint32_t n;
+    while ((n = resample_flush(&rs, &out[produced * 2], capacity - produced)) > 0) {
+        produced += n;
+    }
+
+    /* Drop the filter delay so the track keeps its length and start */
+    uint32_t delay = RESAMPLE_TAPS / 2 * out_rate / audio->sample_rate;
+    uint32_t frames = (uint32_t)((uint64_t)audio->frames * out_rate / audio->sample_rate);
+    if (delay + frames > produced) frames = produced > delay ? produced - delay : 0;
+    memmove(out, &out[delay * 2], (size_t)frames * 4);
+
+    free(audio->pcm);
+    audio->pcm = out;
+    audio->frames = frames;
+    audio->sample_rate = out_rate;
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: wnfpack [-c pcm|adpcm] [-r rate] [-t title] [-a artist]\n"
+            "               [-l album] [-n track] input.wav output.wnf\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    wnfpack_audio_t audio;
+    wnf_writer_t writer;
+    wnf_header_t* hdr;
+    uint8_t codec = WNF_CODEC_PCM16;
+    const char *title = NULL, *artist = NULL, *album = NULL;
+    uint32_t out_rate = 0;
+    int track = -1;
+    int opt;
+
+    memset(&audio, 0, sizeof(audio));
+
+    while ((opt = getopt(argc, argv, "c:r:t:a:l:n:h")) != -1) {
+        switch (opt) {
+            case 'c':
+                if (strcmp(optarg, "pcm") == 0) codec = WNF_CODEC_PCM16;
+                else if (strcmp(optarg, "adpcm") == 0) codec = WNF_CODEC_IMA_ADPCM;
+                else usage();
+                break;
+            case 'r': out_rate = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 't': title = optarg; break;
+            case 'a': artist = optarg; break;
+            case 'l': album = optarg; break;
+            case 'n': track = atoi(optarg); break;
+            default: usage();
+        }
+    }
+    if (argc - optind != 2) usage();
+
+    if (wav_load(&audio, argv[optind]) != 0) return 1;
+
+    /* Output rate: 44.1/48 kHz sources stay as they are, the rest go to 44.1 kHz */
+    if (out_rate == 0) {
+        out_rate = (audio.sample_rate == 44100 || audio.sample_rate == 48000) ?
+                   audio.sample_rate : 44100;
+    }
+    if (resample_audio(&audio, out_rate) != 0) return 1;
+
+    if (title) snprintf(audio.title, WNF_TAG_LEN, "%s", title);
+    if (artist) snprintf(audio.artist, WNF_TAG_LEN, "%s", artist);
+    if (album) snprintf(audio.album, WNF_TAG_LEN, "%s", album);
+    if (track >= 0) audio.track_number = (uint16_t)track;
+    if (audio.title[0] == '\0') {
+        const char* base = strrchr(argv[optind], '/');
+        snprintf(audio.title, WNF_TAG_LEN, "%s", base ? base + 1 : argv[optind]);
+        char* dot = strrchr(audio.title, '.');
+        if (dot) *dot = '\0';
+    }
+
+    /* PCM is always stereo; ADPCM keeps mono sources mono */
+    if (wnf_writer_open(&writer, argv[optind + 1], codec, audio.channels, audio.sample_rate) != 0) {
+        fprintf(stderr, "wnfpack: cannot create %s\n", argv[optind + 1]);
+        return 1;
+    }
+    hdr = &writer.hdr;
+    hdr->track_number = audio.track_number;
+    memcpy(hdr->title, audio.title, WNF_TAG_LEN);
+    memcpy(hdr->artist, audio.artist, WNF_TAG_LEN);
+    memcpy(hdr->album, audio.album, WNF_TAG_LEN);
+    wnf_writer_write(&writer, audio.pcm, audio.frames);
+    if (wnf_writer_close(&writer) != 0) {
+        fprintf(stderr, "wnfpack: cannot write %s\n", argv[optind + 1]);
+        return 1;
+    }
+
+    printf("%s: %s %u Hz %u ch, %u frames (%u.%03u s), %u blocks, gain %+.2f dB, peak %.3f\n",
+           argv[optind + 1], hdr->codec == WNF_CODEC_PCM16 ? "pcm16" : "ima-adpcm",
+           hdr->sample_rate, hdr->channels, hdr->total_frames,
+           hdr->duration_ms / 1000, hdr->duration_ms % 1000, hdr->block_count,
+           hdr->track_gain / 100.0, hdr->track_peak / 32768.0);
+
+    free(audio.pcm);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * WNF Writer - Host Tools
+ */
+
+#include "wnfwrite.h"
+#include <stdlib.h>
+#include <string.h>
+
+int wnf_writer_open(wnf_writer_t* w, const char* path, uint8_t codec,
+                    uint8_t channels, uint32_t sample_rate) {
+    static const uint8_t blank[WNF_HEADER_BYTES];
+    wnf_header_t* hdr = &w->hdr;
+
+    memset(w, 0, sizeof(*w));
+    hdr->codec = codec;
+    hdr->channels = (codec == WNF_CODEC_IMA_ADPCM) ? channels : 2;
+    hdr->block_bytes = (codec == WNF_CODEC_PCM16) ? WNF_PCM_BLOCK_BYTES : WNF_ADPCM_BLOCK_BYTES;
+    hdr->frames_per_block = wnf_block_frames(codec, hdr->channels, hdr->block_bytes);
+    hdr->sample_rate = sample_rate;
+    hdr->data_offset = WNF_HEADER_BYTES;
+    if (hdr->frames_per_block == 0 || sample_rate == 0) {
+        return -1;
+    }
+
+    w->frames = calloc(hdr->frames_per_block, 4);
+    w->block = calloc(1, hdr->block_bytes);
+    w->file = fopen(path, "wb");
+    if (w->frames == NULL || w->block == NULL || w->file == NULL) {
+        if (w->file) fclose(w->file);
+        free(w->frames);
+        free(w->block);
+        return -1;
+    }
+
+    /* Header goes in on close, once the length and gain are known */
+    fwrite(blank, 1, sizeof(blank), w->file);
+    loudness_init(&w->loudness, sample_rate);
+    return 0;
+}
+
+static void wnf_writer_block(wnf_writer_t* w) {
+    wnf_header_t* hdr = &w->hdr;
+    int16_t* frames = w->frames;
+
+    /* Pad the last block with silence */
+    memset(&frames[w->fill * 2], 0, (size_t)(hdr->frames_per_block - w->fill) * 4);
+
+    if (hdr->codec == WNF_CODEC_PCM16) {
+        for (uint32_t i = 0; i < hdr->frames_per_block * 2; i++) {
+            w->block[2 * i] = (uint8_t)frames[i];
+            w->block[2 * i + 1] = (uint8_t)((uint16_t)frames[i] >> 8);
+        }
+    } else {
+        if (hdr->channels == 1) {
+            for (uint32_t i = 0; i < hdr->frames_per_block; i++) frames[i] = frames[2 * i];
+        }
+        adpcm_ima_encode_block(w->state, frames, hdr->channels, w->block, hdr->block_bytes);
+    }
+    fwrite(w->block, 1, hdr->block_bytes, w->file);
+    hdr->block_count++;
+    w->fill = 0;
+}
+
+int wnf_writer_write(wnf_writer_t* w, const int16_t* pcm, uint32_t frames) {
+    wnf_header_t* hdr = &w->hdr;
+
+    loudness_add(&w->loudness, pcm, frames);
+    hdr->total_frames += frames;
+
+    while (frames > 0) {
+        uint32_t n = hdr->frames_per_block - w->fill;
+        if (n > frames) n = frames;
+        memcpy(&w->frames[w->fill * 2], pcm, (size_t)n * 4);
+        w->fill += n;
+        pcm += n * 2;
+        frames -= n;
+        if (w->fill == hdr->frames_per_block) {
+            wnf_writer_block(w);
+        }
+    }
+    return ferror(w->file) ? -1 : 0;
+}
+
+int wnf_writer_close(wnf_writer_t* w) {
+    uint8_t sector[WNF_HEADER_BYTES] = {0};
+    wnf_header_t* hdr = &w->hdr;
+
+    if (w->fill > 0) {
+        wnf_writer_block(w);
+    }
+    hdr->duration_ms = (uint32_t)((uint64_t)hdr->total_frames * 1000 / hdr->sample_rate);
+    loudness_finish(&w->loudness, &hdr->track_gain, &hdr->track_peak);
+    hdr->album_gain = hdr->track_gain;
+    hdr->album_peak = hdr->track_peak;
+
+    wnf_header_write(hdr, sector);
+    fseek(w->file, 0, SEEK_SET);
+    fwrite(sector, 1, sizeof(sector), w->file);
+
+    int status = (ferror(w->file) | fclose(w->file)) ? -1 : 0;
+    free(w->frames);
+    free(w->block);
+    return status;
+}
@@ -0,0 +1,38 @@
+/**
+ * WNF Writer - Host Tools
+ *
+ * Streams stereo s16 frames into a WNF file (src/audio/wnf.h): blocks are
+ * encoded as they fill, the last one zero padded, and the header sector
+ * (frame count, gain and peak) is written when the file is closed. Shared
+ * by wnfpack and wnfbatch so both produce the same bytes.
+ */
+
+#ifndef __WNFWRITE_H
+#define __WNFWRITE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "wnf.h"
+#include "adpcm.h"
+#include "loudness.h"
+
+typedef struct {
+    FILE* file;
+    wnf_header_t hdr;           // Tags and track number are set by the caller
+    int16_t* frames;            // Block being filled, stereo
+    uint32_t fill;
+    uint8_t* block;
+    adpcm_ima_state_t state[ADPCM_IMA_MAX_CHANNELS];
+    loudness_t loudness;
+} wnf_writer_t;
+
+/* PCM16 is always stereo; ADPCM keeps channels (1 = mono from the left) */
+int wnf_writer_open(wnf_writer_t* w, const char* path, uint8_t codec,
+                    uint8_t channels, uint32_t sample_rate);
+
+int wnf_writer_write(wnf_writer_t* w, const int16_t* pcm, uint32_t frames);
+
+/* Flush the last block and write the header; 0 on success */
+int wnf_writer_close(wnf_writer_t* w);
+
+#endif /* __WNFWRITE_H */
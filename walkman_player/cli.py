@@ -13,21 +13,28 @@ from threading import Event
 sys.path.insert(0, str(Path(__file__).parent / 'src'))
 
 from core.player import MusicPlayer
-from gpio.controller import GPIOController, RemoteControlHandler
+from core.daemon_player import DaemonPlayer
+from gpio.controller import DaemonButtonController, GPIOController, RemoteControlHandler
 
 
 class CLIPlayer:
     """Command-line interface for the music player."""
 
-    def __init__(self, use_gpio: bool = False):
+    def __init__(self, use_gpio: bool = False, daemon_socket: str = None):
         """
         Initialize CLI player.
         
         Args:
-            use_gpio: Whether to use real GPIO (False for simulator)
+            use_gpio: Whether to use real GPIO (False for simulator); with
+                daemon_socket, buttons come from wminput through walkmand
+            daemon_socket: Play through walkmand on this socket instead of pygame
         """
-        self.player = MusicPlayer()
-        self.gpio = GPIOController(use_simulator=not use_gpio)
+        self.player = DaemonPlayer(daemon_socket) if daemon_socket else MusicPlayer()
+        if daemon_socket and use_gpio:
+            # wminput watches the buttons and publishes them through walkmand
+            self.gpio = DaemonButtonController(daemon_socket)
+        else:
+            self.gpio = GPIOController(use_simulator=not use_gpio)
         self.remote = RemoteControlHandler(self.player, self.gpio)
         self.running = True
         self.last_display = 0
@@ -250,13 +257,16 @@ def main():
     parser.add_argument('--headless', action='store_true',
                       help='Run in headless mode (GPIO control only)')
     parser.add_argument('--gpio', action='store_true',
-                      help='Use real GPIO (requires root on hardware)')
+                      help='Use real GPIO (requires root on hardware; with --daemon, from wminput)')
     parser.add_argument('--folder', type=str,
                       help='Auto-load music folder on startup')
+    parser.add_argument('--daemon', type=str, nargs='?', const='/tmp/walkmand.sock',
+                      metavar='SOCKET',
+                      help='Play through the walkmand daemon (gapless, WAV/WNF only)')
     
     args = parser.parse_args()
     
-    cli = CLIPlayer(use_gpio=args.gpio)
+    cli = CLIPlayer(use_gpio=args.gpio, daemon_socket=args.daemon)
     
     try:
         if not cli.setup():
@@ -3,6 +3,9 @@
 Audio Converter Helper for Walkman Music Player
 Converts MP3 files to WAV or OGG format for better compatibility.
 Requires: ffmpeg to be installed on system
+
+For the STM32 player, stm32_walkman/build/tools/wnfbatch converts a whole
+library to WNF in parallel and skips unchanged files.
 """
 
 import subprocess
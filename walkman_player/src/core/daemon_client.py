@@ -0,0 +1,106 @@
+"""
+Client for walkmand, the Linux playback daemon (stm32_walkman: make daemon).
+
+The daemon speaks a line protocol on a Unix socket: one command per line,
+one "ok ..." / "error <reason>" reply per command. A second connection is
+subscribed to events ("event track <id>" when a track reaches the DAC,
+"event end" after the last queued track, "event button <name> <action>"
+from the wminput button service) and read by a listener thread.
+"""
+
+import socket
+import threading
+from typing import Callable, Dict, Optional
+
+DEFAULT_SOCKET = '/tmp/walkmand.sock'
+
+
+class DaemonError(Exception):
+    """Error reply from walkmand."""
+
+
+class DaemonClient:
+    """Control connection plus an event listener thread."""
+
+    def __init__(self, path: str = DEFAULT_SOCKET):
+        self.path = path
+        self._lock = threading.Lock()
+        self._sock = self._connect()
+        self._reader = self._sock.makefile('r')
+        self._events: Optional[socket.socket] = None
+        self._listener: Optional[threading.Thread] = None
+
+    def _connect(self) -> socket.socket:
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.connect(self.path)
+        return sock
+
+    def command(self, line: str) -> str:
+        """Send a command, return the reply after "ok" (raises DaemonError)."""
+        with self._lock:
+            self._sock.sendall((line + '\n').encode())
+            reply = self._reader.readline().strip()
+        if reply == 'ok' or reply.startswith('ok '):
+            return reply[3:]
+        raise DaemonError(reply[6:] if reply.startswith('error ') else reply or 'connection closed')
+
+    def play(self, path: str) -> int:
+        """Replace what is playing, returns the track id."""
+        return int(self.command(f'play {path}'))
+
+    def queue(self, path: str) -> int:
+        """Track to continue with gaplessly, returns the track id."""
+        return int(self.command(f'queue {path}'))
+
+    def pause(self, paused: bool = True):
+        self.command('pause' if paused else 'resume')
+
+    def stop(self):
+        self.command('stop')
+
+    def seek(self, position_ms: int):
+        self.command(f'seek {int(position_ms)}')
+
+    def set_volume(self, volume: int):
+        """0-100 (0 = mute)"""
+        self.command(f'volume {int(volume)}')
+
+    def status(self) -> Dict[str, str]:
+        """state, track, position_ms, position_frames, rate, underruns, xruns"""
+        return dict(field.split('=', 1) for field in self.command('status').split())
+
+    def subscribe(self, callback: Callable[[str, int], None],
+                  on_button: Optional[Callable[[str, str], None]] = None):
+        """
+        Start the listener thread; callback(kind, track_id) runs on it with
+        kind 'track' or 'end' (track_id 0), on_button(name, action) with
+        action 'pressed', 'long' or 'released'.
+        """
+        self._events = self._connect()
+        self._events.sendall(b'subscribe\n')
+        self._listener = threading.Thread(target=self._listen, args=(callback, on_button),
+                                          daemon=True)
+        self._listener.start()
+
+    def _listen(self, callback: Callable[[str, int], None],
+                on_button: Optional[Callable[[str, str], None]]):
+        reader = self._events.makefile('r')
+        reader.readline()   # "ok" for subscribe
+        for line in reader:
+            fields = line.split()
+            if len(fields) < 2 or fields[0] != 'event':
+                continue
+            if fields[1] == 'button':
+                if on_button is not None and len(fields) == 4:
+                    on_button(fields[2], fields[3])
+            else:
+                callback(fields[1], int(fields[2]) if len(fields) > 2 else 0)
+
+    def close(self):
+        for sock in (self._events, self._sock):
+            if sock is not None:
+                try:
+                    sock.shutdown(socket.SHUT_RDWR)
+                except OSError:
+                    pass
+                sock.close()
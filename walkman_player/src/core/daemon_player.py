@@ -0,0 +1,183 @@
+"""
+MusicPlayer playing through walkmand, the firmware's engine as a Linux
+daemon (stm32_walkman: make daemon; see daemon_client.py).
+
+The playlist, shuffle and loop logic stay here; the daemon only holds the
+current and the next track. The next track is queued as soon as one
+starts, so the daemon joins them without a gap, and the position is the
+daemon's sample-accurate one instead of a wall-clock estimate. Only the
+formats the core decodes (WAV, WNF) can be played.
+"""
+
+from typing import Dict, Optional
+
+from core import walkman_core
+from core.daemon_client import DaemonClient, DaemonError, DEFAULT_SOCKET
+from core.player import MusicPlayer
+
+
+class DaemonPlayer(MusicPlayer):
+    """Music player backed by walkmand."""
+
+    def __init__(self, socket_path: str = DEFAULT_SOCKET):
+        """
+        Initialize the player.
+
+        Args:
+            socket_path: walkmand control socket
+        """
+        self.socket_path = socket_path
+        super().__init__()
+        self.supported_formats = set(walkman_core.CORE_FORMATS)
+        self._tracks: Dict[int, int] = {}       # Daemon track id -> playlist index
+        self._queued_id: Optional[int] = None   # Queued, not yet at the DAC
+        self.daemon.subscribe(self._on_daemon_event)
+
+    def _init_audio(self):
+        """Connect to the daemon instead of opening pygame's mixer."""
+        self.daemon = DaemonClient(self.socket_path)
+
+    def play(self, index: Optional[int] = None) -> bool:
+        """
+        Play a track from the playlist, or resume from pause.
+
+        Args:
+            index: Index of the track to play. If None, resume from paused state or play from start
+
+        Returns:
+            True if playback started, False otherwise
+        """
+        if index is not None:
+            if not 0 <= index < len(self.playlist):
+                print(f"Error: Invalid index {index}")
+                return False
+            self.current_index = index
+        elif self.is_paused:
+            return self.unpause()
+
+        if not 0 <= self.current_index < len(self.playlist):
+            if not self.playlist:
+                print("Error: No music files in playlist")
+                return False
+            self.current_index = 0
+
+        for _ in range(len(self.playlist)):
+            track_path = self.playlist[self.current_index]
+            try:
+                self.daemon.set_volume(round(self.volume * 100))
+                track_id = self.daemon.play(track_path)
+            except DaemonError as e:
+                print(f"⚠ Skipping {self.get_current_track_name()}: {e}")
+                next_index = self._get_next_track_index()
+                if next_index is None:
+                    break
+                self.current_index = next_index
+                continue
+
+            self._tracks = {track_id: self.current_index}
+            self._queued_id = None
+            self.is_playing = True
+            self.is_paused = False
+            if self.on_track_changed:
+                self.on_track_changed(self.current_index, track_path)
+            if self.on_playback_started:
+                self.on_playback_started()
+            self._queue_next()
+            return True
+
+        self.is_playing = False
+        print("Error: Unable to play any tracks - all files are corrupted or incompatible")
+        return False
+
+    def pause(self) -> bool:
+        if self.is_playing and not self.is_paused:
+            self.daemon.pause(True)
+            self.is_paused = True
+            return True
+        return False
+
+    def unpause(self) -> bool:
+        if self.is_playing and self.is_paused:
+            self.daemon.pause(False)
+            self.is_paused = False
+            return True
+        return False
+
+    def stop(self) -> bool:
+        if self.is_playing:
+            self.daemon.stop()
+            self.is_playing = False
+            self.is_paused = False
+            self._queued_id = None
+            if self.on_playback_stopped:
+                self.on_playback_stopped()
+            return True
+        return False
+
+    def set_volume(self, volume: float) -> bool:
+        self.volume = max(0.0, min(1.0, volume))
+        self.daemon.set_volume(round(self.volume * 100))
+        return True
+
+    def get_playback_position(self) -> float:
+        """Position at the DAC in seconds (held while paused), 0 if stopped."""
+        if not self.is_playing:
+            return 0.0
+        try:
+            return int(self.daemon.status()['position_ms']) / 1000.0
+        except (DaemonError, KeyError, ValueError):
+            return 0.0
+
+    def toggle_shuffle(self) -> bool:
+        enabled = super().toggle_shuffle()
+        self._requeue()
+        return enabled
+
+    def toggle_loop(self) -> str:
+        mode = super().toggle_loop()
+        self._requeue()
+        return mode
+
+    def _requeue(self):
+        """The queued track follows the modes: replace it after a change."""
+        if self.is_playing:
+            self._queue_next()
+
+    def _queue_next(self):
+        """Queue the track that follows the current one, if any."""
+        if self.loop_mode == 'one':
+            next_index = self.current_index
+        else:
+            next_index = self._get_next_track_index()
+        if next_index is None:
+            self._queued_id = None
+            return
+        try:
+            track_id = self.daemon.queue(self.playlist[next_index])
+        except DaemonError as e:
+            # Leave nothing queued: playback ends after the current track
+            print(f"⚠ Cannot queue {self.playlist[next_index]}: {e}")
+            self._queued_id = None
+            return
+        self._tracks[track_id] = next_index
+        self._queued_id = track_id
+
+    def _on_daemon_event(self, kind: str, track_id: int):
+        """Runs on the client's listener thread."""
+        if kind == 'track' and track_id == self._queued_id:
+            # The queued track reached the DAC: it is now the current one
+            self.current_index = self._tracks.pop(track_id)
+            self._queued_id = None
+            if self.on_track_changed:
+                self.on_track_changed(self.current_index, self.playlist[self.current_index])
+            self._queue_next()
+        elif kind == 'end' and self.is_playing:
+            self.is_playing = False
+            self.is_paused = False
+            if self.on_playback_stopped:
+                self.on_playback_stopped()
+
+    def shutdown(self):
+        """Stop playback and disconnect (the daemon keeps running)."""
+        self.stop()
+        self.daemon.close()
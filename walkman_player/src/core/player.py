@@ -1,6 +1,10 @@
 """
 Core music player engine using pygame for audio playback.
 Supports local music file loading and playback control.
+
+Files are validated by a header probe through libwalkman_core (see
+walkman_core.py) and the shuffle order comes from the firmware's engine.
+DaemonPlayer (daemon_player.py) plays through walkmand instead of pygame.
 """
 
 import pygame
@@ -11,13 +15,15 @@ import threading
 import time
 import random
 
+from core import walkman_core
+
 
 class MusicPlayer:
     """Core music player with playlist management and playback control."""
 
     def __init__(self):
         """Initialize the music player."""
-        pygame.mixer.init(frequency=44100, size=-16, channels=2, buffer=512)
+        self._init_audio()
         self.playlist: List[str] = []
         self.current_index: int = -1
         self.is_playing: bool = False
@@ -31,6 +37,10 @@ class MusicPlayer:
         self.shuffle_enabled: bool = False
         self.loop_mode: str = 'off'  # 'off', 'all', 'one'
         self.shuffle_order: List[int] = []  # Shuffled playlist indices
+        self.shuffle_seed: int = 0  # Seed of the current shuffle order
+        
+        # Firmware core library (None if not built)
+        self.core = walkman_core.load()
         
         # Playback time tracking
         self.playback_start_time: float = 0.0  # Time when track started playing
@@ -48,6 +58,10 @@ class MusicPlayer:
         self._monitor_thread = None
         self._stop_monitor = False
 
+    def _init_audio(self):
+        """Open the audio output (overridden by DaemonPlayer)."""
+        pygame.mixer.init(frequency=44100, size=-16, channels=2, buffer=512)
+
     def load_music_directory(self, directory: str) -> int:
         """
         Load all supported audio files from a directory.
@@ -119,21 +133,29 @@ class MusicPlayer:
         """
         Validate if an audio file can be loaded.
         
+        Only the headers are read: WAV/WNF are parsed by the core library,
+        other formats are checked by magic number. Decoding the whole file
+        made loading large folders take minutes.
+        
         Args:
             filepath: Path to the audio file
             
         Returns:
             True if file is valid, False otherwise
         """
-        try:
-            # Try to test load the file
-            test_sound = pygame.mixer.Sound(filepath)
-            return True
-        except pygame.error as e:
-            # Log but don't print - validation is silent
-            return False
-        except Exception as e:
-            return False
+        if self.core is not None and Path(filepath).suffix.lower() in walkman_core.CORE_FORMATS:
+            status, _ = self.core.probe(filepath)
+            if status == walkman_core.WM_OK:
+                return True
+            if status != walkman_core.WM_ERROR_UNSUPPORTED:
+                return False
+            # Valid container the core does not decode (e.g. 24-bit PCM)
+        return walkman_core.sniff_header(filepath)
+
+    def _new_shuffle_order(self) -> List[int]:
+        """Shuffle order from a fresh seed, same algorithm as the firmware."""
+        self.shuffle_seed = random.getrandbits(32)
+        return walkman_core.shuffle_order(self.shuffle_seed, len(self.playlist))
 
     def play(self, index: Optional[int] = None) -> bool:
         """
@@ -401,8 +423,7 @@ class MusicPlayer:
         
         if self.shuffle_enabled:
             # Create shuffled order
-            self.shuffle_order = list(range(len(self.playlist)))
-            random.shuffle(self.shuffle_order)
+            self.shuffle_order = self._new_shuffle_order()
         else:
             self.shuffle_order = []
         
@@ -481,8 +502,7 @@ class MusicPlayer:
             # Use shuffled order
             if not self.shuffle_order:
                 # Recreate shuffle order
-                self.shuffle_order = list(range(len(self.playlist)))
-                random.shuffle(self.shuffle_order)
+                self.shuffle_order = self._new_shuffle_order()
             
             # Find current position in shuffle order
             try:
@@ -495,8 +515,7 @@ class MusicPlayer:
                     # End of shuffled list
                     if self.loop_mode == 'all':
                         # Reshuffle and start over
-                        self.shuffle_order = list(range(len(self.playlist)))
-                        random.shuffle(self.shuffle_order)
+                        self.shuffle_order = self._new_shuffle_order()
                         return self.shuffle_order[0]
                     return None
             except ValueError:
@@ -0,0 +1,256 @@
+"""
+ctypes bindings for libwalkman_core.so, the STM32 firmware's playback core
+built for Linux (stm32_walkman: make core-lib).
+
+Provides header probing with tags, WAV/WNF decoding with sample rate
+conversion and gain, and the firmware's seeded shuffle order. Without the
+library, probing falls back to a magic-number check and the shuffle order
+to a pure-Python copy of the same algorithm, so behaviour stays identical.
+"""
+
+import ctypes
+import ctypes.util
+import os
+from dataclasses import dataclass
+from pathlib import Path
+from typing import List, Optional
+
+ABI_VERSION = 1
+TAG_LEN = 64
+
+# Status codes (walkman_core.h)
+WM_OK = 0
+WM_ERROR = 1
+WM_ERROR_NO_FILE = 2
+WM_ERROR_UNSUPPORTED = 3
+WM_ERROR_ARGUMENT = 4
+
+# Extensions the core decodes
+CORE_FORMATS = {'.wav', '.wnf'}
+
+# Where `make core-lib` puts the library in this repository
+_BUILD_PATH = (Path(__file__).resolve().parents[3] / 'stm32_walkman' /
+               'build' / 'core' / 'libwalkman_core.so')
+
+
+class _Info(ctypes.Structure):
+    _fields_ = [
+        ('codec', ctypes.c_char * 8),
+        ('sample_rate', ctypes.c_uint32),
+        ('channels', ctypes.c_uint32),
+        ('bits_per_sample', ctypes.c_uint32),
+        ('total_frames', ctypes.c_uint32),
+        ('duration_ms', ctypes.c_uint32),
+        ('title', ctypes.c_char * TAG_LEN),
+        ('artist', ctypes.c_char * TAG_LEN),
+        ('album', ctypes.c_char * TAG_LEN),
+        ('replay_gain', ctypes.c_int32),
+        ('replay_peak', ctypes.c_uint32),
+    ]
+
+
+@dataclass
+class AudioInfo:
+    """Stream description read from the file headers."""
+    codec: str
+    sample_rate: int
+    channels: int
+    bits_per_sample: int
+    total_frames: int
+    duration_ms: int
+    title: str
+    artist: str
+    album: str
+    replay_gain_db: float
+    replay_peak: float
+
+    @classmethod
+    def _from_struct(cls, info: _Info) -> 'AudioInfo':
+        def text(raw: bytes) -> str:
+            return raw.decode('utf-8', errors='replace')
+
+        return cls(
+            codec=text(info.codec),
+            sample_rate=info.sample_rate,
+            channels=info.channels,
+            bits_per_sample=info.bits_per_sample,
+            total_frames=info.total_frames,
+            duration_ms=info.duration_ms,
+            title=text(info.title),
+            artist=text(info.artist),
+            album=text(info.album),
+            replay_gain_db=info.replay_gain / 100.0,
+            replay_peak=info.replay_peak / 32768.0,
+        )
+
+
+class Stream:
+    """Decoder handle: interleaved stereo 16-bit frames."""
+
+    def __init__(self, lib, handle):
+        self._lib = lib
+        self._handle = handle
+
+    def read(self, frames: int) -> bytes:
+        """Decode up to frames frames; empty bytes at end of stream."""
+        buf = (ctypes.c_int16 * (frames * 2))()
+        n = self._lib.wm_read(self._handle, buf, frames)
+        return ctypes.string_at(buf, n * 4)
+
+    def seek(self, position_ms: int) -> bool:
+        return self._lib.wm_seek_ms(self._handle, position_ms) == WM_OK
+
+    @property
+    def position_ms(self) -> int:
+        return self._lib.wm_position_ms(self._handle)
+
+    @property
+    def info(self) -> AudioInfo:
+        info = _Info()
+        self._lib.wm_get_info(self._handle, ctypes.byref(info))
+        return AudioInfo._from_struct(info)
+
+    def set_gain_db(self, db: float):
+        self._lib.wm_set_gain_db(self._handle, db)
+
+    def close(self):
+        if self._handle:
+            self._lib.wm_close(self._handle)
+            self._handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+
+class WalkmanCore:
+    """Loaded libwalkman_core.so."""
+
+    def __init__(self, path: str):
+        lib = ctypes.CDLL(path)
+
+        lib.wm_abi_version.restype = ctypes.c_uint32
+        lib.wm_abi_version.argtypes = []
+        if lib.wm_abi_version() != ABI_VERSION:
+            raise OSError(f"{path}: ABI version {lib.wm_abi_version()}, need {ABI_VERSION}")
+
+        lib.wm_probe.restype = ctypes.c_int
+        lib.wm_probe.argtypes = [ctypes.c_char_p, ctypes.POINTER(_Info)]
+        lib.wm_open.restype = ctypes.c_void_p
+        lib.wm_open.argtypes = [ctypes.c_char_p, ctypes.c_uint32, ctypes.POINTER(ctypes.c_int)]
+        lib.wm_read.restype = ctypes.c_uint32
+        lib.wm_read.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_int16), ctypes.c_uint32]
+        lib.wm_seek_ms.restype = ctypes.c_int
+        lib.wm_seek_ms.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+        lib.wm_position_ms.restype = ctypes.c_uint32
+        lib.wm_position_ms.argtypes = [ctypes.c_void_p]
+        lib.wm_get_info.restype = ctypes.c_int
+        lib.wm_get_info.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Info)]
+        lib.wm_set_gain_db.restype = None
+        lib.wm_set_gain_db.argtypes = [ctypes.c_void_p, ctypes.c_float]
+        lib.wm_close.restype = None
+        lib.wm_close.argtypes = [ctypes.c_void_p]
+        lib.wm_shuffle_order.restype = None
+        lib.wm_shuffle_order.argtypes = [ctypes.c_uint32, ctypes.POINTER(ctypes.c_uint16),
+                                         ctypes.c_uint16]
+
+        self._lib = lib
+        self.path = path
+
+    def probe(self, filepath: str):
+        """
+        Parse a file's headers without decoding audio.
+
+        Returns:
+            (status, AudioInfo or None)
+        """
+        info = _Info()
+        status = self._lib.wm_probe(os.fsencode(filepath), ctypes.byref(info))
+        return status, (AudioInfo._from_struct(info) if status == WM_OK else None)
+
+    def open(self, filepath: str, output_rate: int = 0) -> Optional[Stream]:
+        """Open a file for decoding, resampled to output_rate unless 0."""
+        status = ctypes.c_int()
+        handle = self._lib.wm_open(os.fsencode(filepath), output_rate, ctypes.byref(status))
+        return Stream(self._lib, handle) if handle else None
+
+    def shuffle_order(self, seed: int, count: int) -> List[int]:
+        if count > 0xFFFF:
+            return _shuffle_order_py(seed, count)
+        order = (ctypes.c_uint16 * count)()
+        self._lib.wm_shuffle_order(seed & 0xFFFFFFFF, order, count)
+        return list(order)
+
+
+_core = None
+_core_loaded = False
+
+
+def load() -> Optional[WalkmanCore]:
+    """
+    Load the library once: $WALKMAN_CORE_LIB, the stm32_walkman build
+    directory, then the system library path. None if unavailable.
+    """
+    global _core, _core_loaded
+    if _core_loaded:
+        return _core
+    _core_loaded = True
+
+    candidates = [os.environ.get('WALKMAN_CORE_LIB'), str(_BUILD_PATH),
+                  ctypes.util.find_library('walkman_core')]
+    for path in candidates:
+        if not path:
+            continue
+        try:
+            _core = WalkmanCore(path)
+            break
+        except OSError:
+            continue
+    return _core
+
+
+def _shuffle_order_py(seed: int, count: int) -> List[int]:
+    """Same xorshift32 Fisher-Yates as src/audio/shuffle.c."""
+    x = (seed & 0xFFFFFFFF) or 1
+    order = list(range(count))
+    for i in range(count, 1, -1):
+        x ^= (x << 13) & 0xFFFFFFFF
+        x ^= x >> 17
+        x ^= (x << 5) & 0xFFFFFFFF
+        j = x % i
+        order[i - 1], order[j] = order[j], order[i - 1]
+    return order
+
+
+def shuffle_order(seed: int, count: int) -> List[int]:
+    """Firmware shuffle order for a seed, through the library if loaded."""
+    core = load()
+    if core is not None:
+        return core.shuffle_order(seed, count)
+    return _shuffle_order_py(seed, count)
+
+
+def sniff_header(filepath: str) -> bool:
+    """
+    Cheap container check by magic number for files the core does not
+    decode (MP3, Ogg, FLAC) or when the library is missing.
+    """
+    try:
+        with open(filepath, 'rb') as f:
+            head = f.read(12)
+    except OSError:
+        return False
+
+    if head[:4] == b'RIFF' and head[8:12] == b'WAVE':
+        return True
+    if head[:4] in (b'OggS', b'fLaC'):
+        return True
+    if head[:3] == b'ID3':
+        return True
+    # Bare MPEG audio frame sync
+    return len(head) >= 2 and head[0] == 0xFF and (head[1] & 0xE0) == 0xE0
@@ -253,16 +253,84 @@ class GPIOController:
         print("[GPIO] Cleanup complete")
 
 
+class DaemonButtonController:
+    """
+    Buttons from walkmand instead of polling GPIO here.
+
+    wminput (stm32_walkman/linux/wminput.c) waits for kernel edge events,
+    debounces them and publishes each gesture through walkmand, which
+    passes it on as "event button <name> <action>". Same interface as
+    GPIOController; callbacks fire on the debounced press.
+    """
+
+    def __init__(self, socket_path: str = '/tmp/walkmand.sock'):
+        """
+        Initialize the controller.
+
+        Args:
+            socket_path: walkmand control socket
+        """
+        self.socket_path = socket_path
+        self.callbacks: Dict[str, Callable] = {}
+        self._client = None
+        self._monitoring = False
+
+    def setup(self) -> bool:
+        """Connect to walkmand."""
+        from core.daemon_client import DaemonClient
+        try:
+            self._client = DaemonClient(self.socket_path)
+        except OSError as e:
+            print(f"[GPIO] Cannot connect to walkmand at {self.socket_path}: {e}")
+            return False
+        print("[GPIO] Buttons from wminput via walkmand")
+        return True
+
+    def register_callback(self, button_name: str, callback: Callable) -> bool:
+        """Register a callback function for a button."""
+        if button_name not in GPIOController.DEFAULT_PIN_CONFIG:
+            print(f"Unknown button: {button_name}")
+            return False
+        self.callbacks[button_name] = callback
+        return True
+
+    def start_monitoring(self):
+        """Subscribe to button events."""
+        if self._monitoring or self._client is None:
+            return
+        self._monitoring = True
+        self._client.subscribe(lambda kind, track_id: None, on_button=self._on_button)
+        print("[GPIO] Button monitoring started")
+
+    def stop_monitoring(self):
+        """Stop reacting to button events."""
+        self._monitoring = False
+
+    def _on_button(self, button_name: str, action: str):
+        """Handle a button event from the daemon."""
+        if self._monitoring and action == 'pressed' and button_name in self.callbacks:
+            self.callbacks[button_name]()
+            print(f"[GPIO] {button_name} pressed")
+
+    def cleanup(self):
+        """Close the daemon connection."""
+        self.stop_monitoring()
+        if self._client is not None:
+            self._client.close()
+            self._client = None
+        print("[GPIO] Cleanup complete")
+
+
 class RemoteControlHandler:
     """High-level handler for player control via GPIO."""
 
-    def __init__(self, player, gpio_controller: GPIOController):
+    def __init__(self, player, gpio_controller):
         """
         Initialize remote control handler.
         
         Args:
             player: MusicPlayer instance
-            gpio_controller: GPIOController instance
+            gpio_controller: GPIOController or DaemonButtonController
         """
         self.player = player
         self.gpio = gpio_controller
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Test the libwalkman_core bindings (build it first: make -C ../stm32_walkman core-lib)
+"""
+
+import struct
+import sys
+import tempfile
+from pathlib import Path
+
+# Add src to path
+sys.path.insert(0, str(Path(__file__).parent / 'src'))
+
+from core import walkman_core
+
+
+def write_wav(path, frames, rate=32000, tags=None):
+    """Stereo 16-bit WAV with an optional LIST/INFO chunk before the data."""
+    samples = []
+    for i in range(frames):
+        samples += [(i * 7) % 30000 - 15000, -((i * 7) % 30000 - 15000)]
+    data = struct.pack(f'<{len(samples)}h', *samples)
+
+    info = b''
+    for key, value in (tags or {}).items():
+        text = value.encode() + b'\0'
+        if len(text) & 1:
+            text += b'\0'
+        info += key.encode() + struct.pack('<I', len(text)) + text
+    chunks = struct.pack('<4sIHHIIHH', b'fmt ', 16, 1, 2, rate, rate * 4, 4, 16)
+    if info:
+        chunks += b'LIST' + struct.pack('<I', len(info) + 4) + b'INFO' + info
+    chunks += b'data' + struct.pack('<I', len(data)) + data
+
+    Path(path).write_bytes(b'RIFF' + struct.pack('<I', len(chunks) + 4) + b'WAVE' + chunks)
+    return samples
+
+
+def test_core():
+    """Probe, decode, seek, resample and shuffle through the library."""
+    print("\n" + "=" * 60)
+    print("Testing Walkman Core Library")
+    print("=" * 60)
+
+    core = walkman_core.load()
+    if core is None:
+        print("⚠ libwalkman_core.so not found - skipped")
+        return True
+    print(f"✓ Loaded {core.path}")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        wav = str(Path(tmp) / 'tone.wav')
+        samples = write_wav(wav, 32000, tags={'INAM': 'Tone', 'IART': 'Walkman', 'IPRD': 'Tests'})
+
+        status, info = core.probe(wav)
+        assert status == walkman_core.WM_OK, status
+        assert (info.codec, info.sample_rate, info.channels, info.total_frames) == ('wav', 32000, 2, 32000)
+        assert info.duration_ms == 1000
+        assert (info.title, info.artist, info.album) == ('Tone', 'Walkman', 'Tests')
+        print(f"✓ Probe: {info.codec} {info.sample_rate} Hz, {info.duration_ms} ms, "
+              f"'{info.title}' by {info.artist}")
+
+        garbage = Path(tmp) / 'garbage.wav'
+        garbage.write_bytes(b'\0' * 256)
+        assert core.probe(str(garbage))[0] == walkman_core.WM_ERROR_UNSUPPORTED
+        assert core.probe(str(Path(tmp) / 'missing.wav'))[0] == walkman_core.WM_ERROR_NO_FILE
+        assert not walkman_core.sniff_header(str(garbage))
+        print("✓ Probe rejects bad and missing files")
+
+        with core.open(wav) as stream:
+            pcm = stream.read(32000)
+            assert struct.unpack(f'<{len(samples)}h', pcm) == tuple(samples)
+            assert stream.read(16) == b''
+            assert stream.seek(500) and stream.position_ms == 500
+            first = struct.unpack('<2h', stream.read(1))
+            assert first == tuple(samples[32000:32002])
+        print("✓ Decode is bit-exact, seek is frame exact")
+
+        with core.open(wav, output_rate=48000) as stream:
+            total = 0
+            while True:
+                chunk = stream.read(4096)
+                if not chunk:
+                    break
+                total += len(chunk) // 4
+            assert abs(total - 48000) <= 32, total
+        print(f"✓ Resampled 32000 -> 48000 Hz: {total} frames")
+
+    for seed in (0, 1, 0xDEADBEEF):
+        for count in (1, 5, 100, 1000):
+            order = core.shuffle_order(seed, count)
+            assert order == walkman_core._shuffle_order_py(seed, count)
+            assert sorted(order) == list(range(count))
+    print("✓ Shuffle order matches the Python fallback")
+
+    return True
+
+
+if __name__ == "__main__":
+    try:
+        success = test_core()
+    except AssertionError as e:
+        print(f"❌ Assertion failed: {e}")
+        success = False
+    sys.exit(0 if success else 1)
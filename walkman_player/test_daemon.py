@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Test DaemonPlayer against walkmand (build it first: make -C ../stm32_walkman daemon)
+
+The daemon writes to a paced WAV file (-D file:<path>), so the test needs
+no audio hardware and can check the joins between tracks bit-exact.
+"""
+
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import types
+from pathlib import Path
+
+# Add src to path
+sys.path.insert(0, str(Path(__file__).parent / 'src'))
+
+try:
+    import pygame  # noqa: F401
+except ImportError:
+    # DaemonPlayer never touches pygame; MusicPlayer only imports it
+    sys.modules['pygame'] = types.ModuleType('pygame')
+
+from core.daemon_client import DaemonClient
+from core.daemon_player import DaemonPlayer
+from gpio.controller import DaemonButtonController, RemoteControlHandler
+from test_core import write_wav
+
+WALKMAND = Path(__file__).resolve().parent.parent / 'stm32_walkman' / 'build' / 'linux' / 'walkmand'
+
+
+def test_daemon_player():
+    """Gapless track changes, events and position through the daemon."""
+    print("\n" + "=" * 60)
+    print("Testing DaemonPlayer (walkmand)")
+    print("=" * 60)
+
+    if not WALKMAND.is_file():
+        print("⚠ walkmand not built - skipped")
+        return True
+
+    with tempfile.TemporaryDirectory() as tmp:
+        music = Path(tmp) / 'music'
+        music.mkdir()
+        sources = []
+        for name, frames in (('01.wav', 22050), ('02.wav', 11025), ('03.wav', 8820)):
+            sources.append(write_wav(str(music / name), frames, rate=44100))
+        (music / 'skipped.mp3').write_bytes(b'ID3' + b'\0' * 64)
+
+        capture = Path(tmp) / 'out.wav'
+        sock = str(Path(tmp) / 'walkmand.sock')
+        daemon = subprocess.Popen([str(WALKMAND), '-s', sock, '-D', f'file:{capture}'],
+                                  stdout=subprocess.DEVNULL)
+        player = None
+        try:
+            for _ in range(50):
+                if Path(sock).exists():
+                    break
+                time.sleep(0.05)
+
+            player = DaemonPlayer(sock)
+            assert player.load_music_directory(str(music)) == 3
+            print("✓ Loaded WAV tracks, other formats left out")
+
+            changes = []
+            stopped = threading.Event()
+            player.on_track_changed = lambda index, path: changes.append(index)
+            player.on_playback_stopped = stopped.set
+
+            player.set_volume(1.0)
+            assert player.play(0)
+            time.sleep(0.3)
+            position = player.get_playback_position()
+            assert 0.15 <= position <= 0.45, position
+            print(f"✓ Position from the daemon: {position:.3f} s after 0.3 s")
+
+            assert stopped.wait(5), "no end of playlist"
+            assert changes == [0, 1, 2], changes
+            assert not player.is_playing
+            print("✓ Tracks advanced on daemon events, stopped at the end")
+
+            # What wminput sends for a debounced press of play/pause
+            remote = RemoteControlHandler(player, DaemonButtonController(sock))
+            assert remote.setup()
+            started = threading.Event()
+            player.on_track_changed = lambda index, path: started.set()
+            buttons = DaemonClient(sock)
+            buttons.command('button play_pause pressed')
+            assert started.wait(2), "play_pause button did not start playback"
+            player.stop()
+            buttons.close()
+            remote.cleanup()
+            print("✓ Button event from the daemon started playback")
+        finally:
+            if player is not None:
+                player.shutdown()
+            daemon.terminate()
+            daemon.wait(timeout=5)
+
+        data = capture.read_bytes()[44:]
+        out = struct.unpack(f'<{len(data) // 2}h', data)
+        start = next(i for i, s in enumerate(out) if s != 0)
+        joined = tuple(s for samples in sources for s in samples)
+        assert out[start:start + len(joined)] == joined, "tracks not joined bit-exact"
+        print(f"✓ Output holds the three tracks back to back ({len(joined) // 2} frames)")
+
+    return True
+
+
+if __name__ == "__main__":
+    try:
+        success = test_daemon_player()
+    except AssertionError as e:
+        print(f"❌ Assertion failed: {e}")
+        success = False
+    sys.exit(0 if success else 1)